@@ -40,5 +40,29 @@ int main(const int argc, const char * argv[])
     
     std::cout << "Self union duration: " << bench.getElapsedSec() << std::endl;
     
+    // Drill a grid of holes through the top of the input, as the SLA drain holes are drilled.
+    BoundingBoxf3 bb = input.bounding_box();
+    const double r = 0.5, pitch = 4 * r;
+    std::vector<TriangleMesh> holes;
+    for (double x = bb.min.x() + pitch; x < bb.max.x() - pitch; x += pitch)
+        for (double y = bb.min.y() + pitch; y < bb.max.y() - pitch; y += pitch) {
+            TriangleMesh hole = make_cylinder(r, 2 * pitch);
+            hole.translate(float(x), float(y), float(bb.max.z() - pitch));
+            hole.require_shared_vertices();
+            holes.emplace_back(std::move(hole));
+        }
+    
+    bench.start();
+    TriangleMesh holes_mesh = MeshBoolean::cgal::plus(holes);
+    bench.stop();
+    
+    std::cout << "Union of " << holes.size() << " holes duration: " << bench.getElapsedSec() << std::endl;
+    
+    bench.start();
+    MeshBoolean::cgal::minus(input, holes_mesh);
+    bench.stop();
+    
+    std::cout << "Drilling duration: " << bench.getElapsedSec() << std::endl;
+    
     return 0;
 }
@@ -0,0 +1,345 @@
+// Times the stages of the slicing pipeline on a fixed, procedurally generated corpus of models,
+// to catch performance regressions between builds. The results are written as JSON.
+//
+// Usage: slic3r_bench [--repeat N] [--output results.json] [model ...]
+// Models: lattice, vase, plate, scan, sla_miniature. All models are run if none is given.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <tbb/task_arena.h>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintBase.hpp>
+#include <libslic3r/SLAPrint.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/Format/SL1.hpp>
+#include <libslic3r/GCode/GCodeProcessor.hpp>
+
+using namespace Slic3r;
+
+namespace {
+
+struct BenchModel
+{
+    std::string                                         name;
+    PrinterTechnology                                   technology;
+    // Configuration applied over the defaults.
+    std::vector<std::pair<std::string, std::string>>    config;
+    std::function<void(Model&)>                         build;
+};
+
+ModelObject* add_object(Model &model, const std::string &name, const TriangleMesh &mesh, const Vec2d &position)
+{
+    ModelObject *object = model.add_object();
+    object->name = name;
+    object->add_volume(mesh);
+    object->add_instance()->set_offset(Vec3d(position.x(), position.y(), 0.));
+    object->ensure_on_bed();
+    return object;
+}
+
+// 40mm cube made of 2mm bars at 5mm pitch along all three axes, 243 overlapping parts of one object.
+void build_lattice(Model &model)
+{
+    const double size = 40., bar = 2., pitch = 5.;
+    TriangleMesh lattice;
+    for (double a = 0.; a + bar <= size; a += pitch)
+        for (double b = 0.; b + bar <= size; b += pitch) {
+            TriangleMesh x = make_cube(size, bar, bar);
+            x.translate(0.f, float(a), float(b));
+            TriangleMesh y = make_cube(bar, size, bar);
+            y.translate(float(a), 0.f, float(b));
+            TriangleMesh z = make_cube(bar, bar, size);
+            z.translate(float(a), float(b), 0.f);
+            lattice.merge(x);
+            lattice.merge(y);
+            lattice.merge(z);
+        }
+    lattice.repair();
+    add_object(model, "lattice", lattice, Vec2d(100., 100.));
+}
+
+void build_vase(Model &model)
+{
+    add_object(model, "vase", make_cylinder(30., 120., 2. * PI / 720.), Vec2d(100., 100.));
+}
+
+// 20 objects printed with 4 extruders and a wipe tower.
+void build_plate(Model &model)
+{
+    for (int i = 0; i < 20; ++ i) {
+        TriangleMesh mesh = (i % 2 == 0) ? make_cube(15., 15., 20.) : make_cylinder(7.5, 20., 2. * PI / 180.);
+        if (i % 2 == 0)
+            mesh.translate(-7.5f, -7.5f, 0.f);
+        ModelObject *object = add_object(model, "plate_" + std::to_string(i), mesh, Vec2d(20. + 30. * (i % 5), 20. + 30. * (i / 5)));
+        object->config.set("extruder", i % 4 + 1);
+    }
+}
+
+// Sphere of about 2M facets with a deterministic bumpy surface, mimicking a 3D scan.
+void build_scan(Model &model)
+{
+    TriangleMesh sphere = make_sphere(40., 2. * PI / 1414.);
+    sphere.require_shared_vertices();
+    indexed_triangle_set its = sphere.its;
+    for (stl_vertex &v : its.vertices) {
+        Vec3f p = v;
+        v = p * (1.f + 0.02f * std::sin(0.7f * p.x()) * std::sin(0.9f * p.y()) * std::sin(1.1f * p.z()));
+    }
+    TriangleMesh scan(its);
+    scan.repair();
+    add_object(model, "scan", scan, Vec2d(100., 100.));
+}
+
+// Small figure with overhangs for the SLA supports: a head on a body with outstretched arms.
+void build_sla_miniature(Model &model)
+{
+    TriangleMesh figure = make_cylinder(3., 15., 2. * PI / 90.);
+    TriangleMesh head   = make_sphere(4., 2. * PI / 90.);
+    head.translate(0.f, 0.f, 19.f);
+    TriangleMesh arms   = make_cube(20., 2., 2.);
+    arms.translate(-10.f, -1.f, 11.f);
+    figure.merge(head);
+    figure.merge(arms);
+    figure.repair();
+    add_object(model, "sla_miniature", figure, Vec2d(0., 0.));
+}
+
+const std::vector<BenchModel>& corpus()
+{
+    static const std::vector<BenchModel> models {
+        { "lattice",       ptFFF, { { "fill_density", "20%" }, { "support_material", "0" } }, build_lattice },
+        { "vase",          ptFFF, { { "spiral_vase", "1" }, { "perimeters", "1" }, { "top_solid_layers", "0" }, { "fill_density", "0%" } }, build_vase },
+        { "plate",         ptFFF, { { "nozzle_diameter", "0.4,0.4,0.4,0.4" }, { "wipe_tower", "1" }, { "wipe_tower_x", "170" }, { "wipe_tower_y", "150" } }, build_plate },
+        { "scan",          ptFFF, { { "support_material", "1" }, { "fill_density", "15%" } }, build_scan },
+        { "sla_miniature", ptSLA, { { "supports_enable", "1" }, { "pad_enable", "1" }, { "layer_height", "0.05" } }, build_sla_miniature },
+    };
+    return models;
+}
+
+// Samples of a stage of a model, one per repetition.
+struct Stage
+{
+    std::string                     model;
+    std::string                     name;
+    std::vector<PrintStepProfile>   samples;
+};
+
+class Results
+{
+public:
+    void add(const std::string &model, const std::string &name, const PrintStepProfile &profile)
+    {
+        auto it = std::find_if(m_stages.begin(), m_stages.end(), [&](const Stage &s) { return s.model == model && s.name == name; });
+        if (it == m_stages.end())
+            it = m_stages.insert(m_stages.end(), Stage{ model, name, {} });
+        it->samples.emplace_back(profile);
+    }
+
+    // Sum of the profiles of a step over all objects of a print.
+    template<typename StepEnum, class PrintType>
+    void add_objects(const std::string &model, const std::string &name, const PrintType &print, std::initializer_list<StepEnum> steps)
+    {
+        PrintStepProfile sum;
+        sum.finished = true;
+        for (const auto *object : print.objects())
+            for (StepEnum step : steps) {
+                const PrintStepProfile &p = object->step_profile(step);
+                sum.wall_time         += p.wall_time;
+                sum.cpu_time          += p.cpu_time;
+                sum.peak_memory_delta += p.peak_memory_delta;
+                sum.items             += p.items;
+                sum.finished          &= p.finished;
+            }
+        this->add(model, name, sum);
+    }
+
+    std::string json(size_t repeat) const
+    {
+        char buf[512];
+        sprintf(buf, "{\n  \"version\": \"%s\",\n  \"threads\": %d,\n  \"repeat\": %d,\n  \"results\": [", SLIC3R_VERSION_FULL, tbb::this_task_arena::max_concurrency(), int(repeat));
+        std::string out = buf;
+        for (size_t i = 0; i < m_stages.size(); ++ i) {
+            const Stage &stage = m_stages[i];
+            std::vector<double> wall, cpu;
+            size_t peak_memory_delta = 0;
+            for (const PrintStepProfile &p : stage.samples) {
+                wall.emplace_back(p.wall_time);
+                cpu.emplace_back(p.cpu_time);
+                peak_memory_delta = std::max(peak_memory_delta, p.peak_memory_delta);
+            }
+            std::sort(wall.begin(), wall.end());
+            std::sort(cpu.begin(), cpu.end());
+            sprintf(buf, "%s\n    { \"model\": \"%s\", \"stage\": \"%s\", \"wall_time_min\": %.6f, \"wall_time_median\": %.6f, \"cpu_time_median\": %.6f, \"peak_memory_delta\": %zu, \"items\": %zu }",
+                i == 0 ? "" : ",", stage.model.c_str(), stage.name.c_str(), wall.front(), wall[wall.size() / 2], cpu[cpu.size() / 2],
+                peak_memory_delta, stage.samples.back().items);
+            out += buf;
+        }
+        out += "\n  ]\n}\n";
+        return out;
+    }
+
+private:
+    std::vector<Stage> m_stages;
+};
+
+DynamicPrintConfig bench_config(const BenchModel &bench)
+{
+    DynamicPrintConfig config;
+    if (bench.technology == ptFFF)
+        config = DynamicPrintConfig::full_print_config();
+    else {
+        config.apply(SLAFullPrintConfig::defaults());
+        config.set_key_value("printer_technology", new ConfigOptionEnum<PrinterTechnology>(ptSLA));
+    }
+    for (const std::pair<std::string, std::string> &kv : bench.config)
+        config.set_deserialize_strict(kv.first, kv.second);
+    return config;
+}
+
+void validate(const PrintBase &print)
+{
+    std::pair<PrintBase::PrintValidationError, std::string> err = print.validate();
+    if (! err.second.empty())
+        throw Slic3r::RuntimeError(err.second);
+}
+
+void run_fff(const BenchModel &bench, Results &results)
+{
+    Model model;
+    bench.build(model);
+    DynamicPrintConfig config = bench_config(bench);
+
+    Print print;
+    print.apply(model, config);
+    validate(print);
+    print.set_status_silent();
+    print.process();
+
+    results.add_objects<PrintObjectStep>(bench.name, "slice",      print, { posSlice });
+    results.add_objects<PrintObjectStep>(bench.name, "perimeters", print, { posPerimeters });
+    results.add_objects<PrintObjectStep>(bench.name, "infill",     print, { posPrepareInfill, posInfill });
+    results.add_objects<PrintObjectStep>(bench.name, "support",    print, { posSupportMaterial });
+    results.add(bench.name, "skirt_brim_wipe_tower", [&print]() {
+        PrintStepProfile sum = print.step_profile(psWipeTower);
+        for (PrintStep step : { psSkirt, psBrim }) {
+            sum.wall_time += print.step_profile(step).wall_time;
+            sum.cpu_time  += print.step_profile(step).cpu_time;
+        }
+        return sum;
+    }());
+
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("slic3r_bench_%%%%-%%%%-%%%%.gcode")).string();
+    try {
+        PrintStepProfile gcode_export;
+        gcode_export.start();
+        path = print.export_gcode(path, nullptr);
+        gcode_export.stop(0);
+        results.add(bench.name, "gcode_export", gcode_export);
+
+        GCodeProcessor processor;
+        processor.apply_config(print.config());
+        PrintStepProfile gcode_processor;
+        gcode_processor.start();
+        processor.process_file(path, false);
+        gcode_processor.stop(0);
+        results.add(bench.name, "gcode_processor", gcode_processor);
+    } catch (...) {
+        boost::filesystem::remove(path);
+        throw;
+    }
+    boost::filesystem::remove(path);
+}
+
+void run_sla(const BenchModel &bench, Results &results)
+{
+    Model model;
+    bench.build(model);
+    DynamicPrintConfig config = bench_config(bench);
+
+    SLAPrint print;
+    print.set_printer(std::make_shared<SL1Archive>());
+    print.apply(model, config);
+    validate(print);
+    print.set_status_silent();
+    print.process();
+
+    results.add_objects<SLAPrintObjectStep>(bench.name, "hollow_drill",   print, { slaposHollowing, slaposDrillHoles });
+    results.add_objects<SLAPrintObjectStep>(bench.name, "slice",          print, { slaposObjectSlice });
+    results.add_objects<SLAPrintObjectStep>(bench.name, "support_points", print, { slaposSupportPoints });
+    results.add_objects<SLAPrintObjectStep>(bench.name, "support_tree",   print, { slaposSupportTree, slaposPad, slaposSliceSupports });
+    results.add(bench.name, "merge_slices", print.step_profile(slapsMergeSlicesAndEval));
+    results.add(bench.name, "rasterize",    print.step_profile(slapsRasterize));
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    size_t                   repeat = 3;
+    std::string              output;
+    std::vector<std::string> names;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+            repeat = size_t(std::max(1, std::atoi(argv[++ i])));
+        else if (arg == "--output" && i + 1 < argc)
+            output = argv[++ i];
+        else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: slic3r_bench [--repeat N] [--output results.json] [model ...]" << std::endl << "Models:";
+            for (const BenchModel &bench : corpus())
+                std::cout << " " << bench.name;
+            std::cout << std::endl;
+            return EXIT_SUCCESS;
+        } else
+            names.emplace_back(arg);
+    }
+
+    for (const std::string &name : names)
+        if (std::none_of(corpus().begin(), corpus().end(), [&name](const BenchModel &bench) { return bench.name == name; })) {
+            std::cerr << "Unknown model " << name << std::endl;
+            return EXIT_FAILURE;
+        }
+
+    Results results;
+    try {
+        for (const BenchModel &bench : corpus()) {
+            if (! names.empty() && std::find(names.begin(), names.end(), bench.name) == names.end())
+                continue;
+            for (size_t i = 0; i < repeat; ++ i) {
+                std::cerr << "Running " << bench.name << " " << (i + 1) << "/" << repeat << std::endl;
+                if (bench.technology == ptFFF)
+                    run_fff(bench, results);
+                else
+                    run_sla(bench, results);
+            }
+        }
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string json = results.json(repeat);
+    if (output.empty())
+        std::cout << json;
+    else {
+        boost::nowide::ofstream file(output);
+        file << json;
+        if (! file) {
+            std::cerr << "Failed to write " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
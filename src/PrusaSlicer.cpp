@@ -17,10 +17,15 @@
     #endif /* SLIC3R_GUI */
 #endif /* WIN32 */
 
+#include <atomic>
+#include <sstream>
+#include <thread>
+
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/cenv.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <boost/nowide/iostream.hpp>
 #include <boost/nowide/integration/filesystem.hpp>
 
@@ -35,6 +40,7 @@
 #include "libslic3r/Platform.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SLAPrint.hpp"
+#include "libslic3r/SlicesCache.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/AMF.hpp"
 #include "libslic3r/Format/3mf.hpp"
@@ -45,6 +51,7 @@
 #include "libslic3r/Format/CWS.hpp"
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/Thread.hpp"
+#include "libslic3r/Tracing.hpp"
 
 #include "PrusaSlicer.hpp"
 
@@ -92,6 +99,14 @@ int CLI::run(int argc, char **argv)
 	if (! this->setup(argc, argv))
 		return 1;
 
+    if (std::find(m_actions.begin(), m_actions.end(), "server") != m_actions.end()) {
+        if (m_server_job) {
+            boost::nowide::cerr << "error: a server job cannot start another server" << std::endl;
+            return 1;
+        }
+        return this->run_server(argv[0]);
+    }
+
     m_extra_config.apply(m_config, true);
     m_extra_config.normalize_fdm();
     
@@ -167,7 +182,7 @@ int CLI::run(int argc, char **argv)
         for (const std::string& file : m_input_files) {
             if (!boost::filesystem::exists(file)) {
                 boost::nowide::cerr << "No such file: " << file << std::endl;
-                exit(1);
+                return 1;
             }
             Model model;
             try {
@@ -450,11 +465,19 @@ int CLI::run(int argc, char **argv)
                 boost::nowide::cerr << "error: cannot export SLA slices for a SLA configuration" << std::endl;
                 return 1;
             }
+            if (printer_technology == ptSLA) {
+                // The default for "output_filename_format" is good for FDM: "[input_filename_base].gcode"
+                // Replace it with a reasonable SLA default.
+                std::string &format = m_print_config.opt_string("output_filename_format", true);
+                if (format == static_cast<const ConfigOptionString*>(m_print_config.def()->get("output_filename_format")->default_value.get())->value)
+                    format = "[input_filename_base].SL1";
+            }
             // Make a copy of the model if the current action is not the last action, as the model may be
             // modified by the centering and such.
-            Model model_copy;
             bool  make_copy = &opt_key != &m_actions.back();
-            for (Model &model_in : m_models) {
+            // Slices a single input model into its own output file, returns the exit code.
+            auto  slice_model = [&](Model &model_in) -> int {
+                Model model_copy;
                 if (make_copy)
                     model_copy = model_in;
                 Model &model = make_copy ? model_copy : model_in;
@@ -467,6 +490,9 @@ int CLI::run(int argc, char **argv)
                 SLAPrint    sla_print;
                 std::shared_ptr<SLAArchive> sla_archive = Slic3r::get_output_format(m_print_config);
 
+                // The CLI exports the layers right after slicing, rasterize them while exporting to keep the memory bounded.
+                if (sla_archive)
+                    sla_archive->set_streamed_export(true);
                 sla_print.set_printer(sla_archive);
                 sla_print.set_status_callback(
                             [](const PrintBase::SlicingStatus& s)
@@ -499,12 +525,6 @@ int CLI::run(int argc, char **argv)
                 if (printer_technology == ptFFF) {
                     for (auto* mo : model.objects)
                         fff_print.auto_assign_extruders(mo);
-                } else {
-                    // The default for "output_filename_format" is good for FDM: "[input_filename_base].gcode"
-                    // Replace it with a reasonable SLA default.
-                    std::string &format = m_print_config.opt_string("output_filename_format", true);
-                    if (format == static_cast<const ConfigOptionString*>(m_print_config.def()->get("output_filename_format")->default_value.get())->value)
-                        format = "[input_filename_base].SL1";
                 }
                 print->apply(model, m_print_config);
                 std::pair<PrintBase::PrintValidationError, std::string> err = print->validate();
@@ -512,11 +532,36 @@ int CLI::run(int argc, char **argv)
                     boost::nowide::cerr << err.second << std::endl;
                     return 1;
                 }
+                if (const std::string &worker = m_config.opt_string("slices_cache_worker"); ! worker.empty()) {
+                    unsigned int worker_id = 0, num_workers = 0;
+                    char         separator = 0;
+                    std::istringstream ss(worker);
+                    if (! (ss >> worker_id >> separator >> num_workers) || separator != '/' || worker_id >= num_workers || ! ss.eof()) {
+                        boost::nowide::cerr << "error: invalid --slices-cache-worker " << worker << ", expected index/count" << std::endl;
+                        return 1;
+                    }
+                    if (printer_technology != ptFFF || m_config.opt_string("slices_cache").empty()) {
+                        boost::nowide::cerr << "error: --slices-cache-worker requires an FFF configuration and --slices-cache" << std::endl;
+                        return 1;
+                    }
+                    try {
+                        fff_print.process_objects_of_worker(worker_id, num_workers);
+                    } catch (const std::exception &ex) {
+                        boost::nowide::cerr << ex.what() << std::endl;
+                        return 1;
+                    }
+                    boost::nowide::cout << "Objects of the worker " << worker << " stored into " << m_config.opt_string("slices_cache") << std::endl;
+                    return 0;
+                }
                 if (print->empty())
                     boost::nowide::cout << "Nothing to print for " << outfile << " . Either the print is empty or no object is fully inside the print volume." << std::endl;
                 else
                     try {
                         std::string outfile_final;
+                        const std::string &trace_file = m_config.opt_string("trace");
+                        if (! trace_file.empty())
+                            tracing::start();
+                        fff_print.set_release_intermediates(m_config.opt_bool("release_intermediates"));
                         print->process();
                         if (printer_technology == ptFFF) {
                             // The outfile is processed by a PlaceholderParser.
@@ -538,6 +583,22 @@ int CLI::run(int argc, char **argv)
                         // Run the post-processing scripts if defined.
                         run_post_process_scripts(outfile, fff_print.full_print_config());
                         boost::nowide::cout << "Slicing result exported to " << outfile << std::endl;
+                        if (! trace_file.empty()) {
+                            tracing::stop();
+                            if (! tracing::write_chrome_trace(trace_file)) {
+                                boost::nowide::cerr << "Failed to write the trace to " << trace_file << std::endl;
+                                return 1;
+                            }
+                        }
+                        const std::string &step_profile = m_config.opt_string("step_profile");
+                        if (! step_profile.empty()) {
+                            boost::nowide::ofstream file(step_profile);
+                            file << print->step_profiles_json();
+                            if (! file) {
+                                boost::nowide::cerr << "Failed to write the step profile to " << step_profile << std::endl;
+                                return 1;
+                            }
+                        }
                     } catch (const std::exception &ex) {
                         boost::nowide::cerr << ex.what() << std::endl;
                         return 1;
@@ -572,6 +633,34 @@ int CLI::run(int argc, char **argv)
                     << "Filament required: " << print.total_used_filament() << "mm"
                     << " (" << print.total_extruded_volume()/1000 << "cm3)" << std::endl;
 */
+                return 0;
+            };
+            const size_t batch_jobs = size_t(std::max(1, m_config.opt_int("batch_jobs")));
+            if (batch_jobs == 1 || m_models.size() < 2) {
+                for (Model &model_in : m_models)
+                    if (int ret = slice_model(model_in); ret != 0)
+                        return ret;
+            } else {
+                if (! m_config.opt_string("trace").empty() || ! m_config.opt_string("step_profile").empty()) {
+                    boost::nowide::cerr << "error: --trace and --step-profile are not supported with --batch-jobs" << std::endl;
+                    return 1;
+                }
+                // Slice several input files at once, each job runs its parallel steps on the shared thread pool.
+                // Name the threads of the pool before the jobs start, naming them from several jobs at once would race.
+                name_tbb_thread_pool_threads();
+                std::atomic<size_t> next_model(0);
+                std::atomic<int>    ret(0);
+                std::vector<std::thread> threads;
+                for (size_t i = 0; i < std::min(batch_jobs, m_models.size()); ++ i)
+                    threads.emplace_back([&slice_model, &next_model, &ret, this]() {
+                        for (size_t idx; ret == 0 && (idx = next_model ++) < m_models.size();)
+                            if (int r = slice_model(m_models[idx]); r != 0)
+                                ret = r;
+                    });
+                for (std::thread &thread : threads)
+                    thread.join();
+                if (ret != 0)
+                    return ret;
             }
         } else {
             boost::nowide::cerr << "error: option not supported yet: " << opt_key << std::endl;
@@ -579,6 +668,11 @@ int CLI::run(int argc, char **argv)
         }
     }
 
+    if (start_gui && m_server_job) {
+        boost::nowide::cerr << "error: no action to run" << std::endl;
+        return 1;
+    }
+
     if (start_gui) {
 #ifdef SLIC3R_GUI
         Slic3r::GUI::GUI_InitParams params;
@@ -600,6 +694,64 @@ int CLI::run(int argc, char **argv)
     return 0;
 }
 
+// Splits a line into the arguments separated by white spaces. An argument may be enclosed in double quotes, a backslash escapes the next character.
+static std::vector<std::string> split_server_job(const std::string &line)
+{
+    std::vector<std::string> args;
+    std::string              arg;
+    bool                     in_arg    = false;
+    bool                     in_quotes = false;
+    for (size_t i = 0; i < line.size(); ++ i) {
+        char c = line[i];
+        if (c == '\\' && i + 1 < line.size()) {
+            arg += line[++ i];
+            in_arg = true;
+        } else if (c == '"') {
+            in_quotes = ! in_quotes;
+            in_arg    = true;
+        } else if (! in_quotes && (c == ' ' || c == '\t' || c == '\r')) {
+            if (in_arg)
+                args.emplace_back(std::move(arg));
+            arg.clear();
+            in_arg = false;
+        } else {
+            arg += c;
+            in_arg = true;
+        }
+    }
+    if (in_arg)
+        args.emplace_back(std::move(arg));
+    return args;
+}
+
+int CLI::run_server(const char *argv0)
+{
+    boost::nowide::cout << "ready" << std::endl;
+    std::string line;
+    while (std::getline(boost::nowide::cin, line)) {
+        std::vector<std::string> args = split_server_job(line);
+        if (args.empty())
+            continue;
+        args.insert(args.begin(), argv0);
+        std::vector<char*> argv;
+        argv.reserve(args.size() + 1);
+        for (std::string &arg : args)
+            argv.emplace_back(arg.data());
+        argv.emplace_back(nullptr);
+        int ret = 1;
+        try {
+            // Each job starts with a clean state, only the static configuration definitions and the thread pool are shared.
+            CLI job;
+            job.m_server_job = true;
+            ret = job.run(int(args.size()), argv.data());
+        } catch (const std::exception &ex) {
+            boost::nowide::cerr << ex.what() << std::endl;
+        }
+        boost::nowide::cout << "done " << ret << std::endl;
+    }
+    return 0;
+}
+
 bool CLI::setup(int argc, char **argv)
 {
     {
@@ -674,6 +826,8 @@ bool CLI::setup(int argc, char **argv)
             m_config.option(optdef.first, true);
 
     set_data_dir(m_config.opt_string("datadir"));
+    if (const std::string &dir = m_config.opt_string("slices_cache"); ! dir.empty())
+        SlicesCache::instance().set_directory(dir);
     
     if (!validity.empty()) {
         boost::nowide::cerr << "error: " << validity << std::endl;
@@ -31,8 +31,13 @@ private:
     std::vector<std::string>    m_actions;
     std::vector<std::string>    m_transforms;
     std::vector<Model>          m_models;
+    // Job of the server mode, which shall never start the GUI.
+    bool                        m_server_job { false };
 
     bool setup(int argc, char **argv);
+
+    /// Runs the jobs read line by line from the standard input with the configuration definitions and the thread pool initialized.
+    int run_server(const char *argv0);
     
     /// Prints usage of the CLI.
     void print_help(bool include_print_options = false, PrinterTechnology printer_technology = ptFFF | ptSLA | ptSLS) const;
@@ -25,9 +25,7 @@
 #include <string.h>
 #include <math.h>
 
-// Boost pool: Don't use mutexes to synchronize memory allocation.
-#define BOOST_POOL_NO_MT
-#include <boost/pool/object_pool.hpp>
+#include <vector>
 
 #include "stl.h"
 
@@ -65,11 +63,9 @@ static void reverse_facet(stl_file *stl, int facet_num)
 	stl->neighbors_start[facet_num].which_vertex_not[2] = (stl->neighbors_start[facet_num].which_vertex_not[2] + 3) % 6;
 }
 
-// Returns true if the normal was flipped.
-static bool check_normal_vector(stl_file *stl, int facet_num, int normal_fix_flag)
+// Returns true if the normal was flipped. Counts the fixed normals into normals_fixed.
+static bool check_normal_vector(stl_facet *facet, int normal_fix_flag, int &normals_fixed)
 {
-	stl_facet *facet = &stl->facet_start[facet_num];
-
 	stl_normal normal;
 	stl_calculate_normal(normal, facet);
 	stl_normalize_vector(normal);
@@ -89,7 +85,7 @@ static bool check_normal_vector(stl_file *stl, int facet_num, int normal_fix_fla
 		// The normal is not within tolerance, but direction is OK.
 		if (normal_fix_flag) {
 	  		facet->normal = normal;
-	  		++ stl->stats.normals_fixed;
+	  		++ normals_fixed;
 		}
 		return false;
 	}
@@ -100,13 +96,13 @@ static bool check_normal_vector(stl_file *stl, int facet_num, int normal_fix_fla
 		// The normal is not within tolerance and backwards.
 		if (normal_fix_flag) {
 	  		facet->normal = normal;
-	  		++ stl->stats.normals_fixed;
+	  		++ normals_fixed;
 		}
 		return true;
 	}
 	if (normal_fix_flag) {
 		facet->normal = normal;
-		++ stl->stats.normals_fixed;
+		++ normals_fixed;
 	}
 	// Status is unknown.
 	return false;
@@ -118,17 +114,8 @@ void stl_fix_normal_directions(stl_file *stl)
   	if (stl->stats.number_of_facets == 0)
   		return;
 
-	struct stl_normal {
-    	int         facet_num;
-    	stl_normal *next;
-  	};
-
-  	// Initialize linked list.
-  	boost::object_pool<stl_normal> pool;
-   	stl_normal *head = pool.construct();
-  	stl_normal *tail = pool.construct();
-	head->next = tail;
-	tail->next = tail;
+	// Stack of the facets to be fixed, the last one added is fixed first.
+	std::vector<int> facets_to_fix;
 
 	// Initialize list that keeps track of already fixed facets.
 	std::vector<char> norm_sw(stl->stats.number_of_facets, 0);
@@ -140,7 +127,8 @@ void stl_fix_normal_directions(stl_file *stl)
   	// If normal vector is not within tolerance and backwards:
     // Arbitrarily starts at face 0.  If this one is wrong, we're screwed. Thankfully, the chances
     // of it being wrong randomly are low if most of the triangles are right:
-  	if (check_normal_vector(stl, 0, 0)) {
+  	int normals_fixed = 0;
+  	if (check_normal_vector(&stl->facet_start[0], 0, normals_fixed)) {
     	reverse_facet(stl, 0);
       	reversed_ids.emplace_back(0);
   	}
@@ -148,6 +136,8 @@ void stl_fix_normal_directions(stl_file *stl)
   	// Say that we've fixed this facet:
   	norm_sw[facet_num] = 1;
 	int checked = 1;
+	// All the facets before first_unchecked were already fixed, the search for the next part continues from there.
+	uint32_t first_unchecked = 1;
 
   	for (;;) {
     	// Add neighbors_to_list. Add unconnected neighbors to the list.
@@ -173,10 +163,7 @@ void stl_fix_normal_directions(stl_file *stl)
         		// If we haven't fixed this facet yet, add it to the list:
         		if (norm_sw[stl->neighbors_start[facet_num].neighbor[j]] != 1) {
 	          		// Add node to beginning of list.
-	          		stl_normal *newn = pool.construct();
-	          		newn->facet_num = stl->neighbors_start[facet_num].neighbor[j];
-	          		newn->next = head->next;
-	          		head->next = newn;
+	          		facets_to_fix.emplace_back(stl->neighbors_start[facet_num].neighbor[j]);
 	        	}
 	      	}
 	    }
@@ -186,27 +173,26 @@ void stl_fix_normal_directions(stl_file *stl)
     		break;
 
     	// Get next facet to fix from top of list.
-    	if (head->next != tail) {
-      		facet_num = head->next->facet_num;
+    	if (! facets_to_fix.empty()) {
+      		facet_num = facets_to_fix.back();
             assert(facet_num < stl->stats.number_of_facets);
       		if (norm_sw[facet_num] != 1) { // If facet is in list mutiple times
         		norm_sw[facet_num] = 1; // Record this one as being fixed.
         		++ checked;
       		}
-      		stl_normal *temp = head->next;	// Delete this facet from the list.
-      		head->next = head->next->next;
-      		// pool.destroy(temp);
+      		facets_to_fix.pop_back();	// Delete this facet from the list.
     	} else { // If we ran out of facets to fix: All of the facets in this part have been fixed.
       		++ stl->stats.number_of_parts;
       		if (checked >= stl->stats.number_of_facets)
         		// All of the facets have been checked.  Bail out.
         		break;
     		// There is another part here.  Find it and continue.
-    		for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i)
+    		for (uint32_t i = first_unchecked; i < stl->stats.number_of_facets; ++ i)
       			if (norm_sw[i] == 0) {
         			// This is the first facet of the next part.
         			facet_num = i;
-        			if (check_normal_vector(stl, i, 0)) {
+        			first_unchecked = i + 1;
+        			if (check_normal_vector(&stl->facet_start[i], 0, normals_fixed)) {
             			reverse_facet(stl, i);
             			reversed_ids.emplace_back(i);
         			}
@@ -216,15 +202,19 @@ void stl_fix_normal_directions(stl_file *stl)
       			}
     	}
   	}
+}
 
-	// pool.destroy(head);
-	// pool.destroy(tail);
+int stl_fix_normal_values(stl_file *stl, uint32_t facet_begin, uint32_t facet_end)
+{
+	int normals_fixed = 0;
+	for (uint32_t i = facet_begin; i < facet_end; ++ i)
+    	check_normal_vector(&stl->facet_start[i], 1, normals_fixed);
+	return normals_fixed;
 }
 
 void stl_fix_normal_values(stl_file *stl)
 {
-	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i)
-    	check_normal_vector(stl, i, 1);
+	stl->stats.normals_fixed += stl_fix_normal_values(stl, 0, stl->stats.number_of_facets);
 }
 
 void stl_reverse_all_facets(stl_file *stl)
@@ -170,6 +170,9 @@ extern void stl_verify_neighbors(stl_file *stl);
 extern void stl_fill_holes(stl_file *stl);
 extern void stl_fix_normal_directions(stl_file *stl);
 extern void stl_fix_normal_values(stl_file *stl);
+// Fixes the normals of the facets in <facet_begin, facet_end) and returns the number of the fixed normals without updating stl->stats,
+// thus disjoint ranges of facets may be processed in parallel.
+extern int  stl_fix_normal_values(stl_file *stl, uint32_t facet_begin, uint32_t facet_end);
 extern void stl_reverse_all_facets(stl_file *stl);
 extern void stl_translate(stl_file *stl, float x, float y, float z);
 extern void stl_translate_relative(stl_file *stl, float x, float y, float z);
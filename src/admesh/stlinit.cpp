@@ -26,6 +26,9 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
@@ -40,6 +43,18 @@
 extern void stl_internal_reverse_quads(char *buf, size_t cnt);
 #endif /* BOOST_ENDIAN_BIG_BYTE */
 
+// Size of a file, which may be larger than 2 GB. Leaves the file position at the end of the file.
+static int64_t stl_file_size(FILE *fp)
+{
+#ifdef _WIN32
+	_fseeki64(fp, 0, SEEK_END);
+	return _ftelli64(fp);
+#else
+	fseeko(fp, 0, SEEK_END);
+	return ftello(fp);
+#endif
+}
+
 static FILE* stl_open_count_facets(stl_file *stl, const char *file) 
 {
   	// Open the file in binary mode first.
@@ -49,8 +64,7 @@ static FILE* stl_open_count_facets(stl_file *stl, const char *file)
     	return nullptr;
   	}
   	// Find size of file.
-  	fseek(fp, 0, SEEK_END);
-  	long file_size = ftell(fp);
+  	int64_t file_size = stl_file_size(fp);
 
   	// Check for binary or ASCII file.
   	fseek(fp, HEADER_SIZE, SEEK_SET);
@@ -143,66 +157,82 @@ static FILE* stl_open_count_facets(stl_file *stl, const char *file)
 /* Reads the contents of the file pointed to by fp into the stl structure,
    starting at facet first_facet.  The second argument says if it's our first
    time running this for the stl and therefore we should reset our max and min stats. */
+static bool stl_read_binary(stl_file *stl, FILE *fp, int first_facet, bool first)
+{
+	fseek(fp, HEADER_SIZE, SEEK_SET);
+	// Read the facets by large blocks instead of one fread() per facet, the scanned meshes have tens of millions of facets.
+	static constexpr uint32_t block_facets = 65536;
+	std::vector<char> buf(size_t(block_facets) * SIZEOF_STL_FACET);
+	for (uint32_t i = first_facet; i < stl->stats.number_of_facets;) {
+		uint32_t cnt = std::min(block_facets, stl->stats.number_of_facets - i);
+		if (fread(buf.data(), SIZEOF_STL_FACET, cnt, fp) != cnt)
+			return false;
+#if BOOST_ENDIAN_BIG_BYTE
+		for (uint32_t j = 0; j < cnt; ++ j)
+			// Convert the loaded little endian data to big endian.
+			stl_internal_reverse_quads(buf.data() + size_t(j) * SIZEOF_STL_FACET, 48);
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+		for (uint32_t j = 0; j < cnt; ++ j, ++ i) {
+			stl_facet &facet = stl->facet_start[i];
+			memcpy(&facet, buf.data() + size_t(j) * SIZEOF_STL_FACET, SIZEOF_STL_FACET);
+			stl_facet_stats(stl, facet, first);
+		}
+	}
+
+  	stl->stats.size = stl->stats.max - stl->stats.min;
+  	stl->stats.bounding_diameter = stl->stats.size.norm();
+  	return true;
+}
+
 static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first)
 {
 	if (stl->stats.type == binary)
-    	fseek(fp, HEADER_SIZE, SEEK_SET);
-  	else
-    	rewind(fp);
+		return stl_read_binary(stl, fp, first_facet, first);
+	rewind(fp);
 
   	char normal_buf[3][32];
   	for (uint32_t i = first_facet; i < stl->stats.number_of_facets; ++ i) {
   	  	stl_facet facet;
 
-    	if (stl->stats.type == binary) {
-      		// Read a single facet from a binary .STL file. We assume little-endian architecture!
-      		if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET)
-      			return false;
-#if BOOST_ENDIAN_BIG_BYTE
-      		// Convert the loaded little endian data to big endian.
-      		stl_internal_reverse_quads((char*)&facet, 48);
-#endif /* BOOST_ENDIAN_BIG_BYTE */
-    	} else {
-			// Read a single facet from an ASCII .STL file
-			// skip solid/endsolid
-			// (in this order, otherwise it won't work when they are paired in the middle of a file)
-			fscanf(fp, " endsolid%*[^\n]\n");
-			fscanf(fp, " solid%*[^\n]\n");  // name might contain spaces so %*s doesn't work and it also can be empty (just "solid")
-			// Leading space in the fscanf format skips all leading white spaces including numerous new lines and tabs.
-			int res_normal     = fscanf(fp, " facet normal %31s %31s %31s", normal_buf[0], normal_buf[1], normal_buf[2]);
-			assert(res_normal == 3);
-			int res_outer_loop = fscanf(fp, " outer loop");
-			assert(res_outer_loop == 0);
-			int res_vertex1    = fscanf(fp, " vertex %f %f %f", &facet.vertex[0](0), &facet.vertex[0](1), &facet.vertex[0](2));
-			assert(res_vertex1 == 3);
-			int res_vertex2    = fscanf(fp, " vertex %f %f %f", &facet.vertex[1](0), &facet.vertex[1](1), &facet.vertex[1](2));
-			assert(res_vertex2 == 3);
-			// Trailing whitespace is there to eat all whitespaces and empty lines up to the next non-whitespace.
-			int res_vertex3    = fscanf(fp, " vertex %f %f %f ", &facet.vertex[2](0), &facet.vertex[2](1), &facet.vertex[2](2));
-			assert(res_vertex3 == 3);
-			// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
-			char buf[2048];
-			fgets(buf, 2047, fp);
-			bool endloop_ok = strncmp(buf, "endloop", 7) == 0 && (buf[7] == '\r' || buf[7] == '\n' || buf[7] == ' ' || buf[7] == '\t');
-			assert(endloop_ok);
-			// Skip the trailing whitespaces and empty lines.
-			fscanf(fp, " ");
-			fgets(buf, 2047, fp);
-			bool endfacet_ok = strncmp(buf, "endfacet", 8) == 0 && (buf[8] == '\r' || buf[8] == '\n' || buf[8] == ' ' || buf[8] == '\t');
-			assert(endfacet_ok);
-			if (res_normal != 3 || res_outer_loop != 0 || res_vertex1 != 3 || res_vertex2 != 3 || res_vertex3 != 3 || ! endloop_ok || ! endfacet_ok) {
-				BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
-				return false;
-			}
-
-			// The facet normal has been parsed as a single string as to workaround for not a numbers in the normal definition.
-			if (sscanf(normal_buf[0], "%f", &facet.normal(0)) != 1 ||
-			    sscanf(normal_buf[1], "%f", &facet.normal(1)) != 1 ||
-			    sscanf(normal_buf[2], "%f", &facet.normal(2)) != 1) {
-			    // Normal was mangled. Maybe denormals or "not a number" were stored?
-			  	// Just reset the normal and silently ignore it.
-			  	memset(&facet.normal, 0, sizeof(facet.normal));
-			}
+		// Read a single facet from an ASCII .STL file
+		// skip solid/endsolid
+		// (in this order, otherwise it won't work when they are paired in the middle of a file)
+		fscanf(fp, " endsolid%*[^\n]\n");
+		fscanf(fp, " solid%*[^\n]\n");  // name might contain spaces so %*s doesn't work and it also can be empty (just "solid")
+		// Leading space in the fscanf format skips all leading white spaces including numerous new lines and tabs.
+		int res_normal     = fscanf(fp, " facet normal %31s %31s %31s", normal_buf[0], normal_buf[1], normal_buf[2]);
+		assert(res_normal == 3);
+		int res_outer_loop = fscanf(fp, " outer loop");
+		assert(res_outer_loop == 0);
+		int res_vertex1    = fscanf(fp, " vertex %f %f %f", &facet.vertex[0](0), &facet.vertex[0](1), &facet.vertex[0](2));
+		assert(res_vertex1 == 3);
+		int res_vertex2    = fscanf(fp, " vertex %f %f %f", &facet.vertex[1](0), &facet.vertex[1](1), &facet.vertex[1](2));
+		assert(res_vertex2 == 3);
+		// Trailing whitespace is there to eat all whitespaces and empty lines up to the next non-whitespace.
+		int res_vertex3    = fscanf(fp, " vertex %f %f %f ", &facet.vertex[2](0), &facet.vertex[2](1), &facet.vertex[2](2));
+		assert(res_vertex3 == 3);
+		// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
+		char buf[2048];
+		fgets(buf, 2047, fp);
+		bool endloop_ok = strncmp(buf, "endloop", 7) == 0 && (buf[7] == '\r' || buf[7] == '\n' || buf[7] == ' ' || buf[7] == '\t');
+		assert(endloop_ok);
+		// Skip the trailing whitespaces and empty lines.
+		fscanf(fp, " ");
+		fgets(buf, 2047, fp);
+		bool endfacet_ok = strncmp(buf, "endfacet", 8) == 0 && (buf[8] == '\r' || buf[8] == '\n' || buf[8] == ' ' || buf[8] == '\t');
+		assert(endfacet_ok);
+		if (res_normal != 3 || res_outer_loop != 0 || res_vertex1 != 3 || res_vertex2 != 3 || res_vertex3 != 3 || ! endloop_ok || ! endfacet_ok) {
+			BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
+			return false;
+		}
+
+		// The facet normal has been parsed as a single string as to workaround for not a numbers in the normal definition.
+		if (sscanf(normal_buf[0], "%f", &facet.normal(0)) != 1 ||
+		    sscanf(normal_buf[1], "%f", &facet.normal(1)) != 1 ||
+		    sscanf(normal_buf[2], "%f", &facet.normal(2)) != 1) {
+		    // Normal was mangled. Maybe denormals or "not a number" were stored?
+		  	// Just reset the normal and silently ignore it.
+		  	memset(&facet.normal, 0, sizeof(facet.normal));
 		}
 
 #if 0
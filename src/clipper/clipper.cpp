@@ -741,7 +741,7 @@ TEdge* ClipperBase::ProcessBound(TEdge* E, bool NextIsForward)
 }
 //------------------------------------------------------------------------------
 
-bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
+bool ClipperBase::AddPath(const PathView &pg, PolyType PolyTyp, bool Closed)
 {
   CLIPPERLIB_PROFILE_FUNC();
   // Remove duplicate end point from a closed input path.
@@ -765,13 +765,14 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   return result;
 }
 
-bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
+template<typename PathsType>
+bool ClipperBase::AddPathsInternal(const PathsType &ppg, PolyType PolyTyp, bool Closed)
 {
   CLIPPERLIB_PROFILE_FUNC();
   std::vector<int> num_edges(ppg.size(), 0);
   int num_edges_total = 0;
   for (size_t i = 0; i < ppg.size(); ++ i) {
-    const Path &pg = ppg[i];
+    const auto &pg = ppg[i];
     // Remove duplicate end point from a closed input path.
     // Remove duplicate points from the end of the input path.
     int highI = (int)pg.size() -1;
@@ -793,7 +794,7 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
   // Fill in the edge array.
   bool result = false;
   TEdge *p_edge = edges.data();
-  for (Paths::size_type i = 0; i < ppg.size(); ++i)
+  for (size_t i = 0; i < ppg.size(); ++i)
     if (num_edges[i]) {
       bool res = AddPathInternal(ppg[i], num_edges[i] - 1, PolyTyp, Closed, p_edge);
       if (res) {
@@ -807,7 +808,17 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
   return result;
 }
 
-bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
+bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
+{
+  return AddPathsInternal(ppg, PolyTyp, Closed);
+}
+
+bool ClipperBase::AddPaths(const PathViews &ppg, PolyType PolyTyp, bool Closed)
+{
+  return AddPathsInternal(ppg, PolyTyp, Closed);
+}
+
+bool ClipperBase::AddPathInternal(const PathView &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
   CLIPPERLIB_PROFILE_FUNC();
 #ifdef use_lines
@@ -102,6 +102,22 @@ struct IntPoint {
 typedef std::vector< IntPoint > Path;
 typedef std::vector< Path > Paths;
 
+// Non-owning view of a contiguous sequence of points with the memory layout of IntPoint.
+// Allows the caller to feed the Clipper with the points of its own point type without copying them into a Path.
+struct PathView
+{
+  PathView() : points(nullptr), count(0) {}
+  PathView(const IntPoint *points, size_t count) : points(points), count(count) {}
+  PathView(const Path &path) : points(path.data()), count(path.size()) {}
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const IntPoint& operator[](size_t idx) const { return points[idx]; }
+
+  const IntPoint *points;
+  size_t          count;
+};
+typedef std::vector< PathView > PathViews;
+
 inline Path& operator <<(Path& poly, const IntPoint& p) {poly.push_back(p); return poly;}
 inline Paths& operator <<(Paths& polys, const Path& p) {polys.push_back(p); return polys;}
 
@@ -292,8 +308,10 @@ class ClipperBase
 public:
   ClipperBase() : m_UseFullRange(false), m_HasOpenPaths(false) {}
   ~ClipperBase() { Clear(); }
-  bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
+  bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed) { return AddPath(PathView(pg), PolyTyp, Closed); }
+  bool AddPath(const PathView &pg, PolyType PolyTyp, bool Closed);
   bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
+  bool AddPaths(const PathViews &ppg, PolyType PolyTyp, bool Closed);
   void Clear();
   IntRect GetBounds();
   // By default, when three or more vertices are collinear in input polygons (subject or clip), the Clipper object removes the 'inner' vertices before clipping.
@@ -301,7 +319,9 @@ public:
   bool PreserveCollinear() const {return m_PreserveCollinear;};
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
-  bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  template<typename PathsType>
+  bool AddPathsInternal(const PathsType &ppg, PolyType PolyTyp, bool Closed);
+  bool AddPathInternal(const PathView &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
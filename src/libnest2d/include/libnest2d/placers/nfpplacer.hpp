@@ -8,6 +8,9 @@
 #include <iterator>
 #include <future>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -169,6 +172,13 @@ struct NfpPConfig {
 
     std::function<void(const ItemGroup &, NfpPConfig &config)> on_preload;
 
+    /**
+     * @brief A predicate checked while searching for the position of an item.
+     * If it returns true, the search stops and the best position found so far
+     * is used. It is called from the worker threads and has to be cheap.
+     */
+    std::function<bool()> stop_condition;
+
     NfpPConfig(): rotations({0.0, Pi/2.0, Pi, 3*Pi/2}),
         alignment(Alignment::CENTER), starting_point(Alignment::CENTER) {}
 };
@@ -491,11 +501,18 @@ private:
     const double norm_;
     Pile merged_pile_;
 
+    class NfpCache;
+
+    // Shared between the copies of the placer, the cached nfps do not depend
+    // on the contents of the bin.
+    std::shared_ptr<NfpCache> nfp_cache_;
+
 public:
 
     inline explicit _NofitPolyPlacer(const BinType& bin):
         Base(bin),
-        norm_(std::sqrt(sl::area(bin)))
+        norm_(std::sqrt(sl::area(bin))),
+        nfp_cache_(std::make_shared<NfpCache>())
     {
         // In order to not have items out of bin, it will be shrinked by an
         // very little empiric offset value.
@@ -589,6 +606,120 @@ private:
 
     using Shapes = TMultiShape<RawShape>;
 
+    // The nfp of two items depends only on their shapes after the inflation
+    // and rotation. Translating the stationary item translates the nfp by the
+    // same integer offset and the translation of the orbiting item does not
+    // matter at all. Arrangements usually contain many instances of the same
+    // object, so the nfps are cached for each pair of distinct transformed
+    // shapes and stored relative to the translation of the stationary item.
+    class NfpCache {
+        struct Entry {
+            RawShape fixed_sh, orbiter_sh;
+            double fixed_rot, orbiter_rot;
+            Coord fixed_infl, orbiter_infl;
+            RawShape nfp;
+        };
+
+        // Keep the memory bounded for arrangements of many distinct objects.
+        static const size_t MaxEntries = 50000;
+
+        std::unordered_map<size_t, std::vector<Entry>> entries_;
+        size_t count_ = 0;
+        std::mutex mutex_;
+
+        static bool equal(const TContour<RawShape>& a, const TContour<RawShape>& b)
+        {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                              [](const Vertex& p, const Vertex& q) {
+                return getX(p) == getX(q) && getY(p) == getY(q);
+            });
+        }
+
+        static bool equal(const RawShape& a, const RawShape& b)
+        {
+            if (!equal(sl::contour(a), sl::contour(b))) return false;
+
+            auto& ha = sl::holes(a);
+            auto& hb = sl::holes(b);
+            return std::equal(ha.begin(), ha.end(), hb.begin(), hb.end(),
+                              [](const TContour<RawShape>& p,
+                                 const TContour<RawShape>& q) {
+                return equal(p, q);
+            });
+        }
+
+        static bool matches(const Entry& e, const Item& fixed, const Item& orbiter)
+        {
+            return e.fixed_rot == double(fixed.rotation()) &&
+                   e.orbiter_rot == double(orbiter.rotation()) &&
+                   e.fixed_infl == fixed.inflation() &&
+                   e.orbiter_infl == orbiter.inflation() &&
+                   equal(e.fixed_sh, fixed.rawShape()) &&
+                   equal(e.orbiter_sh, orbiter.rawShape());
+        }
+
+    public:
+
+        static size_t combine(size_t seed, size_t v)
+        {
+            return seed ^ (v + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+        }
+
+        static size_t hash(const Item& item)
+        {
+            std::hash<Coord> hc;
+            std::hash<double> hd;
+
+            auto hash_contour = [&hc](size_t seed, const TContour<RawShape>& c) {
+                for (const Vertex& v : c)
+                    seed = combine(combine(seed, hc(getX(v))), hc(getY(v)));
+                return combine(seed, c.size());
+            };
+
+            const RawShape& sh = item.rawShape();
+            size_t seed = hash_contour(0, sl::contour(sh));
+            for (auto& h : sl::holes(sh)) seed = hash_contour(seed, h);
+
+            seed = combine(seed, hd(double(item.rotation())));
+            return combine(seed, hc(item.inflation()));
+        }
+
+        // Copies the cached nfp relative to the stationary item into nfp.
+        bool find(size_t key, const Item& fixed, const Item& orbiter, RawShape& nfp)
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            auto it = entries_.find(key);
+            if (it == entries_.end()) return false;
+
+            for (const Entry& e : it->second)
+                if (matches(e, fixed, orbiter)) {
+                    nfp = e.nfp;
+                    return true;
+                }
+
+            return false;
+        }
+
+        void insert(size_t key, const Item& fixed, const Item& orbiter, RawShape&& nfp)
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (count_ >= MaxEntries) {
+                entries_.clear();
+                count_ = 0;
+            }
+
+            auto& bucket = entries_[key];
+            for (const Entry& e : bucket)
+                if (matches(e, fixed, orbiter)) return;
+
+            bucket.push_back({fixed.rawShape(), orbiter.rawShape(),
+                              double(fixed.rotation()), double(orbiter.rotation()),
+                              fixed.inflation(), orbiter.inflation(),
+                              std::move(nfp)});
+            ++count_;
+        }
+    };
+
     Shapes calcnfp(const Item &trsh, Lvl<nfp::NfpLevel::CONVEX_ONLY>)
     {
         using namespace nfp;
@@ -612,14 +743,27 @@ private:
         }
         // /////////////////////////////////////////////////////////////////////
 
+        NfpCache& cache = *nfp_cache_;
+        size_t orbhash = NfpCache::hash(trsh);
+
         __parallel::enumerate(items_.begin(), items_.end(),
-                              [&nfps, &trsh](const Item& sh, size_t n)
+                              [&nfps, &trsh, &cache, orbhash](const Item& sh, size_t n)
         {
+            size_t key = NfpCache::combine(NfpCache::hash(sh), orbhash);
+            if (cache.find(key, sh, trsh, nfps[n])) {
+                sl::translate(nfps[n], sh.translation());
+                return;
+            }
+
             auto& fixedp = sh.transformedShape();
             auto& orbp = trsh.transformedShape();
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
             correctNfpPosition(subnfp_r, sh, trsh);
             nfps[n] = subnfp_r.first;
+
+            RawShape untranslated = subnfp_r.first;
+            sl::translate(untranslated, Vertex{} - sh.translation());
+            cache.insert(key, sh, trsh, std::move(untranslated));
         });
 
         return nfp::merge(nfps);
@@ -646,10 +790,12 @@ private:
 
     class Optimizer: public opt::TOptimizer<opt::Method::L_SUBPLEX> {
     public:
-        Optimizer(float accuracy = 1.f) {
+        Optimizer(float accuracy = 1.f,
+                  const std::function<bool()> &stopcond = {}) {
             opt::StopCriteria stopcr;
             stopcr.max_iterations = unsigned(std::floor(1000 * accuracy));
             stopcr.relative_score_difference = 1e-20;
+            if (stopcond) stopcr.stop_condition = stopcond;
             this->stopcr_ = stopcr;
         }
     };
@@ -746,7 +892,11 @@ private:
 
             Pile merged_pile = merged_pile_;
 
+            const std::function<bool()> &stopcond = config_.stop_condition;
+            auto stopped = [&stopcond] { return stopcond && stopcond(); };
+
             for(auto rot : config_.rotations) {
+                if (stopped()) break;
 
                 item.translation(initial_tr);
                 item.rotation(initial_rot + rot);
@@ -821,7 +971,7 @@ private:
 
                 // Local optimization with the four polygon corners as
                 // starting points
-                for(unsigned ch = 0; ch < ecache.size(); ch++) {
+                for(unsigned ch = 0; ch < ecache.size() && !stopped(); ch++) {
                     auto& cache = ecache[ch];
 
                     OptResults results(cache.corners().size());
@@ -833,10 +983,11 @@ private:
                     __parallel::enumerate(
                                 cache.corners().begin(),
                                 cache.corners().end(),
-                                [&results, &item, &rofn, &nfpoint, ch, accuracy]
+                                [&results, &item, &rofn, &nfpoint, ch, accuracy,
+                                 &stopcond]
                                 (double pos, size_t n)
                     {
-                        Optimizer solver(accuracy);
+                        Optimizer solver(accuracy, stopcond);
 
                         Item itemcpy = item;
                         auto contour_ofn = [&rofn, &nfpoint, ch, &itemcpy]
@@ -883,10 +1034,10 @@ private:
                         __parallel::enumerate(cache.corners(hidx).begin(),
                                       cache.corners(hidx).end(),
                                       [&results, &item, &nfpoint,
-                                       &rofn, ch, hidx, accuracy]
+                                       &rofn, ch, hidx, accuracy, &stopcond]
                                       (double pos, size_t n)
                         {
-                            Optimizer solver(accuracy);
+                            Optimizer solver(accuracy, stopcond);
 
                             Item itmcpy = item;
                             auto hole_ofn =
@@ -81,6 +81,12 @@ public:
         
         this->template remove_unpackable_items<Placer>(store_, bin, pconfig);
 
+        // The packed items are disjoint and inside the bin, so a bin can be
+        // skipped without trying the item if their areas do not fit. The
+        // fixed items may overlap, so only the packed ones are counted.
+        const double bin_area = sl::area(bin);
+        std::vector<double> packed_area(placers.size(), 0.);
+
         auto it = store_.begin();
 
         while(it != store_.end() && !cancelled()) {
@@ -88,7 +94,11 @@ public:
             size_t j = 0;
             while(!was_packed && !cancelled()) {
                 for(; j < placers.size() && !was_packed && !cancelled(); j++) {
+                    if (packed_area[j] + it->get().area() > bin_area)
+                        continue;
+
                     if((was_packed = placers[j].pack(*it, rem(it, store_) ))) {
+                        packed_area[j] += it->get().area();
                         it->get().binId(int(j));
                         makeProgress(placers[j], j);
                     }
@@ -98,6 +108,7 @@ public:
                     placers.emplace_back(bin);
                     placers.back().configure(pconfig);
                     packed_bins_.emplace_back();
+                    packed_area.emplace_back(0.);
                     j = placers.size() - 1;
                 }
             }
@@ -7,6 +7,7 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -236,6 +237,26 @@ namespace detail {
 		std::vector<igl::Hit>				 hits;
 	};
 
+    // Packet of up to 32 rays traversing the tree at once.
+    template<typename AVertexType, typename AIndexedFaceType, typename ATreeType, typename AVectorType>
+    struct RayPacketIntersector {
+        using VertexType        = AVertexType;
+        using IndexedFaceType   = AIndexedFaceType;
+        using TreeType          = ATreeType;
+        using VectorType        = AVectorType;
+
+        const std::vector<VertexType>       &vertices;
+        const std::vector<IndexedFaceType>  &faces;
+        const TreeType                      &tree;
+
+        const VectorType                    *origins;
+        const VectorType                    *dirs;
+        std::array<VectorType, 32>           invdirs;
+        size_t                               num_rays;
+        // First hits found so far.
+        igl::Hit                            *hits;
+    };
+
 	//FIXME implement SSE for float AABB trees with float ray queries.
 	// SSE/SSE2 is supported by any Intel/AMD x64 processor.
 	// SSE support requires 16 byte alignment of the AABB nodes, representing the bounding boxes with 4+4 floats,
@@ -368,6 +389,45 @@ namespace detail {
 		}
 	}
 
+    // The node is only visited by the rays of the mask hitting its box closer than their hit found so far.
+    template<typename RayPacketIntersectorType>
+    static inline void intersect_ray_packet_recursive_first_hit(RayPacketIntersectorType &ray_intersector, size_t node_idx, uint32_t mask)
+    {
+        using Scalar = typename RayPacketIntersectorType::VectorType::Scalar;
+
+        const auto &node = ray_intersector.tree.node(node_idx);
+        assert(node.is_valid());
+
+        const auto bbox = node.bbox.template cast<Scalar>();
+        uint32_t active = 0;
+        for (size_t i = 0; i < ray_intersector.num_rays; ++ i)
+            if ((mask & (uint32_t(1) << i)) &&
+                ray_box_intersect_invdir(ray_intersector.origins[i], ray_intersector.invdirs[i], bbox, Scalar(0), Scalar(ray_intersector.hits[i].t)))
+                active |= uint32_t(1) << i;
+        if (active == 0)
+            return;
+
+        if (node.is_leaf()) {
+            auto face = ray_intersector.faces[node.idx];
+            for (size_t i = 0; i < ray_intersector.num_rays; ++ i)
+                if (active & (uint32_t(1) << i)) {
+                    double t, u, v;
+                    if (intersect_triangle(
+                            ray_intersector.origins[i], ray_intersector.dirs[i],
+                            ray_intersector.vertices[face(0)], ray_intersector.vertices[face(1)], ray_intersector.vertices[face(2)],
+                            t, u, v)
+                        && t > 0. && float(t) < ray_intersector.hits[i].t)
+                        ray_intersector.hits[i] = igl::Hit { int(node.idx), -1, float(u), float(v), float(t) };
+                }
+        } else {
+            // Left / right child node index.
+            size_t left  = node_idx * 2 + 1;
+            size_t right = left + 1;
+            intersect_ray_packet_recursive_first_hit(ray_intersector, left,  active);
+            intersect_ray_packet_recursive_first_hit(ray_intersector, right, active);
+        }
+    }
+
     template<typename RayIntersectorType>
 	static inline void intersect_ray_recursive_all_hits(RayIntersectorType &ray_intersector, size_t node_idx)
 	{
@@ -632,6 +692,44 @@ inline bool intersect_ray_first_hit(
         ray_intersector, size_t(0), std::numeric_limits<Scalar>::infinity(), hit);
 }
 
+// Find the first intersections of a packet of rays with indexed triangle set.
+// The tree is traversed once for the whole packet, which pays off for coherent rays,
+// for example rays shot from the points of a small circle.
+// Intersection test is calculated with the accuracy of VectorType::Scalar
+// even if the triangle mesh and the AABB Tree are built with floats.
+// Rays without an intersection get a hit with id -1 and infinite t.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline void intersect_ray_packet_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const VectorType					*origins,
+	// Directions of the rays.
+	const VectorType 					*dirs,
+	size_t                               num_rays,
+	// First intersections of the rays with the indexed triangle set, num_rays of them.
+	igl::Hit 							*hits)
+{
+    for (size_t i = 0; i < num_rays; ++ i)
+        hits[i] = igl::Hit { -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() };
+    if (tree.empty())
+        return;
+    // The rays are processed by packets of 32, the width of the mask of the active rays.
+    for (size_t first = 0; first < num_rays; first += 32) {
+        auto ray_intersector = detail::RayPacketIntersector<VertexType, IndexedFaceType, TreeType, VectorType> {
+            vertices, faces, tree, origins + first, dirs + first, {}, std::min<size_t>(32, num_rays - first), hits + first
+        };
+        for (size_t i = 0; i < ray_intersector.num_rays; ++ i)
+            ray_intersector.invdirs[i] = dirs[first + i].cwiseInverse();
+        uint32_t mask = ray_intersector.num_rays == 32 ? ~uint32_t(0) : (uint32_t(1) << ray_intersector.num_rays) - 1;
+        detail::intersect_ray_packet_recursive_first_hit(ray_intersector, size_t(0), mask);
+    }
+}
+
 // Find all intersections of a ray with indexed triangle set.
 // Intersection test is calculated with the accuracy of VectorType::Scalar
 // even if the triangle mesh and the AABB Tree are built with floats.
@@ -752,6 +850,25 @@ void get_candidate_idxs(const TreeType& tree, const VectorType& v, std::vector<s
     return;
 }
 
+// Traverse the tree and collect the indices of all entities whose bounding boxes
+// pass the given test. The test is applied to the inner nodes as well, it shall
+// be conservative, returning true for any box enclosing a box that passes.
+template<typename TreeType, typename BBoxTest>
+void get_candidate_idxs_if(const TreeType& tree, const BBoxTest& bbox_test, std::vector<size_t>& candidates, size_t node_idx = 0)
+{
+    if (tree.empty())
+        return;
+
+    decltype(tree.node(node_idx)) node = tree.node(node_idx);
+    if (! node.is_valid() || ! bbox_test(node.bbox))
+        return;
+
+    if (! node.is_leaf()) {
+        get_candidate_idxs_if(tree, bbox_test, candidates, tree.left_child_idx(node_idx));
+        get_candidate_idxs_if(tree, bbox_test, candidates, tree.right_child_idx(node_idx));
+    } else
+        candidates.push_back(node.idx);
+}
 
 } // namespace AABBTreeIndirect
 } // namespace Slic3r
@@ -124,6 +124,12 @@ void AppConfig::set_defaults()
         if (get("export_sources_full_pathnames").empty())
             set("export_sources_full_pathnames", "0");
 
+        if (get("slices_cache_on_disk").empty())
+            set("slices_cache_on_disk", "0");
+
+        if (get("slicing_threads").empty())
+            set("slicing_threads", "0");
+
 #if ENABLE_CUSTOMIZABLE_FILES_ASSOCIATION_ON_WIN
 #ifdef _WIN32
         if (get("associate_3mf").empty())
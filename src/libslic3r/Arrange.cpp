@@ -1,7 +1,9 @@
 #include "Arrange.hpp"
+#include "ArrangeRaster.hpp"
 #include "SVG.hpp"
 
 #include "BoundingBox.hpp"
+#include "Geometry.hpp"
 
 #include <libnest2d/backends/clipper/geometries.hpp>
 #include <libnest2d/optimizers/nlopt/subplex.hpp>
@@ -10,6 +12,7 @@
 #include <libnest2d/utils/rotcalipers.hpp>
 
 #include <numeric>
+#include <optional>
 #include <ClipperUtils.hpp>
 
 #include <boost/geometry/index/rtree.hpp>
@@ -105,6 +108,10 @@ void fill_config(PConf& pcfg, const ArrangeParams &params) {
     
     // Allow parallel execution.
     pcfg.parallel = params.parallel;
+
+    // Check for cancellation while searching for the position of an item,
+    // not just between the items.
+    pcfg.stop_condition = params.stopcondition;
 }
 
 // Apply penalty to object function result. This is used only when alignment
@@ -607,6 +614,37 @@ template<class Fn> auto call_with_bed(const Points &bed, Fn &&fn)
     }
 }
 
+// The convex polygon of the bed for the raster engine, if there is any.
+static std::optional<Polygon> to_raster_bed(const BoundingBox &bb)
+{
+    return Polygon{bb.min, {bb.max.x(), bb.min.y()}, bb.max, {bb.min.x(), bb.max.y()}};
+}
+
+static std::optional<Polygon> to_raster_bed(const CircleBed &c)
+{
+    // Inscribed into the circle, so nothing gets outside of the bed.
+    const size_t steps = 128;
+    Polygon ret;
+    for (size_t i = 0; i < steps; ++i) {
+        double phi = 2. * PI * i / steps;
+        ret.points.emplace_back(c.center().x() + coord_t(c.radius() * std::cos(phi)),
+                                c.center().y() + coord_t(c.radius() * std::sin(phi)));
+    }
+
+    return ret;
+}
+
+static std::optional<Polygon> to_raster_bed(const Polygon &p)
+{
+    Polygon hull = Geometry::convex_hull(p.points);
+    if (std::abs(hull.area()) - std::abs(p.area()) > 1e-3 * std::abs(hull.area()))
+        return {};
+
+    return hull;
+}
+
+static std::optional<Polygon> to_raster_bed(const InfiniteBed &) { return {}; }
+
 template<>
 void arrange(ArrangePolygons &      items,
              const ArrangePolygons &excludes,
@@ -625,7 +663,13 @@ void arrange(ArrangePolygons &      arrangables,
              const ArrangeParams &  params)
 {
     namespace clppr = ClipperLib;
-    
+
+    if (params.engine == ArrangeParams::Engine::Raster)
+        if (std::optional<Polygon> rbed = to_raster_bed(bed)) {
+            arrange_raster(arrangables, excludes, *rbed, params);
+            return;
+        }
+
     std::vector<Item> items, fixeditems;
     items.reserve(arrangables.size());
     
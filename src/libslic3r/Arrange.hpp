@@ -89,6 +89,18 @@ struct ArrangeParams {
     bool parallel = true;
 
     bool allow_rotations = false;
+
+    /// The arrangement algorithm. The raster engine places the items on a
+    /// bitmap of the bed. It is much faster with many items, e.g. when
+    /// filling the bed, but leaves slightly bigger gaps between the items.
+    /// Unbounded and non-convex beds are always arranged by the no fit
+    /// polygon placer.
+    enum class Engine { NoFitPolygon, Raster };
+    Engine engine = Engine::NoFitPolygon;
+
+    /// Cell size of the raster engine, zero picks one from the size of the
+    /// bed and the sizes of the items.
+    coord_t raster_cell = 0;
     
     /// Progress indicator callback called when an object gets packed. 
     /// The unsigned argument is the number of items remaining to pack.
@@ -96,7 +108,9 @@ struct ArrangeParams {
 
     std::function<void(const ArrangePolygon &)> on_packed;
     
-    /// A predicate returning true if abort is needed.
+    /// A predicate returning true if abort is needed. It is also checked
+    /// from the worker threads while placing an item, so it has to be cheap
+    /// and thread safe.
     std::function<bool(void)>     stopcondition;
     
     ArrangeParams() = default;
@@ -0,0 +1,394 @@
+#include "ArrangeRaster.hpp"
+
+#include "BoundingBox.hpp"
+#include "ClipperUtils.hpp"
+#include "Geometry.hpp"
+
+#include <numeric>
+#include <unordered_map>
+
+namespace Slic3r { namespace arrangement {
+
+namespace {
+
+// One bit per cell. The rows are padded by an empty word, so any 64 bit
+// window of a row can be read without a bounds check.
+class Bitmap {
+    size_t m_width = 0, m_height = 0, m_stride = 0;
+    std::vector<uint64_t> m_words;
+
+public:
+    Bitmap() = default;
+    Bitmap(size_t w, size_t h)
+        : m_width(w), m_height(h), m_stride(w / 64 + 2), m_words(m_stride * h, 0)
+    {}
+
+    size_t width() const { return m_width; }
+    size_t height() const { return m_height; }
+    size_t words() const { return (m_width + 63) / 64; }
+
+    uint64_t word(size_t row, size_t k) const { return m_words[row * m_stride + k]; }
+
+    // The 64 cells of the row starting at the column x.
+    uint64_t window(size_t row, size_t x) const
+    {
+        const uint64_t *w = &m_words[row * m_stride + x / 64];
+        unsigned        s = x % 64;
+        return s == 0 ? w[0] : (w[0] >> s) | (w[1] << (64 - s));
+    }
+
+    // Set the cells [from, to) of the row.
+    void set(size_t row, size_t from, size_t to)
+    {
+        to          = std::min(to, m_width);
+        uint64_t *w = &m_words[row * m_stride];
+        for (size_t x = from; x < to;) {
+            size_t b = x % 64, n = std::min<size_t>(64 - b, to - x);
+            w[x / 64] |= (n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1) << b;
+            x += n;
+        }
+    }
+
+    // Set the cells of the other bitmap placed at the column x and row y.
+    void set(const Bitmap &other, size_t x, size_t y)
+    {
+        for (size_t r = 0; r < other.height(); ++r)
+            for (size_t k = 0; k < other.words(); ++k) {
+                uint64_t m = other.word(r, k);
+                if (m == 0) continue;
+
+                size_t    xk = x + 64 * k, s = xk % 64;
+                uint64_t *w  = &m_words[(y + r) * m_stride + xk / 64];
+                w[0] |= m << s;
+                if (s > 0) w[1] |= m >> (64 - s);
+            }
+    }
+
+    // Test if the other bitmap placed at the column x and row y overlaps
+    // any set cell. It has to be inside this bitmap.
+    bool overlaps(const Bitmap &other, size_t x, size_t y) const
+    {
+        for (size_t r = 0; r < other.height(); ++r)
+            for (size_t k = 0; k < other.words(); ++k)
+                if (window(y + r, x + 64 * k) & other.word(r, k)) return true;
+
+        return false;
+    }
+};
+
+// The x range of the convex polygon within the horizontal band [y0, y1].
+bool band_extents(const Points &pts, double y0, double y1, double &xmin, double &xmax)
+{
+    xmin = std::numeric_limits<double>::max();
+    xmax = std::numeric_limits<double>::lowest();
+
+    for (size_t i = 0; i < pts.size(); ++i) {
+        Vec2d p = pts[i].cast<double>(), q = pts[(i + 1) % pts.size()].cast<double>();
+        if (p.y() > q.y()) std::swap(p, q);
+        if (q.y() < y0 || p.y() > y1) continue;
+
+        double a = p.x(), b = q.x();
+        if (q.y() > p.y()) {
+            double dxdy = (q.x() - p.x()) / (q.y() - p.y());
+            a = p.x() + dxdy * (std::max(p.y(), y0) - p.y());
+            b = p.x() + dxdy * (std::min(q.y(), y1) - p.y());
+        }
+
+        xmin = std::min(xmin, std::min(a, b));
+        xmax = std::max(xmax, std::max(a, b));
+    }
+
+    return xmin <= xmax;
+}
+
+// Set all the cells touched by the convex polygon. The origin is the corner
+// of the first cell.
+void rasterize(Bitmap &bm, const Points &pts, const Point &origin, coord_t cell)
+{
+    if (bm.height() == 0) return;
+
+    BoundingBox bb(pts);
+    auto to_cell = [cell](double v) { return long(std::floor(v / cell)); };
+    long r0 = std::max(to_cell(bb.min.y() - origin.y()), 0l);
+    long r1 = std::min(to_cell(bb.max.y() - origin.y()), long(bm.height()) - 1);
+
+    for (long r = r0; r <= r1; ++r) {
+        double y0 = double(origin.y()) + double(r) * cell, xmin, xmax;
+        if (!band_extents(pts, y0, y0 + cell, xmin, xmax)) continue;
+
+        long c0 = std::max(to_cell(xmin - origin.x()), 0l);
+        long c1 = to_cell(xmax - origin.x()) + 1;
+        if (c1 > c0) bm.set(size_t(r), size_t(c0), size_t(c1));
+    }
+}
+
+// The cells that are not fully inside the convex bed are set.
+Bitmap bed_bitmap(const Polygon &bed, const Point &origin, coord_t cell, size_t w, size_t h)
+{
+    Bitmap bm(w, h);
+    for (size_t r = 0; r < h; ++r) {
+        double y0 = double(origin.y()) + double(r) * cell, y1 = y0 + cell;
+        double l0, r0, l1, r1;
+        long   c0 = 0, c1 = 0;
+        if (band_extents(bed.points, y0, y0, l0, r0) &&
+            band_extents(bed.points, y1, y1, l1, r1)) {
+            c0 = long(std::ceil((std::max(l0, l1) - origin.x()) / cell));
+            c1 = long(std::floor((std::min(r0, r1) - origin.x()) / cell));
+            c0 = std::max(c0, 0l);
+            c1 = std::min(c1, long(w));
+        }
+
+        if (c1 > c0) {
+            bm.set(r, 0, size_t(c0));
+            bm.set(r, size_t(c1), w);
+        } else
+            bm.set(r, 0, w);
+    }
+
+    return bm;
+}
+
+// The convex hull of the polygon inflated by the given amount.
+Polygon inflated_hull(const Polygon &poly, coord_t inflation)
+{
+    if (inflation <= 0) return poly;
+    return Geometry::convex_hull(offset(poly, float(inflation)));
+}
+
+const size_t NoFit = std::numeric_limits<size_t>::max();
+
+// An item rotated by one of the allowed rotations, rasterized with the
+// corner of its bounding box at the corner of the first cell.
+struct Mask {
+    double rotation;
+    Point  corner;
+    Bitmap bits;
+
+    // The first cell in row major order where this mask may fit, for each
+    // bed. The beds only get fuller, so the search resumes from here.
+    std::vector<size_t> next;
+};
+
+struct Shape {
+    Polygon           hull;
+    double            rotation;
+    std::vector<Mask> masks;
+};
+
+// The first cell in [from, until) in row major order where the mask does
+// not overlap the occupied cells, or until if there is no such.
+size_t find_fit(const Bitmap &occupied, const Bitmap &mask, size_t from, size_t until)
+{
+    size_t w = occupied.width();
+    if (mask.width() > w || mask.height() > occupied.height()) return until;
+
+    size_t xmax = w - mask.width(), ymax = occupied.height() - mask.height();
+    for (size_t p = from; p < until; ++p) {
+        size_t y = p / w, x = p % w;
+        if (y > ymax) break;
+        if (x > xmax) {
+            p = (y + 1) * w - 1;
+            continue;
+        }
+        if (!occupied.overlaps(mask, x, y)) return p;
+    }
+
+    return until;
+}
+
+size_t shape_hash(const Polygon &hull, double rotation)
+{
+    size_t seed = std::hash<double>{}(rotation);
+    for (const Point &p : hull.points)
+        seed ^= std::hash<coord_t>{}(p.x() * 31 + p.y()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+    return seed;
+}
+
+coord_t auto_cell_size(const BoundingBox &bedbb, const std::vector<Shape> &shapes)
+{
+    double bedsize = double(std::max(bedbb.size().x(), bedbb.size().y()));
+    double minside = bedsize;
+    for (const Shape &s : shapes) {
+        Vec2crd sz = s.hull.bounding_box().size();
+        minside    = std::min(minside, double(std::min(sz.x(), sz.y())));
+    }
+
+    // About 8 cells over the smallest item, a grid of at most 2048 cells and
+    // at least 256 cells over the bed.
+    double cell = std::min(std::max(minside / 8., bedsize / 2048.), bedsize / 256.);
+    return std::max(coord_t(cell), coord_t(1));
+}
+
+} // namespace
+
+void arrange_raster(ArrangePolygons &      items,
+                    const ArrangePolygons &excludes,
+                    const Polygon &        bed,
+                    const ArrangeParams &  params)
+{
+    // The same corrections of the bed and the items as with the nfp placer.
+    coord_t infl = coord_t(std::ceil(params.min_obj_distance / 2.0));
+    Polygon bedpoly = inflated_hull(bed, params.min_obj_distance / 2);
+
+    std::vector<Shape>  shapes;
+    std::vector<size_t> shape_of(items.size(), NoFit);
+    std::unordered_map<size_t, std::vector<size_t>> shape_index;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        Polygon hull = Geometry::convex_hull(items[i].poly.contour.points);
+        if (hull.size() < 3) continue;
+
+        double rot  = items[i].rotation;
+        auto & cands = shape_index[shape_hash(hull, rot)];
+        auto   it    = std::find_if(cands.begin(), cands.end(), [&](size_t s) {
+            return shapes[s].rotation == rot && shapes[s].hull == hull;
+        });
+
+        if (it != cands.end())
+            shape_of[i] = *it;
+        else {
+            shape_of[i] = shapes.size();
+            cands.emplace_back(shapes.size());
+            shapes.push_back({std::move(hull), rot, {}});
+        }
+    }
+
+    BoundingBox bedbb = bedpoly.bounding_box();
+    coord_t     cell  = params.raster_cell > 0 ? params.raster_cell :
+                                                 auto_cell_size(bedbb, shapes);
+
+    size_t w = size_t(bedbb.size().x() / cell), h = size_t(bedbb.size().y() / cell);
+    if (w == 0 || h == 0) return;
+
+    const Point &origin = bedbb.min;
+    Bitmap       empty_bed = bed_bitmap(bedpoly, origin, cell, w, h);
+    const size_t end = w * h;
+
+    std::vector<double> rotations = {0.};
+    if (params.allow_rotations) rotations = {0., PI / 2., PI, 3. * PI / 2.};
+
+    for (Shape &s : shapes)
+        for (double r : rotations) {
+            Polygon p = s.hull;
+            p.rotate(s.rotation + r);
+            p = inflated_hull(p, infl);
+
+            BoundingBox bb = p.bounding_box();
+            Bitmap bits(size_t(bb.size().x() / cell) + 1, size_t(bb.size().y() / cell) + 1);
+            rasterize(bits, p.points, bb.min, cell);
+            s.masks.push_back({s.rotation + r, bb.min, std::move(bits), {}});
+        }
+
+    struct Placement { size_t item; const Mask *mask; size_t x, y; };
+    struct Bed {
+        Bitmap                 occupied;
+        std::vector<Placement> placed;
+        bool                   has_fixed = false;
+    };
+    std::vector<Bed> beds;
+
+    auto add_bed = [&beds, &empty_bed](size_t bed_idx) {
+        while (beds.size() <= bed_idx) beds.push_back({empty_bed, {}, false});
+    };
+
+    for (const ArrangePolygon &fixed : excludes) {
+        if (fixed.bed_idx < 0) continue;
+
+        Polygon p = inflated_hull(Geometry::convex_hull(fixed.transformed_poly().contour.points), infl);
+        add_bed(size_t(fixed.bed_idx));
+        rasterize(beds[size_t(fixed.bed_idx)].occupied, p.points, origin, cell);
+        beds[size_t(fixed.bed_idx)].has_fixed = true;
+    }
+
+    // The same order as with the first fit selection of libnest2d.
+    std::vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&items](size_t a, size_t b) {
+        int pa = items[a].priority, pb = items[b].priority;
+        return pa == pb ? items[a].poly.area() > items[b].poly.area() : pa > pb;
+    });
+
+    auto to_translation = [&origin, cell](const Mask &m, size_t x, size_t y) {
+        return Vec2crd(origin.x() + coord_t(x) * cell - m.corner.x(),
+                       origin.y() + coord_t(y) * cell - m.corner.y());
+    };
+
+    unsigned remaining = unsigned(items.size());
+    for (size_t idx : order) {
+        if (params.stopcondition && params.stopcondition()) break;
+
+        --remaining;
+        ArrangePolygon &ap = items[idx];
+        ap.bed_idx         = UNARRANGED;
+
+        if (shape_of[idx] == NoFit) continue;
+
+        Shape &s = shapes[shape_of[idx]];
+        for (size_t b = 0;; ++b) {
+            bool fresh = b == beds.size();
+            add_bed(b);
+
+            Bed &       bd   = beds[b];
+            size_t      best = end;
+            const Mask *bm   = nullptr;
+            for (Mask &m : s.masks) {
+                if (m.next.size() <= b) m.next.resize(b + 1, 0);
+                size_t p = find_fit(bd.occupied, m.bits, m.next[b], best);
+                m.next[b] = p;
+                if (p < best) {
+                    best = p;
+                    bm   = &m;
+                }
+            }
+
+            if (bm) {
+                size_t x = best % w, y = best / w;
+                bd.occupied.set(bm->bits, x, y);
+                bd.placed.push_back({idx, bm, x, y});
+                ap.bed_idx     = int(b);
+                ap.rotation    = bm->rotation;
+                ap.translation = to_translation(*bm, x, y);
+                break;
+            }
+
+            // Does not fit even on an empty bed.
+            if (fresh) {
+                beds.pop_back();
+                break;
+            }
+        }
+
+        if (params.progressind) params.progressind(remaining);
+        if (params.on_packed && ap.bed_idx != UNARRANGED) params.on_packed(ap);
+    }
+
+    // Align the piles into the center of the beds without fixed items, when
+    // the moved pile stays inside the bed.
+    for (size_t b = 0; b < beds.size(); ++b) {
+        const Bed &bd = beds[b];
+        if (bd.has_fixed || bd.placed.empty()) continue;
+
+        long x0 = long(w), y0 = long(h), x1 = 0, y1 = 0;
+        for (const Placement &pl : bd.placed) {
+            x0 = std::min(x0, long(pl.x));
+            y0 = std::min(y0, long(pl.y));
+            x1 = std::max(x1, long(pl.x + pl.mask->bits.width()));
+            y1 = std::max(y1, long(pl.y + pl.mask->bits.height()));
+        }
+
+        long dx = (long(w) - (x1 - x0)) / 2 - x0, dy = (long(h) - (y1 - y0)) / 2 - y0;
+        if (dx == 0 && dy == 0) continue;
+
+        bool inside = std::all_of(bd.placed.begin(), bd.placed.end(), [&](const Placement &pl) {
+            return !empty_bed.overlaps(pl.mask->bits, size_t(long(pl.x) + dx), size_t(long(pl.y) + dy));
+        });
+
+        if (inside)
+            for (const Placement &pl : bd.placed)
+                items[pl.item].translation = to_translation(*pl.mask, size_t(long(pl.x) + dx),
+                                                            size_t(long(pl.y) + dy));
+    }
+}
+
+}} // namespace Slic3r::arrangement
@@ -0,0 +1,28 @@
+#ifndef ARRANGERASTER_HPP
+#define ARRANGERASTER_HPP
+
+#include "Arrange.hpp"
+
+namespace Slic3r { namespace arrangement {
+
+/**
+ * \brief Arranges the input polygons on a bitmap of the bed.
+ *
+ * The bed and the convex hulls of the items, inflated by half of the minimum
+ * object distance, are rasterized conservatively into bitmaps with one bit
+ * per cell. The items are placed one by one at the first free cell in row
+ * major order, testing the collisions with bitwise AND of the bitmap words.
+ * The rotated bitmaps of the items are computed once for each distinct shape.
+ * This is much faster than the no fit polygon placer when filling the bed
+ * with many identical items, at the cost of up to a cell of extra gap.
+ *
+ * \param bed A convex polygon of the print bed.
+ */
+void arrange_raster(ArrangePolygons &      items,
+                    const ArrangePolygons &excludes,
+                    const Polygon &        bed,
+                    const ArrangeParams &  params);
+
+}} // namespace Slic3r::arrangement
+
+#endif // ARRANGERASTER_HPP
@@ -27,13 +27,18 @@ public:
             this->defined = false;
             // throw Slic3r::InvalidArgument("Empty point set supplied to BoundingBoxBase constructor");
         } else {
-            typename std::vector<PointClass>::const_iterator it = points.begin();
-            this->min = *it;
-            this->max = *it;
-            for (++ it; it != points.end(); ++ it) {
-                this->min = this->min.cwiseMin(*it);
-                this->max = this->max.cwiseMax(*it);
+            // Four independent scalar reductions, which the compiler vectorizes, instead of the Eigen min / max of each point.
+            using Scalar = typename PointClass::Scalar;
+            Scalar min_x = points.front()(0), min_y = points.front()(1);
+            Scalar max_x = min_x, max_y = min_y;
+            for (const PointClass &pt : points) {
+                min_x = std::min(min_x, pt(0));
+                min_y = std::min(min_y, pt(1));
+                max_x = std::max(max_x, pt(0));
+                max_y = std::max(max_y, pt(1));
             }
+            this->min = PointClass(min_x, min_y);
+            this->max = PointClass(max_x, max_y);
             this->defined = (this->min(0) < this->max(0)) && (this->min(1) < this->max(1));
         }
     }
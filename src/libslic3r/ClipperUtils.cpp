@@ -128,6 +128,7 @@ ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree& polytree)
 Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 {
     Polygon retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -136,6 +137,7 @@ Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 Slic3r::Polyline ClipperPath_to_Slic3rPolyline(const ClipperLib::Path &input)
 {
     Polyline retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -177,6 +179,7 @@ ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input)
 ClipperLib::Path Slic3rMultiPoint_to_ClipperPath(const MultiPoint &input)
 {
     ClipperLib::Path retval;
+    retval.reserve(input.points.size());
     for (Points::const_iterator pit = input.points.begin(); pit != input.points.end(); ++pit)
         retval.emplace_back((*pit)(0), (*pit)(1));
     return retval;
@@ -220,6 +223,38 @@ ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polylines &input)
     return retval;
 }
 
+#ifndef SLIC3R_COORD32
+static_assert(sizeof(Point) == sizeof(ClipperLib::IntPoint) && std::is_same<coord_t, ClipperLib::cInt>::value,
+    "Slic3r::Point and ClipperLib::IntPoint must share the memory layout to pass Slic3r polygons to the Clipper as views");
+
+void Slic3rMultiPoints_to_ClipperPathViews(const Polygons &input, ClipperLib::PathViews &out)
+{
+    out.clear();
+    out.reserve(input.size());
+    for (const Polygon &polygon : input)
+        out.emplace_back(Slic3rPoints_to_ClipperPathView(polygon.points));
+}
+
+void Slic3rMultiPoints_to_ClipperPathViews(const Polylines &input, ClipperLib::PathViews &out)
+{
+    out.clear();
+    out.reserve(input.size());
+    for (const Polyline &polyline : input)
+        out.emplace_back(Slic3rPoints_to_ClipperPathView(polyline.points));
+}
+
+void Slic3rMultiPoints_to_ClipperPathViews(const ExPolygons &input, ClipperLib::PathViews &out)
+{
+    out.clear();
+    out.reserve(number_polygons(input));
+    for (const ExPolygon &expoly : input) {
+        out.emplace_back(Slic3rPoints_to_ClipperPathView(expoly.contour.points));
+        for (const Polygon &hole : expoly.holes)
+            out.emplace_back(Slic3rPoints_to_ClipperPathView(hole.points));
+    }
+}
+#endif // SLIC3R_COORD32
+
 ClipperLib::Paths _offset(ClipperLib::Paths &&input, ClipperLib::EndType endType, const double delta, ClipperLib::JoinType joinType, double miterLimit)
 {
     // scale input
@@ -490,6 +525,26 @@ ExPolygons offset2_ex(const ExPolygons &expolygons, const double delta1,
     return union_ex(polys);
 }
 
+// Add closed polygons to the clipper. The Slic3r polygons are passed as views without copying their points,
+// unless the safety offset is requested, which works on a copy.
+template<class TPolygons>
+void _clipper_add_closed(ClipperLib::Clipper &clipper, const TPolygons &polygons, ClipperLib::PolyType type, bool safety_offset_)
+{
+    if (safety_offset_) {
+        ClipperLib::Paths paths = Slic3rMultiPoints_to_ClipperPaths(polygons);
+        safety_offset(&paths);
+        clipper.AddPaths(paths, type, true);
+    } else {
+#ifdef SLIC3R_COORD32
+        clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(polygons), type, true);
+#else
+        ClipperLib::PathViews views;
+        Slic3rMultiPoints_to_ClipperPathViews(polygons, views);
+        clipper.AddPaths(views, type, true);
+#endif
+    }
+}
+
 template<class T, class TSubj, class TClip>
 T _clipper_do(const ClipperLib::ClipType     clipType,
               TSubj &&                        subject,
@@ -497,26 +552,13 @@ T _clipper_do(const ClipperLib::ClipType     clipType,
               const ClipperLib::PolyFillType fillType,
               const bool                     safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(std::forward<TSubj>(subject));
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(std::forward<TClip>(clip));
-    
-    // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
-    }
-    
     // init Clipper
     ClipperLib::Clipper clipper;
     clipper.Clear();
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    _clipper_add_closed(clipper, subject, ClipperLib::ptSubject, safety_offset_ && clipType == ClipperLib::ctUnion);
+    _clipper_add_closed(clipper, clip,    ClipperLib::ptClip,    safety_offset_ && clipType != ClipperLib::ctUnion);
     
     // perform operation
     T retval;
@@ -550,17 +592,10 @@ bool test_path(const ClipperLib::Path &path) {
 inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const Polygons &subject, 
     const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_)
-        safety_offset((clipType == ClipperLib::ctUnion) ? &input_subject : &input_clip);
-    
     ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    _clipper_add_closed(clipper, subject, ClipperLib::ptSubject, safety_offset_ && clipType == ClipperLib::ctUnion);
+    _clipper_add_closed(clipper, clip,    ClipperLib::ptClip,    safety_offset_ && clipType != ClipperLib::ctUnion);
+    ClipperLib::Paths input_subject;
     // Perform the operation with the output to input_subject.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overapping edges.
@@ -595,20 +630,19 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
     const Polygons &clip, const ClipperLib::PolyFillType fillType,
     const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_) safety_offset(&input_clip);
-    
     // init Clipper
     ClipperLib::Clipper clipper;
     clipper.Clear();
     
-    // add polygons
+    // add polylines and polygons
+#ifdef SLIC3R_COORD32
+    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, false);
+#else
+    ClipperLib::PathViews input_subject;
+    Slic3rMultiPoints_to_ClipperPathViews(subject, input_subject);
     clipper.AddPaths(input_subject, ClipperLib::ptSubject, false);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+#endif
+    _clipper_add_closed(clipper, clip, ClipperLib::ptClip, safety_offset_);
     
     // perform operation
     ClipperLib::PolyTree retval;
@@ -1259,4 +1293,339 @@ ExPolygons variable_offset_inner_ex(const ExPolygon &expoly, const std::vector<s
 	return output;
 }
 
+namespace {
+
+// Fill the path with the points, reusing the memory already allocated by the path.
+template<typename PointIterator>
+inline void points_to_path(PointIterator begin, PointIterator end, ClipperLib::Path &out)
+{
+    out.clear();
+    out.reserve(end - begin);
+    for (PointIterator it = begin; it != end; ++ it)
+        out.emplace_back((*it)(0), (*it)(1));
+}
+
+// Fill the paths with the polygons / polylines, reusing the memory already allocated by the paths.
+template<typename MultiPoints>
+inline void multipoints_to_paths(const MultiPoints &input, ClipperLib::Paths &out)
+{
+    out.resize(input.size());
+    for (size_t i = 0; i < input.size(); ++ i)
+        points_to_path(input[i].points.begin(), input[i].points.end(), out[i]);
+}
+
+inline void multipoints_to_paths(const ExPolygons &input, ClipperLib::Paths &out)
+{
+    size_t cnt = 0;
+    for (const ExPolygon &expoly : input)
+        cnt += expoly.holes.size() + 1;
+    out.resize(cnt);
+    auto it_out = out.begin();
+    for (const ExPolygon &expoly : input) {
+        points_to_path(expoly.contour.points.begin(), expoly.contour.points.end(), *it_out ++);
+        for (const Polygon &hole : expoly.holes)
+            points_to_path(hole.points.begin(), hole.points.end(), *it_out ++);
+    }
+}
+
+// Same parameters as the freshly constructed ClipperOffset of the free offset functions receives.
+inline void setup_offsetter(ClipperLib::ClipperOffset &co, const double delta_scaled, ClipperLib::JoinType joinType, double arcTolerance, double miterLimit)
+{
+    co.Clear();
+    co.MiterLimit         = joinType == jtRound ? 2. : miterLimit;
+    co.ArcTolerance       = joinType == jtRound ? arcTolerance : 0.25;
+    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+}
+
+} // namespace
+
+ClipperContext& ClipperContext::local()
+{
+    static thread_local ClipperContext context;
+    return context;
+}
+
+void ClipperContext::offset_paths(const double delta_scaled, ClipperLib::JoinType joinType, double arcTolerance, double miterLimit)
+{
+    setup_offsetter(m_offsetter, delta_scaled, joinType, arcTolerance, miterLimit);
+    m_offsetter.AddPaths(m_subject, joinType, ClipperLib::etClosedPolygon);
+    m_offsetter.Execute(m_output, delta_scaled);
+    m_offsetter.Clear();
+}
+
+// Mirrors _offset(const ExPolygons &expolygons, ...), see the comments there.
+void ClipperContext::offset_expolygons(const ExPolygons &expolygons, const double delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    const double delta_scaled  = delta * float(CLIPPER_OFFSET_SCALE);
+    const double arc_tolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+    // Offsetted ExPolygons before they are united.
+    ClipperLib::Paths &contours_cummulative = m_output;
+    contours_cummulative.clear();
+    size_t expolygons_collected = 0;
+    m_subject.resize(1);
+    ClipperLib::Path &input = m_subject.front();
+    for (const ExPolygon &expoly : expolygons) {
+        // 1) Offset the outer contour.
+        points_to_path(expoly.contour.points.begin(), expoly.contour.points.end(), input);
+        scaleClipperPolygon(input);
+        setup_offsetter(m_offsetter, delta_scaled, joinType, arc_tolerance, miterLimit);
+        m_offsetter.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+        m_offsetter.Execute(m_contours, delta_scaled);
+        if (m_contours.empty())
+            continue;
+        // 2) Offset the holes one by one, collect the offsetted holes.
+        m_holes.clear();
+        for (const Polygon &hole : expoly.holes) {
+            points_to_path(hole.points.rbegin(), hole.points.rend(), input);
+            scaleClipperPolygon(input);
+            setup_offsetter(m_offsetter, delta_scaled, joinType, arc_tolerance, miterLimit);
+            m_offsetter.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+            m_offsetter.Execute(m_tmp, - delta_scaled);
+            std::move(m_tmp.begin(), m_tmp.end(), std::back_inserter(m_holes));
+        }
+        // 3) Subtract holes from the contours.
+        if (m_holes.empty()) {
+            std::move(m_contours.begin(), m_contours.end(), std::back_inserter(contours_cummulative));
+            ++ expolygons_collected;
+        } else if (delta < 0) {
+            m_clipper.Clear();
+            m_clipper.AddPaths(m_contours, ClipperLib::ptSubject, true);
+            m_clipper.AddPaths(m_holes, ClipperLib::ptClip, true);
+            m_clipper.Execute(ClipperLib::ctDifference, m_tmp, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            m_clipper.Clear();
+            if (! m_tmp.empty()) {
+                std::move(m_tmp.begin(), m_tmp.end(), std::back_inserter(contours_cummulative));
+                ++ expolygons_collected;
+            }
+        } else {
+            std::move(m_contours.begin(), m_contours.end(), std::back_inserter(contours_cummulative));
+            for (ClipperLib::Path &hole : m_holes) {
+                std::reverse(hole.begin(), hole.end());
+                contours_cummulative.emplace_back(std::move(hole));
+            }
+            ++ expolygons_collected;
+        }
+    }
+    m_offsetter.Clear();
+
+    // 4) Unite the offsetted expolygons.
+    if (expolygons_collected > 1 && delta > 0) {
+        m_clipper.Clear();
+        m_clipper.AddPaths(contours_cummulative, ClipperLib::ptSubject, true);
+        m_clipper.Execute(ClipperLib::ctUnion, m_tmp, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        m_clipper.Clear();
+        m_output.swap(m_tmp);
+    }
+    unscaleClipperPolygons(m_output);
+}
+
+template<typename TPolygons>
+void ClipperContext::add_closed(const TPolygons &polygons, ClipperLib::PolyType type, bool safety_offset_)
+{
+#ifdef SLIC3R_COORD32
+    ClipperLib::Paths &paths = type == ClipperLib::ptSubject ? m_subject : m_clip;
+    multipoints_to_paths(polygons, paths);
+    if (safety_offset_)
+        safety_offset(&paths);
+    m_clipper.AddPaths(paths, type, true);
+#else
+    if (safety_offset_) {
+        ClipperLib::Paths &paths = type == ClipperLib::ptSubject ? m_subject : m_clip;
+        multipoints_to_paths(polygons, paths);
+        safety_offset(&paths);
+        m_clipper.AddPaths(paths, type, true);
+    } else {
+        ClipperLib::PathViews &views = type == ClipperLib::ptSubject ? m_subject_views : m_clip_views;
+        Slic3rMultiPoints_to_ClipperPathViews(polygons, views);
+        m_clipper.AddPaths(views, type, true);
+    }
+#endif
+}
+
+template<typename TSubject, typename TClip>
+void ClipperContext::clip_paths(ClipperLib::ClipType clipType, const TSubject &subject, const TClip &clip, bool safety_offset_)
+{
+    m_clipper.Clear();
+    this->add_closed(subject, ClipperLib::ptSubject, safety_offset_ && clipType == ClipperLib::ctUnion);
+    this->add_closed(clip,    ClipperLib::ptClip,    safety_offset_ && clipType != ClipperLib::ctUnion);
+    m_clipper.Execute(clipType, m_output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    m_clipper.Clear();
+}
+
+template<typename TSubject, typename TClip>
+void ClipperContext::clip_polytree(ClipperLib::ClipType clipType, const TSubject &subject, const TClip &clip, bool safety_offset_)
+{
+    // Output to Paths first, then an additional union to build the PolyTree, see _clipper_do_polytree2() for the reasoning.
+    this->clip_paths(clipType, subject, clip, safety_offset_);
+    m_clipper.AddPaths(m_output, ClipperLib::ptSubject, true);
+    m_clipper.Execute(ClipperLib::ctUnion, m_polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    m_clipper.Clear();
+    // if safety_offset_, remove too small polygons & holes
+    if (safety_offset_)
+        for (int idx_poly = 0; idx_poly < m_polytree.ChildCount(); ++ idx_poly) {
+            ClipperLib::PolyNode *ex_polygon = m_polytree.Childs[idx_poly];
+            if (test_path(ex_polygon->Contour)) {
+                m_polytree.Childs.erase(m_polytree.Childs.begin() + idx_poly);
+                -- idx_poly;
+            } else {
+                for (int i = 0; i < ex_polygon->ChildCount(); ++ i)
+                    if (test_path(ex_polygon->Childs[i]->Contour)) {
+                        ex_polygon->Childs.erase(ex_polygon->Childs.begin() + i);
+                        -- i;
+                    }
+            }
+        }
+}
+
+ExPolygons ClipperContext::output_to_expolygons()
+{
+    m_clipper.Clear();
+    m_clipper.AddPaths(m_output, ClipperLib::ptSubject, true);
+    // offset results work with both EvenOdd and NonZero
+    m_clipper.Execute(ClipperLib::ctUnion, m_polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);
+    m_clipper.Clear();
+    return PolyTreeToExPolygons(m_polytree);
+}
+
+Polylines ClipperContext::clip_polylines(ClipperLib::ClipType clipType, const Polylines &subject, const Polygons &clip, bool safety_offset_)
+{
+    m_clipper.Clear();
+#ifdef SLIC3R_COORD32
+    multipoints_to_paths(subject, m_subject);
+    m_clipper.AddPaths(m_subject, ClipperLib::ptSubject, false);
+#else
+    Slic3rMultiPoints_to_ClipperPathViews(subject, m_subject_views);
+    m_clipper.AddPaths(m_subject_views, ClipperLib::ptSubject, false);
+#endif
+    this->add_closed(clip, ClipperLib::ptClip, safety_offset_);
+    m_clipper.Execute(clipType, m_polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    m_clipper.Clear();
+    ClipperLib::PolyTreeToPaths(m_polytree, m_output);
+    return ClipperPaths_to_Slic3rPolylines(m_output);
+}
+
+Polygons ClipperContext::offset(const Polygons &polygons, const double delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    multipoints_to_paths(polygons, m_subject);
+    scaleClipperPolygons(m_subject);
+    this->offset_paths(delta * float(CLIPPER_OFFSET_SCALE), joinType, miterLimit, miterLimit);
+    unscaleClipperPolygons(m_output);
+    return ClipperPaths_to_Slic3rPolygons(m_output);
+}
+
+ExPolygons ClipperContext::offset_ex(const Polygons &polygons, const double delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    multipoints_to_paths(polygons, m_subject);
+    scaleClipperPolygons(m_subject);
+    this->offset_paths(delta * float(CLIPPER_OFFSET_SCALE), joinType, miterLimit, miterLimit);
+    unscaleClipperPolygons(m_output);
+    return this->output_to_expolygons();
+}
+
+Polygons ClipperContext::offset(const ExPolygons &expolygons, const double delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    this->offset_expolygons(expolygons, delta, joinType, miterLimit);
+    return ClipperPaths_to_Slic3rPolygons(m_output);
+}
+
+ExPolygons ClipperContext::offset_ex(const ExPolygons &expolygons, const double delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    this->offset_expolygons(expolygons, delta, joinType, miterLimit);
+    return this->output_to_expolygons();
+}
+
+// Mirrors _offset2(), both offsets share the shortest edge length of the larger delta.
+void ClipperContext::offset2_paths(const Polygons &polygons, const double delta1, const double delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    const double delta_scaled1 = delta1 * float(CLIPPER_OFFSET_SCALE);
+    const double delta_scaled2 = delta2 * float(CLIPPER_OFFSET_SCALE);
+    const double edge_delta    = std::max(std::abs(delta_scaled1), std::abs(delta_scaled2));
+    multipoints_to_paths(polygons, m_subject);
+    scaleClipperPolygons(m_subject);
+    setup_offsetter(m_offsetter, edge_delta, joinType, miterLimit, miterLimit);
+    m_offsetter.AddPaths(m_subject, joinType, ClipperLib::etClosedPolygon);
+    m_offsetter.Execute(m_tmp, delta_scaled1);
+    m_offsetter.Clear();
+    m_offsetter.AddPaths(m_tmp, joinType, ClipperLib::etClosedPolygon);
+    m_offsetter.Execute(m_output, delta_scaled2);
+    m_offsetter.Clear();
+    unscaleClipperPolygons(m_output);
+}
+
+Polygons ClipperContext::offset2(const Polygons &polygons, const double delta1, const double delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    this->offset2_paths(polygons, delta1, delta2, joinType, miterLimit);
+    return ClipperPaths_to_Slic3rPolygons(m_output);
+}
+
+ExPolygons ClipperContext::offset2_ex(const Polygons &polygons, const double delta1, const double delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    this->offset2_paths(polygons, delta1, delta2, joinType, miterLimit);
+    return this->output_to_expolygons();
+}
+
+Polygons ClipperContext::diff(const Polygons &subject, const Polygons &clip, bool safety_offset_)
+{
+    this->clip_paths(ClipperLib::ctDifference, subject, clip, safety_offset_);
+    return ClipperPaths_to_Slic3rPolygons(m_output);
+}
+
+ExPolygons ClipperContext::diff_ex(const Polygons &subject, const Polygons &clip, bool safety_offset_)
+{
+    this->clip_polytree(ClipperLib::ctDifference, subject, clip, safety_offset_);
+    return PolyTreeToExPolygons(m_polytree);
+}
+
+ExPolygons ClipperContext::diff_ex(const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    this->clip_polytree(ClipperLib::ctDifference, subject, clip, safety_offset_);
+    return PolyTreeToExPolygons(m_polytree);
+}
+
+Polylines ClipperContext::diff_pl(const Polylines &subject, const Polygons &clip, bool safety_offset_)
+{
+    return this->clip_polylines(ClipperLib::ctDifference, subject, clip, safety_offset_);
+}
+
+Polygons ClipperContext::intersection(const Polygons &subject, const Polygons &clip, bool safety_offset_)
+{
+    this->clip_paths(ClipperLib::ctIntersection, subject, clip, safety_offset_);
+    return ClipperPaths_to_Slic3rPolygons(m_output);
+}
+
+ExPolygons ClipperContext::intersection_ex(const Polygons &subject, const Polygons &clip, bool safety_offset_)
+{
+    this->clip_polytree(ClipperLib::ctIntersection, subject, clip, safety_offset_);
+    return PolyTreeToExPolygons(m_polytree);
+}
+
+ExPolygons ClipperContext::intersection_ex(const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    this->clip_polytree(ClipperLib::ctIntersection, subject, clip, safety_offset_);
+    return PolyTreeToExPolygons(m_polytree);
+}
+
+Polylines ClipperContext::intersection_pl(const Polylines &subject, const Polygons &clip, bool safety_offset_)
+{
+    return this->clip_polylines(ClipperLib::ctIntersection, subject, clip, safety_offset_);
+}
+
+Polygons ClipperContext::union_(const Polygons &subject, bool safety_offset_)
+{
+    this->clip_paths(ClipperLib::ctUnion, subject, Polygons(), safety_offset_);
+    return ClipperPaths_to_Slic3rPolygons(m_output);
+}
+
+ExPolygons ClipperContext::union_ex(const Polygons &subject, bool safety_offset_)
+{
+    this->clip_polytree(ClipperLib::ctUnion, subject, Polygons(), safety_offset_);
+    return PolyTreeToExPolygons(m_polytree);
+}
+
+ExPolygons ClipperContext::union_ex(const ExPolygons &subject, bool safety_offset_)
+{
+    this->clip_polytree(ClipperLib::ctUnion, subject, Polygons(), safety_offset_);
+    return PolyTreeToExPolygons(m_polytree);
+}
+
 }
@@ -42,6 +42,17 @@ Slic3r::Polygons   ClipperPaths_to_Slic3rPolygons(const ClipperLib::Paths &input
 Slic3r::Polylines  ClipperPaths_to_Slic3rPolylines(const ClipperLib::Paths &input);
 Slic3r::ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input);
 
+#ifndef SLIC3R_COORD32
+// Slic3r::Point and ClipperLib::IntPoint share the memory layout, therefore the Slic3r contours may be passed to the Clipper
+// as views without copying their points. Only valid as long as the source polygons are alive and not modified.
+// With the 32bit coord_t the points have to be copied into ClipperLib::Paths.
+inline ClipperLib::PathView Slic3rPoints_to_ClipperPathView(const Points &points)
+    { return ClipperLib::PathView(reinterpret_cast<const ClipperLib::IntPoint*>(points.data()), points.size()); }
+void Slic3rMultiPoints_to_ClipperPathViews(const Polygons   &input, ClipperLib::PathViews &out);
+void Slic3rMultiPoints_to_ClipperPathViews(const Polylines  &input, ClipperLib::PathViews &out);
+void Slic3rMultiPoints_to_ClipperPathViews(const ExPolygons &input, ClipperLib::PathViews &out);
+#endif // SLIC3R_COORD32
+
 // offset Polygons
 ClipperLib::Paths _offset(ClipperLib::Path &&input, ClipperLib::EndType endType, const double delta, ClipperLib::JoinType joinType, double miterLimit);
 ClipperLib::Paths _offset(ClipperLib::Paths &&input, ClipperLib::EndType endType, const double delta, ClipperLib::JoinType joinType, double miterLimit);
@@ -333,6 +344,74 @@ Polygons  variable_offset_outer(const ExPolygon &expoly, const std::vector<std::
 ExPolygons variable_offset_outer_ex(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit = 2.);
 ExPolygons variable_offset_inner_ex(const ExPolygon &expoly, const std::vector<std::vector<float>> &deltas, double miter_limit = 2.);
 
+// Scratch space for the Clipper operations, one instance per thread (see ClipperContext::local()).
+// The free functions above convert their input into freshly allocated ClipperLib::Paths and construct a new Clipper / ClipperOffset
+// for each call, which produces a lot of allocator traffic when called from the tight loops of the perimeter generator, infill or supports.
+// The context keeps the Clipper engines and the input / output Paths alive between the calls, so that their memory is reused.
+// The results are identical to the results of the free functions of the same name.
+// Each call is done with the buffers before it returns, therefore the calls may be nested as arguments of each other.
+class ClipperContext
+{
+public:
+    // Instance owned by the calling thread.
+    static ClipperContext&  local();
+
+    Polygons    offset   (const Polygons   &polygons,   const double delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3);
+    Polygons    offset   (const ExPolygons &expolygons, const double delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3);
+    ExPolygons  offset_ex(const Polygons   &polygons,   const double delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3);
+    ExPolygons  offset_ex(const ExPolygons &expolygons, const double delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3);
+    Polygons    offset2   (const Polygons &polygons, const double delta1, const double delta2, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3);
+    ExPolygons  offset2_ex(const Polygons &polygons, const double delta1, const double delta2, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3);
+
+    Polygons    diff           (const Polygons   &subject, const Polygons   &clip, bool safety_offset_ = false);
+    ExPolygons  diff_ex        (const Polygons   &subject, const Polygons   &clip, bool safety_offset_ = false);
+    ExPolygons  diff_ex        (const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_ = false);
+    Polylines   diff_pl        (const Polylines  &subject, const Polygons   &clip, bool safety_offset_ = false);
+    Polygons    intersection   (const Polygons   &subject, const Polygons   &clip, bool safety_offset_ = false);
+    ExPolygons  intersection_ex(const Polygons   &subject, const Polygons   &clip, bool safety_offset_ = false);
+    ExPolygons  intersection_ex(const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_ = false);
+    Polylines   intersection_pl(const Polylines  &subject, const Polygons   &clip, bool safety_offset_ = false);
+    Polygons    union_         (const Polygons   &subject, bool safety_offset_ = false);
+    ExPolygons  union_ex       (const Polygons   &subject, bool safety_offset_ = false);
+    ExPolygons  union_ex       (const ExPolygons &subject, bool safety_offset_ = false);
+
+private:
+    ClipperContext() = default;
+    ClipperContext(const ClipperContext&) = delete;
+    ClipperContext& operator=(const ClipperContext&) = delete;
+
+    // Offset of closed m_subject (already scaled), result into m_output (scaled).
+    void        offset_paths(const double delta_scaled, ClipperLib::JoinType joinType, double arcTolerance, double miterLimit);
+    // Double offset of the polygons, unscaled result into m_output.
+    void        offset2_paths(const Polygons &polygons, const double delta1, const double delta2, ClipperLib::JoinType joinType, double miterLimit);
+    // Offset of the expolygons, unscaled result into m_output.
+    void        offset_expolygons(const ExPolygons &expolygons, const double delta, ClipperLib::JoinType joinType, double miterLimit);
+    // Add closed polygons to m_clipper. They are passed as views unless a safety offset is requested, which needs a copy to modify.
+    template<typename TPolygons>
+    void        add_closed(const TPolygons &polygons, ClipperLib::PolyType type, bool safety_offset_);
+    // Boolean operation, result into m_output.
+    template<typename TSubject, typename TClip>
+    void        clip_paths(ClipperLib::ClipType clipType, const TSubject &subject, const TClip &clip, bool safety_offset_);
+    // Boolean operation, result into m_polytree. Mirrors _clipper_do_polytree2().
+    template<typename TSubject, typename TClip>
+    void        clip_polytree(ClipperLib::ClipType clipType, const TSubject &subject, const TClip &clip, bool safety_offset_);
+    // Union of m_output into ExPolygons, as ClipperPaths_to_Slic3rExPolygons() does.
+    ExPolygons  output_to_expolygons();
+    Polylines   clip_polylines(ClipperLib::ClipType clipType, const Polylines &subject, const Polygons &clip, bool safety_offset_);
+
+    ClipperLib::Clipper         m_clipper;
+    ClipperLib::ClipperOffset   m_offsetter;
+    ClipperLib::PolyTree        m_polytree;
+    ClipperLib::Paths           m_subject;
+    ClipperLib::Paths           m_clip;
+    ClipperLib::Paths           m_output;
+    ClipperLib::Paths           m_contours;
+    ClipperLib::Paths           m_holes;
+    ClipperLib::Paths           m_tmp;
+    ClipperLib::PathViews       m_subject_views;
+    ClipperLib::PathViews       m_clip_views;
+};
+
 }
 
 #endif
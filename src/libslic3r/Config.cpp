@@ -5,6 +5,7 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <iterator>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/erase.hpp>
@@ -324,7 +325,8 @@ ConfigOptionDef* ConfigDef::add(const t_config_option_key &opt_key, ConfigOption
     opt->opt_key = opt_key;
     opt->type = type;
     opt->serialization_key_ordinal = ++ serialization_key_ordinal_last;
-    this->by_serialization_key_ordinal[opt->serialization_key_ordinal] = opt;
+    // The ordinals are increasing, append at the end of the map.
+    this->by_serialization_key_ordinal.emplace_hint(this->by_serialization_key_ordinal.end(), opt->serialization_key_ordinal, opt);
     return opt;
 }
 
@@ -955,7 +957,54 @@ void ConfigBase::null_nullables()
 DynamicConfig::DynamicConfig(const ConfigBase& rhs, const t_config_option_keys& keys)
 {
 	for (const t_config_option_key& opt_key : keys)
-		this->options[opt_key] = std::unique_ptr<ConfigOption>(rhs.option(opt_key)->clone());
+		this->set_key_value(opt_key, rhs.option(opt_key)->clone());
+}
+
+DynamicConfig& DynamicConfig::operator+=(const DynamicConfig &rhs)
+{
+    assert(this->def() == nullptr || this->def() == rhs.def());
+    // Merge the two sorted sequences of options.
+    options_type merged;
+    merged.reserve(this->options.size() + rhs.options.size());
+    auto it1 = this->options.begin();
+    for (const auto &kvp : rhs.options) {
+        for (; it1 != this->options.end() && it1->first < kvp.first; ++ it1)
+            merged.emplace_back(std::move(*it1));
+        if (it1 != this->options.end() && it1->first == kvp.first) {
+            assert(it1->second->type() == kvp.second->type());
+            if (it1->second->type() == kvp.second->type())
+                it1->second->set(kvp.second.get());
+            else
+                it1->second.reset(kvp.second->clone());
+            merged.emplace_back(std::move(*it1 ++));
+        } else
+            merged.emplace_back(kvp.first, std::unique_ptr<ConfigOption>(kvp.second->clone()));
+    }
+    std::move(it1, this->options.end(), std::back_inserter(merged));
+    this->options = std::move(merged);
+    return *this;
+}
+
+DynamicConfig& DynamicConfig::operator+=(DynamicConfig &&rhs)
+{
+    assert(this->def() == nullptr || this->def() == rhs.def());
+    // Merge the two sorted sequences of options.
+    options_type merged;
+    merged.reserve(this->options.size() + rhs.options.size());
+    auto it1 = this->options.begin();
+    for (auto &kvp : rhs.options) {
+        for (; it1 != this->options.end() && it1->first < kvp.first; ++ it1)
+            merged.emplace_back(std::move(*it1));
+        if (it1 != this->options.end() && it1->first == kvp.first) {
+            assert(it1->second->type() == kvp.second->type());
+            ++ it1;
+        }
+        merged.emplace_back(std::move(kvp));
+    }
+    std::move(it1, this->options.end(), std::back_inserter(merged));
+    this->options = std::move(merged);
+    rhs.options.clear();
+    return *this;
 }
 
 bool DynamicConfig::operator==(const DynamicConfig &rhs) const
@@ -974,20 +1023,16 @@ bool DynamicConfig::operator==(const DynamicConfig &rhs) const
 // Remove options with all nil values, those are optional and it does not help to hold them.
 size_t DynamicConfig::remove_nil_options()
 {
-	size_t cnt_removed = 0;
-	for (auto it = options.begin(); it != options.end();)
-		if (it->second->is_nil()) {
-			it = options.erase(it);
-			++ cnt_removed;
-		} else
-			++ it;
+	auto it = std::remove_if(options.begin(), options.end(), [](const options_type::value_type &kvp) { return kvp.second->is_nil(); });
+	size_t cnt_removed = size_t(options.end() - it);
+	options.erase(it, options.end());
 	return cnt_removed;
 }
 
 ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key, bool create)
 {
-    auto it = options.find(opt_key);
-    if (it != options.end())
+    auto it = this->lower_bound(opt_key);
+    if (it != options.end() && it->first == opt_key)
         // Option was found.
         return it->second.get();
     if (! create)
@@ -1003,13 +1048,13 @@ ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key, bool cre
         // Let the parent decide what to do if the opt_key is not defined by this->def().
         return nullptr;
     ConfigOption *opt = optdef->create_default_option();
-    this->options.emplace_hint(it, opt_key, std::unique_ptr<ConfigOption>(opt));
+    this->options.emplace(it, opt_key, std::unique_ptr<ConfigOption>(opt));
     return opt;
 }
 
 const ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key) const
 {
-    auto it = options.find(opt_key);
+    auto it = this->find(opt_key);
     if (it == options.end()) {
         //if not find, try with the parent config.
         if (parent != nullptr)
@@ -2,6 +2,7 @@
 #define slic3r_Config_hpp_
 
 #include <assert.h>
+#include <algorithm>
 #include <map>
 #include <climits>
 #include <cstdio>
@@ -2114,8 +2115,10 @@ public:
     {
         assert(this->def() == nullptr || this->def() == rhs.def());
         this->clear();
+        this->options.reserve(rhs.options.size());
+        // rhs.options are sorted already.
         for (const auto &kvp : rhs.options)
-            this->options[kvp.first].reset(kvp.second->clone());
+            this->options.emplace_back(kvp.first, std::unique_ptr<ConfigOption>(kvp.second->clone()));
         return *this;
     }
 
@@ -2132,41 +2135,11 @@ public:
 
     // Add a content of one DynamicConfig to another DynamicConfig.
     // If rhs.def() is not null, then it has to be equal to this->def().
-    DynamicConfig& operator+=(const DynamicConfig &rhs)
-    {
-        assert(this->def() == nullptr || this->def() == rhs.def());
-        for (const auto &kvp : rhs.options) {
-            auto it = this->options.find(kvp.first);
-            if (it == this->options.end())
-                this->options[kvp.first].reset(kvp.second->clone());
-            else {
-                assert(it->second->type() == kvp.second->type());
-                if (it->second->type() == kvp.second->type())
-                    *it->second = *kvp.second;
-                else
-                    it->second.reset(kvp.second->clone());
-            }
-        }
-        return *this;
-    }
+    DynamicConfig& operator+=(const DynamicConfig &rhs);
 
     // Move a content of one DynamicConfig to another DynamicConfig.
     // If rhs.def() is not null, then it has to be equal to this->def().
-    DynamicConfig& operator+=(DynamicConfig &&rhs) 
-    {
-        assert(this->def() == nullptr || this->def() == rhs.def());
-        for (auto &kvp : rhs.options) {
-            auto it = this->options.find(kvp.first);
-            if (it == this->options.end()) {
-                this->options.insert(std::make_pair(kvp.first, std::move(kvp.second)));
-            } else {
-                assert(it->second->type() == kvp.second->type());
-                it->second = std::move(kvp.second);
-            }
-        }
-        rhs.options.clear();
-        return *this;
-    }
+    DynamicConfig& operator+=(DynamicConfig &&rhs);
 
     bool           operator==(const DynamicConfig &rhs) const;
     bool           operator!=(const DynamicConfig &rhs) const { return ! (*this == rhs); }
@@ -2183,7 +2156,7 @@ public:
 
     bool erase(const t_config_option_key &opt_key)
     { 
-        auto it = this->options.find(opt_key);
+        auto it = this->find(opt_key);
         if (it == this->options.end())
             return false;
         this->options.erase(it);
@@ -2213,9 +2186,9 @@ public:
     // Be careful, as this method does not test the existence of opt_key in this->def().
     bool                    set_key_value(const std::string &opt_key, ConfigOption *opt)
     {
-        auto it = this->options.find(opt_key);
-        if (it == this->options.end()) {
-            this->options[opt_key].reset(opt);
+        auto it = this->lower_bound(opt_key);
+        if (it == this->options.end() || it->first != opt_key) {
+            this->options.emplace(it, opt_key, std::unique_ptr<ConfigOption>(opt));
             return true;
         } else {
             it->second.reset(opt);
@@ -2252,12 +2225,26 @@ public:
     void                read_cli(const std::vector<std::string> &tokens, t_config_option_keys* extra, t_config_option_keys* keys = nullptr);
     bool                read_cli(int argc, const char* const argv[], t_config_option_keys* extra, t_config_option_keys* keys = nullptr);
 
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator cbegin() const { return options.cbegin(); }
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator cend()   const { return options.cend(); }
-    size_t                        												 size()   const { return options.size(); }
+    // The options are kept sorted by their keys in a flat vector: One allocation for the whole DynamicConfig instead of a tree node
+    // per option, a binary search over a contiguous memory on lookup and a linear copy / comparison of the configs.
+    using options_type = std::vector<std::pair<t_config_option_key, std::unique_ptr<ConfigOption>>>;
+
+    options_type::const_iterator cbegin() const { return options.cbegin(); }
+    options_type::const_iterator cend()   const { return options.cend(); }
+    size_t                       size()   const { return options.size(); }
 
 private:
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>> options;
+    // First option with a key not less than opt_key.
+    options_type::iterator       lower_bound(const t_config_option_key &opt_key)
+        { return std::lower_bound(options.begin(), options.end(), opt_key, [](const options_type::value_type &l, const t_config_option_key &r) { return l.first < r; }); }
+    options_type::const_iterator lower_bound(const t_config_option_key &opt_key) const
+        { return const_cast<DynamicConfig*>(this)->lower_bound(opt_key); }
+    options_type::iterator       find(const t_config_option_key &opt_key)
+        { auto it = this->lower_bound(opt_key); return (it == options.end() || it->first != opt_key) ? options.end() : it; }
+    options_type::const_iterator find(const t_config_option_key &opt_key) const
+        { return const_cast<DynamicConfig*>(this)->find(opt_key); }
+
+    options_type options;
 
 	friend class cereal::access;
 	template<class Archive> void serialize(Archive &ar) { ar(options); }
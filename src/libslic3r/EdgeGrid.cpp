@@ -1,8 +1,11 @@
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <float.h>
 #include <unordered_map>
 
+#include <tbb/parallel_for.h>
+
 #include <png.h>
 
 #include "libslic3r.h"
@@ -168,6 +171,14 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	m_rows = (m_bbox.max(1) - m_bbox.min(1) + m_resolution - 1) / m_resolution;
 	m_cells.assign(m_rows * m_cols, Cell());
 
+	size_t num_edges = 0;
+	for (const Slic3r::Points *pts : m_contours)
+		num_edges += pts->size();
+	if (num_edges >= 8192) {
+		this->rasterize_m_contours_parallel(num_edges);
+		return;
+	}
+
 	// 3) First round of contour rasterization, count the edges per grid cell.
 	for (size_t i = 0; i < m_contours.size(); ++ i) {
 		const Slic3r::Points &pts = *m_contours[i];
@@ -339,6 +350,70 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 						}
 						}
 
+// Rasterize the contours over many threads, same as the serial rasterization in create_from_m_contours().
+// The cells are filled in an arbitrary order, then the edges of each cell are sorted to the serial order (by contour, then by edge).
+void EdgeGrid::Grid::rasterize_m_contours_parallel(size_t num_edges)
+{
+	// Index of the first edge of each contour, to split the rasterization by edges, not by possibly few huge contours.
+	std::vector<size_t> contour_first_edge;
+	contour_first_edge.reserve(m_contours.size() + 1);
+	contour_first_edge.emplace_back(0);
+	for (const Slic3r::Points *pts : m_contours)
+		contour_first_edge.emplace_back(contour_first_edge.back() + pts->size());
+	assert(contour_first_edge.back() == num_edges);
+
+	auto visit_edges = [this, &contour_first_edge, num_edges](auto &&visitor_factory) {
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, num_edges, 1024), [this, &contour_first_edge, &visitor_factory](const tbb::blocked_range<size_t> &range) {
+			size_t i = std::upper_bound(contour_first_edge.begin(), contour_first_edge.end(), range.begin()) - contour_first_edge.begin() - 1;
+			for (size_t idx_edge = range.begin(); idx_edge < range.end(); ++ idx_edge) {
+				while (idx_edge >= contour_first_edge[i + 1])
+					++ i;
+				const Slic3r::Points &pts = *m_contours[i];
+				const size_t         j   = idx_edge - contour_first_edge[i];
+				auto visitor = visitor_factory(i, j);
+				this->visit_cells_intersecting_line(pts[j], pts[(j + 1 == pts.size()) ? 0 : j + 1], visitor);
+			}
+		});
+	};
+
+	// 1) Count the edges per grid cell.
+	std::vector<std::atomic<size_t>> cursors(m_cells.size());
+	for (std::atomic<size_t> &cursor : cursors)
+		cursor.store(0, std::memory_order_relaxed);
+	visit_edges([this, &cursors](size_t, size_t) {
+		return [this, &cursors](coord_t iy, coord_t ix) {
+			cursors[iy * m_cols + ix].fetch_add(1, std::memory_order_relaxed);
+			// Continue traversing the grid along the edge.
+			return true;
+		};
+	});
+
+	// 2) Prefix sum the numbers of hits per cells to get an index into m_cell_data.
+	size_t cnt = 0;
+	for (size_t i = 0; i < m_cells.size(); ++ i) {
+		m_cells[i].begin = cnt;
+		cnt += cursors[i].load(std::memory_order_relaxed);
+		m_cells[i].end = cnt;
+		cursors[i].store(m_cells[i].begin, std::memory_order_relaxed);
+	}
+	m_cell_data.assign(cnt, std::pair<size_t, size_t>(size_t(-1), size_t(-1)));
+
+	// 3) Fill in m_cell_data by rasterizing the lines once again.
+	visit_edges([this, &cursors](size_t i, size_t j) {
+		return [this, &cursors, i, j](coord_t iy, coord_t ix) {
+			m_cell_data[cursors[iy * m_cols + ix].fetch_add(1, std::memory_order_relaxed)] = std::pair<size_t, size_t>(i, j);
+			return true;
+		};
+	});
+
+	// 4) Restore the order of the serial rasterization.
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, m_cells.size()), [this](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i) {
+			std::sort(m_cell_data.begin() + m_cells[i].begin, m_cell_data.begin() + m_cells[i].end);
+		}
+	});
+}
+
 #if 0
 // Divide, round to a grid coordinate.
 // Divide x/y, round down. y is expected to be positive.
@@ -17,6 +17,11 @@ class Grid
 public:
 	Grid();
 	~Grid();
+	Grid(const Grid &rhs) = default;
+	// The contours are referenced by pointers to their Points, moving the grid together with the polygons it was created from keeps them valid.
+	Grid(Grid &&rhs) = default;
+	Grid& operator=(const Grid &rhs) = default;
+	Grid& operator=(Grid &&rhs) = default;
 
 	void set_bbox(const BoundingBox &bbox) { m_bbox = bbox; }
 
@@ -277,6 +282,7 @@ protected:
 	};
 
 	void create_from_m_contours(coord_t resolution);
+	void rasterize_m_contours_parallel(size_t num_edges);
 #if 0
 	bool line_cell_intersect(const Point &p1, const Point &p2, const Cell &cell);
 #endif
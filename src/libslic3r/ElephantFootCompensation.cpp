@@ -13,6 +13,8 @@
 #include <cmath>
 #include <cassert>
 
+#include <tbb/parallel_for.h>
+
 // #define CONTOUR_DISTANCE_DEBUG_SVG
 
 namespace Slic3r {
@@ -565,11 +567,14 @@ ExPolygon elephant_foot_compensation(const ExPolygon &input_expoly, double min_c
 		bbox.offset(SCALED_EPSILON);
 		grid.set_bbox(bbox);
 		grid.create(simplified, coord_t(0.7 * search_radius));
-		std::vector<std::vector<float>> deltas;
-		deltas.reserve(simplified.holes.size() + 1);
+		// The grid is only read from here on, thus the distance fields of the contour and of the holes may be calculated in parallel.
+		std::vector<std::vector<float>> deltas(simplified.holes.size() + 1);
 		ExPolygon resampled(simplified);
 		double resample_interval = scale_(0.5);
-		for (size_t idx_contour = 0; idx_contour <= simplified.holes.size(); ++ idx_contour) {
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, simplified.holes.size() + 1),
+			[&grid, &resampled, &deltas, resample_interval, scaled_compensation, scaled_min_contour_width, min_contour_width_compensated, search_radius]
+			(const tbb::blocked_range<size_t> &range) {
+		for (size_t idx_contour = range.begin(); idx_contour < range.end(); ++ idx_contour) {
 			Polygon &poly = (idx_contour == 0) ? resampled.contour : resampled.holes[idx_contour - 1];
 			std::vector<ResampledPoint> resampled_point_parameters;
 			poly.points = resample_polygon(poly.points, resample_interval, resampled_point_parameters);
@@ -588,8 +593,9 @@ ExPolygon elephant_foot_compensation(const ExPolygon &input_expoly, double min_c
 			}
 	//		smooth_compensation(dists, 0.4f, 10);
 			smooth_compensation_banded(poly.points, float(0.8 * resample_interval), dists, 0.3f, 3);
-			deltas.emplace_back(dists);
+			deltas[idx_contour] = std::move(dists);
 		}
+		});
 
 		ExPolygons out_vec = variable_offset_inner_ex(resampled, deltas, 2.);
 		if (out_vec.size() == 1)
@@ -622,19 +628,25 @@ ExPolygon  elephant_foot_compensation(const ExPolygon  &input, const Flow &exter
 
 ExPolygons elephant_foot_compensation(const ExPolygons &input, const Flow &external_perimeter_flow, const double compensation)
 {
-	ExPolygons out;
-	out.reserve(input.size());
-	for (const ExPolygon &expoly : input)
-		out.emplace_back(elephant_foot_compensation(expoly, external_perimeter_flow, compensation));
+	// The islands are compensated independently of each other.
+	ExPolygons out(input.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, input.size()),
+		[&input, &out, &external_perimeter_flow, compensation](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			out[i] = elephant_foot_compensation(input[i], external_perimeter_flow, compensation);
+	});
 	return out;
 }
 
 ExPolygons elephant_foot_compensation(const ExPolygons &input, double min_contour_width, const double compensation)
 {
-	ExPolygons out;
-	out.reserve(input.size());
-	for (const ExPolygon &expoly : input)
-		out.emplace_back(elephant_foot_compensation(expoly, min_contour_width, compensation));
+	// The islands are compensated independently of each other.
+	ExPolygons out(input.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, input.size()),
+		[&input, &out, min_contour_width, compensation](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			out[i] = elephant_foot_compensation(input[i], min_contour_width, compensation);
+	});
 	return out;
 }
 
@@ -118,6 +118,77 @@ bool ExPolygon::contains(const Point &point) const
     return true;
 }
 
+void ExPolygonContainsIndex::create(const ExPolygon &expolygon)
+{
+    this->clear();
+    if (expolygon.contour.points.size() < 3)
+        return;
+    BoundingBox bbox = get_extents(expolygon.contour);
+    size_t num_edges = 0;
+    for (size_t i = 0; i < expolygon.num_contours(); ++ i)
+        num_edges += expolygon.contour_or_hole(i).points.size();
+    // A few edges per slab on average.
+    const size_t num_slabs = std::clamp<size_t>(num_edges / 4, 1, 4096);
+    m_ymin        = bbox.min.y();
+    m_slab_height = std::max<coord_t>(1, coord_t((int64_t(bbox.max.y()) - int64_t(bbox.min.y()) + num_slabs) / num_slabs));
+    m_slabs.assign(num_slabs + 1, 0);
+    auto slab_range = [this, num_slabs](const Point &a, const Point &b) {
+        // The crossing test only counts the edges with min(y) <= point.y < max(y), horizontal edges never count.
+        coord_t ymin = std::min(a.y(), b.y());
+        coord_t ymax = std::max(a.y(), b.y());
+        if (ymin == ymax || ymax <= m_ymin)
+            return std::make_pair(size_t(0), size_t(0));
+        return std::make_pair(size_t(std::max<int64_t>(0, (int64_t(ymin) - m_ymin) / m_slab_height)),
+                              size_t(std::min<int64_t>(num_slabs, (int64_t(ymax) - 1 - m_ymin) / m_slab_height + 1)));
+    };
+    // Count the edges of each slab, then fill them in the order of the contours.
+    for (size_t i = 0; i < expolygon.num_contours(); ++ i) {
+        const Points &pts = expolygon.contour_or_hole(i).points;
+        for (size_t j = 0, k = pts.size() - 1; j < pts.size(); k = j ++) {
+            auto range = slab_range(pts[j], pts[k]);
+            for (size_t slab = range.first; slab < range.second; ++ slab)
+                ++ m_slabs[slab + 1];
+        }
+    }
+    for (size_t slab = 0; slab < num_slabs; ++ slab)
+        m_slabs[slab + 1] += m_slabs[slab];
+    m_edges.resize(m_slabs.back());
+    std::vector<uint32_t> slab_end(m_slabs.begin(), m_slabs.end() - 1);
+    for (size_t i = 0; i < expolygon.num_contours(); ++ i) {
+        const Points &pts = expolygon.contour_or_hole(i).points;
+        for (size_t j = 0, k = pts.size() - 1; j < pts.size(); k = j ++) {
+            auto range = slab_range(pts[j], pts[k]);
+            for (size_t slab = range.first; slab < range.second; ++ slab)
+                m_edges[slab_end[slab] ++] = { pts[j], pts[k], uint32_t(i) };
+        }
+    }
+}
+
+bool ExPolygonContainsIndex::contains(const Point &point) const
+{
+    if (m_slabs.empty() || point.y() < m_ymin)
+        return false;
+    size_t slab = size_t((int64_t(point.y()) - m_ymin) / m_slab_height);
+    if (slab + 1 >= m_slabs.size())
+        return false;
+    // Parity of the crossings of the contour being processed, the point has to be inside the contour and outside of all the holes.
+    uint32_t contour = 0;
+    bool     inside  = false;
+    for (auto it = m_edges.begin() + m_slabs[slab]; it != m_edges.begin() + m_slabs[slab + 1]; ++ it) {
+        if (it->contour != contour) {
+            if (inside != (contour == 0))
+                return false;
+            contour = it->contour;
+            inside  = false;
+        }
+        // The same test as Polygon::contains().
+        if (((it->a.y() > point.y()) != (it->b.y() > point.y()))
+            && ((double)point.x() < (double)(it->b.x() - it->a.x()) * (double)(point.y() - it->a.y()) / (double)(it->b.y() - it->a.y()) + (double)it->a.x()))
+            inside = ! inside;
+    }
+    return inside == (contour == 0);
+}
+
 // inclusive version of contains() that also checks whether point is on boundaries
 bool ExPolygon::contains_b(const Point &point) const
 {
@@ -89,6 +89,39 @@ public:
 inline bool operator==(const ExPolygon &lhs, const ExPolygon &rhs) { return lhs.contour == rhs.contour && lhs.holes == rhs.holes; }
 inline bool operator!=(const ExPolygon &lhs, const ExPolygon &rhs) { return lhs.contour != rhs.contour || lhs.holes != rhs.holes; }
 
+// Index of the edges of an ExPolygon for repeated point in polygon queries against the same ExPolygon.
+// The edges are binned into horizontal slabs, a query only tests the edges overlapping the slab of the point
+// with the same crossing test as ExPolygon::contains(), thus it returns the same result.
+// The index keeps a copy of the edges, it does not reference the ExPolygon.
+class ExPolygonContainsIndex
+{
+public:
+    ExPolygonContainsIndex() = default;
+    explicit ExPolygonContainsIndex(const ExPolygon &expolygon) { this->create(expolygon); }
+
+    void create(const ExPolygon &expolygon);
+    void clear() { m_slabs.clear(); m_edges.clear(); }
+    bool empty() const { return m_slabs.empty(); }
+
+    // Same as ExPolygon::contains(point) of the indexed ExPolygon.
+    bool contains(const Point &point) const;
+
+private:
+    struct Edge {
+        // Current and previous point of the contour, in the order of Polygon::contains().
+        Point       a;
+        Point       b;
+        // 0 for the contour, 1 + index of a hole.
+        uint32_t    contour;
+    };
+    coord_t                 m_ymin        { 0 };
+    coord_t                 m_slab_height { 1 };
+    // Start of the edges of each slab in m_edges, one more item than the number of slabs.
+    std::vector<uint32_t>   m_slabs;
+    // Edges of the slabs sorted by their contour.
+    std::vector<Edge>       m_edges;
+};
+
 // Count a nuber of polygons stored inside the vector of expolygons.
 // Useful for allocating space for polygons when converting expolygons to polygons.
 inline size_t number_polygons(const ExPolygons &expolys)
@@ -149,6 +149,20 @@ ExtrusionEntityCollection ExtrusionEntityCollection::flatten(bool preserve_order
     return FlatenEntities(preserve_ordering).flatten(*this);
 
 }
+void ExtrusionEntityCollection::flatten_references(ExtrusionEntitiesPtr &out, bool preserve_ordering) const
+{
+    if (this->no_sort && preserve_ordering) {
+        // flatten() would produce a copy of this collection with the same hierarchy, point to the original instead.
+        out.emplace_back(const_cast<ExtrusionEntityCollection*>(this));
+        return;
+    }
+    for (ExtrusionEntity *entity : this->entities)
+        if (entity->is_collection())
+            static_cast<const ExtrusionEntityCollection*>(entity)->flatten_references(out, preserve_ordering);
+        else
+            out.emplace_back(entity);
+}
+
 void
 FlatenEntities::use(const ExtrusionEntityCollection &coll) {
     if ((coll.no_sort || this->to_fill.no_sort) && preserve_ordering) {
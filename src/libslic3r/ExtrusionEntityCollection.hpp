@@ -112,9 +112,25 @@ public:
     /// Recursively count paths and loops contained in this collection 
     size_t items_count() const;
     /// Returns a flattened copy of this ExtrusionEntityCollection. That is, all of the items in its entities vector are not collections.
-    /// You should be iterating over flatten().entities if you are interested in the underlying ExtrusionEntities (and don't care about hierarchy).
+    /// Use for_each_leaf() instead if you are only interested in the underlying ExtrusionEntities (and don't care about hierarchy).
     /// \param preserve_ordering Flag to method that will flatten if and only if the underlying collection is sortable when True (default: False).
     ExtrusionEntityCollection flatten(bool preserve_ordering = false) const;
+    /// Same as flatten(), but the leaves are not cloned: their pointers are appended to out and they stay owned by this collection.
+    /// With preserve_ordering, a no_sort collection is appended as a whole instead of its flattened copy.
+    void flatten_references(ExtrusionEntitiesPtr &out, bool preserve_ordering = false) const;
+    /// Calls fn(const ExtrusionEntity &leaf) on each non-collection entity of the hierarchy, depth first.
+    /// Neither copies nor allocates: prefer it to flatten() to only visit the leaves.
+    template<typename Fn> void for_each_leaf(Fn &&fn) const {
+        for (const ExtrusionEntity *entity : this->entities)
+            if (entity->is_collection())
+                static_cast<const ExtrusionEntityCollection*>(entity)->for_each_leaf(fn);
+            else
+                fn(*entity);
+    }
+    /// Same as for_each_leaf(fn), only the leaves of the given role are visited.
+    template<typename Fn> void for_each_leaf(ExtrusionRole role, Fn &&fn) const {
+        this->for_each_leaf([role, &fn](const ExtrusionEntity &leaf) { if (leaf.role() == role) fn(leaf); });
+    }
     double total_volume() const override { double volume=0.; for (const auto& ent : entities) volume+=ent->total_volume(); return volume; }
 
     // Following methods shall never be called on an ExtrusionEntityCollection.
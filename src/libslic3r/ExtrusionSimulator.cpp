@@ -13,6 +13,8 @@
 
 #include <boost/multi_array.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include "libslic3r.h"
 #include "ExtrusionSimulator.hpp"
 
@@ -559,8 +561,28 @@ void gcode_paint_layer(
 		float area = polyArea(rect, 4);
 		assert(area > 0.f);
 #endif /* _DEBUG */
+		// Is the point inside the rectangle? The rectangle is oriented counter-clockwise.
+		auto inside_rect = [&rect](const V2f &pt) {
+			for (int k = 0; k < 4; ++ k)
+				if (cross(rect[(k + 1) % 4] - rect[k], pt - rect[k]) < 0.f)
+					return false;
+			return true;
+		};
 		for (int j = bboxLinei.min_corner().y(); j + 1 < bboxLinei.max_corner().y(); ++ j) {
+			// Corners of the first cell of this row at the bottom / top edge, inside the rectangle?
+			bool bottom_left = inside_rect(V2f(float(bboxLinei.min_corner().x()), float(j)));
+			bool top_left    = inside_rect(V2f(float(bboxLinei.min_corner().x()), float(j + 1)));
 			for (int i = bboxLinei.min_corner().x(); i + 1 < bboxLinei.max_corner().x(); ++i) {
+				bool bottom_right = inside_rect(V2f(float(i + 1), float(j)));
+				bool top_right    = inside_rect(V2f(float(i + 1), float(j + 1)));
+				bool inside       = bottom_left && top_left && bottom_right && top_right;
+				bottom_left = bottom_right;
+				top_left    = top_right;
+				if (inside) {
+					// The cell is fully covered by the convex extrusion rectangle, don't clip.
+					acc[j][i] += thickness;
+					continue;
+				}
 				V2f rect2[8];
 				memcpy(rect2, rect, sizeof(rect));
 				int n = clip_rect_by_AABB(rect2, B2f(V2f(float(i), float(j)), V2f(float(i + 1), float(j + 1))));
@@ -990,7 +1012,8 @@ void ExtrusionSimulator::evaluate_accumulator(ExtrusionSimulationType simulation
 	if (simulationType > ExtrusionSimulationDontSpread) {
 		// Average the cells of a bitmap into a lower resolution floating point mask.
 		A2f mask(boost::extents[sz.y()][sz.x()]);
-		for (int r = 0; r < sz.y(); ++r) {
+		tbb::parallel_for(tbb::blocked_range<int>(0, sz.y()), [this, &mask, &sz](const tbb::blocked_range<int> &range) {
+		for (int r = range.begin(); r < range.end(); ++r) {
 			for (int c = 0; c < sz.x(); ++c) {
 				float p = 0;
 				for (unsigned int j = 0; j < pimpl->bitmap_oversampled; ++ j) {
@@ -1003,13 +1026,15 @@ void ExtrusionSimulator::evaluate_accumulator(ExtrusionSimulationType simulation
 				mask[r][c] = p;
 			}
 		}
+		});
 
 		// Spread the excess of the material.
 		gcode_spread_points(pimpl->accumulator, mask, pimpl->extrusion_points, simulationType);
 	}
 
 	// Color map the accumulator.
-	for (int r = 0; r < sz.y(); ++r) {
+	tbb::parallel_for(tbb::blocked_range<int>(0, sz.y()), [this, &sz](const tbb::blocked_range<int> &range) {
+	for (int r = range.begin(); r < range.end(); ++r) {
 		unsigned char *ptr = &pimpl->image_data[(image_size.x() * (viewport.min.y() + r) + viewport.min.x()) * 4];
 		for (int c = 0; c < sz.x(); ++c) {
 			#if 1
@@ -1025,6 +1050,7 @@ void ExtrusionSimulator::evaluate_accumulator(ExtrusionSimulationType simulation
 			*ptr ++ = (idx == 0) ? 0 : 255;
 		}
 	}
+	});
 }
 
 } // namespace Slic3r
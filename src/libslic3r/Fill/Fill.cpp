@@ -2,12 +2,15 @@
 #include <stdio.h>
 #include <memory>
 
+#include <tbb/parallel_for.h>
+
 #include "../ClipperUtils.hpp"
 #include "../Geometry.hpp"
 #include "../Layer.hpp"
 #include "../Print.hpp"
 #include "../PrintConfig.hpp"
 #include "../Surface.hpp"
+#include "../Tracing.hpp"
 
 #include "FillBase.hpp"
 #include "FillRectilinear.hpp"
@@ -297,16 +300,17 @@ std::vector<SurfaceFill> group_fills(const Layer &layer)
             }
         if (! voids.empty() && ! surfaces_polygons.empty()) {
             // First clip voids by the printing polygons, as the voids were ignored by the loop above during mutual clipping.
-            voids = diff(voids, surfaces_polygons);
+            ClipperContext &clipper = ClipperContext::local();
+            voids = clipper.diff(voids, surfaces_polygons);
             // Corners of infill regions, which would not be filled with an extrusion path with a radius of distance_between_surfaces/2
-            Polygons collapsed = diff(
+            Polygons collapsed = clipper.diff(
                 surfaces_polygons,
-                offset2(surfaces_polygons, (float)-distance_between_surfaces/2, (float)+distance_between_surfaces/2),
+                clipper.offset2(surfaces_polygons, (float)-distance_between_surfaces/2, (float)+distance_between_surfaces/2),
                 true);
             //FIXME why the voids are added to collapsed here? First it is expensive, second the result may lead to some unwanted regions being
             // added if two offsetted void regions merge.
             // polygons_append(voids, collapsed);
-            ExPolygons extensions = intersection_ex(offset(collapsed, (float)distance_between_surfaces), voids, true);
+            ExPolygons extensions = clipper.intersection_ex(clipper.offset(collapsed, (float)distance_between_surfaces), voids, true);
             // Now find an internal infill SurfaceFill to add these extrusions to.
             SurfaceFill *internal_solid_fill = nullptr;
             unsigned int region_id = 0;
@@ -377,6 +381,7 @@ void export_group_fills_to_svg(const char *path, const std::vector<SurfaceFill>
 // friend to Layer
 void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree)
 {
+    SLIC3R_TRACE_ZONE("Layer::make_fills");
     for (LayerRegion* layerm : m_regions) {
         layerm->fills.clear();
         layerm->ironings.clear();
@@ -397,7 +402,8 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
     }
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
 
-    for (SurfaceFill &surface_fill : surface_fills) {
+    // Fill a single group of surfaces, the extrusions are collected into out.
+    auto fill_surfaces = [this, &bbox, adaptive_fill_octree, support_fill_octree](SurfaceFill &surface_fill, ExtrusionEntitiesPtr &out) {
         // Create the filler object.
         std::unique_ptr<Fill> f = std::unique_ptr<Fill>(Fill::new_from_type(surface_fill.params.pattern));
         f->set_bounding_box(bbox);
@@ -469,9 +475,26 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
                 surface_fill.surface.expolygon = std::move(expoly);
 
                 //make fill
-                f->fill_surface_extrusion(&surface_fill.surface, surface_fill.params, m_regions[surface_fill.region_id]->fills.entities);
+                f->fill_surface_extrusion(&surface_fill.surface, surface_fill.params, out);
             }
         }
+    };
+
+    if (surface_fills.size() == 1) {
+        fill_surfaces(surface_fills.front(), m_regions[surface_fills.front().region_id]->fills.entities);
+    } else if (! surface_fills.empty()) {
+        // The surface fills are independent, fill them in parallel. This is nested into the parallel loop over the layers
+        // of PrintObject::infill(), which helps objects with a few layers, but large areas to fill.
+        // The extrusions are collected per surface fill and then appended in the order of the surface fills,
+        // so that the result does not depend on the scheduling.
+        std::vector<ExtrusionEntitiesPtr> fills(surface_fills.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, surface_fills.size(), 1),
+            [&surface_fills, &fills, &fill_surfaces](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    fill_surfaces(surface_fills[i], fills[i]);
+            });
+        for (size_t i = 0; i < surface_fills.size(); ++ i)
+            append(m_regions[surface_fills[i].region_id]->fills.entities, std::move(fills[i]));
     }
 
     // add thin fill regions
@@ -607,6 +630,16 @@ void Layer::make_ironing()
     fill_params.connection  = InfillConnection::icConnected;
     fill_params.monotonic  = true;
 
+    // The layer slices shrunk by half the nozzle diameter, shared by the regions ironed with the same nozzle.
+    std::vector<std::pair<double, Polygons>> lslices_shrunk;
+    auto lslices_shrunk_by_nozzle = [this, &lslices_shrunk](double nozzle_dmr) -> const Polygons& {
+        for (const std::pair<double, Polygons> &shrunk : lslices_shrunk)
+            if (shrunk.first == nozzle_dmr)
+                return shrunk.second;
+        lslices_shrunk.emplace_back(nozzle_dmr, offset(this->lslices, -float(scale_(0.5 * nozzle_dmr))));
+        return lslices_shrunk.back().second;
+    };
+
     for (size_t i = 0; i < by_extruder.size(); ++ i) {
         // Find span of regions equivalent to the ironing operation.
         IroningParams &ironing_params = by_extruder[i];
@@ -628,7 +661,7 @@ void Layer::make_ironing()
                         if (surface.has_fill_solid())
                             polygons_append(polys, surface.expolygon);
                 // Trim the top surfaces with half the nozzle diameter.
-                ironing_areas = intersection_ex(polys, offset(this->lslices, -float(scale_(0.5 * nozzle_dmr))));
+                ironing_areas = intersection_ex(polys, lslices_shrunk_by_nozzle(nozzle_dmr));
             } else {
                 // Merge top surfaces with the same ironing parameters.
                 Polygons polys;
@@ -637,7 +670,7 @@ void Layer::make_ironing()
                         if (surface.has_pos_top())
                             polygons_append(polys, surface.expolygon);
                 // Trim the top surfaces with half the nozzle diameter.
-                ironing_areas = intersection_ex(polys, offset(this->lslices, -float(scale_(0.5 * nozzle_dmr))));
+                ironing_areas = intersection_ex(polys, lslices_shrunk_by_nozzle(nozzle_dmr));
             }
         }
 
@@ -648,14 +681,20 @@ void Layer::make_ironing()
         double height = ironing_params.height * fill.get_spacing() / nozzle_dmr;
         Flow flow = Flow::new_from_spacing(float(nozzle_dmr), 0., float(height), false);
         double flow_mm3_per_mm = flow.mm3_per_mm();
-        Surface surface_fill((stPosTop | stDensSolid), ExPolygon());
-        for (ExPolygon &expoly : ironing_areas) {
-            surface_fill.expolygon = std::move(expoly);
-            Polylines polylines;
-            try {
-                polylines = fill.fill_surface(&surface_fill, fill_params);
-            } catch (InfillFailedException &) {
-            }
+        // Fill the ironing areas in parallel, the filler is not modified by fill_surface().
+        std::vector<Polylines> ironing_polylines(ironing_areas.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, ironing_areas.size(), 1),
+            [&ironing_areas, &ironing_polylines, &fill, &fill_params](const tbb::blocked_range<size_t> &range) {
+                Surface surface_fill((stPosTop | stDensSolid), ExPolygon());
+                for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                    surface_fill.expolygon = std::move(ironing_areas[idx]);
+                    try {
+                        ironing_polylines[idx] = fill.fill_surface(&surface_fill, fill_params);
+                    } catch (InfillFailedException &) {
+                    }
+                }
+            });
+        for (Polylines &polylines : ironing_polylines) {
             if (! polylines.empty()) {
                 // Save into layer.
                 ExtrusionEntityCollection *eec = new ExtrusionEntityCollection();
@@ -15,6 +15,8 @@
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <map>
+#include <mutex>
 
 // Boost pool: Don't use mutexes to synchronize memory allocation.
 #define BOOST_POOL_NO_MT
@@ -25,6 +27,8 @@
 #include <boost/geometry/geometries/segment.hpp>
 #include <boost/geometry/index/rtree.hpp>
 
+#include <tbb/parallel_for.h>
+
 
 namespace Slic3r {
 namespace FillAdaptive {
@@ -256,9 +260,22 @@ struct CubeProperties
 
 struct Octree
 {
+    // build_octree() builds the top split_depth levels of the octree on a single thread, sorting the triangles into the subtrees
+    // rooted at the Cubes split_depth levels below the root, then it builds the subtrees in parallel.
+    static constexpr int        split_depth = 3;
+
+    // Cube at split_depth levels below the root with the indices of the triangles intersecting it.
+    struct Subtree {
+        Cube                   *cube { nullptr };
+        BoundingBoxf3           bbox;
+        std::vector<uint32_t>   triangles;
+    };
+
     // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
     // perfect for building up our octree.
     boost::object_pool<Cube>    pool;
+    // The pool is not thread safe, therefore the subtrees built in parallel allocate their Cubes from their own pools.
+    std::vector<std::unique_ptr<boost::object_pool<Cube>>> subtree_pools;
     Cube*                       root_cube { nullptr };
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
@@ -266,7 +283,11 @@ struct Octree
     Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
         : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
 
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    void insert_triangle(boost::object_pool<Cube> &pool, const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    // Insert the triangle into the top levels of the octree down to the Subtrees at "levels" below current_cube,
+    // which appends the triangle index to the Subtrees it intersects.
+    void bin_triangle(uint32_t triangle_idx, const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth,
+                      int levels, size_t bin, std::vector<Subtree> &subtrees);
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -1476,27 +1497,54 @@ OctreePtr build_octree(
     auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
 
     if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
         double edge_length_half = 0.5 * cubes_properties.back().edge_length;
         Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
+        const BoundingBoxf3 root_bbox(octree->root_cube->center - diag_half, octree->root_cube->center + diag_half);
         int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
-        };
         auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
-            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
-            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
-            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
+        // Triangles of the mesh followed by the overhang triangles.
+        const size_t num_mesh_triangles = triangle_mesh.indices.size();
+        const size_t num_triangles      = num_mesh_triangles + overhang_triangles.size() / 3;
+        auto triangle = [&triangle_mesh, &overhang_triangles, num_mesh_triangles](size_t idx) {
+            if (idx < num_mesh_triangles) {
+                const stl_triangle_vertex_indices &tri = triangle_mesh.indices[idx];
+                return std::array<Vec3d, 3>{ triangle_mesh.vertices[tri[0]].cast<double>(), triangle_mesh.vertices[tri[1]].cast<double>(), triangle_mesh.vertices[tri[2]].cast<double>() };
+            }
+            idx = 3 * (idx - num_mesh_triangles);
+            return std::array<Vec3d, 3>{ overhang_triangles[idx], overhang_triangles[idx + 1], overhang_triangles[idx + 2] };
+        };
+        auto accepted = [support_overhangs_only, &up_vector, num_mesh_triangles](size_t idx, const std::array<Vec3d, 3> &tri) {
+            return idx >= num_mesh_triangles || ! support_overhangs_only || is_overhang_triangle(tri[0], tri[1], tri[2], up_vector);
+        };
+        if (max_depth > Octree::split_depth) {
+            // A Cube is created if and only if a triangle intersects it, therefore the subtrees may be built independently,
+            // producing the same octree as inserting the triangles one by one.
+            std::vector<Octree::Subtree> subtrees(size_t(1) << (3 * Octree::split_depth));
+            for (size_t idx = 0; idx < num_triangles; ++ idx)
+                if (std::array<Vec3d, 3> tri = triangle(idx); accepted(idx, tri))
+                    octree->bin_triangle(uint32_t(idx), tri[0], tri[1], tri[2], octree->root_cube, root_bbox, max_depth, Octree::split_depth, 0, subtrees);
+            subtrees.erase(std::remove_if(subtrees.begin(), subtrees.end(), [](const Octree::Subtree &subtree) { return subtree.cube == nullptr; }), subtrees.end());
+            octree->subtree_pools.reserve(subtrees.size());
+            for (size_t i = 0; i < subtrees.size(); ++ i)
+                octree->subtree_pools.emplace_back(std::make_unique<boost::object_pool<Cube>>());
+            Octree *octree_ptr = octree.get();
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, subtrees.size(), 1),
+                [octree_ptr, max_depth, &subtrees, &triangle](const tbb::blocked_range<size_t> &range) {
+                for (size_t subtree_idx = range.begin(); subtree_idx < range.end(); ++ subtree_idx) {
+                    Octree::Subtree          &subtree = subtrees[subtree_idx];
+                    boost::object_pool<Cube> &pool    = *octree_ptr->subtree_pools[subtree_idx];
+                    for (uint32_t idx : subtree.triangles) {
+                        std::array<Vec3d, 3> tri = triangle(idx);
+                        octree_ptr->insert_triangle(pool, tri[0], tri[1], tri[2], subtree.cube, subtree.bbox, max_depth - Octree::split_depth);
+                    }
+                    subtree.triangles = std::vector<uint32_t>();
+                }
+            });
+        } else {
+            for (size_t idx = 0; idx < num_triangles; ++ idx)
+                if (std::array<Vec3d, 3> tri = triangle(idx); accepted(idx, tri))
+                    octree->insert_triangle(octree->pool, tri[0], tri[1], tri[2], octree->root_cube, root_bbox, max_depth);
         }
-        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
         {
             // Transform the octree to world coordinates to reduce computation when extracting infill lines.
             auto rot = transform_to_world().toRotationMatrix();
@@ -1508,7 +1556,59 @@ OctreePtr build_octree(
     return octree;
 }
 
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
+OctreeSharedPtr build_octree_shared(uint64_t key, const std::function<OctreePtr()> &build)
+{
+    // The cache does not own the octrees, they are released together with the last PrintObject referencing them.
+    struct Slot {
+        std::mutex                  mutex;
+        std::weak_ptr<Octree>       octree;
+    };
+    static std::mutex                                   mutex;
+    static std::map<uint64_t, std::shared_ptr<Slot>>    slots;
+
+    std::shared_ptr<Slot> slot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Drop the slots of the released octrees, which are not being built at the moment.
+        for (auto it = slots.begin(); it != slots.end();)
+            if (it->first != key && it->second.use_count() == 1 && it->second->octree.expired())
+                it = slots.erase(it);
+            else
+                ++ it;
+        std::shared_ptr<Slot> &dst = slots[key];
+        if (! dst)
+            dst = std::make_shared<Slot>();
+        slot = dst;
+    }
+
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    OctreeSharedPtr octree = slot->octree.lock();
+    if (! octree) {
+        octree = OctreeSharedPtr(build());
+        slot->octree = octree;
+    }
+    return octree;
+}
+
+// Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
+// We will rather densify the octree a bit more than necessary instead of missing a triangle.
+static inline BoundingBoxf3 child_bbox(const Cube &current_cube, const BoundingBoxf3 &current_bbox, size_t child_idx)
+{
+    const Vec3d  &child_center_dir = child_centers[child_idx];
+    BoundingBoxf3 bbox;
+    for (int k = 0; k < 3; ++ k) {
+        if (child_center_dir[k] == -1.) {
+            bbox.min[k] = current_bbox.min[k];
+            bbox.max[k] = current_cube.center[k] + EPSILON;
+        } else {
+            bbox.min[k] = current_cube.center[k] - EPSILON;
+            bbox.max[k] = current_bbox.max[k];
+        }
+    }
+    return bbox;
+}
+
+void Octree::insert_triangle(boost::object_pool<Cube> &pool, const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
 {
     assert(current_cube);
     assert(depth > 0);
@@ -1517,26 +1617,40 @@ void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cub
     const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[-- depth].height + EPSILON);
 
     for (size_t i = 0; i < 8; ++ i) {
-        const Vec3d &child_center_dir = child_centers[i];
-        // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
-        // We will rather densify the octree a bit more than necessary instead of missing a triangle.
-        BoundingBoxf3 bbox;
-        for (int k = 0; k < 3; ++ k) {
-            if (child_center_dir[k] == -1.) {
-                bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
-            } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
-                bbox.max[k] = current_bbox.max[k];
-            }
-        }
-        Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
+        BoundingBoxf3 bbox = child_bbox(*current_cube, current_bbox, i);
+        Vec3d child_center = current_cube->center + (child_centers[i] * (this->cubes_properties[depth].edge_length / 2.));
         //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
         if (triangle_AABB_intersects(a, b, c, bbox)) {
             if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
+                current_cube->children[i] = pool.construct(child_center);
             if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
+                this->insert_triangle(pool, a, b, c, current_cube->children[i], bbox, depth);
+        }
+    }
+}
+
+void Octree::bin_triangle(uint32_t triangle_idx, const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth,
+                          int levels, size_t bin, std::vector<Subtree> &subtrees)
+{
+    assert(current_cube);
+    assert(depth > levels);
+    assert(levels > 0);
+
+    -- depth;
+    -- levels;
+    for (size_t i = 0; i < 8; ++ i) {
+        BoundingBoxf3 bbox = child_bbox(*current_cube, current_bbox, i);
+        if (triangle_AABB_intersects(a, b, c, bbox)) {
+            if (! current_cube->children[i])
+                current_cube->children[i] = this->pool.construct(current_cube->center + (child_centers[i] * (this->cubes_properties[depth].edge_length / 2.)));
+            size_t child_bin = bin * 8 + i;
+            if (levels == 0) {
+                Subtree &subtree = subtrees[child_bin];
+                subtree.cube = current_cube->children[i];
+                subtree.bbox = bbox;
+                subtree.triangles.emplace_back(triangle_idx);
+            } else
+                this->bin_triangle(triangle_idx, a, b, c, current_cube->children[i], bbox, depth, levels, child_bin, subtrees);
         }
     }
 }
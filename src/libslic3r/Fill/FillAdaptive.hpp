@@ -13,6 +13,9 @@
 
 #include "FillBase.hpp"
 
+#include <functional>
+#include <memory>
+
 struct indexed_triangle_set;
 
 namespace Slic3r {
@@ -26,6 +29,7 @@ struct Octree;
 // To keep the definition of Octree opaque, we have to define a custom deleter.
 struct OctreeDeleter { void operator()(Octree *p); };
 using  OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
+using  OctreeSharedPtr = std::shared_ptr<Octree>;
 
 // Calculate line spacing for
 // 1) adaptive cubic infill
@@ -48,6 +52,12 @@ FillAdaptive::OctreePtr         build_octree(
     // If true, octree is densified below internal overhangs only.
     bool                         support_overhangs_only);
 
+// Returns the octree built for the key by a PrintObject still holding it, or builds a new one.
+// The key is a hash of all the inputs of build_octree(), therefore PrintObjects with the same mesh, placement, internal overhangs
+// and line spacing (for example duplicates differing just by the perimeter count) share a single octree.
+// Concurrent requests for the same key wait for the first one to build it. Thread safe.
+FillAdaptive::OctreeSharedPtr   build_octree_shared(uint64_t key, const std::function<OctreePtr()> &build);
+
 //
 // Some of the algorithms used by class FillAdaptive were inspired by
 // Cura Engine's class SubDivCube
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <numeric>
+#include <set>
 
 #include "../ClipperUtils.hpp"
 #include "../EdgeGrid.hpp"
@@ -665,22 +666,39 @@ namespace PrusaSimpleConnect {
         bool  point_consumed = false;
     };
 
+    // Indices of the contour points with either the point or the segment starting with it consumed, sorted.
+    using ConsumedIndices = std::set<size_t>;
+
+    static inline void collect_consumed(const std::vector<ContourPointData>& contour_data, ConsumedIndices& consumed)
+    {
+        for (size_t i = 0; i < contour_data.size(); ++i)
+            if (contour_data[i].segment_consumed || contour_data[i].point_consumed)
+                consumed.insert(consumed.end(), i);
+    }
+
+    // Is idx inside the closed interval <idx_start, idx_end> running with increasing indices along a closed contour?
+    static inline bool cyclic_inside(size_t idx_start, size_t idx_end, size_t idx)
+    {
+        return (idx_start <= idx_end) ? (idx >= idx_start && idx <= idx_end) : (idx >= idx_start || idx <= idx_end);
+    }
+
     // Verify whether the contour from point idx_start to point idx_end could be taken (whether all segments along the contour were not yet extruded).
-    static bool could_take(const std::vector<ContourPointData>& contour_data, size_t idx_start, size_t idx_end)
+    // Instead of walking the contour, the first consumed index at or after idx_start is looked up.
+    static bool could_take(const std::vector<ContourPointData>& contour_data, const ConsumedIndices& consumed, size_t idx_start, size_t idx_end)
     {
         assert(idx_start != idx_end);
-        for (size_t i = idx_start; i != idx_end; ) {
-            if (contour_data[i].segment_consumed || contour_data[i].point_consumed)
+        auto it = consumed.lower_bound(idx_start);
+        if (idx_start < idx_end) {
+            if (it != consumed.end() && *it < idx_end)
                 return false;
-            if (++i == contour_data.size())
-                i = 0;
-        }
+        } else if (it != consumed.end() || (! consumed.empty() && *consumed.begin() < idx_end))
+            return false;
         return !contour_data[idx_end].point_consumed;
     }
 
     // Connect end of pl1 to the start of pl2 using the perimeter contour.
     // The idx_start and idx_end are ordered so that the connecting polyline points will be taken with increasing indices.
-    static void take(Polyline& pl1, Polyline&& pl2, const Points& contour, std::vector<ContourPointData>& contour_data, size_t idx_start, size_t idx_end, bool reversed)
+    static void take(Polyline& pl1, Polyline&& pl2, const Points& contour, std::vector<ContourPointData>& contour_data, ConsumedIndices& consumed, size_t idx_start, size_t idx_end, bool reversed)
     {
 #ifndef NDEBUG
         size_t num_points_initial = pl1.points.size();
@@ -698,12 +716,15 @@ namespace PrusaSimpleConnect {
         contour_data[idx_start].point_consumed = true;
         contour_data[idx_start].segment_consumed = true;
         contour_data[idx_end].point_consumed = true;
+        consumed.insert(idx_start);
+        consumed.insert(idx_end);
 
         if (reversed) {
             size_t i = (idx_end == 0) ? contour_data.size() - 1 : idx_end - 1;
             while (i != idx_start) {
                 contour_data[i].point_consumed = true;
                 contour_data[i].segment_consumed = true;
+                consumed.insert(i);
                 pl1.points.emplace_back(contour[i]);
                 if (i == 0)
                     i = contour_data.size();
@@ -716,6 +737,7 @@ namespace PrusaSimpleConnect {
             while (i != idx_end) {
                 contour_data[i].point_consumed = true;
                 contour_data[i].segment_consumed = true;
+                consumed.insert(i);
                 pl1.points.emplace_back(contour[i]);
                 if (++i == contour_data.size())
                     i = 0;
@@ -1105,6 +1127,11 @@ namespace PrusaSimpleConnect {
         }
         assert(boundary_data.size() == boundary_src.holes.size() + 1);
 
+        // Sorted consumed indices of each contour, to test a connection with a binary search instead of walking the contour.
+        std::vector<ConsumedIndices> boundary_consumed(boundary_data.size());
+        for (size_t idx_contour = 0; idx_contour < boundary_data.size(); ++idx_contour)
+            collect_consumed(boundary_data[idx_contour], boundary_consumed[idx_contour]);
+
         size_t idx_chain_last = 0;
         for (ConnectionCost& connection_cost : connections_sorted) {
             const std::pair<size_t, size_t>* cp1 = &map_infill_end_point_to_boundary[connection_cost.idx_first * 2 + 1];
@@ -1113,21 +1140,14 @@ namespace PrusaSimpleConnect {
             const std::pair<size_t, size_t>* cp2next = cp2 + 1;
             assert(cp1->first == cp2->first && cp1->first != boundary_idx_unconnected);
             std::vector<ContourPointData>& contour_data = boundary_data[cp1->first];
+            ConsumedIndices&               consumed     = boundary_consumed[cp1->first];
             if (connection_cost.reversed)
                 std::swap(cp1, cp2);
-            // Mark the the other end points of the segments to be taken as consumed temporarily, so they will not be crossed
-            // by the new connection line.
-            bool prev_marked = false;
-            bool next_marked = false;
-            if (cp1prev->first == cp1->first && !contour_data[cp1prev->second].point_consumed) {
-                contour_data[cp1prev->second].point_consumed = true;
-                prev_marked = true;
-            }
-            if (cp2next->first == cp1->first && !contour_data[cp2next->second].point_consumed) {
-                contour_data[cp2next->second].point_consumed = true;
-                next_marked = true;
-            }
-            if (could_take(contour_data, cp1->second, cp2->second)) {
+            // The other end points of the segments to be taken shall not be crossed by the new connection line,
+            // as if they were consumed.
+            if ((cp1prev->first != cp1->first || ! cyclic_inside(cp1->second, cp2->second, cp1prev->second)) &&
+                (cp2next->first != cp1->first || ! cyclic_inside(cp1->second, cp2->second, cp2next->second)) &&
+                could_take(contour_data, consumed, cp1->second, cp2->second)) {
                 // Indices of the polygons to be connected.
                 size_t idx_first = connection_cost.idx_first;
                 size_t idx_second = idx_first + 1;
@@ -1141,14 +1161,10 @@ namespace PrusaSimpleConnect {
                     last = lower;
                 }
                 // Connect the two polygons using the boundary contour.
-                take(infill_ordered[idx_first], std::move(infill_ordered[idx_second]), boundary[cp1->first], contour_data, cp1->second, cp2->second, connection_cost.reversed);
+                take(infill_ordered[idx_first], std::move(infill_ordered[idx_second]), boundary[cp1->first], contour_data, consumed, cp1->second, cp2->second, connection_cost.reversed);
                 // Mark the second polygon as merged with the first one.
                 merged_with[idx_second] = merged_with[idx_first];
             }
-            if (prev_marked)
-                contour_data[cp1prev->second].point_consumed = false;
-            if (next_marked)
-                contour_data[cp2next->second].point_consumed = false;
         }
         polylines_out.reserve(polylines_out.size() + std::count_if(infill_ordered.begin(), infill_ordered.end(), [](const Polyline& pl) { return !pl.empty(); }));
         for (Polyline& pl : infill_ordered)
@@ -37,8 +37,9 @@ FillConcentric::_fill_surface_single(
 
     Polygons loops = to_polygons(std::move(expolygon));
     Polygons last  = loops;
+    ClipperContext &clipper = ClipperContext::local();
     while (! last.empty()) {
-        last = offset2(last, -double(distance + scale_(this->get_spacing()) /2), +double(scale_(this->get_spacing()) /2));
+        last = clipper.offset2(last, -double(distance + scale_(this->get_spacing()) /2), +double(scale_(this->get_spacing()) /2));
         append(loops, last);
     }
 
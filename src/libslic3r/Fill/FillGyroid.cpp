@@ -4,6 +4,9 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
 
 #include "FillGyroid.hpp"
 
@@ -101,6 +104,61 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
     return points;
 }
 
+// Single periods of the odd and even gyroid waves, see make_one_period().
+struct GyroidPeriods
+{
+    std::vector<Vec2d> odd;
+    std::vector<Vec2d> even;
+};
+
+struct GyroidPeriodsKey
+{
+    double scale_factor;
+    double z;
+    double tolerance;
+    // min(2 * PI, width), the only dependency of make_one_period() on the width of the pattern.
+    double limit;
+    bool   vertical;
+
+    bool operator==(const GyroidPeriodsKey &rhs) const {
+        return scale_factor == rhs.scale_factor && z == rhs.z && tolerance == rhs.tolerance && limit == rhs.limit && vertical == rhs.vertical;
+    }
+};
+
+// The periods of the gyroid waves are refined numerically, which is the most expensive part of the gyroid pattern generation.
+// The waves only depend on the Z phase, the scale and the tolerance, while the rest of the pattern is just the periods tiled over
+// the bounding box. All the islands and regions of a layer sharing the infill spacing, as well as the other objects sliced at the same Z,
+// share the periods, thus the most recently used ones are cached.
+static std::shared_ptr<const GyroidPeriods> gyroid_periods(const GyroidPeriodsKey &key, double width, bool flip)
+{
+    static constexpr size_t                                                          capacity = 32;
+    static std::mutex                                                                mutex;
+    static std::list<std::pair<GyroidPeriodsKey, std::shared_ptr<const GyroidPeriods>>> cache;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = cache.begin(); it != cache.end(); ++ it)
+            if (it->first == key) {
+                cache.splice(cache.begin(), cache, it);
+                return cache.front().second;
+            }
+    }
+
+    // Calculate outside of the lock, the other threads may be filling other layers in the meantime.
+    const double z_sin = sin(key.z);
+    const double z_cos = cos(key.z);
+    auto periods = std::make_shared<GyroidPeriods>();
+    // creates one period of the waves, so it doesn't have to be recalculated all the time
+    periods->odd  = make_one_period(width, key.scale_factor, z_cos, z_sin, key.vertical, flip, key.tolerance);
+    // even polylines are a bit shifted
+    periods->even = make_one_period(width, key.scale_factor, z_cos, z_sin, key.vertical, ! flip, key.tolerance);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.emplace_front(key, periods);
+    if (cache.size() > capacity)
+        cache.pop_back();
+    return periods;
+}
+
 static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
@@ -126,9 +184,10 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
         std::swap(width,height);
     }
 
-    std::vector<Vec2d> one_period_odd = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
-    flip = !flip;                                                                   // even polylines are a bit shifted
-    std::vector<Vec2d> one_period_even = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
+    std::shared_ptr<const GyroidPeriods> periods = gyroid_periods({ scaleFactor, z, tolerance, std::min(2 * M_PI, width), vertical }, width, flip);
+    const std::vector<Vec2d> &one_period_odd  = periods->odd;
+    const std::vector<Vec2d> &one_period_even = periods->even;
+    flip = !flip;
     Polylines result;
 
     for (double y0 = lower_bound; y0 < upper_bound + EPSILON; y0 += M_PI) {
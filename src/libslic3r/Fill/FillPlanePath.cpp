@@ -27,22 +27,32 @@ void FillPlanePath::_fill_surface_single(
     expolygon.translate(-double(shift.x()), -double(shift.y()));
     bounding_box.translate(-double(shift.x()), -double(shift.y()));
 
-    Pointfs pts = _generate(
+    // Only the parts of the curve close to the surface are generated and clipped.
+    // The clip box is in units of the line spacing and it is inflated, so that no curve segment reaching into the surface is left out.
+    BoundingBox clip_box = get_extents(expolygon.contour);
+    clip_box.min = Point(coord_t(floor(coordf_t(clip_box.min.x()) / distance_between_lines)) - 2, coord_t(floor(coordf_t(clip_box.min.y()) / distance_between_lines)) - 2);
+    clip_box.max = Point(coord_t(ceil(coordf_t(clip_box.max.x()) / distance_between_lines)) + 2, coord_t(ceil(coordf_t(clip_box.max.y()) / distance_between_lines)) + 2);
+
+    std::vector<Pointfs> chains = _generate(
         coord_t(ceil(coordf_t(bounding_box.min.x()) / distance_between_lines)),
         coord_t(ceil(coordf_t(bounding_box.min.y()) / distance_between_lines)),
         coord_t(ceil(coordf_t(bounding_box.max.x()) / distance_between_lines)),
-        coord_t(ceil(coordf_t(bounding_box.max.y()) / distance_between_lines)));
+        coord_t(ceil(coordf_t(bounding_box.max.y()) / distance_between_lines)),
+        clip_box);
 
     Polylines polylines;
-    if (pts.size() >= 2) {
-        // Convert points to a polyline, upscale.
-        polylines.push_back(Polyline());
-        Polyline &polyline = polylines.back();
-        polyline.points.reserve(pts.size());
-        for (const Vec2d &pt : pts)
-            polyline.points.push_back(Point(
-                coord_t(floor(pt.x() * distance_between_lines + 0.5)), 
-                coord_t(floor(pt.y() * distance_between_lines + 0.5))));
+    for (const Pointfs &pts : chains)
+        if (pts.size() >= 2) {
+            // Convert points to a polyline, upscale.
+            polylines.push_back(Polyline());
+            Polyline &polyline = polylines.back();
+            polyline.points.reserve(pts.size());
+            for (const Vec2d &pt : pts)
+                polyline.points.push_back(Point(
+                    coord_t(floor(pt.x() * distance_between_lines + 0.5)), 
+                    coord_t(floor(pt.y() * distance_between_lines + 0.5))));
+        }
+    if (! polylines.empty()) {
 //      intersection(polylines_src, offset((Polygons)expolygon, scale_(0.02)), &polylines);
         polylines = intersection_pl(std::move(polylines), to_polygons(expolygon));
         Polylines chained;
@@ -60,10 +70,20 @@ void FillPlanePath::_fill_surface_single(
 }
 
 // Follow an Archimedean spiral, in polar coordinates: r=a+b\theta
-Pointfs FillArchimedeanChords::_generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const
+// Radius of a centered spiral to cover the domain (min_x, min_y) - (max_x, max_y), limited to cover the clip_box only.
+static inline coordf_t spiral_max_radius(coord_t max_x, coord_t max_y, const BoundingBox &clip_box)
+{
+    coordf_t r2 = coordf_t(max_x)*coordf_t(max_x)+coordf_t(max_y)*coordf_t(max_y);
+    coordf_t r2_clip = 0.;
+    for (const Point &corner : { clip_box.min, clip_box.max, Point(clip_box.min.x(), clip_box.max.y()), Point(clip_box.max.x(), clip_box.min.y()) })
+        r2_clip = std::max(r2_clip, corner.cast<coordf_t>().squaredNorm());
+    return std::sqrt(std::min(r2, r2_clip)) * std::sqrt(2.) + 1.5;
+}
+
+std::vector<Pointfs> FillArchimedeanChords::_generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const BoundingBox &clip_box) const
 {
     // Radius to achieve.
-    coordf_t rmax = std::sqrt(coordf_t(max_x)*coordf_t(max_x)+coordf_t(max_y)*coordf_t(max_y)) * std::sqrt(2.) + 1.5;
+    coordf_t rmax = spiral_max_radius(max_x, max_y, clip_box);
     // Now unwind the spiral.
     coordf_t a = 1.;
     coordf_t b = 1./(2.*M_PI);
@@ -79,7 +99,7 @@ Pointfs FillArchimedeanChords::_generate(coord_t min_x, coord_t min_y, coord_t m
         r = a + b * theta;
         out.emplace_back(r * cos(theta), r * sin(theta));
     }
-    return out;
+    return { std::move(out) };
 }
 
 // Adapted from 
@@ -127,7 +147,32 @@ static inline Point hilbert_n_to_xy(const size_t n)
     return Point(x, y);
 }
 
-Pointfs FillHilbertCurve::_generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const
+// Emit the points of the Hilbert curve in the square of side 2^(level+1) starting at (x, y) in the given state,
+// in the same order as hilbert_n_to_xy() would. Sub-squares not touching clip_box are skipped, which splits the curve into chains.
+static void hilbert_generate_clipped(int level, int state, coord_t x, coord_t y, coord_t min_x, coord_t min_y, const BoundingBox &clip_box, std::vector<Pointfs> &chains)
+{
+    static const int next_state[16] = { 4,0,0,12, 0,4,4,8, 12,8,8,4, 8,12,12,0 };
+    static const int digit_to_x[16] = { 0,1,1,0, 0,0,1,1, 1,0,0,1, 1,1,0,0 };
+    static const int digit_to_y[16] = { 0,0,1,1, 0,1,1,0, 1,1,0,0, 1,0,0,1 };
+
+    const coord_t size = coord_t(1) << level;
+    for (int digit = 0; digit < 4; ++ digit) {
+        const int     st = state + digit;
+        const coord_t cx = x | (coord_t(digit_to_x[st]) << level);
+        const coord_t cy = y | (coord_t(digit_to_y[st]) << level);
+        if (cx + min_x > clip_box.max.x() || cx + min_x + size - 1 < clip_box.min.x() ||
+            cy + min_y > clip_box.max.y() || cy + min_y + size - 1 < clip_box.min.y()) {
+            // This sub-square is outside of the clip box, start a new chain.
+            if (! chains.back().empty())
+                chains.emplace_back();
+        } else if (level == 0)
+            chains.back().emplace_back(cx + min_x, cy + min_y);
+        else
+            hilbert_generate_clipped(level - 1, next_state[st], cx, cy, min_x, min_y, clip_box, chains);
+    }
+}
+
+std::vector<Pointfs> FillHilbertCurve::_generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const BoundingBox &clip_box) const
 {
     // Minimum power of two square to fit the domain.
     size_t sz = 2;
@@ -140,20 +185,20 @@ Pointfs FillHilbertCurve::_generate(coord_t min_x, coord_t min_y, coord_t max_x,
         }
     }
 
-    size_t sz2 = sz * sz;
-    Pointfs line;
-    line.reserve(sz2);
-    for (size_t i = 0; i < sz2; ++ i) {
-        Point p = hilbert_n_to_xy(i);
-        line.emplace_back(p.x() + min_x, p.y() + min_y);
-    }
-    return line;
+    // Generate the curve hierarchically, so that only the parts close to the surface are emitted.
+    // Leading zero digits toggle the state between 0 and 4, thus starting with all pw digits in this state
+    // is equivalent to hilbert_n_to_xy() over the indices 0 .. sz^2 - 1.
+    std::vector<Pointfs> chains(1);
+    hilbert_generate_clipped(int(pw) - 1, (pw & 1) ? 4 : 0, 0, 0, min_x, min_y, clip_box, chains);
+    if (chains.back().empty())
+        chains.pop_back();
+    return chains;
 }
 
-Pointfs FillOctagramSpiral::_generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const
+std::vector<Pointfs> FillOctagramSpiral::_generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const BoundingBox &clip_box) const
 {
     // Radius to achieve.
-    coordf_t rmax = std::sqrt(coordf_t(max_x)*coordf_t(max_x)+coordf_t(max_y)*coordf_t(max_y)) * std::sqrt(2.) + 1.5;
+    coordf_t rmax = spiral_max_radius(max_x, max_y, clip_box);
     // Now unwind the spiral.
     coordf_t r = 0;
     coordf_t r_inc = sqrt(2.);
@@ -180,7 +225,7 @@ Pointfs FillOctagramSpiral::_generate(coord_t min_x, coord_t min_y, coord_t max_
         out.emplace_back( rx, -rx);
         out.emplace_back( r2+r_inc, -rx);
     }
-    return out;
+    return { std::move(out) };
 }
 
 } // namespace Slic3r
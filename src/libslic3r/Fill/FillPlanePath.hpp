@@ -28,7 +28,10 @@ protected:
 
     float _layer_angle(size_t idx) const override { return 0.f; }
     virtual bool  _centered() const = 0;
-    virtual Pointfs _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const = 0;
+    // Generate the curve over the domain (min_x, min_y) - (max_x, max_y) in units of the line spacing.
+    // Parts of the curve, which are certainly outside of clip_box (in the same units), may be left out,
+    // thus the curve may be returned as multiple chains.
+    virtual std::vector<Pointfs> _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const BoundingBox &clip_box) const = 0;
 };
 
 class FillArchimedeanChords : public FillPlanePath
@@ -39,7 +42,7 @@ public:
 
 protected:
     bool  _centered() const override { return true; }
-    Pointfs _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const override;
+    std::vector<Pointfs> _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const BoundingBox &clip_box) const override;
 };
 
 class FillHilbertCurve : public FillPlanePath
@@ -50,7 +53,7 @@ public:
 
 protected:
     bool  _centered() const override { return false; }
-    Pointfs _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const override;
+    std::vector<Pointfs> _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const BoundingBox &clip_box) const override;
 };
 
 class FillOctagramSpiral : public FillPlanePath
@@ -61,7 +64,7 @@ public:
 
 protected:
     bool  _centered() const override { return true; }
-    Pointfs _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const override;
+    std::vector<Pointfs> _generate(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y, const BoundingBox &clip_box) const override;
 };
 
 } // namespace Slic3r
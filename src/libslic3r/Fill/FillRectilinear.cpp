@@ -421,7 +421,7 @@ public:
         //        if (sticks_removed) BOOST_LOG_TRIVIAL(error) << "Sticks removed!";
         polygons_outer = offset(polygons_src, float(aoffset1), ClipperLib::jtMiter, mitterLimit);
         if (aoffset2 < 0)
-            polygons_inner = offset(polygons_outer, float(aoffset2 - aoffset1), ClipperLib::jtMiter, mitterLimit);
+            polygons_inner = ClipperContext::local().offset(polygons_outer, float(aoffset2 - aoffset1), ClipperLib::jtMiter, mitterLimit);
         // Filter out contours with zero area or small area, contours with 2 points only.
         const double min_area_threshold = 0.01 * aoffset2 * aoffset2;
         remove_small(polygons_outer, min_area_threshold);
@@ -791,13 +791,51 @@ std::vector<SegmentedIntersectionLine> FillRectilinear::_vert_lines_for_polygon(
     iRun ++;
 #endif /* SLIC3R_DEBUG */
 
-    // For each contour
     // Allocate storage for the segments.
     std::vector<SegmentedIntersectionLine> segs(n_vlines, SegmentedIntersectionLine());
     for (size_t i = 0; i < n_vlines; ++ i) {
         segs[i].idx = i;
         segs[i].pos = x0 + i * line_spacing;
     }
+    if (n_vlines == 0)
+        return segs;
+
+    // Range of the vertical lines intersected by a contour segment, empty if il > ir.
+    const int n_vlines_int = int(n_vlines);
+    auto vertical_lines_range = [x0, line_spacing, n_vlines_int](const Point &p1, const Point &p2) {
+        coord_t l = p1(0);
+        coord_t r = p2(0);
+        if (l > r)
+            std::swap(l, r);
+        // il = ceil((l - x0) / line_spacing), ir = floor((r - x0) / line_spacing), clamped to the existing vertical lines.
+        coord_t dl = l - x0;
+        coord_t dr = r - x0;
+        coord_t il = dl > 0 ? (dl + line_spacing - 1) / line_spacing : - ((- dl) / line_spacing);
+        coord_t ir = dr >= 0 ? dr / line_spacing : - ((- dr + line_spacing - 1) / line_spacing);
+        return std::make_pair(int(std::max(coord_t(0), il)), int(std::min(coord_t(n_vlines_int - 1), ir)));
+    };
+
+    // First count the intersections of each vertical line to allocate the intersections at once,
+    // the intersections of the long vertical lines of large sheet-like surfaces would otherwise be reallocated many times.
+    {
+        std::vector<int> counts(n_vlines + 1, 0);
+        for (size_t iContour = 0; iContour < poly_with_offset.n_contours; ++ iContour) {
+            const Points &contour = poly_with_offset.contour(iContour).points;
+            if (contour.size() < 2)
+                continue;
+            for (size_t iSegment = 0, iPrev = contour.size() - 1; iSegment < contour.size(); iPrev = iSegment ++)
+                if (auto [il, ir] = vertical_lines_range(contour[iPrev], contour[iSegment]); il <= ir) {
+                    ++ counts[il];
+                    -- counts[ir + 1];
+                }
+        }
+        for (size_t i = 0, count = 0; i < n_vlines; ++ i) {
+            count += counts[i];
+            segs[i].intersections.reserve(count);
+        }
+    }
+
+    // For each contour
     for (size_t iContour = 0; iContour < poly_with_offset.n_contours; ++ iContour) {
         const Points &contour = poly_with_offset.contour(iContour).points;
         bool is_hole = poly_with_offset.contour(iContour).is_clockwise();
@@ -809,57 +847,44 @@ std::vector<SegmentedIntersectionLine> FillRectilinear::_vert_lines_for_polygon(
             const Point &p1 = contour[iPrev];
             const Point &p2 = contour[iSegment];
             // Which of the equally spaced vertical lines is intersected by this segment?
-            coord_t l = p1(0);
-            coord_t r = p2(0);
-            if (l > r)
-                std::swap(l, r);
             // il, ir are the left / right indices of vertical lines intersecting a segment
-            int il = (l - x0) / line_spacing;
-            while (il * line_spacing + x0 < l)
-                ++ il;
-            il = std::max(int(0), il);
-            int ir = (r - x0 + line_spacing) / line_spacing;
-            while (ir * line_spacing + x0 > r)
-                -- ir;
-            ir = std::min(int(segs.size()) - 1, ir);
+            auto [il, ir] = vertical_lines_range(p1, p2);
             if (il > ir)
                 // No vertical line intersects this segment.
                 continue;
             assert(il >= 0 && size_t(il) < segs.size());
             assert(ir >= 0 && size_t(ir) < segs.size());
+            if (p1(0) == p2(0))
+                // Ignore strictly vertical segments.
+                continue;
+            // Parameters of the segment shared by all the vertical lines it intersects.
+            const bool    left_to_right = p2(0) > p1(0);
+            const uint32_t dx           = uint32_t(left_to_right ? int64_t(p2(0)) - int64_t(p1(0)) : int64_t(p1(0)) - int64_t(p2(0)));
+            const int64_t  dy           = int64_t(p2(1)) - int64_t(p1(1));
+            const int64_t  y0           = int64_t(p1(1)) * int64_t(dx);
+            SegmentIntersection is;
+            is.iContour = iContour;
+            is.iSegment = iSegment;
+            is.is_hole  = is_hole;
             for (int i = il; i <= ir; ++ i) {
                 coord_t this_x = segs[i].pos;
                 assert(this_x == i * line_spacing + x0);
-                SegmentIntersection is;
-                is.iContour = iContour;
-                is.iSegment = iSegment;
-                is.is_hole = is_hole;
-                assert(l <= this_x);
-                assert(r >= this_x);
+                assert(std::min(p1(0), p2(0)) <= this_x);
+                assert(std::max(p1(0), p2(0)) >= this_x);
                 // Calculate the intersection position in y axis. x is known.
                 if (p1(0) == this_x) {
-                    if (p2(0) == this_x) {
-                        // Ignore strictly vertical segments.
-                        continue;
-                    }
                     is.pos_p = p1(1);
                     is.pos_q = 1;
                 } else if (p2(0) == this_x) {
                     is.pos_p = p2(1);
                     is.pos_q = 1;
                 } else {
-                    // First calculate the intersection parameter 't' as a rational number with non negative denominator.
-                    if (p2(0) > p1(0)) {
-                        is.pos_p = this_x - p1(0);
-                        is.pos_q = p2(0) - p1(0);
-                    } else {
-                        is.pos_p = p1(0) - this_x;
-                        is.pos_q = p1(0) - p2(0);
-                    }
-                    assert(is.pos_p >= 0 && is.pos_p <= is.pos_q);
-                    // Make an intersection point from the 't'.
-                    is.pos_p *= int64_t(p2(1) - p1(1));
-                    is.pos_p += p1(1) * int64_t(is.pos_q);
+                    // The intersection parameter 't' as a rational number with non negative denominator,
+                    // the intersection point is then p1.y + t * (p2.y - p1.y).
+                    int64_t t = left_to_right ? int64_t(this_x) - int64_t(p1(0)) : int64_t(p1(0)) - int64_t(this_x);
+                    assert(t >= 0 && t <= int64_t(dx));
+                    is.pos_p = t * dy + y0;
+                    is.pos_q = dx;
                 }
                 // +-1 to take rounding into account.
                 assert(is.pos() + 1 >= std::min(p1(1), p2(1)));
@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <iostream>
 
+#include <tbb/parallel_for.h>
+
 #include "FillSmooth.hpp"
 
 namespace Slic3r {
@@ -18,9 +20,9 @@ namespace Slic3r {
     }
 
     /// @idx: the index of the step (0 = first step, 1 = second step, ...) The first lay down the volume and the others smoothen the surface.
-    void FillSmooth::perform_single_fill(const int idx, ExtrusionEntityCollection &eecroot, const Surface &srf_source,
+    ExtrusionEntityCollection* FillSmooth::perform_single_fill(const int idx, const Surface &srf_source,
         const FillParams &params, const double volume) const {
-        if (srf_source.expolygon.empty()) return;
+        if (srf_source.expolygon.empty()) return nullptr;
         
         // Save into layer smoothing path.
         ExtrusionEntityCollection *eec = new ExtrusionEntityCollection();
@@ -40,37 +42,42 @@ namespace Slic3r {
         if (rolePass[idx] != erNone)
             params_modifided.role = rolePass[idx];
 
+        // The filler of this pass, shared by all the expolygons to fill.
+        std::unique_ptr<Fill> f2 = std::unique_ptr<Fill>(Fill::new_from_type(fillPattern[idx]));
+        f2->bounding_box = this->bounding_box;
+        f2->init_spacing(this->get_spacing(), params_modifided);
+        f2->layer_id = this->layer_id;
+        f2->z = this->z;
+        f2->angle = anglePass[idx] + this->angle;
+        // Maximum length of the perimeter segment linking two infill lines.
+        f2->link_max_length = this->link_max_length;
+        // Used by the concentric infill pattern to clip the loops to create extrusion paths.
+        f2->loop_clipping = this->loop_clipping;
+
         //choose if we are going to extrude with or without overlap
         if ((params.flow.bridge && idx == 0) || has_overlap[idx] || this->no_overlap_expolygons.empty()){
-            this->fill_expolygon(idx, *eec, srf_source, params_modifided, volume);
+            this->fill_expolygon(idx, *f2, *eec, srf_source, params_modifided, volume);
         }
         else{
             Surface surfaceNoOverlap(srf_source);
             for (const ExPolygon &poly : this->no_overlap_expolygons) {
                 if (poly.empty()) continue;
                 surfaceNoOverlap.expolygon = poly;
-                this->fill_expolygon(idx, *eec, surfaceNoOverlap, params_modifided, volume);
+                this->fill_expolygon(idx, *f2, *eec, surfaceNoOverlap, params_modifided, volume);
             }
         }
         
-        if (eec->entities.empty()) delete eec;
-        else eecroot.entities.push_back(eec);
+        if (eec->entities.empty()) {
+            delete eec;
+            return nullptr;
+        }
+        return eec;
     }
     
-    void FillSmooth::fill_expolygon(const int idx, ExtrusionEntityCollection &eec, const Surface &srf_to_fill, 
+    void FillSmooth::fill_expolygon(const int idx, const Fill &filler, ExtrusionEntityCollection &eec, const Surface &srf_to_fill, 
         const FillParams &params, const double volume) const {
         
-        std::unique_ptr<Fill> f2 = std::unique_ptr<Fill>(Fill::new_from_type(fillPattern[idx]));
-        f2->bounding_box = this->bounding_box;
-        f2->init_spacing(this->get_spacing(),params);
-        f2->layer_id = this->layer_id;
-        f2->z = this->z;
-        f2->angle = anglePass[idx] + this->angle;
-        // Maximum length of the perimeter segment linking two infill lines.
-        f2->link_max_length = this->link_max_length;
-        // Used by the concentric infill pattern to clip the loops to create extrusion paths.
-        f2->loop_clipping = this->loop_clipping;
-        Polylines polylines_layer = f2->fill_surface(&srf_to_fill, params);
+        Polylines polylines_layer = filler.fill_surface(&srf_to_fill, params);
 
         if (!polylines_layer.empty()) {
 
@@ -120,21 +127,21 @@ namespace Slic3r {
         FillParams first_pass_params = params;
         //if(first_pass_params.role != ExtrusionRole::erSupportMaterial && first_pass_params.role != ExtrusionRole::erSupportMaterialInterface)
         //s    first_pass_params.role = ExtrusionRole::erSolidInfill;
-        perform_single_fill(0, *eecroot, *surface, first_pass_params, volume_to_occupy);
 
-        //use monotonic for ironing pass
+        //use monotonic for ironing pass (second & third infill)
         FillParams monotonic_params = params;
         monotonic_params.monotonic = true;
 
-        //second infill
-        if (nbPass > 1){
-            perform_single_fill(1, *eecroot, *surface, monotonic_params, volume_to_occupy);
-        }
-
-        // third infill
-        if (nbPass > 2){
-            perform_single_fill(2, *eecroot, *surface, monotonic_params, volume_to_occupy);
-        }
+        // The passes are independent, generate them in parallel and keep their order.
+        ExtrusionEntityCollection *passes[3] = { nullptr, nullptr, nullptr };
+        tbb::parallel_for(tbb::blocked_range<int>(0, std::min(nbPass, 3), 1),
+            [this, surface, &first_pass_params, &monotonic_params, volume_to_occupy, &passes](const tbb::blocked_range<int> &range) {
+                for (int idx = range.begin(); idx < range.end(); ++ idx)
+                    passes[idx] = perform_single_fill(idx, *surface, idx == 0 ? first_pass_params : monotonic_params, volume_to_occupy);
+            });
+        for (ExtrusionEntityCollection *pass : passes)
+            if (pass != nullptr)
+                eecroot->entities.push_back(pass);
         
         if (!eecroot->entities.empty()) 
             out.push_back(eecroot);
@@ -55,9 +55,10 @@ protected:
     //fill algorithm to call
     InfillPattern fillPattern[3];
 
-    void perform_single_fill(const int idx, ExtrusionEntityCollection &eecroot, const Surface &srf_source,
+    // Returns nullptr if nothing was extruded by this pass.
+    ExtrusionEntityCollection* perform_single_fill(const int idx, const Surface &srf_source,
         const FillParams &params, const double volume) const;
-    void fill_expolygon(const int idx, ExtrusionEntityCollection &eec, const Surface &srf_to_fill,
+    void fill_expolygon(const int idx, const Fill &filler, ExtrusionEntityCollection &eec, const Surface &srf_to_fill,
         const FillParams &params, const double volume) const;
 };
 
@@ -13,6 +13,10 @@
 
 #include <limits>
 #include <stdexcept>
+#if __has_include(<charconv>)
+    #include <charconv>
+    #include <type_traits>
+#endif
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -27,6 +31,8 @@
 #include <boost/foreach.hpp>
 namespace pt = boost::property_tree;
 
+#include <tbb/parallel_for.h>
+
 #include <expat.h>
 #include <Eigen/Dense>
 #include "miniz_extension.hpp"
@@ -156,10 +162,32 @@ std::string get_attribute_value_string(const char** attributes, unsigned int att
     return (text != nullptr) ? text : "";
 }
 
+#if __has_include(<charconv>)
+template <typename T, typename = void>
+struct is_from_chars_convertible : std::false_type {};
+template <typename T>
+struct is_from_chars_convertible<T, std::void_t<decltype(std::from_chars(std::declval<const char*>(), std::declval<const char*>(), std::declval<T&>()))>> : std::true_type {};
+#endif
+
+// Parses the leading number of the text, as atof() does, without depending on the locale if the compiler supports it.
+template <typename T>
+static inline float parse_float(const char* text)
+{
+#if __has_include(<charconv>)
+    if constexpr (is_from_chars_convertible<T>::value) {
+        T out;
+        // The vertices are written by the exporters without a leading sign '+' or spaces, those are left for atof().
+        if (auto [ptr, ec] = std::from_chars(text, text + ::strlen(text), out); ec == std::errc())
+            return float(out);
+    }
+#endif
+    return (float)::atof(text);
+}
+
 float get_attribute_value_float(const char** attributes, unsigned int attributes_size, const char* attribute_key)
 {
     const char* text = get_attribute_value_charptr(attributes, attributes_size, attribute_key);
-    return (text != nullptr) ? (float)::atof(text) : 0.0f;
+    return (text != nullptr) ? parse_float<double>(text) : 0.0f;
 }
 
 int get_attribute_value_int(const char** attributes, unsigned int attributes_size, const char* attribute_key)
@@ -421,6 +449,8 @@ namespace Slic3r {
         IdToSlaDrainHolesMap    m_sla_drain_holes;
         std::string m_curr_metadata_name;
         std::string m_curr_characters;
+        // Only the characters of the metadata are collected, not the white spaces between the vertices and the triangles.
+        bool m_in_metadata;
         std::string m_name;
 
     public:
@@ -538,6 +568,7 @@ namespace Slic3r {
         , m_unit_factor(1.0f)
         , m_curr_metadata_name("")
         , m_curr_characters("")
+        , m_in_metadata(false)
         , m_name("")
     {
     }
@@ -566,6 +597,7 @@ namespace Slic3r {
         m_sla_support_points.clear();
         m_curr_metadata_name.clear();
         m_curr_characters.clear();
+        m_in_metadata = false;
         clear_errors();
 
         return _load_model_from_file(filename, model, config, config_substitutions);
@@ -1320,7 +1352,12 @@ namespace Slic3r {
         bool res = true;
         unsigned int num_attributes = (unsigned int)XML_GetSpecifiedAttributeCount(m_xml_parser);
 
-        if (::strcmp(MODEL_TAG, name) == 0)
+        // The vertices and the triangles are by far the most frequent elements.
+        if (::strcmp(VERTEX_TAG, name) == 0)
+            res = _handle_start_vertex(attributes, num_attributes);
+        else if (::strcmp(TRIANGLE_TAG, name) == 0)
+            res = _handle_start_triangle(attributes, num_attributes);
+        else if (::strcmp(MODEL_TAG, name) == 0)
             res = _handle_start_model(attributes, num_attributes);
         else if (::strcmp(RESOURCES_TAG, name) == 0)
             res = _handle_start_resources(attributes, num_attributes);
@@ -1330,12 +1367,8 @@ namespace Slic3r {
             res = _handle_start_mesh(attributes, num_attributes);
         else if (::strcmp(VERTICES_TAG, name) == 0)
             res = _handle_start_vertices(attributes, num_attributes);
-        else if (::strcmp(VERTEX_TAG, name) == 0)
-            res = _handle_start_vertex(attributes, num_attributes);
         else if (::strcmp(TRIANGLES_TAG, name) == 0)
             res = _handle_start_triangles(attributes, num_attributes);
-        else if (::strcmp(TRIANGLE_TAG, name) == 0)
-            res = _handle_start_triangle(attributes, num_attributes);
         else if (::strcmp(COMPONENTS_TAG, name) == 0)
             res = _handle_start_components(attributes, num_attributes);
         else if (::strcmp(COMPONENT_TAG, name) == 0)
@@ -1358,7 +1391,11 @@ namespace Slic3r {
 
         bool res = true;
 
-        if (::strcmp(MODEL_TAG, name) == 0)
+        if (::strcmp(VERTEX_TAG, name) == 0)
+            res = _handle_end_vertex();
+        else if (::strcmp(TRIANGLE_TAG, name) == 0)
+            res = _handle_end_triangle();
+        else if (::strcmp(MODEL_TAG, name) == 0)
             res = _handle_end_model();
         else if (::strcmp(RESOURCES_TAG, name) == 0)
             res = _handle_end_resources();
@@ -1368,12 +1405,8 @@ namespace Slic3r {
             res = _handle_end_mesh();
         else if (::strcmp(VERTICES_TAG, name) == 0)
             res = _handle_end_vertices();
-        else if (::strcmp(VERTEX_TAG, name) == 0)
-            res = _handle_end_vertex();
         else if (::strcmp(TRIANGLES_TAG, name) == 0)
             res = _handle_end_triangles();
-        else if (::strcmp(TRIANGLE_TAG, name) == 0)
-            res = _handle_end_triangle();
         else if (::strcmp(COMPONENTS_TAG, name) == 0)
             res = _handle_end_components();
         else if (::strcmp(COMPONENT_TAG, name) == 0)
@@ -1391,7 +1424,8 @@ namespace Slic3r {
 
     void _3MF_Importer::_handle_model_xml_characters(const XML_Char* s, int len)
     {
-        m_curr_characters.append(s, len);
+        if (m_in_metadata)
+            m_curr_characters.append(s, len);
     }
 
     void _3MF_Importer::_handle_start_config_xml_element(const char* name, const char** attributes)
@@ -1715,6 +1749,7 @@ namespace Slic3r {
     bool _3MF_Importer::_handle_start_metadata(const char** attributes, unsigned int num_attributes)
     {
         m_curr_characters.clear();
+        m_in_metadata = true;
 
         std::string name = get_attribute_value_string(attributes, num_attributes, NAME_ATTR);
         if (!name.empty())
@@ -1725,6 +1760,7 @@ namespace Slic3r {
 
     bool _3MF_Importer::_handle_end_metadata()
     {
+        m_in_metadata = false;
         if (m_curr_metadata_name == SLIC3RPE_3MF_VERSION)
         {
             m_version = (unsigned int)atoi(m_curr_characters.c_str());
@@ -2044,6 +2080,73 @@ namespace Slic3r {
             importer->_handle_end_config_xml_element(name);
     }
 
+    // Archive entry deflated while its text is being written into stream: the text is cut into chunks, which are deflated
+    // in parallel by batches into independent deflate blocks, so that neither the whole text nor its compression hold the memory and the CPU.
+    class DeflatedZipEntry
+    {
+    public:
+        std::stringstream stream;
+
+        // To be called regularly while writing into stream.
+        void flush_if_needed() { if (size_t(stream.tellp()) >= ChunkSize) this->flush_stream(); }
+        // Deflates the rest of the text and adds the entry to the archive.
+        bool add_to_archive(mz_zip_archive& archive, const std::string& name);
+
+    private:
+        static constexpr size_t ChunkSize = 1 << 20;
+        static constexpr size_t BatchSize = 16;
+
+        void flush_stream();
+        // The chunks are deflated into blocks ending at a byte boundary, the last one being the final block of the entry.
+        void deflate_pending(bool last);
+
+        std::vector<std::string> m_pending;
+        std::string              m_deflated;
+        mz_uint32                m_crc32 { MZ_CRC32_INIT };
+        mz_uint64                m_size { 0 };
+    };
+
+    void DeflatedZipEntry::flush_stream()
+    {
+        m_pending.emplace_back(stream.str());
+        stream.str("");
+        const std::string& chunk = m_pending.back();
+        m_crc32 = (mz_uint32)mz_crc32(m_crc32, (const mz_uint8*)chunk.data(), chunk.size());
+        m_size += chunk.size();
+        if (m_pending.size() >= BatchSize)
+            this->deflate_pending(false);
+    }
+
+    void DeflatedZipEntry::deflate_pending(bool last)
+    {
+        if (last && m_pending.empty())
+            // Terminate the deflate stream with an empty final block.
+            m_pending.emplace_back();
+        std::vector<std::string> deflated(m_pending.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_pending.size(), 1), [this, last, &deflated](const tbb::blocked_range<size_t>& range) {
+            std::unique_ptr<tdefl_compressor> compressor(new tdefl_compressor);
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                tdefl_init(compressor.get(), [](const void* buf, int len, void* user) -> mz_bool {
+                    static_cast<std::string*>(user)->append((const char*)buf, size_t(len));
+                    return MZ_TRUE;
+                }, &deflated[i], tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -15, MZ_DEFAULT_STRATEGY));
+                tdefl_compress_buffer(compressor.get(), m_pending[i].data(), m_pending[i].size(), (last && i + 1 == m_pending.size()) ? TDEFL_FINISH : TDEFL_SYNC_FLUSH);
+            }
+        });
+        for (const std::string& d : deflated)
+            m_deflated += d;
+        m_pending.clear();
+    }
+
+    bool DeflatedZipEntry::add_to_archive(mz_zip_archive& archive, const std::string& name)
+    {
+        if (stream.tellp() > 0)
+            this->flush_stream();
+        this->deflate_pending(true);
+        return mz_zip_writer_add_mem_ex(&archive, name.c_str(), (const void*)m_deflated.data(), m_deflated.size(), nullptr, 0,
+            MZ_DEFAULT_LEVEL | MZ_ZIP_FLAG_COMPRESSED_DATA, m_size, m_crc32);
+    }
+
     class _3MF_Exporter : public _3MF_Base
     {
         struct BuildItem
@@ -2101,8 +2204,8 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(std::stringstream& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(std::stringstream& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_object_to_model_stream(DeflatedZipEntry& entry, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_mesh_to_object_stream(DeflatedZipEntry& entry, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_config_ranges_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2333,7 +2436,9 @@ namespace Slic3r {
 
     bool _3MF_Exporter::_add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data)
     {
-        std::stringstream stream;
+        // The meshes are deflated while they are being written.
+        DeflatedZipEntry entry;
+        std::stringstream& stream = entry.stream;
         // https://en.cppreference.com/w/cpp/types/numeric_limits/max_digits10
         // Conversion of a floating-point value to text and back is exact as long as at least max_digits10 were used (9 for float, 17 for double).
         // It is guaranteed to produce the same floating-point value, even though the intermediate text representation is not exact.
@@ -2376,7 +2481,7 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(stream, object_id, *obj, build_items, object_it->second.volumes_offsets))
+            if (!_add_object_to_model_stream(entry, object_id, *obj, build_items, object_it->second.volumes_offsets))
             {
                 add_error("Unable to add object to archive");
                 return false;
@@ -2394,9 +2499,7 @@ namespace Slic3r {
 
         stream << "</" << MODEL_TAG << ">\n";
 
-        std::string out = stream.str();
-
-        if (!mz_zip_writer_add_mem(&archive, MODEL_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+        if (!entry.add_to_archive(archive, MODEL_FILE))
         {
             add_error("Unable to add model file to archive");
             return false;
@@ -2405,8 +2508,9 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(std::stringstream& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_stream(DeflatedZipEntry& entry, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
+        std::stringstream& stream = entry.stream;
         unsigned int id = 0;
         for (const ModelInstance* instance : object.instances)
         {
@@ -2419,7 +2523,7 @@ namespace Slic3r {
 
             if (id == 0)
             {
-                if (!_add_mesh_to_object_stream(stream, object, volumes_offsets))
+                if (!_add_mesh_to_object_stream(entry, object, volumes_offsets))
                 {
                     add_error("Unable to add mesh to archive");
                     return false;
@@ -2446,8 +2550,9 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(std::stringstream& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_mesh_to_object_stream(DeflatedZipEntry& entry, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
     {
+        std::stringstream& stream = entry.stream;
         stream << "   <" << MESH_TAG << ">\n";
         stream << "    <" << VERTICES_TAG << ">\n";
 
@@ -2482,6 +2587,7 @@ namespace Slic3r {
                 stream << "x=\"" << v(0) << "\" ";
                 stream << "y=\"" << v(1) << "\" ";
                 stream << "z=\"" << v(2) << "\" />\n";
+                entry.flush_if_needed();
             }
         }
 
@@ -2521,6 +2627,7 @@ namespace Slic3r {
                     stream << CUSTOM_SEAM_ATTR << "=\"" << custom_seam_data_string << "\" ";
 
                 stream << "/>\n";
+                entry.flush_if_needed();
             }
         }
 
@@ -8,7 +8,13 @@
 #include "libslic3r/Zipper.hpp"
 #include "libslic3r/SLAPrint.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <thread>
+
+#include <tbb/pipeline.h>
+#include <tbb/spin_mutex.h>
 
 #include "libslic3r/Exception.hpp"
 #include "libslic3r/SlicesToTriangleMesh.hpp"
@@ -49,15 +55,32 @@ namespace Slic3r {
 
 namespace {
 
-struct PNGBuffer { std::vector<uint8_t> buf; std::string fname; };
+// A layer image in the archive, it is extracted only when its layer gets vectorized.
+struct PNGEntry { mz_uint index; size_t size; std::string fname; };
+struct PNGBuffer { std::vector<uint8_t> buf; size_t layer_idx; };
 struct ArchiveData {
     boost::property_tree::ptree profile, config;
-    std::vector<PNGBuffer> images;
+    std::string zipfname;
+    // Sorted by the file name, which is the order of the layers.
+    std::vector<PNGEntry> images;
 };
 
 static const constexpr char *CONFIG_FNAME  = "config.ini";
 static const constexpr char *PROFILE_FNAME = "prusaslicer.ini";
 
+// Upper bound of the memory held by the layer images being extracted and decoded at the same time.
+static const constexpr size_t IMPORT_MEMORY_BUDGET = size_t(256) << 20;
+
+// Little RAII
+struct ZipReader: public MZ_Archive {
+    ZipReader(const std::string &fname) {
+        if (!open_zip_reader(&arch, fname))
+            throw Slic3r::FileIOError(get_errorstr());
+    }
+
+    ~ZipReader() { close_zip_reader(&arch); }
+};
+
 boost::property_tree::ptree read_ini(const mz_zip_archive_file_stat &entry,
                                      MZ_Archive &                    zip)
 {
@@ -73,33 +96,25 @@ boost::property_tree::ptree read_ini(const mz_zip_archive_file_stat &entry,
     return tree;
 }
 
-PNGBuffer read_png(const mz_zip_archive_file_stat &entry,
-                   MZ_Archive &                    zip,
-                   const std::string &             name)
+PNGBuffer read_png(const PNGEntry &entry, MZ_Archive &zip, size_t layer_idx)
 {
-    std::vector<uint8_t> buf(entry.m_uncomp_size);
+    std::vector<uint8_t> buf(entry.size);
 
-    if (!mz_zip_reader_extract_file_to_mem(&zip.arch, entry.m_filename,
-                                           buf.data(), buf.size(), 0))
+    if (!mz_zip_reader_extract_to_mem(&zip.arch, entry.index,
+                                      buf.data(), buf.size(), 0))
         throw Slic3r::FileIOError(zip.get_errorstr());
 
-    return {std::move(buf), (name.empty() ? entry.m_filename : name)};
+    return {std::move(buf), layer_idx};
 }
 
+// Reads the configuration files and lists the layer images, the images are not extracted yet.
 ArchiveData extract_sla_archive(const std::string &zipfname,
                                  const std::string &exclude)
 {
     ArchiveData arch;
+    arch.zipfname = zipfname;
 
-    // Little RAII
-    struct Arch: public MZ_Archive {
-        Arch(const std::string &fname) {
-            if (!open_zip_reader(&arch, fname))
-                throw Slic3r::FileIOError(get_errorstr());
-        }
-
-        ~Arch() { close_zip_reader(&arch); }
-    } zip (zipfname);
+    ZipReader zip (zipfname);
 
     mz_uint num_entries = mz_zip_reader_get_num_files(&zip.arch);
 
@@ -117,18 +132,16 @@ ArchiveData extract_sla_archive(const std::string &zipfname,
             if (name == CONFIG_FNAME) arch.config = read_ini(entry, zip);
             if (name == PROFILE_FNAME) arch.profile = read_ini(entry, zip);
 
-            if (boost::filesystem::path(name).extension().string() == ".png") {
-                auto it = std::lower_bound(
-                    arch.images.begin(), arch.images.end(), PNGBuffer{{}, name},
-                    [](const PNGBuffer &r1, const PNGBuffer &r2) {
-                        return std::less<std::string>()(r1.fname, r2.fname);
-                    });
-
-                arch.images.insert(it, read_png(entry, zip, name));
-            }
+            if (boost::filesystem::path(name).extension().string() == ".png")
+                arch.images.push_back({i, size_t(entry.m_uncomp_size), std::move(name)});
         }
     }
 
+    std::sort(arch.images.begin(), arch.images.end(),
+              [](const PNGEntry &r1, const PNGEntry &r2) {
+                  return std::less<std::string>()(r1.fname, r2.fname);
+              });
+
     return arch;
 }
 
@@ -234,51 +247,79 @@ SliceParams get_slice_params(const DynamicPrintConfig &cfg)
     return SliceParams{opt_layerh->getFloat(), opt_init_layerh->getFloat()};
 }
 
+// The layer images are streamed through a pipeline: they are extracted one by one (the zip reader is not thread safe),
+// then decoded and vectorized in parallel. Only a bounded number of layers is in flight, thus the memory held by the images
+// stays below the budget regardless of the number of layers in the archive.
 std::vector<ExPolygons> extract_slices_from_sla_archive(
     ArchiveData &            arch,
     const RasterParams &     rstp,
-    std::function<bool(int)> progr)
+    std::function<bool(int)> progr,
+    size_t                   memory_budget = IMPORT_MEMORY_BUDGET)
 {
     auto jobdir = arch.config.get<std::string>("jobDir");
     for (auto &c : jobdir) c = std::tolower(c);
 
     std::vector<ExPolygons> slices(arch.images.size());
+    if (arch.images.empty())
+        return slices;
 
     struct Status
     {
         double          incr, val, prev;
-        bool            stop = false;
+        std::atomic<bool> stop { false };
         tbb::spin_mutex mutex;
     } st {100. / slices.size(), 0., 0.};
 
-    tbb::parallel_for(size_t(0), arch.images.size(),
-                     [&arch, &slices, &st, &rstp, progr](size_t i) {
-        // Status indication guarded with the spinlock
-        {
-            std::lock_guard<tbb::spin_mutex> lck(st.mutex);
-            if (st.stop) return;
-
-            st.val += st.incr;
-            double curr = std::round(st.val);
-            if (curr > st.prev) {
-                st.prev = curr;
-                st.stop = !progr(int(curr));
-            }
-        }
-
-        png::ImageGreyscale img;
-        png::ReadBuf rb{arch.images[i].buf.data(), arch.images[i].buf.size()};
-        if (!png::decode_png(rb, img)) return;
-
-        auto rings = marchsq::execute(img, 128, rstp.win);
-        ExPolygons expolys = rings_to_expolygons(rings, rstp.px_w, rstp.px_h);
-
-        // Invert the raster transformations indicated in
-        // the profile metadata
-        invert_raster_trafo(expolys, rstp.trafo, rstp.width, rstp.height);
-
-        slices[i] = std::move(expolys);
-    });
+    // A layer in flight holds the compressed image and the decoded raster.
+    size_t max_image_size = 0;
+    for (const PNGEntry &entry : arch.images)
+        max_image_size = std::max(max_image_size, entry.size);
+    const size_t layer_memory = max_image_size + size_t(rstp.width / scaled<double>(rstp.px_w) + 1.) * size_t(rstp.height / scaled<double>(rstp.px_h) + 1.);
+    const size_t max_tokens   = std::clamp<size_t>(memory_budget / std::max<size_t>(layer_memory, 1), 1, 4 * std::max(1u, std::thread::hardware_concurrency()));
+
+    ZipReader zip (arch.zipfname);
+    size_t layer_idx = 0;
+    tbb::parallel_pipeline(max_tokens,
+        tbb::make_filter<void, PNGBuffer>(tbb::filter::serial_in_order,
+            [&arch, &zip, &st, &layer_idx](tbb::flow_control &fc) -> PNGBuffer {
+                if (layer_idx == arch.images.size() || st.stop) {
+                    fc.stop();
+                    return PNGBuffer();
+                }
+                PNGBuffer png = read_png(arch.images[layer_idx], zip, layer_idx);
+                ++ layer_idx;
+                return png;
+            }) &
+        tbb::make_filter<PNGBuffer, void>(tbb::filter::parallel,
+            [&slices, &st, &rstp, progr](PNGBuffer png) {
+                // Status indication guarded with the spinlock
+                {
+                    std::lock_guard<tbb::spin_mutex> lck(st.mutex);
+                    if (st.stop) return;
+
+                    st.val += st.incr;
+                    double curr = std::round(st.val);
+                    if (curr > st.prev) {
+                        st.prev = curr;
+                        st.stop = !progr(int(curr));
+                    }
+                }
+
+                png::ImageGreyscale img;
+                png::ReadBuf rb{png.buf.data(), png.buf.size()};
+                if (!png::decode_png(rb, img)) return;
+                // Release the compressed image while the raster is being vectorized.
+                png.buf = std::vector<uint8_t>();
+
+                auto rings = marchsq::execute(img, 128, rstp.win);
+                ExPolygons expolys = rings_to_expolygons(rings, rstp.px_w, rstp.px_h);
+
+                // Invert the raster transformations indicated in
+                // the profile metadata
+                invert_raster_trafo(expolys, rstp.trafo, rstp.width, rstp.height);
+
+                slices[png.layer_idx] = std::move(expolys);
+            }));
 
     if (st.stop) slices = {};
 
@@ -427,14 +468,12 @@ void SL1Archive::export_print(Zipper& zipper,
         zipper.add_entry("prusaslicer.ini");
         zipper << to_ini(slicerconf);
         
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
+        for_each_layer(print, [&zipper, &project](size_t i, const sla::EncodedRaster &rst) {
+            std::string imgname = project + string_printf("%.5d", i) + "." +
                                   rst.extension();
             
             zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
-        }
+        });
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
         // Rethrow the exception
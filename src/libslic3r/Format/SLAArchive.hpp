@@ -1,6 +1,7 @@
 #ifndef slic3r_FORMAT_SLACOMMON_HPP
 #define slic3r_FORMAT_SLACOMMON_HPP
 
+#include <functional>
 #include <string>
 
 #include "libslic3r/Zipper.hpp"
@@ -17,6 +18,10 @@ protected:
     
     uqptr<sla::RasterBase> create_raster() const override;
     sla::RasterEncoder get_encoder() const override;
+
+    // Calls fn(layer_idx, encoded_raster) for the layers of the print in their order. The layers rasterized by the rasterization step
+    // are passed directly, with the streamed export the layers are rasterized and encoded in parallel by batches of a bounded size.
+    void for_each_layer(const SLAPrint &print, const std::function<void(size_t, const sla::EncodedRaster&)> &fn) const;
 public: 
     SLAArchive() = default;
    
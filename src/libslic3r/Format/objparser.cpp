@@ -1,14 +1,26 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include "objparser.hpp"
 
 namespace ObjParser {
 
-static bool obj_parseline(const char *line, ObjData &data)
+// Face vertex index given relative to the end of the vertex lists, which was resolved against the lists of a chunk of the file.
+struct ObjRelativeIndex
+{
+	size_t			vertex;
+	int ObjVertex::*member;
+};
+
+// relative_indices: if not null, the relative indices of the face vertices are recorded to be shifted once the chunks are merged.
+static bool obj_parseline(const char *line, ObjData &data, std::vector<ObjRelativeIndex> *relative_indices = nullptr)
 {
 #define EATWS() while (*line == ' ' || *line == '\t') ++ line
 
@@ -213,6 +225,14 @@ static bool obj_parseline(const char *line, ObjData &data)
 					line = endptr;
 				}
 			}
+			if (relative_indices != nullptr) {
+				if (vertex.coordIdx < 0)
+					relative_indices->push_back({ data.vertices.size(), &ObjVertex::coordIdx });
+				if (vertex.normalIdx < 0)
+					relative_indices->push_back({ data.vertices.size(), &ObjVertex::normalIdx });
+				if (vertex.textureCoordIdx < 0)
+					relative_indices->push_back({ data.vertices.size(), &ObjVertex::textureCoordIdx });
+			}
 			if (vertex.coordIdx < 0)
                 vertex.coordIdx += (int)data.coordinates.size() / 4;
             else
@@ -320,43 +340,103 @@ static bool obj_parseline(const char *line, ObjData &data)
 	return true;
 }
 
+// Appends the data parsed from a chunk of the file to data.
+static void obj_merge(ObjData &data, ObjData &&chunk, const std::vector<ObjRelativeIndex> &relative_indices)
+{
+	const int coordinates_offset		 = int(data.coordinates.size() / 4);
+	const int normals_offset			 = int(data.normals.size() / 3);
+	const int texture_coordinates_offset = int(data.textureCoordinates.size() / 3);
+	const int vertices_offset			 = int(data.vertices.size());
+	// The relative indices were resolved against the vertex lists of the chunk only.
+	for (const ObjRelativeIndex &idx : relative_indices)
+		chunk.vertices[idx.vertex].*idx.member += 
+			(idx.member == &ObjVertex::coordIdx) ? coordinates_offset : (idx.member == &ObjVertex::normalIdx) ? normals_offset : texture_coordinates_offset;
+	auto append = [](auto &dst, auto &src) {
+		if (dst.empty())
+			dst = std::move(src);
+		else
+			dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+	};
+	auto append_shifted = [vertices_offset, &append](auto &dst, auto &src) {
+		for (auto &item : src)
+			item.vertexIdxFirst += vertices_offset;
+		append(dst, src);
+	};
+	append(data.coordinates,		chunk.coordinates);
+	append(data.textureCoordinates, chunk.textureCoordinates);
+	append(data.normals,			chunk.normals);
+	append(data.parameters,			chunk.parameters);
+	append(data.mtllibs,			chunk.mtllibs);
+	append_shifted(data.usemtls,	chunk.usemtls);
+	append_shifted(data.objects,	chunk.objects);
+	append_shifted(data.groups,		chunk.groups);
+	append_shifted(data.smoothingGroups, chunk.smoothingGroups);
+	append(data.vertices,			chunk.vertices);
+}
+
 bool objparse(const char *path, ObjData &data)
 {
-	FILE *pFile = boost::nowide::fopen(path, "rt");
+	FILE *pFile = boost::nowide::fopen(path, "rb");
 	if (pFile == 0)
 		return false;
 
 	try {
-		char buf[65536 * 2];
-		size_t len = 0;
-		size_t lenPrev = 0;
-		while ((len = ::fread(buf + lenPrev, 1, 65536, pFile)) != 0) {
-			len += lenPrev;
-			size_t lastLine = 0;
-			for (size_t i = 0; i < len; ++ i)
-				if (buf[i] == '\r' || buf[i] == '\n') {
-					buf[i] = 0;
-					char *c = buf + lastLine;
-					while (*c == ' ' || *c == '\t')
-						++ c;
-					//FIXME check the return value and exit on error?
-					// Will it break parsing of some obj files?
-					obj_parseline(c, data);
-					lastLine = i + 1;
-				}
-			lenPrev = len - lastLine;
-			if (lenPrev > 65536) {
-		    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
-				::fclose(pFile);
-				return false;
+		// The whole file is parsed in memory by chunks of whole lines, the chunks are parsed in parallel.
+		std::vector<char> buf;
+		char block[65536];
+		for (size_t len = 0; (len = ::fread(block, 1, sizeof(block), pFile)) != 0;)
+			buf.insert(buf.end(), block, block + len);
+		::fclose(pFile);
+		pFile = nullptr;
+		// Terminate the last line.
+		buf.push_back('\n');
+
+		static constexpr size_t chunk_size = 1 << 22;
+		std::vector<std::pair<size_t, size_t>> chunks;
+		for (size_t begin = 0; begin < buf.size();) {
+			size_t end = std::min(begin + chunk_size, buf.size());
+			while (end < buf.size() && buf[end] != '\r' && buf[end] != '\n')
+				++ end;
+			end = std::min(end + 1, buf.size());
+			chunks.emplace_back(begin, end);
+			begin = end;
+		}
+
+		std::vector<ObjData>						 chunks_data(chunks.size());
+		std::vector<std::vector<ObjRelativeIndex>>	 chunks_relative_indices(chunks.size());
+		std::vector<char>							 chunks_line_too_long(chunks.size(), false);
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+			for (size_t ichunk = range.begin(); ichunk < range.end(); ++ ichunk) {
+				size_t lastLine = chunks[ichunk].first;
+				for (size_t i = chunks[ichunk].first; i < chunks[ichunk].second; ++ i)
+					if (buf[i] == '\r' || buf[i] == '\n') {
+						if (i - lastLine > 65536) {
+							chunks_line_too_long[ichunk] = true;
+							return;
+						}
+						buf[i] = 0;
+						char *c = buf.data() + lastLine;
+						while (*c == ' ' || *c == '\t')
+							++ c;
+						//FIXME check the return value and exit on error?
+						// Will it break parsing of some obj files?
+						obj_parseline(c, chunks_data[ichunk], (ichunk == 0) ? nullptr : &chunks_relative_indices[ichunk]);
+						lastLine = i + 1;
+					}
 			}
-			memmove(buf, buf + lastLine, lenPrev);
+		});
+		if (std::find(chunks_line_too_long.begin(), chunks_line_too_long.end(), true) != chunks_line_too_long.end()) {
+	    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
+			return false;
 		}
+		for (size_t ichunk = 0; ichunk < chunks.size(); ++ ichunk)
+			obj_merge(data, std::move(chunks_data[ichunk]), chunks_relative_indices[ichunk]);
     }
     catch (std::bad_alloc&) {
     	BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
 	}
-	::fclose(pFile);
+	if (pFile != nullptr)
+		::fclose(pFile);
 
 	// printf("vertices: %d\r\n", data.vertices.size() / 4);
 	// printf("coords: %d\r\n", data.coordinates.size());
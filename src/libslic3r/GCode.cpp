@@ -5,10 +5,13 @@
 #include "ExtrusionEntity.hpp"
 #include "EdgeGrid.hpp"
 #include "Geometry.hpp"
+#include "GCode/ArcFitting.hpp"
 #include "GCode/FanMover.hpp"
 #include "GCode/PrintExtents.hpp"
+#include "GCode/ThumbnailRenderer.hpp"
 #include "GCode/WipeTower.hpp"
 #include "ShortestPath.hpp"
+#include "Tracing.hpp"
 #include "Utils.hpp"
 #include "ClipperUtils.hpp"
 #include "libslic3r.h"
@@ -33,6 +36,9 @@
 #include "SVG.hpp"
 
 #include <tbb/parallel_for.h>
+#include <tbb/pipeline.h>
+#include <tbb/task_group.h>
+#include <tbb/task_scheduler_init.h>
 
 #include <Shiny/Shiny.h>
 
@@ -583,6 +589,31 @@ std::vector<GCode::LayerToPrint> GCode::collect_layers_to_print(const PrintObjec
     return layers_to_print;
 }
 
+// Layers of an object in the order of collect_layers_to_print(object), a support layer being taken only where there is no object layer
+// at the same print_z. Unlike collect_layers_to_print(), this only reads the layers and it reports nothing, so it may run in the background.
+static std::vector<const Layer*> object_layers_to_print(const PrintObject &object)
+{
+    std::vector<const Layer*> layers;
+    layers.reserve(object.layers().size() + object.support_layers().size());
+    size_t idx_object_layer  = 0;
+    size_t idx_support_layer = 0;
+    while (idx_object_layer < object.layers().size() || idx_support_layer < object.support_layers().size()) {
+        const Layer *object_layer  = (idx_object_layer < object.layers().size()) ? object.layers()[idx_object_layer++] : nullptr;
+        const Layer *support_layer = (idx_support_layer < object.support_layers().size()) ? object.support_layers()[idx_support_layer++] : nullptr;
+        if (object_layer && support_layer) {
+            if (object_layer->print_z < support_layer->print_z - EPSILON) {
+                support_layer = nullptr;
+                --idx_support_layer;
+            } else if (support_layer->print_z < object_layer->print_z - EPSILON) {
+                object_layer = nullptr;
+                --idx_object_layer;
+            }
+        }
+        layers.emplace_back(object_layer ? object_layer : support_layer);
+    }
+    return layers;
+}
+
 // Prepare for non-sequential printing of multiple objects: Support resp. object layers with nearly identical print_z
 // will be printed for  all objects at once.
 // Return a list of <print_z, per object LayerToPrint> items.
@@ -646,6 +677,9 @@ namespace DoExport {
     }
 } // namespace DoExport
 
+// Size of the stdio buffer of the exported G-code file.
+static constexpr size_t GCODE_FILE_BUFFER_SIZE = size_t(1) << 20;
+
 void GCode::do_export(Print* print, const char* path, GCodeProcessor::Result* result, ThumbnailsGeneratorCallback thumbnail_cb)
 {
     PROFILE_CLEAR();
@@ -664,9 +698,14 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessor::Result* re
     std::string path_tmp(path);
     path_tmp += ".tmp";
 
+    // Large buffer of the output file: the G-code is written in many small fragments and in few large layers,
+    // a buffer of the default size would issue a write system call every few kilobytes.
+    // It is released after the file is closed.
+    std::unique_ptr<char[]> file_buffer(new char[GCODE_FILE_BUFFER_SIZE]);
     FILE *file = boost::nowide::fopen(path_tmp.c_str(), "wb");
     if (file == nullptr)
         throw Slic3r::RuntimeError(std::string("G-code export to ") + path + " failed.\nCannot open the file for writing.\n");
+    setvbuf(file, file_buffer.get(), _IOFBF, GCODE_FILE_BUFFER_SIZE);
 
     try {
         m_placeholder_parser_failed_templates.clear();
@@ -701,13 +740,9 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessor::Result* re
         throw Slic3r::PlaceholderParserError(msg);
     }
 
-    BOOST_LOG_TRIVIAL(debug) << "Start processing gcode, " << log_memory_info();
-    //klipper can hide gcode into a macro, so add guessed init gcode to the processor.
-    if (this->config().start_gcode_manual) {
-        std::string gcode = m_writer.preamble();
-        m_processor.process_string(gcode, [print]() { print->throw_if_canceled(); });
-    }
-    m_processor.process_file(path_tmp, true, [print]() { print->throw_if_canceled(); });
+    BOOST_LOG_TRIVIAL(debug) << "Finish processing gcode, " << log_memory_info();
+    // The gcode has been processed while being written, only the time estimates remain to be added into the file.
+    m_processor.finish_streaming(path_tmp, true);
     DoExport::update_print_estimated_times_stats(m_processor, print->m_print_statistics);
     if (result != nullptr)
         *result = std::move(m_processor.extract_result());
@@ -945,6 +980,7 @@ namespace DoExport {
 	static std::string update_print_stats_and_format_filament_stats(
 	    const bool                   has_wipe_tower,
 	    const WipeTowerData         &wipe_tower_data,
+	    const PrintConfig           &config,
 	    const std::vector<Extruder> &extruders,
 		PrintStatistics 		    &print_statistics)
 	{
@@ -976,21 +1012,22 @@ namespace DoExport {
 	                ++ dst.second;
 	            };
 	            print_statistics.filament_stats.insert(std::pair<size_t, float>{extruder.id(), (float)used_filament});
+	            print_statistics.extruded_volumes[extruder.id()] = extruded_volume;
+	            if (has_wipe_tower)
+	                print_statistics.wipe_tower_volumes[extruder.id()] = extruded_volume - extruder.extruded_volume();
 	            append(out_filament_used_mm,  "%.2lf", used_filament);
 	            append(out_filament_used_cm3, "%.2lf", extruded_volume * 0.001);
 	            if (filament_weight > 0.) {
-	                print_statistics.total_weight = print_statistics.total_weight + filament_weight;
 	                append(out_filament_used_g, "%.2lf", filament_weight);
-	                if (filament_cost > 0.) {
-	                    print_statistics.total_cost = print_statistics.total_cost + filament_cost;
+	                if (filament_cost > 0.)
 	                    append(out_filament_cost, "%.2lf", filament_cost);
-	                }
 	            }
 	            print_statistics.total_used_filament += used_filament;
 	            print_statistics.total_extruded_volume += extruded_volume;
 	            print_statistics.total_wipe_tower_filament += has_wipe_tower ? used_filament - extruder.used_filament() : 0.;
-	            print_statistics.total_wipe_tower_cost += has_wipe_tower ? (extruded_volume - extruder.extruded_volume())* extruder.filament_density() * 0.001 * extruder.filament_cost() * 0.001 : 0.;
 	        }
+	        // The weights and the costs are derived from the extruded volumes.
+	        print_statistics.update_weight_and_cost(config);
 	        filament_stats_string_out += out_filament_used_mm.first;
             filament_stats_string_out += "\n" + out_filament_used_cm3.first;
 			if (out_filament_used_g.second)
@@ -1087,6 +1124,9 @@ void GCode::_init_multiextruders(FILE *file, Print &print, GCodeWriter & writer,
 }
 
 
+// Upper limit of the memory occupied by the avoid crossing perimeters boundaries precomputed before the layers are exported.
+static constexpr size_t AVOID_CROSSING_PERIMETERS_PRECOMPUTE_MAX_MEMORY = size_t(512) << 20;
+
 void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thumbnail_cb)
 {
     PROFILE_FUNC();
@@ -1162,11 +1202,22 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     m_enable_extrusion_role_markers = false;
 #endif /* HAS_PRESSURE_EQUALIZER */
 
+    //klipper can hide gcode into a macro, so add guessed init gcode to the processor.
+    if (this->config().start_gcode_manual) {
+        std::string gcode = m_writer.preamble();
+        m_processor.process_string(gcode, [&print]() { print.throw_if_canceled(); });
+    }
+    // From now on, everything written into the file is processed by _write(), instead of parsing the file again after the export.
+    m_processor.start_streaming();
+
     // Write information on the generator.
     _write_format(file, "; %s\n\n", Slic3r::header_slic3r_generated().c_str());
 
 
     const ConfigOptionBool *thumbnails_with_bed = print.full_print_config().option<ConfigOptionBool>("thumbnails_with_bed");
+    // Without the 3D scene of the GUI (command line export), the thumbnails are rendered in software.
+    if (thumbnail_cb == nullptr)
+        thumbnail_cb = [&print](const ThumbnailsParams &params) { return render_thumbnails(print, params); };
     DoExport::export_thumbnails_to_file(thumbnail_cb, 
         print.full_print_config().option<ConfigOptionPoints>("thumbnails")->values,
         thumbnails_with_bed==nullptr? false:thumbnails_with_bed->value,
@@ -1476,6 +1527,11 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
         if (print.config().complete_objects.value) {
             size_t finished_objects = 0;
             const PrintObject *prev_object = (*print_object_instance_sequential_active)->print_object;
+            // The avoid crossing perimeters boundaries of the next object are computed in the background
+            // while the G-code of the current object is being generated.
+            const PrintObject                          *precomputed_object = nullptr;
+            AvoidCrossingPerimeters::PrecomputedLayers  precomputed_layers;
+            tbb::task_group                             precompute_next_object;
             for (; print_object_instance_sequential_active != print_object_instances_ordering.end(); ++ print_object_instance_sequential_active) {
                 const PrintObject &object = *(*print_object_instance_sequential_active)->print_object;
                 if (&object != prev_object || tool_ordering.first_extruder() != final_extruder_id) {
@@ -1520,26 +1576,65 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
                 m_cooling_buffer->set_current_extruder(initial_extruder_id);
                 // Pair the object layers with the support layers by z, extrude them.
                 std::vector<LayerToPrint> layers_to_print = collect_layers_to_print(object);
-                for (LayerToPrint &ltp : layers_to_print) {
-                    std::vector<LayerToPrint> lrs;
-                    lrs.emplace_back(std::move(ltp));
-                    this->process_layer(file, print, print.m_print_statistics, lrs, tool_ordering.tools_for_layer(ltp.print_z()), nullptr, *print_object_instance_sequential_active - object.instances().data());
+                if (print.config().avoid_crossing_perimeters) {
+                    precompute_next_object.wait();
+                    if (precomputed_object == &object)
+                        m_avoid_crossing_perimeters.set_precomputed_layers(std::move(precomputed_layers));
+                    else
+                        m_avoid_crossing_perimeters.init_layers(object_layers_to_print(object), AVOID_CROSSING_PERIMETERS_PRECOMPUTE_MAX_MEMORY);
+                    precomputed_object = nullptr;
+                    precomputed_layers.clear();
+                    // Instances of the same object share the layers, their boundaries are computed again for each instance as init_layer() consumes them.
+                    if (auto it_next = std::next(print_object_instance_sequential_active); it_next != print_object_instances_ordering.end()) {
+                        precomputed_object = (*it_next)->print_object;
+                        precompute_next_object.run([precomputed_object, &precomputed_layers]() {
+                            precomputed_layers = AvoidCrossingPerimeters::precompute_layers(object_layers_to_print(*precomputed_object), AVOID_CROSSING_PERIMETERS_PRECOMPUTE_MAX_MEMORY);
+                        });
+                    }
                     print.throw_if_canceled();
                 }
+                this->process_layers(file, print, layers_to_print.size(),
+                    [this, &print, &layers_to_print, &tool_ordering, instance_idx = *print_object_instance_sequential_active - object.instances().data()](size_t layer_idx) {
+                        std::vector<LayerToPrint> lrs;
+                        lrs.emplace_back(std::move(layers_to_print[layer_idx]));
+                        return this->process_layer(print, print.m_print_statistics, lrs, tool_ordering.tools_for_layer(lrs.front().print_z()), nullptr, instance_idx);
+                    },
+                    [this, &print, &layers_to_print](size_t first_layer, size_t last_layer) {
+                        std::vector<const Layer*> layers;
+                        for (size_t layer_idx = first_layer; layer_idx < last_layer; ++ layer_idx)
+                            if (layers_to_print[layer_idx].object_layer != nullptr)
+                                layers.emplace_back(layers_to_print[layer_idx].object_layer);
+                        this->prepare_lower_layer_edge_grids(print, layers);
+                    });
 #ifdef HAS_PRESSURE_EQUALIZER
                 if (m_pressure_equalizer)
                     _write(file, m_pressure_equalizer->process("", true));
 #endif /* HAS_PRESSURE_EQUALIZER */
+                m_avoid_crossing_perimeters.clear_precomputed_layers();
                 ++ finished_objects;
                 // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
                 // Reset it when starting another object from 1st layer.
                 m_second_layer_things_done = false;
                 prev_object = &object;
             }
+            precompute_next_object.wait();
         } else {
             // Sort layers by Z.
             // All extrusion moves with the same top layer height are extruded uninterrupted.
             std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> layers_to_print = collect_layers_to_print(print);
+            // Plan the order of the object instances over several layers to shorten the travels between them.
+            std::vector<std::vector<const PrintInstance*>> print_object_instances_ordering_by_layer;
+            if (print.config().travel_planning_lookahead.value > 0) {
+                std::vector<std::vector<const PrintObject*>> objects_by_layer;
+                objects_by_layer.reserve(layers_to_print.size());
+                for (const std::pair<coordf_t, std::vector<LayerToPrint>> &layer : layers_to_print) {
+                    objects_by_layer.emplace_back();
+                    for (const LayerToPrint &ltp : layer.second)
+                        if (ltp.object() != nullptr)
+                            objects_by_layer.back().emplace_back(ltp.object());
+                }
+                print_object_instances_ordering_by_layer = chain_print_object_instances(print, objects_by_layer, size_t(print.config().travel_planning_lookahead.value));
+            }
             // Prusa Multi-Material wipe tower.
             if (has_wipe_tower && ! layers_to_print.empty()) {
                 m_wipe_tower.reset(new WipeTowerIntegration(print.config(), *print.wipe_tower_data().priming.get(), print.wipe_tower_data().tool_changes, *print.wipe_tower_data().final_purge.get()));
@@ -1582,18 +1677,38 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
                 }
                 print.throw_if_canceled();
             }
-            // Extrude the layers.
-            for (auto &layer : layers_to_print) {
-                const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
-                if (m_wipe_tower && layer_tools.has_wipe_tower)
-                    m_wipe_tower->next_layer();
-                this->process_layer(file, print, print.m_print_statistics, layer.second, layer_tools, &print_object_instances_ordering, size_t(-1));
+            if (print.config().avoid_crossing_perimeters) {
+                std::vector<const Layer*> layers;
+                for (const std::pair<coordf_t, std::vector<LayerToPrint>> &layer : layers_to_print)
+                    for (const LayerToPrint &ltp : layer.second)
+                        layers.emplace_back(ltp.layer());
+                m_avoid_crossing_perimeters.init_layers(layers, AVOID_CROSSING_PERIMETERS_PRECOMPUTE_MAX_MEMORY);
                 print.throw_if_canceled();
             }
+            // Extrude the layers.
+            this->process_layers(file, print, layers_to_print.size(),
+                [this, &print, &layers_to_print, &tool_ordering, &print_object_instances_ordering, &print_object_instances_ordering_by_layer](size_t layer_idx) {
+                    const std::pair<coordf_t, std::vector<LayerToPrint>> &layer = layers_to_print[layer_idx];
+                    const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
+                    if (m_wipe_tower && layer_tools.has_wipe_tower)
+                        m_wipe_tower->next_layer();
+                    const std::vector<const PrintInstance*> &ordering = print_object_instances_ordering_by_layer.empty() ?
+                        print_object_instances_ordering : print_object_instances_ordering_by_layer[layer_idx];
+                    return this->process_layer(print, print.m_print_statistics, layer.second, layer_tools, &ordering, size_t(-1));
+                },
+                [this, &print, &layers_to_print](size_t first_layer, size_t last_layer) {
+                    std::vector<const Layer*> layers;
+                    for (size_t layer_idx = first_layer; layer_idx < last_layer; ++ layer_idx)
+                        for (const LayerToPrint &ltp : layers_to_print[layer_idx].second)
+                            if (ltp.object_layer != nullptr)
+                                layers.emplace_back(ltp.object_layer);
+                    this->prepare_lower_layer_edge_grids(print, layers);
+                });
 #ifdef HAS_PRESSURE_EQUALIZER
             if (m_pressure_equalizer)
                 _write(file, m_pressure_equalizer->process("", true));
 #endif /* HAS_PRESSURE_EQUALIZER */
+            m_avoid_crossing_perimeters.clear_precomputed_layers();
             if (m_wipe_tower)
                 // Purge the extruder, pull out the active filament.
                 _write(file, m_wipe_tower->finalize(*this));
@@ -1649,7 +1764,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     // Get filament stats.
     _write(file, DoExport::update_print_stats_and_format_filament_stats(
     	// Const inputs
-        has_wipe_tower, print.wipe_tower_data(),
+        has_wipe_tower, print.wipe_tower_data(), print.config(),
         m_writer.extruders(),
         // Modifies
         print.m_print_statistics));
@@ -1658,7 +1773,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     _write_format(file, "; total filament cost = %.2lf\n", print.m_print_statistics.total_cost);
     if (print.m_print_statistics.total_toolchanges > 0)
     	_write_format(file, "; total toolchanges = %i\n", print.m_print_statistics.total_toolchanges);
-    _writeln(file, GCodeProcessor::Estimated_Printing_Time_Placeholder_Tag);
+    _write(file, GCodeProcessor::Estimated_Printing_Time_Placeholder_Line);
 
     // Append full config.
     _write(file, "\n", true);
@@ -1689,7 +1804,14 @@ std::string GCode::placeholder_parser_process(const std::string &name, const std
         }
         func_add_colour("thumbnails_color_int", config().thumbnails_color);
 
-        std::string gcode = m_placeholder_parser.process(templ, current_extruder_id, config_override, &m_placeholder_parser_context);
+        auto it_compiled = m_placeholder_parser_compiled_templates.find(templ);
+        if (it_compiled == m_placeholder_parser_compiled_templates.end()) {
+            // The wipe tower G-code is unique at each toolchange, keep the cache bounded.
+            if (m_placeholder_parser_compiled_templates.size() >= 256)
+                m_placeholder_parser_compiled_templates.clear();
+            it_compiled = m_placeholder_parser_compiled_templates.emplace(templ, PlaceholderParser::compile(templ)).first;
+        }
+        std::string gcode = m_placeholder_parser.process(it_compiled->second, current_extruder_id, config_override, &m_placeholder_parser_context);
         if (!gcode.empty() && m_config.gcode_comments) {
             gcode = "; custom gcode: " + name + "\n" + gcode;
             check_add_eol(gcode);
@@ -2143,14 +2265,28 @@ namespace Skirt {
 
 } // namespace Skirt
 
+// Chain the entities by a greedy algorithm to minimize a travel distance from start_near, then pass them to extrude() in that order.
+// The entities are owned by the layers, so they are neither reordered nor reversed in place. Only those to be printed reversed are copied.
+template<typename ExtrudeFn>
+static void extrude_chained(const ExtrusionEntitiesPtr &entities, const Point &start_near, ExtrudeFn extrude)
+{
+    for (const std::pair<size_t, bool> &idx : chain_extrusion_entities(const_cast<ExtrusionEntitiesPtr&>(entities), &start_near)) {
+        const ExtrusionEntity *entity = entities[idx.first];
+        if (idx.second) {
+            std::unique_ptr<ExtrusionEntity> reversed(entity->clone());
+            reversed->reverse();
+            extrude(*reversed);
+        } else
+            extrude(*entity);
+    }
+}
+
 // In sequential mode, process_layer is called once per each object and its copy,
 // therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
 // In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
 // For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
 // and performing the extruder specific extrusions together.
-void GCode::process_layer(
-    // Write into the output file.
-    FILE                                    *file,
+GCode::LayerResult GCode::process_layer(
     const Print                             &print,
     PrintStatistics                         &print_stat,
     // Set of object & print layers of the same PrintObject and with the same print_z.
@@ -2162,13 +2298,15 @@ void GCode::process_layer(
     // Otherwise print a single copy of a single object.
     const size_t                     		 single_object_instance_idx)
 {
+    SLIC3R_TRACE_ZONE("GCode::process_layer");
     assert(! layers.empty());
     // Either printing all copies of all objects, or just a single copy of a single object.
     assert(single_object_instance_idx == size_t(-1) || layers.size() == 1);
 
+    LayerResult result;
     if (layer_tools.extruders.empty())
         // Nothing to extrude.
-        return;
+        return result;
 
     // Extract 1st object_layer and support_layer of this set of layers with an equal print_z.
     const Layer         *object_layer  = nullptr;
@@ -2439,6 +2577,13 @@ void GCode::process_layer(
 
     // Extrude the skirt, brim, support, perimeters, infill ordered by the extruders.
     std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids(layers.size());
+    // Pick up the distance fields computed ahead by prepare_lower_layer_edge_grids(), the others are created on demand.
+    for (size_t i = 0; i < layers.size(); ++ i)
+        if (layers[i].object_layer != nullptr)
+            if (auto it = m_lower_layer_edge_grids.find(layers[i].object_layer); it != m_lower_layer_edge_grids.end()) {
+                lower_layer_edge_grids[i] = std::move(it->second);
+                m_lower_layer_edge_grids.erase(it);
+            }
     for (uint16_t extruder_id : layer_tools.extruders)
     {
         gcode += (layer_tools.has_wipe_tower && m_wipe_tower) ?
@@ -2581,14 +2726,41 @@ void GCode::process_layer(
                             gcode += m_writer.set_temperature(m_config.first_layer_temperature.get_at(m_writer.tool()->id()), false, m_writer.tool()->id());
                     else if (m_config.temperature.get_at(m_writer.tool()->id()) > 0) // don't set it if disabled
                         gcode += m_writer.set_temperature(m_config.temperature.get_at(m_writer.tool()->id()), false, m_writer.tool()->id());
-                    gcode += this->extrude_support(
-                        // support_extrusion_role is erSupportMaterial, erSupportMaterialInterface or erMixed for all extrusion paths.
-                    instance_to_print.object_by_extruder.support->chained_path_from(m_last_pos, instance_to_print.object_by_extruder.support_extrusion_role));
+                    const ExtrusionEntityCollection &support = *instance_to_print.object_by_extruder.support;
+                    // support_extrusion_role is erSupportMaterial, erSupportMaterialInterface or erMixed for all extrusion paths.
+                    const ExtrusionRole support_role = instance_to_print.object_by_extruder.support_extrusion_role;
+                    if (support.no_sort || support_role == erMixed)
+                        gcode += this->extrude_support(support);
+                    else
+                        extrude_chained(filter_by_extrusion_role(support.entities, support_role), m_last_pos,
+                            [this, &gcode](const ExtrusionEntity &support_fill) { gcode += this->extrude_support(support_fill); });
                     m_layer = layers[instance_to_print.layer_id].layer();
                 }
-                //FIXME order islands?
                 // Sequential tool path ordering of multiple parts within the same object, aka. perimeter tracking (#5511)
-                for (ObjectByExtruder::Island &island : instance_to_print.object_by_extruder.islands) {
+                std::vector<ObjectByExtruder::Island> &islands = instance_to_print.object_by_extruder.islands;
+                std::vector<size_t> islands_order;
+                const Layer *object_layer = layers[instance_to_print.layer_id].object_layer;
+                if (print.config().travel_planning_lookahead.value > 0 && object_layer != nullptr && islands.size() == object_layer->lslices_bboxes.size() + 1) {
+                    // Visit the islands by the closest one first, starting from the current position.
+                    // The extrusions not fitting into any island stay last.
+                    Points              island_centers;
+                    std::vector<size_t> island_ids;
+                    for (size_t i = 0; i + 1 < islands.size(); ++ i)
+                        if (! islands[i].by_region.empty()) {
+                            island_centers.emplace_back(object_layer->lslices_bboxes[i].center());
+                            island_ids.emplace_back(i);
+                        }
+                    Point start_near = m_last_pos;
+                    for (size_t i : chain_points(island_centers, m_last_pos_defined ? &start_near : nullptr))
+                        islands_order.emplace_back(island_ids[i]);
+                    islands_order.emplace_back(islands.size() - 1);
+                } else {
+                    islands_order.reserve(islands.size());
+                    for (size_t i = 0; i < islands.size(); ++ i)
+                        islands_order.emplace_back(i);
+                }
+                for (size_t island_idx : islands_order) {
+                    ObjectByExtruder::Island &island = islands[island_idx];
                     const std::vector<ObjectByExtruder::Island::Region>& by_region_specific =
                         is_anything_overridden ? 
                         island.by_region_per_copy(by_region_per_copy_cache, 
@@ -2704,28 +2876,88 @@ void GCode::process_layer(
     }
 
 
+    result.gcode        = std::move(gcode);
+    result.layer_id     = layer.id();
+    result.support_only = support_layer != nullptr && object_layer == nullptr;
+    result.is_nop       = false;
+    BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z <<
+        log_memory_info();
+
+
+    std::chrono::time_point<std::chrono::system_clock> end_export_layer = std::chrono::system_clock::now();
+    if ((static_cast<std::chrono::duration<double>>(end_export_layer - m_last_status_update)).count() > 0.2) {
+        m_last_status_update = std::chrono::system_clock::now();
+        print.set_status(int((layer.id() * 100) / layer_count()), std::string(L("Generating G-code layer %s / %s")), std::vector<std::string>{ std::to_string(layer.id()), std::to_string(layer_count()) }, PrintBase::SlicingStatus::DEFAULT);
+    }
+    return result;
+}
+
+void GCode::process_layer_postprocess(FILE *file, LayerResult &&layer)
+{
+    if (layer.is_nop)
+        return;
+
     // Apply cooling logic; this may alter speeds.
     if (m_cooling_buffer)
-        gcode = m_cooling_buffer->process_layer(gcode, layer.id(), (support_layer != nullptr && object_layer == nullptr));
+        layer.gcode = m_cooling_buffer->process_layer(layer.gcode, layer.layer_id, layer.support_only);
 
 #ifdef HAS_PRESSURE_EQUALIZER
     // Apply pressure equalization if enabled;
     // printf("G-code before filter:\n%s\n", gcode.c_str());
     if (m_pressure_equalizer)
-        gcode = m_pressure_equalizer->process(gcode.c_str(), false);
+        layer.gcode = m_pressure_equalizer->process(layer.gcode.c_str(), false);
     // printf("G-code after filter:\n%s\n", out.c_str());
 #endif /* HAS_PRESSURE_EQUALIZER */
 
-    _write(file, gcode);
-    BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z <<
-        log_memory_info();
+    _write(file, layer.gcode);
+}
 
+void GCode::process_layers(FILE *file, const Print &print, size_t num_layers, const std::function<LayerResult(size_t)> &generate_layer,
+    const std::function<void(size_t, size_t)> &prepare_layers)
+{
+    // The layers are prepared in parallel in windows of a few layers ahead of their generation, which bounds the memory of the prepared data.
+    const size_t prepare_window = 2 * size_t(tbb::task_scheduler_init::default_num_threads());
+    auto prepare = [num_layers, prepare_window, &prepare_layers](size_t layer_idx) {
+        if (layer_idx % prepare_window == 0)
+            prepare_layers(layer_idx, std::min(num_layers, layer_idx + prepare_window));
+    };
 
-    std::chrono::time_point<std::chrono::system_clock> end_export_layer = std::chrono::system_clock::now();
-    if ((static_cast<std::chrono::duration<double>>(end_export_layer - m_last_status_update)).count() > 0.2) {
-        m_last_status_update = std::chrono::system_clock::now();
-        print.set_status(int((layer.id() * 100) / layer_count()), std::string(L("Generating G-code layer %s / %s")), std::vector<std::string>{ std::to_string(layer.id()), std::to_string(layer_count()) }, PrintBase::SlicingStatus::DEFAULT);
+    // The cooling buffer and the fan mover emit their fan commands through m_writer, using its active tool for the fan offset.
+    // The wipe tower reads the fan speed back when generating the next layer, and a tool change or milling swaps the active tool
+    // in the middle of a layer. In these cases the next layer can't be generated while the previous one is being post-processed.
+    bool milling   = ! print.config().milling_diameter.values.empty() &&
+        std::any_of(print.regions().begin(), print.regions().end(), [](const PrintRegion *region) { return region->config().milling_post_process.value; });
+    bool pipelined = print.config().gcode_export_pipelined.value && ! m_wipe_tower && ! milling && print.extruders().size() <= 1;
+    if (! pipelined) {
+        for (size_t layer_idx = 0; layer_idx < num_layers; ++ layer_idx) {
+            prepare(layer_idx);
+            this->process_layer_postprocess(file, generate_layer(layer_idx));
+            print.throw_if_canceled();
+        }
+        return;
     }
+
+    // The layers are generated by a serial stage, as process_layer() moves the writer, the seam placer and the avoid crossing
+    // perimeters state from one layer to the next. The stateful post-processing filters then consume the layers strictly in order,
+    // therefore the output is identical to the one of the loop above.
+    // The number of layers in flight is bounded to limit the memory held by the generated G-code.
+    size_t layer_idx = 0;
+    tbb::parallel_pipeline(4,
+        tbb::make_filter<void, LayerResult>(tbb::filter::serial_in_order,
+            [&print, &layer_idx, num_layers, &generate_layer, &prepare](tbb::flow_control &fc) -> LayerResult {
+                if (layer_idx == num_layers) {
+                    fc.stop();
+                    return LayerResult();
+                }
+                print.throw_if_canceled();
+                prepare(layer_idx);
+                return generate_layer(layer_idx ++);
+            }) &
+        tbb::make_filter<LayerResult, void>(tbb::filter::serial_in_order,
+            [this, file](LayerResult layer) {
+                this->process_layer_postprocess(file, std::move(layer));
+            }));
+    print.throw_if_canceled();
 }
 
 void GCode::apply_print_config(const PrintConfig &print_config)
@@ -2827,6 +3059,38 @@ std::string GCode::change_layer(coordf_t print_z)
 
 
 
+// Distance field over the slices of the layer below, used by the seam placer to penalize the overhangs.
+static std::unique_ptr<EdgeGrid::Grid> create_lower_layer_edge_grid(const Layer &layer)
+{
+    assert(layer.lower_layer != nullptr);
+    const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
+    auto grid = make_unique<EdgeGrid::Grid>();
+    grid->create(layer.lower_layer->lslices, distance_field_resolution);
+    grid->calculate_sdf();
+    return grid;
+}
+
+void GCode::prepare_lower_layer_edge_grids(const Print &print, const std::vector<const Layer*> &layers)
+{
+    m_lower_layer_edge_grids.clear();
+    // The seam of a spiral vase is not placed by the seam placer.
+    if (print.config().spiral_vase)
+        return;
+    std::vector<const Layer*> layers_with_loops;
+    for (const Layer *layer : layers)
+        if (layer->lower_layer != nullptr && 
+            std::any_of(layer->regions().begin(), layer->regions().end(), [](const LayerRegion *layerm) { return ! layerm->perimeters.entities.empty(); }))
+            layers_with_loops.emplace_back(layer);
+    std::vector<std::unique_ptr<EdgeGrid::Grid>> grids(layers_with_loops.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers_with_loops.size(), 1),
+        [&layers_with_loops, &grids](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                grids[i] = create_lower_layer_edge_grid(*layers_with_loops[i]);
+        });
+    for (size_t i = 0; i < layers_with_loops.size(); ++ i)
+        m_lower_layer_edge_grids.emplace(layers_with_loops[i], std::move(grids[i]));
+}
+
 //like extrude_loop but with varying z and two full round
 std::string GCode::extrude_loop_vase(const ExtrusionLoop &original_loop, const std::string &description, double speed, std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid)
 {
@@ -2839,10 +3103,7 @@ std::string GCode::extrude_loop_vase(const ExtrusionLoop &original_loop, const s
     if (m_layer->lower_layer != nullptr && lower_layer_edge_grid != nullptr) {
         if (!*lower_layer_edge_grid) {
             // Create the distance field for a layer below.
-            const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
-            *lower_layer_edge_grid = make_unique<EdgeGrid::Grid>();
-            (*lower_layer_edge_grid)->create(m_layer->lower_layer->lslices, distance_field_resolution);
-            (*lower_layer_edge_grid)->calculate_sdf();
+            *lower_layer_edge_grid = create_lower_layer_edge_grid(*m_layer);
 #if 0
             {
                 static int iRun = 0;
@@ -3150,10 +3411,7 @@ std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::s
     if (m_layer->lower_layer != nullptr && lower_layer_edge_grid != nullptr) {
         if (! *lower_layer_edge_grid) {
             // Create the distance field for a layer below.
-            const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
-            *lower_layer_edge_grid = make_unique<EdgeGrid::Grid>();
-            (*lower_layer_edge_grid)->create(m_layer->lower_layer->lslices, distance_field_resolution);
-            (*lower_layer_edge_grid)->calculate_sdf();
+            *lower_layer_edge_grid = create_lower_layer_edge_grid(*m_layer);
             #if 0
             {
                 static int iRun = 0;
@@ -3373,10 +3631,7 @@ void GCode::use(const ExtrusionEntityCollection &collection) {
             next_entity->visit(*this);
         }
     } else {
-        ExtrusionEntityCollection chained = collection.chained_path_from(m_last_pos);
-        for (const ExtrusionEntity* next_entity : chained.entities) {
-            next_entity->visit(*this);
-        }
+        extrude_chained(filter_by_extrusion_role(collection.entities, collection.role()), m_last_pos, [this](const ExtrusionEntity &next_entity) { next_entity.visit(*this); });
     }
 }
 
@@ -3494,11 +3749,7 @@ std::string GCode::extrude_infill(const Print& print, const std::vector<ObjectBy
                     gcode += m_writer.set_temperature(m_config.first_layer_temperature.get_at(m_writer.tool()->id()), false, m_writer.tool()->id());
             else if (m_config.temperature.get_at(m_writer.tool()->id()) > 0) // don't set it if disabled
                 gcode += m_writer.set_temperature(m_config.temperature.get_at(m_writer.tool()->id()), false, m_writer.tool()->id());
-            ExtrusionEntitiesPtr extrusions{ region.infills };
-            chain_and_reorder_extrusion_entities(extrusions, &m_last_pos);
-            for (const ExtrusionEntity* fill : extrusions) {
-                gcode += extrude_entity(*fill, "");
-            }
+            extrude_chained(region.infills, m_last_pos, [this, &gcode](const ExtrusionEntity &fill) { gcode += extrude_entity(fill, ""); });
         }
     }
     return gcode;
@@ -3518,46 +3769,33 @@ std::string GCode::extrude_ironing(const Print& print, const std::vector<ObjectB
                     gcode += m_writer.set_temperature(m_config.first_layer_temperature.get_at(m_writer.tool()->id()), false, m_writer.tool()->id());
             else if (m_config.temperature.get_at(m_writer.tool()->id()) > 0)
                 gcode += m_writer.set_temperature(m_config.temperature.get_at(m_writer.tool()->id()), false, m_writer.tool()->id());
-            ExtrusionEntitiesPtr extrusions{ region.ironings };
-            chain_and_reorder_extrusion_entities(extrusions, &m_last_pos);
-            for (const ExtrusionEntity* fill : extrusions) {
-                gcode += extrude_entity(*fill, "");
-            }
+            extrude_chained(region.ironings, m_last_pos, [this, &gcode](const ExtrusionEntity &fill) { gcode += extrude_entity(fill, ""); });
         }
     }
     return gcode;
 }
 
-std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fills)
+std::string GCode::extrude_support(const ExtrusionEntity &support_fill)
 {
-    std::string gcode;
-    if (! support_fills.entities.empty()) {
-        const char   *support_label            = "support material";
-        const char   *support_interface_label  = "support material interface";
-        const double  support_speed            = m_config.support_material_speed.value;
-        const double  support_interface_speed  = m_config.support_material_interface_speed.get_abs_value(support_speed);
-        for (const ExtrusionEntity *ee : support_fills.entities) {
-            ExtrusionRole role = ee->role();
-            assert(role == erSupportMaterial || role == erSupportMaterialInterface || role == erMixed);
-            if (const ExtrusionEntityCollection* coll = dynamic_cast<const ExtrusionEntityCollection*>(ee)) {
-                gcode += extrude_support(*coll);
-                continue;
-            }
-            const char  *label = (role == erSupportMaterial) ? support_label : support_interface_label;
-            const double speed = (role == erSupportMaterial) ? support_speed : support_interface_speed;
-            visitor_gcode = "";
-            visitor_comment = label;
-            visitor_speed = speed;
-            visitor_lower_layer_edge_grid = nullptr;
-            ee->visit(*this); // will call extrude_thing()
-            gcode += visitor_gcode;
-        }
+    if (const ExtrusionEntityCollection* coll = dynamic_cast<const ExtrusionEntityCollection*>(&support_fill)) {
+        std::string gcode;
+        for (const ExtrusionEntity *ee : coll->entities)
+            gcode += extrude_support(*ee);
+        return gcode;
     }
-    return gcode;
+    ExtrusionRole role = support_fill.role();
+    assert(role == erSupportMaterial || role == erSupportMaterialInterface || role == erMixed);
+    const double support_speed = m_config.support_material_speed.value;
+    visitor_gcode = "";
+    visitor_comment = (role == erSupportMaterial) ? "support material" : "support material interface";
+    visitor_speed = (role == erSupportMaterial) ? support_speed : m_config.support_material_interface_speed.get_abs_value(support_speed);
+    visitor_lower_layer_edge_grid = nullptr;
+    support_fill.visit(*this); // will call extrude_thing()
+    return visitor_gcode;
 }
 
 
-void GCode::_post_process(std::string& what, bool flush) {
+const std::string& GCode::_post_process(const std::string& what, bool flush) {
 
     //if enabled, move the fan startup earlier.
     if (this->config().fan_speedup_time.value != 0 || this->config().fan_kickstart.value > 0) {
@@ -3569,22 +3807,19 @@ void GCode::_post_process(std::string& what, bool flush) {
                 this->config().use_relative_e_distances.value,
                 this->config().fan_speedup_overhangs.value,
                 (float)this->config().fan_kickstart.value));
-        what = this->m_fan_mover->process_gcode(what, flush);
+        return this->m_fan_mover->process_gcode(what, flush);
     }
-
+    return what;
 }
 
-void GCode::_write(FILE* file, const char *what, bool flush /*=false*/)
+void GCode::_write(FILE* file, const std::string& what, bool flush /*=false*/)
 {
-    if (what != nullptr) {
-        
-        //const char * gcode_pp = _post_process(what).c_str();
-        std::string str_preproc{ what };
-        _post_process(str_preproc, flush);
-        const char* gcode = str_preproc.c_str();
-        // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), file);
-    }
+    // Without post-processing, the fragment is written as it is, no copy.
+    const std::string &gcode = _post_process(what, flush);
+    // writes string to file
+    fwrite(gcode.data(), 1, gcode.size(), file);
+    // and process it
+    m_processor.process_buffer(gcode);
 }
 
 void GCode::_writeln(FILE* file, const std::string &what)
@@ -3640,6 +3875,41 @@ std::vector<double> cut_corner_cache = {
     0.252510726678311,0.262777267777188,0.27352986689699,0.284799648665007,0.296620441746888,0.309029079319231,0.322065740515038,0.335774339512048,0.350202970204428,0.365404415947691,
     0.381436735764648,0.398363940736199,0.416256777189962,0.435193636891737,0.455261618934834 };
 
+// Extrudes along the points, with G2 / G3 arcs where they lie on a circle.
+std::string GCode::_extrude_arcs(const Points &path_points, double e_per_mm, const std::string &comment)
+{
+    // arcs of a smaller radius are better left to the polyline, larger ones are no better than a line.
+    static constexpr double ARC_FITTING_MIN_RADIUS = 0.5;
+    static constexpr double ARC_FITTING_MAX_RADIUS = 1000.;
+    Points points;
+    points.reserve(path_points.size());
+    for (const Point &pt : path_points)
+        if (points.empty() || pt != points.back())
+            points.push_back(pt);
+    std::string gcode;
+    size_t      start = 0;
+    for (const ArcFitting::Move &move : ArcFitting::fit(points, scale_d(m_config.arc_fitting_tolerance.value),
+            scale_d(ARC_FITTING_MIN_RADIUS), scale_d(ARC_FITTING_MAX_RADIUS))) {
+        const Point &end = points[move.end];
+        if (move.is_arc) {
+            const Vec2d start_pt = points[start].cast<double>();
+            gcode += m_writer.extrude_arc_to_xy(
+                this->point_to_gcode(end),
+                (move.center - start_pt) * SCALING_FACTOR,
+                e_per_mm * unscaled(ArcFitting::arc_length(start_pt, end.cast<double>(), move.center, move.ccw)),
+                move.ccw,
+                comment);
+        } else {
+            gcode += m_writer.extrude_to_xy(
+                this->point_to_gcode(end),
+                e_per_mm * unscaled(points[start].distance_to(end)),
+                comment);
+        }
+        start = move.end;
+    }
+    return gcode;
+}
+
 std::string GCode::_extrude(const ExtrusionPath &path, const std::string &description, double speed) {
 
     std::string descr = description.empty() ? ExtrusionEntity::role_to_string(path.role()) : description;
@@ -3657,12 +3927,17 @@ std::string GCode::_extrude(const ExtrusionPath &path, const std::string &descri
             std::string comment = m_config.gcode_comments ? descr : "";
             if (path.role() != erExternalPerimeter || config().external_perimeter_cut_corners.value == 0) {
                 // normal & legacy pathcode
-                for (const Line& line : path.polyline.lines()) {
-                    if (line.a == line.b) continue; //todo: investigate if it happens (it happens in perimeters)
-                    gcode += m_writer.extrude_to_xy(
-                        this->point_to_gcode(line.b),
-                        e_per_mm * unscaled(line.length()),
-                        comment);
+                if (m_writer.use_arc_fitting() && ! m_spiral_vase) {
+                    // the spiral vase only ramps the z of the G1 moves
+                    gcode += this->_extrude_arcs(path.polyline.points, e_per_mm, comment);
+                } else {
+                    for (const Line& line : path.polyline.lines()) {
+                        if (line.a == line.b) continue; //todo: investigate if it happens (it happens in perimeters)
+                        gcode += m_writer.extrude_to_xy(
+                            this->point_to_gcode(line.b),
+                            e_per_mm * unscaled(line.length()),
+                            comment);
+                    }
                 }
             } else {
                 // external_perimeter_cut_corners pathcode
@@ -4407,14 +4682,12 @@ void GCode::ObjectByExtruder::Island::Region::append(const Type type, const Extr
     }
 
     // First we append the entities, there are eec->entities.size() of them:
-    //don't do fill->entities because it will discard no_sort, we must use flatten(preserve_ordering = true)
-    // this method will encapsulate every no_sort into an other collection, so we can get the entities directly.
-    ExtrusionEntitiesPtr entities = eec->flatten(true).entities;
+    //don't do fill->entities because it will discard no_sort, we must flatten with preserve_ordering = true
+    // this method will keep every no_sort collection as a single entity, so we can get the entities directly.
+    // The entities are referenced, not cloned: they stay owned by the LayerRegion.
     size_t old_size = perimeters_or_infills->size();
-    size_t new_size = old_size + entities.size();
-    perimeters_or_infills->reserve(new_size);
-    for (auto* ee : entities)
-        perimeters_or_infills->emplace_back(ee);
+    eec->flatten_references(*perimeters_or_infills, true);
+    size_t new_size = perimeters_or_infills->size();
 
     if (copies_extruder != nullptr) {
     	// Don't reallocate overrides if not needed.
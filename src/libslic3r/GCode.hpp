@@ -22,8 +22,10 @@
 
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <chrono>
+#include <functional>
 
 #ifdef HAS_PRESSURE_EQUALIZER
 #include "GCode/PressureEqualizer.hpp"
@@ -205,9 +207,17 @@ private:
 
     static std::vector<LayerToPrint>        		                   collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
-    void            process_layer(
-        // Write into the output file.
-        FILE                            *file,
+    // G-code of a single layer produced by process_layer(), before the cooling buffer and the other
+    // stateful post-processing filters are applied.
+    struct LayerResult {
+        std::string gcode;
+        size_t      layer_id     = 0;
+        // Only support material is extruded at this layer, the cooling buffer appends its time to the next layer.
+        bool        support_only = false;
+        // Nothing to extrude at this layer, the post-processing is skipped.
+        bool        is_nop       = true;
+    };
+    LayerResult     process_layer(
         const Print                     &print,
         PrintStatistics                 &print_stat,
         // Set of object & print layers of the same PrintObject and with the same print_z.
@@ -219,6 +229,17 @@ private:
         // Otherwise print a single copy of a single object.
         size_t                     single_object_idx = size_t(-1)
         );
+    // Apply the cooling buffer and the pressure equalizer to a layer produced by process_layer(), then write it into the output file.
+    void            process_layer_postprocess(FILE *file, LayerResult &&layer);
+    // Call process_layer() through generate_layer for num_layers layers and post-process them in their order.
+    // If gcode_export_pipelined is enabled and the tool state doesn't interleave between the layer generation
+    // and the post-processing, the next layers are generated while the previous ones are being post-processed.
+    // Before the layers are generated, prepare_layers(first, last) is called for windows of the upcoming layers [first, last).
+    void            process_layers(FILE *file, const Print &print, size_t num_layers, const std::function<LayerResult(size_t)> &generate_layer,
+                        const std::function<void(size_t, size_t)> &prepare_layers);
+    // Create the distance fields of the layers below the object layers in parallel, process_layer() then picks them up
+    // instead of creating them on the export thread.
+    void            prepare_lower_layer_edge_grids(const Print &print, const std::vector<const Layer*> &layers);
 
     void            set_last_pos(const Point &pos) { m_last_pos = pos; m_last_pos_defined = true; }
     bool            last_pos_defined() const { return m_last_pos_defined; }
@@ -314,7 +335,7 @@ private:
     std::string     extrude_perimeters(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::unique_ptr<EdgeGrid::Grid> &lower_layer_edge_grid);
     std::string     extrude_infill(const Print& print, const std::vector<ObjectByExtruder::Island::Region>& by_region, bool is_infill_first);
     std::string     extrude_ironing(const Print& print, const std::vector<ObjectByExtruder::Island::Region>& by_region);
-    std::string     extrude_support(const ExtrusionEntityCollection &support_fills);
+    std::string     extrude_support(const ExtrusionEntity &support_fill);
 
     Polyline        travel_to(std::string& gcode, const Point &point, ExtrusionRole role);
     void            write_travel_to(std::string& gcode, const Polyline& travel, std::string comment);
@@ -338,9 +359,13 @@ private:
     PlaceholderParser::ContextData      m_placeholder_parser_context;
     // Collection of templates, on which the placeholder substitution failed.
     std::map<std::string, std::string>  m_placeholder_parser_failed_templates;
+    // Templates compiled by placeholder_parser_process(), keyed by their text, as the custom G-codes are filled in at each layer or toolchange.
+    std::unordered_map<std::string, PlaceholderParser::CompiledTemplate> m_placeholder_parser_compiled_templates;
     OozePrevention                      m_ooze_prevention;
     Wipe                                m_wipe;
     AvoidCrossingPerimeters             m_avoid_crossing_perimeters;
+    // Distance fields over the layers below the object layers, prepared for the seam placement of the next few layers.
+    std::unordered_map<const Layer*, std::unique_ptr<EdgeGrid::Grid>> m_lower_layer_edge_grids;
     bool                                m_enable_loop_clipping;
     // If enabled, the G-code generator will put following comments at the ends
     // of the G-code lines: _EXTRUDE_SET_SPEED, _WIPE, _BRIDGE_FAN_START, _BRIDGE_FAN_END, _BRIDGE_INTERNAL_FAN_START, _BRIDGE_INTERNAL_FAN_END
@@ -417,8 +442,8 @@ private:
     GCodeProcessor m_processor;
 
     // Write a string into a file.
-    void _write(FILE* file, const std::string& what, bool flush = false) { this->_write(file, what.c_str(), flush); }
-    void _write(FILE* file, const char *what, bool flush = false);
+    void _write(FILE* file, const std::string& what, bool flush = false);
+    void _write(FILE* file, const char *what, bool flush = false) { if (what != nullptr) this->_write(file, std::string(what), flush); }
 
     // Write a string into a file. 
     // Add a newline, if the string does not end with a newline already.
@@ -430,9 +455,11 @@ private:
 
     //some post-processing on the file, with their data class
     std::unique_ptr<FanMover> m_fan_mover;
-    void _post_process(std::string& what, bool flush = true);
+    // Returns what if there is no post-processing to do, otherwise the output of the post-processor, valid until its next call.
+    const std::string& _post_process(const std::string& what, bool flush = true);
 
     std::string _extrude(const ExtrusionPath &path, const std::string &description, double speed = -1);
+    std::string _extrude_arcs(const Points &points, double e_per_mm, const std::string &comment);
     std::string _before_extrude(const ExtrusionPath &path, const std::string &description, double speed = -1);
     double_t    _compute_speed_mm_per_sec(const ExtrusionPath& path, double speed = -1);
     std::string _after_extrude(const ExtrusionPath &path);
@@ -0,0 +1,111 @@
+#include "ArcFitting.hpp"
+
+#include <cmath>
+
+namespace Slic3r {
+
+namespace ArcFitting {
+
+// An arc sweeping close to a full circle could be taken by the firmware for a tiny arc once its end points are rounded.
+static constexpr double MAX_SWEEP = 2. * PI - 0.1;
+
+struct Circle {
+    Vec2d   center;
+    double  radius;
+    bool    ccw;
+};
+
+// Circle passing through the three points, false if they are collinear.
+static bool circle_through(const Vec2d &a, const Vec2d &b, const Vec2d &c, Circle &out)
+{
+    const Vec2d  ab = b - a;
+    const Vec2d  ac = c - a;
+    const double d  = 2. * (ab.x() * ac.y() - ab.y() * ac.x());
+    if (d == 0.)
+        return false;
+    const double ab2 = ab.squaredNorm();
+    const double ac2 = ac.squaredNorm();
+    const Vec2d  u((ac.y() * ab2 - ab.y() * ac2) / d, (ab.x() * ac2 - ac.x() * ab2) / d);
+    out.center = a + u;
+    out.radius = u.norm();
+    // a, b, c turning left means a counter-clockwise arc.
+    out.ccw    = d > 0.;
+    return true;
+}
+
+// Are the points first..last approximated by the arc of the circle within tolerance?
+// The first and the last point are on the circle already.
+static bool arc_fits(const std::vector<Vec2d> &pts, size_t first, size_t last, const Circle &circle, double tolerance)
+{
+    double sweep = 0.;
+    for (size_t k = first; k < last; ++ k) {
+        const Vec2d  p  = pts[k]     - circle.center;
+        const Vec2d  q  = pts[k + 1] - circle.center;
+        const double cr = p.x() * q.y() - p.y() * q.x();
+        // The points shall progress around the center in the direction of the arc.
+        if (circle.ccw ? cr <= 0. : cr >= 0.)
+            return false;
+        sweep += std::atan2(std::abs(cr), p.dot(q));
+        if (sweep > MAX_SWEEP)
+            return false;
+        if (k > first && std::abs(p.norm() - circle.radius) > tolerance)
+            return false;
+        // Deviation of the segment from the arc, largest at its midpoint.
+        if (std::abs((0.5 * (p + q)).norm() - circle.radius) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+std::vector<Move> fit(const Points &points, double tolerance, double min_radius, double max_radius)
+{
+    std::vector<Move> out;
+    if (points.size() < 2)
+        return out;
+    std::vector<Vec2d> pts;
+    pts.reserve(points.size());
+    for (const Point &pt : points)
+        pts.emplace_back(pt.cast<double>());
+
+    for (size_t i = 0; i + 1 < pts.size();) {
+        size_t end = i + 1;
+        Circle best;
+        // Extend the arc starting at i for as long as the points fit a circle.
+        for (size_t j = i + 2; j < pts.size(); ++ j) {
+            Circle circle;
+            if (! circle_through(pts[i], pts[(i + j) / 2], pts[j], circle) ||
+                circle.radius < min_radius || circle.radius > max_radius ||
+                ! arc_fits(pts, i, j, circle, tolerance))
+                break;
+            end  = j;
+            best = circle;
+        }
+        Move move;
+        move.end = end;
+        if (end > i + 1) {
+            move.is_arc = true;
+            move.center = best.center;
+            move.ccw    = best.ccw;
+        }
+        out.emplace_back(move);
+        i = end;
+    }
+    return out;
+}
+
+double arc_length(const Vec2d &start, const Vec2d &end, const Vec2d &center, bool ccw)
+{
+    const Vec2d s = start - center;
+    const Vec2d e = end   - center;
+    double angle = std::atan2(e.y(), e.x()) - std::atan2(s.y(), s.x());
+    if (ccw) {
+        if (angle < 0.)
+            angle += 2. * PI;
+    } else if (angle > 0.)
+        angle -= 2. * PI;
+    return std::abs(angle) * s.norm();
+}
+
+} // namespace ArcFitting
+
+} // namespace Slic3r
@@ -0,0 +1,36 @@
+#ifndef slic3r_ArcFitting_hpp_
+#define slic3r_ArcFitting_hpp_
+
+#include "../libslic3r.h"
+#include "../Point.hpp"
+
+#include <vector>
+
+namespace Slic3r {
+
+namespace ArcFitting {
+
+// A piece of a polyline replaced by a single move: a straight line or a circular arc ending at the point end of the polyline.
+// The piece starts at the end point of the previous one, or at the first point of the polyline.
+struct Move {
+    size_t  end;
+    bool    is_arc  { false };
+    // Only valid for arcs, in scaled coordinates.
+    Vec2d   center  { Vec2d::Zero() };
+    bool    ccw     { false };
+};
+
+// Greedily replaces the runs of at least three consecutive points of the polyline lying on a circle by arcs.
+// All the points and the midpoints of the segments of a run are closer to the arc than tolerance,
+// the radius of the arc is in <min_radius, max_radius>. All the values are scaled.
+// The consecutive points shall be different.
+std::vector<Move> fit(const Points &points, double tolerance, double min_radius, double max_radius);
+
+// Length of the arc from start to end around center, counter-clockwise if ccw.
+double arc_length(const Vec2d &start, const Vec2d &end, const Vec2d &center, bool ccw);
+
+} // namespace ArcFitting
+
+} // namespace Slic3r
+
+#endif // slic3r_ArcFitting_hpp_
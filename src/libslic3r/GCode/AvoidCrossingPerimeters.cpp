@@ -12,6 +12,11 @@
 #include <numeric>
 #include <unordered_set>
 
+#include <boost/functional/hash.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
 namespace Slic3r {
 
 struct TravelPoint
@@ -392,13 +397,27 @@ static size_t avoid_perimeters(const AvoidCrossingPerimeters::Boundary &boundary
     return num_intersections;
 }
 
+// ExPolygon::contains() of the idx-th ExPolygon. The travels of a layer query the same lslices over and over,
+// thus the ExPolygons with many points are indexed on their first query.
+static bool expolygon_contains(const ExPolygons &ex_polygons, std::vector<ExPolygonContainsIndex> &contains_index, size_t idx, const Point &point)
+{
+    const ExPolygon &ex_polygon = ex_polygons[idx];
+    if (ex_polygon.contour.points.size() < 64)
+        return ex_polygon.contains(point);
+    if (contains_index.size() != ex_polygons.size())
+        contains_index.assign(ex_polygons.size(), ExPolygonContainsIndex());
+    if (contains_index[idx].empty())
+        contains_index[idx].create(ex_polygon);
+    return contains_index[idx].contains(point);
+}
+
 // Check if anyone of ExPolygons contains whole travel.
 // called by need_wipe() and AvoidCrossingPerimeters::travel_to()
-// FIXME Lukas H.: Maybe similar approach could also be used for ExPolygon::contains()
-static bool any_expolygon_contains(const ExPolygons               &ex_polygons,
-                                   const std::vector<BoundingBox> &ex_polygons_bboxes,
-                                   const EdgeGrid::Grid            &grid_lslice,
-                                   const Line                      &travel)
+static bool any_expolygon_contains(const ExPolygons                     &ex_polygons,
+                                   const std::vector<BoundingBox>       &ex_polygons_bboxes,
+                                   std::vector<ExPolygonContainsIndex>  &contains_index,
+                                   const EdgeGrid::Grid                 &grid_lslice,
+                                   const Line                           &travel)
 {
     assert(ex_polygons.size() == ex_polygons_bboxes.size());
     if(!grid_lslice.bbox().contains(travel.a) || !grid_lslice.bbox().contains(travel.b))
@@ -411,7 +430,7 @@ static bool any_expolygon_contains(const ExPolygons               &ex_polygons,
     if (!visitor.intersect) {
         for (const ExPolygon &ex_polygon : ex_polygons) {
             const BoundingBox &bbox = ex_polygons_bboxes[&ex_polygon - &ex_polygons.front()];
-            if (bbox.contains(travel.a) && bbox.contains(travel.b) && ex_polygon.contains(travel.a))
+            if (bbox.contains(travel.a) && bbox.contains(travel.b) && expolygon_contains(ex_polygons, contains_index, &ex_polygon - &ex_polygons.front(), travel.a))
                 return true;
         }
     }
@@ -420,7 +439,8 @@ static bool any_expolygon_contains(const ExPolygons               &ex_polygons,
 
 // Check if anyone of ExPolygons contains whole travel.
 // called by need_wipe()
-static bool any_expolygon_contains(const ExPolygons &ex_polygons, const std::vector<BoundingBox> &ex_polygons_bboxes, const EdgeGrid::Grid &grid_lslice, const Polyline &travel)
+static bool any_expolygon_contains(const ExPolygons &ex_polygons, const std::vector<BoundingBox> &ex_polygons_bboxes, std::vector<ExPolygonContainsIndex> &contains_index,
+                                   const EdgeGrid::Grid &grid_lslice, const Polyline &travel)
 {
     assert(ex_polygons.size() == ex_polygons_bboxes.size());
     if(std::any_of(travel.points.begin(), travel.points.end(), [&grid_lslice](const Point &point) { return !grid_lslice.bbox().contains(point); }))
@@ -440,18 +460,19 @@ static bool any_expolygon_contains(const ExPolygons &ex_polygons, const std::vec
         for (const ExPolygon &ex_polygon : ex_polygons) {
             const BoundingBox &bbox = ex_polygons_bboxes[&ex_polygon - &ex_polygons.front()];
             if (std::all_of(travel.points.begin(), travel.points.end(), [&bbox](const Point &point) { return bbox.contains(point); }) &&
-                ex_polygon.contains(travel.points.front()))
+                expolygon_contains(ex_polygons, contains_index, &ex_polygon - &ex_polygons.front(), travel.points.front()))
                 return true;
         }
     }
     return false;
 }
 
-static bool need_wipe(const GCode          &gcodegen,
-                      const EdgeGrid::Grid &grid_lslice,
-                      const Line           &original_travel,
-                      const Polyline       &result_travel,
-                      const size_t          intersection_count)
+static bool need_wipe(const GCode                          &gcodegen,
+                      std::vector<ExPolygonContainsIndex>  &lslices_contains,
+                      const EdgeGrid::Grid                 &grid_lslice,
+                      const Line                           &original_travel,
+                      const Polyline                       &result_travel,
+                      const size_t                          intersection_count)
 {
     const ExPolygons               &lslices        = gcodegen.layer()->lslices;
     const std::vector<BoundingBox> &lslices_bboxes = gcodegen.layer()->lslices_bboxes;
@@ -464,16 +485,16 @@ static bool need_wipe(const GCode          &gcodegen,
         // The original layer is intersected with defined boundaries. Then it is necessary to make a detailed test.
         // If the z-lift is enabled, then a wipe is needed when the original travel leads above the holes.
         if (z_lift_enabled) {
-            if (any_expolygon_contains(lslices, lslices_bboxes, grid_lslice, original_travel)) {
+            if (any_expolygon_contains(lslices, lslices_bboxes, lslices_contains, grid_lslice, original_travel)) {
                 // Check if original_travel and result_travel are not same.
                 // If both are the same, then it is possible to skip testing of result_travel
                 wipe_needed = !(result_travel.size() > 2 && result_travel.first_point() == original_travel.a && result_travel.last_point() == original_travel.b) &&
-                              !any_expolygon_contains(lslices, lslices_bboxes, grid_lslice, result_travel);
+                              !any_expolygon_contains(lslices, lslices_bboxes, lslices_contains, grid_lslice, result_travel);
             } else {
                 wipe_needed = true;
             }
         } else {
-            wipe_needed = !any_expolygon_contains(lslices, lslices_bboxes, grid_lslice, result_travel);
+            wipe_needed = !any_expolygon_contains(lslices, lslices_bboxes, lslices_contains, grid_lslice, result_travel);
         }
     }
 
@@ -884,6 +905,14 @@ static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons
 {
     boundary->clear();
     boundary->boundaries = std::move(boundary_polygons);
+    boundary->hash       = boundary->boundaries.size();
+    for (const Polygon &polygon : boundary->boundaries) {
+        boost::hash_combine(boundary->hash, polygon.points.size());
+        for (const Point &pt : polygon.points) {
+            boost::hash_combine(boundary->hash, pt.x());
+            boost::hash_combine(boundary->hash, pt.y());
+        }
+    }
 
     BoundingBox bbox(get_extents(boundary->boundaries));
     bbox.offset(SCALED_EPSILON);
@@ -894,6 +923,39 @@ static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons
     init_boundary_distances(boundary);
 }
 
+size_t AvoidCrossingPerimeters::RouteCache::KeyHash::operator()(const Key &key) const
+{
+    return boost::hash_range(key.begin(), key.end());
+}
+
+// Travels starting and ending this close are routed the same way.
+static constexpr coord_t ROUTE_CACHE_QUANTUM     = coord_t(0.001 / SCALING_FACTOR);
+// Limit of the routes cached per boundary, the cache is cleared once the limit is reached.
+static constexpr size_t  ROUTE_CACHE_MAX_ROUTES  = 100000;
+
+// Plan a travel around the boundary, or reuse the same travel planned before around a boundary of the same shape.
+static size_t avoid_perimeters_cached(const AvoidCrossingPerimeters::Boundary &boundary,
+                                      AvoidCrossingPerimeters::RouteCache     &cache,
+                                      const Point                             &start,
+                                      const Point                             &end,
+                                      Polyline                                &result_out)
+{
+    if (cache.boundary_hash != boundary.hash) {
+        cache.routes.clear();
+        cache.boundary_hash = boundary.hash;
+    } else if (cache.routes.size() >= ROUTE_CACHE_MAX_ROUTES)
+        cache.routes.clear();
+    auto quantize = [](coord_t v) { return coord_t(std::floor(double(v) / double(ROUTE_CACHE_QUANTUM) + 0.5)); };
+    AvoidCrossingPerimeters::RouteCache::Key key { quantize(start.x()), quantize(start.y()), quantize(end.x()), quantize(end.y()) };
+    if (auto it = cache.routes.find(key); it != cache.routes.end()) {
+        result_out = it->second.polyline;
+        return it->second.num_intersections;
+    }
+    size_t num_intersections = avoid_perimeters(boundary, start, end, result_out);
+    cache.routes.insert({ key, { result_out, num_intersections } });
+    return num_intersections;
+}
+
 // Plan travel, which avoids perimeter crossings by following the boundaries of the layer.
 Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &point, bool *could_be_wipe_disabled)
 {
@@ -913,14 +975,14 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     const ExPolygons               &lslices          = gcodegen.layer()->lslices;
     const std::vector<BoundingBox> &lslices_bboxes   = gcodegen.layer()->lslices_bboxes;
     bool                            is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!lslices.empty() && !any_expolygon_contains(lslices, lslices_bboxes, m_grid_lslice, travel)))) {
+    if (!use_external && (is_support_layer || (!lslices.empty() && !any_expolygon_contains(lslices, lslices_bboxes, m_lslices_contains, m_grid_lslice, travel)))) {
         // Initialize m_internal only when it is necessary.
         if (m_internal.boundaries.empty())
             init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
 
         // Trim the travel line by the bounding box.
         if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), result_pl);
+            travel_intersection_count = avoid_perimeters_cached(m_internal, m_internal_routes, startf.cast<coord_t>(), endf.cast<coord_t>(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -931,7 +993,7 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
 
         // Trim the travel line by the bounding box.
         if (!m_external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_external.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_external, startf.cast<coord_t>(), endf.cast<coord_t>(), result_pl);
+            travel_intersection_count = avoid_perimeters_cached(m_external, m_external_routes, startf.cast<coord_t>(), endf.cast<coord_t>(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -963,27 +1025,95 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_grid_lslice, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_contains, m_grid_lslice, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static void init_grid_lslice(EdgeGrid::Grid &grid, const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslice.set_bbox(bbox_slice);
+    grid.set_bbox(bbox_slice);
     //FIXME 1mm grid?
-    m_grid_lslice.create(layer.lslices, coord_t(scale_(1.)));
+    grid.create(layer.lslices, coord_t(scale_(1.)));
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    if (m_init && m_layer == &layer)
+        // Another instance of the same object, the boundaries and the routes planned in the object coordinates are still valid.
+        return;
+    m_layer = &layer;
+    m_lslices_contains.clear();
+    if (auto it = m_precomputed.find(&layer); it != m_precomputed.end()) {
+        // Moving the grids together with their polygons keeps the pointers of the grids into the polygons valid.
+        m_grid_lslice = std::move(it->second.grid_lslice);
+        m_internal    = std::move(it->second.internal);
+        m_external    = std::move(it->second.external);
+        m_precomputed.erase(it);
+    } else {
+        m_internal.clear();
+        m_external.clear();
+        init_grid_lslice(m_grid_lslice, layer);
+    }
     m_init = true;
 }
 
+// Rough estimate of the memory occupied by the polygons and the grid of a boundary.
+static size_t boundary_memory_size(const Polygons &polygons, const EdgeGrid::Grid &grid)
+{
+    size_t out = grid.rows() * grid.cols() * 2 * sizeof(size_t);
+    for (const Polygon &polygon : polygons)
+        // The points and their precomputed distances.
+        out += sizeof(Polygon) + polygon.points.size() * (sizeof(Point) + 2 * sizeof(float));
+    return out;
+}
+
+AvoidCrossingPerimeters::PrecomputedLayers AvoidCrossingPerimeters::precompute_layers(const std::vector<const Layer*> &layers, size_t max_memory)
+{
+    PrecomputedLayers precomputed;
+    if (layers.empty())
+        return precomputed;
+    // The external boundaries are only needed for travels between objects or their instances.
+    size_t num_instances = 0;
+    for (const PrintObject *object : layers.front()->object()->print()->objects())
+        num_instances += object->instances().size();
+    const bool need_external = num_instances > 1;
+
+    // Process the layers in batches, so that the precomputation stops soon after the memory limit is reached.
+    const size_t batch_size  = 2 * size_t(tbb::task_scheduler_init::default_num_threads());
+    size_t       memory_used = 0;
+    std::vector<LayerBoundaries> batch;
+    for (size_t batch_begin = 0; batch_begin < layers.size() && memory_used < max_memory; batch_begin += batch_size) {
+        const size_t batch_end = std::min(layers.size(), batch_begin + batch_size);
+        batch.clear();
+        batch.resize(batch_end - batch_begin);
+        tbb::parallel_for(tbb::blocked_range<size_t>(batch_begin, batch_end, 1),
+            [&layers, &batch, batch_begin, need_external](const tbb::blocked_range<size_t> &range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    const Layer     &layer = *layers[layer_idx];
+                    LayerBoundaries &out   = batch[layer_idx - batch_begin];
+                    init_grid_lslice(out.grid_lslice, layer);
+                    init_boundary(&out.internal, to_polygons(get_boundary(layer)));
+                    if (need_external)
+                        init_boundary(&out.external, get_boundary_external(layer));
+                }
+            });
+        for (size_t layer_idx = batch_begin; layer_idx < batch_end; ++ layer_idx) {
+            LayerBoundaries &boundaries = batch[layer_idx - batch_begin];
+            memory_used += boundary_memory_size(boundaries.internal.boundaries, boundaries.internal.grid) +
+                           boundary_memory_size(boundaries.external.boundaries, boundaries.external.grid) +
+                           boundary_memory_size(Polygons(), boundaries.grid_lslice);
+            precomputed.emplace(layers[layer_idx], std::move(boundaries));
+        }
+    }
+    return precomputed;
+}
+
 #if 0
 static double travel_length(const std::vector<TravelPoint> &travel) {
     double total_length = 0;
@@ -5,6 +5,9 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <array>
+#include <unordered_map>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -24,6 +27,11 @@ public:
 
     void        init_layer(const Layer &layer);
     bool        is_init() { return m_init; }
+    // Compute the boundaries of the layers in parallel ahead of the G-code export, init_layer() then just picks them up.
+    // Layers are precomputed in their order until the precomputed data would take more than max_memory bytes,
+    // the boundaries of the remaining layers are computed on demand by init_layer() and travel_to().
+    void        init_layers(const std::vector<const Layer*> &layers, size_t max_memory) { m_precomputed = precompute_layers(layers, max_memory); }
+    void        clear_precomputed_layers() { m_precomputed.clear(); }
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
     {
@@ -42,14 +50,44 @@ public:
         std::vector<std::vector<float>> boundaries_params;
         // Used for detection of intersection between line and any polygon from boundaries
         EdgeGrid::Grid grid;
+        // Hash of the boundaries, identifies boundaries of identical shape, see RouteCache.
+        size_t hash { 0 };
 
         void clear()
         {
             boundaries.clear();
             boundaries_params.clear();
+            hash = 0;
         }
     };
 
+    // Travel routes planned around a boundary, shared by the instances of an object and by the layers with identical boundaries.
+    // The travels inside an object are planned in the coordinate system of the object, thus they repeat for each of its instances.
+    struct RouteCache {
+        struct Route {
+            Polyline    polyline;
+            size_t      num_intersections;
+        };
+        // Start and end point of the travel, quantized.
+        using Key = std::array<coord_t, 4>;
+        struct KeyHash { size_t operator()(const Key &key) const; };
+
+        // Hash of the boundary the routes were planned around.
+        size_t                                  boundary_hash { 0 };
+        std::unordered_map<Key, Route, KeyHash> routes;
+    };
+
+    struct LayerBoundaries {
+        EdgeGrid::Grid grid_lslice;
+        Boundary       internal;
+        Boundary       external;
+    };
+    using PrecomputedLayers = std::unordered_map<const Layer*, LayerBoundaries>;
+    // Computes the boundaries for init_layers(). Only reads the layers, thus it may run in the background
+    // for the next object of a sequential print while the G-code of the current object is being generated.
+    static PrecomputedLayers precompute_layers(const std::vector<const Layer*> &layers, size_t max_memory);
+    void        set_precomputed_layers(PrecomputedLayers &&precomputed) { m_precomputed = std::move(precomputed); }
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -62,10 +100,20 @@ private:
 
     // Used for detection of line or polyline is inside of any polygon.
     EdgeGrid::Grid m_grid_lslice;
+    // Point in polygon indices of the lslices of m_layer, created on demand.
+    std::vector<ExPolygonContainsIndex> m_lslices_contains;
     // Store all needed data for travels inside object
     Boundary m_internal;
     // Store all needed data for travels outside object
     Boundary m_external;
+
+    // Boundaries computed by init_layers(), consumed by init_layer().
+    PrecomputedLayers m_precomputed;
+    // Layer the boundaries above were initialized for.
+    const Layer   *m_layer { nullptr };
+
+    RouteCache     m_internal_routes;
+    RouteCache     m_external_routes;
 };
 
 } // namespace Slic3r
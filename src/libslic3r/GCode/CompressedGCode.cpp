@@ -0,0 +1,407 @@
+#include "CompressedGCode.hpp"
+
+#include "../Exception.hpp"
+#include "GCodeProcessor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+#include <boost/beast/core/detail/base64.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <miniz.h>
+
+namespace Slic3r {
+
+static constexpr char     COMPRESSED_GCODE_MAGIC[4] = { 'S', 'G', 'C', 'Z' };
+static constexpr uint32_t COMPRESSED_GCODE_VERSION  = 1;
+// Size of the text compressed into a block. The layers are usually smaller, so that a layer is read by decompressing one or two blocks.
+static constexpr size_t   COMPRESSED_GCODE_BLOCK_SIZE = size_t(1) << 20;
+// Magic, version.
+static constexpr size_t   COMPRESSED_GCODE_HEADER_SIZE  = 8;
+// Index offset, magic.
+static constexpr size_t   COMPRESSED_GCODE_TRAILER_SIZE = 12;
+
+static int seek_file(FILE *file, uint64_t offset, int origin)
+{
+#ifdef _WIN32
+    return _fseeki64(file, int64_t(offset), origin);
+#else
+    return fseeko(file, off_t(offset), origin);
+#endif
+}
+
+static uint64_t tell_file(FILE *file)
+{
+#ifdef _WIN32
+    return uint64_t(_ftelli64(file));
+#else
+    return uint64_t(ftello(file));
+#endif
+}
+
+static void put_u32(std::string &out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++ i)
+        out += char((v >> (8 * i)) & 0xff);
+}
+
+static void put_u64(std::string &out, uint64_t v)
+{
+    for (int i = 0; i < 8; ++ i)
+        out += char((v >> (8 * i)) & 0xff);
+}
+
+static void put_string(std::string &out, const std::string &s)
+{
+    put_u32(out, uint32_t(s.size()));
+    out += s;
+}
+
+// Reads the little endian integers and the strings of the index, throws when reading past its end.
+class IndexReader
+{
+public:
+    IndexReader(const std::string &data) : m_data(data) {}
+
+    uint64_t get(size_t nbytes) {
+        this->check(nbytes);
+        uint64_t v = 0;
+        for (size_t i = 0; i < nbytes; ++ i)
+            v |= uint64_t(uint8_t(m_data[m_pos + i])) << (8 * i);
+        m_pos += nbytes;
+        return v;
+    }
+    uint32_t    get_u32() { return uint32_t(this->get(4)); }
+    uint64_t    get_u64() { return this->get(8); }
+    std::string get_string() {
+        size_t size = this->get_u32();
+        this->check(size);
+        std::string out = m_data.substr(m_pos, size);
+        m_pos += size;
+        return out;
+    }
+
+private:
+    void check(size_t nbytes) const {
+        if (m_pos + nbytes > m_data.size())
+            throw Slic3r::RuntimeError("The index of the compressed G-code is truncated");
+    }
+
+    const std::string &m_data;
+    size_t             m_pos { 0 };
+};
+
+bool is_compressed_gcode_file(const std::string &path)
+{
+    FILE *file = boost::nowide::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return false;
+    char magic[4];
+    bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, COMPRESSED_GCODE_MAGIC, 4) == 0;
+    fclose(file);
+    return ok;
+}
+
+namespace {
+
+// Accumulates the lines of the G-code into the blocks and collects the index.
+class CompressedGCodeWriter
+{
+public:
+    CompressedGCodeWriter(FILE *file) : m_file(file) {
+        std::string header(COMPRESSED_GCODE_MAGIC, 4);
+        put_u32(header, COMPRESSED_GCODE_VERSION);
+        this->write(header);
+        m_block.reserve(COMPRESSED_GCODE_BLOCK_SIZE);
+    }
+
+    // The line including its trailing new line.
+    void add_line(const std::string &line) {
+        this->scan_line(line);
+        if (! m_block.empty() && m_block.size() + line.size() > COMPRESSED_GCODE_BLOCK_SIZE)
+            this->flush_block();
+        m_block += line;
+        m_text_offset += line.size();
+    }
+
+    void finalize() {
+        this->flush_block();
+        std::string index;
+        put_u32(index, uint32_t(m_blocks.size()));
+        for (const std::string &block : m_blocks)
+            index += block;
+        put_u32(index, uint32_t(m_layers.size()));
+        for (uint64_t offset : m_layers)
+            put_u64(index, offset);
+        put_u32(index, uint32_t(m_metadata.size()));
+        for (const std::pair<std::string, std::string> &kvp : m_metadata) {
+            put_string(index, kvp.first);
+            put_string(index, kvp.second);
+        }
+        put_u32(index, uint32_t(m_thumbnails.size()));
+        for (const CompressedGCodeThumbnail &thumbnail : m_thumbnails) {
+            put_u32(index, thumbnail.width);
+            put_u32(index, thumbnail.height);
+            put_string(index, thumbnail.png);
+        }
+        put_u64(index, m_file_offset);
+        index.append(COMPRESSED_GCODE_MAGIC, 4);
+        this->write(index);
+    }
+
+private:
+    void write(const std::string &data) {
+        if (fwrite(data.data(), 1, data.size(), m_file) != data.size())
+            throw Slic3r::RuntimeError("Writing of the compressed G-code failed. Is the disk full?");
+        m_file_offset += data.size();
+    }
+
+    void flush_block() {
+        if (m_block.empty())
+            return;
+        mz_ulong compressed_size = mz_compressBound(mz_ulong(m_block.size()));
+        m_compressed.resize(8 + compressed_size);
+        if (mz_compress2(reinterpret_cast<unsigned char*>(&m_compressed[8]), &compressed_size,
+                reinterpret_cast<const unsigned char*>(m_block.data()), mz_ulong(m_block.size()), MZ_DEFAULT_LEVEL) != MZ_OK)
+            throw Slic3r::RuntimeError("Compression of the G-code failed");
+        m_compressed.resize(8 + compressed_size);
+        std::string sizes;
+        put_u32(sizes, uint32_t(m_block.size()));
+        put_u32(sizes, uint32_t(compressed_size));
+        memcpy(&m_compressed[0], sizes.data(), 8);
+        std::string entry;
+        put_u64(entry, m_file_offset);
+        put_u64(entry, m_text_offset - m_block.size());
+        entry += sizes;
+        m_blocks.emplace_back(std::move(entry));
+        this->write(m_compressed);
+        m_block.clear();
+    }
+
+    // Collects the layers, the thumbnails and the "; key = value" comments following the last layer.
+    void scan_line(const std::string &line) {
+        size_t len = line.size();
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+            -- len;
+        if (len == 0 || line[0] != ';')
+            return;
+        if (len == GCodeProcessor::Layer_Change_Tag.size() + 1 && line.compare(1, len - 1, GCodeProcessor::Layer_Change_Tag) == 0) {
+            m_layers.push_back(m_text_offset);
+            m_metadata.clear();
+        } else if (m_thumbnail) {
+            if (line.compare(0, len, "; thumbnail end") == 0) {
+                m_thumbnail->png.resize(boost::beast::detail::base64::decoded_size(m_thumbnail_base64.size()));
+                m_thumbnail->png.resize(boost::beast::detail::base64::decode(&m_thumbnail->png[0], m_thumbnail_base64.data(), m_thumbnail_base64.size()).first);
+                m_thumbnails.emplace_back(std::move(*m_thumbnail));
+                m_thumbnail.reset();
+                m_thumbnail_base64.clear();
+            } else if (len > 2)
+                m_thumbnail_base64.append(line, 2, len - 2);
+        } else if (line.compare(0, 18, "; thumbnail begin ") == 0) {
+            unsigned int width = 0, height = 0;
+            if (sscanf(line.c_str() + 18, "%ux%u", &width, &height) == 2) {
+                m_thumbnail.reset(new CompressedGCodeThumbnail{ width, height, std::string() });
+                m_thumbnail_base64.clear();
+            }
+        } else if (line.compare(0, 2, "; ") == 0) {
+            size_t eq = line.find(" = ", 2);
+            if (eq != std::string::npos && eq < len)
+                m_metadata.emplace_back(line.substr(2, eq - 2), line.substr(eq + 3, len - eq - 3));
+        }
+    }
+
+    FILE                                             *m_file;
+    uint64_t                                          m_file_offset { 0 };
+    uint64_t                                          m_text_offset { 0 };
+    std::string                                       m_block;
+    std::string                                       m_compressed;
+    // Serialized index entries of the blocks.
+    std::vector<std::string>                          m_blocks;
+    std::vector<uint64_t>                             m_layers;
+    std::vector<std::pair<std::string, std::string>>  m_metadata;
+    std::vector<CompressedGCodeThumbnail>             m_thumbnails;
+    std::unique_ptr<CompressedGCodeThumbnail>         m_thumbnail;
+    std::string                                       m_thumbnail_base64;
+};
+
+} // namespace
+
+void compress_gcode_file(const std::string &src_path, const std::string &dst_path)
+{
+    FILE *src = boost::nowide::fopen(src_path.c_str(), "rb");
+    if (src == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot open the G-code file ") + src_path + " for compression");
+    FILE *dst = boost::nowide::fopen(dst_path.c_str(), "wb");
+    if (dst == nullptr) {
+        fclose(src);
+        throw Slic3r::RuntimeError(std::string("Cannot open the file ") + dst_path + " for writing the compressed G-code");
+    }
+    try {
+        CompressedGCodeWriter writer(dst);
+        std::vector<char>     chunk(size_t(1) << 16);
+        std::string           line;
+        for (size_t n; (n = fread(chunk.data(), 1, chunk.size(), src)) > 0;) {
+            for (const char *p = chunk.data(), *end = p + n; p < end;) {
+                const char *nl = static_cast<const char*>(memchr(p, '\n', end - p));
+                if (nl == nullptr) {
+                    line.append(p, end);
+                    break;
+                }
+                line.append(p, nl + 1);
+                writer.add_line(line);
+                line.clear();
+                p = nl + 1;
+            }
+        }
+        if (! line.empty())
+            writer.add_line(line);
+        if (ferror(src))
+            throw Slic3r::RuntimeError(std::string("Reading of the G-code file ") + src_path + " failed");
+        writer.finalize();
+        if (fflush(dst) != 0)
+            throw Slic3r::RuntimeError("Writing of the compressed G-code failed. Is the disk full?");
+    } catch (...) {
+        fclose(src);
+        fclose(dst);
+        boost::nowide::remove(dst_path.c_str());
+        throw;
+    }
+    fclose(src);
+    fclose(dst);
+}
+
+void decompress_gcode_file(const std::string &src_path, const std::string &dst_path)
+{
+    CompressedGCodeReader reader(src_path);
+    FILE *dst = boost::nowide::fopen(dst_path.c_str(), "wb");
+    if (dst == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot open the file ") + dst_path + " for writing the decompressed G-code");
+    try {
+        reader.decompress(dst);
+        if (fflush(dst) != 0)
+            throw Slic3r::RuntimeError("Writing of the decompressed G-code failed. Is the disk full?");
+    } catch (...) {
+        fclose(dst);
+        boost::nowide::remove(dst_path.c_str());
+        throw;
+    }
+    fclose(dst);
+}
+
+CompressedGCodeReader::CompressedGCodeReader(const std::string &path)
+{
+    m_file = boost::nowide::fopen(path.c_str(), "rb");
+    if (m_file == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot open the compressed G-code file ") + path);
+    try {
+        const std::string invalid = std::string("The file ") + path + " is not a valid compressed G-code";
+        char header[COMPRESSED_GCODE_HEADER_SIZE];
+        if (fread(header, 1, COMPRESSED_GCODE_HEADER_SIZE, m_file) != COMPRESSED_GCODE_HEADER_SIZE || memcmp(header, COMPRESSED_GCODE_MAGIC, 4) != 0)
+            throw Slic3r::RuntimeError(invalid);
+        std::string version(header + 4, 4);
+        if (IndexReader(version).get_u32() > COMPRESSED_GCODE_VERSION)
+            throw Slic3r::RuntimeError(std::string("The compressed G-code ") + path + " was written by a newer version");
+        // The trailer points to the index.
+        std::string trailer(COMPRESSED_GCODE_TRAILER_SIZE, 0);
+        if (seek_file(m_file, 0, SEEK_END) != 0)
+            throw Slic3r::RuntimeError(invalid);
+        uint64_t file_size = tell_file(m_file);
+        if (file_size < COMPRESSED_GCODE_HEADER_SIZE + COMPRESSED_GCODE_TRAILER_SIZE ||
+            seek_file(m_file, file_size - COMPRESSED_GCODE_TRAILER_SIZE, SEEK_SET) != 0 ||
+            fread(&trailer[0], 1, COMPRESSED_GCODE_TRAILER_SIZE, m_file) != COMPRESSED_GCODE_TRAILER_SIZE ||
+            memcmp(&trailer[8], COMPRESSED_GCODE_MAGIC, 4) != 0)
+            throw Slic3r::RuntimeError(invalid);
+        uint64_t index_offset = IndexReader(trailer).get_u64();
+        if (index_offset < COMPRESSED_GCODE_HEADER_SIZE || index_offset > file_size - COMPRESSED_GCODE_TRAILER_SIZE)
+            throw Slic3r::RuntimeError(invalid);
+        std::string data(size_t(file_size - COMPRESSED_GCODE_TRAILER_SIZE - index_offset), 0);
+        if (seek_file(m_file, index_offset, SEEK_SET) != 0 || fread(&data[0], 1, data.size(), m_file) != data.size())
+            throw Slic3r::RuntimeError(invalid);
+        IndexReader index(data);
+        m_blocks.resize(index.get_u32());
+        for (Block &block : m_blocks) {
+            block.file_offset     = index.get_u64();
+            block.text_offset     = index.get_u64();
+            block.text_size       = index.get_u32();
+            block.compressed_size = index.get_u32();
+        }
+        m_layers.resize(index.get_u32());
+        for (uint64_t &offset : m_layers)
+            offset = index.get_u64();
+        m_metadata.resize(index.get_u32());
+        for (std::pair<std::string, std::string> &kvp : m_metadata) {
+            kvp.first  = index.get_string();
+            kvp.second = index.get_string();
+        }
+        m_thumbnails.resize(index.get_u32());
+        for (CompressedGCodeThumbnail &thumbnail : m_thumbnails) {
+            thumbnail.width  = index.get_u32();
+            thumbnail.height = index.get_u32();
+            thumbnail.png    = index.get_string();
+        }
+    } catch (...) {
+        fclose(m_file);
+        throw;
+    }
+}
+
+CompressedGCodeReader::~CompressedGCodeReader()
+{
+    fclose(m_file);
+}
+
+std::string CompressedGCodeReader::read_block(size_t idx)
+{
+    const Block &block = m_blocks[idx];
+    std::string compressed(block.compressed_size, 0);
+    // Skip the sizes preceding the compressed data.
+    if (seek_file(m_file, block.file_offset + 8, SEEK_SET) != 0 ||
+        fread(&compressed[0], 1, compressed.size(), m_file) != compressed.size())
+        throw Slic3r::RuntimeError("Reading of the compressed G-code failed");
+    std::string text(block.text_size, 0);
+    mz_ulong    text_size = mz_ulong(text.size());
+    if (mz_uncompress(reinterpret_cast<unsigned char*>(&text[0]), &text_size,
+            reinterpret_cast<const unsigned char*>(compressed.data()), mz_ulong(compressed.size())) != MZ_OK ||
+        text_size != block.text_size)
+        throw Slic3r::RuntimeError("The compressed G-code is corrupted");
+    return text;
+}
+
+std::string CompressedGCodeReader::layer(size_t idx)
+{
+    assert(idx < m_layers.size());
+    return this->text(size_t(m_layers[idx]), idx + 1 < m_layers.size() ? size_t(m_layers[idx + 1]) : this->text_size());
+}
+
+std::string CompressedGCodeReader::text(size_t begin, size_t end)
+{
+    std::string out;
+    end = std::min(end, this->text_size());
+    if (begin >= end)
+        return out;
+    out.reserve(end - begin);
+    // First block ending after begin.
+    auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), uint64_t(begin),
+        [](uint64_t offset, const Block &block) { return offset < block.text_offset + block.text_size; });
+    for (; it != m_blocks.end() && it->text_offset < end; ++ it) {
+        std::string block = this->read_block(it - m_blocks.begin());
+        size_t from = begin > it->text_offset ? size_t(begin - it->text_offset) : 0;
+        size_t to   = std::min(size_t(end - it->text_offset), block.size());
+        out.append(block, from, to - from);
+    }
+    return out;
+}
+
+void CompressedGCodeReader::decompress(FILE *out)
+{
+    for (size_t i = 0; i < m_blocks.size(); ++ i) {
+        std::string block = this->read_block(i);
+        if (fwrite(block.data(), 1, block.size(), out) != block.size())
+            throw Slic3r::RuntimeError("Writing of the decompressed G-code failed. Is the disk full?");
+    }
+}
+
+} // namespace Slic3r
@@ -0,0 +1,79 @@
+#ifndef slic3r_CompressedGCode_hpp_
+#define slic3r_CompressedGCode_hpp_
+
+#include "../libslic3r.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Slic3r {
+
+// Container of a G-code file compressed by blocks of whole lines, with an index of the blocks and of the layers
+// to decompress only a part of the G-code, and with the thumbnails and the statistics / configuration of the G-code,
+// readable without decompressing it:
+//
+//   "SGCZ" magic, u32 version
+//   blocks:  u32 text size, u32 compressed size, deflated text
+//   index:   u32 count, { u64 file offset, u64 text offset, u32 text size, u32 compressed size } of the blocks
+//            u32 count, { u64 text offset } of the ;LAYER_CHANGE lines
+//            u32 count, { string key, string value } of the "; key = value" comments following the last layer
+//            u32 count, { u32 width, u32 height, string png } of the thumbnails
+//   trailer: u64 file offset of the index, "SGCZ" magic
+//
+// All the integers are little endian, the strings are stored as u32 size followed by the bytes.
+
+struct CompressedGCodeThumbnail
+{
+    uint32_t    width;
+    uint32_t    height;
+    std::string png;
+};
+
+// Does the file start with the magic of the container?
+bool is_compressed_gcode_file(const std::string &path);
+// Compresses the G-code text file src into the container dst. Throws Slic3r::RuntimeError on failure.
+void compress_gcode_file(const std::string &src, const std::string &dst);
+// Decompresses the container src into the G-code text file dst. Throws Slic3r::RuntimeError on failure.
+void decompress_gcode_file(const std::string &src, const std::string &dst);
+
+class CompressedGCodeReader
+{
+public:
+    // Reads the index of the container. Throws Slic3r::RuntimeError if the file is not a valid container.
+    explicit CompressedGCodeReader(const std::string &path);
+    ~CompressedGCodeReader();
+
+    size_t      text_size() const { return m_blocks.empty() ? 0 : size_t(m_blocks.back().text_offset + m_blocks.back().text_size); }
+    size_t      layers_count() const { return m_layers.size(); }
+    // G-code of the layer, from its ;LAYER_CHANGE up to the next one. The last layer runs up to the end of the G-code.
+    std::string layer(size_t idx);
+    // G-code between the offsets into the decompressed text, only the blocks overlapping the range are decompressed.
+    std::string text(size_t begin, size_t end);
+    // Writes the complete G-code text.
+    void        decompress(FILE *out);
+
+    const std::vector<std::pair<std::string, std::string>>& metadata()   const { return m_metadata; }
+    const std::vector<CompressedGCodeThumbnail>&            thumbnails() const { return m_thumbnails; }
+
+private:
+    struct Block {
+        uint64_t file_offset;
+        uint64_t text_offset;
+        uint32_t text_size;
+        uint32_t compressed_size;
+    };
+
+    std::string read_block(size_t idx);
+
+    FILE                                             *m_file { nullptr };
+    std::vector<Block>                                m_blocks;
+    std::vector<uint64_t>                             m_layers;
+    std::vector<std::pair<std::string, std::string>>  m_metadata;
+    std::vector<CompressedGCodeThumbnail>             m_thumbnails;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_CompressedGCode_hpp_
@@ -1,10 +1,11 @@
 #include "../GCode.hpp"
+#include "ArcFitting.hpp"
 #include "CoolingBuffer.hpp"
-#include <boost/algorithm/string/predicate.hpp>
-#include <boost/algorithm/string/replace.hpp>
 #include <boost/log/trivial.hpp>
+#include <array>
 #include <iostream>
 #include <float.h>
+#include <string_view>
 #include <unordered_set>
 
 #if 0
@@ -335,6 +336,34 @@ std::string CoolingBuffer::process_layer(const std::string &gcode, size_t layer_
     return this->apply_layer_cooldown(gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
 }
 
+static inline bool starts_with(const std::string_view &line, const std::string_view &prefix)
+{
+    return line.size() >= prefix.size() && line.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Append the comment without the cooling markers, which are not to be exported.
+static void append_without_markers(std::string &out, std::string_view comment, bool external_perimeter, bool wipe)
+{
+    static constexpr std::string_view set_speed     = ";_EXTRUDE_SET_SPEED";
+    static constexpr std::string_view ext_perimeter = ";_EXTERNAL_PERIMETER";
+    static constexpr std::string_view wipe_marker   = ";_WIPE";
+    for (size_t pos = comment.find(";_"); pos != std::string_view::npos; pos = comment.find(";_")) {
+        out.append(comment.data(), pos);
+        comment.remove_prefix(pos);
+        size_t skip =
+            starts_with(comment, set_speed) ? set_speed.size() :
+            (external_perimeter && starts_with(comment, ext_perimeter)) ? ext_perimeter.size() :
+            (wipe && starts_with(comment, wipe_marker)) ? wipe_marker.size() : 0;
+        if (skip == 0) {
+            // Not a marker to be removed, keep ";_".
+            out.append(comment.data(), 2);
+            skip = 2;
+        }
+        comment.remove_prefix(skip);
+    }
+    out.append(comment.data(), comment.size());
+}
+
 // Parse the layer G-code for the moves, which could be adjusted.
 // Return the list of parsed lines, bucketed by an extruder.
 std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const
@@ -372,32 +401,42 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
     {
         while (*line_end != '\n' && *line_end != 0)
             ++ line_end;
-        // sline will not contain the trailing '\n'.
-        std::string sline(line_start, line_end);
+        // sline will not contain the trailing '\n'. It points into gcode, thus it is followed by '\n' or by the terminating zero.
+        std::string_view sline(line_start, line_end - line_start);
         // CoolingLine will contain the trailing '\n'.
         if (*line_end == '\n')
             ++ line_end;
         CoolingLine line(0, line_start - gcode.c_str(), line_end - gcode.c_str());
-        if (boost::starts_with(sline, "G0 "))
+        // Arcs are G1 moves with the center at the offset arc_center from the start.
+        bool arc = false;
+        if (starts_with(sline, "G0 "))
             line.type = CoolingLine::TYPE_G0;
-        else if (boost::starts_with(sline, "G1 "))
+        else if (starts_with(sline, "G1 "))
             line.type = CoolingLine::TYPE_G1;
-        else if (boost::starts_with(sline, "G92 "))
+        else if (starts_with(sline, "G2 ") || starts_with(sline, "G3 ")) {
+            line.type = CoolingLine::TYPE_G1;
+            arc = true;
+        }
+        else if (starts_with(sline, "G92 "))
             line.type = CoolingLine::TYPE_G92;
         if (line.type) {
             // G0, G1 or G92
             // Parse the G-code line.
-            std::vector<float> new_pos(current_pos);
+            std::array<float, 5> new_pos;
+            std::copy(current_pos.begin(), current_pos.end(), new_pos.begin());
+            Vec2d arc_center(0., 0.);
             const char *c = sline.data() + 3;
             for (;;) {
                 // Skip whitespaces.
                 for (; *c == ' ' || *c == '\t'; ++ c);
-                if (*c == 0 || *c == ';')
+                if (c == line_end || *c == 0 || *c == ';')
                     break;
                 // Parse the axis.
                 size_t axis = (*c >= 'X' && *c <= 'Z') ? (*c - 'X') :
                               (*c == extrusion_axis) ? 3 : (*c == 'F') ? 4 : size_t(-1);
-                if (axis != size_t(-1)) {
+                if (arc && (*c == 'I' || *c == 'J')) {
+                    arc_center[*c - 'I'] = atof(c + 1);
+                } else if (axis != size_t(-1)) {
                     new_pos[axis] = float(atof(++c));
                     if (axis == 4) {
                         // Convert mm/min to mm/sec.
@@ -408,15 +447,17 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                     }
                 }
                 // Skip this word.
-                for (; *c != ' ' && *c != '\t' && *c != 0; ++ c);
+                for (; c != line_end && *c != ' ' && *c != '\t' && *c != 0; ++ c);
             }
-            bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
-            bool wipe               = boost::contains(sline, ";_WIPE");
+            // The cooling markers are in the comment.
+            std::string_view comment = c < line_end ? std::string_view(c, line_end - c) : std::string_view();
+            bool external_perimeter = comment.find(";_EXTERNAL_PERIMETER") != std::string_view::npos;
+            bool wipe               = comment.find(";_WIPE") != std::string_view::npos;
             if (external_perimeter)
                 line.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
             if (wipe)
                 line.type |= CoolingLine::TYPE_WIPE;
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED") && ! wipe) {
+            if (! wipe && comment.find(";_EXTRUDE_SET_SPEED") != std::string_view::npos) {
                 line.type |= CoolingLine::TYPE_ADJUSTABLE;
                 active_speed_modifier = adjustment->lines.size();
             }
@@ -430,7 +471,10 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                     dif[i] = new_pos[i] - current_pos[i];
                 float dxy2 = dif[0] * dif[0] + dif[1] * dif[1];
                 float dxyz2 = dxy2 + dif[2] * dif[2];
-                if (dxyz2 > 0.f) {
+                if (arc) {
+                    const Vec2d start(current_pos[0], current_pos[1]);
+                    line.length = float(ArcFitting::arc_length(start, Vec2d(new_pos[0], new_pos[1]), start + arc_center, sline[1] == '3'));
+                } else if (dxyz2 > 0.f) {
                     // Movement in xyz, calculate time from the xyz Euclidian distance.
                     line.length = sqrt(dxyz2);
                 } else if (std::abs(dif[3]) > 0.f) {
@@ -464,12 +508,12 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                     line.type = 0;
                 }
             }
-            current_pos = std::move(new_pos);
-        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
+            std::copy(new_pos.begin(), new_pos.end(), current_pos.begin());
+        } else if (starts_with(sline, ";_EXTRUDE_END")) {
             line.type = CoolingLine::TYPE_EXTRUDE_END;
             active_speed_modifier = size_t(-1);
-        } else if (boost::starts_with(sline, toolchange_prefix)) {
-            uint16_t new_extruder = (uint16_t)atoi(sline.c_str() + toolchange_prefix.size());
+        } else if (starts_with(sline, toolchange_prefix)) {
+            uint16_t new_extruder = (uint16_t)atoi(sline.data() + toolchange_prefix.size());
             // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes - those shall be ignored.
             if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
                 if (new_extruder != current_extruder) {
@@ -485,26 +529,26 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                     BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " << sline;
             }
 
-        } else if (boost::starts_with(sline, ";_BRIDGE_FAN_START")) {
+        } else if (starts_with(sline, ";_BRIDGE_FAN_START")) {
             line.type = CoolingLine::TYPE_BRIDGE_FAN_START;
-        } else if (boost::starts_with(sline, ";_BRIDGE_FAN_END")) {
+        } else if (starts_with(sline, ";_BRIDGE_FAN_END")) {
             line.type = CoolingLine::TYPE_BRIDGE_FAN_END;
-        } else if (boost::starts_with(sline, ";_BRIDGE_INTERNAL_FAN_START")) {
+        } else if (starts_with(sline, ";_BRIDGE_INTERNAL_FAN_START")) {
             line.type = CoolingLine::TYPE_BRIDGE_INTERNAL_FAN_START;
-        } else if (boost::starts_with(sline, ";_BRIDGE_INTERNAL_FAN_END")) {
+        } else if (starts_with(sline, ";_BRIDGE_INTERNAL_FAN_END")) {
             line.type = CoolingLine::TYPE_BRIDGE_INTERNAL_FAN_END;
-        } else if (boost::starts_with(sline, ";_TOP_FAN_START")) {
+        } else if (starts_with(sline, ";_TOP_FAN_START")) {
             line.type = CoolingLine::TYPE_TOP_FAN_START;
-        } else if (boost::starts_with(sline, ";_TOP_FAN_END")) {
+        } else if (starts_with(sline, ";_TOP_FAN_END")) {
             line.type = CoolingLine::TYPE_TOP_FAN_END;
-        } else if (boost::starts_with(sline, "G4 ")) {
+        } else if (starts_with(sline, "G4 ")) {
             // Parse the wait time.
             line.type = CoolingLine::TYPE_G4;
             size_t pos_S = sline.find('S', 3);
             size_t pos_P = sline.find('P', 3);
             line.time = line.time_max = float(
-                (pos_S > 0) ? atof(sline.c_str() + pos_S + 1) :
-                (pos_P > 0) ? atof(sline.c_str() + pos_P + 1) * 0.001 : 0.);
+                (pos_S != std::string_view::npos) ? atof(sline.data() + pos_S + 1) :
+                (pos_P != std::string_view::npos) ? atof(sline.data() + pos_P + 1) * 0.001 : 0.);
         }
         if (line.type != 0)
             adjustment->lines.emplace_back(std::move(line));
@@ -948,13 +992,8 @@ std::string CoolingBuffer::apply_layer_cooldown(
             if (end < line_end) {
                 if (line->type & (CoolingLine::TYPE_ADJUSTABLE | CoolingLine::TYPE_EXTERNAL_PERIMETER | CoolingLine::TYPE_WIPE)) {
                     // Process comments, remove ";_EXTRUDE_SET_SPEED", ";_EXTERNAL_PERIMETER", ";_WIPE"
-                    std::string comment(end, line_end);
-                    boost::replace_all(comment, ";_EXTRUDE_SET_SPEED", "");
-                    if (line->type & CoolingLine::TYPE_EXTERNAL_PERIMETER)
-                        boost::replace_all(comment, ";_EXTERNAL_PERIMETER", "");
-                    if (line->type & CoolingLine::TYPE_WIPE)
-                        boost::replace_all(comment, ";_WIPE", "");
-                    new_gcode += comment;
+                    append_without_markers(new_gcode, std::string_view(end, line_end - end),
+                        (line->type & CoolingLine::TYPE_EXTERNAL_PERIMETER) != 0, (line->type & CoolingLine::TYPE_WIPE) != 0);
                 } else {
                     // Just attach the rest of the source line.
                     new_gcode.append(end, line_end - end);
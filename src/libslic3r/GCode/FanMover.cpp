@@ -1,5 +1,6 @@
 #include "FanMover.hpp"
 
+#include "ArcFitting.hpp"
 #include "GCodeReader.hpp"
 
 #include <iomanip>
@@ -32,7 +33,7 @@ const std::string& FanMover::process_gcode(const std::string& gcode, bool flush)
 
     if (flush) {
         while (!m_buffer.empty()) {
-            m_process_output += m_buffer.front().raw + "\n";
+            _print_line(m_buffer.front().raw);
             remove_from_buffer(m_buffer.begin());
         }
     }
@@ -98,11 +99,11 @@ void FanMover::_put_in_middle_G1(std::list<BufferData>::iterator item_to_split,
     assert(item_to_split != m_buffer.end());
     if (nb_sec < item_to_split->time * 0.1) {
         // doesn't really need to be split, print it after
-        m_buffer.insert(next(item_to_split), line_to_write);
+        m_buffer.insert(next(item_to_split), std::move(line_to_write));
     } else if (nb_sec > item_to_split->time * 0.9) {
         // doesn't really need to be split, print it before
         //will also print before if line_to_split.time == 0
-        m_buffer.insert(item_to_split, line_to_write);
+        m_buffer.insert(item_to_split, std::move(line_to_write));
     } else if (item_to_split->raw.size() > 2
         && item_to_split->raw[0] == 'G' && item_to_split->raw[1] == '1' && item_to_split->raw[2] == ' ') {
         float percent = nb_sec / item_to_split->time;
@@ -141,12 +142,12 @@ void FanMover::_put_in_middle_G1(std::list<BufferData>::iterator item_to_split,
             }
         }
         //add before then line_to_write, then there is the modified data.
-        m_buffer.insert(item_to_split, before);
-        m_buffer.insert(item_to_split, line_to_write);
+        m_buffer.insert(item_to_split, std::move(before));
+        m_buffer.insert(item_to_split, std::move(line_to_write));
 
     } else {
         //not a G1, print it before
-        m_buffer.insert(item_to_split, line_to_write);
+        m_buffer.insert(item_to_split, std::move(line_to_write));
     }
 }
 
@@ -154,13 +155,13 @@ void FanMover::_print_in_middle_G1(BufferData& line_to_split, float nb_sec, cons
     //std::cout << "_print_in_middle_G1\n";
     if (nb_sec < line_to_split.time * 0.1) {
         // doesn't really need to be split, print it after
-        m_process_output += line_to_split.raw + "\n";
-        m_process_output += line_to_write + (line_to_write.back() == '\n'?"":"\n");
+        _print_line(line_to_split.raw);
+        _print_line(line_to_write);
     } else if (nb_sec > line_to_split.time * 0.9) {
         // doesn't really need to be split, print it before
         //will also print before if line_to_split.time == 0
-        m_process_output += line_to_write + (line_to_write.back() == '\n' ? "" : "\n");
-        m_process_output += line_to_split.raw + "\n";
+        _print_line(line_to_write);
+        _print_line(line_to_split.raw);
     }else if(line_to_split.raw.size() > 2
         && line_to_split.raw[0] == 'G' && line_to_split.raw[1] == '1' && line_to_split.raw[2] == ' ') {
         float percent = nb_sec / line_to_split.time;
@@ -183,14 +184,14 @@ void FanMover::_print_in_middle_G1(BufferData& line_to_split, float nb_sec, cons
                 change_axis_value(before, 'E', line_to_split.e + line_to_split.de * percent, 5);
             }
         }
-        m_process_output += before + "\n";
-        m_process_output += line_to_write + (line_to_write.back() == '\n' ? "" : "\n");
-        m_process_output += line_to_split.raw + "\n";
+        _print_line(before);
+        _print_line(line_to_write);
+        _print_line(line_to_split.raw);
 
     } else {
         //not a G1, print it before
-        m_process_output += line_to_write + (line_to_write.back() == '\n' ? "" : "\n");
-        m_process_output += line_to_split.raw + "\n";
+        _print_line(line_to_write);
+        _print_line(line_to_split.raw);
     }
 }
 
@@ -214,7 +215,7 @@ void FanMover::_remove_slow_fan(int16_t min_speed, float past_sec) {
 void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCodeLine& line)
 {
     // processes 'normal' gcode lines
-    std::string cmd(line.cmd());
+    const std::string_view cmd = line.cmd();
     double time = 0;
     int16_t fan_speed = -1;
     if (cmd.length() > 1) {
@@ -232,6 +233,15 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                     dist = std::sqrt(dist);
                     time = dist / m_current_speed;
                 }
+            } else if (::atoi(&cmd[1]) == 2 || ::atoi(&cmd[1]) == 3) {
+                float i = 0, j = 0;
+                line.has_value('I', i);
+                line.has_value('J', j);
+                const Vec2d start(reader.x(), reader.y());
+                const Vec2d end(line.has_x() ? line.x() : reader.x(), line.has_y() ? line.y() : reader.y());
+                double dist = ArcFitting::arc_length(start, end, start + Vec2d(i, j), cmd[1] == '3');
+                if (dist > 0)
+                    time = dist / m_current_speed;
             }
             break;
         }
@@ -250,7 +260,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                             _print_in_middle_G1(m_buffer.front(), m_buffer_time_size - nb_seconds_delay, line.raw());
                             remove_from_buffer(m_buffer.begin());
                         } else {
-                            m_process_output += line.raw() + "\n";
+                            _print_line(line.raw());
                         }
                     } else {
                         //if kickstart
@@ -304,8 +314,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
         {
             if (line.raw().size() > 10 && line.raw().rfind(";TYPE:", 0) == 0) {
                 // get the type of the next extrusions
-                std::string extrusion_string = line.raw().substr(6, line.raw().size() - 6);
-                current_role = ExtrusionEntity::string_to_role(extrusion_string);
+                current_role = ExtrusionEntity::string_to_role(std::string_view(line.raw()).substr(6));
             }
             if (line.raw().size() > 16 && line.raw().rfind("; custom gcode", 0) == 0) {
                 m_is_custom_gcode = line.raw().rfind("; custom gcode end", 0) != 0;
@@ -354,7 +363,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                     m_process_output += m_writer.set_fan(backdata.fan_speed,true);
                     m_current_fan_speed = backdata.fan_speed;
                 } else {
-                    m_process_output += backdata.raw + "\n";
+                    _print_line(backdata.raw);
                     if (backdata.fan_speed >= 0) {
                         //note that this is the only plce where the fan_speed is set and we print from the buffer, as if the fan_speed >= 0 => time == 0
                         //and as this flush all time == 0 lines fromt he back of the queue...
@@ -21,9 +21,9 @@ public:
     bool is_kickstart;
     float x = 0, y = 0, z = 0, e = 0;
     float dx = 0, dy = 0, dz = 0, de = 0;
-    BufferData(std::string line, float time = 0, int16_t fan_speed = 0, float is_kickstart = false) : raw(line), time(time), fan_speed(fan_speed), is_kickstart(is_kickstart){
+    BufferData(std::string line, float time = 0, int16_t fan_speed = 0, float is_kickstart = false) : raw(std::move(line)), time(time), fan_speed(fan_speed), is_kickstart(is_kickstart){
         //avoid double \n
-        if(!line.empty() && line.back() == '\n') line.pop_back();
+        if(!raw.empty() && raw.back() == '\n') raw.pop_back();
     }
 };
 
@@ -71,13 +71,19 @@ public:
 private:
     BufferData& put_in_buffer(BufferData&& data) {
         m_buffer_time_size += data.time;
-        m_buffer.emplace_back(data);
+        m_buffer.emplace_back(std::move(data));
         return m_buffer.back();
     }
     std::list<BufferData>::iterator remove_from_buffer(std::list<BufferData>::iterator data) {
         m_buffer_time_size -= data->time;
         return m_buffer.erase(data);
     }
+    // Appends the line to the output, ending it with a new line.
+    void _print_line(const std::string &line) {
+        m_process_output += line;
+        if (line.empty() || line.back() != '\n')
+            m_process_output += '\n';
+    }
     // Processes the given gcode line
     void _process_gcode_line(GCodeReader& reader, const GCodeReader::GCodeLine& line);
     void _put_in_middle_G1(std::list<BufferData>::iterator item_to_split, float nb_sec, BufferData&& line_to_write);
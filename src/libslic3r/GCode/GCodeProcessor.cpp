@@ -1,13 +1,23 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/Print.hpp"
+#include "libslic3r/Tracing.hpp"
 #include "GCodeProcessor.hpp"
+#include "CompressedGCode.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
 
+#include <tbb/parallel_invoke.h>
+
+#include <algorithm>
+
 #include <float.h>
 #include <assert.h>
 
@@ -37,6 +47,9 @@ const std::string GCodeProcessor::Custom_Code_Tag    = "CUSTOM_GCODE";
 const std::string GCodeProcessor::First_Line_M73_Placeholder_Tag          = "; _GP_FIRST_LINE_M73_PLACEHOLDER";
 const std::string GCodeProcessor::Last_Line_M73_Placeholder_Tag           = "; _GP_LAST_LINE_M73_PLACEHOLDER";
 const std::string GCodeProcessor::Estimated_Printing_Time_Placeholder_Tag = "; _GP_ESTIMATED_PRINTING_TIME_PLACEHOLDER";
+// Large enough for the two lines of the normal and of the silent mode.
+const std::string GCodeProcessor::Estimated_Printing_Time_Placeholder_Line = Estimated_Printing_Time_Placeholder_Tag +
+    std::string(255 - Estimated_Printing_Time_Placeholder_Tag.size(), ' ') + "\n";
 
 const float GCodeProcessor::Wipe_Width = 0.05f;
 const float GCodeProcessor::Wipe_Height = 0.05f;
@@ -253,10 +266,9 @@ static void recalculate_trapezoids(std::vector<GCodeProcessor::TimeBlock>& block
             // Recalculate if current block entry or exit junction speed has changed.
             if (curr->flags.recalculate || next->flags.recalculate) {
                 // NOTE: Entry and exit factors always > 0 by all previous logic operations.
-                GCodeProcessor::TimeBlock block = *curr;
-                block.feedrate_profile.exit = next->feedrate_profile.entry;
-                block.calculate_trapezoid();
-                curr->trapezoid = block.trapezoid;
+                // The exit feedrate is only read by calculate_trapezoid() and it is always set before, thus the block is updated in place.
+                curr->feedrate_profile.exit = next->feedrate_profile.entry;
+                curr->calculate_trapezoid();
                 curr->flags.recalculate = false; // Reset current only to ensure next trapezoid is computed
             }
         }
@@ -264,10 +276,8 @@ static void recalculate_trapezoids(std::vector<GCodeProcessor::TimeBlock>& block
 
     // Last/newest block in buffer. Always recalculated.
     if (next != nullptr) {
-        GCodeProcessor::TimeBlock block = *next;
-        block.feedrate_profile.exit = next->safe_feedrate;
-        block.calculate_trapezoid();
-        next->trapezoid = block.trapezoid;
+        next->feedrate_profile.exit = next->safe_feedrate;
+        next->calculate_trapezoid();
         next->flags.recalculate = false;
     }
 }
@@ -317,6 +327,22 @@ void GCodeProcessor::TimeMachine::calculate_time(size_t keep_last_n_blocks)
         blocks.clear();
 }
 
+void GCodeProcessor::TimeProcessor::calculate_time(size_t keep_last_n_blocks, size_t min_blocks)
+{
+    TimeMachine& normal  = machines[static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Normal)];
+    TimeMachine& stealth = machines[static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Stealth)];
+    bool calculate_normal  = normal.enabled && normal.blocks.size() > min_blocks;
+    bool calculate_stealth = stealth.enabled && stealth.blocks.size() > min_blocks;
+    if (calculate_normal && calculate_stealth)
+        tbb::parallel_invoke(
+            [&normal, keep_last_n_blocks]() { normal.calculate_time(keep_last_n_blocks); },
+            [&stealth, keep_last_n_blocks]() { stealth.calculate_time(keep_last_n_blocks); });
+    else if (calculate_normal)
+        normal.calculate_time(keep_last_n_blocks);
+    else if (calculate_stealth)
+        stealth.calculate_time(keep_last_n_blocks);
+}
+
 void GCodeProcessor::TimeProcessor::reset()
 {
     extruder_unloaded = true;
@@ -329,10 +355,62 @@ void GCodeProcessor::TimeProcessor::reset()
         machines[i].reset();
     }
     machines[static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Normal)].enabled = true;
+    estimated_time_placeholder_offset = std::string::npos;
+}
+
+std::string GCodeProcessor::TimeProcessor::estimated_printing_time_lines() const
+{
+    std::string ret;
+    for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Count); ++i) {
+        const TimeMachine& machine = machines[i];
+        PrintEstimatedTimeStatistics::ETimeMode mode = static_cast<PrintEstimatedTimeStatistics::ETimeMode>(i);
+        if (mode == PrintEstimatedTimeStatistics::ETimeMode::Normal || machine.enabled) {
+            char buf[128];
+            sprintf(buf, "; estimated printing time (%s mode) = %s\n",
+                (mode == PrintEstimatedTimeStatistics::ETimeMode::Normal) ? "normal" : "silent",
+                get_time_dhms(machine.time).c_str());
+            ret += buf;
+        }
+    }
+    return ret;
+}
+
+bool GCodeProcessor::TimeProcessor::patch_estimated_time_placeholder(const std::string& filename) const
+{
+    const std::string& slot = Estimated_Printing_Time_Placeholder_Line;
+    std::string lines = estimated_printing_time_lines();
+    if (lines.size() > slot.size())
+        return false;
+    if (size_t padding = slot.size() - lines.size(); padding > 0)
+        // G-code comment filling the rest of the slot.
+        lines += (padding == 1) ? std::string("\n") : ";" + std::string(padding - 2, ' ') + "\n";
+
+    FILE* file = boost::nowide::fopen(filename.c_str(), "r+b");
+    if (file == nullptr)
+        return false;
+    // The slot shall still be there, the file may have been modified since it was written.
+    std::string current(slot.size(), '\0');
+    bool ok = fseek(file, long(estimated_time_placeholder_offset), SEEK_SET) == 0 &&
+              fread(current.data(), 1, current.size(), file) == current.size() && current == slot &&
+              fseek(file, long(estimated_time_placeholder_offset), SEEK_SET) == 0;
+    if (ok) {
+        fwrite(lines.data(), 1, lines.size(), file);
+        if (ferror(file)) {
+            fclose(file);
+            throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nIs the disk full?\n"));
+        }
+    }
+    fclose(file);
+    return ok;
 }
 
 void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
 {
+    // Without the lines M73, only the placeholder of the estimated printing time is replaced, in place if the slot is known.
+    if (! export_remaining_time_enabled && estimated_time_placeholder_offset != std::string::npos &&
+        patch_estimated_time_placeholder(filename))
+        return;
+
     boost::nowide::ifstream in(filename);
     if (!in.good())
         throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nCannot open file for reading.\n"));
@@ -384,19 +462,8 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
                 }
             }
         }
-        else if (line == Estimated_Printing_Time_Placeholder_Tag) {
-            for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Count); ++i) {
-                const TimeMachine& machine = machines[i];
-                PrintEstimatedTimeStatistics::ETimeMode mode = static_cast<PrintEstimatedTimeStatistics::ETimeMode>(i);
-                if (mode == PrintEstimatedTimeStatistics::ETimeMode::Normal || machine.enabled) {
-                    char buf[128];
-                    sprintf(buf, "; estimated printing time (%s mode) = %s\n",
-                        (mode == PrintEstimatedTimeStatistics::ETimeMode::Normal) ? "normal" : "silent",
-                        get_time_dhms(machine.time).c_str());
-                    ret += buf;
-                }
-            }
-        }
+        else if (line == Estimated_Printing_Time_Placeholder_Tag || gcode_line == Estimated_Printing_Time_Placeholder_Line)
+            ret = estimated_printing_time_lines();
 
         return std::make_pair(!ret.empty(), ret.empty() ? gcode_line : ret);
     };
@@ -514,6 +581,84 @@ const std::vector<std::pair<GCodeProcessor::EProducer, std::string>> GCodeProces
     { EProducer::KissSlicer,  "KISSlicer" }
 };
 
+void GCodeProcessor::MoveVertices::clear()
+{
+    m_type.clear();
+    m_extrusion_role.clear();
+    m_position.clear();
+    m_delta_extruder.clear();
+    m_feedrate.clear();
+    m_time.clear();
+    m_run_start.clear();
+    m_run_attributes.clear();
+}
+
+void GCodeProcessor::MoveVertices::reserve(size_t n)
+{
+    m_type.reserve(n);
+    m_extrusion_role.reserve(n);
+    m_position.reserve(n);
+    m_delta_extruder.reserve(n);
+    m_feedrate.reserve(n);
+    m_time.reserve(n);
+}
+
+void GCodeProcessor::MoveVertices::push_back(const MoveVertex& move)
+{
+    Attributes attributes = { move.extruder_id, move.cp_color_id, move.width, move.height, move.mm3_per_mm, move.fan_speed, move.layer_duration, move.temperature };
+    if (m_run_attributes.empty() || m_run_attributes.back() != attributes) {
+        m_run_start.emplace_back(uint32_t(m_type.size()));
+        m_run_attributes.emplace_back(attributes);
+    }
+    m_type.emplace_back(move.type);
+    m_extrusion_role.emplace_back(move.extrusion_role);
+    m_position.emplace_back(move.position);
+    m_delta_extruder.emplace_back(move.delta_extruder);
+    m_feedrate.emplace_back(move.feedrate);
+    m_time.emplace_back(move.time);
+}
+
+size_t GCodeProcessor::MoveVertices::run_id(size_t idx) const
+{
+    assert(! m_run_start.empty());
+    auto it = std::upper_bound(m_run_start.begin(), m_run_start.end(), uint32_t(idx));
+    return (it == m_run_start.begin()) ? 0 : size_t(it - m_run_start.begin()) - 1;
+}
+
+GCodeProcessor::MoveVertex GCodeProcessor::MoveVertices::get(size_t idx, size_t run) const
+{
+    assert(idx < this->size() && run < m_run_attributes.size());
+    const Attributes& attributes = m_run_attributes[run];
+    return {
+        m_type[idx],
+        m_extrusion_role[idx],
+        attributes.extruder_id,
+        attributes.cp_color_id,
+        m_position[idx],
+        m_delta_extruder[idx],
+        m_feedrate[idx],
+        attributes.width,
+        attributes.height,
+        attributes.mm3_per_mm,
+        attributes.fan_speed,
+        attributes.layer_duration,
+        m_time[idx],
+        attributes.temperature
+    };
+}
+
+size_t GCodeProcessor::MoveVertices::memory_size() const
+{
+    return SLIC3R_STDVEC_MEMSIZE(m_type, EMoveType) +
+           SLIC3R_STDVEC_MEMSIZE(m_extrusion_role, ExtrusionRole) +
+           SLIC3R_STDVEC_MEMSIZE(m_position, Vec3f) +
+           SLIC3R_STDVEC_MEMSIZE(m_delta_extruder, float) +
+           SLIC3R_STDVEC_MEMSIZE(m_feedrate, float) +
+           SLIC3R_STDVEC_MEMSIZE(m_time, float) +
+           SLIC3R_STDVEC_MEMSIZE(m_run_start, uint32_t) +
+           SLIC3R_STDVEC_MEMSIZE(m_run_attributes, Attributes);
+}
+
 unsigned int GCodeProcessor::s_result_id = 0;
 
 GCodeProcessor::GCodeProcessor()
@@ -853,8 +998,24 @@ void GCodeProcessor::process_string(const std::string& gcode, std::function<void
         });
 }
 
-void GCodeProcessor::process_file(const std::string& filename, bool apply_postprocess, std::function<void()> cancel_callback)
+void GCodeProcessor::process_file(const std::string& filename, bool apply_postprocess, std::function<void()> cancel_callback, size_t max_offset)
 {
+    SLIC3R_TRACE_ZONE("GCodeProcessor::process_file");
+    if (is_compressed_gcode_file(filename)) {
+        // Parse the text of the compressed G-code, decompressed into a temporary file.
+        const std::string text_filename = (boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("." SLIC3R_APP_KEY ".gcode.%%%%-%%%%-%%%%-%%%%")).string();
+        decompress_gcode_file(filename, text_filename);
+        try {
+            this->process_file(text_filename, apply_postprocess, cancel_callback, max_offset);
+        } catch (...) {
+            boost::nowide::remove(text_filename.c_str());
+            throw;
+        }
+        boost::nowide::remove(text_filename.c_str());
+        return;
+    }
+
     auto last_cancel_callback_time = std::chrono::high_resolution_clock::now();
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
@@ -892,9 +1053,7 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
     }
 
     // process gcode
-    m_result.id = ++s_result_id;
-    // 1st move must be a dummy move
-    m_result.moves.emplace_back(MoveVertex());
+    start_processing();
     m_parser.parse_file(filename, [this, cancel_callback, &last_cancel_callback_time](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (cancel_callback != nullptr) {
             // call the cancel callback every 100 ms
@@ -905,21 +1064,121 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
             }
         }
         process_gcode_line(line);
-        });
+        }, max_offset);
+    finish_processing(filename, apply_postprocess);
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+}
+
+std::vector<GCodeProcessor::LayerIndexEntry> GCodeProcessor::scan_layers(const std::string& filename)
+{
+    std::vector<LayerIndexEntry> layers;
+    const std::string layer_change = ";" + Layer_Change_Tag;
+    // The lines are followed by a new line or a zero, the number of the ;Z: tag is parsed in place.
+    auto scan_line = [&layers, &layer_change](const char* line, size_t len, size_t offset) {
+        if (len > 0 && line[len - 1] == '\r')
+            --len;
+        if (len == layer_change.size() && memcmp(line, layer_change.data(), len) == 0) {
+            layers.push_back({ offset });
+            return;
+        }
+        if (layers.empty())
+            return;
+        LayerIndexEntry& layer = layers.back();
+        ++layer.lines;
+        if (len > 1 && line[0] == 'G' && line[1] >= '0' && line[1] <= '3' && (len == 2 || line[2] == ' '))
+            ++layer.moves;
+        else if (layer.z == 0.0f && len > 3 && line[0] == ';' && line[1] == 'Z' && line[2] == ':')
+            layer.z = float(atof(line + 3));
+    };
 
-    // update width/height of wipe moves
-    for (MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
+    try {
+        boost::interprocess::file_mapping  mapping(filename.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+        region.advise(boost::interprocess::mapped_region::advice_sequential);
+        const char* begin = static_cast<const char*>(region.get_address());
+        const char* end = begin + region.get_size();
+        for (const char* ptr = begin; ptr < end;) {
+            const char* line_end = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+            if (line_end == nullptr) {
+                // The last line is not terminated, scan a copy of it.
+                const std::string line(ptr, end);
+                scan_line(line.c_str(), line.size(), ptr - begin);
+                break;
+            }
+            scan_line(ptr, line_end - ptr, ptr - begin);
+            ptr = line_end + 1;
         }
+        return layers;
+    } catch (const boost::interprocess::interprocess_exception&) {
+        // The file is empty or it could not be mapped, read it through a stream.
+    }
+    boost::nowide::ifstream f(filename);
+    std::string line;
+    for (size_t offset = 0; std::getline(f, line); offset += line.size() + 1)
+        scan_line(line.c_str(), line.size(), offset);
+    return layers;
+}
+
+void GCodeProcessor::start_streaming()
+{
+    m_streamed_line.clear();
+    m_streamed_size = 0;
+    start_processing();
+}
+
+void GCodeProcessor::process_buffer(const std::string& buffer)
+{
+    SLIC3R_TRACE_ZONE("GCodeProcessor::process_buffer");
+    auto process_line = [this](GCodeReader& reader, const GCodeReader::GCodeLine& line) { process_gcode_line(line); };
+    GCodeReader::GCodeLine gline;
+    size_t line_start = 0;
+    for (size_t line_end = buffer.find('\n'); line_end != std::string::npos; line_start = line_end + 1, line_end = buffer.find('\n', line_start)) {
+        gline.reset();
+        if (m_streamed_line.empty()) {
+            if (buffer[line_start] == ';' && buffer.compare(line_start, Estimated_Printing_Time_Placeholder_Tag.size(), Estimated_Printing_Time_Placeholder_Tag) == 0)
+                // Slot to be replaced in place by TimeProcessor::post_process().
+                m_time_processor.estimated_time_placeholder_offset = m_streamed_size + line_start;
+            // The line is terminated by the new line, it could be parsed in place.
+            m_parser.parse_line(buffer.data() + line_start, gline, process_line);
+        } else {
+            // Complete the line started by the previous buffer.
+            m_streamed_line.append(buffer, line_start, line_end - line_start);
+            if (boost::starts_with(m_streamed_line, Estimated_Printing_Time_Placeholder_Tag))
+                m_time_processor.estimated_time_placeholder_offset = m_streamed_size - (m_streamed_line.size() - (line_end - line_start));
+            m_parser.parse_line(m_streamed_line.c_str(), gline, process_line);
+            m_streamed_line.clear();
+        }
+    }
+    m_streamed_line.append(buffer, line_start, std::string::npos);
+    m_streamed_size += buffer.size();
+}
+
+void GCodeProcessor::finish_streaming(const std::string& filename, bool apply_postprocess)
+{
+    if (! m_streamed_line.empty()) {
+        // The last line is not terminated by a new line.
+        m_parser.parse_line(m_streamed_line, [this](GCodeReader& reader, const GCodeReader::GCodeLine& line) { process_gcode_line(line); });
+        m_streamed_line.clear();
     }
+    finish_processing(filename, apply_postprocess);
+}
 
+void GCodeProcessor::start_processing()
+{
+    m_result.id = ++s_result_id;
+    // 1st move must be a dummy move
+    m_result.moves.emplace_back(MoveVertex());
+}
+
+void GCodeProcessor::finish_processing(const std::string& filename, bool apply_postprocess)
+{
     // process the time blocks
+    m_time_processor.calculate_time();
     for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Count); ++i) {
-        TimeMachine& machine = m_time_processor.machines[i];
-        TimeMachine::CustomGCodeTime& gcode_time = machine.gcode_time;
-        machine.calculate_time();
+        TimeMachine::CustomGCodeTime& gcode_time = m_time_processor.machines[i].gcode_time;
         if (gcode_time.needed && gcode_time.cache != 0.0f)
             gcode_time.times.push_back({ CustomGCode::ColorChange, gcode_time.cache });
     }
@@ -931,24 +1190,107 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
         m_time_processor.post_process(filename);
 
     //update times for results
-    for (size_t i = 0; i < m_result.moves.size(); i++) {
-        //field layer_duration contains the layer id for the move in which the layer_duration has to be set.
-        size_t layer_id = size_t(m_result.moves[i].layer_duration);
-        std::vector<float>& layer_times = m_result.time_statistics.modes[0].layers_times;
+    //field layer_duration contains the layer id for the moves of the run in which the layer_duration has to be set.
+    const std::vector<float>& layer_times = m_result.time_statistics.modes[0].layers_times;
+    m_result.moves.transform_attributes([&layer_times](MoveVertices::Attributes& attributes) {
+        size_t layer_id = size_t(attributes.layer_duration);
         if (layer_times.size() > layer_id - 1 && layer_id > 0)
-            m_result.moves[i].layer_duration = layer_times[layer_id - 1];
+            attributes.layer_duration = layer_times[layer_id - 1];
         else
-            m_result.moves[i].layer_duration = 0;
-}
+            attributes.layer_duration = 0;
+    });
+    update_moves_ranges();
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     m_mm3_per_mm_compare.output();
     m_height_compare.output();
     m_width_compare.output();
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
+}
 
-#if ENABLE_GCODE_VIEWER_STATISTICS
-    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
+void GCodeProcessor::ValuesRange::merge(const ValuesRange& other)
+{
+    if (other.count == 0)
+        return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    if (count <= 2 && other.count <= 2) {
+        // both hold at most two distinct values, their min and max
+        unsigned int shared = (other.min == min || other.min == max) ? 1 : 0;
+        if (other.count == 2 && (other.max == min || other.max == max))
+            ++shared;
+        count += other.count - shared;
+    }
+    else
+        count += other.count;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+float GCodeProcessor::round_to_nearest(float value, unsigned int decimals)
+{
+    float res = 0.0f;
+    if (decimals == 0)
+        res = std::round(value);
+    else {
+        char buf[64];
+        sprintf(buf, "%.*g", decimals, value);
+        res = std::stof(buf);
+    }
+    return res;
+}
+
+void GCodeProcessor::update_moves_ranges()
+{
+    MovesRanges& ranges = m_result.ranges;
+    ranges.reset();
+    if (m_result.moves.empty())
+        return;
+
+    // the rounded values are cached, as they change far less often than the moves
+    float last_height = -1.0f, height = 0.0f;
+    float last_width = -1.0f, width = 0.0f;
+    float last_volumetric_rate = -1.0f, volumetric_rate = 0.0f;
+    MoveVertices::const_iterator it = m_result.moves.begin();
+    // skip the first (dummy) move
+    for (++it; it != m_result.moves.end(); ++it) {
+        const MoveVertex move = *it;
+        switch (move.type)
+        {
+        case EMoveType::Extrude:
+        {
+            if (move.height != last_height) {
+                last_height = move.height;
+                height = round_to_nearest(move.height, 2);
+            }
+            if (move.width != last_width) {
+                last_width = move.width;
+                width = round_to_nearest(move.width, 2);
+            }
+            if (move.volumetric_rate() != last_volumetric_rate) {
+                last_volumetric_rate = move.volumetric_rate();
+                volumetric_rate = round_to_nearest(last_volumetric_rate, 2);
+            }
+            ranges.height.update_from(height);
+            ranges.width.update_from(width);
+            ranges.fan_speed.update_from(move.fan_speed);
+            if (move.layer_duration > 0.f)
+                ranges.layer_duration.update_from(move.layer_duration);
+            ranges.elapsed_time.update_from(move.time);
+            ranges.volumetric_rate.update_from(volumetric_rate);
+            ranges.extruder_temp.update_from(move.temperature);
+            ranges.extrude_feedrate.update_from(move.feedrate);
+            break;
+        }
+        case EMoveType::Travel:
+        {
+            ranges.travel_feedrate.update_from(move.feedrate);
+            break;
+        }
+        default: { break; }
+        }
+    }
 }
 
 float GCodeProcessor::get_time(PrintEstimatedTimeStatistics::ETimeMode mode) const
@@ -1888,6 +2230,10 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
         double volume_extruded_filament = area_filament_cross_section * delta_pos[E];
         double area_toolpath_cross_section = volume_extruded_filament / delta_xyz;
 
+        if (m_result.extruded_volumes.size() <= m_extruder_id)
+            m_result.extruded_volumes.resize(size_t(m_extruder_id) + 1, 0.);
+        m_result.extruded_volumes[m_extruder_id] += volume_extruded_filament;
+
         // volume extruded filament / tool displacement = area toolpath cross section
         m_mm3_per_mm = float(area_toolpath_cross_section);
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
@@ -2110,11 +2456,10 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
         prev = curr;
 
         blocks.push_back(block);
-
-        if (blocks.size() > TimeProcessor::Planner::refresh_threshold)
-            machine.calculate_time(TimeProcessor::Planner::queue_size);
     }
 
+    m_time_processor.calculate_time(TimeProcessor::Planner::queue_size, TimeProcessor::Planner::refresh_threshold);
+
     // store move
     store_move_vertex(type);
 
@@ -2662,8 +3007,9 @@ void GCodeProcessor::store_move_vertex(EMoveType type)
         Vec3f(float(m_end_position[X]), float(m_end_position[Y]), float(m_end_position[Z])) + m_extruder_offsets[m_extruder_id],
         float(m_end_position[E] - m_start_position[E]),
         m_feedrate,
-        m_width,
-        m_height,
+        // width/height of wipe moves are fixed
+        (type == EMoveType::Wipe) ? Wipe_Width : m_width,
+        (type == EMoveType::Wipe) ? Wipe_Height : m_height,
         m_mm3_per_mm,
         m_fan_speed,
         float(m_layer_id), //layer_duration: set later
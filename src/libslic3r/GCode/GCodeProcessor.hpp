@@ -7,7 +7,11 @@
 #include "libslic3r/PrintConfig.hpp"
 #include "libslic3r/CustomGCode.hpp"
 
+#include <algorithm>
+#include <cfloat>
 #include <cstdint>
+#include <cstddef>
+#include <iterator>
 #include <array>
 #include <vector>
 #include <string>
@@ -81,6 +85,8 @@ namespace Slic3r {
         static const std::string First_Line_M73_Placeholder_Tag;
         static const std::string Last_Line_M73_Placeholder_Tag;
         static const std::string Estimated_Printing_Time_Placeholder_Tag;
+        // Estimated_Printing_Time_Placeholder_Tag padded with spaces to a fixed size, to be replaced in place by post_process().
+        static const std::string Estimated_Printing_Time_Placeholder_Line;
 
         static const float Wipe_Width;
         static const float Wipe_Height;
@@ -250,11 +256,23 @@ namespace Slic3r {
             std::vector<float> filament_load_times;
             std::vector<float> filament_unload_times;
             std::array<TimeMachine, static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Count)> machines;
+            // file offset of the Estimated_Printing_Time_Placeholder_Line written by the streaming interface, npos if none
+            size_t estimated_time_placeholder_offset;
 
             void reset();
 
+            // Runs the planner of the enabled machines holding more than min_blocks blocks, see TimeMachine::calculate_time().
+            // The machines are independent, the normal and the stealth modes are calculated concurrently.
+            void calculate_time(size_t keep_last_n_blocks = 0, size_t min_blocks = 0);
+
             // post process the file with the given filename to add remaining time lines M73
             void post_process(const std::string& filename);
+
+        private:
+            // lines replacing Estimated_Printing_Time_Placeholder_Tag
+            std::string estimated_printing_time_lines() const;
+            // overwrites the placeholder slot at estimated_time_placeholder_offset, false if the file doesn't hold the slot there
+            bool patch_estimated_time_placeholder(const std::string& filename) const;
         };
 
     public:
@@ -278,6 +296,142 @@ namespace Slic3r {
             float volumetric_rate() const { return feedrate * mm3_per_mm; }
         };
 
+        // Storage of the moves of a Result, as a structure of arrays.
+        // The fields changing with every move (type, role, position, extrusion, feedrate, time) are stored per move,
+        // the fields changing only on transitions (extruder, color, width, height, fan speed, temperature...)
+        // are stored run-length encoded: a new run is started only when any of them changes.
+        // MoveVertex is the decoded view of a single move.
+        class MoveVertices
+        {
+        public:
+            // Fields shared by all the moves of a run.
+            struct Attributes
+            {
+                unsigned char extruder_id{ 0 };
+                unsigned char cp_color_id{ 0 };
+                float width{ 0.0f }; // mm
+                float height{ 0.0f }; // mm
+                float mm3_per_mm{ 0.0f };
+                float fan_speed{ 0.0f }; // percentage
+                float layer_duration{ 0.0f }; // s
+                float temperature{ 0.0f }; // deg
+
+                bool operator==(const Attributes& rhs) const {
+                    return extruder_id == rhs.extruder_id && cp_color_id == rhs.cp_color_id && width == rhs.width && height == rhs.height &&
+                        mm3_per_mm == rhs.mm3_per_mm && fan_speed == rhs.fan_speed && layer_duration == rhs.layer_duration && temperature == rhs.temperature;
+                }
+                bool operator!=(const Attributes& rhs) const { return !(*this == rhs); }
+            };
+
+            // Sequential access, keeps track of the current run to avoid searching for it at every move.
+            class const_iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = MoveVertex;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = const MoveVertex*;
+                using reference         = MoveVertex;
+
+                const_iterator(const MoveVertices* moves, size_t idx) : m_moves(moves), m_idx(idx), m_run((idx < moves->size()) ? moves->run_id(idx) : 0) {}
+
+                MoveVertex      operator*() const { return m_moves->get(m_idx, m_run); }
+                const_iterator& operator++() {
+                    if (++m_idx < m_moves->size() && m_run + 1 < m_moves->m_run_start.size() && m_moves->m_run_start[m_run + 1] <= m_idx)
+                        ++m_run;
+                    return *this;
+                }
+                bool operator==(const const_iterator& rhs) const { return m_idx == rhs.m_idx; }
+                bool operator!=(const const_iterator& rhs) const { return m_idx != rhs.m_idx; }
+
+            private:
+                const MoveVertices* m_moves;
+                size_t              m_idx;
+                size_t              m_run;
+            };
+
+            size_t size() const { return m_type.size(); }
+            bool   empty() const { return m_type.empty(); }
+            void   clear();
+            void   reserve(size_t n);
+            void   push_back(const MoveVertex& move);
+            void   emplace_back(const MoveVertex& move) { this->push_back(move); }
+
+            // Random access, the run containing the move is searched for.
+            MoveVertex operator[](size_t idx) const { return this->get(idx, this->run_id(idx)); }
+            MoveVertex back() const { return (*this)[this->size() - 1]; }
+
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, this->size()); }
+
+            // Per move fields, accessed without decoding the whole move.
+            EMoveType     type(size_t idx) const { return m_type[idx]; }
+            ExtrusionRole extrusion_role(size_t idx) const { return m_extrusion_role[idx]; }
+            const Vec3f&  position(size_t idx) const { return m_position[idx]; }
+            float         time(size_t idx) const { return m_time[idx]; }
+            const Attributes& attributes(size_t idx) const { return m_run_attributes[this->run_id(idx)]; }
+
+            // Number of runs of attributes.
+            size_t runs_count() const { return m_run_attributes.size(); }
+            // Calls fn(Attributes&) for each run, the adjacent runs are not merged back if they become equal.
+            template<typename Fn> void transform_attributes(Fn fn) { for (Attributes& attributes : m_run_attributes) fn(attributes); }
+
+            size_t memory_size() const;
+
+        private:
+            // Index of the run containing the move with the given index.
+            size_t     run_id(size_t idx) const;
+            MoveVertex get(size_t idx, size_t run) const;
+
+            std::vector<EMoveType>     m_type;
+            std::vector<ExtrusionRole> m_extrusion_role;
+            std::vector<Vec3f>         m_position;
+            std::vector<float>         m_delta_extruder;
+            std::vector<float>         m_feedrate;
+            std::vector<float>         m_time;
+            // Index of the first move of each run.
+            std::vector<uint32_t>      m_run_start;
+            std::vector<Attributes>    m_run_attributes;
+        };
+
+        // Range of the values taken by a field of the moves, used by the legends of the preview.
+        // count is 1 (or 2) when the field takes only one (or two) distinct values, it is greater otherwise.
+        struct ValuesRange
+        {
+            float min{ FLT_MAX };
+            float max{ -FLT_MAX };
+            unsigned int count{ 0 };
+
+            void update_from(const float value) {
+                if (value != max && value != min)
+                    ++count;
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+            // Merges the values of other, keeping count exact up to 2 distinct values.
+            void merge(const ValuesRange& other);
+            void reset() { min = FLT_MAX; max = -FLT_MAX; count = 0; }
+        };
+
+        // Ranges of the fields of the moves, computed once at the end of the processing
+        // so that the preview does not have to scan all the moves to build its legends.
+        struct MovesRanges
+        {
+            // Fields of the extrusion moves.
+            ValuesRange height;
+            ValuesRange width;
+            ValuesRange fan_speed;
+            ValuesRange volumetric_rate;
+            ValuesRange extruder_temp;
+            ValuesRange layer_duration;
+            ValuesRange elapsed_time;
+            // Feedrate, kept apart for the extrusion and the travel moves as the preview shows the ones of the visible moves only.
+            ValuesRange extrude_feedrate;
+            ValuesRange travel_feedrate;
+
+            void reset() { *this = MovesRanges(); }
+        };
+
         struct Result
         {
             struct SettingsIds
@@ -294,33 +448,52 @@ namespace Slic3r {
                 }
             };
             unsigned int id;
-            std::vector<MoveVertex> moves;
+            MoveVertices moves;
             Pointfs bed_shape;
             SettingsIds settings_ids;
             size_t extruders_count;
             std::vector<std::string> extruder_colors;
             std::vector<std::string> filament_colors;
             PrintEstimatedTimeStatistics time_statistics;
+            MovesRanges ranges;
+            // Volume of filament (mm3) extruded by each extruder, the weight and the cost are derived from it.
+            std::vector<double> extruded_volumes;
+
+            // Weight (g) and cost of the extruded filament for the given densities (g/cm3) and costs (per kg),
+            // computed without processing the G-code again when only these change.
+            std::pair<double, double> filament_weight_and_cost(const ConfigOptionFloats& density, const ConfigOptionFloats& cost) const {
+                std::pair<double, double> out{ 0., 0. };
+                for (size_t id = 0; id < extruded_volumes.size(); ++id) {
+                    double weight = extruded_volumes[id] * density.get_at(id) * 0.001;
+                    out.first  += weight;
+                    out.second += weight * cost.get_at(id) * 0.001;
+                }
+                return out;
+            }
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
             int64_t time{ 0 };
             void reset()
             {
                 time = 0;
-                moves = std::vector<MoveVertex>();
+                moves = MoveVertices();
                 bed_shape = Pointfs();
                 extruder_colors = std::vector<std::string>();
                 extruders_count = 0;
                 settings_ids.reset();
+                ranges.reset();
+                extruded_volumes.clear();
             }
 #else
             void reset()
             {
-                moves = std::vector<MoveVertex>();
+                moves = MoveVertices();
                 bed_shape = Pointfs();
                 extruder_colors = std::vector<std::string>();
                 extruders_count = 0;
                 settings_ids.reset();
+                ranges.reset();
+                extruded_volumes.clear();
             }
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
         };
@@ -454,6 +627,11 @@ namespace Slic3r {
         Result m_result;
         static unsigned int s_result_id;
 
+        // Last line of a buffer passed to process_buffer(), not terminated yet.
+        std::string m_streamed_line;
+        // Size of the gcode passed to process_buffer() so far.
+        size_t      m_streamed_size { 0 };
+
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
         DataChecker m_mm3_per_mm_compare{ "mm3_per_mm", 0.01f };
         DataChecker m_height_compare{ "height", 0.01f };
@@ -461,6 +639,24 @@ namespace Slic3r {
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
 
     public:
+        struct LayerIndexEntry
+        {
+            // Offset of the layer change line in the file.
+            size_t offset;
+            // From the ;Z: tag following the layer change, 0 if there is none.
+            float  z{ 0.0f };
+            // Number of lines, starting with the layer change, and of G0 - G3 moves of the layer.
+            size_t lines{ 1 };
+            size_t moves{ 0 };
+        };
+
+        // Scans the file for the layer changes without parsing the moves, much faster than process_file(),
+        // to load the layers of a large file on demand.
+        static std::vector<LayerIndexEntry> scan_layers(const std::string& filename);
+
+        // Rounds value to the given number of significant digits, as shown by the legends of the preview.
+        static float round_to_nearest(float value, unsigned int decimals);
+
         GCodeProcessor();
 
         void apply_config(const PrintConfig& config);
@@ -478,9 +674,17 @@ namespace Slic3r {
 
         // Process the gcode contained in the file with the given filename
         // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
-        void process_file(const std::string& filename, bool apply_postprocess, std::function<void()> cancel_callback = nullptr);
+        // Only the lines starting before max_offset are processed, for example the first layers up to an offset given by scan_layers().
+        void process_file(const std::string& filename, bool apply_postprocess, std::function<void()> cancel_callback = nullptr, size_t max_offset = size_t(-1));
         void process_string(const std::string& gcode, std::function<void()> cancel_callback = nullptr);
 
+        // Process the gcode while it is being written, instead of parsing the written file again.
+        // Call start_streaming(), then process_buffer() with the consecutive chunks of the gcode as written into the file,
+        // then finish_streaming() once the file is closed. The chunks don't need to end at the end of a line.
+        void start_streaming();
+        void process_buffer(const std::string& buffer);
+        void finish_streaming(const std::string& filename, bool apply_postprocess);
+
         float get_time(PrintEstimatedTimeStatistics::ETimeMode mode) const;
         std::string get_time_dhm(PrintEstimatedTimeStatistics::ETimeMode mode) const;
         std::vector<std::pair<CustomGCode::Type, std::pair<float, float>>> get_custom_gcode_times(PrintEstimatedTimeStatistics::ETimeMode mode, bool include_remaining) const;
@@ -490,6 +694,10 @@ namespace Slic3r {
         std::vector<float> get_layers_time(PrintEstimatedTimeStatistics::ETimeMode mode) const;
 
     private:
+        // Called before / after parsing the gcode by process_file() or by the streaming interface.
+        void start_processing();
+        void finish_processing(const std::string& filename, bool apply_postprocess);
+
         void process_gcode_line(const GCodeReader::GCodeLine& line);
 
         // Process tags embedded into comments
@@ -616,6 +824,8 @@ namespace Slic3r {
         void simulate_st_synchronize(float additional_time = 0.0f);
 
         void update_estimated_times_stats();
+        // Fills m_result.ranges from the moves, once their times and layer durations are final.
+        void update_moves_ranges();
    };
 
 } /* namespace Slic3r */
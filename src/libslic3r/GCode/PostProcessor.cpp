@@ -1,10 +1,13 @@
 #include "PostProcessor.hpp"
+#include "CompressedGCode.hpp"
+#include "../Utils.hpp"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/nowide/convert.hpp>
+#include <boost/nowide/cstdio.hpp>
 
 #ifdef WIN32
 
@@ -179,7 +182,7 @@ static int run_script(const std::string &script, const std::string &gcode, std::
 
 namespace Slic3r {
 
-void run_post_process_scripts(const std::string &path, const DynamicPrintConfig &config)
+static void run_scripts(const std::string &path, const DynamicPrintConfig &config)
 {
     const auto* post_process = config.opt<ConfigOptionStrings>("post_process");
     if (// likely running in SLA mode
@@ -216,4 +219,21 @@ void run_post_process_scripts(const std::string &path, const DynamicPrintConfig
     }
 }
 
+void run_post_process_scripts(const std::string &path, const DynamicPrintConfig &config, bool compress)
+{
+    run_scripts(path, config);
+
+    // The compression comes last, the scripts expect the G-code text.
+    const auto *compression = config.opt<ConfigOptionBool>("gcode_compression");
+    if (compress && compression != nullptr && compression->value) {
+        BOOST_LOG_TRIVIAL(info) << "Compressing the G-code file " << path;
+        const std::string path_tmp = path + ".tmp";
+        compress_gcode_file(path, path_tmp);
+        if (rename_file(path_tmp, path)) {
+            boost::nowide::remove(path_tmp.c_str());
+            throw Slic3r::RuntimeError(std::string("Failed to rename the compressed G-code file from ") + path_tmp + " to " + path);
+        }
+    }
+}
+
 } // namespace Slic3r
@@ -8,7 +8,8 @@
 
 namespace Slic3r {
 
-extern void run_post_process_scripts(const std::string &path, const DynamicPrintConfig &config);
+// Runs the post-processing scripts over the exported G-code, then compresses it if gcode_compression is enabled and compress is set.
+extern void run_post_process_scripts(const std::string &path, const DynamicPrintConfig &config, bool compress = true);
 
 } // namespace Slic3r
 
@@ -7,6 +7,8 @@
 
 #include "PressureEqualizer.hpp"
 
+#include <boost/log/trivial.hpp>
+
 namespace Slic3r {
 
 PressureEqualizer::PressureEqualizer(const Slic3r::GCodeConfig *config) : 
@@ -115,15 +117,11 @@ const char* PressureEqualizer::process(const char *szGCode, bool flush)
         assert(circular_buffer_items == 0);
         circular_buffer_pos = 0;
 
-#if 1 
-        printf("Statistics: \n"); 
-        printf("Minimum volumetric extrusion rate: %f\n", m_stat.volumetric_extrusion_rate_min);
-        printf("Maximum volumetric extrusion rate: %f\n", m_stat.volumetric_extrusion_rate_max);
         if (m_stat.extrusion_length > 0)
             m_stat.volumetric_extrusion_rate_avg /= m_stat.extrusion_length;
-        printf("Average volumetric extrusion rate: %f\n", m_stat.volumetric_extrusion_rate_avg);
+        BOOST_LOG_TRIVIAL(debug) << "PressureEqualizer statistics: volumetric extrusion rate min " << m_stat.volumetric_extrusion_rate_min
+            << ", max " << m_stat.volumetric_extrusion_rate_max << ", average " << m_stat.volumetric_extrusion_rate_avg;
         m_stat.reset();
-#endif
     } 
 
     return output_buffer.data();
@@ -265,14 +263,6 @@ bool PressureEqualizer::process_line(const char *line, const size_t len, GCodeLi
                     buf.volumetric_extrusion_rate_start = rate;
                     buf.volumetric_extrusion_rate_end   = rate;
                     m_stat.update(rate, sqrt(len2));
-                    if (rate < 40.f) {
-                    	printf("Extremely low flow rate: %f. Line %d, Length: %f, extrusion: %f Old position: (%f, %f, %f), new position: (%f, %f, %f)\n", 
-                            rate, 
-                            int(line_idx),
-                            sqrt(len2), sqrt((diff[3]*diff[3])/len2),
-                            m_current_pos[0], m_current_pos[1], m_current_pos[2],
-                            new_pos[0], new_pos[1], new_pos[2]);
-                    }
                 }
             } else if (changed[0] || changed[1] || changed[2]) {
                 // Moving without extrusion.
@@ -54,7 +54,7 @@ private:
         float positive;
         float negative;
     };
-    enum { numExtrusionRoles = erSupportMaterialInterface + 1 };
+    enum { numExtrusionRoles = erCount };
     ExtrusionRateSlope              m_max_volumetric_extrusion_rate_slopes[numExtrusionRoles];
     float                           m_max_volumetric_extrusion_rate_slope_positive;
     float                           m_max_volumetric_extrusion_rate_slope_negative;
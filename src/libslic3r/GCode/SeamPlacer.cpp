@@ -9,6 +9,10 @@
 #include "libslic3r/SVG.hpp"
 #include "libslic3r/Layer.hpp"
 
+#include <boost/functional/hash.hpp>
+
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 // This penalty is added to all points inside custom blockers (subtracted from pts inside enforcers).
@@ -190,79 +194,93 @@ static std::vector<float> polygon_angles_at_vertices(const Polygon &polygon, con
 
 
 
-void SeamPlacer::init(const Print& print)
+uint64_t SeamPlacer::custom_seam_triangles_key(const PrintObject& po, float max_nozzle_dmr)
 {
-    m_enforcers.clear();
-    m_blockers.clear();
-    m_seam_history.clear();
-    m_po_list.clear();
+    size_t seed = 0;
+    bool   painted = false;
+    for (const ModelVolume* mv : po.model_object()->volumes) {
+        if (! mv->is_model_part() || mv->seam_facets.empty())
+            continue;
+        painted = true;
+        // The timestamp changes with each stroke of the seam painting gizmo.
+        boost::hash_combine(seed, mv->id().id);
+        boost::hash_combine(seed, mv->seam_facets.timestamp());
+        const Transform3d& m = mv->get_matrix();
+        boost::hash_range(seed, m.data(), m.data() + 16);
+        const indexed_triangle_set& its = mv->mesh().its;
+        for (const stl_vertex& v : its.vertices)
+            boost::hash_range(seed, v.data(), v.data() + 3);
+        for (const stl_triangle_vertex_indices& f : its.indices)
+            boost::hash_range(seed, f.data(), f.data() + 3);
+    }
+    // Nothing painted, nothing to project. Zero is never produced by the hash of a painted object in practice.
+    if (! painted)
+        return 0;
+    const Transform3d& trafo = po.trafo();
+    boost::hash_range(seed, trafo.data(), trafo.data() + 16);
+    boost::hash_combine(seed, po.center_offset().x());
+    boost::hash_combine(seed, po.center_offset().y());
+    boost::hash_combine(seed, po.layers().size());
+    for (const Layer* layer : po.layers())
+        boost::hash_combine(seed, layer->slice_z);
+    boost::hash_combine(seed, max_nozzle_dmr);
+    boost::hash_combine(seed, po.config().first_layer_size_compensation.value);
+    return uint64_t(seed);
+}
+
 
-   const std::vector<double>& nozzle_dmrs = print.config().nozzle_diameter.values;
-   float max_nozzle_dmr = *std::max_element(nozzle_dmrs.begin(), nozzle_dmrs.end());
 
+std::shared_ptr<const CustomSeamTriangles> SeamPlacer::compute_custom_seam_triangles(const PrintObject& po, float max_nozzle_dmr, uint64_t key)
+{
+    auto out = std::make_shared<CustomSeamTriangles>();
+    out->key = key;
+    if (key == 0)
+        return out;
 
     std::vector<ExPolygons> temp_enf;
     std::vector<ExPolygons> temp_blk;
+    po.project_and_append_custom_facets(true, EnforcerBlockerType::ENFORCER, temp_enf);
+    po.project_and_append_custom_facets(true, EnforcerBlockerType::BLOCKER, temp_blk);
+    out->enforcers.assign(temp_enf.size(), CustomTrianglesPerLayer());
+    out->blockers.assign(temp_blk.size(), CustomTrianglesPerLayer());
+
+    // A helper class to store data to build the AABB tree from.
+    class CustomTriangleRef {
+    public:
+        CustomTriangleRef(size_t idx,
+                          Point&& centroid,
+                          BoundingBox&& bb)
+            : m_idx{idx}, m_centroid{centroid},
+              m_bbox{AlignedBoxType(bb.min, bb.max)}
+        {}
+        size_t idx() const              { return m_idx;      }
+        const Point& centroid() const   { return m_centroid; }
+        const TreeType::BoundingBox& bbox() const { return m_bbox; }
+
+    private:
+        size_t m_idx;
+        Point m_centroid;
+        AlignedBoxType m_bbox;
+    };
 
-    for (const PrintObject* po : print.objects()) {
-        temp_enf.clear();
-        temp_blk.clear();
-        po->project_and_append_custom_facets(true, EnforcerBlockerType::ENFORCER, temp_enf);
-        po->project_and_append_custom_facets(true, EnforcerBlockerType::BLOCKER, temp_blk);
-
-        // Offset the triangles out slightly.
-        for (auto* custom_per_object : {&temp_enf, &temp_blk}) {
-            float offset = max_nozzle_dmr - po->config().first_layer_size_compensation;
-            for (ExPolygons& explgs : *custom_per_object) {
-                explgs = Slic3r::offset_ex(explgs, scale_(offset));
-                offset = max_nozzle_dmr;
-            }
-        }
-
+    // Offset the triangles out slightly, then extract the ExPolygons and save them into the AABB tree of their layer.
+    // Called for enforcers and blockers separately, each layer is independent of the others.
+    auto add_custom = [&po, max_nozzle_dmr](std::vector<ExPolygons>& src, std::vector<CustomTrianglesPerLayer>& dest) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, src.size()),
+            [&po, max_nozzle_dmr, &src, &dest](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                ExPolygons& expolys_on_layer = src[layer_idx];
+                if (expolys_on_layer.empty())
+                    continue;
+                float offset = layer_idx == 0 ? max_nozzle_dmr - float(po.config().first_layer_size_compensation) : max_nozzle_dmr;
+                expolys_on_layer = Slic3r::offset_ex(expolys_on_layer, scale_(offset));
 //     FIXME: Offsetting should be done somehow cheaper, but following does not work
-//        for (auto* custom_per_object : {&temp_enf, &temp_blk}) {
-//            for (ExPolygons& plgs : *custom_per_object) {
-//                for (ExPolygon& plg : plgs) {
+//                for (ExPolygon& plg : expolys_on_layer) {
 //                    auto out = Slic3r::offset_ex(plg, scale_(max_nozzle_dmr));
 //                    plg = out.empty() ? ExPolygon() : out.front();
 //                    assert(out.empty() || out.size() == 1);
 //                }
-//            }
-//        }
-
-
-
-        // Remember this PrintObject and initialize a store of enforcers and blockers for it.
-        m_po_list.push_back(po);
-        size_t po_idx = m_po_list.size() - 1;
-        m_enforcers.emplace_back(std::vector<CustomTrianglesPerLayer>(temp_enf.size()));
-        m_blockers.emplace_back(std::vector<CustomTrianglesPerLayer>(temp_blk.size()));
-
-        // A helper class to store data to build the AABB tree from.
-        class CustomTriangleRef {
-        public:
-            CustomTriangleRef(size_t idx,
-                              Point&& centroid,
-                              BoundingBox&& bb)
-                : m_idx{idx}, m_centroid{centroid},
-                  m_bbox{AlignedBoxType(bb.min, bb.max)}
-            {}
-            size_t idx() const              { return m_idx;      }
-            const Point& centroid() const   { return m_centroid; }
-            const TreeType::BoundingBox& bbox() const { return m_bbox; }
-
-        private:
-            size_t m_idx;
-            Point m_centroid;
-            AlignedBoxType m_bbox;
-        };
-
-        // A lambda to extract the ExPolygons and save them into the member AABB tree.
-        // Will be called for enforcers and blockers separately.
-        auto add_custom = [](std::vector<ExPolygons>& src, std::vector<CustomTrianglesPerLayer>& dest) {
-            // Go layer by layer, and append all the ExPolygons into the AABB tree.
-            size_t layer_idx = 0;
-            for (ExPolygons& expolys_on_layer : src) {
+
                 CustomTrianglesPerLayer& layer_data = dest[layer_idx];
                 std::vector<CustomTriangleRef> triangles_data;
                 layer_data.polys.reserve(expolys_on_layer.size());
@@ -278,13 +296,43 @@ void SeamPlacer::init(const Print& print)
                 }
                 // All polygons are saved, build the AABB tree for them.
                 layer_data.tree.build(std::move(triangles_data));
-                ++layer_idx;
             }
-        };
+        });
+    };
 
-        add_custom(temp_enf, m_enforcers.at(po_idx));
-        add_custom(temp_blk, m_blockers.at(po_idx));
-    }
+    add_custom(temp_enf, out->enforcers);
+    add_custom(temp_blk, out->blockers);
+    return out;
+}
+
+
+
+void SeamPlacer::init(const Print& print)
+{
+    m_custom_seams.clear();
+    m_seam_history.clear();
+    m_po_list.clear();
+
+    const std::vector<double>& nozzle_dmrs = print.config().nozzle_diameter.values;
+    float max_nozzle_dmr = float(*std::max_element(nozzle_dmrs.begin(), nozzle_dmrs.end()));
+
+    // Remember the PrintObjects, reuse the enforcers and blockers cached on those whose seam painting, meshes and layers did not change.
+    // This is called again for each object of a sequential print, then all the objects hit their caches.
+    m_po_list.assign(print.objects().begin(), print.objects().end());
+    m_custom_seams.assign(m_po_list.size(), nullptr);
+    std::vector<uint64_t> keys(m_po_list.size(), 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_po_list.size()),
+        [this, max_nozzle_dmr, &keys](const tbb::blocked_range<size_t>& range) {
+        for (size_t po_idx = range.begin(); po_idx < range.end(); ++ po_idx) {
+            const PrintObject& po = *m_po_list[po_idx];
+            keys[po_idx] = custom_seam_triangles_key(po, max_nozzle_dmr);
+            if (po.m_custom_seam_triangles && po.m_custom_seam_triangles->key == keys[po_idx])
+                m_custom_seams[po_idx] = po.m_custom_seam_triangles;
+            else
+                // The projection is parallel over the triangles, the offsetting over the layers.
+                m_custom_seams[po_idx] = po.m_custom_seam_triangles = compute_custom_seam_triangles(po, max_nozzle_dmr, keys[po_idx]);
+        }
+    });
 
     this->external_perimeters_first = print.default_region_config().external_perimeters_first;
 }
@@ -708,8 +756,9 @@ void SeamPlacer::get_enforcers_and_blockers(size_t layer_id,
         return false;
     };
 
-    if (! m_enforcers[po_idx].empty()) {
-        const CustomTrianglesPerLayer& enforcers = m_enforcers[po_idx][layer_id];
+    const CustomSeamTriangles& custom_seams = *m_custom_seams[po_idx];
+    if (! custom_seams.enforcers.empty()) {
+        const CustomTrianglesPerLayer& enforcers = custom_seams.enforcers[layer_id];
         if (! enforcers.polys.empty()) {
     for (size_t i=0; i<polygon.points.size(); ++i) {
                 if (is_inside(polygon.points[i], enforcers))
@@ -718,8 +767,8 @@ void SeamPlacer::get_enforcers_and_blockers(size_t layer_id,
         }
     }
 
-    if (! m_blockers[po_idx].empty()) {
-        const CustomTrianglesPerLayer& blockers = m_blockers[po_idx][layer_id];
+    if (! custom_seams.blockers.empty()) {
+        const CustomTrianglesPerLayer& blockers = custom_seams.blockers[layer_id];
         if (! blockers.polys.empty()) {
             for (size_t i=0; i<polygon.points.size(); ++i) {
                 if (is_inside(polygon.points[i], blockers))
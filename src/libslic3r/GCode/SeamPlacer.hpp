@@ -1,6 +1,7 @@
 #ifndef libslic3r_SeamPlacer_hpp_
 #define libslic3r_SeamPlacer_hpp_
 
+#include <memory>
 #include <optional>
 
 #include "libslic3r/Polygon.hpp"
@@ -16,6 +17,20 @@ class Print;
 class Layer;
 namespace EdgeGrid { class Grid; }
 
+// Custom seam enforcers and blockers of a PrintObject projected onto its layers, offset and indexed for the point queries.
+// Computed by SeamPlacer::init() and cached on the PrintObject, as it only depends on the seam painting,
+// the meshes and the layers, not on the rest of the configuration.
+struct CustomSeamTriangles {
+    using TreeType = AABBTreeIndirect::Tree<2, coord_t>;
+    struct PerLayer {
+        Polygons polys;
+        TreeType tree;
+    };
+    // Hash of the inputs, see SeamPlacer::custom_seam_triangles_key().
+    uint64_t                key { 0 };
+    std::vector<PerLayer>   enforcers;
+    std::vector<PerLayer>   blockers;
+};
 
 class SeamHistory {
 public:
@@ -46,15 +61,12 @@ public:
                    coordf_t nozzle_diameter, const PrintObject* po,
                    bool was_clockwise, const EdgeGrid::Grid* lower_layer_edge_grid);
 
-    using TreeType = AABBTreeIndirect::Tree<2, coord_t>;
+    using TreeType = CustomSeamTriangles::TreeType;
     using AlignedBoxType = Eigen::AlignedBox<TreeType::CoordType, TreeType::NumDimensions>;
 
 private:
 
-    struct CustomTrianglesPerLayer {
-        Polygons polys;
-        TreeType tree;
-    };
+    using CustomTrianglesPerLayer = CustomSeamTriangles::PerLayer;
 
     // Just a cache to save some lookups.
     const Layer* m_last_layer_po = nullptr;
@@ -63,8 +75,8 @@ private:
 
     bool m_last_loop_was_external = true;
 
-    std::vector<std::vector<CustomTrianglesPerLayer>> m_enforcers;
-    std::vector<std::vector<CustomTrianglesPerLayer>> m_blockers;
+    // Shared with the PrintObjects of m_po_list, which keep them for the next export.
+    std::vector<std::shared_ptr<const CustomSeamTriangles>> m_custom_seams;
     std::vector<const PrintObject*> m_po_list;
 
     //std::map<const PrintObject*, Point>  m_last_seam_position;
@@ -73,6 +85,11 @@ private:
     // if it's expected, we need to randomized at the external periemter.
     bool external_perimeters_first;
 
+    // Hash of everything the projected enforcers and blockers of a PrintObject depend on.
+    static uint64_t custom_seam_triangles_key(const PrintObject& po, float max_nozzle_dmr);
+    // Project the painted seam facets of a PrintObject onto its layers, offset them and build the AABB trees, in parallel over the layers.
+    static std::shared_ptr<const CustomSeamTriangles> compute_custom_seam_triangles(const PrintObject& po, float max_nozzle_dmr, uint64_t key);
+
     // Get indices of points inside enforcers and blockers.
     void get_enforcers_and_blockers(size_t layer_id,
                                     const Polygon& polygon,
@@ -98,11 +115,13 @@ private:
     }
 
     bool is_custom_enforcer_on_layer(size_t layer_id, size_t po_idx) const {
-        return (! m_enforcers.at(po_idx).empty() && ! m_enforcers.at(po_idx)[layer_id].polys.empty());
+        const std::vector<CustomTrianglesPerLayer>& enforcers = m_custom_seams.at(po_idx)->enforcers;
+        return (! enforcers.empty() && ! enforcers[layer_id].polys.empty());
     }
 
     bool is_custom_blocker_on_layer(size_t layer_id, size_t po_idx) const {
-        return (! m_blockers.at(po_idx).empty() && ! m_blockers.at(po_idx)[layer_id].polys.empty());
+        const std::vector<CustomTrianglesPerLayer>& blockers = m_custom_seams.at(po_idx)->blockers;
+        return (! blockers.empty() && ! blockers[layer_id].polys.empty());
     }
 };
 
@@ -1,5 +1,7 @@
 #include "ThumbnailData.hpp"
 
+#include <algorithm>
+
 namespace Slic3r {
 
 void ThumbnailData::set(unsigned int w, unsigned int h)
@@ -28,4 +30,38 @@ bool ThumbnailData::is_valid() const
     return (width != 0) && (height != 0) && ((unsigned int)pixels.size() == 4 * width * height);
 }
 
+ThumbnailData downscaled(const ThumbnailData &src, unsigned int w, unsigned int h)
+{
+    ThumbnailData out;
+    if (! src.is_valid() || w == 0 || h == 0 || w > src.width || h > src.height)
+        return out;
+
+    out.set(w, h);
+    for (unsigned int r = 0; r < h; ++ r) {
+        // Source rows and columns with their centers inside of the target pixel.
+        unsigned int r_begin = (r * src.height) / h;
+        unsigned int r_end   = std::max(r_begin + 1, ((r + 1) * src.height) / h);
+        for (unsigned int c = 0; c < w; ++ c) {
+            unsigned int c_begin = (c * src.width) / w;
+            unsigned int c_end   = std::max(c_begin + 1, ((c + 1) * src.width) / w);
+            double rgb[3] = { 0., 0., 0. };
+            double alpha  = 0.;
+            for (unsigned int sr = r_begin; sr < r_end; ++ sr)
+                for (unsigned int sc = c_begin; sc < c_end; ++ sc) {
+                    const unsigned char *px = &src.pixels[4 * (sr * src.width + sc)];
+                    double a = px[3];
+                    for (int i = 0; i < 3; ++ i)
+                        rgb[i] += a * px[i];
+                    alpha += a;
+                }
+            unsigned char *px = &out.pixels[4 * (r * w + c)];
+            size_t count = size_t(r_end - r_begin) * size_t(c_end - c_begin);
+            for (int i = 0; i < 3; ++ i)
+                px[i] = (alpha > 0.) ? (unsigned char)(rgb[i] / alpha + 0.5) : 0;
+            px[3] = (unsigned char)(alpha / double(count) + 0.5);
+        }
+    }
+    return out;
+}
+
 } // namespace Slic3r
@@ -21,6 +21,10 @@ struct ThumbnailData
 
 using ThumbnailsList = std::vector<ThumbnailData>;
 
+// Downscale the RGBA thumbnail to w x h by averaging the source pixels covered by each target pixel,
+// weighted by their alpha. w and h shall not be larger than the source size.
+ThumbnailData downscaled(const ThumbnailData &src, unsigned int w, unsigned int h);
+
 struct ThumbnailsParams
 {
     const Vec2ds    sizes;
@@ -0,0 +1,245 @@
+#include "ThumbnailRenderer.hpp"
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace Slic3r {
+
+namespace {
+
+// Same lighting as the gouraud_light shader, the light directions are in eye space.
+const Vec3f LIGHT_TOP_DIR(-0.4574957f, 0.4574957f, 0.7624929f);
+const Vec3f LIGHT_FRONT_DIR(0.6985074f, 0.1397015f, 0.6985074f);
+const float INTENSITY_CORRECTION = 0.6f;
+const float LIGHT_TOP_DIFFUSE    = 0.8f * INTENSITY_CORRECTION;
+const float LIGHT_FRONT_DIFFUSE  = 0.3f * INTENSITY_CORRECTION;
+const float INTENSITY_AMBIENT    = 0.3f;
+
+// Same as Camera::DefaultZoomToBoxMarginFactor.
+const float ZOOM_TO_BOX_MARGIN_FACTOR = 1.025f;
+
+// Rows of the thumbnail rasterized by a single task.
+const int BAND_HEIGHT = 16;
+
+using Color = std::array<float, 3>;
+
+const Color DEFAULT_COLOR = { 1.0f, 0.5f, 0.0f };
+const Color BED_COLOR     = { 0.7f, 0.7f, 0.7f };
+
+// Triangle in eye space, counter-clockwise when looking from the camera.
+struct Triangle
+{
+    std::array<Vec3f, 3> v;
+    std::array<unsigned char, 3> rgb;
+};
+
+bool parse_color(const std::string &str, Color &color)
+{
+    if (str.size() != 7 || str.front() != '#')
+        return false;
+    char *end = nullptr;
+    long  rgb = std::strtol(str.c_str() + 1, &end, 16);
+    if (end != str.c_str() + 7)
+        return false;
+    color = { float((rgb >> 16) & 0xFF) / 255.f, float((rgb >> 8) & 0xFF) / 255.f, float(rgb & 0xFF) / 255.f };
+    return true;
+}
+
+// Color of the volumes printed with the given extruder, the extruder color takes precedence
+// over the filament color as in the 3D scene.
+Color extruder_color(const PrintConfig &config, int extruder_id)
+{
+    Color color = DEFAULT_COLOR;
+    size_t idx = size_t(std::max(0, extruder_id - 1));
+    if ((idx >= config.extruder_colour.values.size() || ! parse_color(config.extruder_colour.values[idx], color)) &&
+        idx < config.filament_colour.values.size())
+        parse_color(config.filament_colour.values[idx], color);
+    return color;
+}
+
+class Scene
+{
+public:
+    Scene()
+    {
+        // Iso view of Camera::set_default_orientation().
+        m_rotation = (Eigen::AngleAxisf(float(-0.25 * PI), Vec3f::UnitX()) * Eigen::AngleAxisf(float(0.25 * PI), Vec3f::UnitZ())).toRotationMatrix();
+    }
+
+    // Adds the triangles facing the camera. Double sided triangles are flipped instead of being culled.
+    void add(const indexed_triangle_set &its, const Transform3d &trafo, const Color &color, bool double_sided, bool fit)
+    {
+        Transform3f t = trafo.cast<float>();
+        // Mirroring flips the orientation of the faces.
+        bool flip = t.matrix().block<3, 3>(0, 0).determinant() < 0.f;
+        m_triangles.reserve(m_triangles.size() + its.indices.size());
+        for (const stl_triangle_vertex_indices &face : its.indices) {
+            Triangle tri;
+            for (int i = 0; i < 3; ++ i)
+                tri.v[flip ? 2 - i : i] = m_rotation * (t * its.vertices[face(i)]);
+            Vec3f normal = (tri.v[1] - tri.v[0]).cross(tri.v[2] - tri.v[0]);
+            if (normal.z() <= 0.f) {
+                if (! double_sided || normal.z() == 0.f)
+                    continue;
+                std::swap(tri.v[1], tri.v[2]);
+                normal = - normal;
+            }
+            normal.normalize();
+            float intensity = INTENSITY_AMBIENT + LIGHT_TOP_DIFFUSE * std::max(0.f, normal.dot(LIGHT_TOP_DIR)) +
+                              LIGHT_FRONT_DIFFUSE * std::max(0.f, normal.dot(LIGHT_FRONT_DIR));
+            for (int i = 0; i < 3; ++ i)
+                tri.rgb[i] = (unsigned char)std::lround(255.f * std::clamp(color[i] * intensity, 0.f, 1.f));
+            if (fit)
+                for (const Vec3f &v : tri.v)
+                    m_box.extend(v.head<2>());
+            m_triangles.emplace_back(tri);
+        }
+    }
+
+    // Nothing to zoom to.
+    bool empty() const { return m_triangles.empty() || m_box.isEmpty(); }
+
+    ThumbnailData render(unsigned int width, unsigned int height, bool transparent_background) const
+    {
+        ThumbnailData thumbnail;
+        thumbnail.set(width, height);
+        if (! thumbnail.is_valid() || this->empty())
+            return thumbnail;
+
+        // Orthographic projection zoomed to the fitted box, the pixel centers are at half integers.
+        Vec2f size   = m_box.sizes().cwiseMax(Vec2f(EPSILON, EPSILON));
+        float scale  = std::min(float(width) / size.x(), float(height) / size.y()) / ZOOM_TO_BOX_MARGIN_FACTOR;
+        Vec2f center = m_box.center();
+        Vec2f offset = Vec2f(0.5f * float(width), 0.5f * float(height)) - scale * center;
+
+        // Sort the triangles into the bands of rows they cover.
+        int num_bands = (int(height) + BAND_HEIGHT - 1) / BAND_HEIGHT;
+        std::vector<std::vector<size_t>> bands(num_bands);
+        for (size_t i = 0; i < m_triangles.size(); ++ i) {
+            const Triangle &tri = m_triangles[i];
+            float ymin = std::min({ tri.v[0].y(), tri.v[1].y(), tri.v[2].y() }) * scale + offset.y();
+            float ymax = std::max({ tri.v[0].y(), tri.v[1].y(), tri.v[2].y() }) * scale + offset.y();
+            int   from = std::max(0, int(std::floor(ymin - 0.5f)) / BAND_HEIGHT);
+            int   to   = std::min(num_bands - 1, int(std::ceil(ymax - 0.5f)) / BAND_HEIGHT);
+            for (int b = from; b <= to; ++ b)
+                bands[b].emplace_back(i);
+        }
+
+        // Rows are stored bottom-up as returned by glReadPixels().
+        std::vector<unsigned char> &pixels = thumbnail.pixels;
+        tbb::parallel_for(tbb::blocked_range<int>(0, num_bands), [&](const tbb::blocked_range<int> &range) {
+            std::vector<float> depth;
+            for (int b = range.begin(); b < range.end(); ++ b) {
+                int row_from = b * BAND_HEIGHT;
+                int row_to   = std::min(int(height), row_from + BAND_HEIGHT);
+                depth.assign(size_t(row_to - row_from) * width, - std::numeric_limits<float>::max());
+                unsigned char background = transparent_background ? 0 : 255;
+                std::fill(pixels.begin() + size_t(row_from) * width * 4, pixels.begin() + size_t(row_to) * width * 4, background);
+
+                for (size_t idx : bands[b]) {
+                    const Triangle &tri = m_triangles[idx];
+                    std::array<Vec2f, 3> p;
+                    for (int i = 0; i < 3; ++ i)
+                        p[i] = scale * tri.v[i].head<2>() + offset;
+                    auto edge = [](const Vec2f &a, const Vec2f &b, float x, float y) {
+                        return (b.x() - a.x()) * (y - a.y()) - (b.y() - a.y()) * (x - a.x());
+                    };
+                    float area = edge(p[0], p[1], p[2].x(), p[2].y());
+                    if (area <= 0.f)
+                        continue;
+                    float inv_area = 1.f / area;
+                    int x0 = std::max(0, int(std::floor(std::min({ p[0].x(), p[1].x(), p[2].x() }) - 0.5f)));
+                    int x1 = std::min(int(width) - 1, int(std::ceil(std::max({ p[0].x(), p[1].x(), p[2].x() }) - 0.5f)));
+                    int y0 = std::max(row_from, int(std::floor(std::min({ p[0].y(), p[1].y(), p[2].y() }) - 0.5f)));
+                    int y1 = std::min(row_to - 1, int(std::ceil(std::max({ p[0].y(), p[1].y(), p[2].y() }) - 0.5f)));
+                    for (int y = y0; y <= y1; ++ y) {
+                        float py = float(y) + 0.5f;
+                        for (int x = x0; x <= x1; ++ x) {
+                            float px = float(x) + 0.5f;
+                            float w0 = edge(p[1], p[2], px, py);
+                            float w1 = edge(p[2], p[0], px, py);
+                            float w2 = edge(p[0], p[1], px, py);
+                            if (w0 < 0.f || w1 < 0.f || w2 < 0.f)
+                                continue;
+                            // Larger z is closer to the camera.
+                            float  z = (w0 * tri.v[0].z() + w1 * tri.v[1].z() + w2 * tri.v[2].z()) * inv_area;
+                            size_t i = size_t(y - row_from) * width + size_t(x);
+                            if (z <= depth[i])
+                                continue;
+                            depth[i] = z;
+                            unsigned char *px_data = pixels.data() + (size_t(y) * width + size_t(x)) * 4;
+                            px_data[0] = tri.rgb[0];
+                            px_data[1] = tri.rgb[1];
+                            px_data[2] = tri.rgb[2];
+                            px_data[3] = 255;
+                        }
+                    }
+                }
+            }
+        });
+        return thumbnail;
+    }
+
+private:
+    Eigen::Matrix3f                 m_rotation;
+    std::vector<Triangle>           m_triangles;
+    // Box of the triangles to zoom to, in eye space.
+    Eigen::AlignedBox<float, 2>     m_box;
+};
+
+} // namespace
+
+ThumbnailsList render_thumbnails(const Print &print, const ThumbnailsParams &params)
+{
+    const PrintConfig &config = print.config();
+
+    Color custom_color;
+    bool  use_custom_color = config.thumbnails_custom_color.value && parse_color(config.thumbnails_color.value, custom_color);
+
+    Scene scene;
+    for (const PrintObject *object : print.objects()) {
+        const ModelObject *model_object = object->model_object();
+        for (const PrintInstance &instance : object->instances()) {
+            if (params.printable_only && ! instance.model_instance->printable)
+                continue;
+            for (const ModelVolume *volume : model_object->volumes) {
+                if (params.parts_only && ! volume->is_model_part())
+                    continue;
+                Color color = use_custom_color ? custom_color : extruder_color(config, volume->extruder_id());
+                scene.add(volume->mesh().its, instance.model_instance->get_matrix() * volume->get_matrix(), color, false, true);
+            }
+        }
+    }
+
+    if (params.show_bed && config.bed_shape.values.size() >= 3) {
+        // The bed is a flat fan at z = 0, it does not contribute to the zoom as in the 3D scene.
+        indexed_triangle_set bed;
+        for (const Vec2d &pt : config.bed_shape.values)
+            bed.vertices.emplace_back(float(pt.x()), float(pt.y()), 0.f);
+        for (int i = 1; i + 1 < int(bed.vertices.size()); ++ i)
+            bed.indices.emplace_back(0, i, i + 1);
+        scene.add(bed, Transform3d::Identity(), BED_COLOR, true, false);
+    }
+
+    if (scene.empty())
+        return ThumbnailsList();
+
+    ThumbnailsList thumbnails(params.sizes.size());
+    tbb::parallel_for(size_t(0), params.sizes.size(), [&](size_t i) {
+        const Vec2d &size = params.sizes[i];
+        if (size.x() > 0 && size.y() > 0)
+            thumbnails[i] = scene.render((unsigned int)size.x(), (unsigned int)size.y(), params.transparent_background);
+    });
+    return thumbnails;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,18 @@
+#ifndef slic3r_ThumbnailRenderer_hpp_
+#define slic3r_ThumbnailRenderer_hpp_
+
+#include "ThumbnailData.hpp"
+
+namespace Slic3r {
+
+class Print;
+
+// Renders the thumbnails of the print without an OpenGL context, to be used when exporting
+// the G-code from the command line. The model parts of the printable instances are rasterized
+// with a z-buffer from the same iso view and with the same lighting as the thumbnails of the GUI,
+// optionally over the bed shape. The pixels are stored bottom-up as returned by glReadPixels().
+ThumbnailsList render_thumbnails(const Print &print, const ThumbnailsParams &params);
+
+} // namespace Slic3r
+
+#endif // slic3r_ThumbnailRenderer_hpp_
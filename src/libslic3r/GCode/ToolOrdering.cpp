@@ -11,9 +11,13 @@
     #undef NDEBUG
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include <libslic3r.h>
 
 
@@ -90,6 +94,7 @@ ToolOrdering::ToolOrdering(const PrintObject &object, uint16_t first_extruder, b
 
     // Collect extruders reuqired to print the layers.
     this->collect_extruders(object, std::vector<std::pair<double, uint16_t>>());
+    this->sort_layer_extruders();
 
     // Reorder the extruders to minimize tool switches.
     this->reorder_extruders(first_extruder);
@@ -143,6 +148,7 @@ ToolOrdering::ToolOrdering(const Print &print, uint16_t first_extruder, bool pri
     // Collect extruders reuqired to print the layers.
     for (auto object : print.objects())
         this->collect_extruders(*object, per_layer_extruder_switches);
+    this->sort_layer_extruders();
 
     // Reorder the extruders to minimize tool switches.
     this->reorder_extruders(first_extruder);
@@ -186,85 +192,92 @@ void ToolOrdering::collect_extruders(const PrintObject &object, const std::vecto
             layer_tools.has_support = true;
     }
 
-    // Extruder overrides are ordered by print_z.
-    std::vector<std::pair<double, uint16_t>>::const_iterator it_per_layer_extruder_override;
-	it_per_layer_extruder_override = per_layer_extruder_switches.begin();
-    uint16_t extruder_override = 0;
-
     // Collect the object extruders.
-    for (auto layer : object.layers()) {
-        LayerTools &layer_tools = this->tools_for_layer(layer->print_z);
+    // Each layer of the object maps to a different LayerTools, therefore the layers are processed in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, object.layers().size()), [this, &object, &per_layer_extruder_switches](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer *layer       = object.layers()[layer_idx];
+            LayerTools  &layer_tools = this->tools_for_layer(layer->print_z);
+
+            // Override extruder with the last switch below this layer. Extruder overrides are ordered by print_z.
+            auto it_per_layer_extruder_override = std::lower_bound(per_layer_extruder_switches.begin(), per_layer_extruder_switches.end(), layer->print_z + EPSILON,
+                [](const std::pair<double, uint16_t> &extruder_switch, double print_z) { return extruder_switch.first < print_z; });
+            uint16_t extruder_override = it_per_layer_extruder_override == per_layer_extruder_switches.begin() ? 0 : std::prev(it_per_layer_extruder_override)->second;
+
+            // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
+            layer_tools.extruder_override = extruder_override;
+
+            // What extruders are required to print this object layer?
+            for (size_t region_id = 0; region_id < object.region_volumes.size(); ++ region_id) {
+                const LayerRegion *layerm = (region_id < layer->regions().size()) ? layer->regions()[region_id] : nullptr;
+                if (layerm == nullptr)
+                    continue;
+                const PrintRegion &region = *object.print()->regions()[region_id];
 
-        // Override extruder with the next 
-    	for (; it_per_layer_extruder_override != per_layer_extruder_switches.end() && it_per_layer_extruder_override->first < layer->print_z + EPSILON; ++ it_per_layer_extruder_override)
-    		extruder_override = (int)it_per_layer_extruder_override->second;
+                if (! layerm->perimeters.entities.empty()) {
+                    bool something_nonoverriddable = true;
 
-        // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
-        layer_tools.extruder_override = extruder_override;
+                    if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
+                        something_nonoverriddable = false;
+                        for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
+                            if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
+                                something_nonoverriddable = true;
+                    }
 
-        // What extruders are required to print this object layer?
-        for (size_t region_id = 0; region_id < object.region_volumes.size(); ++ region_id) {
-            const LayerRegion *layerm = (region_id < layer->regions().size()) ? layer->regions()[region_id] : nullptr;
-            if (layerm == nullptr)
-                continue;
-            const PrintRegion &region = *object.print()->regions()[region_id];
+                    if (something_nonoverriddable)
+                   		layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().perimeter_extruder.value : extruder_override);
 
-            if (! layerm->perimeters.entities.empty()) {
-                bool something_nonoverriddable = true;
+                    layer_tools.has_object = true;
+                }
 
-                if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
-                    something_nonoverriddable = false;
-                    for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
-                        if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
+                bool has_infill       = false;
+                bool has_solid_infill = false;
+                bool something_nonoverriddable = false;
+                for (const ExtrusionEntity *ee : layerm->fills.entities) {
+                    // fill represents infill extrusions of a single island.
+                    const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                    ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
+                    if (is_solid_infill(role))
+                        has_solid_infill = true;
+                    else if (role != erNone)
+                        has_infill = true;
+
+                    if (m_print_config_ptr) {
+                        if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
                             something_nonoverriddable = true;
+                    }
                 }
 
-                if (something_nonoverriddable)
-               		layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().perimeter_extruder.value : extruder_override);
-
-                layer_tools.has_object = true;
-            }
-
-            bool has_infill       = false;
-            bool has_solid_infill = false;
-            bool something_nonoverriddable = false;
-            for (const ExtrusionEntity *ee : layerm->fills.entities) {
-                // fill represents infill extrusions of a single island.
-                const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
-                if (is_solid_infill(role))
-                    has_solid_infill = true;
-                else if (role != erNone)
-                    has_infill = true;
-
-                if (m_print_config_ptr) {
-                    if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
-                        something_nonoverriddable = true;
+                if (something_nonoverriddable || !m_print_config_ptr) {
+                	if (extruder_override == 0) {
+		                if (has_solid_infill)
+		                    layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
+		                if (has_infill)
+		                    layer_tools.extruders.emplace_back(region.config().infill_extruder);
+                	} else if (has_solid_infill || has_infill)
+                		layer_tools.extruders.emplace_back(extruder_override);
                 }
+                if (has_solid_infill || has_infill)
+                    layer_tools.has_object = true;
             }
-
-            if (something_nonoverriddable || !m_print_config_ptr) {
-            	if (extruder_override == 0) {
-	                if (has_solid_infill)
-	                    layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
-	                if (has_infill)
-	                    layer_tools.extruders.emplace_back(region.config().infill_extruder);
-            	} else if (has_solid_infill || has_infill)
-            		layer_tools.extruders.emplace_back(extruder_override);
-            }
-            if (has_solid_infill || has_infill)
-                layer_tools.has_object = true;
         }
-    }
-
-    for (auto& layer : m_layer_tools) {
-        // Sort and remove duplicates
-        sort_remove_duplicates(layer.extruders);
+    });
+}
 
-        // make sure that there are some tools for each object layer (e.g. tall wiping object will result in empty extruders vector)
-        if (layer.extruders.empty() && layer.has_object)
-            layer.extruders.emplace_back(0); // 0="dontcare" extruder - it will be taken care of in reorder_extruders
-    }
+// Called once the extruders of all the objects were collected.
+void ToolOrdering::sort_layer_extruders()
+{
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layer_tools.size()), [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            LayerTools &layer = m_layer_tools[layer_idx];
+            // Sort and remove duplicates
+            sort_remove_duplicates(layer.extruders);
+
+            // make sure that there are some tools for each object layer (e.g. tall wiping object will result in empty extruders vector)
+            if (layer.extruders.empty() && layer.has_object)
+                layer.extruders.emplace_back(0); // 0="dontcare" extruder - it will be taken care of in reorder_extruders
+        }
+    });
 }
 
 // Reorder extruders to minimize layer changes.
@@ -589,6 +602,51 @@ bool WipingExtrusions::is_overriddable(const ExtrusionEntityCollection& eec, con
     return true;
 }
 
+// Collects the overriddable extrusions of this layer, so that the repeated calls of mark_wiping_extrusions() for the toolchanges
+// of this layer don't need to look up the object layers and to test all their extrusions again.
+void WipingExtrusions::collect_overriddable_extrusions(const Print& print)
+{
+    if (m_overriddable_collected)
+        return;
+    m_overriddable_collected = true;
+
+    const LayerTools& lt = *m_layer_tools;
+
+    // we will sort objects so that dedicated for wiping are at the beginning:
+    PrintObjectPtrs object_list = print.objects();
+    std::stable_partition(object_list.begin(), object_list.end(), [](const PrintObject* object) { return object->config().wipe_into_objects.value; });
+
+    for (const PrintObject* object : object_list) {
+        // Finds this layer:
+        const Layer* this_layer = object->get_layer_at_printz(lt.print_z, EPSILON);
+        if (this_layer == nullptr)
+        	continue;
+        OverriddableObject overriddable_object { object, object->instances().size(), {} };
+        for (size_t region_id = 0; region_id < object->region_volumes.size() && region_id < this_layer->regions().size(); ++ region_id) {
+            const auto& region = *object->print()->regions()[region_id];
+
+            if (!region.config().wipe_into_infill && !object->config().wipe_into_objects)
+                continue;
+
+            OverriddableRegion overriddable_region { &region, {}, {} };
+            for (const ExtrusionEntity* ee : this_layer->regions()[region_id]->fills.entities) {
+                auto* fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                if (is_overriddable(*fill, print.config(), *object, region))
+                    overriddable_region.fills.emplace_back(fill, float(fill->total_volume()));
+            }
+            for (const ExtrusionEntity* ee : this_layer->regions()[region_id]->perimeters.entities) {
+                auto* fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                if (is_overriddable(*fill, print.config(), *object, region))
+                    overriddable_region.perimeters.emplace_back(fill, float(fill->total_volume()));
+            }
+            if (! overriddable_region.fills.empty() || ! overriddable_region.perimeters.empty())
+                overriddable_object.regions.emplace_back(std::move(overriddable_region));
+        }
+        if (! overriddable_object.regions.empty())
+            m_overriddable_objects.emplace_back(std::move(overriddable_object));
+    }
+}
+
 // Following function iterates through all extrusions on the layer, remembers those that could be used for wiping after toolchange
 // and returns volume that is left to be wiped on the wipe tower.
 float WipingExtrusions::mark_wiping_extrusions(const Print& print, uint16_t old_extruder, uint16_t new_extruder, float volume_to_wipe)
@@ -599,9 +657,9 @@ float WipingExtrusions::mark_wiping_extrusions(const Print& print, uint16_t old_
     if (! this->something_overridable || volume_to_wipe <= 0. || print.config().filament_soluble.get_at(old_extruder) || print.config().filament_soluble.get_at(new_extruder))
         return std::max(0.f, volume_to_wipe); // Soluble filament cannot be wiped in a random infill, neither the filament after it
 
-    // we will sort objects so that dedicated for wiping are at the beginning:
-    PrintObjectPtrs object_list = print.objects();
-    std::sort(object_list.begin(), object_list.end(), [](const PrintObject* a, const PrintObject* b) { return a->config().wipe_into_objects; });
+    // The objects dedicated for wiping are at the beginning of the list.
+    this->collect_overriddable_extrusions(print);
+    const std::vector<OverriddableObject> &object_list = m_overriddable_objects;
 
     // We will now iterate through
     //  - first the dedicated objects to mark perimeters or infills (depending on infill_first)
@@ -611,46 +669,33 @@ float WipingExtrusions::mark_wiping_extrusions(const Print& print, uint16_t old_
     bool perimeters_done = false;
 
     for (int i=0 ; i<(int)object_list.size() + (perimeters_done ? 0 : 1); ++i) {
-        if (!perimeters_done && (i==(int)object_list.size() || !object_list[i]->config().wipe_into_objects)) { // we passed the last dedicated object in list
+        if (!perimeters_done && (i==(int)object_list.size() || !object_list[i].object->config().wipe_into_objects)) { // we passed the last dedicated object in list
             perimeters_done = true;
             i=-1;   // let's go from the start again
             continue;
         }
 
-        const PrintObject* object = object_list[i];
-
-        // Finds this layer:
-        const Layer* this_layer = object->get_layer_at_printz(lt.print_z, EPSILON);
-        if (this_layer == nullptr)
-        	continue;
-        size_t num_of_copies = object->instances().size();
+        const PrintObject* object = object_list[i].object;
+        size_t num_of_copies = object_list[i].num_of_copies;
 
         // iterate through copies (aka PrintObject instances) first, so that we mark neighbouring infills to minimize travel moves
         for (uint16_t copy = 0; copy < num_of_copies; ++copy) {
 
-            for (size_t region_id = 0; region_id < object->region_volumes.size(); ++ region_id) {
-                const auto& region = *object->print()->regions()[region_id];
-
-                if (!region.config().wipe_into_infill && !object->config().wipe_into_objects)
-                    continue;
+            for (const OverriddableRegion &overriddable_region : object_list[i].regions) {
+                const auto& region = *overriddable_region.region;
 
                 bool wipe_into_infill_only = ! object->config().wipe_into_objects && region.config().wipe_into_infill;
                 if (region.config().infill_first != perimeters_done || wipe_into_infill_only) {
-                    for (const ExtrusionEntity* ee : this_layer->regions()[region_id]->fills.entities) {                      // iterate through all infill Collections
-                        auto* fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-
-                        if (!is_overriddable(*fill, print.config(), *object, region))
-                            continue;
-
+                    for (const auto &[fill, volume] : overriddable_region.fills) {                      // iterate through all overriddable infill Collections
                         if (wipe_into_infill_only && ! region.config().infill_first)
                             // In this case we must check that the original extruder is used on this layer before the one we are overridding
                             // (and the perimeters will be finished before the infill is printed):
                             if (!lt.is_extruder_order(lt.perimeter_extruder(region), new_extruder))
                                 continue;
 
-                        if ((!is_entity_overridden(fill, copy) && fill->total_volume() > min_infill_volume)) {     // this infill will be used to wipe this extruder
+                        if ((!is_entity_overridden(fill, copy) && volume > min_infill_volume)) {     // this infill will be used to wipe this extruder
                             set_extruder_override(fill, copy, new_extruder, num_of_copies);
-                            if ((volume_to_wipe -= float(fill->total_volume())) <= 0.f)
+                            if ((volume_to_wipe -= volume) <= 0.f)
                                 // More material was purged already than asked for.
 	                            return 0.f;
                         }
@@ -660,11 +705,10 @@ float WipingExtrusions::mark_wiping_extrusions(const Print& print, uint16_t old_
                 // Now the same for perimeters - see comments above for explanation:
                 if (object->config().wipe_into_objects && region.config().infill_first == perimeters_done)
                 {
-                    for (const ExtrusionEntity* ee : this_layer->regions()[region_id]->perimeters.entities) {
-                        auto* fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                        if (is_overriddable(*fill, print.config(), *object, region) && !is_entity_overridden(fill, copy) && fill->total_volume() > min_infill_volume) {
+                    for (const auto &[fill, volume] : overriddable_region.perimeters) {
+                        if (!is_entity_overridden(fill, copy) && volume > min_infill_volume) {
                             set_extruder_override(fill, copy, new_extruder, num_of_copies);
-                            if ((volume_to_wipe -= float(fill->total_volume())) <= 0.f)
+                            if ((volume_to_wipe -= volume) <= 0.f)
                             	// More material was purged already than asked for.
 	                            return 0.f;
                         }
@@ -693,25 +737,17 @@ void WipingExtrusions::ensure_perimeters_infills_order(const Print& print)
     uint16_t first_nonsoluble_extruder = first_nonsoluble_extruder_on_layer(print.config());
     uint16_t last_nonsoluble_extruder = last_nonsoluble_extruder_on_layer(print.config());
 
-    for (const PrintObject* object : print.objects()) {
-        // Finds this layer:
-        const Layer* this_layer = object->get_layer_at_printz(lt.print_z, EPSILON);
-        if (this_layer == nullptr)
-        	continue;
-        size_t num_of_copies = object->instances().size();
+    this->collect_overriddable_extrusions(print);
+    for (const OverriddableObject &overriddable_object : m_overriddable_objects) {
+        const PrintObject* object = overriddable_object.object;
+        size_t num_of_copies = overriddable_object.num_of_copies;
 
         for (size_t copy = 0; copy < num_of_copies; ++copy) {    // iterate through copies first, so that we mark neighbouring infills to minimize travel moves
-            for (size_t region_id = 0; region_id < object->region_volumes.size(); ++ region_id) {
-                const auto& region = *object->print()->regions()[region_id];
+            for (const OverriddableRegion &overriddable_region : overriddable_object.regions) {
+                const auto& region = *overriddable_region.region;
 
-                if (!region.config().wipe_into_infill && !object->config().wipe_into_objects)
-                    continue;
-
-                for (const ExtrusionEntity* ee : this_layer->regions()[region_id]->fills.entities) {                      // iterate through all infill Collections
-                    auto* fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-
-                    if (!is_overriddable(*fill, print.config(), *object, region)
-                     || is_entity_overridden(fill, copy) )
+                for (const auto &[fill, volume] : overriddable_region.fills) {                      // iterate through all overriddable infill Collections
+                    if (is_entity_overridden(fill, copy))
                         continue;
 
                     // This infill could have been overridden but was not - unless we do something, it could be
@@ -730,11 +766,9 @@ void WipingExtrusions::ensure_perimeters_infills_order(const Print& print)
                 }
 
                 // Now the same for perimeters - see comments above for explanation:
-                for (const ExtrusionEntity* ee : this_layer->regions()[region_id]->perimeters.entities) {                      // iterate through all perimeter Collections
-                    auto* fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                    if (is_overriddable(*fill, print.config(), *object, region) && ! is_entity_overridden(fill, copy))
+                for (const auto &[fill, volume] : overriddable_region.perimeters)                      // iterate through all overriddable perimeter Collections
+                    if (! is_entity_overridden(fill, copy))
                         set_extruder_override(fill, copy, (region.config().infill_first ? last_nonsoluble_extruder : first_nonsoluble_extruder), num_of_copies);
-                }
             }
         }
     }
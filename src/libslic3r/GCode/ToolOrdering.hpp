@@ -57,6 +57,19 @@ private:
     // This function is called from mark_wiping_extrusions and sets extruder that it should be printed with (-1 .. as usual)
     void set_extruder_override(const ExtrusionEntity* entity, size_t copy_id, int extruder, size_t num_of_copies);
 
+    // Overriddable extrusions of this layer with their volumes, collected once for all the toolchanges of the layer.
+    struct OverriddableRegion {
+        const PrintRegion                                               *region;
+        std::vector<std::pair<const ExtrusionEntityCollection*, float>>  fills;
+        std::vector<std::pair<const ExtrusionEntityCollection*, float>>  perimeters;
+    };
+    struct OverriddableObject {
+        const PrintObject                                               *object;
+        size_t                                                           num_of_copies;
+        std::vector<OverriddableRegion>                                  regions;
+    };
+    void collect_overriddable_extrusions(const Print& print);
+
     // Returns true in case that entity is not printed with its usual extruder for a given copy:
     bool is_entity_overridden(const ExtrusionEntity* entity, size_t copy_id) const {
         auto it = entity_map.find(entity);
@@ -64,6 +77,9 @@ private:
     }
 
     std::map<const ExtrusionEntity*, ExtruderPerCopy> entity_map;  // to keep track of who prints what
+    // Objects dedicated for wiping first, see collect_overriddable_extrusions().
+    std::vector<OverriddableObject> m_overriddable_objects;
+    bool m_overriddable_collected = false;
     bool something_overridable = false;
     bool something_overridden = false;
     const LayerTools* m_layer_tools = nullptr;    // so we know which LayerTools object this belongs to
@@ -167,6 +183,7 @@ public:
 private:
     void				initialize_layers(std::vector<coordf_t> &zs);
     void 				collect_extruders(const PrintObject &object, const std::vector<std::pair<double, uint16_t>> &per_layer_extruder_switches);
+    void 				sort_layer_extruders();
     void				reorder_extruders(uint16_t last_extruder_id);
     void 				fill_wipe_tower_partitions(const PrintConfig &config, coordf_t object_bottom_z, coordf_t max_layer_height);
     void 				collect_extruder_statistics(bool prime_multi_material);
@@ -10,6 +10,7 @@
 #include "Flow.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/functional/hash.hpp>
 
 
 // Experimental "Peter's wipe tower" feature was partially implemented, inspired by
@@ -1478,6 +1479,25 @@ void WipeTower::plan_toolchange(float z_par, float layer_height_par, uint16_t ol
 	m_plan.back().tool_changes.push_back(WipeTowerInfo::ToolChange(old_tool, new_tool, depth, ramming_depth, first_wipe_line, wipe_volume));
 }
 
+size_t WipeTower::plan_hash() const
+{
+    size_t seed = m_plan.size();
+    for (const WipeTowerInfo &layer : m_plan) {
+        boost::hash_combine(seed, layer.z);
+        boost::hash_combine(seed, layer.height);
+        boost::hash_combine(seed, layer.tool_changes.size());
+        for (const WipeTowerInfo::ToolChange &toolchange : layer.tool_changes) {
+            boost::hash_combine(seed, toolchange.old_tool);
+            boost::hash_combine(seed, toolchange.new_tool);
+            boost::hash_combine(seed, toolchange.required_depth);
+            boost::hash_combine(seed, toolchange.ramming_depth);
+            boost::hash_combine(seed, toolchange.first_wipe_line);
+            boost::hash_combine(seed, toolchange.wipe_volume);
+        }
+    }
+    return seed;
+}
+
 
 
 void WipeTower::plan_tower()
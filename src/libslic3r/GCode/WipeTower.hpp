@@ -107,6 +107,10 @@ public:
 	// Iterates through prepared m_plan, generates ToolChangeResults and appends them to "result"
 	void generate(std::vector<std::vector<ToolChangeResult>> &result);
 
+	// Hash of the prepared m_plan. Combined with the hash of the configuration, it tells whether generate()
+	// would produce the same ToolChangeResults as for a previous plan.
+	size_t plan_hash() const;
+
     float get_depth() const { return m_wipe_tower_depth; }
     float get_brim_width() const { return m_wipe_tower_brim_width; }
 
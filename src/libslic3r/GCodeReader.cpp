@@ -1,10 +1,14 @@
 #include "GCodeReader.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/nowide/fstream.hpp>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <cstdio>
 
 #include <Shiny/Shiny.h>
 
@@ -22,6 +26,43 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_extrusion_axis = m_config.get_extrusion_axis()[0];
 }
 
+// Parse a number in the fixed decimal notation written by the G-code generator ([+-]digits[.digits]), independent of the locale.
+// Leading whitespaces are skipped as by strtod(), the end of line is never skipped.
+// If no number is found, pend is set to ptr. Numbers with an exponent, too many digits, infinities or NaNs
+// are left to strtod() to produce the same value as before.
+double GCodeReader::parse_number(const char *ptr, const char **pend)
+{
+    static constexpr double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    const char *c        = skip_whitespaces(ptr);
+    const char *start    = c;
+    bool        negative = *c == '-';
+    if (*c == '-' || *c == '+')
+        ++ c;
+    uint64_t mantissa   = 0;
+    int      num_digits = 0;
+    int      num_frac   = 0;
+    for (; *c >= '0' && *c <= '9'; ++ c, ++ num_digits)
+        mantissa = mantissa * 10 + uint64_t(*c - '0');
+    if (*c == '.')
+        for (++ c; *c >= '0' && *c <= '9'; ++ c, ++ num_digits, ++ num_frac)
+            mantissa = mantissa * 10 + uint64_t(*c - '0');
+    if (num_digits == 0 || num_digits > 15 || *c == 'e' || *c == 'E') {
+        if (num_digits == 0 && *c != 'i' && *c != 'I' && *c != 'n' && *c != 'N') {
+            // Not a number.
+            *pend = ptr;
+            return 0.;
+        }
+        char   *end = nullptr;
+        double  v   = strtod(start, &end);
+        *pend = end == start ? ptr : end;
+        return v;
+    }
+    // Both the mantissa and the power of ten are exact in double, thus the division is rounded correctly.
+    double v = double(mantissa) / pow10[num_frac];
+    *pend = c;
+    return negative ? - v : v;
+}
+
 const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline, std::pair<const char*, const char*> &command)
 {
     PROFILE_FUNC();
@@ -57,8 +98,13 @@ const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline,
             }
             if (axis != NUM_AXES_WITH_UNKNOWN) {
                 // Try to parse the numeric value.
-                char   *pend = nullptr;
-                double  v = strtod(++ c, &pend);
+                const char *pend = nullptr;
+                double      v    = 0.;
+                // Don't skip the end of line to parse the next one, the lines of a file mapped into memory are not null terminated.
+                if (is_end_of_line(*skip_whitespaces(++ c)))
+                    pend = c;
+                else
+                    v = parse_number(c, &pend);
                 if (pend != nullptr && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     if (axis != UNKNOWN_AXIS)
@@ -103,7 +149,8 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
     PROFILE_FUNC();
     if (*command.first == 'G') {
         int cmd_len = int(command.second - command.first);
-        if ((cmd_len == 2 && (command.first[1] == '0' || command.first[1] == '1')) ||
+        // G0 / G1 moves, G2 / G3 arcs
+        if ((cmd_len == 2 && command.first[1] >= '0' && command.first[1] <= '3') ||
             (cmd_len == 3 &&  command.first[1] == '9' && command.first[2] == '2')) {
             for (size_t i = 0; i < NUM_AXES; ++ i)
                 if (gline.has(Axis(i)))
@@ -112,13 +159,42 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
     }
 }
 
-void GCodeReader::parse_file(const std::string &file, callback_t callback)
+void GCodeReader::parse_file(const std::string &file, callback_t callback, size_t max_offset)
 {
+    m_parsing_file = true;
+    // A single GCodeLine is reused for all the lines of the file, so that its raw string keeps its capacity
+    // and no memory is allocated per line.
+    GCodeLine gline;
+    try {
+        // Parse the lines in place from the file mapped into memory.
+        boost::interprocess::file_mapping  mapping(file.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+        region.advise(boost::interprocess::mapped_region::advice_sequential);
+        const char *ptr = static_cast<const char*>(region.get_address());
+        const char *region_end = ptr + region.get_size();
+        const char *end        = ptr + std::min(region.get_size(), max_offset);
+        while (m_parsing_file && ptr < end) {
+            const char *line_end = static_cast<const char*>(memchr(ptr, '\n', region_end - ptr));
+            gline.reset();
+            if (line_end == nullptr) {
+                // The last line is not terminated by a new line, thus it is not terminated at all. Parse a copy of it.
+                this->parse_line(std::string(ptr, region_end).c_str(), gline, callback);
+                break;
+            }
+            // The parser stops at the end of line, the rest of the line (after a '\r') is skipped as with std::getline().
+            this->parse_line(ptr, gline, callback);
+            ptr = line_end + 1;
+        }
+        return;
+    } catch (const boost::interprocess::interprocess_exception &) {
+        // The file is empty or it could not be mapped (for example a non-ASCII path on Windows), read it through a stream.
+    }
     boost::nowide::ifstream f(file);
     std::string line;
-    m_parsing_file = true;
-    while (m_parsing_file && std::getline(f, line))
-        this->parse_line(line, callback);
+    for (size_t offset = 0; m_parsing_file && offset < max_offset && std::getline(f, line); offset += line.size() + 1) {
+        gline.reset();
+        this->parse_line(line.c_str(), gline, callback);
+    }
 }
 
 bool GCodeReader::GCodeLine::has(char axis) const
@@ -159,8 +235,8 @@ bool GCodeReader::GCodeLine::has_value(char axis, float &value) const
         // Check the name of the axis.
         if (*c == axis) {
             // Try to parse the numeric value.
-            char   *pend = nullptr;
-            double  v = strtod(++ c, &pend);
+            const char *pend = nullptr;
+            double      v    = GCodeReader::parse_number(++ c, &pend);
             if (pend != nullptr && is_end_of_word(*pend)) {
                 // The axis value has been parsed correctly.
                 value = float(v);
@@ -175,8 +251,10 @@ bool GCodeReader::GCodeLine::has_value(char axis, float &value) const
 
 void GCodeReader::GCodeLine::set(const GCodeReader &reader, const Axis axis, const float new_value, const int decimal_digits)
 {
-    std::ostringstream ss;
-    ss << std::fixed << std::setprecision(decimal_digits) << new_value;
+    // Format the same way as std::fixed with precision decimal_digits, without the overhead of a stream.
+    char buf[64];
+    int  buf_len = snprintf(buf, sizeof(buf), "%.*f", decimal_digits, new_value);
+    std::string_view str_value(buf, std::max(0, std::min(buf_len, int(sizeof(buf)) - 1)));
 
     char match[3] = " X";
     if (int(axis) < 3)
@@ -191,13 +269,15 @@ void GCodeReader::GCodeLine::set(const GCodeReader &reader, const Axis axis, con
     if (this->has(axis)) {
         size_t pos = m_raw.find(match)+2;
         size_t end = m_raw.find(' ', pos+1);
-        m_raw = m_raw.replace(pos, end-pos, ss.str());
+        m_raw.replace(pos, end-pos, str_value);
     } else {
         size_t pos = m_raw.find(' ');
-        if (pos == std::string::npos)
-            m_raw += std::string(match) + ss.str();
-        else
-            m_raw = m_raw.replace(pos, 0, std::string(match) + ss.str());
+        if (pos == std::string::npos) {
+            m_raw.append(match).append(str_value);
+        } else {
+            m_raw.insert(pos, str_value);
+            m_raw.insert(pos, match);
+        }
     }
     m_axis[axis] = new_value;
     m_mask |= 1 << int(axis);
@@ -115,7 +115,10 @@ public:
     void parse_line(const std::string &line, Callback callback)
         { GCodeLine gline; this->parse_line(line.c_str(), gline, callback); }
 
-    void parse_file(const std::string &file, callback_t callback);
+    // Parse the file mapped into memory, without copying it line by line.
+    // The GCodeLine passed to the callback is only valid during the call.
+    // Only the lines starting before max_offset are parsed, for example up to the end of a layer.
+    void parse_file(const std::string &file, callback_t callback, size_t max_offset = size_t(-1));
     void quit_parsing_file() { m_parsing_file = false; }
 
     float& x()       { return m_position[X]; }
@@ -150,6 +153,8 @@ private:
             ; // silence -Wempty-body
         return c;
     }
+    // Locale independent parser of the numbers of the G-code words, see GCodeReader.cpp.
+    static double       parse_number(const char *ptr, const char **pend);
 
     GCodeConfig m_config;
     char        m_extrusion_axis;
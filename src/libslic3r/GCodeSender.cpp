@@ -53,7 +53,7 @@ namespace Slic3r {
 
 GCodeSender::GCodeSender()
     : io(), serial(io), can_send(false), sent(0), open(false), error(false),
-      connected(false), queue_paused(false)
+      connected(false), queue_paused(false), writing(false), rx_buffer_size(0), in_flight_bytes(0)
 {
 #ifdef DEBUG_SERIAL
     std::srand(std::time(nullptr));
@@ -96,6 +96,9 @@ GCodeSender::connect(std::string devname, unsigned int baud_rate)
     // a reset firmware expect line numbers to start again from 1
     this->sent = 0;
     this->last_sent.clear();
+    this->in_flight.clear();
+    this->in_flight_bytes = 0;
+    this->writing = false;
 
     /* Initialize debugger */
 #ifdef DEBUG_SERIAL
@@ -205,6 +208,16 @@ GCodeSender::queue_size() const
     return this->queue.size();
 }
 
+void
+GCodeSender::set_rx_buffer_size(size_t bytes)
+{
+    {
+        boost::lock_guard<boost::mutex> l(this->queue_mutex);
+        this->rx_buffer_size = bytes;
+    }
+    this->send();
+}
+
 void
 GCodeSender::pause_queue()
 {
@@ -351,12 +364,13 @@ GCodeSender::on_read(const boost::system::error_code& error,
             {
                 boost::lock_guard<boost::mutex> l(this->queue_mutex);
                 this->can_send = true;
+                this->acknowledge_line();
             }
             this->send();
         } else if (boost::starts_with(line, "ok")) {
             {
                 boost::lock_guard<boost::mutex> l(this->queue_mutex);
-                this->can_send = true;
+                this->acknowledge_line();
             }
             this->send();
         } else if (boost::istarts_with(line, "resend")  // Marlin uses "Resend: "
@@ -386,10 +400,12 @@ GCodeSender::on_read(const boost::system::error_code& error,
                     
                     // we can empty last_sent because it's not useful anymore
                     this->last_sent.clear();
+                    // the firmware dropped everything after the failed line, nothing is waiting for an "ok" anymore
+                    this->in_flight.clear();
+                    this->in_flight_bytes = 0;
                     
                     // start resending with the requested line number
                     this->sent = toresend - 1;
-                    this->can_send = true;
                 }
                 this->send();
             } else {
@@ -461,70 +477,107 @@ GCodeSender::send()
 }
 
 void
-GCodeSender::do_send()
+GCodeSender::acknowledge_line()
 {
-    boost::lock_guard<boost::mutex> l(this->queue_mutex);
-    
-    // printer is not connected or we're still waiting for the previous ack
-    if (!this->can_send) return;
-    
-    std::string line;
-    while (!this->priqueue.empty() || (!this->queue.empty() && !this->queue_paused)) {
-        if (!this->priqueue.empty()) {
-            line = this->priqueue.front();
-            this->priqueue.pop_front();
-        } else {
-            line = this->queue.front();
-            this->queue.pop();
-        }
-        
-        // strip comments
-        size_t comment_pos = line.find_first_of(';');
-        if (comment_pos != std::string::npos)
-            line.erase(comment_pos, std::string::npos);
-        boost::algorithm::trim(line);
-        
-        // if line is not empty, send it
-        if (!line.empty()) break;
-        // if line is empty, process next item in queue
+    if (!this->in_flight.empty()) {
+        this->in_flight_bytes -= this->in_flight.front();
+        this->in_flight.pop_front();
     }
-    if (line.empty()) return;
-    
-    // compute full line
-    ++ this->sent;
-#ifndef DEBUG_SERIAL
-    const auto line_num = this->sent;
-#else
-    // In DEBUG_SERIAL mode, test line re-synchronization by sending bad line number 1/4 of the time
-    const auto line_num = std::rand() < RAND_MAX/4 ? 0 : this->sent;
-#endif
-    std::string full_line = "N" + boost::lexical_cast<std::string>(line_num) + " " + line;
+}
+
+// Format a line with its line number and checksum, the way the firmware expects it.
+static std::string
+format_line(size_t line_num, const std::string &line)
+{
+    std::string full_line = "N" + std::to_string(line_num) + " " + line;
     
     // calculate checksum
     int cs = 0;
     for (std::string::const_iterator it = full_line.begin(); it != full_line.end(); ++it)
        cs = cs ^ *it;
     
-    // write line to device
     full_line += "*";
-    full_line += boost::lexical_cast<std::string>(cs);
+    full_line += std::to_string(cs);
     full_line += "\n";
+    return full_line;
+}
+
+void
+GCodeSender::do_send()
+{
+    boost::lock_guard<boost::mutex> l(this->queue_mutex);
+    
+    // printer is not connected or the previous batch of lines is still being written
+    if (!this->can_send || this->writing) return;
     
+    // All the lines which fit are formatted into a single contiguous write.
+    std::ostream os(&this->write_buffer);
+    size_t num_lines = 0;
+    for (;;) {
+        // In the default mode a single line is sent and its "ok" is waited for.
+        if (this->rx_buffer_size == 0 && !this->in_flight.empty()) break;
+        
+        std::string line;
+        while (!this->priqueue.empty() || (!this->queue.empty() && !this->queue_paused)) {
+            if (!this->priqueue.empty()) {
+                line = this->priqueue.front();
+                this->priqueue.pop_front();
+            } else {
+                line = this->queue.front();
+                this->queue.pop();
+            }
+            
+            // strip comments
+            size_t comment_pos = line.find_first_of(';');
+            if (comment_pos != std::string::npos)
+                line.erase(comment_pos, std::string::npos);
+            boost::algorithm::trim(line);
+            
+            // if line is not empty, send it
+            if (!line.empty()) break;
+            // if line is empty, process next item in queue
+        }
+        if (line.empty()) break;
+        
+        // compute full line
+#ifndef DEBUG_SERIAL
+        const auto line_num = this->sent + 1;
+#else
+        // In DEBUG_SERIAL mode, test line re-synchronization by sending bad line number 1/4 of the time
+        const auto line_num = std::rand() < RAND_MAX/4 ? 0 : this->sent + 1;
+#endif
+        std::string full_line = format_line(line_num, line);
+        
+        // In the character counting mode, keep at most rx_buffer_size bytes in the firmware's receive buffer.
+        // A single line is always sent if nothing is waiting for an "ok", so that an overlong line does not stall the queue.
+        if (!this->in_flight.empty() && this->in_flight_bytes + full_line.size() > this->rx_buffer_size) {
+            // Put the line back, it will be the first one sent after the next "ok".
+            this->priqueue.push_front(line);
+            break;
+        }
+        
 #ifdef DEBUG_SERIAL
-    fs << ">> " << full_line << std::flush;
+        fs << ">> " << full_line << std::flush;
 #endif
-    
-    this->last_sent.push_back(line);
-    this->can_send = false;
-    
-    while (this->last_sent.size() > KEEP_SENT) {
-        this->last_sent.pop_front();
+        
+        ++ this->sent;
+        this->last_sent.push_back(line);
+        this->in_flight.push_back(full_line.size());
+        this->in_flight_bytes += full_line.size();
+        
+        // keep enough sent lines to serve a resend request for any line which is not yet acknowledged
+        while (this->last_sent.size() > KEEP_SENT + this->in_flight.size()) {
+            this->last_sent.pop_front();
+        }
+        
+        // we can't supply boost::asio::buffer(full_line) to async_write() because full_line is on the
+        // stack and the buffer would lose its underlying storage causing memory corruption
+        os << full_line;
+        ++ num_lines;
     }
+    if (num_lines == 0) return;
     
-    // we can't supply boost::asio::buffer(full_line) to async_write() because full_line is on the
-    // stack and the buffer would lose its underlying storage causing memory corruption
-    std::ostream os(&this->write_buffer);
-    os << full_line;
+    this->writing = true;
     boost::asio::async_write(this->serial, this->write_buffer, boost::bind(&GCodeSender::on_write, this, boost::asio::placeholders::error,
                 boost::asio::placeholders::bytes_transferred));
 }
@@ -542,6 +595,10 @@ GCodeSender::on_write(const boost::system::error_code& error,
         return;
     }
     
+    {
+        boost::lock_guard<boost::mutex> l(this->queue_mutex);
+        this->writing = false;
+    }
     this->do_send();
 }
 
@@ -2,6 +2,8 @@
 #define slic3r_GCodeSender_hpp_
 
 #include "libslic3r.h"
+#include <deque>
+#include <list>
 #include <queue>
 #include <string>
 #include <vector>
@@ -25,6 +27,9 @@ class GCodeSender : private boost::noncopyable {
     bool is_connected() const;
     bool wait_connected(unsigned int timeout = 3) const;
     size_t queue_size() const;
+    // Number of bytes of the firmware's receive buffer to keep filled with lines, waiting for their "ok".
+    // Zero (the default) sends a single line and waits for its "ok" before sending the next one.
+    void set_rx_buffer_size(size_t bytes);
     void pause_queue();
     void resume_queue();
     void purge_queue(bool priority = false);
@@ -44,7 +49,7 @@ class GCodeSender : private boost::noncopyable {
     bool error;
     mutable boost::mutex error_mutex;
     
-    // this mutex guards queue, priqueue, can_send, queue_paused, sent, last_sent
+    // this mutex guards queue, priqueue, can_send, queue_paused, sent, last_sent, writing, rx_buffer_size, in_flight
     mutable boost::mutex queue_mutex;
     std::queue<std::string> queue;
     std::list<std::string> priqueue;
@@ -52,6 +57,12 @@ class GCodeSender : private boost::noncopyable {
     bool queue_paused;
     size_t sent;
     std::deque<std::string> last_sent;
+    // whether an asynchronous write of write_buffer is in progress
+    bool writing;
+    size_t rx_buffer_size;
+    // sizes of the lines sent, but not yet acknowledged by an "ok", and their sum
+    std::deque<size_t> in_flight;
+    size_t in_flight_bytes;
     
     // this mutex guards log, T, B
     mutable boost::mutex log_mutex;
@@ -61,6 +72,7 @@ class GCodeSender : private boost::noncopyable {
     void set_baud_rate(unsigned int baud_rate);
     void set_error_status(bool e);
     void do_send();
+    void acknowledge_line();
     void on_write(const boost::system::error_code& error, size_t bytes_transferred);
     void do_close();
     void do_read();
@@ -1,50 +1,90 @@
 #include "GCodeWriter.hpp"
 #include "CustomGCode.hpp"
 #include <algorithm>
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <assert.h>
 
+#if __has_include(<charconv>)
+    #include <charconv>
+    #include <utility>
+#endif
+
 #define FLAVOR_IS(val) this->config.gcode_flavor.value == val
 #define FLAVOR_IS_NOT(val) this->config.gcode_flavor.value != val
-#define COMMENT(comment) if (this->config.gcode_comments.value && !comment.empty()) gcode << " ; " << comment;
-#define PRECISION(val, precision) to_string_nozero(val, precision)
+#define COMMENT(comment) if (this->config.gcode_comments.value && !comment.empty()) { gcode += " ; "; gcode += comment; }
+#define PRECISION(val, precision) append_nozero(gcode, val, precision)
 #define XYZ_NUM(val) PRECISION(val, this->config.gcode_precision_xyz.value)
-#define FLOAT_PRECISION(val, precision) std::defaultfloat << std::setprecision(precision) << (val)
+#define FLOAT_PRECISION(val, precision) append_number(gcode, val, precision, false)
 #define F_NUM(val) FLOAT_PRECISION(val, 8)
 #define E_NUM(val) PRECISION(val, this->config.gcode_precision_e.get_at(m_tool->id()))
 
 namespace Slic3r {
 
-std::string to_string_nozero(double value, int32_t max_precision) {
+#if __has_include(<charconv>)
+    template <typename T, typename = void>
+    struct is_to_chars_convertible : std::false_type {};
+    template <typename T>
+    struct is_to_chars_convertible<T, std::void_t<decltype(std::to_chars(std::declval<char*>(), std::declval<char*>(), std::declval<T>(), std::chars_format::fixed, 0))>> : std::true_type {};
+#endif
+
+// Appends the value formatted as std::ostream does with std::fixed (fixed = true) or std::defaultfloat and the given precision,
+// that is like printf("%.*f") or printf("%.*g"), without the allocations and the locale lookups of a std::ostringstream.
+static void append_number(std::string &out, double value, int precision, bool fixed)
+{
+    char buf[64];
+#if __has_include(<charconv>)
+    // Older GCC and the OSX compiler only implement std::to_chars for integers.
+    if constexpr (is_to_chars_convertible<double>::value) {
+        auto [end_ptr, error_code] = std::to_chars(buf, buf + sizeof(buf), value, fixed ? std::chars_format::fixed : std::chars_format::general, precision);
+        if (error_code == std::errc()) {
+            out.append(buf, end_ptr);
+            return;
+        }
+    }
+#endif
+    // The G-code export runs with the "C" numeric locale, see GUI_App.
+    int len = snprintf(buf, sizeof(buf), fixed ? "%.*f" : "%.*g", precision, value);
+    if (len < int(sizeof(buf))) {
+        out.append(buf, len);
+    } else {
+        size_t old_size = out.size();
+        out.resize(old_size + len + 1);
+        snprintf(&out[old_size], len + 1, fixed ? "%.*f" : "%.*g", precision, value);
+        out.resize(old_size + len);
+    }
+}
+
+// Appends the value with at most max_precision decimals, without the trailing zeros.
+static void append_nozero(std::string &out, double value, int32_t max_precision)
+{
     double intpart;
     if (modf(value, &intpart) == 0.0) {
-        //shortcut for int
-        return boost::lexical_cast<std::string>(intpart);
+        //shortcut for int, same output as boost::lexical_cast<std::string>(intpart)
+        append_number(out, intpart, 17, false);
     } else {
-        std::stringstream ss;
         //first, get the int part, to see how many digit it takes
         int long10 = 0;
         if (intpart > 9)
             long10 = (int)std::floor(std::log10(std::abs(intpart)));
         //set the usable precision: there is only 15-16 decimal digit in a double
-        ss << std::fixed << std::setprecision(int(std::min(15 - long10, int(max_precision)))) << value;
-        std::string ret = ss.str();
-        uint8_t nb_del = 0;
-        for (uint8_t i = uint8_t(ss.tellp()) - 1; i > 0; i--) {
-            if (ret[i] == '0')
-                nb_del++;
-            else
-                break;
-        }
-        if (nb_del > 0)
-            return ret.substr(0, ret.size() - nb_del);
-        else
-            return ret;
+        size_t start = out.size();
+        append_number(out, value, int(std::min(15 - long10, int(max_precision))), true);
+        size_t end = out.size();
+        while (end > start + 1 && out[end - 1] == '0')
+            -- end;
+        out.resize(end);
     }
 }
 
+std::string to_string_nozero(double value, int32_t max_precision) {
+    std::string out;
+    append_nozero(out, value, max_precision);
+    return out;
+}
+
     std::string GCodeWriter::PausePrintCode = "M601";
 
 void GCodeWriter::apply_print_config(const PrintConfig &print_config)
@@ -250,7 +290,7 @@ std::string GCodeWriter::set_bed_temperature(uint32_t temperature, bool wait)
 
 std::string GCodeWriter::set_fan(const uint8_t speed, bool dont_save, uint16_t default_tool)
 {
-    std::ostringstream gcode;
+    std::string gcode;
 
     const Tool *tool = m_tool == nullptr ? get_tool(default_tool) : m_tool;
     //add fan_offset
@@ -272,31 +312,32 @@ std::string GCodeWriter::set_fan(const uint8_t speed, bool dont_save, uint16_t d
         // write it
         if (fan_speed == 0) {
             if (FLAVOR_IS(gcfTeacup)) {
-                gcode << "M106 S0";
+                gcode += "M106 S0";
             } else if (FLAVOR_IS(gcfMakerWare) || FLAVOR_IS(gcfSailfish)) {
-                gcode << "M127";
+                gcode += "M127";
             } else {
-                gcode << "M107";
+                gcode += "M107";
             }
-            if (this->config.gcode_comments) gcode << " ; disable fan";
-            gcode << "\n";
+            if (this->config.gcode_comments) gcode += " ; disable fan";
+            gcode += "\n";
         } else {
             if (FLAVOR_IS(gcfMakerWare) || FLAVOR_IS(gcfSailfish)) {
-                gcode << "M126 T";
+                gcode += "M126 T";
             } else {
-                gcode << "M106 ";
+                gcode += "M106 ";
                 if (FLAVOR_IS(gcfMach3) || FLAVOR_IS(gcfMachinekit)) {
-                    gcode << "P";
+                    gcode += "P";
                 } else {
-                    gcode << "S";
+                    gcode += "S";
                 }
-                gcode << (fan_baseline * (fan_speed / 100.0));
+                // default precision of a std::ostream
+                FLOAT_PRECISION(fan_baseline * (fan_speed / 100.0), 6);
             }
-            if (this->config.gcode_comments) gcode << " ; enable fan";
-            gcode << "\n";
+            if (this->config.gcode_comments) gcode += " ; enable fan";
+            gcode += "\n";
         }
     }
-    return gcode.str();
+    return gcode;
 }
 
 void GCodeWriter::set_acceleration(uint32_t acceleration)
@@ -322,25 +363,26 @@ std::string GCodeWriter::write_acceleration(){
 
     m_last_acceleration = m_current_acceleration;
 
-    std::ostringstream gcode;
+    std::string gcode;
+    const std::string acceleration = std::to_string(m_current_acceleration);
 	//try to set only printing acceleration, travel should be untouched if possible
     if (FLAVOR_IS(gcfRepetier)) {
         // M201: Set max printing acceleration
-        gcode << "M201 X" << m_current_acceleration << " Y" << m_current_acceleration;
+        gcode += "M201 X" + acceleration + " Y" + acceleration;
     } else if(FLAVOR_IS(gcfMarlin) || FLAVOR_IS(gcfLerdge) || FLAVOR_IS(gcfSprinter)){
         // M204: Set printing acceleration
-        gcode << "M204 P" << m_current_acceleration;
+        gcode += "M204 P" + acceleration;
     } else  if (FLAVOR_IS(gcfRepRap)) {
         // M204: Set printing & travel acceleration
-        gcode << "M204 P" << m_current_acceleration <<" T" << m_current_acceleration;
+        gcode += "M204 P" + acceleration + " T" + acceleration;
     } else {
         // M204: Set default acceleration
-        gcode << "M204 S" << m_current_acceleration;
+        gcode += "M204 S" + acceleration;
     }
-    if (this->config.gcode_comments) gcode << " ; adjust acceleration";
-    gcode << "\n";
+    if (this->config.gcode_comments) gcode += " ; adjust acceleration";
+    gcode += "\n";
     
-    return gcode.str();
+    return gcode;
 }
 
 std::string GCodeWriter::reset_e(bool force)
@@ -357,11 +399,10 @@ std::string GCodeWriter::reset_e(bool force)
     }
 
     if (! m_extrusion_axis.empty() && ! this->config.use_relative_e_distances) {
-        std::ostringstream gcode;
-        gcode << "G92 " << m_extrusion_axis << "0";
-        if (this->config.gcode_comments) gcode << " ; reset extrusion distance";
-        gcode << "\n";
-        return gcode.str();
+        std::string gcode = "G92 " + m_extrusion_axis + "0";
+        if (this->config.gcode_comments) gcode += " ; reset extrusion distance";
+        gcode += "\n";
+        return gcode;
     } else {
         return "";
     }
@@ -416,7 +457,7 @@ std::string GCodeWriter::toolchange(uint16_t tool_id)
 
     // return the toolchange command
     // if we are running a single-extruder setup, just set the extruder and return nothing
-    std::ostringstream gcode;
+    std::string gcode;
     if (this->multiple_extruders) {
         if (FLAVOR_IS(gcfKlipper)) {
             //check if we can use the tool_name field or not
@@ -424,49 +465,48 @@ std::string GCodeWriter::toolchange(uint16_t tool_id)
                 // NOTE: this will probably break if there's more than 10 tools, as it's relying on the
                 // ASCII character table.
                 && this->config.tool_name.values[tool_id][0] != static_cast<char>(('0' + tool_id))) {
-                gcode << this->toolchange_prefix() << this->config.tool_name.values[tool_id];
+                gcode += this->toolchange_prefix() + this->config.tool_name.values[tool_id];
             } else {
-                gcode << this->toolchange_prefix() << "extruder";
+                gcode += this->toolchange_prefix() + "extruder";
                 if (tool_id > 0)
-                    gcode << tool_id;
+                    gcode += std::to_string(tool_id);
             }
         } else {
-            gcode << this->toolchange_prefix() << tool_id;
+            gcode += this->toolchange_prefix() + std::to_string(tool_id);
         }
         if (this->config.gcode_comments)
-            gcode << " ; change extruder";
-        gcode << "\n";
-        gcode << this->reset_e(true);
+            gcode += " ; change extruder";
+        gcode += "\n";
+        gcode += this->reset_e(true);
     }
-    return gcode.str();
+    return gcode;
 }
 
 std::string GCodeWriter::set_speed(double F, const std::string &comment, const std::string &cooling_marker) const
 {
     assert(F > 0.);
     assert(F < 100000.);
-    std::ostringstream gcode;
-    gcode << "G1 F" << F_NUM(F);
+    std::string gcode = "G1 F";
+    F_NUM(F);
     COMMENT(comment);
-    gcode << cooling_marker;
-    gcode << "\n";
-    return gcode.str();
+    gcode += cooling_marker;
+    gcode += "\n";
+    return gcode;
 }
 
 std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &comment)
 {
-    std::ostringstream gcode;
-    gcode << write_acceleration();
+    std::string gcode = write_acceleration();
 
     m_pos.x() = point.x();
     m_pos.y() = point.y();
     
-    gcode << "G1 X" << XYZ_NUM(point.x())
-          <<   " Y" << XYZ_NUM(point.y())
-          <<   " F" << F_NUM(this->config.travel_speed.value * 60.0);
+    gcode += "G1 X"; XYZ_NUM(point.x());
+    gcode +=   " Y"; XYZ_NUM(point.y());
+    gcode +=   " F"; F_NUM(this->config.travel_speed.value * 60.0);
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
+    return gcode;
 }
 
 std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &comment)
@@ -490,19 +530,19 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
     m_lifted = 0;
     m_pos = point;
 
-    std::ostringstream gcode;
-    gcode << write_acceleration();
-    gcode << "G1 X" << XYZ_NUM(point.x())
-          << " Y" << XYZ_NUM(point.y());
+    std::string gcode = write_acceleration();
+    gcode += "G1 X"; XYZ_NUM(point.x());
+    gcode += " Y"; XYZ_NUM(point.y());
+    gcode += " Z";
     if (config.z_step > SCALING_FACTOR)
-        gcode << " Z" << PRECISION(point.z(), 6);
+        PRECISION(point.z(), 6);
     else
-        gcode << " Z" << XYZ_NUM(point.z());
-    gcode <<   " F" << F_NUM(this->config.travel_speed.value * 60.0);
+        XYZ_NUM(point.z());
+    gcode +=   " F"; F_NUM(this->config.travel_speed.value * 60.0);
 
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
+    return gcode;
 }
 
 std::string GCodeWriter::travel_to_z(double z, const std::string &comment)
@@ -528,18 +568,18 @@ std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
 {
     m_pos.z() = z;
 
-    std::ostringstream gcode;
-
-    gcode << write_acceleration();    if (config.z_step > SCALING_FACTOR)
-        gcode << "G1 Z" << PRECISION(z, 6);
+    std::string gcode = write_acceleration();
+    gcode += "G1 Z";
+    if (config.z_step > SCALING_FACTOR)
+        PRECISION(z, 6);
     else
-        gcode << "G1 Z" << XYZ_NUM(z);
+        XYZ_NUM(z);
 
     const double speed = this->config.travel_speed_z.value == 0.0 ? this->config.travel_speed.value : this->config.travel_speed_z.value;
-    gcode <<   " F" << F_NUM(speed * 60.0);
+    gcode +=   " F"; F_NUM(speed * 60.0);
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
+    return gcode;
 }
 
 bool GCodeWriter::will_move_z(double z) const
@@ -561,15 +601,15 @@ std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std:
     m_pos.y() = point.y();
     bool is_extrude = m_tool->extrude(dE) != 0;
 
-    std::ostringstream gcode;
-    gcode << write_acceleration();
-    gcode << "G1 X" << XYZ_NUM(point.x())
-        << " Y" << XYZ_NUM(point.y());
-    if(is_extrude)
-        gcode <<    " " << m_extrusion_axis << E_NUM(m_tool->E());
+    std::string gcode = write_acceleration();
+    gcode += "G1 X"; XYZ_NUM(point.x());
+    gcode += " Y"; XYZ_NUM(point.y());
+    if (is_extrude) {
+        gcode += " "; gcode += m_extrusion_axis; E_NUM(m_tool->E());
+    }
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
+    return gcode;
 }
 
 std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment)
@@ -580,16 +620,41 @@ std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std
     m_lifted = 0;
     bool is_extrude = m_tool->extrude(dE) != 0;
 
-    std::ostringstream gcode;
-    gcode << write_acceleration();
-    gcode << "G1 X" << XYZ_NUM(point.x())
-        << " Y" << XYZ_NUM(point.y())
-        << " Z" << XYZ_NUM(point.z() + m_pos.z());
-    if (is_extrude)
-            gcode <<    " " << m_extrusion_axis << E_NUM(m_tool->E());
+    std::string gcode = write_acceleration();
+    gcode += "G1 X"; XYZ_NUM(point.x());
+    gcode += " Y"; XYZ_NUM(point.y());
+    gcode += " Z"; XYZ_NUM(point.z() + m_pos.z());
+    if (is_extrude) {
+        gcode += " "; gcode += m_extrusion_axis; E_NUM(m_tool->E());
+    }
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
+    return gcode;
+}
+
+bool GCodeWriter::use_arc_fitting() const
+{
+    return this->config.arc_fitting.value && FLAVOR_IS_NOT(gcfTeacup) && FLAVOR_IS_NOT(gcfMakerWare) && FLAVOR_IS_NOT(gcfSailfish);
+}
+
+std::string GCodeWriter::extrude_arc_to_xy(const Vec2d &point, const Vec2d &center_offset, double dE, bool ccw, const std::string &comment)
+{
+    assert(dE == dE);
+    m_pos.x() = point.x();
+    m_pos.y() = point.y();
+    bool is_extrude = m_tool->extrude(dE) != 0;
+
+    std::string gcode = write_acceleration();
+    gcode += ccw ? "G3 X" : "G2 X"; XYZ_NUM(point.x());
+    gcode += " Y"; XYZ_NUM(point.y());
+    gcode += " I"; XYZ_NUM(center_offset.x());
+    gcode += " J"; XYZ_NUM(center_offset.y());
+    if (is_extrude) {
+        gcode += " "; gcode += m_extrusion_axis; E_NUM(m_tool->E());
+    }
+    COMMENT(comment);
+    gcode += "\n";
+    return gcode;
 }
 
 std::string GCodeWriter::retract(bool before_wipe)
@@ -624,7 +689,7 @@ std::string GCodeWriter::retract_for_toolchange(bool before_wipe)
 
 std::string GCodeWriter::_retract(double length, double restart_extra, const std::string &comment)
 {
-    std::ostringstream gcode;
+    std::string gcode;
     
     /*  If firmware retraction is enabled, we use a fake value of 1
         since we ignore the actual configured retract_length which 
@@ -645,29 +710,29 @@ std::string GCodeWriter::_retract(double length, double restart_extra, const std
     if (dE != 0) {
         if (this->config.use_firmware_retraction) {
             if (FLAVOR_IS(gcfMachinekit))
-                gcode << "G22 ; retract\n";
+                gcode += "G22 ; retract\n";
             else
-                gcode << "G10 ; retract\n";
+                gcode += "G10 ; retract\n";
         } else {
-            gcode << "G1 " << m_extrusion_axis << E_NUM(m_tool->E())
-                           << " F" << F_NUM(m_tool->retract_speed() * 60.);
+            gcode += "G1 "; gcode += m_extrusion_axis; E_NUM(m_tool->E());
+            gcode += " F"; F_NUM(m_tool->retract_speed() * 60.);
             COMMENT(comment);
-            gcode << "\n";
+            gcode += "\n";
         }
     }
     
     if (FLAVOR_IS(gcfMakerWare))
-        gcode << "M103 ; extruder off\n";
+        gcode += "M103 ; extruder off\n";
     
-    return gcode.str();
+    return gcode;
 }
 
 std::string GCodeWriter::unretract()
 {
-    std::ostringstream gcode;
+    std::string gcode;
     
     if (FLAVOR_IS(gcfMakerWare))
-        gcode << "M101 ; extruder on\n";
+        gcode += "M101 ; extruder on\n";
     
     double dE = m_tool->unretract();
     assert(dE >= 0);
@@ -675,20 +740,20 @@ std::string GCodeWriter::unretract()
     if (dE != 0) {
         if (this->config.use_firmware_retraction) {
             if (FLAVOR_IS(gcfMachinekit))
-                 gcode << "G23 ; unretract\n";
+                 gcode += "G23 ; unretract\n";
             else
-                 gcode << "G11 ; unretract\n";
-            gcode << this->reset_e();
+                 gcode += "G11 ; unretract\n";
+            gcode += this->reset_e();
         } else {
             // use G1 instead of G0 because G0 will blend the restart with the previous travel move
-            gcode << "G1 " << m_extrusion_axis << E_NUM(m_tool->E())
-                           << " F" << F_NUM(m_tool->deretract_speed() * 60.);
-            if (this->config.gcode_comments) gcode << " ; unretract";
-            gcode << "\n";
+            gcode += "G1 "; gcode += m_extrusion_axis; E_NUM(m_tool->E());
+            gcode += " F"; F_NUM(m_tool->deretract_speed() * 60.);
+            if (this->config.gcode_comments) gcode += " ; unretract";
+            gcode += "\n";
         }
     }
     
-    return gcode.str();
+    return gcode;
 }
 
 /*  If this method is called more than once before calling unlift(),
@@ -70,6 +70,10 @@ public:
     bool        will_move_z(double z) const;
     std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string());
     std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string());
+    // Are the extrusions to be fitted with arcs? Not all the firmwares understand G2 / G3.
+    bool        use_arc_fitting() const;
+    // Arc around the center placed at center_offset from the current position, counter-clockwise if ccw.
+    std::string extrude_arc_to_xy(const Vec2d &point, const Vec2d &center_offset, double dE, bool ccw, const std::string &comment = std::string());
     std::string retract(bool before_wipe = false);
     std::string retract_for_toolchange(bool before_wipe = false);
     std::string unretract();
@@ -31,10 +31,21 @@ public:
 	KDTreeIndirect(KDTreeIndirect &&rhs) : m_nodes(std::move(rhs.m_nodes)), coordinate(std::move(rhs.coordinate)) {}
 	KDTreeIndirect& operator=(KDTreeIndirect &&rhs) { m_nodes = std::move(rhs.m_nodes); coordinate = std::move(rhs.coordinate); return *this; }
 	void clear() { m_nodes.clear(); }
+	// Exchange the memory of the nodes with an external buffer. Building many small trees in a row,
+	// the memory allocated by the previous tree may be handed over to the next one.
+	void swap_nodes(std::vector<size_t> &nodes) { m_nodes.swap(nodes); }
 
 	void build(size_t num_indices)
 	{
 		std::vector<size_t> indices;
+		this->build(num_indices, indices);
+	}
+
+	// Build over the <0, num_indices) indices, using the indices vector as a scratch buffer.
+	// The indices vector is left empty, but it keeps its capacity to be reused for building another tree.
+	void build(size_t num_indices, std::vector<size_t> &indices)
+	{
+		indices.clear();
 		indices.reserve(num_indices);
 		for (size_t i = 0; i < num_indices; ++ i)
 			indices.emplace_back(i);
@@ -230,6 +241,37 @@ size_t find_closest_point(const KDTreeIndirectType& kdtree, const PointType& poi
 	return find_closest_point(kdtree, point, [](size_t) { return true; });
 }
 
+// Find all points within max_distance from the center point using Euclidian metrics.
+template<typename KDTreeIndirectType, typename PointType, typename FilterFn>
+void find_nearby_points(const KDTreeIndirectType &kdtree, const PointType &center, const typename KDTreeIndirectType::CoordType &max_distance, FilterFn filter, std::vector<size_t> &out)
+{
+	struct Visitor {
+		using CoordType = typename KDTreeIndirectType::CoordType;
+		const KDTreeIndirectType   &kdtree;
+		const PointType    		   &center;
+		const CoordType				max_distance_squared;
+		const FilterFn				filter;
+		std::vector<size_t> 	   &out;
+
+		Visitor(const KDTreeIndirectType &kdtree, const PointType &center, const CoordType &max_distance, FilterFn filter, std::vector<size_t> &out) :
+			kdtree(kdtree), center(center), max_distance_squared(max_distance * max_distance), filter(filter), out(out) {}
+		unsigned int operator()(size_t idx, size_t dimension) {
+			if (this->filter(idx)) {
+				auto dist = CoordType(0);
+				for (size_t i = 0; i < KDTreeIndirectType::NumDimensions; ++ i) {
+					CoordType d = center[i] - kdtree.coordinate(idx, i);
+					dist += d * d;
+				}
+				if (dist <= max_distance_squared)
+					out.emplace_back(idx);
+			}
+			return kdtree.descent_mask(center[dimension], max_distance_squared, idx, dimension);
+		}
+	} visitor(kdtree, center, max_distance, filter, out);
+
+	kdtree.visit(visitor);
+}
+
 } // namespace Slic3r
 
 #endif /* slic3r_KDTreeIndirect_hpp_ */
@@ -4,6 +4,9 @@
 #include "Fill/Fill.hpp"
 #include "ShortestPath.hpp"
 #include "SVG.hpp"
+#include "Tracing.hpp"
+
+#include <unordered_map>
 
 #include <boost/log/trivial.hpp>
 
@@ -113,89 +116,83 @@ ExPolygons Layer::merged(float offset_scaled) const
     return out;
 }
 
+// Merge the surfaces of a group into new_slices. Surfaces whose bounding boxes do not touch any other surface
+// of the group are appended as they are, only the clusters of touching surfaces are unioned.
+static void merge_touching_surfaces(const Surfaces &surfaces, SurfaceCollection &new_slices)
+{
+    if (surfaces.size() == 1) {
+        new_slices.surfaces.emplace_back(surfaces.front());
+        return;
+    }
+    std::vector<BoundingBox> bboxes;
+    bboxes.reserve(surfaces.size());
+    for (const Surface &surface : surfaces) {
+        BoundingBox bbox = get_extents(surface.expolygon);
+        // the safety offset of union_ex() may merge surfaces that only touch
+        bbox.offset(SCALED_EPSILON);
+        bboxes.emplace_back(bbox);
+    }
+    // Union-find over the overlapping bounding boxes.
+    std::vector<size_t> parent(surfaces.size());
+    for (size_t i = 0; i < parent.size(); ++ i)
+        parent[i] = i;
+    auto find_root = [&parent](size_t i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    for (size_t i = 0; i < surfaces.size(); ++ i)
+        for (size_t j = i + 1; j < surfaces.size(); ++ j)
+            if (bboxes[i].overlap(bboxes[j]))
+                parent[find_root(j)] = find_root(i);
+    std::vector<Surfaces> clusters(surfaces.size());
+    for (size_t i = 0; i < surfaces.size(); ++ i)
+        clusters[find_root(i)].emplace_back(surfaces[i]);
+    for (Surfaces &cluster : clusters)
+        if (cluster.size() == 1)
+            new_slices.surfaces.emplace_back(std::move(cluster.front()));
+        else if (! cluster.empty())
+            new_slices.append(union_ex(cluster, true), cluster.front());
+}
+
 // Here the perimeters are created cummulatively for all layer regions sharing the same parameters influencing the perimeters.
 // The perimeter paths and the thin fills (ExtrusionEntityCollection) are assigned to the first compatible layer region.
 // The resulting fill surface is split back among the originating regions.
 void Layer::make_perimeters()
 {
+    SLIC3R_TRACE_ZONE("Layer::make_perimeters");
     BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id();
     
-    // keep track of regions whose perimeters we have already generated
-    std::vector<unsigned char> done(m_regions.size(), false);
-    
-    for (LayerRegionPtrs::iterator layerm = m_regions.begin(); layerm != m_regions.end(); ++ layerm) {
-      if ((*layerm)->slices().empty()) {
-          (*layerm)->perimeters.clear();
-          (*layerm)->fills.clear();
-          (*layerm)->ironings.clear();
-          (*layerm)->thin_fills.clear();
-      } else {
-        size_t region_id = layerm - m_regions.begin();
-        if (done[region_id])
+    // Group the regions with the same perimeter settings. The fingerprint of these settings is computed
+    // by PrintRegion whenever its config changes, so the grouping is a hash lookup per region.
+    std::vector<LayerRegionPtrs> groups;
+    std::unordered_map<size_t, std::vector<size_t>> hash_to_groups;
+    for (LayerRegion *layerm : m_regions) {
+        if (layerm->slices().empty()) {
+            layerm->perimeters.clear();
+            layerm->fills.clear();
+            layerm->ironings.clear();
+            layerm->thin_fills.clear();
             continue;
-        BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << ", region " << region_id;
-        done[region_id] = true;
-        const PrintRegionConfig &config = (*layerm)->region()->config();
-        
-        // find compatible regions
-        LayerRegionPtrs layerms;
-        layerms.push_back(*layerm);
-        for (LayerRegionPtrs::const_iterator it = layerm + 1; it != m_regions.end(); ++it) {
-            LayerRegion* other_layerm = *it;
-            const PrintRegionConfig &other_config = other_layerm->region()->config();
-            if (other_layerm->slices().empty()) continue;
-            /// !!! add here the settings you want to be added in the per-object menu.
-            /// if you don't do that, objects will share the same region, and the same settings.
-            if (config.perimeter_extruder           == other_config.perimeter_extruder
-                && config.perimeters                == other_config.perimeters
-                && config.external_perimeter_extrusion_width == other_config.external_perimeter_extrusion_width
-                && config.external_perimeter_overlap == other_config.external_perimeter_overlap
-                && config.external_perimeter_speed == other_config.external_perimeter_speed // it os mandatory? can't this be set at gcode.cpp?
-                && config.external_perimeters_first == other_config.external_perimeters_first
-                && config.external_perimeters_hole  == other_config.external_perimeters_hole
-                && config.external_perimeters_nothole == other_config.external_perimeters_nothole
-                && config.external_perimeters_vase == other_config.external_perimeters_vase
-                && config.extra_perimeters_odd_layers == other_config.extra_perimeters_odd_layers
-                && config.extra_perimeters_overhangs == other_config.extra_perimeters_overhangs
-                && config.gap_fill                  == other_config.gap_fill
-                && config.gap_fill_last             == other_config.gap_fill_last
-                && config.gap_fill_min_area         == other_config.gap_fill_min_area
-                && config.gap_fill_overlap          == other_config.gap_fill_overlap
-                && config.gap_fill_speed            == other_config.gap_fill_speed
-                && config.infill_dense              == other_config.infill_dense
-                && config.infill_dense_algo         == other_config.infill_dense_algo
-                && config.no_perimeter_unsupported_algo == other_config.no_perimeter_unsupported_algo
-                && config.only_one_perimeter_top    == other_config.only_one_perimeter_top
-                && config.only_one_perimeter_top_other_algo == other_config.only_one_perimeter_top_other_algo
-                && config.overhangs_width_speed     == other_config.overhangs_width_speed
-                && config.overhangs_width           == other_config.overhangs_width
-                && config.overhangs_reverse         == other_config.overhangs_reverse
-                && config.overhangs_reverse_threshold == other_config.overhangs_reverse_threshold
-                && config.perimeter_extrusion_width == other_config.perimeter_extrusion_width
-                && config.perimeter_loop            == other_config.perimeter_loop
-                && config.perimeter_loop_seam       == other_config.perimeter_loop_seam
-                && config.perimeter_overlap         == other_config.perimeter_overlap
-                && config.perimeter_speed           == other_config.perimeter_speed // it os mandatory? can't this be set at gcode.cpp?
-                && config.small_perimeter_speed     == other_config.small_perimeter_speed
-                && config.small_perimeter_min_length == other_config.small_perimeter_min_length
-                && config.small_perimeter_max_length == other_config.small_perimeter_max_length
-                && config.thin_walls                == other_config.thin_walls
-                && config.thin_walls_min_width      == other_config.thin_walls_min_width
-                && config.thin_walls_overlap        == other_config.thin_walls_overlap
-                && config.thin_perimeters           == other_config.thin_perimeters
-                && config.thin_perimeters_all       == other_config.thin_perimeters_all
-                && config.thin_walls_speed          == other_config.thin_walls_speed
-                && config.infill_overlap            == other_config.infill_overlap
-                && config.perimeter_loop            == other_config.perimeter_loop) {
-                layerms.push_back(other_layerm);
-                done[it - m_regions.begin()] = true;
-            }
         }
-        
+        std::vector<size_t> &candidates = hash_to_groups[layerm->region()->perimeter_config_hash()];
+        auto it_group = std::find_if(candidates.begin(), candidates.end(), [&groups, layerm](size_t idx) {
+            return groups[idx].front()->region()->has_same_perimeter_config(*layerm->region());
+        });
+        if (it_group == candidates.end()) {
+            candidates.emplace_back(groups.size());
+            groups.emplace_back(LayerRegionPtrs{ layerm });
+        } else
+            groups[*it_group].emplace_back(layerm);
+    }
+
+    for (LayerRegionPtrs &layerms : groups) {
+        BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << ", group of " << layerms.size() << " region(s)";
         if (layerms.size() == 1) {  // optimization
-            (*layerm)->fill_surfaces.surfaces.clear();
-            (*layerm)->make_perimeters((*layerm)->slices(), &(*layerm)->fill_surfaces);
-            (*layerm)->fill_expolygons = to_expolygons((*layerm)->fill_surfaces.surfaces);
+            LayerRegion *layerm = layerms.front();
+            layerm->fill_surfaces.surfaces.clear();
+            layerm->make_perimeters(layerm->slices(), &layerm->fill_surfaces);
+            layerm->fill_expolygons = to_expolygons(layerm->fill_surfaces.surfaces);
         } else {
             SurfaceCollection new_slices;
             // Use the region with highest infill rate, as the make_perimeters() function below decides on the gap fill based on the infill existence.
@@ -213,9 +210,9 @@ void Layer::make_perimeters()
                     layerm->thin_fills.clear();
                     layerm->fill_no_overlap_expolygons.clear();
                 }
-                // merge the surfaces assigned to each group
+                // merge the surfaces assigned to each group, only where they touch
                 for (std::pair<const unsigned short,Surfaces> &surfaces_with_extra_perimeters : slices)
-                    new_slices.append(union_ex(surfaces_with_extra_perimeters.second, true), surfaces_with_extra_perimeters.second.front());
+                    merge_touching_surfaces(surfaces_with_extra_perimeters.second, new_slices);
             }
             
             // make perimeters
@@ -239,11 +236,58 @@ void Layer::make_perimeters()
                 }
             }
         }
-      }
     }
     BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << " - Done";
 }
 
+bool Layer::has_same_perimeter_inputs(const Layer &other) const
+{
+    // The first layer is printed with its own flows.
+    if (this->id() == 0 || other.id() == 0 || this->height != other.height || m_regions.size() != other.m_regions.size())
+        return false;
+    auto same_lslices = [](const Layer *l1, const Layer *l2) {
+        return (l1 == nullptr) == (l2 == nullptr) && (l1 == nullptr || l1->lslices == l2->lslices);
+    };
+    if (! same_lslices(this->lower_layer, other.lower_layer) || ! same_lslices(this->upper_layer, other.upper_layer))
+        return false;
+    for (size_t region_id = 0; region_id < m_regions.size(); ++ region_id) {
+        const Surfaces &surfaces       = m_regions[region_id]->slices().surfaces;
+        const Surfaces &other_surfaces = other.m_regions[region_id]->slices().surfaces;
+        if (surfaces.size() != other_surfaces.size())
+            return false;
+        for (size_t i = 0; i < surfaces.size(); ++ i) {
+            const Surface &s1 = surfaces[i];
+            const Surface &s2 = other_surfaces[i];
+            if (s1.surface_type != s2.surface_type || s1.extra_perimeters != s2.extra_perimeters || s1.thickness != s2.thickness ||
+                s1.thickness_layers != s2.thickness_layers || s1.bridge_angle != s2.bridge_angle || s1.maxNbSolidLayersOnTop != s2.maxNbSolidLayersOnTop ||
+                s1.expolygon != s2.expolygon)
+                return false;
+        }
+    }
+    return true;
+}
+
+void Layer::copy_perimeters_from(const Layer &src)
+{
+    assert(m_regions.size() == src.m_regions.size());
+    for (size_t region_id = 0; region_id < m_regions.size(); ++ region_id) {
+        LayerRegion       &layerm     = *m_regions[region_id];
+        const LayerRegion &src_layerm = *src.m_regions[region_id];
+        if (layerm.slices().empty()) {
+            layerm.perimeters.clear();
+            layerm.fills.clear();
+            layerm.ironings.clear();
+            layerm.thin_fills.clear();
+        } else {
+            layerm.perimeters                   = src_layerm.perimeters;
+            layerm.thin_fills                   = src_layerm.thin_fills;
+            layerm.fill_surfaces                = src_layerm.fill_surfaces;
+            layerm.fill_expolygons              = src_layerm.fill_expolygons;
+            layerm.fill_no_overlap_expolygons   = src_layerm.fill_no_overlap_expolygons;
+        }
+    }
+}
+
 void Layer::make_milling_post_process() {
     if (this->object()->print()->config().milling_diameter.empty()) return;
 
@@ -152,6 +152,11 @@ public:
         return false;
     }
     void                    make_perimeters();
+    // Are the inputs of make_perimeters() the same as those of the other layer, so that both layers get the same perimeters?
+    // The odd and even layers differ with some of the options, the caller has to take care of them.
+    bool                    has_same_perimeter_inputs(const Layer &other) const;
+    // Copy the results of make_perimeters() from a layer with the same inputs.
+    void                    copy_perimeters_from(const Layer &src);
 
     void                    make_milling_post_process();    void                    make_fills() { this->make_fills(nullptr, nullptr); };
     void                    make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree);
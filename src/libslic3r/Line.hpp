@@ -82,7 +82,8 @@ public:
     static inline double distance_to_squared(const Point &point, const Point &a, const Point &b) { return line_alg::distance_to_squared(Line{a, b}, Vec<2, coord_t>{point}); }
     static double distance_to(const Point &point, const Point &a, const Point &b) { return sqrt(distance_to_squared(point, a, b)); }
     Point point_at(double distance) const;
-    coord_t dot(const Line &l2) const { return vector().dot(l2.vector()); }
+    // Evaluated with 64bit intermediates, the dot product of two 32bit vectors does not fit 32 bits.
+    int64_t dot(const Line &l2) const { return vector().cast<int64_t>().dot(l2.vector().cast<int64_t>()); }
     void extend_end(double distance) { Line line = *this; line.reverse(); this->b = line.point_at(-distance); }
     void extend_start(double distance) { this->a = this->point_at(-distance); }
 
@@ -28,10 +28,17 @@ MedialAxis::build(Polylines &polylines)
 void
 MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* polylines)
 {
-    std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > thickness;
     Lines lines = voronoi_edges;
     VD vd;
     construct_voronoi(lines.begin(), lines.end(), &vd);
+    if (vd.edges().empty())
+        return;
+    EdgesState state;
+    state.first_edge = &vd.edges().front();
+    state.thickness.assign(vd.edges().size(), std::pair<coordf_t, coordf_t>(0., 0.));
+    state.valid.assign(vd.edges().size(), false);
+    // The edges are validated against this->expolygon, which differs from voronoi_edges for the stop-gap in build().
+    const Lines boundary = this->expolygon.lines();
 
     typedef const VD::edge_type   edge_t;
     
@@ -58,37 +65,39 @@ MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* po
     
     
     // collect valid edges (i.e. prune those not belonging to MAT)
-    // note: this keeps twins, so it inserts twice the number of the valid edges
-    std::set<const VD::edge_type*> valid_edges;
+    // note: this keeps twins, so it marks twice the number of the valid edges
     {
-        std::set<const edge_t*> seen_edges;
+        std::vector<unsigned char> seen_edges(vd.edges().size(), false);
         for (VD::const_edge_iterator edge = vd.edges().begin(); edge != vd.edges().end(); ++edge) {
             // if we only process segments representing closed loops, none if the
             // infinite edges (if any) would be part of our MAT anyway
             if (edge->is_secondary() || edge->is_infinite()) continue;
         
             // don't re-validate twins
-            if (seen_edges.find(&*edge) != seen_edges.end()) continue;  // TODO: is this needed?
-            seen_edges.insert(&*edge);
-            seen_edges.insert(edge->twin());
+            if (seen_edges[state.idx(&*edge)]) continue;  // TODO: is this needed?
+            seen_edges[state.idx(&*edge)] = true;
+            seen_edges[state.idx(edge->twin())] = true;
             
-            if (!this->validate_edge(&*edge, lines, thickness)) continue;
-            valid_edges.insert(&*edge);
-            valid_edges.insert(edge->twin());
+            if (!this->validate_edge(&*edge, lines, boundary, state)) continue;
+            state.valid[state.idx(&*edge)] = true;
+            state.valid[state.idx(edge->twin())] = true;
         }
     }
-    std::set<const VD::edge_type*> edges = valid_edges;
+    state.remaining = state.valid;
     
-    // iterate through the valid edges to build polylines
-    while (!edges.empty()) {
-        const edge_t* edge = *edges.begin();
-        if (thickness[edge].first > this->max_width*1.001) {
+    // iterate through the valid edges to build polylines, starting with the first remaining edge of the diagram
+    for (size_t edge_idx = 0; edge_idx < vd.edges().size(); ++ edge_idx) {
+        if (! state.remaining[edge_idx])
+            continue;
+        const edge_t* edge = &vd.edges()[edge_idx];
+        const std::pair<coordf_t, coordf_t> &thickness = state.thickness[edge_idx];
+        if (thickness.first > this->max_width*1.001) {
             //std::cerr << "Error, edge.first has a thickness of " << unscaled(this->thickness[edge].first) << " > " << unscaled(this->max_width) << "\n";
             //(void)this->edges.erase(edge);
             //(void)this->edges.erase(edge->twin());
             //continue;
         }
-        if (thickness[edge].second > this->max_width*1.001) {
+        if (thickness.second > this->max_width*1.001) {
             //std::cerr << "Error, edge.second has a thickness of " << unscaled(this->thickness[edge].second) << " > " << unscaled(this->max_width) << "\n";
             //(void)this->edges.erase(edge);
             //(void)this->edges.erase(edge->twin());
@@ -99,20 +108,20 @@ MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* po
         ThickPolyline polyline;
         polyline.points.push_back(Point( edge->vertex0()->x(), edge->vertex0()->y() ));
         polyline.points.push_back(Point( edge->vertex1()->x(), edge->vertex1()->y() ));
-        polyline.width.push_back(thickness[edge].first);
-        polyline.width.push_back(thickness[edge].second);
+        polyline.width.push_back(thickness.first);
+        polyline.width.push_back(thickness.second);
         
         // remove this edge and its twin from the available edges
-        (void)edges.erase(edge);
-        (void)edges.erase(edge->twin());
+        state.remaining[edge_idx] = false;
+        state.remaining[state.idx(edge->twin())] = false;
         
         // get next points
-        this->process_edge_neighbors(edge, &polyline, edges, valid_edges, thickness);
+        this->process_edge_neighbors(edge, &polyline, state);
         
         // get previous points
         {
             ThickPolyline rpolyline;
-            this->process_edge_neighbors(edge->twin(), &rpolyline, edges, valid_edges, thickness);
+            this->process_edge_neighbors(edge->twin(), &rpolyline, state);
             polyline.points.insert(polyline.points.begin(), rpolyline.points.rbegin(), rpolyline.points.rend());
             polyline.width.insert(polyline.width.begin(), rpolyline.width.rbegin(), rpolyline.width.rend());
             polyline.endpoints.first = rpolyline.endpoints.second;
@@ -148,7 +157,7 @@ MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* po
 }
 
 void
-MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline, std::set<const VD::edge_type*> &edges, std::set<const VD::edge_type*> &valid_edges, std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > &thickness)
+MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline, EdgesState &state)
 {
     while (true) {
         // Since rot_next() works on the edge starting point but we want
@@ -160,7 +169,7 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
         std::vector<const VD::edge_type*> neighbors;
         for (const VD::edge_type* neighbor = twin->rot_next(); neighbor != twin;
             neighbor = neighbor->rot_next()) {
-            if (valid_edges.count(neighbor) > 0) neighbors.push_back(neighbor);
+            if (state.valid[state.idx(neighbor)]) neighbors.push_back(neighbor);
         }
     
         // if we have a single neighbor then we can continue recursively
@@ -168,14 +177,14 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
             const VD::edge_type* neighbor = neighbors.front();
             
             // break if this is a closed loop
-            if (edges.count(neighbor) == 0) return;
+            if (! state.remaining[state.idx(neighbor)]) return;
             
             Point new_point(neighbor->vertex1()->x(), neighbor->vertex1()->y());
             polyline->points.push_back(new_point);
-            polyline->width.push_back(thickness[neighbor].second);
+            polyline->width.push_back(state.thickness[state.idx(neighbor)].second);
             
-            (void)edges.erase(neighbor);
-            (void)edges.erase(neighbor->twin());
+            state.remaining[state.idx(neighbor)] = false;
+            state.remaining[state.idx(neighbor->twin())] = false;
             edge = neighbor;
         } else if (neighbors.size() == 0) {
             polyline->endpoints.second = true;
@@ -187,8 +196,44 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
     }
 }
 
+// Position of a segment against the boundary of an expolygon, decided without the Clipper:
+// 1 if the segment is strictly inside, -1 if it is strictly outside, 0 if it touches or crosses the boundary or if it is too close to tell.
+static int segment_position_by_boundary(const Line &line, const ExPolygon &expolygon, const Lines &boundary)
+{
+    const Vec2d a = line.a.cast<double>();
+    const Vec2d b = line.b.cast<double>();
+    const BoundingBox bbox(Points{ line.a, line.b });
+    // Side of q relative to the line (p, p + dir), 0 if q is on the line or too close to it to be sure with the rounding errors.
+    // The coordinates are integers, their differences are exact in double.
+    auto side = [](const Vec2d &p, const Vec2d &dir, const Vec2d &q) {
+        const Vec2d  w   = q - p;
+        const double l   = dir.x() * w.y();
+        const double r   = dir.y() * w.x();
+        const double err = 1e-14 * (std::abs(l) + std::abs(r));
+        return l - r > err ? 1 : l - r < - err ? -1 : 0;
+    };
+    for (const Line &segment : boundary) {
+        if (std::max(segment.a.x(), segment.b.x()) < bbox.min.x() || std::min(segment.a.x(), segment.b.x()) > bbox.max.x() ||
+            std::max(segment.a.y(), segment.b.y()) < bbox.min.y() || std::min(segment.a.y(), segment.b.y()) > bbox.max.y())
+            continue;
+        const Vec2d p = segment.a.cast<double>();
+        const Vec2d q = segment.b.cast<double>();
+        const int   s1 = side(a, b - a, p);
+        const int   s2 = side(a, b - a, q);
+        if (s1 != 0 && s1 == s2)
+            continue;
+        const int   s3 = side(p, q - p, a);
+        const int   s4 = side(p, q - p, b);
+        if (s3 != 0 && s3 == s4)
+            continue;
+        return 0;
+    }
+    // The segment does not touch the boundary, thus its first point is not on the boundary either.
+    return expolygon.contains(line.a) ? 1 : -1;
+}
+
 bool
-MedialAxis::validate_edge(const VD::edge_type* edge, Lines &lines, std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > &thickness)
+MedialAxis::validate_edge(const VD::edge_type* edge, Lines &lines, const Lines &boundary, EdgesState &state)
 {
     // prevent overflows and detect almost-infinite edges
     if (std::abs(edge->vertex0()->x()) > double(CLIPPER_MAX_COORD_UNSCALED) ||
@@ -213,6 +258,10 @@ MedialAxis::validate_edge(const VD::edge_type* edge, Lines &lines, std::map<cons
     if (line.a.coincides_with_epsilon(line.b)) {
         // in this case, contains(line) returns a false positive
         if (!this->expolygon.contains(line.a)) return false;
+    } else if (int position = segment_position_by_boundary(line, this->expolygon, boundary); position != 0) {
+        // Most of the edges are far from the boundary, the Clipper is only needed for those touching it.
+        if (position < 0 && line.length() > SCALED_EPSILON)
+            return false;
     } else {
         //test if  (!expolygon.contains(line))
         Polylines external_bits = diff_pl(Polylines{ Polyline{ line.a, line.b } }, expolygon);
@@ -301,8 +350,8 @@ MedialAxis::validate_edge(const VD::edge_type* edge, Lines &lines, std::map<cons
     if (w0 > this->max_width*1.05 && w1 > this->max_width*1.05)
         return false;
     
-    thickness[edge]         = std::make_pair(w0, w1);
-    thickness[edge->twin()] = std::make_pair(w1, w0);
+    state.thickness[state.idx(edge)]         = std::make_pair(w0, w1);
+    state.thickness[state.idx(edge->twin())] = std::make_pair(w1, w0);
     
     return true;
 }
@@ -74,8 +74,19 @@ class MedialAxis {
             typedef boost::polygon::segment_data<coordinate_type>   segment_type;
             typedef boost::polygon::rectangle_data<coordinate_type> rect_type;
         };
-        void process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline, std::set<const VD::edge_type*> &edges, std::set<const VD::edge_type*> &valid_edges, std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > &thickness);
-        bool validate_edge(const VD::edge_type* edge, Lines &lines, std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > &thickness);
+        /// state of the edges of the Voronoi diagram in polyline_from_voronoi(), indexed by the position of the edge in the diagram.
+        struct EdgesState {
+            const VD::edge_type*                        first_edge { nullptr };
+            /// thickness at the start and at the end of a valid edge
+            std::vector<std::pair<coordf_t, coordf_t>>  thickness;
+            /// edges belonging to the medial axis
+            std::vector<unsigned char>                  valid;
+            /// valid edges not yet collected into a polyline
+            std::vector<unsigned char>                  remaining;
+            size_t idx(const VD::edge_type* edge) const { return edge - first_edge; }
+        };
+        void process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline, EdgesState &state);
+        bool validate_edge(const VD::edge_type* edge, Lines &lines, const Lines &boundary, EdgesState &state);
         const Line& retrieve_segment(const VD::cell_type* cell, Lines& lines) const;
         const Point& retrieve_endpoint(const VD::cell_type* cell, Lines& lines) const;
         void polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* polylines_out);
@@ -1,6 +1,11 @@
 #include "Exception.hpp"
 #include "MeshBoolean.hpp"
 #include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/BoundingBox.hpp"
+
+#include <numeric>
+
+#include <tbb/parallel_for.h>
 #undef PI
 
 // Include igl first. It defines "L" macro which then clashes with our localization
@@ -246,9 +251,81 @@ template<class Op> void _mesh_boolean_do(Op &&op, TriangleMesh &A, const Triangl
     A = cgal_to_triangle_mesh(meshA.m);
 }
 
+// Disjoint set over indices with path halving.
+static size_t _find_root(std::vector<size_t> &parent, size_t i)
+{
+    while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+    return i;
+}
+
+// Splits the indexed triangle set into the parts connected through shared vertices.
+static std::vector<indexed_triangle_set> _connected_parts(const indexed_triangle_set &its)
+{
+    std::vector<size_t> parent(its.vertices.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for (const stl_triangle_vertex_indices &f : its.indices)
+        for (int i = 1; i < 3; ++ i)
+            parent[_find_root(parent, size_t(f(i)))] = _find_root(parent, size_t(f(0)));
+
+    std::vector<int> part_of_root(its.vertices.size(), -1);
+    std::vector<int> new_vertex_id(its.vertices.size(), -1);
+    std::vector<indexed_triangle_set> parts;
+    for (const stl_triangle_vertex_indices &f : its.indices) {
+        size_t root = _find_root(parent, size_t(f(0)));
+        if (part_of_root[root] == -1) {
+            part_of_root[root] = int(parts.size());
+            parts.emplace_back();
+        }
+        indexed_triangle_set &part = parts[part_of_root[root]];
+        stl_triangle_vertex_indices nf;
+        for (int i = 0; i < 3; ++ i) {
+            int &id = new_vertex_id[f(i)];
+            if (id == -1) {
+                id = int(part.vertices.size());
+                part.vertices.emplace_back(its.vertices[f(i)]);
+            }
+            nf(i) = id;
+        }
+        part.indices.emplace_back(nf);
+    }
+    return parts;
+}
+
+static BoundingBoxf3 _bounding_box(const indexed_triangle_set &its)
+{
+    BoundingBoxf3 bb;
+    for (const stl_vertex &v : its.vertices)
+        bb.merge(v.cast<double>());
+    return bb;
+}
+
+static void _merge(TriangleMesh &A, const indexed_triangle_set &its)
+{
+    if (! its.indices.empty())
+        A.merge(TriangleMesh(its));
+}
+
 void minus(TriangleMesh &A, const TriangleMesh &B)
 {
-    _mesh_boolean_do(_cgal_diff, A, B);
+    // Only the parts of A close to B take part in the corefinement, the rest is copied over.
+    // A part enclosing another part has a larger bounding box, thus the shells enclosing
+    // a touched part are touched as well and CGAL still sees the complete nesting to orient.
+    BoundingBoxf3 bbB = B.bounding_box();
+    TriangleMesh touched, untouched;
+    for (const indexed_triangle_set &part : _connected_parts(A.its))
+        _merge(_bounding_box(part).intersects(bbB) ? touched : untouched, part);
+
+    if (touched.empty())
+        return;
+    if (! untouched.empty()) {
+        touched.require_shared_vertices();
+        _mesh_boolean_do(_cgal_diff, touched, B);
+        touched.merge(untouched);
+        touched.require_shared_vertices();
+        A = std::move(touched);
+    } else
+        _mesh_boolean_do(_cgal_diff, A, B);
 }
 
 void plus(TriangleMesh &A, const TriangleMesh &B)
@@ -261,6 +338,57 @@ void intersect(TriangleMesh &A, const TriangleMesh &B)
     _mesh_boolean_do(_cgal_intersection, A, B);
 }
 
+TriangleMesh plus(const std::vector<TriangleMesh> &meshes)
+{
+    // Cluster the meshes with overlapping bounding boxes, only the meshes of a cluster
+    // need to be united with CGAL. The clusters are disjoint and processed in parallel.
+    std::vector<BoundingBoxf3> bbs;
+    bbs.reserve(meshes.size());
+    for (const TriangleMesh &m : meshes)
+        bbs.emplace_back(m.bounding_box());
+
+    std::vector<size_t> parent(meshes.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for (size_t i = 0; i < meshes.size(); ++ i)
+        for (size_t j = i + 1; j < meshes.size(); ++ j)
+            if (bbs[i].intersects(bbs[j]))
+                parent[_find_root(parent, j)] = _find_root(parent, i);
+
+    std::vector<std::vector<size_t>> clusters;
+    std::vector<int> cluster_of_root(meshes.size(), -1);
+    for (size_t i = 0; i < meshes.size(); ++ i) {
+        size_t root = _find_root(parent, i);
+        if (cluster_of_root[root] == -1) {
+            cluster_of_root[root] = int(clusters.size());
+            clusters.emplace_back();
+        }
+        clusters[cluster_of_root[root]].emplace_back(i);
+    }
+
+    std::vector<TriangleMesh> united(clusters.size());
+    tbb::parallel_for(size_t(0), clusters.size(), [&meshes, &clusters, &united](size_t i) {
+        const std::vector<size_t> &cluster = clusters[i];
+        if (cluster.size() == 1) {
+            united[i] = meshes[cluster.front()];
+            return;
+        }
+        CGALMesh result;
+        triangle_mesh_to_cgal(meshes[cluster.front()], result.m);
+        for (size_t j = 1; j < cluster.size(); ++ j) {
+            CGALMesh m;
+            triangle_mesh_to_cgal(meshes[cluster[j]], m.m);
+            _cgal_do(_cgal_union, result, m);
+        }
+        united[i] = cgal_to_triangle_mesh(result.m);
+    });
+
+    TriangleMesh out;
+    for (const TriangleMesh &m : united)
+        out.merge(m);
+    out.require_shared_vertices();
+    return out;
+}
+
 bool does_self_intersect(const TriangleMesh &mesh)
 {
     CGALMesh cgalm;
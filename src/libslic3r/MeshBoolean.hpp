@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <exception>
+#include <vector>
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <Eigen/Geometry>
@@ -35,6 +36,10 @@ void minus(TriangleMesh &A, const TriangleMesh &B);
 void plus(TriangleMesh &A, const TriangleMesh &B);
 void intersect(TriangleMesh &A, const TriangleMesh &B);
 
+// Union of many meshes, typically drain holes. Only the meshes with overlapping
+// bounding boxes are united with CGAL, the disjoint groups are processed in parallel.
+TriangleMesh plus(const std::vector<TriangleMesh> &meshes);
+
 void minus(CGALMesh &A, CGALMesh &B);
 void plus(CGALMesh &A, CGALMesh &B);
 void intersect(CGALMesh &A, CGALMesh &B);
@@ -114,11 +114,6 @@ namespace Slic3r {
         milling_lines = union_ex(milling_lines);
 
         ExPolygons secured_points = offset_ex(milling_lines, double(milling_diameter / 3));
-        ExPolygons entrypoints;
-        for (const ExPolygon& expoly : secured_points)
-//            expoly.simplify(SCALED_RESOLUTION, &entrypoints); // should already be done
-            entrypoints.push_back(expoly);
-        entrypoints = union_ex(entrypoints);
         Polygons entrypoints_poly;
         for (const ExPolygon& expoly : secured_points)
             entrypoints_poly.emplace_back(expoly);
@@ -159,9 +154,6 @@ namespace Slic3r {
                 milling_lines.push_back(expoly);
             surfaces.push_back(surf.expolygon);
         }
-        union_ex(milling_lines, true);
-        union_ex(surfaces, true);
-
 
         ExPolygons exact_unmillable_area = diff_ex(offset_ex(milling_lines, -milling_radius, ClipperLib::jtRound), surfaces, true);
         if (exact_unmillable_area.empty())
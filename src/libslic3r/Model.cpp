@@ -949,10 +949,14 @@ Polygon ModelObject::convex_hull_2d(const Transform3d &trafo_instance) const
     for (const ModelVolume *v : this->volumes)
         if (v->is_model_part()) {
             Transform3d trafo = trafo_instance * v->get_matrix();
-			const indexed_triangle_set &its = v->mesh().its;
+            // The 2D convex hull of the transformed mesh is the 2D convex hull of its transformed 3D convex hull,
+            // which is calculated once per mesh and has much less vertices.
+            std::shared_ptr<const TriangleMesh> hull = v->get_convex_hull_shared_ptr();
+            const TriangleMesh &mesh = (hull && ! hull->empty()) ? *hull : v->mesh();
+			const indexed_triangle_set &its = mesh.its;
 			if (its.vertices.empty()) {
                 // Using the STL faces.
-				const stl_file& stl = v->mesh().stl;
+				const stl_file& stl = mesh.stl;
 				for (const stl_facet &facet : stl.facet_start)
                     for (size_t j = 0; j < 3; ++ j) {
                         Vec3d p = trafo * facet.vertex[j].cast<double>();
@@ -1246,9 +1250,17 @@ ModelObjectPtrs ModelObject::cut(size_t instance, coordf_t z, bool keep_upper, b
             
             mesh.require_shared_vertices();
             
-            // Perform cut
-            TriangleMeshSlicer tms(&mesh);
-            tms.cut(float(z), &upper_mesh, &lower_mesh);
+            // Perform cut, the slicer and a full repair are only needed for non-manifold sections.
+            indexed_triangle_set upper_its, lower_its;
+            if (cut_mesh(mesh.its, float(z), keep_upper ? &upper_its : nullptr, keep_lower ? &lower_its : nullptr)) {
+                if (keep_upper)
+                    upper_mesh = TriangleMesh(upper_its);
+                if (keep_lower)
+                    lower_mesh = TriangleMesh(lower_its);
+            } else {
+                TriangleMeshSlicer tms(&mesh);
+                tms.cut(float(z), &upper_mesh, &lower_mesh);
+            }
 
             // Reset volume transformation except for offset
             const Vec3d offset = volume->get_offset();
@@ -1987,7 +1999,7 @@ indexed_triangle_set FacetsAnnotation::get_facets(const ModelVolume& mv, Enforce
 
 bool FacetsAnnotation::set(const TriangleSelector& selector)
 {
-    std::map<int, std::vector<bool>> sel_map = selector.serialize();
+    const std::map<int, std::vector<bool>> &sel_map = selector.serialize();
     if (sel_map != m_data) {
         m_data = sel_map;
         this->touch();
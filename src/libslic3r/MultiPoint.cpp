@@ -47,11 +47,14 @@ void MultiPoint::rotate(double angle, const Point &center)
 
 double MultiPoint::length() const
 {
-    Lines lines = this->lines();
+    return MultiPoint::length(this->points);
+}
+
+double MultiPoint::length(const Points &points)
+{
     double len = 0;
-    for (Lines::iterator it = lines.begin(); it != lines.end(); ++it) {
-        len += it->length();
-    }
+    for (size_t i = 1; i < points.size(); ++ i)
+        len += (points[i] - points[i - 1]).cast<double>().norm();
     return len;
 }
 
@@ -181,6 +184,37 @@ Point MultiPoint::point_projection(const Point &point) const {
     return proj;
 }
 
+// Find the point of pts in the open index range (anchor_idx, floater_idx) furthest from the segment (pts[anchor_idx], pts[floater_idx]).
+// Returns the squared distance and updates furthest_idx, it is left at anchor_idx if no point is further than zero.
+// Same as calling Line::distance_to_squared() for each point, but the segment vector and its length are only calculated once
+// and the loop over the contiguous points does not branch on the projection parameter, so that the compiler may vectorize it.
+static inline double douglas_peucker_furthest_point(const std::vector<Point> &pts, size_t anchor_idx, size_t floater_idx, size_t &furthest_idx)
+{
+    const Vec2d  a  = pts[anchor_idx].cast<double>();
+    const Vec2d  b  = pts[floater_idx].cast<double>();
+    const Vec2d  v  = b - a;
+    const double l2 = v.squaredNorm();
+    double       max_dist_sq = 0.0;
+    furthest_idx = anchor_idx;
+    for (size_t i = anchor_idx + 1; i < floater_idx; ++ i) {
+        const Vec2d  va = pts[i].cast<double>() - a;
+        double dist_sq;
+        if (l2 == 0.0) {
+            // a == b case
+            dist_sq = va.squaredNorm();
+        } else {
+            const double t = va.dot(v) / l2;
+            const Vec2d  d = (t < 0.0) ? va : (t > 1.0) ? Vec2d(va - v) : Vec2d(t * v - va);
+            dist_sq = d.squaredNorm();
+        }
+        if (dist_sq > max_dist_sq) {
+            max_dist_sq  = dist_sq;
+            furthest_idx = i;
+        }
+    }
+    return max_dist_sq;
+}
+
 std::vector<Point> MultiPoint::_douglas_peucker(const std::vector<Point>& pts, const double tolerance)
 {
     std::vector<Point> result_pts;
@@ -198,16 +232,9 @@ std::vector<Point> MultiPoint::_douglas_peucker(const std::vector<Point>& pts, c
             dpStack.reserve(pts.size());
             dpStack.emplace_back(floater_idx);
             for (;;) {
-                double max_dist_sq  = 0.0;
-                size_t furthest_idx = anchor_idx;
                 // find point furthest from line seg created by (anchor, floater) and note it
-                for (size_t i = anchor_idx + 1; i < floater_idx; ++ i) {
-                    double dist_sq = Line::distance_to_squared(pts[i], *anchor, *floater);
-                    if (dist_sq > max_dist_sq) {
-                        max_dist_sq  = dist_sq;
-                        furthest_idx = i;
-                    }
-                }
+                size_t furthest_idx;
+                double max_dist_sq = douglas_peucker_furthest_point(pts, anchor_idx, floater_idx, furthest_idx);
                 // remove point if less than tolerance
                 if (max_dist_sq <= tolerance_sq) {
                     result_pts.emplace_back(*floater);
@@ -281,16 +308,9 @@ std::vector<Point> MultiPoint::_douglas_peucker_plus(const std::vector<Point>& p
             dpStack.reserve(pts.size());
             dpStack.emplace_back(floater_idx);
             for (;;) {
-                double max_dist_sq = 0.0;
-                size_t furthest_idx = anchor_idx;
                 // find point furthest from line seg created by (anchor, floater) and note it
-                for (size_t i = anchor_idx + 1; i < floater_idx; ++i) {
-                    double dist_sq = Line::distance_to_squared(pts[i], *anchor, *floater);
-                    if (dist_sq > max_dist_sq) {
-                        max_dist_sq = dist_sq;
-                        furthest_idx = i;
-                    }
-                }
+                size_t furthest_idx;
+                double max_dist_sq = douglas_peucker_furthest_point(pts, anchor_idx, floater_idx, furthest_idx);
                 // remove point if less than tolerance
                 if (max_dist_sq <= tolerance_sq) {
                     result_pts.emplace_back(*floater);
@@ -38,7 +38,8 @@ public:
     virtual Lines lines() const = 0;
     size_t size() const { return points.size(); }
     bool   empty() const { return points.empty(); }
-    double length() const;
+    // Length of the path through the points, Polygon adds the closing segment.
+    virtual double length() const;
     bool   is_valid() const { return this->points.size() >= 2; }
 
     int  find_point(const Point &point) const;
@@ -83,6 +84,9 @@ public:
     // Projection of a point onto the lines defined by the points.
     virtual Point point_projection(const Point &point) const;
 
+    // Length of the open path through the points, without building its Lines.
+    static double length(const Points &points);
+
     static Points _douglas_peucker(const Points& points, const double tolerance);
     static Points _douglas_peucker_plus(const Points& points, const double tolerance, const double min_length);
     static Points visivalingam(const Points& pts, const double& tolerance);
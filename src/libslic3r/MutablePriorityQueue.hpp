@@ -15,6 +15,8 @@ public:
 
 	void		clear();
 	void		reserve(size_t cnt) 				{ m_heap.reserve(cnt); }
+	// Exchange the memory of the heap with an external buffer, to reuse the memory allocated by another queue.
+	void		swap_storage(std::vector<T> &storage) { m_heap.swap(storage); }
 	void		push(const T &item);
 	void		push(T &&item);
 	void		pop();
@@ -9,12 +9,15 @@
 #include <cassert>
 #include <vector>
 
+#include <tbb/parallel_for.h>
+
 #include "BoundingBox.hpp"
 #include "ExPolygon.hpp"
 #include "Geometry.hpp"
 #include "Milling/MillingPostProcess.hpp"
 #include "Polygon.hpp"
 #include "Line.hpp"
+#include "Print.hpp"
 #include "ClipperUtils.hpp"
 #include "SVG.hpp"
 #include "polypartition.h"
@@ -66,7 +69,7 @@ void PerimeterGenerator::process()
     coord_t solid_infill_spacing = this->solid_infill_flow.scaled_spacing();
 
     //infill / perimeter
-    coord_t infill_peri_overlap = (coord_t)scale_(this->config->get_abs_value("infill_overlap", unscale<coordf_t>(perimeter_spacing + solid_infill_spacing) / 2));
+    const coord_t infill_peri_overlap_config = (coord_t)scale_(this->config->get_abs_value("infill_overlap", unscale<coordf_t>(perimeter_spacing + solid_infill_spacing) / 2));
     // infill gap to add vs perimeter (useful if using perimeter bonding)
     coord_t infill_gap = 0;
 
@@ -357,12 +360,26 @@ void PerimeterGenerator::process()
         }
     }
 
-    surface_idx = 0;
     const int extra_odd_perimeter = (config->extra_perimeters_odd_layers && layer->id() % 2 == 1 ? 1:0);
-    for (const Surface &surface : all_surfaces) {
+    // The islands are independent of each other, thus they are processed in parallel, each one into its own output.
+    // The outputs are then appended in the order of the islands. A layer with many islands is then shared by several threads,
+    // balanced with the other layers by the TBB scheduler.
+    struct IslandOutput {
+        ExtrusionEntityCollection   loops;
+        ExtrusionEntityCollection   gap_fill;
+        ExPolygons                  fill;
+        ExPolygons                  fill_no_overlap;
+    };
+    std::vector<IslandOutput> island_outputs(all_surfaces.size());
+    auto process_island = [&](const Surface &surface, IslandOutput &out) {
+        // A layer may take seconds for complex islands, stop between the islands once the slicing is canceled.
+        if (layer->object()->print()->canceled())
+            throw CanceledException();
+        // The onion shells are calculated by many offsets in a tight loop, reuse the Clipper buffers of this thread.
+        ClipperContext &clipper = ClipperContext::local();
+        coord_t infill_peri_overlap = infill_peri_overlap_config;
         // detect how many perimeters must be generated for this island
         int        loop_number = this->config->perimeters + surface.extra_perimeters - 1 + extra_odd_perimeter;  // 0-indexed loops
-        surface_idx++;
 
         if (this->config->only_one_perimeter_top && loop_number > 0 && this->upper_slices == NULL){
             loop_number = 0;
@@ -470,7 +487,7 @@ void PerimeterGenerator::process()
                         // the minimum thickness of a single loop is:
                         // ext_width/2 + ext_spacing/2 + spacing/2 + width/2
                     if (thin_perimeter)
-                        next_onion = offset_ex(
+                        next_onion = clipper.offset_ex(
                             last,
                             -(float)(ext_perimeter_width / 2),
                             (round_peri ? ClipperLib::JoinType::jtRound : ClipperLib::JoinType::jtMiter),
@@ -505,19 +522,19 @@ void PerimeterGenerator::process()
                         // (actually, something larger than that still may exist due to mitering or other causes)
                         coord_t min_width = (coord_t)scale_(this->config->thin_walls_min_width.get_abs_value(this->ext_perimeter_flow.nozzle_diameter));
                         
-                        ExPolygons no_thin_zone = offset_ex(next_onion, double(ext_perimeter_width / 2), jtSquare);
+                        ExPolygons no_thin_zone = clipper.offset_ex(next_onion, double(ext_perimeter_width / 2), jtSquare);
                         // medial axis requires non-overlapping geometry
-                        ExPolygons thin_zones = diff_ex(last, no_thin_zone, true);
+                        ExPolygons thin_zones = clipper.diff_ex(last, no_thin_zone, true);
                         //don't use offset2_ex, because we don't want to merge the zones that have been separated.
                             //a very little bit of overlap can be created here with other thin polygons, but it's more useful than worisome.
-                        ExPolygons half_thins = offset_ex(thin_zones, double(-min_width / 2));
+                        ExPolygons half_thins = clipper.offset_ex(thin_zones, double(-min_width / 2));
                         //simplify them
                         for (ExPolygon &half_thin : half_thins) {
                             half_thin.remove_point_too_near((coord_t)SCALED_RESOLUTION);
                         }
                         //we push the bits removed and put them into what we will use as our anchor
                         if (half_thins.size() > 0) {
-                            no_thin_zone = diff_ex(last, offset_ex(half_thins, double(min_width / 2 - SCALED_EPSILON)), true);
+                            no_thin_zone = clipper.diff_ex(last, clipper.offset_ex(half_thins, double(min_width / 2 - SCALED_EPSILON)), true);
                         }
                         ExPolygons thins;
                         // compute a bit of overlap to anchor thin walls inside the print.
@@ -590,7 +607,7 @@ void PerimeterGenerator::process()
                             (round_peri ? min_round_spacing : 3));
                         // now try with different min spacing if we fear some hysteresis
                         //TODO, do that for each polygon from last, instead to do for all of them in one go.
-                        ExPolygons no_thin_onion = offset_ex(last, double(-good_spacing));
+                        ExPolygons no_thin_onion = clipper.offset_ex(last, double(-good_spacing));
                         if (last_area < 0) {
                             last_area = 0;
                             for (const ExPolygon& expoly : last) {
@@ -631,7 +648,7 @@ void PerimeterGenerator::process()
                     } else {
                         // If "overlapping_perimeters" is enabled, this paths will be entered, which 
                         // leads to overflows, as in prusa3d/Slic3r GH #32
-                        next_onion = offset_ex(last, double( - good_spacing),
+                        next_onion = clipper.offset_ex(last, double( - good_spacing),
                             (round_peri ? ClipperLib::JoinType::jtRound : ClipperLib::JoinType::jtMiter),
                             (round_peri ? min_round_spacing : 3));
                     }
@@ -642,9 +659,9 @@ void PerimeterGenerator::process()
                         // not using safety offset here would "detect" very narrow gaps
                         // (but still long enough to escape the area threshold) that gap fill
                         // won't be able to fill but we'd still remove from infill area
-                        append(gaps, diff_ex(
-                            offset(last, -0.5f * gap_fill_spacing),
-                            offset(next_onion, 0.5f * good_spacing + 10,
+                        append(gaps, clipper.diff_ex(
+                            clipper.offset(last, -0.5f * gap_fill_spacing),
+                            clipper.offset(next_onion, 0.5f * good_spacing + 10,
                                 (round_peri ? ClipperLib::JoinType::jtRound : ClipperLib::JoinType::jtMiter),
                                 (round_peri ? min_round_spacing : 3))));  // safety offset
                 }
@@ -913,7 +930,7 @@ void PerimeterGenerator::process()
                     ExtrusionEntityCollection tw = thin_variable_width
                         (thin_walls, erThinWall, this->ext_perimeter_flow);
 
-                    entities.append(tw.entities);
+                    entities.append(std::move(tw.entities));
                     thin_walls.clear();
                 }
             } else {
@@ -979,11 +996,7 @@ void PerimeterGenerator::process()
                 }
 
             }
-            // append perimeters for this slice as a collection
-            if (!entities.empty()) {
-                //move it, to avoid to clone evrything and then delete it
-                this->loops->entities.emplace_back( new ExtrusionEntityCollection(std::move(entities)));
-            }
+            out.loops = std::move(entities);
         } // for each loop of an island
 
         // fill gaps
@@ -1058,7 +1071,6 @@ void PerimeterGenerator::process()
             if (!polylines.empty()) {
                 ExtrusionEntityCollection gap_fill = thin_variable_width(polylines, 
                     erGapFill, this->solid_infill_flow);
-                this->gap_fill->append(gap_fill.entities);
                 /*  Make sure we don't infill narrow parts that are already gap-filled
                     (we only consider this surface's gaps to reduce the diff() complexity).
                     Growing actual extrusions ensures that gaps not filled by medial axis
@@ -1068,6 +1080,7 @@ void PerimeterGenerator::process()
                 //FIXME Vojtech: This grows by a rounded extrusion width, not by line spacing,
                 // therefore it may cover the area, but no the volume.
                 last = diff_ex(to_polygons(last), gap_fill.polygons_covered_by_width(10.f));
+                out.gap_fill = std::move(gap_fill);
             }
         }
         //TODO: if a gapfill extrusion is a loop and with width always >= perimeter width then change the type to perimeter and put it at the right place in the loops vector.
@@ -1104,7 +1117,7 @@ void PerimeterGenerator::process()
         if (!top_fills.empty()) {
             infill_exp = union_ex(infill_exp, offset_ex(top_infill_exp, double(infill_peri_overlap)));
         }
-        this->fill_surfaces->append(infill_exp, stPosInternal | stDensSparse);
+        out.fill = infill_exp;
             
         if (infill_peri_overlap != 0) {
             ExPolygons polyWithoutOverlap;
@@ -1120,7 +1133,7 @@ void PerimeterGenerator::process()
             if (!top_fills.empty()) {
                 polyWithoutOverlap = union_ex(polyWithoutOverlap, top_infill_exp);
             }
-            this->fill_no_overlap.insert(this->fill_no_overlap.end(), polyWithoutOverlap.begin(), polyWithoutOverlap.end());
+            out.fill_no_overlap = std::move(polyWithoutOverlap);
                 /*{
                     std::stringstream stri;
                     stri << this->layer->id() << "_2_end_makeperimeter_" << this->layer->id() << ".svg";
@@ -1134,7 +1147,25 @@ void PerimeterGenerator::process()
                     svg.Close();
                 }*/
         }
-    } // for each island
+    }; // process_island
+
+    if (all_surfaces.size() == 1)
+        process_island(all_surfaces.front(), island_outputs.front());
+    else
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, all_surfaces.size(), 1),
+            [&all_surfaces, &island_outputs, &process_island](const tbb::blocked_range<size_t> &range) {
+            for (size_t island_idx = range.begin(); island_idx < range.end(); ++ island_idx)
+                process_island(all_surfaces[island_idx], island_outputs[island_idx]);
+        });
+
+    for (IslandOutput &out : island_outputs) {
+        // append perimeters for this slice as a collection
+        if (! out.loops.empty())
+            this->loops->entities.emplace_back(new ExtrusionEntityCollection(std::move(out.loops)));
+        this->gap_fill->append(std::move(out.gap_fill.entities));
+        this->fill_surfaces->append(out.fill, stPosInternal | stDensSparse);
+        append(this->fill_no_overlap, std::move(out.fill_no_overlap));
+    }
 }
 
 
@@ -1164,38 +1195,29 @@ ExtrusionPaths PerimeterGenerator::create_overhangs(const Polyline& loop_polygon
     Polylines small_flow;
     Polylines big_flow;
 
+    // The lower slices are grown by increasing distances, thus each region contains the previous ones.
+    // Once the remaining polylines are found fully inside a region, they are inside all the following regions as well
+    // and the remaining boolean operations may be skipped. This is the common case of a fully supported perimeter.
     Polylines* previous = &ok_polylines;
-    if (this->config->overhangs_width_speed.value > 0) {
-        if (!this->_lower_slices_bridge_speed_small.empty()) {
-            small_speed = diff_pl(*previous, this->_lower_slices_bridge_speed_small);
-            if (!small_speed.empty()) {
-                *previous = intersection_pl(*previous, this->_lower_slices_bridge_speed_small);
-                previous = &small_speed;
-            }
-        }
-        if (!this->_lower_slices_bridge_speed_big.empty()) {
-            big_speed = diff_pl(*previous, this->_lower_slices_bridge_speed_big);
-            if (!big_speed.empty()) {
-                *previous = intersection_pl(*previous, this->_lower_slices_bridge_speed_big);
-                previous = &big_speed;
-            }
+    bool previous_inside = false;
+    auto split_by_region = [&previous, &previous_inside](const Polygons &region, Polylines &outside) {
+        if (region.empty() || previous_inside)
+            return;
+        outside = diff_pl(*previous, region);
+        if (outside.empty()) {
+            previous_inside = true;
+        } else {
+            *previous = intersection_pl(*previous, region);
+            previous = &outside;
         }
+    };
+    if (this->config->overhangs_width_speed.value > 0) {
+        split_by_region(this->_lower_slices_bridge_speed_small, small_speed);
+        split_by_region(this->_lower_slices_bridge_speed_big, big_speed);
     }
     if (this->config->overhangs_width.value > 0) {
-        if (!this->_lower_slices_bridge_flow_small.empty()) {
-            small_flow = diff_pl(*previous, this->_lower_slices_bridge_flow_small);
-            if (!small_flow.empty()) {
-                *previous = intersection_pl(*previous, this->_lower_slices_bridge_flow_small);
-                previous = &small_flow;
-            }
-        }
-        if (!this->_lower_slices_bridge_flow_big.empty()) {
-            big_flow = diff_pl(*previous, this->_lower_slices_bridge_flow_big);
-            if (!big_flow.empty()) {
-                *previous = intersection_pl(*previous, this->_lower_slices_bridge_flow_big);
-                previous = &big_flow;
-            }
-        }
+        split_by_region(this->_lower_slices_bridge_flow_small, small_flow);
+        split_by_region(this->_lower_slices_bridge_flow_big, big_flow);
     }
 
     //note: layer height is used to identify the path type
@@ -1425,7 +1447,7 @@ ExtrusionEntityCollection PerimeterGenerator::_traverse_loops(
     // append thin walls to the nearest-neighbor search (only for first iteration)
     if (!thin_walls.empty()) {
         ExtrusionEntityCollection tw = thin_variable_width(thin_walls, erThinWall, this->ext_perimeter_flow);
-        coll.append(tw.entities);
+        coll.append(std::move(tw.entities));
         thin_walls.clear();
     }
 
@@ -1655,7 +1677,7 @@ void PerimeterGenerator::_merge_thin_walls(ExtrusionEntityCollection &extrusions
 
     //now add thinwalls that have no anchor (make them reversable)
     ExtrusionEntityCollection tws = thin_variable_width(not_added, erThinWall, this->ext_perimeter_flow);
-    extrusions.append(tws.entities);
+    extrusions.append(std::move(tws.entities));
 }
 
 PerimeterIntersectionPoint
@@ -1848,7 +1870,7 @@ PerimeterGenerator::_extrude_and_cut_loop(const PerimeterGeneratorLoop &loop, co
                 }
                 direction_polyline.clip_start(SCALED_RESOLUTION);
                 direction_polyline.clip_end(SCALED_RESOLUTION);
-                coord_t dot = direction.dot(Line(direction_polyline.points.back(), direction_polyline.points.front()));
+                int64_t dot = direction.dot(Line(direction_polyline.points.back(), direction_polyline.points.front()));
                 need_to_reverse = dot>0;
             }
             if (need_to_reverse) {
@@ -1886,7 +1908,7 @@ PerimeterGenerator::_extrude_and_cut_loop(const PerimeterGeneratorLoop &loop, co
                 Polyline direction_polyline = initial_polyline;
                 direction_polyline.clip_start(SCALED_RESOLUTION);
                 direction_polyline.clip_end(SCALED_RESOLUTION);
-                coord_t dot = direction.dot(Line(direction_polyline.points.back(), direction_polyline.points.front()));
+                int64_t dot = direction.dot(Line(direction_polyline.points.back(), direction_polyline.points.front()));
                 need_to_reverse = dot>0;
             }
 
@@ -1,6 +1,8 @@
 #include "PlaceholderParser.hpp"
 #include "Exception.hpp"
 #include "Flow.hpp"
+#include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <ctime>
 #include <iomanip>
@@ -1471,6 +1473,146 @@ std::string PlaceholderParser::process(const std::string &templ, unsigned int cu
     return process_macro(templ, context);
 }
 
+static inline bool is_identifier_char(char c) { return c == '_' || std::isalnum((unsigned char)c); }
+
+// Is the trimmed text an identifier, which is not a keyword of the macro language?
+static bool is_plain_variable(const std::string &text)
+{
+    static const char *keywords[] = { "and", "if", "int", "else", "elsif", "endif", "false", "min", "max", "random", "not", "or", "true" };
+    if (text.empty() || ! (text.front() == '_' || std::isalpha((unsigned char)text.front())) ||
+        ! std::all_of(text.begin(), text.end(), is_identifier_char))
+        return false;
+    return std::none_of(std::begin(keywords), std::end(keywords), [&text](const char *kw) { return text == kw; });
+}
+
+// Does the content of a {} macro start with the keyword?
+static bool macro_starts_with_keyword(const std::string &macro, const char *keyword)
+{
+    size_t len = strlen(keyword);
+    return macro.compare(0, len, keyword) == 0 && (macro.size() == len || ! is_identifier_char(macro[len]));
+}
+
+PlaceholderParser::CompiledTemplate PlaceholderParser::compile(const std::string &templ)
+{
+    CompiledTemplate out;
+    auto add = [&out](CompiledTemplate::SegmentType type, std::string text) {
+        if (type == CompiledTemplate::SegmentType::Text && ! out.m_segments.empty() && out.m_segments.back().type == type)
+            out.m_segments.back().text += text;
+        else
+            out.m_segments.push_back({ type, std::move(text) });
+    };
+    // Start of the {if} block being collected, and its nesting level.
+    size_t if_start = std::string::npos;
+    int    if_depth = 0;
+    bool   valid    = true;
+    for (size_t i = 0; valid && i < templ.size();) {
+        if (templ[i] == '[') {
+            // [variable], [vector_index] or [vector_[index]]
+            size_t end = templ.find(']', i + 1);
+            if (end != std::string::npos && templ.find('[', i + 1) < end)
+                end = templ.find(']', end + 1);
+            if (end == std::string::npos) {
+                valid = false;
+                break;
+            }
+            if (if_depth == 0) {
+                std::string name = boost::algorithm::trim_copy(templ.substr(i + 1, end - i - 1));
+                if (is_plain_variable(name))
+                    add(CompiledTemplate::SegmentType::Variable, std::move(name));
+                else
+                    add(CompiledTemplate::SegmentType::Macro, templ.substr(i, end + 1 - i));
+            }
+            i = end + 1;
+        } else if (templ[i] == '{') {
+            // Find the closing brace outside of the string literals.
+            size_t end = i + 1;
+            for (bool quoted = false; end < templ.size() && (quoted || templ[end] != '}'); ++ end)
+                if (templ[end] == '\\' && quoted)
+                    ++ end;
+                else if (templ[end] == '"')
+                    quoted = ! quoted;
+                else if (templ[end] == '{' && ! quoted)
+                    break;
+            if (end >= templ.size() || templ[end] != '}') {
+                valid = false;
+                break;
+            }
+            std::string macro = boost::algorithm::trim_copy(templ.substr(i + 1, end - i - 1));
+            // A regular expression may contain braces, leave such templates to the macro processor.
+            if (macro.find("=~") != std::string::npos || macro.find("!~") != std::string::npos) {
+                valid = false;
+                break;
+            }
+            if (macro_starts_with_keyword(macro, "if")) {
+                if (if_depth ++ == 0)
+                    if_start = i;
+            } else if (macro_starts_with_keyword(macro, "endif")) {
+                if (if_depth == 0) {
+                    valid = false;
+                    break;
+                }
+                if (-- if_depth == 0)
+                    add(CompiledTemplate::SegmentType::Macro, templ.substr(if_start, end + 1 - if_start));
+            } else if (if_depth == 0) {
+                if (macro_starts_with_keyword(macro, "else") || macro_starts_with_keyword(macro, "elsif")) {
+                    valid = false;
+                    break;
+                }
+                add(CompiledTemplate::SegmentType::Macro, templ.substr(i, end + 1 - i));
+            }
+            i = end + 1;
+        } else {
+            size_t end = std::min(templ.find('[', i), templ.find('{', i));
+            if (end == std::string::npos)
+                end = templ.size();
+            if (if_depth == 0)
+                add(CompiledTemplate::SegmentType::Text, templ.substr(i, end - i));
+            i = end;
+        }
+    }
+    if (! valid || if_depth != 0) {
+        // Let the macro processor parse the whole template and report the errors.
+        out.m_segments.clear();
+        out.m_segments.push_back({ CompiledTemplate::SegmentType::Macro, templ });
+    }
+    return out;
+}
+
+std::string PlaceholderParser::process(const CompiledTemplate &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, ContextData *context_data) const
+{
+    client::MyContext context;
+    context.external_config 	= this->external_config();
+    context.config              = &this->config();
+    context.config_override     = config_override;
+    context.current_extruder_id = current_extruder_id;
+    context.context_data        = context_data;
+    std::string output;
+    for (const CompiledTemplate::Segment &segment : templ.m_segments) {
+        switch (segment.type) {
+        case CompiledTemplate::SegmentType::Text:
+            output += segment.text;
+            break;
+        case CompiledTemplate::SegmentType::Variable:
+            // Resolve the variable directly in the common case, otherwise let the macro processor
+            // handle the legacy vector indexing and the errors.
+            if (const ConfigOption *opt = context.resolve_symbol(segment.text); opt != nullptr && opt->is_scalar()) {
+                output += opt->serialize();
+                break;
+            } else if (opt != nullptr && ! static_cast<const ConfigOptionVectorBase*>(opt)->empty()) {
+                const ConfigOptionVectorBase *vec = static_cast<const ConfigOptionVectorBase*>(opt);
+                output += vec->vserialize()[(current_extruder_id >= vec->size()) ? 0 : current_extruder_id];
+                break;
+            }
+            output += process_macro("[" + segment.text + "]", context);
+            break;
+        case CompiledTemplate::SegmentType::Macro:
+            output += process_macro(segment.text, context);
+            break;
+        }
+    }
+    return output;
+}
+
 // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
 // Throws Slic3r::RuntimeError on syntax or runtime error.
 bool PlaceholderParser::evaluate_boolean_expression(const std::string &templ, const DynamicConfig &config, const DynamicConfig *config_override)
@@ -22,6 +22,23 @@ public:
         std::mt19937 rng;
     };
 
+    // Template split once by compile() into its free-form text, its legacy [variable] expansions and its {macros},
+    // so that the free-form text is not parsed again each time the template is filled in.
+    // The compiled template does not depend on the configuration, it may be cached by the template text.
+    class CompiledTemplate {
+    public:
+        bool empty() const { return m_segments.empty(); }
+    private:
+        friend class PlaceholderParser;
+        enum class SegmentType { Text, Variable, Macro };
+        struct Segment {
+            SegmentType type;
+            // Free-form text, name of the variable or source of the macro to be evaluated by the macro processor.
+            std::string text;
+        };
+        std::vector<Segment> m_segments;
+    };
+
     PlaceholderParser(const DynamicConfig *external_config = nullptr);
     
     // Return a list of keys, which should be changed in m_config from rhs.
@@ -52,6 +69,10 @@ public:
     // Fill in the template using a macro processing language.
     // Throws Slic3r::PlaceholderParserError on syntax or runtime error.
     std::string process(const std::string &templ, unsigned int current_extruder_id = 0, const DynamicConfig *config_override = nullptr, ContextData *context = nullptr) const;
+    // Same as above for a template compiled by compile(), with the same result.
+    std::string process(const CompiledTemplate &templ, unsigned int current_extruder_id = 0, const DynamicConfig *config_override = nullptr, ContextData *context = nullptr) const;
+    // Split the template for process(). The syntax is not validated, the errors are reported by process().
+    static CompiledTemplate compile(const std::string &templ);
     
     // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
     // Throws Slic3r::PlaceholderParserError on syntax or runtime error.
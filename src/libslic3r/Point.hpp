@@ -27,8 +27,8 @@ typedef Eigen::Matrix<int32_t,  2, 1, Eigen::DontAlign> Vec2i32;
 typedef Eigen::Matrix<int64_t, 2, 1, Eigen::DontAlign> Vec2i64;
 typedef Eigen::Matrix<int32_t,  3, 1, Eigen::DontAlign> Vec3i32;
 typedef Eigen::Matrix<int64_t, 3, 1, Eigen::DontAlign> Vec3i64;
-typedef Vec2i64 Vec2crd;
-typedef Vec3i64 Vec3crd;
+typedef Eigen::Matrix<coord_t, 2, 1, Eigen::DontAlign> Vec2crd;
+typedef Eigen::Matrix<coord_t, 3, 1, Eigen::DontAlign> Vec3crd;
 
 // Vector types with a double coordinate base type.
 typedef Eigen::Matrix<float,    2, 1, Eigen::DontAlign> Vec2f;
@@ -57,7 +57,7 @@ typedef Eigen::Transform<double, 3, Eigen::Affine, Eigen::DontAlign> Transform3d
 inline bool operator<(const Vec2d &lhs, const Vec2d &rhs) { return lhs(0) < rhs(0) || (lhs(0) == rhs(0) && lhs(1) < rhs(1)); }
 
 // One likely does not want to perform the cross product with a 32bit accumulator.
-//inline int32_t cross2(const Vec2i32 &v1, const Vec2i32 &v2) { return v1(0) * v2(1) - v1(1) * v2(0); }
+inline int64_t cross2(const Vec2i32 &v1, const Vec2i32 &v2) { return int64_t(v1(0)) * int64_t(v2(1)) - int64_t(v1(1)) * int64_t(v2(0)); }
 inline int64_t cross2(const Vec2i64 &v1, const Vec2i64 &v2) { return v1(0) * v2(1) - v1(1) * v2(0); }
 inline float   cross2(const Vec2f   &v1, const Vec2f   &v2) { return v1(0) * v2(1) - v1(1) * v2(0); }
 inline double  cross2(const Vec2d   &v1, const Vec2d   &v2) { return v1(0) * v2(1) - v1(1) * v2(0); }
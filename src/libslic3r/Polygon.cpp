@@ -56,11 +56,10 @@ double Polygon::area(const Points &points)
     if (n < 3) 
         return 0.;
     
-    double a = 0.;
-    for (size_t i = 0, j = n - 1; i < n; ++i) {
-        a += ((double)points[j](0) + (double)points[i](0)) * ((double)points[i](1) - (double)points[j](1));
-        j = i;
-    }
+    // Closing edge first, then the edges in order without a loop carried index, summed in the same order as before.
+    double a = ((double)points[n - 1](0) + (double)points[0](0)) * ((double)points[0](1) - (double)points[n - 1](1));
+    for (size_t i = 1; i < n; ++i)
+        a += ((double)points[i - 1](0) + (double)points[i](0)) * ((double)points[i](1) - (double)points[i - 1](1));
     return 0.5 * a;
 }
 
@@ -71,7 +70,8 @@ double Polygon::area() const
 
 bool Polygon::is_counter_clockwise() const
 {
-    return ClipperLib::Orientation(Slic3rMultiPoint_to_ClipperPath(*this));
+    // Same as ClipperLib::Orientation(), which is Area() >= 0, without converting the points into a ClipperLib::Path.
+    return Polygon::area(this->points) >= 0.;
 }
 
 bool Polygon::is_clockwise() const
@@ -39,6 +39,8 @@ public:
 
     // last point == first point for polygons
     const Point& last_point() const override { return this->points.front(); }
+    // Including the closing segment, zero below 3 points as lines().
+    double length() const override { return (this->points.size() > 2) ? MultiPoint::length(this->points) + (this->points.front() - this->points.back()).cast<double>().norm() : 0.; }
 
     Lines lines() const override;
     Polyline split_at_vertex(const Point &point) const;
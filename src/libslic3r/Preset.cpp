@@ -39,6 +39,8 @@
 #include <boost/locale.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include "libslic3r.h"
 #include "Utils.hpp"
 #include "PlaceholderParser.hpp"
@@ -547,7 +549,7 @@ const std::vector<std::string>& Preset::print_options()
         "brim_offset",
         // support
         "support_material", "support_material_auto", "support_material_threshold", "support_material_enforce_layers",
-        "raft_layers", "support_material_pattern", "support_material_with_sheath", "support_material_spacing",
+        "raft_layers", "support_material_style", "support_material_pattern", "support_material_with_sheath", "support_material_spacing",
         "support_material_interface_pattern",
         "support_material_synchronize_layers", "support_material_angle", "support_material_interface_layers",
         "support_material_interface_spacing", "support_material_interface_contact_loops",
@@ -559,8 +561,9 @@ const std::vector<std::string>& Preset::print_options()
         "complete_objects_one_skirt",
         "complete_objects_one_brim",
         "complete_objects_sort",
+        "travel_planning_lookahead",
         "extruder_clearance_radius", 
-        "extruder_clearance_height", "gcode_comments", "gcode_label_objects", "output_filename_format", "post_process", "perimeter_extruder", 
+        "extruder_clearance_height", "gcode_comments", "gcode_compression", "gcode_export_pipelined", "arc_fitting", "arc_fitting_tolerance", "gcode_label_objects", "output_filename_format", "post_process", "perimeter_extruder", 
         "infill_extruder", "solid_infill_extruder", "support_material_extruder", "support_material_interface_extruder", 
         "ooze_prevention", "standby_temperature_delta", "interface_shells", 
         // width & spacing
@@ -873,6 +876,7 @@ const std::vector<std::string>& Preset::sla_printer_options()
             "first_layer_size_compensation",
             "elephant_foot_min_width",
             "gamma_correction",
+            "fast_png_encoding",
             "min_exposure_time", "max_exposure_time",
             "min_initial_exposure_time", "max_initial_exposure_time",
             //FIXME the print host keys are left here just for conversion from the Printer preset to Physical Printer preset.
@@ -940,9 +944,7 @@ void PresetCollection::load_presets(
     boost::filesystem::path dir = boost::filesystem::absolute(boost::filesystem::path(dir_path) / subdir).make_preferred();
     m_dir_path = dir.string();
     std::string errors_cummulative;
-    // Store the loaded presets into a new vector, otherwise the binary search for already existing presets would be broken.
-    // (see the "Preset already present, not loading" message).
-    std::deque<Preset> presets_loaded;
+    std::vector<std::pair<std::string, std::string>> files;
     for (auto &dir_entry : boost::filesystem::directory_iterator(dir))
         if (Slic3r::is_ini_file(dir_entry)) {
             std::string name = dir_entry.path().filename().string();
@@ -954,37 +956,58 @@ void PresetCollection::load_presets(
                 BOOST_LOG_TRIVIAL(warning) << "Preset already present, not loading: " << name;
                 continue;
             }
+            files.emplace_back(std::move(name), dir_entry.path().string());
+        }
+    // The preset files are independent, parse them in parallel. The results are collected in the order of the directory listing.
+    struct Loaded {
+        std::unique_ptr<Preset>     preset;
+        ConfigSubstitutions         config_substitutions;
+        std::string                 error;
+    };
+    std::vector<Loaded> loaded(files.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, files.size()), [this, &files, &loaded, substitution_rule](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
             try {
-                Preset preset(m_type, name, false);
-                preset.file = dir_entry.path().string();
+                auto preset = std::make_unique<Preset>(m_type, files[i].first, false);
+                preset->file = files[i].second;
                 // Load the preset file, apply preset values on top of defaults.
                 try {
                     DynamicPrintConfig config;
-                    ConfigSubstitutions config_substitutions = config.load_from_ini(preset.file, substitution_rule);
-                    if (! config_substitutions.empty())
-                        substitutions.push_back({ preset.name, m_type, PresetConfigSubstitutions::Source::UserFile, preset.file, std::move(config_substitutions) });
+                    loaded[i].config_substitutions = config.load_from_ini(preset->file, substitution_rule);
                     // Find a default preset for the config. The PrintPresetCollection provides different default preset based on the "printer_technology" field.
                     const Preset &default_preset = this->default_preset_for(config);
-                    preset.config = default_preset.config;
-                    preset.config.apply(std::move(config));
-                    Preset::normalize(preset.config);
+                    preset->config = default_preset.config;
+                    preset->config.apply(std::move(config));
+                    Preset::normalize(preset->config);
                     // Report configuration fields, which are misplaced into a wrong group.
                     std::string incorrect_keys = Preset::remove_invalid_keys(config, default_preset.config);
                     if (! incorrect_keys.empty())
                         BOOST_LOG_TRIVIAL(error) << "Error in a preset file: The preset \"" <<
-                            preset.file << "\" contains the following incorrect keys: " << incorrect_keys << ", which were removed";
-                    preset.loaded = true;
+                            preset->file << "\" contains the following incorrect keys: " << incorrect_keys << ", which were removed";
+                    preset->loaded = true;
                 } catch (const std::ifstream::failure &err) {
-                    throw Slic3r::RuntimeError(std::string("The selected preset cannot be loaded: ") + preset.file + "\n\tReason: " + err.what());
+                    throw Slic3r::RuntimeError(std::string("The selected preset cannot be loaded: ") + preset->file + "\n\tReason: " + err.what());
                 } catch (const std::runtime_error &err) {
-                    throw Slic3r::RuntimeError(std::string("Failed loading the preset file: ") + preset.file + "\n\tReason: " + err.what());
+                    throw Slic3r::RuntimeError(std::string("Failed loading the preset file: ") + preset->file + "\n\tReason: " + err.what());
                 }
-                presets_loaded.emplace_back(preset);
+                loaded[i].preset = std::move(preset);
             } catch (const std::runtime_error &err) {
-                errors_cummulative += err.what();
-                errors_cummulative += "\n";
+                loaded[i].error = err.what();
             }
         }
+    });
+    // Store the loaded presets into a new vector, otherwise the binary search for already existing presets would be broken.
+    // (see the "Preset already present, not loading" message).
+    std::deque<Preset> presets_loaded;
+    for (Loaded &l : loaded)
+        if (l.preset) {
+            if (! l.config_substitutions.empty())
+                substitutions.push_back({ l.preset->name, m_type, PresetConfigSubstitutions::Source::UserFile, l.preset->file, std::move(l.config_substitutions) });
+            presets_loaded.emplace_back(std::move(*l.preset));
+        } else {
+            errors_cummulative += l.error;
+            errors_cummulative += "\n";
+        }
     m_presets.insert(m_presets.end(), std::make_move_iterator(presets_loaded.begin()), std::make_move_iterator(presets_loaded.end()));
     std::sort(m_presets.begin() + m_num_default_presets, m_presets.end());
     if(this->type() == Preset::Type::TYPE_PRINTER)
@@ -22,10 +22,16 @@
 
 #include <algorithm>
 #include <limits>
+#include <numeric>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <tbb/parallel_for.h>
 
 // Mark string for localization and translate.
 #define L(s) Slic3r::I18N::translate(s)
@@ -71,6 +77,8 @@ bool Print::invalidate_state_by_config_options(const std::vector<t_config_option
     // Cache the plenty of parameters, which influence the G-code generator only,
     // or they are only notes not influencing the generated G-code.
     static std::unordered_set<std::string> steps_gcode = {
+        "arc_fitting",
+        "arc_fitting_tolerance",
         "avoid_crossing_perimeters",
         "avoid_crossing_perimeters_max_detour",
         "avoid_crossing_not_first_layer",
@@ -122,6 +130,8 @@ bool Print::invalidate_state_by_config_options(const std::vector<t_config_option
         "full_fan_speed_layer",
         "gap_fill_speed",
         "gcode_comments",
+        "gcode_compression",
+        "gcode_export_pipelined",
         "gcode_filename_illegal_char",
         "gcode_label_objects",
         "gcode_precision_xyz",
@@ -177,6 +187,7 @@ bool Print::invalidate_state_by_config_options(const std::vector<t_config_option
         "top_fan_speed",
         "threads",
         "travel_acceleration",
+        "travel_planning_lookahead",
         "travel_speed",
         "travel_speed_z",
         "use_firmware_retraction",
@@ -473,6 +484,48 @@ void Print::model_volume_list_update_supports_seams(ModelObject &model_object_ds
             delete mv_with_status.first;
 }
 
+// Z range of the triangles painted differently in model_object and model_object_new by the support painting gizmo,
+// in the coordinate system of a PrintObject with the trafo transformation. Returns false if no painted triangle differs.
+static bool model_custom_supports_changed_z_range(const ModelObject &model_object, const ModelObject &model_object_new, const Transform3d &trafo, coordf_t &z_min, coordf_t &z_max)
+{
+    assert(model_object.volumes.size() == model_object_new.volumes.size());
+    z_min = std::numeric_limits<coordf_t>::max();
+    z_max = std::numeric_limits<coordf_t>::lowest();
+    for (size_t i = 0; i < model_object.volumes.size(); ++ i) {
+        const ModelVolume &mv     = *model_object.volumes[i];
+        const ModelVolume &mv_new = *model_object_new.volumes[i];
+        if (! mv_new.is_model_part() || mv_new.supported_facets.timestamp_matches(mv.supported_facets))
+            continue;
+        const indexed_triangle_set &its = mv_new.mesh().its;
+        const Transform3d           tr  = trafo * mv_new.get_matrix();
+        auto add_triangle = [&its, &tr, &z_min, &z_max](int idx) {
+            if (idx >= 0 && size_t(idx) < its.indices.size())
+                for (int j = 0; j < 3; ++ j) {
+                    double z = (tr * its.vertices[its.indices[idx](j)].cast<double>()).z();
+                    z_min = std::min(z_min, z);
+                    z_max = std::max(z_max, z);
+                }
+        };
+        // Both maps are sorted by the triangle index, walk them in parallel.
+        const std::map<int, std::vector<bool>> &data     = mv.supported_facets.get_data();
+        const std::map<int, std::vector<bool>> &data_new = mv_new.supported_facets.get_data();
+        auto it = data.begin(), it_new = data_new.begin();
+        while (it != data.end() || it_new != data_new.end()) {
+            if (it_new == data_new.end() || (it != data.end() && it->first < it_new->first))
+                add_triangle((it ++)->first);
+            else if (it == data.end() || it_new->first < it->first)
+                add_triangle((it_new ++)->first);
+            else {
+                if (it->second != it_new->second)
+                    add_triangle(it->first);
+                ++ it;
+                ++ it_new;
+            }
+        }
+    }
+    return z_min <= z_max;
+}
+
 static inline void model_volume_list_copy_configs(ModelObject &model_object_dst, const ModelObject &model_object_src, const ModelVolumeType type)
 {
     size_t i_src, i_dst;
@@ -617,19 +670,48 @@ static bool custom_per_printz_gcodes_tool_changes_differ(const std::vector<Custo
 
 // Collect diffs of configuration values at various containers,
 // resolve the filament rectract overrides of extruder retract values.
+// The print, object and region configs were synchronized with m_full_print_config by the last apply(), therefore only the options
+// modified since then in the full print config are compared against them.
 void Print::config_diffs(
 	const DynamicPrintConfig &new_full_config, 
 	t_config_option_keys &print_diff, t_config_option_keys &object_diff, t_config_option_keys &region_diff, 
 	t_config_option_keys &full_config_diff, 
 	DynamicPrintConfig &filament_overrides) const
 {
+    // Prepare for storing of the full print config into new_full_config to be exported into the G-code and to be used by the PlaceholderParser.
+    // Both configs are sorted by their keys, walk them in parallel.
+    {
+        auto it_old = m_full_print_config.cbegin();
+        for (auto it_new = new_full_config.cbegin(); it_new != new_full_config.cend(); ++ it_new) {
+            while (it_old != m_full_print_config.cend() && it_old->first < it_new->first)
+                ++ it_old;
+            const ConfigOption *opt_old = (it_old != m_full_print_config.cend() && it_old->first == it_new->first) ? it_old->second.get() : nullptr;
+            const ConfigOption *opt_new = it_new->second.get();
+            if (opt_old == nullptr || *opt_new != *opt_old || opt_new->is_phony() != opt_old->is_phony())
+                full_config_diff.emplace_back(it_new->first);
+        }
+    }
+    if (full_config_diff.empty())
+        return;
+
     // Collect changes to print config, account for overrides of extruder retract values by filament presets.
     {
 	    const std::vector<std::string> &extruder_retract_keys = print_config_def.extruder_retract_keys();
 	    const std::string               filament_prefix       = "filament_";
-	    for (const t_config_option_key &opt_key : m_config.keys()) {
+        // Modified options, and the extruder retract values overriden by the modified filament retract values.
+        t_config_option_keys            modified = full_config_diff;
+        for (const t_config_option_key &opt_key : full_config_diff)
+            if (boost::starts_with(opt_key, filament_prefix)) {
+                std::string extruder_key = opt_key.substr(filament_prefix.size());
+                if (std::binary_search(extruder_retract_keys.begin(), extruder_retract_keys.end(), extruder_key))
+                    modified.emplace_back(std::move(extruder_key));
+            }
+        sort_remove_duplicates(modified);
+	    for (const t_config_option_key &opt_key : modified) {
 	        const ConfigOption *opt_old = m_config.option(opt_key);
-	        assert(opt_old != nullptr);
+	        if (opt_old == nullptr)
+	            // Not a print option.
+	            continue;
 	        const ConfigOption *opt_new = new_full_config.option(opt_key);
 			// assert(opt_new != nullptr);
 			if (opt_new == nullptr)
@@ -653,15 +735,17 @@ void Print::config_diffs(
 	    }
 	}
 	// Collect changes to object and region configs.
-    object_diff = m_default_object_config.diff(new_full_config);
-    region_diff = m_default_region_config.diff(new_full_config);
-    // Prepare for storing of the full print config into new_full_config to be exported into the G-code and to be used by the PlaceholderParser.
-    for (const t_config_option_key &opt_key : new_full_config.keys()) {
-        const ConfigOption *opt_old = m_full_print_config.option(opt_key);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
-        if (opt_old == nullptr || *opt_new != *opt_old)
-            full_config_diff.emplace_back(opt_key);
-    }
+    auto diff_modified = [&new_full_config, &full_config_diff](const ConfigBase &config, t_config_option_keys &diff) {
+        // The same test as ConfigBase::diff(), limited to the modified options.
+        for (const t_config_option_key &opt_key : full_config_diff) {
+            const ConfigOption *this_opt  = config.option(opt_key);
+            const ConfigOption *other_opt = new_full_config.option(opt_key);
+            if (this_opt != nullptr && other_opt != nullptr && (*this_opt != *other_opt || this_opt->is_phony() != other_opt->is_phony()))
+                diff.emplace_back(opt_key);
+        }
+    };
+    diff_modified(m_default_object_config, object_diff);
+    diff_modified(m_default_region_config, region_diff);
 }
 
 std::vector<ObjectID> Print::print_object_ids() const 
@@ -795,10 +879,16 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
 		ObjectID     id;
         Status       status;
         LayerRanges  layer_ranges;
+        // Set by step 3) if the ModelInstances were refreshed or their content changed,
+        // cleared if the ModelInstances of an Old / Moved ModelObject are the same as before.
+        bool         instances_changed { true };
         // Search by id.
-        bool operator<(const ModelObjectStatus &rhs) const { return id < rhs.id; }
+        bool operator==(const ModelObjectStatus &rhs) const { return id == rhs.id; }
+        struct Hash { size_t operator()(const ModelObjectStatus &s) const { return std::hash<size_t>()(s.id.id); } };
     };
-    std::set<ModelObjectStatus> model_object_status;
+    // Hashed by ModelObject ID, the lookups below are performed once per ModelObject and PrintObject.
+    std::unordered_set<ModelObjectStatus, ModelObjectStatus::Hash> model_object_status;
+    model_object_status.reserve(std::max(m_model.objects.size(), model.objects.size()));
 
     // 1) Synchronize model objects.
     if (model.id() != m_model.id()) {
@@ -939,6 +1029,8 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             continue;
         // Update the ModelObject instance, possibly invalidate the linked PrintObjects.
         assert(it_status->status == ModelObjectStatus::Old || it_status->status == ModelObjectStatus::Moved);
+        bool &instances_changed = const_cast<ModelObjectStatus&>(*it_status).instances_changed;
+        instances_changed = false;
         // Check whether a model part volume was added or removed, their transformations or order changed.
         // Only volume IDs, volume types, transformation matrices and their order are checked, configuration and other parameters are NOT checked.
         bool model_parts_differ         = model_volume_list_changed(model_object, model_object_new, ModelVolumeType::MODEL_PART);
@@ -964,10 +1056,16 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
                 this->call_cancel_callback();
                 update_apply_status(false);
             }
-            // Invalidate just the supports step.
+            // Invalidate just the supports step. If just the support painting changed, only the support layers close to the modified facets will be recalculated.
             auto range = print_object_status.equal_range(PrintObjectStatus(model_object.id()));
-            for (auto it = range.first; it != range.second; ++ it)
-                update_apply_status(it->print_object->invalidate_step(posSupportMaterial));
+            for (auto it = range.first; it != range.second; ++ it) {
+                coordf_t z_min, z_max;
+                if (! supports_differ && ! seam_position_differ &&
+                    model_custom_supports_changed_z_range(model_object, model_object_new, it->print_object->trafo(), z_min, z_max))
+                    update_apply_status(it->print_object->invalidate_support_painting(z_min, z_max));
+                else
+                    update_apply_status(it->print_object->invalidate_step(posSupportMaterial));
+            }
             if (supports_differ) {
                 // Copy just the support volumes.
                 model_volume_list_update_supports_seams(model_object, model_object_new);
@@ -1012,6 +1110,7 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             	! std::equal(model_object.instances.begin(), model_object.instances.end(), model_object_new.instances.begin(), [](auto l, auto r){ return l->id() == r->id(); })) {
             	// G-code generator accesses model_object.instances to generate sequential print ordering matching the Plater object list.
             	update_apply_status(this->invalidate_step(psGCodeExport));
+                instances_changed = true;
 	            model_object.clear_instances();
 	            model_object.instances.reserve(model_object_new.instances.size());
 	            for (const ModelInstance *model_instance : model_object_new.instances) {
@@ -1024,6 +1123,7 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
 	        	// If some of the instances changed, the bounding box of the updated ModelObject is likely no more valid.
 	        	// This is safe as the ModelObject's bounding box is only accessed from this function, which is called from the main thread only.
 	 			model_object.invalidate_bounding_box();
+                instances_changed = true;
 	        	// Synchronize the content of instances.
 	        	auto new_instance = model_object_new.instances.begin();
 				for (auto old_instance = model_object.instances.begin(); old_instance != model_object.instances.end(); ++ old_instance, ++ new_instance) {
@@ -1044,11 +1144,28 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
         for (ModelObject *model_object : m_model.objects) {
             auto range = print_object_status.equal_range(PrintObjectStatus(model_object->id()));
             std::vector<const PrintObjectStatus*> old;
+            bool        any_old_deleted = false;
             if (range.first != range.second) {
                 old.reserve(print_object_status.count(PrintObjectStatus(model_object->id())));
                 for (auto it = range.first; it != range.second; ++ it)
                     if (it->status != PrintObjectStatus::Deleted)
                         old.emplace_back(&(*it));
+                    else
+                        any_old_deleted = true;
+            }
+            if (! old.empty() && ! any_old_deleted) {
+                auto it_status = model_object_status.find(ModelObjectStatus(model_object->id()));
+                assert(it_status != model_object_status.end());
+                if (! it_status->instances_changed) {
+                    // Neither the ModelInstances nor the PrintObjects of this ModelObject changed, reuse the PrintObjects
+                    // without regrouping and comparing all the instances. The multiset keeps the PrintObjects
+                    // in the order of m_objects, which is the order produced by the merge below.
+                    for (const PrintObjectStatus *pos : old) {
+                        print_objects_new.emplace_back(pos->print_object);
+                        const_cast<PrintObjectStatus*>(pos)->status = PrintObjectStatus::Reused;
+                    }
+                    continue;
+                }
             }
             // Generate a list of trafos and XY offsets for instances of a ModelObject
             // Producing the config for PrintObject on demand, caching it at print_object_last.
@@ -1283,6 +1400,8 @@ static inline bool sequential_print_horizontal_clearance_valid(const Print &prin
     if (print.config().extruder_clearance_radius == 0)
         return true;
 	Polygons convex_hulls_other;
+    // Bounding boxes of convex_hulls_other, only the hulls with overlapping bounding boxes are intersected.
+    std::vector<BoundingBox> convex_hulls_other_bboxes;
 	std::map<ObjectID, Polygon> map_model_object_to_convex_hull;
     const double dist_grow = PrintConfig::min_object_distance(&print.default_region_config()) * 2;
 	for (const PrintObject *print_object : print.objects()) {
@@ -1320,9 +1439,15 @@ static inline bool sequential_print_horizontal_clearance_valid(const Print &prin
             // instance.shift is a position of a centered object, while model object may not be centered.
             // Conver the shift from the PrintObject's coordinates into ModelObject's coordinates by removing the centering offset.
             convex_hull.translate(instance.shift - print_object->center_offset());
-	        if (! intersection(convex_hulls_other, (Polygons)convex_hull).empty())
+            BoundingBox bbox = get_extents(convex_hull);
+            Polygons    convex_hulls_near;
+            for (size_t i = 0; i < convex_hulls_other.size(); ++ i)
+                if (bbox.overlap(convex_hulls_other_bboxes[i]))
+                    convex_hulls_near.emplace_back(convex_hulls_other[i]);
+	        if (! convex_hulls_near.empty() && ! intersection(convex_hulls_near, (Polygons)convex_hull).empty())
                 return false;
 	        convex_hulls_other.emplace_back(std::move(convex_hull));
+            convex_hulls_other_bboxes.emplace_back(bbox);
         }
 
         /*
@@ -1755,6 +1880,98 @@ Flow Print::skirt_flow(size_t extruder_id, bool first_layer/*=false*/) const
     
 }
 
+void Print::prepare_shared_slicing()
+{
+    m_shared_volume_slices.clear();
+    // Hash the meshes of the objects to be sliced, the objects loaded from the same file several times
+    // don't share the meshes, thus the meshes are compared by their content.
+    std::vector<std::vector<size_t>> mesh_hashes(m_objects.size());
+    std::vector<size_t>              geometry_hashes(m_objects.size(), 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size()), [this, &mesh_hashes, &geometry_hashes](const tbb::blocked_range<size_t> &range) {
+        for (size_t idx_object = range.begin(); idx_object < range.end(); ++ idx_object) {
+            const PrintObject *object = m_objects[idx_object];
+            if (object->is_step_done(posSlice))
+                continue;
+            size_t &seed = geometry_hashes[idx_object];
+            auto hash_matrix = [&seed](const Transform3d &m) { boost::hash_range(seed, m.data(), m.data() + 16); };
+            for (const ModelVolume *volume : object->model_object()->volumes) {
+                size_t mesh_hash = 0;
+                const indexed_triangle_set &its = volume->mesh().its;
+                for (const stl_vertex &v : its.vertices)
+                    boost::hash_range(mesh_hash, v.data(), v.data() + 3);
+                for (const stl_triangle_vertex_indices &f : its.indices)
+                    boost::hash_range(mesh_hash, f.data(), f.data() + 3);
+                mesh_hashes[idx_object].emplace_back(mesh_hash);
+                boost::hash_combine(seed, mesh_hash);
+                boost::hash_combine(seed, int(volume->type()));
+                hash_matrix(volume->get_matrix());
+            }
+            hash_matrix(object->trafo());
+            boost::hash_combine(seed, object->center_offset().x());
+            boost::hash_combine(seed, object->center_offset().y());
+        }
+    });
+    std::map<size_t, size_t> num_objects;
+    for (size_t idx_object = 0; idx_object < m_objects.size(); ++ idx_object)
+        if (! mesh_hashes[idx_object].empty())
+            ++ num_objects[geometry_hashes[idx_object]];
+    for (size_t idx_object = 0; idx_object < m_objects.size(); ++ idx_object) {
+        PrintObject *object = m_objects[idx_object];
+        object->m_volume_mesh_hashes.clear();
+        if (! mesh_hashes[idx_object].empty() && num_objects[geometry_hashes[idx_object]] > 1)
+            object->m_volume_mesh_hashes = std::move(mesh_hashes[idx_object]);
+    }
+}
+
+// Split the objects among the workers of a distributed slicing, the most expensive objects first, each to the least loaded worker.
+// The split only depends on the objects, thus all the workers compute the same split.
+static std::vector<size_t> objects_of_worker(const PrintObjectPtrs &objects, size_t worker_id, size_t num_workers)
+{
+    // Estimate the cost of slicing an object by the number of its triangles times the number of its layers.
+    std::vector<std::pair<double, size_t>> costs;
+    costs.reserve(objects.size());
+    for (size_t idx_object = 0; idx_object < objects.size(); ++ idx_object) {
+        const PrintObject *object = objects[idx_object];
+        size_t num_facets = 0;
+        for (const ModelVolume *volume : object->model_object()->volumes)
+            if (volume->is_model_part())
+                num_facets += volume->mesh().its.indices.size();
+        double layer_height = std::max(EPSILON, object->config().layer_height.value);
+        costs.emplace_back(double(num_facets + 1) * (unscaled(object->height()) / layer_height + 1.), idx_object);
+    }
+    std::sort(costs.begin(), costs.end(), [](const auto &l, const auto &r) { return l.first > r.first || (l.first == r.first && l.second < r.second); });
+    std::vector<double> loads(num_workers, 0.);
+    std::vector<size_t> out;
+    for (const std::pair<double, size_t> &cost : costs) {
+        size_t worker = std::min_element(loads.begin(), loads.end()) - loads.begin();
+        loads[worker] += cost.first;
+        if (worker == worker_id)
+            out.emplace_back(cost.second);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void Print::process_objects_of_worker(size_t worker_id, size_t num_workers)
+{
+    assert(num_workers > 0 && worker_id < num_workers);
+    name_tbb_thread_pool_threads();
+
+    std::vector<size_t> object_ids = objects_of_worker(m_objects, worker_id, num_workers);
+    BOOST_LOG_TRIVIAL(info) << "Slicing " << object_ids.size() << " of " << m_objects.size() << " objects as the worker " << worker_id << " of " << num_workers << log_memory_info();
+    this->prepare_shared_slicing();
+    // Only the steps stored into the SlicesCache are calculated, the rest of the steps depends on the whole print.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, object_ids.size(), 1),
+        [this, &object_ids](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                m_objects[object_ids[i]]->make_perimeters();
+        }
+    );
+    m_shared_volume_slices.clear();
+    this->throw_if_canceled();
+}
+
 bool Print::has_support_material() const
 {
     for (const PrintObject *object : m_objects)
@@ -1786,26 +2003,40 @@ void Print::process()
     name_tbb_thread_pool_threads();
 
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
-    for (PrintObject *obj : m_objects)
-        obj->make_perimeters();
-    this->set_status(70, L("Infilling layers"));
-    for (PrintObject *obj : m_objects)
-        obj->infill();
-    for (PrintObject *obj : m_objects)
-        obj->ironing();
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_material();
+    this->prepare_shared_slicing();
+    // The PrintObject steps only depend on the previous steps of the same object, therefore each object runs its steps
+    // in their order, while the objects are processed concurrently. This way the parallel loops of a plate of many small objects
+    // overlap, instead of each object and each step waiting for the last layer of the previous one.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_objects.size(), 1),
+        [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx_object = range.begin(); idx_object < range.end(); ++ idx_object) {
+                PrintObject *obj = m_objects[idx_object];
+                obj->make_perimeters();
+                obj->infill();
+                obj->ironing();
+                obj->generate_support_material();
+                if (m_release_intermediates)
+                    obj->release_intermediates();
+            }
+        }
+    );
+    m_shared_volume_slices.clear();
+    this->throw_if_canceled();
     if (this->set_started(psWipeTower)) {
-        m_wipe_tower_data.clear();
         m_tool_ordering.clear();
         if (this->has_wipe_tower()) {
             //this->set_status(95, L("Generating wipe tower"));
+            // Clears m_wipe_tower_data, keeping the previous tool changes for reuse.
             this->_make_wipe_tower();
-        } else if (! this->config().complete_objects.value) {
-            // Initialize the tool ordering, so it could be used by the G-code preview slider for planning tool changes and filament switches.
-            m_tool_ordering = ToolOrdering(*this, -1, false);
-            if (m_tool_ordering.empty() || m_tool_ordering.last_extruder() == unsigned(-1))
-                throw Slic3r::SlicingError("The print is empty. The model is not printable with current print settings.");
+        } else {
+            m_wipe_tower_data.clear();
+            if (! this->config().complete_objects.value) {
+                // Initialize the tool ordering, so it could be used by the G-code preview slider for planning tool changes and filament switches.
+                m_tool_ordering = ToolOrdering(*this, -1, false);
+                if (m_tool_ordering.empty() || m_tool_ordering.last_extruder() == unsigned(-1))
+                    throw Slic3r::SlicingError("The print is empty. The model is not printable with current print settings.");
+            }
         }
         this->set_done(psWipeTower);
     }
@@ -1972,41 +2203,47 @@ void Print::_make_skirt(const PrintObjectPtrs &objects, ExtrusionEntityCollectio
     }
     
     // Collect points from all layers contained in skirt height.
+    // The convex hull of the shifted instances is the convex hull of their shifted object hulls. The object hull is cached
+    // at the object, so that after moving the instances around only the hull vertices are shifted again.
     Points points;
     for (const PrintObject *object : objects) {
-        Points object_points;
-        // Get object layers up to skirt_height_z.
-        for (const Layer *layer : object->m_layers) {
-            if (layer->print_z > skirt_height_z)
-                break;
-            for (const ExPolygon &expoly : layer->lslices)
-                // Collect the outer contour points only, ignore holes for the calculation of the convex hull.
-                append(object_points, expoly.contour.points);
-        }
-        // Get support layers up to skirt_height_z.
-        for (const SupportLayer *layer : object->support_layers()) {
-            if (layer->print_z > skirt_height_z)
-                break;
-            for (const ExtrusionEntity *extrusion_entity : layer->support_fills.entities) {
-                Polylines poly;
-                extrusion_entity->collect_polylines(poly);
-                for (const Polyline &polyline : poly)
-                    append(object_points, polyline.points);
+        const coordf_t hull_brim_width = config().skirt_distance_from_brim ? object->config().brim_width.value : -1.;
+        if (object->m_skirt_hull_height != skirt_height_z || object->m_skirt_hull_brim_width != hull_brim_width) {
+            Points object_points;
+            // Get object layers up to skirt_height_z.
+            for (const Layer *layer : object->m_layers) {
+                if (layer->print_z > skirt_height_z)
+                    break;
+                for (const ExPolygon &expoly : layer->lslices)
+                    // Collect the outer contour points only, ignore holes for the calculation of the convex hull.
+                    append(object_points, expoly.contour.points);
             }
+            // Get support layers up to skirt_height_z.
+            for (const SupportLayer *layer : object->support_layers()) {
+                if (layer->print_z > skirt_height_z)
+                    break;
+                for (const ExtrusionEntity *extrusion_entity : layer->support_fills.entities) {
+                    Polylines poly;
+                    extrusion_entity->collect_polylines(poly);
+                    for (const Polyline &polyline : poly)
+                        append(object_points, polyline.points);
+                }
+            }
+            // Include the brim.
+            if (config().skirt_distance_from_brim) {
+                for (const ExPolygon& expoly : object->m_layers[0]->lslices)
+                    for (const Polygon& poly : offset(expoly.contour, scale_(object->config().brim_width)))
+                        append(object_points, poly.points);
+            }
+            object->m_skirt_hull             = object_points.size() < 3 ? std::move(object_points) : Slic3r::Geometry::convex_hull(std::move(object_points)).points;
+            object->m_skirt_hull_height      = skirt_height_z;
+            object->m_skirt_hull_brim_width  = hull_brim_width;
         }
-        // Include the brim.
-        if (config().skirt_distance_from_brim) {
-            for (const ExPolygon& expoly : object->m_layers[0]->lslices)
-                for (const Polygon& poly : offset(expoly.contour, scale_(object->config().brim_width)))
-                    append(object_points, poly.points);
-        }
-        // Repeat points for each object copy.
-        for (const PrintInstance &instance : object->instances()) {
-            Points copy_points = object_points;
-            for (Point &pt : copy_points)
-                pt += instance.shift;
-            append(points, copy_points);
-        }
+        // Repeat the hull for each object copy.
+        points.reserve(points.size() + object->m_skirt_hull.size() * object->instances().size());
+        for (const PrintInstance &instance : object->instances())
+            for (const Point &pt : object->m_skirt_hull)
+                points.emplace_back(pt + instance.shift);
     }
 
     // Include the wipe tower.
@@ -2276,6 +2513,58 @@ void Print::_extrude_brim_from_tree(std::vector<std::vector<BrimLoop>>& loops, c
     }
 }
 
+// Splits the islands into groups, which brims can't touch each other: the bounding boxes of the islands grown by reach
+// overlap transitively inside a group and don't overlap between the groups. The groups keep the order of their first island.
+static std::vector<ExPolygons> group_brim_islands(ExPolygons &&islands, coord_t reach)
+{
+    namespace bgm = boost::geometry::model;
+    namespace bgi = boost::geometry::index;
+    using rtree_point_t = bgm::point<double, 2, boost::geometry::cs::cartesian>;
+    using rtree_box_t   = bgm::box<rtree_point_t>;
+    using rtree_value_t = std::pair<rtree_box_t, size_t>;
+
+    std::vector<rtree_value_t> boxes;
+    boxes.reserve(islands.size());
+    for (size_t i = 0; i < islands.size(); ++ i) {
+        BoundingBox bbox = get_extents(islands[i].contour);
+        bbox.offset(reach);
+        boxes.emplace_back(rtree_box_t(rtree_point_t(double(bbox.min.x()), double(bbox.min.y())), rtree_point_t(double(bbox.max.x()), double(bbox.max.y()))), i);
+    }
+    bgi::rtree<rtree_value_t, bgi::rstar<16, 4>> rtree(boxes.begin(), boxes.end());
+
+    // Union-find over the overlapping boxes, the root of a set is its lowest index.
+    std::vector<size_t> parent(islands.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find_root = [&parent](size_t i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    std::vector<rtree_value_t> hits;
+    for (const rtree_value_t &box : boxes) {
+        hits.clear();
+        rtree.query(bgi::intersects(box.first), std::back_inserter(hits));
+        for (const rtree_value_t &hit : hits) {
+            size_t a = find_root(box.second);
+            size_t b = find_root(hit.second);
+            if (a != b)
+                parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    std::vector<ExPolygons> groups;
+    std::vector<size_t>     group_of_root(islands.size(), size_t(-1));
+    for (size_t i = 0; i < islands.size(); ++ i) {
+        size_t root = find_root(i);
+        if (group_of_root[root] == size_t(-1)) {
+            group_of_root[root] = groups.size();
+            groups.emplace_back();
+        }
+        groups[group_of_root[root]].emplace_back(std::move(islands[i]));
+    }
+    return groups;
+}
+
 //TODO: test if no regression vs old _make_brim.
 // this new one can extrude brim for an object inside an other object.
 void Print::_make_brim(const Flow &flow, const PrintObjectPtrs &objects, ExPolygons &unbrimmable, ExtrusionEntityCollection &out) {
@@ -2306,6 +2595,36 @@ void Print::_make_brim(const Flow &flow, const PrintObjectPtrs &objects, ExPolyg
 
     this->throw_if_canceled();
 
+    const size_t num_loops = size_t(floor(std::max(0.,(brim_config.brim_width.value - brim_config.brim_offset.value)) / flow.spacing()));
+    // The brims of islands further apart than twice the brim width don't touch, thus the brim of each group of nearby islands
+    // is generated separately and in parallel. With many instances on the plate, the unions and the clipping then run over
+    // a neighbourhood each instead of over all the islands of the plate.
+    const coord_t brim_reach = coord_t(num_loops + 1) * flow.scaled_spacing();
+    std::vector<ExPolygons>  island_groups = group_brim_islands(std::move(islands), brim_reach);
+    std::vector<BoundingBox> unbrimmable_bboxes = get_extents_vector(unbrimmable);
+    std::vector<ExtrusionEntityCollection> group_brims(island_groups.size());
+    std::vector<ExPolygons>                group_brimmable_areas(island_groups.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, island_groups.size()),
+        [this, &flow, num_loops, brim_reach, &island_groups, &unbrimmable, &unbrimmable_bboxes, &group_brims, &group_brimmable_areas](const tbb::blocked_range<size_t> &range) {
+            for (size_t group_id = range.begin(); group_id < range.end(); ++ group_id) {
+                BoundingBox bbox = get_extents(island_groups[group_id]);
+                bbox.offset(brim_reach);
+                ExPolygons group_unbrimmable;
+                for (size_t i = 0; i < unbrimmable.size(); ++ i)
+                    if (bbox.overlap(unbrimmable_bboxes[i]))
+                        group_unbrimmable.emplace_back(unbrimmable[i]);
+                group_brimmable_areas[group_id] = this->_make_brim_from_islands(flow, num_loops, std::move(island_groups[group_id]), group_unbrimmable, group_brims[group_id]);
+            }
+        });
+    for (size_t group_id = 0; group_id < island_groups.size(); ++ group_id) {
+        out.append(std::move(group_brims[group_id].entities));
+        append(unbrimmable, std::move(group_brimmable_areas[group_id]));
+    }
+}
+
+// Brim of a group of islands, see group_brim_islands(). Returns the area covered by the brim.
+ExPolygons Print::_make_brim_from_islands(const Flow &flow, size_t num_loops, ExPolygons islands, const ExPolygons &unbrimmable, ExtrusionEntityCollection &out)
+{
     //simplify & merge
     ExPolygons unbrimmable_areas;
     for (ExPolygon &expoly : islands)
@@ -2315,7 +2634,6 @@ void Print::_make_brim(const Flow &flow, const PrintObjectPtrs &objects, ExPolyg
     unbrimmable_areas = islands;
 
     //get the brimmable area
-    const size_t num_loops = size_t(floor(std::max(0.,(brim_config.brim_width.value - brim_config.brim_offset.value)) / flow.spacing()));
     ExPolygons brimmable_areas;
     for (ExPolygon &expoly : islands) {
         for (Polygon poly : offset(expoly.contour, num_loops * flow.scaled_spacing(), jtSquare)) {
@@ -2386,8 +2704,8 @@ void Print::_make_brim(const Flow &flow, const PrintObjectPtrs &objects, ExPolyg
     frontiers.insert(frontiers.begin(), unbrimmable_polygons.begin(), unbrimmable_polygons.end());
 
     _extrude_brim_from_tree(loops, frontiers, flow, out);
-    
-    unbrimmable.insert(unbrimmable.end(), brimmable_areas.begin(), brimmable_areas.end());
+
+    return brimmable_areas;
 }
 
 void Print::_make_brim_ears(const Flow &flow, const PrintObjectPtrs &objects, ExPolygons &unbrimmable, ExtrusionEntityCollection &out) {
@@ -2579,10 +2897,36 @@ void Print::_make_brim_interior(const Flow &flow, const PrintObjectPtrs &objects
             }
     }
 
+    const size_t num_loops = size_t(floor((brim_config.brim_width_interior.value - brim_config.brim_offset.value) / flow.spacing()));
+    // The interior brim stays inside the holes of the islands, thus only the overlapping islands are processed together, see _make_brim().
+    std::vector<ExPolygons>  island_groups = group_brim_islands(std::move(islands), SCALED_EPSILON);
+    std::vector<BoundingBox> unbrimmable_bboxes = get_extents_vector(unbrimmable_areas);
+    std::vector<ExtrusionEntityCollection> group_brims(island_groups.size());
+    std::vector<ExPolygons>                group_brimmable_areas(island_groups.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, island_groups.size()),
+        [this, &flow, num_loops, &island_groups, &unbrimmable_areas, &unbrimmable_bboxes, &group_brims, &group_brimmable_areas](const tbb::blocked_range<size_t> &range) {
+            for (size_t group_id = range.begin(); group_id < range.end(); ++ group_id) {
+                BoundingBox bbox = get_extents(island_groups[group_id]);
+                bbox.offset(SCALED_EPSILON);
+                ExPolygons group_unbrimmable;
+                for (size_t i = 0; i < unbrimmable_areas.size(); ++ i)
+                    if (bbox.overlap(unbrimmable_bboxes[i]))
+                        group_unbrimmable.emplace_back(unbrimmable_areas[i]);
+                group_brimmable_areas[group_id] = this->_make_brim_interior_from_islands(flow, num_loops, std::move(island_groups[group_id]), group_unbrimmable, group_brims[group_id]);
+            }
+        });
+    for (size_t group_id = 0; group_id < island_groups.size(); ++ group_id) {
+        out.append(std::move(group_brims[group_id].entities));
+        append(unbrimmable_areas, std::move(group_brimmable_areas[group_id]));
+    }
+}
+
+// Interior brim of a group of islands, see group_brim_islands(). Returns the area covered by the brim.
+ExPolygons Print::_make_brim_interior_from_islands(const Flow &flow, size_t num_loops, ExPolygons islands, const ExPolygons &unbrimmable_areas, ExtrusionEntityCollection &out)
+{
     islands = union_ex(islands);
 
     //to have the brimmable areas, get all holes, use them as contour , add smaller hole inside and make a diff with unbrimmable
-    const size_t num_loops = size_t(floor((brim_config.brim_width_interior.value - brim_config.brim_offset.value) / flow.spacing()));
     ExPolygons brimmable_areas;
     Polygons islands_to_loops;
     for (const ExPolygon &expoly : islands) {
@@ -2634,7 +2978,7 @@ void Print::_make_brim_interior(const Flow &flow, const PrintObjectPtrs &objects
 
     _extrude_brim_from_tree(loops, frontiers, flow, out, true);
 
-    unbrimmable_areas.insert(unbrimmable_areas.end(), brimmable_areas.begin(), brimmable_areas.end());
+    return brimmable_areas;
 }
 
 /// reorder & join polyline if their ending are near enough, then extrude the brim from the polyline into 'out'.
@@ -2754,9 +3098,21 @@ void Print::finalize_first_layer_convex_hull()
 {
     append(m_first_layer_convex_hull.points, m_skirt_convex_hull);
     if (m_first_layer_convex_hull.empty()) {
-        // Neither skirt nor brim was extruded. Collect points of printed objects from 1st layer.
-        for (Polygon &poly : this->first_layer_islands())
-            append(m_first_layer_convex_hull.points, std::move(poly.points));
+        // Neither skirt nor brim was extruded. Collect points of printed objects from 1st layer,
+        // the hull of each object is shifted to its instances.
+        for (const PrintObject *object : m_objects) {
+            Points object_points;
+            for (const ExPolygon &expoly : object->m_layers.front()->lslices)
+                append(object_points, expoly.contour.points);
+            if (! object->support_layers().empty())
+                for (Polygon &poly : object->support_layers().front()->support_fills.polygons_covered_by_spacing(float(SCALED_EPSILON)))
+                    append(object_points, std::move(poly.points));
+            if (object_points.size() >= 3)
+                object_points = Geometry::convex_hull(std::move(object_points)).points;
+            for (const PrintInstance &instance : object->instances())
+                for (const Point &pt : object_points)
+                    m_first_layer_convex_hull.points.emplace_back(pt + instance.shift);
+        }
     }
     append(m_first_layer_convex_hull.points, this->first_layer_wipe_tower_corners());
     m_first_layer_convex_hull = Geometry::convex_hull(m_first_layer_convex_hull.points);
@@ -2788,7 +3144,9 @@ const WipeTowerData& Print::wipe_tower_data(size_t extruders_cnt, double first_l
 
 void Print::_make_wipe_tower()
 {
-    m_wipe_tower_data.clear();
+    // Keep the wipe tower generated the last time, it is reused below if the same wipe tower is planned again.
+    WipeTowerData previous_wipe_tower(m_tool_ordering);
+    previous_wipe_tower.swap_generated(m_wipe_tower_data);
     if (! this->has_wipe_tower())
         return;
 
@@ -2923,14 +3281,36 @@ void Print::_make_wipe_tower()
         }
     }
 
+    // Unload the current filament over the purge tower.
+    coordf_t layer_height = m_objects.front()->config().layer_height.value;
+
+    // The generated wipe tower depends on the plan, on the configuration and on the final purge layer only.
+    // Regenerating the same wipe tower is the bulk of this step, thus reuse the previous one if nothing changed.
+    size_t plan_hash = wipe_tower.plan_hash();
+    for (const std::string &opt_key : m_config.keys())
+        boost::hash_combine(plan_hash, m_config.opt_serialize(opt_key));
+    for (const std::string &opt_key : m_default_object_config.keys())
+        boost::hash_combine(plan_hash, m_default_object_config.opt_serialize(opt_key));
+    boost::hash_combine(plan_hash, m_wipe_tower_data.tool_ordering.back().print_z);
+    boost::hash_combine(plan_hash, m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions > 0);
+    boost::hash_combine(plan_hash, layer_height);
+    if (previous_wipe_tower.final_purge && previous_wipe_tower.plan_hash == plan_hash) {
+        BOOST_LOG_TRIVIAL(debug) << "Reusing the previously generated wipe tower";
+        m_wipe_tower_data.tool_changes          = std::move(previous_wipe_tower.tool_changes);
+        m_wipe_tower_data.final_purge           = std::move(previous_wipe_tower.final_purge);
+        m_wipe_tower_data.used_filament         = std::move(previous_wipe_tower.used_filament);
+        m_wipe_tower_data.number_of_toolchanges = previous_wipe_tower.number_of_toolchanges;
+        m_wipe_tower_data.depth                 = m_wipe_tower_data.plan_depth      = previous_wipe_tower.plan_depth;
+        m_wipe_tower_data.brim_width            = m_wipe_tower_data.plan_brim_width = previous_wipe_tower.plan_brim_width;
+        m_wipe_tower_data.plan_hash             = plan_hash;
+        return;
+    }
+
     // Generate the wipe tower layers.
     m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
     wipe_tower.generate(m_wipe_tower_data.tool_changes);
-    m_wipe_tower_data.depth = wipe_tower.get_depth();
-    m_wipe_tower_data.brim_width = wipe_tower.get_brim_width();
-
-    // Unload the current filament over the purge tower.
-    coordf_t layer_height = m_objects.front()->config().layer_height.value;
+    m_wipe_tower_data.depth      = m_wipe_tower_data.plan_depth      = wipe_tower.get_depth();
+    m_wipe_tower_data.brim_width = m_wipe_tower_data.plan_brim_width = wipe_tower.get_brim_width();
     if (m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions > 0) {
         // The wipe tower goes up to the last layer of the print.
         if (wipe_tower.layer_finished()) {
@@ -2950,6 +3330,7 @@ void Print::_make_wipe_tower()
 
     m_wipe_tower_data.used_filament = wipe_tower.get_used_filament();
     m_wipe_tower_data.number_of_toolchanges = wipe_tower.get_number_of_toolchanges();
+    m_wipe_tower_data.plan_hash = plan_hash;
 }
 
 // Generate a recommended G-code output file name based on the format template, default extension, and template parameters
@@ -2964,6 +3345,33 @@ std::string Print::output_filename(const std::string &filename_base) const
     return this->PrintBase::output_filename(m_config.output_filename_format.value, ".gcode", filename_base, &config);
 }
 
+std::string Print::step_profiles_json() const
+{
+    static const std::array<const char*, psCount>  print_step_names  { "wipe_tower", "skirt", "brim", "gcode_export" };
+    static const std::array<const char*, posCount> object_step_names { "slice", "perimeters", "prepare_infill", "infill", "ironing", "support_material" };
+    return print_step_profiles_json<PrintStep, PrintObjectStep>(*this, "FFF", print_step_names, object_step_names);
+}
+
+void PrintStatistics::update_weight_and_cost(const GCodeConfig &config)
+{
+    this->total_weight          = 0.;
+    this->total_cost            = 0.;
+    this->total_wipe_tower_cost = 0.;
+    for (const std::pair<const size_t, double> &volume : this->extruded_volumes) {
+        double density = config.filament_density.get_at(volume.first);
+        double cost    = config.filament_cost.get_at(volume.first);
+        double weight  = volume.second * density * 0.001;
+        if (weight > 0.) {
+            this->total_weight += weight;
+            if (cost > 0.)
+                this->total_cost += weight * cost * 0.001;
+        }
+        auto it_wipe_tower = this->wipe_tower_volumes.find(volume.first);
+        if (it_wipe_tower != this->wipe_tower_volumes.end())
+            this->total_wipe_tower_cost += it_wipe_tower->second * density * 0.001 * cost * 0.001;
+    }
+}
+
 DynamicConfig PrintStatistics::config() const
 {
     DynamicConfig config;
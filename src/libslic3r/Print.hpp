@@ -16,6 +16,11 @@
 
 #include "libslic3r.h"
 
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+
 namespace Slic3r {
 
 class Print;
@@ -25,11 +30,16 @@ class GCode;
 enum class SlicingMode : uint32_t;
 class Layer;
 class SupportLayer;
+class SeamPlacer;
+struct CustomSeamTriangles;
+class PrintObjectSupportMaterial;
+struct SupportContactsCache;
 
 namespace FillAdaptive {
     struct Octree;
     struct OctreeDeleter;
     using OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
+    using OctreeSharedPtr = std::shared_ptr<Octree>;
 };
 
 // Print step IDs for keeping track of the print state.
@@ -77,13 +87,20 @@ public:
 	void                        collect_object_printing_extruders(std::set<uint16_t> &object_extruders) const;
 	static void                 collect_object_printing_extruders(const PrintConfig &print_config, const PrintObjectConfig &object_config, const PrintRegionConfig &region_config, std::set<uint16_t> &object_extruders);
 
+    // Serialized values of the options that Layer::make_perimeters() requires to be identical
+    // for two regions to share their perimeters, and its hash. Updated whenever the config changes.
+    const std::string&          perimeter_config_key() const { return m_perimeter_config_key; }
+    size_t                      perimeter_config_hash() const { return m_perimeter_config_hash; }
+    bool                        has_same_perimeter_config(const PrintRegion &other) const
+        { return m_perimeter_config_hash == other.m_perimeter_config_hash && m_perimeter_config_key == other.m_perimeter_config_key; }
+
 // Methods modifying the PrintRegion's state:
 public:
     Print*                      print() { return m_print; }
-    void                        set_config(const PrintRegionConfig &config) { m_config = config; }
-    void                        set_config(PrintRegionConfig &&config) { m_config = std::move(config); }
+    void                        set_config(const PrintRegionConfig &config) { m_config = config; this->update_perimeter_config_key(); }
+    void                        set_config(PrintRegionConfig &&config) { m_config = std::move(config); this->update_perimeter_config_key(); }
     void                        config_apply_only(const ConfigBase &other, const t_config_option_keys &keys, bool ignore_nonexistent = false) 
-                                        { this->m_config.apply_only(other, keys, ignore_nonexistent); }
+                                        { this->m_config.apply_only(other, keys, ignore_nonexistent); this->update_perimeter_config_key(); }
 
 protected:
     size_t             m_refcnt;
@@ -91,9 +108,13 @@ protected:
 private:
     Print             *m_print;
     PrintRegionConfig  m_config;
+    std::string        m_perimeter_config_key;
+    size_t             m_perimeter_config_hash { 0 };
+
+    void               update_perimeter_config_key();
     
     //PrintRegion(Print* print) : m_refcnt(0), m_print(print) {}
-    PrintRegion(Print* print, const PrintRegionConfig& config) : m_refcnt(0), m_print(print), m_config(config) {}
+    PrintRegion(Print* print, const PrintRegionConfig& config) : m_refcnt(0), m_print(print), m_config(config) { this->update_perimeter_config_key(); }
     ~PrintRegion() = default;
 };
 
@@ -210,6 +231,10 @@ public:
 protected:
     // to be called from Print only.
     friend class Print;
+    // to cache the projected custom seams.
+    friend class SeamPlacer;
+    // to cache the support contact layers.
+    friend class PrintObjectSupportMaterial;
 
 	PrintObject(Print* print, ModelObject* model_object, const Transform3d& trafo, PrintInstances&& instances);
 	~PrintObject() = default;
@@ -221,6 +246,9 @@ protected:
     bool                    invalidate_step(PrintObjectStep step);
     // Invalidates all PrintObject and Print steps.
     bool                    invalidate_all_steps();
+    // Invalidates the supports after a change of the support painting touching just the Z range <z_min, z_max>.
+    // The support contact layers out of the range will be reused by the next support generation.
+    bool                    invalidate_support_painting(coordf_t z_min, coordf_t z_max);
     // Invalidate steps based on a set of parameters changed.
     bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys);
     // If ! m_slicing_params.valid, recalculate.
@@ -229,14 +257,27 @@ protected:
     static PrintObjectConfig object_config_from_model_object(const PrintObjectConfig &default_object_config, const ModelObject &object, size_t num_extruders);
     static PrintRegionConfig region_config_from_model_volume(const PrintRegionConfig &default_region_config, const DynamicPrintConfig *layer_range_config, const ModelVolume &volume, size_t num_extruders);
 
+    // Layers produced by the step.
+    size_t                  step_items(PrintObjectStep step) const override;
+
 private:
     void make_perimeters();
     void prepare_infill();
     void infill();
     void ironing();
     void generate_support_material();
+    // Drop the data of the layers which are only needed to recalculate the steps before the G-code export, see Print::set_release_intermediates().
+    void release_intermediates();
 
     void _slice(const std::vector<coordf_t> &layer_height_profile);
+    // Hash of the inputs of the slicing step, see SlicesCache.
+    uint64_t slices_cache_key(const std::vector<coordf_t> &layer_height_profile) const;
+    bool restore_slices_from_cache(uint64_t key);
+    void store_slices_to_cache(uint64_t key) const;
+    // Hash of the inputs of the perimeters step, derived from the key of the slices the perimeters are generated from.
+    uint64_t perimeters_cache_key() const;
+    bool restore_perimeters_from_cache(uint64_t key);
+    void store_perimeters_to_cache(uint64_t key) const;
     ExPolygons _shrink_contour_holes(double contour_delta, double default_delta, double convex_delta, const ExPolygons& input) const;
     ExPolygons _grow_contour_holes(double contour_delta, double default_delta, double convex_delta, const ExPolygons& input) const;
     void _transform_hole_to_polyholes();
@@ -254,7 +295,7 @@ private:
     void discover_horizontal_shells();
     void combine_infill();
     void _generate_support_material();
-    std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> prepare_adaptive_infill_data();
+    std::pair<FillAdaptive::OctreeSharedPtr, FillAdaptive::OctreeSharedPtr> prepare_adaptive_infill_data();
 
     // XYZ in scaled coordinates
     Vec3crd									m_size;
@@ -280,6 +321,30 @@ private:
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                                    m_typed_slices = false;
+    // Key of the current slices in the SlicesCache, valid once posSlice is done.
+    uint64_t                                m_slices_cache_key = 0;
+
+    // Custom seam enforcers and blockers projected onto the layers by the last SeamPlacer::init(),
+    // reused by the next G-code export if the seam painting, the meshes and the layers did not change.
+    mutable std::shared_ptr<const CustomSeamTriangles> m_custom_seam_triangles;
+    // Convex hull of the object without the instance shifts, collected by the last Print::_make_skirt() up to m_skirt_hull_height
+    // and with the brim of m_skirt_hull_brim_width (-1 if the skirt does not follow the brim). Invalid if m_skirt_hull_height < 0.
+    mutable Points                          m_skirt_hull;
+    mutable coordf_t                        m_skirt_hull_height = -1.;
+    mutable coordf_t                        m_skirt_hull_brim_width = -1.;
+    // Hashes of the meshes of model_object()->volumes, set by Print::prepare_shared_slicing() if another PrintObject
+    // with the same meshes and placement is going to be sliced, empty otherwise. See slice_shared().
+    std::vector<size_t>                     m_volume_mesh_hashes;
+    // Top contact layers of the last support generation, see SupportContactsCache.
+    std::shared_ptr<SupportContactsCache>   m_support_contacts_cache;
+    // Set by invalidate_support_painting() to keep m_support_contacts_cache while invalidating posSupportMaterial.
+    bool                                    m_support_invalidated_by_painting = false;
+    // Set by release_intermediates(), the steps it released the inputs of are then recalculated from posSlice.
+    bool                                    m_intermediates_released = false;
+    // Octrees of the adaptive cubic and support cubic infill built by the last infill(). They are held until the next infill(),
+    // so that the other objects with the same mesh and line spacing reuse them, see FillAdaptive::build_octree_shared().
+    FillAdaptive::OctreeSharedPtr           m_adaptive_fill_octree;
+    FillAdaptive::OctreeSharedPtr           m_support_fill_octree;
 
     std::vector<ExPolygons> slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below) const;
     std::vector<ExPolygons> slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode) const
@@ -293,6 +358,16 @@ private:
         { return this->slice_volumes(z, mode, 0, mode, volumes); }
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, SlicingMode mode, const ModelVolume &volume) const;
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, const std::vector<t_layer_height_range> &ranges, SlicingMode mode, const ModelVolume &volume) const;
+    std::vector<ExPolygons> _slice_volumes(
+        const std::vector<float> &z,
+        SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below,
+        const std::vector<const ModelVolume*> &volumes) const;
+    std::vector<ExPolygons> _slice_volume(const std::vector<float> &z, SlicingMode mode, const ModelVolume &volume) const;
+    // Hash of the inputs of a raw slicing of the volumes by slice_volumes(), or by slice_volume() if merged is false.
+    uint64_t volume_slices_key(bool merged, const std::vector<float> &z, SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below,
+        const std::vector<const ModelVolume*> &volumes) const;
+    // Returns the slices produced by slice_fn, which may have been produced by another PrintObject of equal meshes and placement.
+    std::vector<ExPolygons> slice_shared(uint64_t key, const std::function<std::vector<ExPolygons>()> &slice_fn) const;
 
 
 };
@@ -322,6 +397,9 @@ struct WipeTowerData
         number_of_toolchanges = -1;
         depth = 0.f;
         brim_width = 0.f;
+        plan_hash = 0;
+        plan_depth = 0.f;
+        plan_brim_width = 0.f;
     }
 
 private:
@@ -329,6 +407,26 @@ private:
 	// as this WipeTowerData shares reference to Print::m_tool_ordering.
 	friend class Print;
 	WipeTowerData(ToolOrdering &tool_ordering) : tool_ordering(tool_ordering) { clear(); }
+	// Exchanges the generated wipe tower with rhs, the tool ordering is not touched.
+	void swap_generated(WipeTowerData &rhs) {
+        std::swap(priming, rhs.priming);
+        std::swap(tool_changes, rhs.tool_changes);
+        std::swap(final_purge, rhs.final_purge);
+        std::swap(used_filament, rhs.used_filament);
+        std::swap(number_of_toolchanges, rhs.number_of_toolchanges);
+        std::swap(depth, rhs.depth);
+        std::swap(brim_width, rhs.brim_width);
+        std::swap(plan_hash, rhs.plan_hash);
+        std::swap(plan_depth, rhs.plan_depth);
+        std::swap(plan_brim_width, rhs.plan_brim_width);
+    }
+
+    // Hash of the wipe tower plan and of the configuration the tool changes were generated from, and the depth
+    // and brim width they were generated with (depth and brim_width are overwritten by estimates while psWipeTower is invalid).
+    // Print::_make_wipe_tower() reuses the tool changes if it plans the same wipe tower again.
+    size_t                                                plan_hash;
+    float                                                 plan_depth;
+    float                                                 plan_brim_width;
 	WipeTowerData(const WipeTowerData & /* rhs */) = delete;
 	WipeTowerData &operator=(const WipeTowerData & /* rhs */) = delete;
 };
@@ -348,6 +446,13 @@ struct PrintStatistics
     double                          total_wipe_tower_cost;
     double                          total_wipe_tower_filament;
     std::map<size_t, float>         filament_stats;
+    // Volume of filament (mm3) extruded by each extruder, and the part of it extruded for the wipe tower.
+    std::map<size_t, double>        extruded_volumes;
+    std::map<size_t, double>        wipe_tower_volumes;
+
+    // Recomputes the weights and the costs from the extruded volumes, for instance after the filament density
+    // or cost changed, without exporting the G-code again.
+    void                    update_weight_and_cost(const GCodeConfig &config);
 
     // Config with the filled in print statistics.
     DynamicConfig           config() const;
@@ -365,6 +470,8 @@ struct PrintStatistics
         total_wipe_tower_cost  = 0.;
         total_wipe_tower_filament = 0.;
         filament_stats.clear();
+        extruded_volumes.clear();
+        wipe_tower_volumes.clear();
     }
 };
 
@@ -417,6 +524,14 @@ public:
     ApplyStatus         apply(const Model &model, DynamicPrintConfig config) override;
 
     void                process() override;
+    // Release the intermediate data of the layers once the object steps are done, to lower the peak memory of a command line
+    // or server slicing. Invalidating a step which needs the released data then recalculates the object from its slicing.
+    void                set_release_intermediates(bool release) { m_release_intermediates = release; }
+    // Worker of a distributed slicing: slices and generates the perimeters of the share of the objects assigned to worker_id
+    // out of num_workers, storing the results into the SlicesCache. The objects are split by their estimated cost deterministically,
+    // thus the workers started with the same input and configuration cover all the objects. The G-code is then exported
+    // by a regular process() of the same job sharing the SlicesCache directory, which restores the objects from the cache.
+    void                process_objects_of_worker(size_t worker_id, size_t num_workers);
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodeProcessor::Result* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
@@ -485,6 +600,8 @@ public:
 
 	std::string                 output_filename(const std::string &filename_base = std::string()) const override;
 
+    std::string                 step_profiles_json() const override;
+
     // Accessed by SupportMaterial
     const PrintRegion*  get_region(size_t idx) const  { return m_regions[idx]; }
     const ToolOrdering& get_tool_ordering() const { return m_wipe_tower_data.tool_ordering; }   // #ys_FIXME just for testing
@@ -500,6 +617,9 @@ protected:
     // Invalidates the step, and its depending steps in Print.
     bool                invalidate_step(PrintStep step);
 
+    // Objects processed by the step.
+    size_t              step_items(PrintStep /* step */) const override { return m_objects.size(); }
+
 private:
 	void 				config_diffs(
 		const DynamicPrintConfig &new_full_config, 
@@ -509,12 +629,16 @@ private:
 
     void                _make_skirt(const PrintObjectPtrs &objects, ExtrusionEntityCollection &out, std::optional<ExtrusionEntityCollection> &out_first_layer);
     void                _make_brim(const Flow &flow, const PrintObjectPtrs &objects, ExPolygons &unbrimmable, ExtrusionEntityCollection &out);
+    ExPolygons          _make_brim_from_islands(const Flow &flow, size_t num_loops, ExPolygons islands, const ExPolygons &unbrimmable, ExtrusionEntityCollection &out);
     void                _make_brim_ears(const Flow &flow, const PrintObjectPtrs &objects, ExPolygons &unbrimmable, ExtrusionEntityCollection &out);
     void                _make_brim_interior(const Flow &flow, const PrintObjectPtrs &objects, ExPolygons &unbrimmable, ExtrusionEntityCollection &out);
+    ExPolygons          _make_brim_interior_from_islands(const Flow &flow, size_t num_loops, ExPolygons islands, const ExPolygons &unbrimmable, ExtrusionEntityCollection &out);
     void                _extrude_brim_from_tree(std::vector<std::vector<BrimLoop>> &loops, const Polygons &frontiers, const Flow &flow, ExtrusionEntityCollection &out, bool reversed = false);
     Polylines           _reorder_brim_polyline(Polylines lines, ExtrusionEntityCollection &out, const Flow &flow);
     void                _make_wipe_tower();
     void                finalize_first_layer_convex_hull();
+    // Finds the PrintObjects to be sliced, which have the same meshes and placement, and lets them share the raw slices.
+    void                prepare_shared_slicing();
 
     // Islands of objects and their supports extruded at the 1st layer.
     Polygons            first_layer_islands() const;
@@ -549,6 +673,13 @@ private:
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
 
+    // Raw slices of the volumes shared by the PrintObjects of equal meshes and placement while they are sliced
+    // by Print::process(), see PrintObject::slice_shared().
+    std::mutex                                                          m_shared_volume_slices_mutex;
+    std::map<uint64_t, std::shared_future<std::vector<ExPolygons>>>     m_shared_volume_slices;
+    // See set_release_intermediates().
+    bool                                                                m_release_intermediates = false;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
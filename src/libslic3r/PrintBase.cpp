@@ -1,6 +1,11 @@
 #include "Exception.hpp"
 #include "PrintBase.hpp"
 
+#include "Utils.hpp"
+
+#include <chrono>
+
+#include <boost/chrono/process_cpu_clocks.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -15,6 +20,64 @@ namespace Slic3r
 
 size_t PrintStateBase::g_last_timestamp = 0;
 
+static double wall_time_now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double cpu_time_now()
+{
+    // User + system time of all the threads of the process.
+    return boost::chrono::duration<double>(boost::chrono::process_user_cpu_clock::now().time_since_epoch()).count() +
+           boost::chrono::duration<double>(boost::chrono::process_system_cpu_clock::now().time_since_epoch()).count();
+}
+
+void PrintStepProfile::start()
+{
+    *this = PrintStepProfile();
+    m_start_wall_time   = wall_time_now();
+    m_start_cpu_time    = cpu_time_now();
+    m_start_peak_memory = peak_memory_usage();
+}
+
+void PrintStepProfile::stop(size_t items)
+{
+    if (m_start_wall_time == 0.)
+        // The step was marked as done without having been started.
+        return;
+    size_t peak_memory = peak_memory_usage();
+    this->wall_time         = wall_time_now() - m_start_wall_time;
+    this->cpu_time          = cpu_time_now() - m_start_cpu_time;
+    this->peak_memory_delta = peak_memory > m_start_peak_memory ? peak_memory - m_start_peak_memory : 0;
+    this->items             = items;
+    this->finished          = true;
+}
+
+void PrintStepProfile::append_json(std::string &out, const char *step_name) const
+{
+    char buf[256];
+    sprintf(buf, "{ \"step\": \"%s\", \"finished\": %s, \"wall_time\": %.6f, \"cpu_time\": %.6f, \"peak_memory_delta\": %zu, \"items\": %zu }",
+        step_name, this->finished ? "true" : "false", this->wall_time, this->cpu_time, this->peak_memory_delta, this->items);
+    out += buf;
+}
+
+void PrintStepProfile::append_json_string(std::string &out, const std::string &str)
+{
+    out += '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            sprintf(buf, "\\u%04x", int(c));
+            out += buf;
+        } else
+            out += c;
+    }
+    out += '"';
+}
+
 // Update "scale", "input_filename", "input_filename_base" placeholders from the current m_objects.
 void PrintBase::update_object_placeholders(DynamicConfig &config, const std::string &default_ext) const
 {
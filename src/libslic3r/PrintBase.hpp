@@ -2,6 +2,7 @@
 #define slic3r_PrintBase_hpp_
 
 #include "libslic3r.h"
+#include <array>
 #include <set>
 #include <vector>
 #include <string>
@@ -302,6 +303,37 @@ private:
     int                 m_step_active = -1;
 };
 
+// Resources consumed by the last run of a Print / PrintObject step, measured between set_started() and set_done().
+class PrintStepProfile
+{
+public:
+    // Wall clock time in seconds.
+    double  wall_time           { 0. };
+    // CPU time of the whole process in seconds, summed over all threads.
+    double  cpu_time            { 0. };
+    // Growth of the peak resident memory of the process in bytes.
+    size_t  peak_memory_delta   { 0 };
+    // Number of items produced by the step (layers, support points, ...), zero if not applicable.
+    size_t  items               { 0 };
+    // The step has finished since it was last started.
+    bool    finished            { false };
+
+    // Reset the profile and sample the process counters.
+    void    start();
+    // Measure the resources consumed since start().
+    void    stop(size_t items);
+
+    // Append the profile as a JSON object.
+    void    append_json(std::string &out, const char *step_name) const;
+    // Append a string as a quoted and escaped JSON string.
+    static void append_json_string(std::string &out, const std::string &str);
+
+private:
+    double  m_start_wall_time   { 0. };
+    double  m_start_cpu_time    { 0. };
+    size_t  m_start_peak_memory { 0 };
+};
+
 class PrintBase;
 
 class PrintObjectBase : public ObjectBase
@@ -467,6 +499,10 @@ public:
     // If filename_set is empty, than the path may be a file or directory. If it is a file, then the macro will not be processed.
     std::string                output_filepath(const std::string &path, const std::string &filename_base = std::string()) const;
 
+    // Wall time, CPU time, peak memory growth and item count of the last run of each Print and PrintObject step
+    // as a JSON document. To be queried after process() finished.
+    virtual std::string        step_profiles_json() const = 0;
+
 protected:
 	friend class PrintObjectBase;
     friend class BackgroundSlicingProcess;
@@ -514,11 +550,18 @@ public:
     bool            is_step_done(PrintStepEnum step) const { return m_state.is_done(step, this->state_mutex()); }
 	PrintStateBase::StateWithTimeStamp step_state_with_timestamp(PrintStepEnum step) const { return m_state.state_with_timestamp(step, this->state_mutex()); }
     PrintStateBase::StateWithWarnings  step_state_with_warnings(PrintStepEnum step) const { return m_state.state_with_warnings(step, this->state_mutex()); }
+    const PrintStepProfile&            step_profile(PrintStepEnum step) const { return m_step_profiles[step]; }
 
 protected:
-    bool            set_started(PrintStepEnum step) { return m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintStepEnum step) {
+        bool started = m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        if (started)
+            m_step_profiles[step].start();
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintStepEnum step) { 
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        m_step_profiles[step].stop(this->step_items(step));
         if (status.second)
             this->status_update_warnings(this->id(), static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -545,8 +588,12 @@ protected:
     		this->status_update_warnings(this->id(), static_cast<int>(active_step.first), warning_level, message);
     }
 
+    // Number of items produced by a step for its profile.
+    virtual size_t  step_items(PrintStepEnum /* step */) const { return 0; }
+
 private:
-    PrintState<PrintStepEnum, COUNT> m_state;
+    PrintState<PrintStepEnum, COUNT>        m_state;
+    std::array<PrintStepProfile, COUNT>     m_step_profiles;
 };
 
 template<typename PrintType, typename PrintObjectStepEnum, const size_t COUNT>
@@ -560,14 +607,20 @@ public:
     bool            is_step_done(PrintObjectStepEnum step) const { return m_state.is_done(step, PrintObjectBase::state_mutex(m_print)); }
     PrintStateBase::StateWithTimeStamp step_state_with_timestamp(PrintObjectStepEnum step) const { return m_state.state_with_timestamp(step, PrintObjectBase::state_mutex(m_print)); }
     PrintStateBase::StateWithWarnings  step_state_with_warnings(PrintObjectStepEnum step) const { return m_state.state_with_warnings(step, PrintObjectBase::state_mutex(m_print)); }
+    const PrintStepProfile&            step_profile(PrintObjectStepEnum step) const { return m_step_profiles[step]; }
 
 protected:
 	PrintObjectBaseWithState(PrintType *print, ModelObject *model_object) : PrintObjectBase(model_object), m_print(print) {}
 
-    bool            set_started(PrintObjectStepEnum step) 
-        { return m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintObjectStepEnum step) {
+        bool started = m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        if (started)
+            m_step_profiles[step].start();
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintObjectStepEnum step) { 
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        m_step_profiles[step].stop(this->step_items(step));
         if (status.second)
             this->status_update_warnings(m_print, static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -594,6 +647,9 @@ protected:
     		this->status_update_warnings(m_print, static_cast<int>(active_step.first), warning_level, message);
     }
 
+    // Number of items produced by a step for its profile.
+    virtual size_t  step_items(PrintObjectStepEnum /* step */) const { return 0; }
+
 protected:
     // If the background processing stop was requested, throw CanceledException.
     // To be called by the worker thread and its sub-threads (mostly launched on the TBB thread pool) regularly.
@@ -604,8 +660,45 @@ protected:
 
 private:
     PrintState<PrintObjectStepEnum, COUNT>   m_state;
+    std::array<PrintStepProfile, COUNT>      m_step_profiles;
 };
 
+// Append the profiles of all steps of a Print or PrintObject as a JSON array, step_names are indexed by the step.
+template<typename StepEnum, class PrintOrObject, size_t COUNT>
+void append_step_profiles_json(std::string &out, const PrintOrObject &print_or_object, const std::array<const char*, COUNT> &step_names)
+{
+    out += "[";
+    for (size_t i = 0; i < COUNT; ++ i) {
+        out += i == 0 ? "\n" : ",\n";
+        out += "      ";
+        print_or_object.step_profile(StepEnum(i)).append_json(out, step_names[i]);
+    }
+    out += " ]";
+}
+
+// JSON document of the step profiles of a Print and of its PrintObjects.
+template<typename PrintStepEnum, typename PrintObjectStepEnum, class PrintType, size_t PRINT_COUNT, size_t OBJECT_COUNT>
+std::string print_step_profiles_json(const PrintType &print, const char *technology,
+    const std::array<const char*, PRINT_COUNT> &print_step_names, const std::array<const char*, OBJECT_COUNT> &object_step_names)
+{
+    std::string out = "{\n  \"technology\": \"";
+    out += technology;
+    out += "\",\n  \"steps\": ";
+    append_step_profiles_json<PrintStepEnum>(out, print, print_step_names);
+    out += ",\n  \"objects\": [";
+    bool first = true;
+    for (const auto *object : print.objects()) {
+        out += first ? "\n    { \"name\": " : ",\n    { \"name\": ";
+        first = false;
+        PrintStepProfile::append_json_string(out, object->model_object()->name);
+        out += ", \"steps\": ";
+        append_step_profiles_json<PrintObjectStepEnum>(out, *object, object_step_names);
+        out += " }";
+    }
+    out += " ]\n}\n";
+    return out;
+}
+
 } // namespace Slic3r
 
 #endif /* slic3r_PrintBase_hpp_ */
@@ -6,7 +6,6 @@
 #include <unordered_set>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
-#include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/thread.hpp>
 #include <boost/nowide/iostream.hpp>
@@ -220,6 +219,25 @@ void PrintConfigDef::init_fff_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("arc_fitting", coBool);
+    def->label = L("Arc fitting");
+    def->category = OptionCategory::output;
+    def->tooltip = L("Replace the runs of short G1 segments approximating a circular arc by G2/G3 arc moves, "
+        "which makes the G-code files smaller and spares the firmware planner."
+        "\nThe firmware has to support the arc moves (ARC_SUPPORT for Marlin, [gcode_arcs] for Klipper). "
+        "It's not used with the MakerWare, Sailfish and Teacup flavors.");
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionBool(false));
+
+    def = this->add("arc_fitting_tolerance", coFloat);
+    def->label = L("Arc fitting tolerance");
+    def->category = OptionCategory::output;
+    def->tooltip = L("Maximum distance between the points of an extrusion and the arc replacing them.");
+    def->sidetext = L("mm");
+    def->min = 0;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionFloat(0.02));
+
     def = this->add("avoid_crossing_perimeters", coBool);
     def->label = L("Avoid crossing perimeters");
     def->category = OptionCategory::perimeter;
@@ -2033,6 +2051,25 @@ void PrintConfigDef::init_fff_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionBool(0));
 
+    def = this->add("gcode_compression", coBool);
+    def->label = L("Compressed G-code");
+    def->category = OptionCategory::output;
+    def->tooltip = L("Store the exported G-code compressed by blocks, with an index of its layers, its thumbnails and its statistics, "
+        "after the post-processing scripts have run. The file is much smaller and is read faster by the G-code viewer, "
+        "but the printers and the print hosts can't read it: the G-code uploaded to a print host is never compressed.");
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionBool(false));
+
+    def = this->add("gcode_export_pipelined", coBool);
+    def->label = L("Pipelined G-code export");
+    def->category = OptionCategory::output;
+    def->tooltip = L("Generate the G-code of the next layer while the cooling, pressure equalizer and fan post-processing "
+        "of the previous layers are still running in other threads. The output is identical to the single-threaded export."
+        "\nIt's not used when a wipe tower or milling is used, or when more than one extruder is printing, as these "
+        "interleave the tool state between the layer generation and the post-processing.");
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("gcode_filename_illegal_char", coString);
     def->label = L("Illegal characters");
     def->full_label = L("Illegal characters for filename");
@@ -2572,13 +2609,13 @@ void PrintConfigDef::init_fff_params()
             std::string axis_upper = boost::to_upper_copy<std::string>(axis.name);
             // Add the machine feedrate limits for XYZE axes. (M203)
             def = this->add("machine_max_feedrate_" + axis.name, coFloats);
-            def->full_label = (boost::format("Maximum feedrate %1%") % axis_upper).str();
+            def->full_label = "Maximum feedrate " + axis_upper;
             (void)L("Maximum feedrate X");
             (void)L("Maximum feedrate Y");
             (void)L("Maximum feedrate Z");
             (void)L("Maximum feedrate E");
             def->category = OptionCategory::limits;
-            def->tooltip  = (boost::format("Maximum feedrate of the %1% axis") % axis_upper).str();
+            def->tooltip  = "Maximum feedrate of the " + axis_upper + " axis";
             (void)L("Maximum feedrate of the X axis");
             (void)L("Maximum feedrate of the Y axis");
             (void)L("Maximum feedrate of the Z axis");
@@ -2589,13 +2626,13 @@ void PrintConfigDef::init_fff_params()
             def->set_default_value(new ConfigOptionFloats(axis.max_feedrate));
             // Add the machine acceleration limits for XYZE axes (M201)
             def = this->add("machine_max_acceleration_" + axis.name, coFloats);
-            def->full_label = (boost::format("Maximum acceleration %1%") % axis_upper).str();
+            def->full_label = "Maximum acceleration " + axis_upper;
             (void)L("Maximum acceleration X");
             (void)L("Maximum acceleration Y");
             (void)L("Maximum acceleration Z");
             (void)L("Maximum acceleration E");
             def->category = OptionCategory::limits;
-            def->tooltip  = (boost::format("Maximum acceleration of the %1% axis") % axis_upper).str();
+            def->tooltip  = "Maximum acceleration of the " + axis_upper + " axis";
             (void)L("Maximum acceleration of the X axis");
             (void)L("Maximum acceleration of the Y axis");
             (void)L("Maximum acceleration of the Z axis");
@@ -2606,13 +2643,13 @@ void PrintConfigDef::init_fff_params()
             def->set_default_value(new ConfigOptionFloats(axis.max_acceleration));
             // Add the machine jerk limits for XYZE axes (M205)
             def = this->add("machine_max_jerk_" + axis.name, coFloats);
-            def->full_label = (boost::format("Maximum jerk %1%") % axis_upper).str();
+            def->full_label = "Maximum jerk " + axis_upper;
             (void)L("Maximum jerk X");
             (void)L("Maximum jerk Y");
             (void)L("Maximum jerk Z");
             (void)L("Maximum jerk E");
             def->category = OptionCategory::limits;
-            def->tooltip  = (boost::format("Maximum jerk of the %1% axis") % axis_upper).str();
+            def->tooltip  = "Maximum jerk of the " + axis_upper + " axis";
             (void)L("Maximum jerk of the X axis");
             (void)L("Maximum jerk of the Y axis");
             (void)L("Maximum jerk of the Z axis");
@@ -2753,7 +2790,6 @@ void PrintConfigDef::init_fff_params()
     def->sidetext = L("mm³/s²");
     def->min = 0;
     def->mode = comExpert;
-    def->set_default_value(new ConfigOptionFloat(0);
     def->set_default_value(new ConfigOptionFloat(0));
 
     def = this->add("max_volumetric_extrusion_rate_slope_negative", coFloat);
@@ -2765,7 +2801,6 @@ void PrintConfigDef::init_fff_params()
     def->sidetext = L("mm³/s²");
     def->min = 0;
     def->mode = comExpert;
-    def->set_default_value(new ConfigOptionFloat(0);
     def->set_default_value(new ConfigOptionFloat(0));
 #endif /* HAS_PRESSURE_EQUALIZER */
 
@@ -4016,6 +4051,22 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionEnum<SupportMaterialPattern>(smpRectilinear));
 
+    def = this->add("support_material_style", coEnum);
+    def->label = L("Style");
+    def->full_label = L("Support style");
+    def->category = OptionCategory::support;
+    def->tooltip = L("Style and shape of the support towers."
+                   "\nGrid: the contact areas are projected down to the bed or the object and stretched into a regular grid."
+                   "\nTree: thin branches grow from the contact areas and merge on the way down, avoiding the object. "
+                   "Uses much less material on organic shapes, the contact areas themselves are unchanged.");
+    def->enum_keys_map = &ConfigOptionEnum<SupportMaterialStyle>::get_enum_values();
+    def->enum_values.push_back("grid");
+    def->enum_values.push_back("tree");
+    def->enum_labels.push_back(L("Grid"));
+    def->enum_labels.push_back(L("Tree"));
+    def->mode = comAdvanced;
+    def->set_default_value(new ConfigOptionEnum<SupportMaterialStyle>(smsGrid));
+
     def = this->add("support_material_interface_pattern", coEnum);
     def->label = L("Pattern");
     def->full_label = L("Support interface pattern");
@@ -4306,6 +4357,17 @@ void PrintConfigDef::init_fff_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionFloatOrPercent(1500, false));
 
+    def = this->add("travel_planning_lookahead", coInt);
+    def->label = L("Travel planning lookahead");
+    def->category = OptionCategory::output;
+    def->tooltip = L("Plan the order of the objects printed on each layer over this number of layers, to shorten the travels between the objects "
+        "and from the last object of a layer to the first object of the next layer. The islands of an object are visited by the closest one. "
+        "Set zero to print the objects in the same order on each layer and the islands in their slicing order.");
+    def->sidetext = L("layers");
+    def->min = 0;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionInt(0));
+
     def = this->add("travel_speed", coFloat);
     def->label = L("Travel");
     def->full_label = L("Travel speed");
@@ -4958,6 +5020,14 @@ void PrintConfigDef::init_sla_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionFloat(1.0));
 
+    def = this->add("fast_png_encoding", coBool);
+    def->label = L("Fast PNG encoding");
+    def->full_label = L("Fast PNG encoding of the layers");
+    def->tooltip  = L("Encode the layer images with a simpler compression, which is much faster "
+                      "for the mostly flat layer images but produces slightly larger archives.");
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionBool(false));
+
 
     // SLA Material settings.
     def = this->add("material_type", coString);
@@ -5762,6 +5832,7 @@ std::unordered_set<std::string> prusa_export_to_remove_keys = {
 "support_material_contact_distance_type",
 "support_material_interface_pattern",
 "support_material_solid_first_layer",
+"support_material_style",
 "thin_perimeters_all",
 "thin_perimeters",
 "thin_walls_merge",
@@ -5777,6 +5848,7 @@ std::unordered_set<std::string> prusa_export_to_remove_keys = {
 "top_fan_speed",
 "top_infill_extrusion_spacing",
 "travel_acceleration",
+"travel_planning_lookahead",
 "travel_speed_z",
 "wipe_advanced_algo",
 "wipe_advanced_multiplier",
@@ -6647,6 +6719,13 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->cli = "gcodeviewer";
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("server", coBool);
+    def->label = L("Server mode");
+    def->tooltip = L("Keep running and process the jobs read from the standard input, one job per line. "
+                     "Each line contains the command line arguments of a job, for example \"--export-gcode --load config.ini -o out.gcode model.stl\". "
+                     "The completion of each job is reported by the line \"done <exit code>\" written to the standard output.");
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("slice", coBool);
     def->label = L("Slice");
     def->tooltip = L("Slice the model as FFF or SLA based on the printer_technology configuration value.");
@@ -6819,12 +6898,46 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->label = L("Data directory");
     def->tooltip = L("Load and store settings at the given directory. This is useful for maintaining different profiles or including configurations from a network storage.");
 
+    def = this->add("batch_jobs", coInt);
+    def->label = L("Batch jobs");
+    def->tooltip = L("Slice up to this number of the input files at once, each into its own output file named by --output. "
+                     "The jobs share the thread pool, thus the small jobs keep all the cores busy.");
+    def->min = 1;
+    def->set_default_value(new ConfigOptionInt(1));
+
     def = this->add("loglevel", coInt);
     def->label = L("Logging level");
     def->tooltip = L("Sets logging sensitivity. 0:fatal, 1:error, 2:warning, 3:info, 4:debug, 5:trace\n"
                      "For example. loglevel=2 logs fatal, error and warning level messages.");
     def->min = 0;
 
+    def = this->add("step_profile", coString);
+    def->label = L("Step profile file");
+    def->tooltip = L("After slicing, write the wall time, CPU time, peak memory growth and number of produced items "
+                     "of each slicing step of the print and of its objects to the specified file in JSON format.");
+
+    def = this->add("release_intermediates", coBool);
+    def->label = L("Release intermediate slicing data");
+    def->tooltip = L("Release the data of the layers, which are not needed by the G-code export, as soon as an object is sliced. "
+                     "This lowers the peak memory of slicing large or many objects.");
+
+    def = this->add("slices_cache", coString);
+    def->label = L("Slices cache directory");
+    def->tooltip = L("Store the slices and the perimeters of the objects into the specified directory and load them from there "
+                     "when an object is sliced again with the same settings. The directory may be shared by several machines.");
+
+    def = this->add("slices_cache_worker", coString);
+    def->label = L("Slices cache worker");
+    def->tooltip = L("Distribute the slicing of a large job over several machines. With the value index/count (for example 0/4), "
+                     "only slice and generate the perimeters of the share of the objects of the worker index out of count workers "
+                     "into the --slices-cache directory, without exporting G-code. Once all the workers finished, run the same job "
+                     "without this option to export the G-code from the cached objects.");
+
+    def = this->add("trace", coString);
+    def->label = L("Trace file");
+    def->tooltip = L("Record the time spent by all threads in the stages of slicing and G-code export and write the timeline "
+                     "to the specified file in the Chrome trace format, to be opened with chrome://tracing or ui.perfetto.dev.");
+
 #if (defined(_MSC_VER) || defined(__MINGW32__)) && defined(SLIC3R_GUI)
     def = this->add("sw_renderer", coBool);
     def->label = L("Render with a software renderer");
@@ -31,7 +31,7 @@
 #include "libslic3r.h"
 #include "Config.hpp"
 
-// #define HAS_PRESSURE_EQUALIZER
+#define HAS_PRESSURE_EQUALIZER
 
 namespace Slic3r {
 
@@ -109,6 +109,10 @@ enum SupportMaterialPattern {
     smpRectilinear, smpRectilinearGrid, smpHoneycomb,
 };
 
+enum SupportMaterialStyle {
+    smsGrid, smsTree,
+};
+
 enum SeamPosition {
     spRandom, spNearest, spAligned, spRear, spCustom, spCost
 };
@@ -291,6 +295,14 @@ template<> inline const t_config_enum_values& ConfigOptionEnum<SupportMaterialPa
     return keys_map;
 }
 
+template<> inline const t_config_enum_values& ConfigOptionEnum<SupportMaterialStyle>::get_enum_values() {
+    static t_config_enum_values keys_map{
+        {"grid", smsGrid},
+        {"tree", smsTree},
+    };
+    return keys_map;
+}
+
 template<> inline const t_config_enum_values& ConfigOptionEnum<SeamPosition>::get_enum_values() {
     static t_config_enum_values keys_map{
         {"random", spRandom},
@@ -673,6 +685,7 @@ public:
     ConfigOptionFloat               support_material_spacing;
     ConfigOptionFloat               support_material_speed;
     ConfigOptionBool                support_material_solid_first_layer;
+    ConfigOptionEnum<SupportMaterialStyle> support_material_style;
     ConfigOptionBool                support_material_synchronize_layers;
     // Overhang angle threshold.
     ConfigOptionInt                 support_material_threshold;
@@ -737,6 +750,7 @@ protected:
         OPT_PTR(support_material_spacing);
         OPT_PTR(support_material_speed);
         OPT_PTR(support_material_solid_first_layer);
+        OPT_PTR(support_material_style);
         OPT_PTR(support_material_synchronize_layers);
         OPT_PTR(support_material_xy_spacing);
         OPT_PTR(support_material_threshold);
@@ -1043,6 +1057,8 @@ class GCodeConfig : public StaticPrintConfig
 {
     STATIC_PRINT_CONFIG_CACHE(GCodeConfig)
 public:
+    ConfigOptionBool                arc_fitting;
+    ConfigOptionFloat               arc_fitting_tolerance;
     ConfigOptionString              before_layer_gcode;
     ConfigOptionString              between_objects_gcode;
     ConfigOptionFloats              deretract_speed;
@@ -1090,6 +1106,8 @@ public:
     ConfigOptionFloats              filament_cooling_final_speed;
     ConfigOptionStrings             filament_ramming_parameters;
     ConfigOptionBool                gcode_comments;
+    ConfigOptionBool                gcode_compression;
+    ConfigOptionBool                gcode_export_pipelined;
     ConfigOptionString              gcode_filename_illegal_char;
     ConfigOptionEnum<GCodeFlavor>   gcode_flavor;
     ConfigOptionBool                gcode_label_objects;
@@ -1159,6 +1177,8 @@ public:
 protected:
     void initialize(StaticCacheBase &cache, const char *base_ptr)
     {
+        OPT_PTR(arc_fitting);
+        OPT_PTR(arc_fitting_tolerance);
         OPT_PTR(before_layer_gcode);
         OPT_PTR(between_objects_gcode);
         OPT_PTR(deretract_speed);
@@ -1206,6 +1226,8 @@ protected:
         OPT_PTR(filament_cooling_final_speed);
         OPT_PTR(filament_ramming_parameters);
         OPT_PTR(gcode_comments);
+        OPT_PTR(gcode_compression);
+        OPT_PTR(gcode_export_pipelined);
         OPT_PTR(gcode_filename_illegal_char);
         OPT_PTR(gcode_flavor);
         OPT_PTR(gcode_label_objects);
@@ -1358,6 +1380,7 @@ public:
     ConfigOptionPercent             time_estimation_compensation;
     ConfigOptionInts                top_fan_speed;
     ConfigOptionFloatOrPercent      travel_acceleration;
+    ConfigOptionInt                 travel_planning_lookahead;
     ConfigOptionBools               wipe;
     ConfigOptionBool                wipe_tower;
     ConfigOptionFloatOrPercent      wipe_tower_brim;
@@ -1459,6 +1482,7 @@ protected:
         OPT_PTR(time_estimation_compensation);
         OPT_PTR(top_fan_speed);
         OPT_PTR(travel_acceleration);
+        OPT_PTR(travel_planning_lookahead);
         OPT_PTR(wipe);
         OPT_PTR(wipe_tower);
         OPT_PTR(wipe_tower_brim);
@@ -1745,6 +1769,7 @@ public:
     ConfigOptionFloat                       first_layer_size_compensation;
     ConfigOptionFloat                       elephant_foot_min_width;
     ConfigOptionFloat                       gamma_correction;
+    ConfigOptionBool                        fast_png_encoding;
     ConfigOptionFloat                       fast_tilt_time;
     ConfigOptionFloat                       slow_tilt_time;
     ConfigOptionFloat                       area_fill;
@@ -1776,6 +1801,7 @@ protected:
         OPT_PTR(first_layer_size_compensation);
         OPT_PTR(elephant_foot_min_width);
         OPT_PTR(gamma_correction);
+        OPT_PTR(fast_png_encoding);
         OPT_PTR(fast_tilt_time);
         OPT_PTR(slow_tilt_time);
         OPT_PTR(area_fill);
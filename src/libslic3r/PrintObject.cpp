@@ -9,16 +9,24 @@
 #include "SupportMaterial.hpp"
 #include "Surface.hpp"
 #include "Slicing.hpp"
+#include "SlicesCache.hpp"
 #include "Tesselate.hpp"
+#include "Tracing.hpp"
 #include "Utils.hpp"
 #include "Fill/FillAdaptive.hpp"
 #include "Format/STL.hpp"
 
+#include <future>
+#include <numeric>
 #include <utility>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 #include <float.h>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/task_arena.h>
 #include <tbb/atomic.h>
 
 #include <Shiny/Shiny.h>
@@ -116,6 +124,13 @@ namespace Slic3r {
         std::vector<coordf_t> layer_height_profile;
         this->update_layer_height_profile(*this->model_object(), m_slicing_params, layer_height_profile);
         m_print->throw_if_canceled();
+        // Toggling a slicing option back and forth produces the same slices, don't slice again in that case.
+        const uint64_t cache_key = this->slices_cache_key(layer_height_profile);
+        m_slices_cache_key = cache_key;
+        if (this->restore_slices_from_cache(cache_key)) {
+            this->set_done(posSlice);
+            return;
+        }
         this->_slice(layer_height_profile);
         m_print->throw_if_canceled();
         // Fix the model.
@@ -147,9 +162,188 @@ namespace Slic3r {
         });
         if (m_layers.empty())
             throw Slic3r::SlicingError("No layers were detected. You might want to repair your STL file(s) or check their size or thickness and retry.\n");
+        this->store_slices_to_cache(cache_key);
         this->set_done(posSlice);
     }
 
+    uint64_t PrintObject::slices_cache_key(const std::vector<coordf_t>& layer_height_profile) const
+    {
+        size_t seed = 0;
+        auto hash_matrix = [&seed](const Transform3d& m) {
+            for (size_t i = 0; i < 16; ++i)
+                boost::hash_combine(seed, m.data()[i]);
+        };
+        auto hash_config = [&seed](const ConfigBase& config, const t_config_option_keys& keys) {
+            for (const t_config_option_key& key : keys)
+                if (const ConfigOption* opt = config.option(key); opt != nullptr) {
+                    boost::hash_combine(seed, key);
+                    boost::hash_combine(seed, opt->serialize());
+                }
+        };
+
+        // Geometry: the layers, the placement of the object and the meshes of the volumes assigned to the regions.
+        boost::hash_range(seed, layer_height_profile.begin(), layer_height_profile.end());
+        boost::hash_combine(seed, m_slicing_params.object_print_z_min);
+        boost::hash_combine(seed, m_slicing_params.raft_layers());
+        hash_matrix(m_trafo);
+        boost::hash_combine(seed, m_center_offset.x());
+        boost::hash_combine(seed, m_center_offset.y());
+        for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
+            boost::hash_combine(seed, region_id);
+            for (const std::pair<t_layer_height_range, int>& volume_and_range : this->region_volumes[region_id]) {
+                const ModelVolume& volume = *this->model_object()->volumes[volume_and_range.second];
+                boost::hash_combine(seed, volume_and_range.first.first);
+                boost::hash_combine(seed, volume_and_range.first.second);
+                boost::hash_combine(seed, volume_and_range.second);
+                boost::hash_combine(seed, int(volume.type()));
+                hash_matrix(volume.get_matrix());
+                const indexed_triangle_set& its = volume.mesh().its;
+                for (const stl_vertex& v : its.vertices)
+                    boost::hash_range(seed, v.data(), v.data() + 3);
+                for (const stl_triangle_vertex_indices& f : its.indices)
+                    boost::hash_range(seed, f.data(), f.data() + 3);
+            }
+            // The region options are read all over _slice() (curve smoothing, hole compensation, extruders for the shrinkage...),
+            // not only those invalidating posSlice, thus the complete region config is part of the key.
+            if (!this->region_volumes[region_id].empty()) {
+                const PrintRegionConfig& region_config = this->print()->regions()[region_id]->config();
+                hash_config(region_config, region_config.keys());
+            }
+        }
+
+        // Configuration: the object config and the print options invalidating posSlice in Print::invalidate_state_by_config_options().
+        hash_config(m_config, m_config.keys());
+        hash_config(m_print->config(), { "nozzle_diameter", "resolution", "filament_shrink", "spiral_vase", "z_step" });
+        return uint64_t(seed);
+    }
+
+    bool PrintObject::restore_slices_from_cache(uint64_t key)
+    {
+        SlicesCache::EntryPtr entry = SlicesCache::instance().find(key);
+        if (!entry || entry->layers.empty())
+            return false;
+        // The entry may come from disk, check it matches the current set of regions before touching the layers.
+        for (const SlicesCache::Layer& cached : entry->layers)
+            if (cached.region_slices.size() != this->region_volumes.size())
+                return false;
+
+        BOOST_LOG_TRIVIAL(info) << "Slicing objects - restoring " << entry->layers.size() << " layers from the slices cache";
+        m_typed_slices = false;
+        this->clear_layers();
+        Layer* prev = nullptr;
+        for (const SlicesCache::Layer& cached : entry->layers) {
+            Layer* layer = this->add_layer(int(cached.id), cached.height, cached.print_z, cached.slice_z);
+            if (prev != nullptr) {
+                prev->upper_layer = layer;
+                layer->lower_layer = prev;
+            }
+            for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id)
+                layer->add_region(this->print()->regions()[region_id])->m_slices.surfaces = cached.region_slices[region_id];
+            layer->slicing_errors = cached.slicing_errors;
+            layer->lslices = cached.lslices;
+            layer->lslices_bboxes.reserve(layer->lslices.size());
+            for (const ExPolygon& expoly : layer->lslices)
+                layer->lslices_bboxes.emplace_back(get_extents(expoly));
+            layer->backup_untyped_slices();
+            prev = layer;
+        }
+        return true;
+    }
+
+    void PrintObject::store_slices_to_cache(uint64_t key) const
+    {
+        auto entry = std::make_shared<SlicesCache::Entry>();
+        entry->layers.reserve(m_layers.size());
+        for (const Layer* layer : m_layers) {
+            SlicesCache::Layer cached;
+            cached.id             = layer->id();
+            cached.height         = layer->height;
+            cached.print_z        = layer->print_z;
+            cached.slice_z        = layer->slice_z;
+            cached.slicing_errors = layer->slicing_errors;
+            cached.lslices        = layer->lslices;
+            cached.region_slices.reserve(layer->regions().size());
+            for (const LayerRegion* layerm : layer->regions())
+                cached.region_slices.emplace_back(layerm->slices().surfaces);
+            entry->layers.emplace_back(std::move(cached));
+        }
+        SlicesCache::instance().insert(key, std::move(entry));
+    }
+
+    uint64_t PrintObject::perimeters_cache_key() const
+    {
+        size_t seed = size_t(m_slices_cache_key);
+        // Tag the key, so that it never collides with the key of the slices.
+        boost::hash_combine(seed, std::string("perimeters"));
+        // The perimeter generator reads the print options all over (flows, gap fill, overhangs, thin walls...),
+        // thus the complete print config is part of the key. The object and region configs are already part of the slices key.
+        const PrintConfig& print_config = m_print->config();
+        for (const t_config_option_key& key : print_config.keys())
+            if (const ConfigOption* opt = print_config.option(key); opt != nullptr) {
+                boost::hash_combine(seed, key);
+                boost::hash_combine(seed, opt->serialize());
+            }
+        return uint64_t(seed);
+    }
+
+    bool PrintObject::restore_perimeters_from_cache(uint64_t key)
+    {
+        SlicesCache::EntryPtr entry = SlicesCache::instance().find(key);
+        if (!entry || entry->layers.size() != m_layers.size())
+            return false;
+        // The entry may come from disk, check it matches the current layers before touching them.
+        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++layer_idx) {
+            const SlicesCache::Layer& cached = entry->layers[layer_idx];
+            if (cached.id != m_layers[layer_idx]->id() || cached.region_perimeters.size() != m_layers[layer_idx]->m_regions.size())
+                return false;
+        }
+
+        BOOST_LOG_TRIVIAL(info) << "Generating perimeters - restoring " << entry->layers.size() << " layers from the slices cache";
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &entry](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                m_print->throw_if_canceled();
+                const SlicesCache::Layer& cached = entry->layers[layer_idx];
+                for (size_t region_id = 0; region_id < cached.region_perimeters.size(); ++region_id) {
+                    const SlicesCache::RegionPerimeters& src = cached.region_perimeters[region_id];
+                    LayerRegion& layerm = *m_layers[layer_idx]->m_regions[region_id];
+                    layerm.m_slices.surfaces          = src.slices;
+                    layerm.fill_surfaces.surfaces     = src.fill_surfaces;
+                    layerm.fill_expolygons            = src.fill_expolygons;
+                    layerm.fill_no_overlap_expolygons = src.fill_no_overlap_expolygons;
+                    layerm.perimeters                 = src.perimeters;
+                    layerm.thin_fills                 = src.thin_fills;
+                }
+            }
+        });
+        m_print->throw_if_canceled();
+        return true;
+    }
+
+    void PrintObject::store_perimeters_to_cache(uint64_t key) const
+    {
+        auto entry = std::make_shared<SlicesCache::Entry>();
+        entry->layers.assign(m_layers.size(), SlicesCache::Layer());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &entry](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                const Layer* layer = m_layers[layer_idx];
+                SlicesCache::Layer& cached = entry->layers[layer_idx];
+                cached.id      = layer->id();
+                cached.height  = layer->height;
+                cached.print_z = layer->print_z;
+                cached.slice_z = layer->slice_z;
+                cached.region_perimeters.reserve(layer->regions().size());
+                for (const LayerRegion* layerm : layer->regions())
+                    cached.region_perimeters.push_back({ layerm->slices().surfaces, layerm->fill_surfaces.surfaces, layerm->fill_expolygons,
+                        layerm->fill_no_overlap_expolygons, layerm->perimeters, layerm->thin_fills });
+            }
+        });
+        SlicesCache::instance().insert(key, std::move(entry));
+    }
+
 
 
     Polygons create_polyholes(const Point center, const coord_t radius, const coord_t nozzle_diameter, bool multiple)
@@ -228,31 +422,73 @@ namespace Slic3r {
         //sort holes per center-diameter
         std::map<std::tuple<Point, float, int, coord_t, bool>, std::vector<std::pair<Polygon*, int>>> id2layerz2hole;
 
+        // Hash the hole centers of each layer into a grid, so that the matching hole of the next layer is found
+        // without scanning all the holes of that layer. The cells are as big as the largest allowed variation,
+        // thus a matching center is always found in the 3x3 cells around the searched center.
+        coord_t cell_size = 1;
+        for (const auto& layer_holes : layerid2center)
+            for (const auto& hole : layer_holes)
+                cell_size = std::max(cell_size, std::get<3>(hole.first));
+        auto cell_of = [cell_size](const Point& pt) -> std::pair<int64_t, int64_t> {
+            return { int64_t(std::floor(double(pt.x()) / cell_size)), int64_t(std::floor(double(pt.y()) / cell_size)) };
+        };
+        auto cell_key = [](int64_t cx, int64_t cy) -> uint64_t { return (uint64_t(uint32_t(cx)) << 32) | uint64_t(uint32_t(cy)); };
+        std::vector<std::unordered_map<uint64_t, std::vector<size_t>>> layerid2grid(layerid2center.size());
+        // Holes already attached to a hole of a lower layer.
+        std::vector<std::vector<bool>> layerid2used(layerid2center.size());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, layerid2center.size()),
+            [&layerid2center, &layerid2grid, &layerid2used, &cell_of, &cell_key](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                layerid2used[layer_idx].assign(layerid2center[layer_idx].size(), false);
+                for (size_t hole_idx = 0; hole_idx < layerid2center[layer_idx].size(); ++hole_idx) {
+                    std::pair<int64_t, int64_t> cell = cell_of(std::get<0>(layerid2center[layer_idx][hole_idx].first));
+                    layerid2grid[layer_idx][cell_key(cell.first, cell.second)].push_back(hole_idx);
+                }
+            }
+        });
+
         //search & find hole that span at least X layers
         const size_t min_nb_layers = 2;
         float max_layer_height = config().layer_height * 2;
         for (size_t layer_idx = 0; layer_idx < this->m_layers.size(); ++layer_idx) {
             for (size_t hole_idx = 0; hole_idx < layerid2center[layer_idx].size(); ++hole_idx) {
+                if (layerid2used[layer_idx][hole_idx])
+                    continue;
                 //get all other same polygons
                 std::tuple<Point, float, int, coord_t, bool>& id = layerid2center[layer_idx][hole_idx].first;
+                std::pair<int64_t, int64_t> id_cell = cell_of(std::get<0>(id));
                 float max_z = layers()[layer_idx]->print_z;
                 std::vector<std::pair<Polygon*, int>> holes;
                 holes.emplace_back(layerid2center[layer_idx][hole_idx].second, layer_idx);
                 for (size_t search_layer_idx = layer_idx + 1; search_layer_idx < this->m_layers.size(); ++search_layer_idx) {
                     if (layers()[search_layer_idx]->print_z - layers()[search_layer_idx]->height - max_z > EPSILON) break;
-                    //search an other polygon with same id
-                    for (size_t search_hole_idx = 0; search_hole_idx < layerid2center[search_layer_idx].size(); ++search_hole_idx) {
-                        std::tuple<Point, float, int, coord_t, bool>& search_id = layerid2center[search_layer_idx][search_hole_idx].first;
-                        if (std::get<2>(id) == std::get<2>(search_id)
-                            && std::get<0>(id).distance_to(std::get<0>(search_id)) < std::get<3>(id)
-                            && std::abs(std::get<1>(id) - std::get<1>(search_id)) < std::get<3>(id)
-                            ) {
-                            max_z = layers()[search_layer_idx]->print_z;
-                            holes.emplace_back(layerid2center[search_layer_idx][search_hole_idx].second, search_layer_idx);
-                            layerid2center[search_layer_idx].erase(layerid2center[search_layer_idx].begin() + search_hole_idx);
-                            search_hole_idx--;
-                            break;
+                    //search an other polygon with same id, the first one in the order of the layer holes
+                    size_t found_idx = size_t(-1);
+                    for (int64_t cx = id_cell.first - 1; cx <= id_cell.first + 1; ++cx)
+                        for (int64_t cy = id_cell.second - 1; cy <= id_cell.second + 1; ++cy) {
+                            auto it_cell = layerid2grid[search_layer_idx].find(cell_key(cx, cy));
+                            if (it_cell == layerid2grid[search_layer_idx].end())
+                                continue;
+                            for (size_t search_hole_idx : it_cell->second) {
+                                if (search_hole_idx >= found_idx)
+                                    break;
+                                if (layerid2used[search_layer_idx][search_hole_idx])
+                                    continue;
+                                std::tuple<Point, float, int, coord_t, bool>& search_id = layerid2center[search_layer_idx][search_hole_idx].first;
+                                if (std::get<2>(id) == std::get<2>(search_id)
+                                    && std::get<0>(id).distance_to(std::get<0>(search_id)) < std::get<3>(id)
+                                    && std::abs(std::get<1>(id) - std::get<1>(search_id)) < std::get<3>(id)
+                                    ) {
+                                    found_idx = search_hole_idx;
+                                    break;
+                                }
+                            }
                         }
+                    if (found_idx != size_t(-1)) {
+                        max_z = layers()[search_layer_idx]->print_z;
+                        holes.emplace_back(layerid2center[search_layer_idx][found_idx].second, search_layer_idx);
+                        layerid2used[search_layer_idx][found_idx] = true;
                     }
                 }
                 //check if strait hole or first layer hole (cause of first layer compensation)
@@ -262,16 +498,32 @@ namespace Slic3r {
             }
         }
         //create a polyhole per id and replace holes points by it.
+        // Index the holes of layer->lslices by their points, as they are searched by their original points.
+        auto hash_points = [](const Points& pts) {
+            size_t seed = pts.size();
+            for (const Point& pt : pts) {
+                boost::hash_combine(seed, pt.x());
+                boost::hash_combine(seed, pt.y());
+            }
+            return seed;
+        };
+        std::vector<std::unordered_multimap<size_t, Polygon*>> layerid2lslices_holes(m_layers.size());
+        for (const auto& entry : id2layerz2hole)
+            for (const auto& poly_to_replace : entry.second)
+                if (layerid2lslices_holes[poly_to_replace.second].empty())
+                    for (ExPolygon& explo_slice : m_layers[poly_to_replace.second]->lslices)
+                        for (Polygon& poly_slice : explo_slice.holes)
+                            layerid2lslices_holes[poly_to_replace.second].emplace(hash_points(poly_slice.points), &poly_slice);
         for (auto entry : id2layerz2hole) {
             Polygons polyholes = create_polyholes(std::get<0>(entry.first), std::get<1>(entry.first), scale_(print()->config().nozzle_diameter.get_at(std::get<2>(entry.first) - 1)), std::get<4>(entry.first));
             for (auto& poly_to_replace : entry.second) {
                 Polygon polyhole = polyholes[poly_to_replace.second % polyholes.size()];
                 //search the clone in layers->slices
-                for (ExPolygon& explo_slice : m_layers[poly_to_replace.second]->lslices) {
-                    for (Polygon& poly_slice : explo_slice.holes) {
-                        if (poly_slice.points == poly_to_replace.first->points) {
-                            poly_slice.points = polyhole.points;
-                        }
+                auto range = layerid2lslices_holes[poly_to_replace.second].equal_range(hash_points(poly_to_replace.first->points));
+                for (auto it = range.first; it != range.second; ++it) {
+                    Polygon& poly_slice = *it->second;
+                    if (poly_slice.points == poly_to_replace.first->points) {
+                        poly_slice.points = polyhole.points;
                     }
                 }
                 // copy
@@ -291,6 +543,7 @@ namespace Slic3r {
         if (!this->set_started(posPerimeters))
             return;
 
+        SLIC3R_TRACE_ZONE("PrintObject::make_perimeters");
         m_print->set_status(20, L("Generating perimeters"));
         BOOST_LOG_TRIVIAL(info) << "Generating perimeters..." << log_memory_info();
 
@@ -303,6 +556,14 @@ namespace Slic3r {
             m_typed_slices = false;
         }
 
+        // The milling post-process is not part of the cache entries.
+        const bool use_cache = print()->config().milling_diameter.empty();
+        const uint64_t cache_key = use_cache ? this->perimeters_cache_key() : 0;
+        if (use_cache && this->restore_perimeters_from_cache(cache_key)) {
+            this->set_done(posPerimeters);
+            return;
+        }
+
         // atomic counter for gui progress
         std::atomic<int> atomic_count{ 0 };
         int nb_layers_update = std::max(1, (int)m_layers.size() / 20);
@@ -378,11 +639,49 @@ namespace Slic3r {
             BOOST_LOG_TRIVIAL(debug) << "Generating extra perimeters for region " << region_id << " in parallel - end";
         }
 
+        // Prismatic parts have long runs of layers with the same slices. A layer with the same slices, the same slices below and above
+        // and the same height as the layer below gets the same perimeters, thus only the first layer of such a run is processed,
+        // the perimeters of the other ones are copied from it.
+        // With some options the odd layers get different perimeters than the even ones, then a layer is compared with the layer two below.
+        // The vase mode switches on at a height, it is not worth the trouble.
+        std::vector<size_t> perimeters_source(m_layers.size());
+        std::iota(perimeters_source.begin(), perimeters_source.end(), 0);
+        if (! m_print->config().spiral_vase) {
+            size_t stride = 1;
+            for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id)
+                if (! this->region_volumes[region_id].empty()) {
+                    const PrintRegionConfig& region_config = m_print->regions()[region_id]->config();
+                    if (region_config.extra_perimeters_odd_layers || region_config.overhangs_reverse)
+                        stride = 2;
+                }
+            std::vector<unsigned char> same_as_below(m_layers.size(), false);
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(stride, m_layers.size()),
+                [this, stride, &same_as_below](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                    m_print->throw_if_canceled();
+                    same_as_below[layer_idx] = m_layers[layer_idx]->has_same_perimeter_inputs(*m_layers[layer_idx - stride]);
+                }
+            });
+            for (size_t layer_idx = stride; layer_idx < m_layers.size(); ++layer_idx)
+                if (same_as_below[layer_idx])
+                    perimeters_source[layer_idx] = perimeters_source[layer_idx - stride];
+        }
+        std::vector<size_t> layers_to_process;
+        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++layer_idx)
+            if (perimeters_source[layer_idx] == layer_idx)
+                layers_to_process.emplace_back(layer_idx);
+        // The copied layers are accounted for the progress upfront.
+        atomic_count = int(m_layers.size() - layers_to_process.size());
+        if (layers_to_process.size() < m_layers.size())
+            BOOST_LOG_TRIVIAL(debug) << "Generating perimeters - reusing the perimeters of " << m_layers.size() - layers_to_process.size() << " layers with the same slices";
+
         BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this, &atomic_count, &last_update, nb_layers_update](const tbb::blocked_range<size_t>& range) {
-            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            tbb::blocked_range<size_t>(0, layers_to_process.size()),
+            [this, &layers_to_process, &atomic_count, &last_update, nb_layers_update](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                const size_t layer_idx = layers_to_process[i];
                 std::chrono::time_point<std::chrono::system_clock> start_make_perimeter = std::chrono::system_clock::now();
                 m_print->throw_if_canceled();
                 m_layers[layer_idx]->make_perimeters();
@@ -401,7 +700,20 @@ namespace Slic3r {
         }
         );
         m_print->throw_if_canceled();
+        if (layers_to_process.size() < m_layers.size())
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, m_layers.size()),
+                [this, &perimeters_source](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx)
+                    if (perimeters_source[layer_idx] != layer_idx) {
+                        m_print->throw_if_canceled();
+                        m_layers[layer_idx]->copy_perimeters_from(*m_layers[perimeters_source[layer_idx]]);
+                    }
+            });
+        m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
+        if (use_cache)
+            this->store_perimeters_to_cache(cache_key);
 
         if (print()->config().milling_diameter.size() > 0) {
             BOOST_LOG_TRIVIAL(debug) << "Generating milling post-process in parallel - start";
@@ -563,7 +875,9 @@ namespace Slic3r {
         this->prepare_infill();
 
         if (this->set_started(posInfill)) {
-            auto [adaptive_fill_octree, support_fill_octree] = this->prepare_adaptive_infill_data();
+            std::tie(m_adaptive_fill_octree, m_support_fill_octree) = this->prepare_adaptive_infill_data();
+            FillAdaptive::Octree *adaptive_fill_octree = m_adaptive_fill_octree.get();
+            FillAdaptive::Octree *support_fill_octree  = m_support_fill_octree.get();
 
             // atomic counter for gui progress
             std::atomic<int> atomic_count{ 0 };
@@ -573,11 +887,11 @@ namespace Slic3r {
             BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, m_layers.size()),
-                [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree, &atomic_count , &last_update, nb_layers_update](const tbb::blocked_range<size_t>& range) {
+                [this, adaptive_fill_octree, support_fill_octree, &atomic_count , &last_update, nb_layers_update](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
                     std::chrono::time_point<std::chrono::system_clock> start_make_fill = std::chrono::system_clock::now();
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get());
+                    m_layers[layer_idx]->make_fills(adaptive_fill_octree, support_fill_octree);
 
                     // updating progress
                     int nb_layers_done = (++atomic_count);
@@ -645,13 +959,17 @@ namespace Slic3r {
         }
     }
 
-    std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare_adaptive_infill_data()
+    std::pair<FillAdaptive::OctreeSharedPtr, FillAdaptive::OctreeSharedPtr> PrintObject::prepare_adaptive_infill_data()
     {
         using namespace FillAdaptive;
 
+        // Release the octrees of the previous infill() first, so that they are not held twice when rebuilding.
+        m_adaptive_fill_octree.reset();
+        m_support_fill_octree.reset();
+
         auto [adaptive_line_spacing, support_line_spacing] = adaptive_fill_line_spacing(*this);
         if ((adaptive_line_spacing == 0. && support_line_spacing == 0.) || this->layers().empty())
-            return std::make_pair(OctreePtr(), OctreePtr());
+            return std::make_pair(OctreeSharedPtr(), OctreeSharedPtr());
 
         indexed_triangle_set mesh = this->model_object()->raw_indexed_triangle_set();
         // Rotate mesh and build octree on it with axis-aligned (standart base) cubes.
@@ -681,9 +999,32 @@ namespace Slic3r {
         for (size_t i = 1; i < overhangs.size(); ++i)
             append(overhangs.front(), std::move(overhangs[i]));
 
-        return std::make_pair(
-            adaptive_line_spacing ? build_octree(mesh, overhangs.front(), adaptive_line_spacing, false) : OctreePtr(),
-            support_line_spacing ? build_octree(mesh, overhangs.front(), support_line_spacing, true) : OctreePtr());
+        // Key of the octrees shared with the other objects: the rotated mesh and the overhangs, which are all the inputs of build_octree()
+        // besides the line spacing.
+        size_t seed = 0;
+        for (const stl_vertex &v : mesh.vertices)
+            boost::hash_range(seed, v.data(), v.data() + 3);
+        for (const stl_triangle_vertex_indices &f : mesh.indices)
+            boost::hash_range(seed, f.data(), f.data() + 3);
+        for (const Vec3d &p : overhangs.front())
+            boost::hash_range(seed, p.data(), p.data() + 3);
+        auto octree_key = [seed](coordf_t line_spacing, bool support_overhangs_only) {
+            size_t key = seed;
+            boost::hash_combine(key, line_spacing);
+            boost::hash_combine(key, support_overhangs_only);
+            return uint64_t(key);
+        };
+        auto octree = [&mesh, &overhangs, &octree_key](coordf_t line_spacing, bool support_overhangs_only) {
+            return line_spacing == 0. ? OctreeSharedPtr() :
+                build_octree_shared(octree_key(line_spacing, support_overhangs_only),
+                    [&mesh, &overhangs, line_spacing, support_overhangs_only]() { return build_octree(mesh, overhangs.front(), line_spacing, support_overhangs_only); });
+        };
+        // The two octrees are independent, build them concurrently.
+        OctreeSharedPtr adaptive_fill_octree, support_fill_octree;
+        tbb::parallel_invoke(
+            [&]() { adaptive_fill_octree = octree(adaptive_line_spacing, false); },
+            [&]() { support_fill_octree  = octree(support_line_spacing, true); });
+        return std::make_pair(std::move(adaptive_fill_octree), std::move(support_fill_octree));
     }
 
     void PrintObject::clear_layers()
@@ -795,6 +1136,7 @@ namespace Slic3r {
                 || opt_key == "support_material_interface_extruder"
                 || opt_key == "support_material_interface_spacing"
                 || opt_key == "support_material_pattern"
+                || opt_key == "support_material_style"
                 || opt_key == "support_material_interface_pattern"
                 || opt_key == "support_material_xy_spacing"
                 || opt_key == "support_material_spacing"
@@ -935,8 +1277,21 @@ namespace Slic3r {
 
     bool PrintObject::invalidate_step(PrintObjectStep step)
     {
+        // The untyped slices and the fill boundaries released by release_intermediates() are only recalculated by slicing.
+        if (m_intermediates_released && (step == posPerimeters || step == posPrepareInfill || step == posInfill))
+            step = posSlice;
+        if (step == posSlice)
+            m_intermediates_released = false;
+
         bool invalidated = Inherited::invalidate_step(step);
 
+        // The cached support contact layers survive only a change of the support painting.
+        if ((step == posSlice || step == posSupportMaterial) && ! m_support_invalidated_by_painting)
+            m_support_contacts_cache.reset();
+        // The skirt hull is collected from the slices and the support layers.
+        if (step == posSlice || step == posPerimeters || step == posInfill || step == posSupportMaterial)
+            m_skirt_hull_height = -1.;
+
         // propagate to dependent steps
         if (step == posPerimeters) {
             invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning });
@@ -964,6 +1319,28 @@ namespace Slic3r {
         return invalidated;
     }
 
+    void PrintObject::release_intermediates()
+    {
+        if (! this->is_step_done(posInfill) || ! this->is_step_done(posSupportMaterial))
+            return;
+        // The G-code export needs the extrusions, the lslices, the region slices and the fill surfaces (for the travels),
+        // the untyped slice backup is only needed by make_perimeters() and the fill boundaries by prepare_infill() and infill().
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                for (LayerRegion *layerm : m_layers[layer_idx]->regions()) {
+                    ExPolygons().swap(layerm->raw_slices);
+                    ExPolygons().swap(layerm->fill_expolygons);
+                    ExPolygons().swap(layerm->fill_no_overlap_expolygons);
+                }
+        });
+        m_adaptive_fill_octree.reset();
+        m_support_fill_octree.reset();
+        m_support_contacts_cache.reset();
+        m_intermediates_released = true;
+    }
+
     bool PrintObject::invalidate_all_steps()
     {
         // First call the "invalidate" functions, which may cancel background processing.
@@ -971,9 +1348,26 @@ namespace Slic3r {
         // Then reset some of the depending values.
         this->m_slicing_params.valid = false;
         this->region_volumes.clear();
+        m_support_contacts_cache.reset();
+        m_skirt_hull_height = -1.;
         return result;
     }
 
+    size_t PrintObject::step_items(PrintObjectStep step) const
+    {
+        return step == posSupportMaterial ? this->support_layer_count() : this->layer_count();
+    }
+
+    bool PrintObject::invalidate_support_painting(coordf_t z_min, coordf_t z_max)
+    {
+        if (m_support_contacts_cache)
+            m_support_contacts_cache->invalidate_z_range(z_min, z_max);
+        m_support_invalidated_by_painting = true;
+        bool invalidated = this->invalidate_step(posSupportMaterial);
+        m_support_invalidated_by_painting = false;
+        return invalidated;
+    }
+
     bool PrintObject::has_support_material() const
     {
         return m_config.support_material
@@ -1503,23 +1897,23 @@ namespace Slic3r {
             BOOST_LOG_TRIVIAL(debug) << "Collecting surfaces covered with extrusions in parallel - end";
         }
 
-        for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
-            BOOST_LOG_TRIVIAL(debug) << "Processing external surfaces for region " << region_id << " in parallel - start";
-            tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, m_layers.size()),
-                [this, &surfaces_covered, region_id](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
-                    m_print->throw_if_canceled();
-                    // BOOST_LOG_TRIVIAL(trace) << "Processing external surface, layer" << m_layers[layer_idx]->print_z;
-                    m_layers[layer_idx]->get_region((int)region_id)->process_external_surfaces(
-                        (layer_idx == 0) ? nullptr : m_layers[layer_idx - 1],
-                        (layer_idx == 0 || surfaces_covered.empty() || surfaces_covered[layer_idx - 1].empty()) ? nullptr : &surfaces_covered[layer_idx - 1]);
-                }
+        // The regions of a layer only read the lower layer slices, thus all the regions are processed in a single pass over the layers.
+        BOOST_LOG_TRIVIAL(debug) << "Processing external surfaces in parallel - start";
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &surfaces_covered](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                m_print->throw_if_canceled();
+                // BOOST_LOG_TRIVIAL(trace) << "Processing external surface, layer" << m_layers[layer_idx]->print_z;
+                const Layer    *lower_layer         = (layer_idx == 0) ? nullptr : m_layers[layer_idx - 1];
+                const Polygons *lower_layer_covered = (layer_idx == 0 || surfaces_covered.empty() || surfaces_covered[layer_idx - 1].empty()) ? nullptr : &surfaces_covered[layer_idx - 1];
+                for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id)
+                    m_layers[layer_idx]->get_region((int)region_id)->process_external_surfaces(lower_layer, lower_layer_covered);
             }
-            );
-            m_print->throw_if_canceled();
-            BOOST_LOG_TRIVIAL(debug) << "Processing external surfaces for region " << region_id << " in parallel - end";
         }
+        );
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Processing external surfaces in parallel - end";
     }
 
     void PrintObject::discover_vertical_shells()
@@ -1539,6 +1933,49 @@ namespace Slic3r {
             Polygons    bottom_perimeter_surfaces;
             Polygons    holes;
         };
+        // Unions of the cached top or bottom surfaces over runs of 2^k consecutive layers (a sparse table).
+        // The union over any window of layers is then the union of just two overlapping runs,
+        // instead of growing the union layer by layer for each layer of the sliding window.
+        struct DiscoverVerticalShellsUnionTable
+        {
+            // level 0 points to the cache, level k > 0 is stored in levels[k - 1].
+            std::vector<const Polygons*>       base;
+            std::vector<std::vector<Polygons>> levels;
+
+            void build(std::vector<const Polygons*> &&surfaces, size_t max_window, const std::function<void()> &throw_if_canceled)
+            {
+                base = std::move(surfaces);
+                for (size_t run = 2; run <= max_window && run <= base.size(); run *= 2) {
+                    const size_t k = levels.size();
+                    levels.emplace_back(base.size() - run + 1);
+                    tbb::parallel_for(tbb::blocked_range<size_t>(0, levels[k].size()), [this, k, run, &throw_if_canceled](const tbb::blocked_range<size_t> &range) {
+                        for (size_t i = range.begin(); i < range.end(); ++ i) {
+                            throw_if_canceled();
+                            const Polygons &a = this->run_union(k, i);
+                            const Polygons &b = this->run_union(k, i + run / 2);
+                            levels[k][i] = union_(a, b);
+                        }
+                    });
+                }
+            }
+            // Union of the surfaces of layers <begin, end).
+            Polygons query(size_t begin, size_t end) const
+            {
+                assert(begin < end && end <= base.size());
+                size_t k = 0;
+                while ((size_t(2) << k) <= end - begin)
+                    ++ k;
+                assert(k <= levels.size());
+                const Polygons &a = this->run_union(k, begin);
+                const Polygons &b = this->run_union(k, end - (size_t(1) << k));
+                if (&a == &b)
+                    // A single run. The runs of a single layer are not merged yet.
+                    return k == 0 ? union_(a) : a;
+                return union_(a, b);
+            }
+        private:
+            const Polygons& run_union(size_t k, size_t i) const { return k == 0 ? *base[i] : levels[k - 1][i]; }
+        };
         bool     spiral_vase = this->print()->config().spiral_vase.value;
         size_t   num_layers = spiral_vase ? std::min(size_t(first_printing_region(*this)->config().bottom_solid_layers), m_layers.size()) : m_layers.size();
         coordf_t min_layer_height = this->slicing_parameters().min_layer_height;
@@ -1699,10 +2136,53 @@ namespace Slic3r {
                 BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << idx_region << " in parallel - end : cache top / bottom";
             }
 
+            // Windows of the layers projected to each layer to guarantee a minimum shell thickness:
+            // <top.first, top.second) above and <bottom.first, bottom.second) below the layer.
+            std::vector<std::pair<size_t, size_t>> top_windows(num_layers, { 0, 0 });
+            std::vector<std::pair<size_t, size_t>> bottom_windows(num_layers, { 0, 0 });
+            size_t max_top_window = 0;
+            size_t max_bottom_window = 0;
+            for (size_t idx_layer = 0; idx_layer < num_layers; ++ idx_layer) {
+                const PrintRegionConfig &region_config = region.config();
+                if (int n_top_layers = region_config.top_solid_layers.value; n_top_layers > 0) {
+                    coordf_t print_z = m_layers[idx_layer]->print_z;
+                    int i = int(idx_layer) + 1;
+                    for (; i < int(num_layers) &&
+                        (i < int(idx_layer) + n_top_layers ||
+                            m_layers[i]->print_z - print_z < region_config.top_solid_min_thickness - EPSILON);
+                        ++i);
+                    top_windows[idx_layer] = { idx_layer + 1, size_t(std::max(i, int(idx_layer) + 1)) };
+                    max_top_window = std::max(max_top_window, top_windows[idx_layer].second - top_windows[idx_layer].first);
+                }
+                if (int n_bottom_layers = region_config.bottom_solid_layers.value; n_bottom_layers > 0) {
+                    coordf_t bottom_z = m_layers[idx_layer]->bottom_z();
+                    int i = int(idx_layer) - 1;
+                    for (; i >= 0 &&
+                        (i > int(idx_layer) - n_bottom_layers ||
+                            bottom_z - m_layers[i]->bottom_z() < region_config.bottom_solid_min_thickness - EPSILON);
+                        --i);
+                    bottom_windows[idx_layer] = { size_t(i + 1), idx_layer };
+                    max_bottom_window = std::max(max_bottom_window, bottom_windows[idx_layer].second - bottom_windows[idx_layer].first);
+                }
+            }
+            DiscoverVerticalShellsUnionTable top_unions, bottom_unions;
+            {
+                std::vector<const Polygons*> top_surfaces, bottom_surfaces;
+                top_surfaces.reserve(num_layers);
+                bottom_surfaces.reserve(num_layers);
+                for (const DiscoverVerticalShellsCacheEntry &cache : cache_top_botom_regions) {
+                    top_surfaces.emplace_back(&cache.top_surfaces);
+                    bottom_surfaces.emplace_back(&cache.bottom_surfaces);
+                }
+                auto throw_if_canceled = [this]() { m_print->throw_if_canceled(); };
+                top_unions.build(std::move(top_surfaces), max_top_window, throw_if_canceled);
+                bottom_unions.build(std::move(bottom_surfaces), max_bottom_window, throw_if_canceled);
+            }
+
             BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << idx_region << " in parallel - start : ensure vertical wall thickness";
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, num_layers, grain_size),
-                [this, idx_region, &cache_top_botom_regions, nb_perimeter_layers_for_solid_fill]
+                [this, idx_region, &cache_top_botom_regions, nb_perimeter_layers_for_solid_fill, &top_windows, &bottom_windows, &top_unions, &bottom_unions]
             (const tbb::blocked_range<size_t>& range) {
                 // printf("discover_vertical_shells from %d to %d\n", range.begin(), range.end());
                 for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++idx_layer) {
@@ -1715,7 +2195,6 @@ namespace Slic3r {
 
                     Layer* layer = m_layers[idx_layer];
                     LayerRegion* layerm = layer->m_regions[idx_region];
-                    const PrintRegionConfig& region_config = layerm->region()->config();
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
                     layerm->export_region_slices_to_svg_debug("4_discover_vertical_shells-initial");
@@ -1758,23 +2237,13 @@ namespace Slic3r {
                         }
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
                         polygons_append(holes, cache_top_botom_regions[idx_layer].holes);
-                        if (int n_top_layers = region_config.top_solid_layers.value; n_top_layers > 0) {
+                        if (const auto [top_begin, top_end] = top_windows[idx_layer]; top_begin < top_end) {
                             // Gather top regions projected to this layer.
-                            coordf_t print_z = layer->print_z;
-                            for (int i = int(idx_layer) + 1;
-                                i < int(cache_top_botom_regions.size()) &&
-                                (i < int(idx_layer) + n_top_layers ||
-                                    m_layers[i]->print_z - print_z < region_config.top_solid_min_thickness - EPSILON);
-                                ++i) {
+                            shell = top_unions.query(top_begin, top_end);
+                            for (int i = int(top_begin); i < int(top_end); ++i) {
                                 const DiscoverVerticalShellsCacheEntry& cache = cache_top_botom_regions[i];
                                 if (!holes.empty())
                                     holes = intersection(holes, cache.holes);
-                                if (!cache.top_surfaces.empty()) {
-                                    polygons_append(shell, cache.top_surfaces);
-                                    // Running the union_ using the Clipper library piece by piece is cheaper 
-                                    // than running the union_ all at once.
-                                    shell = union_(shell, false);
-                                }
                                 if (nb_perimeter_layers_for_solid_fill != 0) {
                                     if (!cache.top_fill_surfaces.empty()) {
                                         polygons_append(fill_shell, cache.top_fill_surfaces);
@@ -1787,23 +2256,14 @@ namespace Slic3r {
                                 }
                             }
                         }
-                        if (int n_bottom_layers = region_config.bottom_solid_layers.value; n_bottom_layers > 0) {
+                        if (const auto [bottom_begin, bottom_end] = bottom_windows[idx_layer]; bottom_begin < bottom_end) {
                             // Gather bottom regions projected to this layer.
-                            coordf_t bottom_z = layer->bottom_z();
-                            for (int i = int(idx_layer) - 1;
-                                i >= 0 &&
-                                (i > int(idx_layer) - n_bottom_layers ||
-                                    bottom_z - m_layers[i]->bottom_z() < region_config.bottom_solid_min_thickness - EPSILON);
-                                --i) {
+                            if (Polygons bottom_shell = bottom_unions.query(bottom_begin, bottom_end); ! bottom_shell.empty())
+                                shell = shell.empty() ? std::move(bottom_shell) : union_(shell, bottom_shell);
+                            for (int i = int(bottom_end) - 1; i >= int(bottom_begin); --i) {
                                 const DiscoverVerticalShellsCacheEntry& cache = cache_top_botom_regions[i];
                                 if (!holes.empty())
                                     holes = intersection(holes, cache.holes);
-                                if (!cache.bottom_surfaces.empty()) {
-                                    polygons_append(shell, cache.bottom_surfaces);
-                                    // Running the union_ using the Clipper library piece by piece is cheaper 
-                                    // than running the union_ all at once.
-                                    shell = union_(shell, false);
-                                }
                                 if (nb_perimeter_layers_for_solid_fill != 0) {
                                     if (!cache.bottom_fill_surfaces.empty()) {
                                         polygons_append(fill_shell, cache.bottom_fill_surfaces);
@@ -1998,29 +2458,46 @@ namespace Slic3r {
     {
         BOOST_LOG_TRIVIAL(info) << "Bridge over infill..." << log_memory_info();
 
+        // Bridge flow of the regions to bridge, skip bridging in case there are no voids.
+        std::vector<std::pair<size_t, Flow>> regions_to_bridge;
         for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
             const PrintRegion& region = *m_print->regions()[region_id];
-
-            // skip bridging in case there are no voids
             if (region.config().fill_density.value == 100) continue;
-
             // get bridge flow
-            Flow bridge_flow = region.flow(
+            regions_to_bridge.emplace_back(region_id, region.flow(
                 frSolidInfill,
                 -1,     // layer height, not relevant for bridge flow
                 true,   // bridge
                 false,  // first layer
                 -1,     // custom width, not relevant for bridge flow
                 *this
-            );
+            ));
+        }
+        if (regions_to_bridge.empty() || m_layers.size() < 2)
+            return;
 
-            for (LayerPtrs::iterator layer_it = m_layers.begin(); layer_it != m_layers.end(); ++layer_it) {
-                // skip first layer
-                if (layer_it == m_layers.begin())
-                    continue;
+        // Internal sparse surfaces of all the regions of each layer, collected once and shared by all the regions of the layers above.
+        // They are not modified by this step, thus the layers may be processed in parallel.
+        std::vector<Polygons> layers_internal_sparse(m_layers.size() - 1);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size() - 1),
+            [this, &layers_internal_sparse](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx)
+                    for (const LayerRegion* lower_layerm : m_layers[layer_idx]->m_regions)
+                        lower_layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse, &layers_internal_sparse[layer_idx]);
+            }
+        );
 
-                Layer* layer = *layer_it;
-                LayerRegion* layerm = layer->m_regions[region_id];
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(1, m_layers.size()),
+            [this, &regions_to_bridge, &layers_internal_sparse](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx)
+            for (const std::pair<size_t, Flow>& region_to_bridge : regions_to_bridge) {
+                m_print->throw_if_canceled();
+                const PrintRegion& region      = *m_print->regions()[region_to_bridge.first];
+                const Flow&        bridge_flow = region_to_bridge.second;
+                Layer* layer = m_layers[layer_idx];
+                LayerRegion* layerm = layer->m_regions[region_to_bridge.first];
 
                 // extract the stInternalSolid surfaces that might be transformed into bridges
                 Polygons internal_solid;
@@ -2035,19 +2512,14 @@ namespace Slic3r {
 
                     // iterate through lower layers spanned by bridge_flow
                     double bottom_z = layer->print_z - bridge_flow.height;
-                    for (int i = int(layer_it - m_layers.begin()) - 1; i >= 0; --i) {
+                    for (int i = int(layer_idx) - 1; i >= 0; --i) {
                         const Layer* lower_layer = m_layers[i];
 
                         // stop iterating if layer is lower than bottom_z
                         if (lower_layer->print_z < bottom_z) break;
 
-                        // iterate through regions and collect internal surfaces
-                        Polygons lower_internal;
-                        for (LayerRegion* lower_layerm : lower_layer->m_regions)
-                            lower_layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse, &lower_internal);
-
-                        // intersect such lower internal surfaces with the candidate solid surfaces
-                        to_bridge_pp = intersection(to_bridge_pp, lower_internal);
+                        // intersect the internal surfaces of the lower layer with the candidate solid surfaces
+                        to_bridge_pp = intersection(to_bridge_pp, layers_internal_sparse[i]);
                     }
 
                     // there's no point in bridging too thin/short regions
@@ -2129,9 +2601,10 @@ namespace Slic3r {
                 layerm->export_region_slices_to_svg_debug("7_bridge_over_infill");
                 layerm->export_region_fill_surfaces_to_svg_debug("7_bridge_over_infill");
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
-                m_print->throw_if_canceled();
             }
         }
+        );
+        m_print->throw_if_canceled();
     }
 
     /* This method applies overextrude flow to the first internal solid layer above
@@ -2362,6 +2835,7 @@ namespace Slic3r {
     // this should be idempotent
     void PrintObject::_slice(const std::vector<coordf_t>& layer_height_profile)
     {
+        SLIC3R_TRACE_ZONE("PrintObject::_slice");
         BOOST_LOG_TRIVIAL(info) << "Slicing objects..." << log_memory_info();
 
         m_typed_slices = false;
@@ -3069,6 +3543,81 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
         const std::vector<float>& z,
         SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below,
         const std::vector<const ModelVolume*>& volumes) const
+    {
+        if (m_volume_mesh_hashes.empty() || volumes.empty())
+            return this->_slice_volumes(z, mode, slicing_mode_normal_below_layer, mode_below, volumes);
+        return this->slice_shared(this->volume_slices_key(true, z, mode, slicing_mode_normal_below_layer, mode_below, volumes),
+            [this, &z, mode, slicing_mode_normal_below_layer, mode_below, &volumes]() { return this->_slice_volumes(z, mode, slicing_mode_normal_below_layer, mode_below, volumes); });
+    }
+
+    std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float>& z, SlicingMode mode, const ModelVolume& volume) const
+    {
+        if (m_volume_mesh_hashes.empty() || z.empty())
+            return this->_slice_volume(z, mode, volume);
+        return this->slice_shared(this->volume_slices_key(false, z, mode, 0, mode, { &volume }),
+            [this, &z, mode, &volume]() { return this->_slice_volume(z, mode, volume); });
+    }
+
+    uint64_t PrintObject::volume_slices_key(bool merged, const std::vector<float>& z, SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below,
+        const std::vector<const ModelVolume*>& volumes) const
+    {
+        assert(m_volume_mesh_hashes.size() == this->model_object()->volumes.size());
+        size_t seed = 0;
+        auto hash_matrix = [&seed](const Transform3d& m) { boost::hash_range(seed, m.data(), m.data() + 16); };
+        boost::hash_combine(seed, merged);
+        boost::hash_range(seed, z.begin(), z.end());
+        boost::hash_combine(seed, uint32_t(mode));
+        boost::hash_combine(seed, slicing_mode_normal_below_layer);
+        boost::hash_combine(seed, uint32_t(mode_below));
+        for (const ModelVolume* volume : volumes) {
+            auto it = std::find(this->model_object()->volumes.begin(), this->model_object()->volumes.end(), volume);
+            assert(it != this->model_object()->volumes.end());
+            boost::hash_combine(seed, m_volume_mesh_hashes[it - this->model_object()->volumes.begin()]);
+            hash_matrix(volume->get_matrix());
+        }
+        hash_matrix(m_trafo);
+        boost::hash_combine(seed, m_center_offset.x());
+        boost::hash_combine(seed, m_center_offset.y());
+        boost::hash_combine(seed, m_config.slice_closing_radius.value);
+        boost::hash_combine(seed, m_config.model_precision.value);
+        return uint64_t(seed);
+    }
+
+    std::vector<ExPolygons> PrintObject::slice_shared(uint64_t key, const std::function<std::vector<ExPolygons>()>& slice_fn) const
+    {
+        std::promise<std::vector<ExPolygons>>       promise;
+        std::shared_future<std::vector<ExPolygons>> slices;
+        bool                                        owner = false;
+        {
+            std::lock_guard<std::mutex> lock(m_print->m_shared_volume_slices_mutex);
+            auto it = m_print->m_shared_volume_slices.find(key);
+            if (it == m_print->m_shared_volume_slices.end()) {
+                slices = promise.get_future().share();
+                m_print->m_shared_volume_slices.emplace(key, slices);
+                owner = true;
+            } else
+                slices = it->second;
+        }
+        if (owner) {
+            try {
+                std::vector<ExPolygons> out;
+                // The other object waits for these slices while blocking its thread. Isolate the parallel slicing,
+                // so that this thread does not pick up the slicing of the waiting object and waits for itself.
+                tbb::this_task_arena::isolate([&slice_fn, &out]() { out = slice_fn(); });
+                promise.set_value(std::move(out));
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+        } else
+            BOOST_LOG_TRIVIAL(debug) << "Slicing objects - sharing the slices of an object with the same meshes";
+        return slices.get();
+    }
+
+    std::vector<ExPolygons> PrintObject::_slice_volumes(
+        const std::vector<float>& z,
+        SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below,
+        const std::vector<const ModelVolume*>& volumes) const
     {
         std::vector<ExPolygons> layers;
         if (!volumes.empty()) {
@@ -3103,7 +3652,7 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
         return layers;
     }
 
-    std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float>& z, SlicingMode mode, const ModelVolume& volume) const
+    std::vector<ExPolygons> PrintObject::_slice_volume(const std::vector<float>& z, SlicingMode mode, const ModelVolume& volume) const
     {
         std::vector<ExPolygons> layers;
         if (!z.empty()) {
@@ -3176,72 +3725,79 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
             if (m_layers[idx_layer]->slicing_errors)
                 buggy_layers.push_back(idx_layer);
 
-        BOOST_LOG_TRIVIAL(debug) << "Slicing objects - fixing slicing errors in parallel - begin";
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, buggy_layers.size()),
-            [this, &buggy_layers](const tbb::blocked_range<size_t>& range) {
-            for (size_t buggy_layer_idx = range.begin(); buggy_layer_idx < range.end(); ++buggy_layer_idx) {
-                m_print->throw_if_canceled();
-                size_t idx_layer = buggy_layers[buggy_layer_idx];
-                Layer* layer = m_layers[idx_layer];
-                assert(layer->slicing_errors);
-                // Try to repair the layer surfaces by merging all contours and all holes from neighbor layers.
-                // BOOST_LOG_TRIVIAL(trace) << "Attempting to repair layer" << idx_layer;
-                for (size_t region_id = 0; region_id < layer->m_regions.size(); ++region_id) {
-                    LayerRegion* layerm = layer->m_regions[region_id];
-                    // Find the first valid layer below / above the current layer.
-                    const Surfaces* upper_surfaces = nullptr;
-                    const Surfaces* lower_surfaces = nullptr;
-                    for (size_t j = idx_layer + 1; j < m_layers.size(); ++j)
-                        if (!m_layers[j]->slicing_errors) {
-                            upper_surfaces = &m_layers[j]->regions()[region_id]->slices().surfaces;
-                            break;
-                        }
-                    for (int j = int(idx_layer) - 1; j >= 0; --j)
-                        if (!m_layers[j]->slicing_errors) {
-                            lower_surfaces = &m_layers[j]->regions()[region_id]->slices().surfaces;
-                            break;
-                        }
-                    // Collect outer contours and holes from the valid layers above & below.
-                    Polygons outer;
-                    outer.reserve(
-                        ((upper_surfaces == nullptr) ? 0 : upper_surfaces->size()) +
-                        ((lower_surfaces == nullptr) ? 0 : lower_surfaces->size()));
-                    size_t num_holes = 0;
-                    if (upper_surfaces)
-                        for (const auto& surface : *upper_surfaces) {
-                            outer.push_back(surface.expolygon.contour);
-                            num_holes += surface.expolygon.holes.size();
-                        }
-                    if (lower_surfaces)
-                        for (const auto& surface : *lower_surfaces) {
-                            outer.push_back(surface.expolygon.contour);
-                            num_holes += surface.expolygon.holes.size();
-                        }
-                    Polygons holes;
-                    holes.reserve(num_holes);
-                    if (upper_surfaces)
-                        for (const auto& surface : *upper_surfaces)
-                            polygons_append(holes, surface.expolygon.holes);
-                    if (lower_surfaces)
-                        for (const auto& surface : *lower_surfaces)
-                            polygons_append(holes, surface.expolygon.holes);
-                    layerm->m_slices.set(diff_ex(union_(outer), holes, false), stPosInternal | stDensSparse);
+        if (! buggy_layers.empty()) {
+            BOOST_LOG_TRIVIAL(debug) << "Slicing objects - fixing slicing errors in parallel - begin";
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, buggy_layers.size()),
+                [this, &buggy_layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t buggy_layer_idx = range.begin(); buggy_layer_idx < range.end(); ++buggy_layer_idx) {
+                    m_print->throw_if_canceled();
+                    size_t idx_layer = buggy_layers[buggy_layer_idx];
+                    Layer* layer = m_layers[idx_layer];
+                    assert(layer->slicing_errors);
+                    // Try to repair the layer surfaces by merging all contours and all holes from neighbor layers.
+                    // BOOST_LOG_TRIVIAL(trace) << "Attempting to repair layer" << idx_layer;
+                    for (size_t region_id = 0; region_id < layer->m_regions.size(); ++region_id) {
+                        LayerRegion* layerm = layer->m_regions[region_id];
+                        // Find the first valid layer below / above the current layer.
+                        const Surfaces* upper_surfaces = nullptr;
+                        const Surfaces* lower_surfaces = nullptr;
+                        for (size_t j = idx_layer + 1; j < m_layers.size(); ++j)
+                            if (!m_layers[j]->slicing_errors) {
+                                upper_surfaces = &m_layers[j]->regions()[region_id]->slices().surfaces;
+                                break;
+                            }
+                        for (int j = int(idx_layer) - 1; j >= 0; --j)
+                            if (!m_layers[j]->slicing_errors) {
+                                lower_surfaces = &m_layers[j]->regions()[region_id]->slices().surfaces;
+                                break;
+                            }
+                        // Collect outer contours and holes from the valid layers above & below.
+                        Polygons outer;
+                        outer.reserve(
+                            ((upper_surfaces == nullptr) ? 0 : upper_surfaces->size()) +
+                            ((lower_surfaces == nullptr) ? 0 : lower_surfaces->size()));
+                        size_t num_holes = 0;
+                        if (upper_surfaces)
+                            for (const auto& surface : *upper_surfaces) {
+                                outer.push_back(surface.expolygon.contour);
+                                num_holes += surface.expolygon.holes.size();
+                            }
+                        if (lower_surfaces)
+                            for (const auto& surface : *lower_surfaces) {
+                                outer.push_back(surface.expolygon.contour);
+                                num_holes += surface.expolygon.holes.size();
+                            }
+                        Polygons holes;
+                        holes.reserve(num_holes);
+                        if (upper_surfaces)
+                            for (const auto& surface : *upper_surfaces)
+                                polygons_append(holes, surface.expolygon.holes);
+                        if (lower_surfaces)
+                            for (const auto& surface : *lower_surfaces)
+                                polygons_append(holes, surface.expolygon.holes);
+                        layerm->m_slices.set(diff_ex(union_(outer), holes, false), stPosInternal | stDensSparse);
+                    }
+                    // Update layer slices after repairing the single regions.
+                    layer->make_slices();
                 }
-                // Update layer slices after repairing the single regions.
-                layer->make_slices();
-            }
-        });
-        m_print->throw_if_canceled();
-        BOOST_LOG_TRIVIAL(debug) << "Slicing objects - fixing slicing errors in parallel - end";
-
-        // remove empty layers from bottom
-        while (!m_layers.empty() && (m_layers.front()->lslices.empty() || m_layers.front()->empty())) {
-            delete m_layers.front();
-            m_layers.erase(m_layers.begin());
-            m_layers.front()->lower_layer = nullptr;
-            for (size_t i = 0; i < m_layers.size(); ++i)
-                m_layers[i]->set_id(m_layers[i]->id() - 1);
+            });
+            m_print->throw_if_canceled();
+            BOOST_LOG_TRIVIAL(debug) << "Slicing objects - fixing slicing errors in parallel - end";
+        }
+
+        // remove empty layers from bottom, all of them at once and renumber the remaining layers once
+        size_t num_empty = 0;
+        while (num_empty < m_layers.size() && (m_layers[num_empty]->lslices.empty() || m_layers[num_empty]->empty()))
+            ++num_empty;
+        if (num_empty > 0) {
+            for (size_t i = 0; i < num_empty; ++i)
+                delete m_layers[i];
+            m_layers.erase(m_layers.begin(), m_layers.begin() + num_empty);
+            if (!m_layers.empty())
+                m_layers.front()->lower_layer = nullptr;
+            for (Layer* layer : m_layers)
+                layer->set_id(layer->id() - num_empty);
         }
 
         return buggy_layers.empty() ? "" :
@@ -3364,202 +3920,208 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
     {
         BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
 
-        for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
-            for (size_t i = 0; i < m_layers.size(); ++i) {
-                m_print->throw_if_canceled();
-                Layer* layer = m_layers[i];
-                LayerRegion* layerm = layer->regions()[region_id];
-                const PrintRegionConfig& region_config = layerm->region()->config();
-                if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
-                    (i % region_config.solid_infill_every_layers) == 0) {
-                    // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
-                    SurfaceType type = (region_config.fill_density == 100) ? (stPosInternal | stDensSolid) : (stPosInternal | stDensSolid | stModBridge);
-                    for (Surface& surface : layerm->fill_surfaces.surfaces)
-                        if (surface.surface_type == (stPosInternal | stDensSparse))
-                            surface.surface_type = type;
-                }
-
-                // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
-                if (region_config.ensure_vertical_shell_thickness.value)
-                    continue;
-
-                coordf_t print_z = layer->print_z;
-                coordf_t bottom_z = layer->bottom_z();
-                // 0: topSolid, 1: botSolid, 2: boSolidBridged
-                for (size_t idx_surface_type = 0; idx_surface_type < 3; ++idx_surface_type) {
+        // The shells are scattered from each layer to the neighbor layers of the same region only,
+        // therefore the regions are processed independently. The scattering over the layers is inherently serial:
+        // the shells of a layer are limited by the shells scattered to it from the layers processed before.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, this->region_volumes.size()), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t region_id = range.begin(); region_id < range.end(); ++region_id) {
+                for (size_t i = 0; i < m_layers.size(); ++i) {
                     m_print->throw_if_canceled();
-                    SurfaceType type = (idx_surface_type == 0) ? (stPosTop | stDensSolid) :
-                        ((idx_surface_type == 1) ? (stPosBottom | stDensSolid) : 
-                            (stPosBottom | stDensSolid | stModBridge));
-                    int num_solid_layers = ((type & stPosTop) == stPosTop) ? region_config.top_solid_layers.value : region_config.bottom_solid_layers.value;
-                    if (num_solid_layers == 0)
-                        continue;
-                    // Find slices of current type for current layer.
-                    // Use slices instead of fill_surfaces, because they also include the perimeter area,
-                    // which needs to be propagated in shells; we need to grow slices like we did for
-                    // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
-                    // not work in some situations, as there won't be any grown region in the perimeter 
-                    // area (this was seen in a model where the top layer had one extra perimeter, thus
-                    // its fill_surfaces were thinner than the lower layer's infill), however it's the best
-                    // solution so far. Growing the external slices by external_infill_margin will put
-                    // too much solid infill inside nearly-vertical slopes.
-
-                    // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
-                    // (not covered by a layer above / below).
-                    // This does not contain the areas covered by perimeters!
-                    ExPolygons solid;
-                    for (const Surface& surface : layerm->slices().surfaces)
-                        if (surface.surface_type == type)
-                            solid.push_back(surface.expolygon);
-                    // Infill areas (slices without the perimeters).
-                    for (const Surface& surface : layerm->fill_surfaces.surfaces)
-                        if (surface.surface_type == type)
-                            solid.push_back(surface.expolygon);
-                    if (solid.empty())
+                    Layer* layer = m_layers[i];
+                    LayerRegion* layerm = layer->regions()[region_id];
+                    const PrintRegionConfig& region_config = layerm->region()->config();
+                    if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
+                        (i % region_config.solid_infill_every_layers) == 0) {
+                        // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
+                        SurfaceType type = (region_config.fill_density == 100) ? (stPosInternal | stDensSolid) : (stPosInternal | stDensSolid | stModBridge);
+                        for (Surface& surface : layerm->fill_surfaces.surfaces)
+                            if (surface.surface_type == (stPosInternal | stDensSparse))
+                                surface.surface_type = type;
+                    }
+
+                    // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
+                    if (region_config.ensure_vertical_shell_thickness.value)
                         continue;
-                    solid = union_ex(solid);
-                    //                Slic3r::debugf "Layer %d has %s surfaces\n", $i, (($type & stTop) != 0) ? 'top' : 'bottom';
-
-                                    // Scatter top / bottom regions to other layers. Scattering process is inherently serial, it is difficult to parallelize without locking.
-                    for (int n = ((type & stPosTop) == stPosTop) ? int(i) - 1 : int(i) + 1;
-                        ((type & stPosTop) == stPosTop) ?
-                        (n >= 0 && (int(i) - n < num_solid_layers ||
-                            print_z - m_layers[n]->print_z < region_config.top_solid_min_thickness.value - EPSILON)) :
-                        (n < int(m_layers.size()) && (n - int(i) < num_solid_layers ||
-                            m_layers[n]->bottom_z() - bottom_z < region_config.bottom_solid_min_thickness.value - EPSILON));
-                        ((type & stPosTop) == stPosTop) ? --n : ++n)
-                    {
-                        //                    Slic3r::debugf "  looking for neighbors on layer %d...\n", $n;                  
-                                            // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
-                        LayerRegion* neighbor_layerm = m_layers[n]->regions()[region_id];
-
-                        // find intersection between neighbor and current layer's surfaces
-                        // intersections have contours and holes
-                        // we update $solid so that we limit the next neighbor layer to the areas that were
-                        // found on this one - in other words, solid shells on one layer (for a given external surface)
-                        // are always a subset of the shells found on the previous shell layer
-                        // this approach allows for DWIM in hollow sloping vases, where we want bottom
-                        // shells to be generated in the base but not in the walls (where there are many
-                        // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the 
-                        // upper perimeter as an obstacle and shell will not be propagated to more upper layers
-                        //FIXME How does it work for stInternalBRIDGE? This is set for sparse infill. Likely this does not work.
-                        ExPolygons new_internal_solid;
+
+                    coordf_t print_z = layer->print_z;
+                    coordf_t bottom_z = layer->bottom_z();
+                    // 0: topSolid, 1: botSolid, 2: boSolidBridged
+                    for (size_t idx_surface_type = 0; idx_surface_type < 3; ++idx_surface_type) {
+                        m_print->throw_if_canceled();
+                        SurfaceType type = (idx_surface_type == 0) ? (stPosTop | stDensSolid) :
+                            ((idx_surface_type == 1) ? (stPosBottom | stDensSolid) : 
+                                (stPosBottom | stDensSolid | stModBridge));
+                        int num_solid_layers = ((type & stPosTop) == stPosTop) ? region_config.top_solid_layers.value : region_config.bottom_solid_layers.value;
+                        if (num_solid_layers == 0)
+                            continue;
+                        // Find slices of current type for current layer.
+                        // Use slices instead of fill_surfaces, because they also include the perimeter area,
+                        // which needs to be propagated in shells; we need to grow slices like we did for
+                        // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
+                        // not work in some situations, as there won't be any grown region in the perimeter 
+                        // area (this was seen in a model where the top layer had one extra perimeter, thus
+                        // its fill_surfaces were thinner than the lower layer's infill), however it's the best
+                        // solution so far. Growing the external slices by external_infill_margin will put
+                        // too much solid infill inside nearly-vertical slopes.
+
+                        // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
+                        // (not covered by a layer above / below).
+                        // This does not contain the areas covered by perimeters!
+                        ExPolygons solid;
+                        for (const Surface& surface : layerm->slices().surfaces)
+                            if (surface.surface_type == type)
+                                solid.push_back(surface.expolygon);
+                        // Infill areas (slices without the perimeters).
+                        for (const Surface& surface : layerm->fill_surfaces.surfaces)
+                            if (surface.surface_type == type)
+                                solid.push_back(surface.expolygon);
+                        if (solid.empty())
+                            continue;
+                        solid = union_ex(solid);
+                        //                Slic3r::debugf "Layer %d has %s surfaces\n", $i, (($type & stTop) != 0) ? 'top' : 'bottom';
+
+                                        // Scatter top / bottom regions to other layers. Scattering process is inherently serial, it is difficult to parallelize without locking.
+                        for (int n = ((type & stPosTop) == stPosTop) ? int(i) - 1 : int(i) + 1;
+                            ((type & stPosTop) == stPosTop) ?
+                            (n >= 0 && (int(i) - n < num_solid_layers ||
+                                print_z - m_layers[n]->print_z < region_config.top_solid_min_thickness.value - EPSILON)) :
+                            (n < int(m_layers.size()) && (n - int(i) < num_solid_layers ||
+                                m_layers[n]->bottom_z() - bottom_z < region_config.bottom_solid_min_thickness.value - EPSILON));
+                            ((type & stPosTop) == stPosTop) ? --n : ++n)
                         {
-                            ExPolygons internal;
-                            for (const Surface& surface : neighbor_layerm->fill_surfaces.surfaces)
-                                if (surface.has_pos_internal() && (surface.has_fill_sparse() || surface.has_fill_solid()))
-                                    internal.push_back(surface.expolygon);
-                            internal = union_ex(internal);
-                            new_internal_solid = intersection_ex(solid, internal, true);
-                        }
-                        if (new_internal_solid.empty()) {
-                            // No internal solid needed on this layer. In order to decide whether to continue
-                            // searching on the next neighbor (thus enforcing the configured number of solid
-                            // layers, use different strategies according to configured infill density:
-                            if (region_config.fill_density.value == 0) {
-                                // If user expects the object to be void (for example a hollow sloping vase),
-                                // don't continue the search. In this case, we only generate the external solid
-                                // shell if the object would otherwise show a hole (gap between perimeters of 
-                                // the two layers), and internal solid shells are a subset of the shells found 
-                                // on each previous layer.
-                                goto EXTERNAL;
-                            } else {
-                                // If we have internal infill, we can generate internal solid shells freely.
-                                continue;
+                            //                    Slic3r::debugf "  looking for neighbors on layer %d...\n", $n;                  
+                                                // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
+                            LayerRegion* neighbor_layerm = m_layers[n]->regions()[region_id];
+
+                            // find intersection between neighbor and current layer's surfaces
+                            // intersections have contours and holes
+                            // we update $solid so that we limit the next neighbor layer to the areas that were
+                            // found on this one - in other words, solid shells on one layer (for a given external surface)
+                            // are always a subset of the shells found on the previous shell layer
+                            // this approach allows for DWIM in hollow sloping vases, where we want bottom
+                            // shells to be generated in the base but not in the walls (where there are many
+                            // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the 
+                            // upper perimeter as an obstacle and shell will not be propagated to more upper layers
+                            //FIXME How does it work for stInternalBRIDGE? This is set for sparse infill. Likely this does not work.
+                            ExPolygons new_internal_solid;
+                            {
+                                ExPolygons internal;
+                                for (const Surface& surface : neighbor_layerm->fill_surfaces.surfaces)
+                                    if (surface.has_pos_internal() && (surface.has_fill_sparse() || surface.has_fill_solid()))
+                                        internal.push_back(surface.expolygon);
+                                internal = union_ex(internal);
+                                new_internal_solid = intersection_ex(solid, internal, true);
+                            }
+                            if (new_internal_solid.empty()) {
+                                // No internal solid needed on this layer. In order to decide whether to continue
+                                // searching on the next neighbor (thus enforcing the configured number of solid
+                                // layers, use different strategies according to configured infill density:
+                                if (region_config.fill_density.value == 0) {
+                                    // If user expects the object to be void (for example a hollow sloping vase),
+                                    // don't continue the search. In this case, we only generate the external solid
+                                    // shell if the object would otherwise show a hole (gap between perimeters of 
+                                    // the two layers), and internal solid shells are a subset of the shells found 
+                                    // on each previous layer.
+                                    goto EXTERNAL;
+                                } else {
+                                    // If we have internal infill, we can generate internal solid shells freely.
+                                    continue;
+                                }
                             }
-                        }
 
-                        if (region_config.fill_density.value == 0) {
-                            // if we're printing a hollow object we discard any solid shell thinner
-                            // than a perimeter width, since it's probably just crossing a sloping wall
-                            // and it's not wanted in a hollow print even if it would make sense when
-                            // obeying the solid shell count option strictly (DWIM!)
-                            float margin = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width());
-                            ExPolygons too_narrow = diff_ex(
-                                new_internal_solid,
-                                offset2_ex(new_internal_solid, -margin, +margin, jtMiter, 5),
-                                true);
-                            // Trim the regularized region by the original region.
-                            if (!too_narrow.empty())
-                            if (!too_narrow.empty()) {
-                                solid = new_internal_solid = diff_ex(new_internal_solid, too_narrow);
+                            if (region_config.fill_density.value == 0) {
+                                // if we're printing a hollow object we discard any solid shell thinner
+                                // than a perimeter width, since it's probably just crossing a sloping wall
+                                // and it's not wanted in a hollow print even if it would make sense when
+                                // obeying the solid shell count option strictly (DWIM!)
+                                float margin = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width());
+                                ExPolygons too_narrow = diff_ex(
+                                    new_internal_solid,
+                                    offset2_ex(new_internal_solid, -margin, +margin, jtMiter, 5),
+                                    true);
+                                // Trim the regularized region by the original region.
+                                if (!too_narrow.empty())
+                                if (!too_narrow.empty()) {
+                                    solid = new_internal_solid = diff_ex(new_internal_solid, too_narrow);
+                                }
                             }
-                        }
 
 
-                        //merill: this is creating artifacts, and i can't recreate the issue it wants to fix.
-
-                        // make sure the new internal solid is wide enough, as it might get collapsed
-                        // when spacing is added in Fill.pm
-                        if(false){
-                            //FIXME Vojtech: Disable this and you will be sorry.
-                            // https://github.com/prusa3d/PrusaSlicer/issues/26 bottom
-                            float margin = 3.f * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
-                            // we use a higher miterLimit here to handle areas with acute angles
-                            // in those cases, the default miterLimit would cut the corner and we'd
-                            // get a triangle in $too_narrow; if we grow it below then the shell
-                            // would have a different shape from the external surface and we'd still
-                            // have the same angle, so the next shell would be grown even more and so on.
-                            ExPolygons too_narrow = diff_ex(
-                                new_internal_solid,
-                                offset2_ex(new_internal_solid, -margin, +margin, ClipperLib::jtMiter, 5),
-                                true);
-                            if (!too_narrow.empty()) {
-                                // grow the collapsing parts and add the extra area to  the neighbor layer 
-                                // as well as to our original surfaces so that we support this 
-                                // additional area in the next shell too
-                                // make sure our grown surfaces don't exceed the fill area
-                                ExPolygons internal;
-                                for (const Surface& surface : neighbor_layerm->fill_surfaces.surfaces)
-                                    if (surface.has_pos_internal() && !surface.has_mod_bridge())
-                                        internal.push_back(surface.expolygon);
-                                expolygons_append(new_internal_solid,
-                                    intersection_ex(
-                                        offset_ex(too_narrow, +margin),
-                                        // Discard bridges as they are grown for anchoring and we can't
-                                        // remove such anchors. (This may happen when a bridge is being 
-                                        // anchored onto a wall where little space remains after the bridge
-                                        // is grown, and that little space is an internal solid shell so 
-                                        // it triggers this too_narrow logic.)
-                                        union_ex(internal)));
-                                // see https://github.com/prusa3d/PrusaSlicer/pull/3426
-                                // solid = new_internal_solid;
+                            //merill: this is creating artifacts, and i can't recreate the issue it wants to fix.
+
+                            // make sure the new internal solid is wide enough, as it might get collapsed
+                            // when spacing is added in Fill.pm
+                            if(false){
+                                //FIXME Vojtech: Disable this and you will be sorry.
+                                // https://github.com/prusa3d/PrusaSlicer/issues/26 bottom
+                                float margin = 3.f * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
+                                // we use a higher miterLimit here to handle areas with acute angles
+                                // in those cases, the default miterLimit would cut the corner and we'd
+                                // get a triangle in $too_narrow; if we grow it below then the shell
+                                // would have a different shape from the external surface and we'd still
+                                // have the same angle, so the next shell would be grown even more and so on.
+                                ExPolygons too_narrow = diff_ex(
+                                    new_internal_solid,
+                                    offset2_ex(new_internal_solid, -margin, +margin, ClipperLib::jtMiter, 5),
+                                    true);
+                                if (!too_narrow.empty()) {
+                                    // grow the collapsing parts and add the extra area to  the neighbor layer 
+                                    // as well as to our original surfaces so that we support this 
+                                    // additional area in the next shell too
+                                    // make sure our grown surfaces don't exceed the fill area
+                                    ExPolygons internal;
+                                    for (const Surface& surface : neighbor_layerm->fill_surfaces.surfaces)
+                                        if (surface.has_pos_internal() && !surface.has_mod_bridge())
+                                            internal.push_back(surface.expolygon);
+                                    expolygons_append(new_internal_solid,
+                                        intersection_ex(
+                                            offset_ex(too_narrow, +margin),
+                                            // Discard bridges as they are grown for anchoring and we can't
+                                            // remove such anchors. (This may happen when a bridge is being 
+                                            // anchored onto a wall where little space remains after the bridge
+                                            // is grown, and that little space is an internal solid shell so 
+                                            // it triggers this too_narrow logic.)
+                                            union_ex(internal)));
+                                    // see https://github.com/prusa3d/PrusaSlicer/pull/3426
+                                    // solid = new_internal_solid;
+                                }
                             }
-                        }
 
-                        // internal-solid are the union of the existing internal-solid surfaces
-                        // and new ones
-                        SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
-                        expolygons_append(new_internal_solid, to_expolygons(backup.filter_by_type(stPosInternal | stDensSolid)));
-                        ExPolygons internal_solid = union_ex(new_internal_solid, false);
-                        // assign new internal-solid surfaces to layer
-                        neighbor_layerm->fill_surfaces.set(internal_solid, stPosInternal | stDensSolid);
-                        // subtract intersections from layer surfaces to get resulting internal surfaces
-                        //ExPolygons polygons_internal = to_polygons(std::move(internal_solid));
-                        ExPolygons internal = diff_ex(
-                            to_expolygons(backup.filter_by_type(stPosInternal | stDensSparse)),
-                            internal_solid,
-                            true);
-                        // assign resulting internal surfaces to layer
-                        neighbor_layerm->fill_surfaces.append(internal, stPosInternal | stDensSparse);
-                        expolygons_append(internal_solid, internal);
-                        // assign top and bottom surfaces to layer
-                        SurfaceType surface_types_solid[] = { stPosTop | stDensSolid, stPosBottom | stDensSolid, stPosBottom | stDensSolid | stModBridge };
-                        backup.keep_types(surface_types_solid, 3);
-                        //backup.keep_types_flag(stPosTop | stPosBottom);
-                        std::vector<SurfacesPtr> top_bottom_groups;
-                        backup.group(&top_bottom_groups);
-                        for (SurfacesPtr& group : top_bottom_groups) {
-                            neighbor_layerm->fill_surfaces.append(
-                                diff_ex(to_expolygons(group), union_ex(internal_solid)),
-                                // Use an existing surface as a template, it carries the bridge angle etc.
-                                *group.front());
+                            // internal-solid are the union of the existing internal-solid surfaces
+                            // and new ones
+                            SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
+                            expolygons_append(new_internal_solid, to_expolygons(backup.filter_by_type(stPosInternal | stDensSolid)));
+                            ExPolygons internal_solid = union_ex(new_internal_solid, false);
+                            // assign new internal-solid surfaces to layer
+                            neighbor_layerm->fill_surfaces.set(internal_solid, stPosInternal | stDensSolid);
+                            // subtract intersections from layer surfaces to get resulting internal surfaces
+                            //ExPolygons polygons_internal = to_polygons(std::move(internal_solid));
+                            ExPolygons internal = diff_ex(
+                                to_expolygons(backup.filter_by_type(stPosInternal | stDensSparse)),
+                                internal_solid,
+                                true);
+                            // assign resulting internal surfaces to layer
+                            neighbor_layerm->fill_surfaces.append(internal, stPosInternal | stDensSparse);
+                            expolygons_append(internal_solid, internal);
+                            // assign top and bottom surfaces to layer
+                            SurfaceType surface_types_solid[] = { stPosTop | stDensSolid, stPosBottom | stDensSolid, stPosBottom | stDensSolid | stModBridge };
+                            backup.keep_types(surface_types_solid, 3);
+                            //backup.keep_types_flag(stPosTop | stPosBottom);
+                            std::vector<SurfacesPtr> top_bottom_groups;
+                            backup.group(&top_bottom_groups);
+                            for (SurfacesPtr& group : top_bottom_groups) {
+                                neighbor_layerm->fill_surfaces.append(
+                                    diff_ex(to_expolygons(group), union_ex(internal_solid)),
+                                    // Use an existing surface as a template, it carries the bridge angle etc.
+                                    *group.front());
+                            }
                         }
-                    }
-                EXTERNAL:;
-                } // foreach type (stTop, stBottom, stBottomBridge)
-            } // for each layer
-        } // for each region
+                    EXTERNAL:;
+                    } // foreach type (stTop, stBottom, stBottomBridge)
+                } // for each layer
+            } // for each region
+        });
+        m_print->throw_if_canceled();
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
         for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
@@ -3616,11 +4178,16 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
             }
 
             // loop through layers to which we have assigned layers to combine
-            for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++layer_idx) {
+            // The combined layer ranges are disjoint, so they are processed in parallel.
+            std::vector<size_t> combined_layers;
+            for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++layer_idx)
+                if (combine[layer_idx] > 1)
+                    combined_layers.emplace_back(layer_idx);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, combined_layers.size()), [this, region, region_id, &combine, &combined_layers](const tbb::blocked_range<size_t> &range) {
+            for (size_t combined_idx = range.begin(); combined_idx < range.end(); ++combined_idx) {
                 m_print->throw_if_canceled();
-                size_t num_layers = combine[layer_idx];
-                if (num_layers <= 1)
-                    continue;
+                const size_t layer_idx  = combined_layers[combined_idx];
+                const size_t num_layers = combine[layer_idx];
                 // Get all the LayerRegion objects to be combined.
                 std::vector<LayerRegion*> layerms;
                 layerms.reserve(num_layers);
@@ -3684,6 +4251,8 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
                     }
                 }
             }
+            });
+            m_print->throw_if_canceled();
         }
     }
 
@@ -3698,10 +4267,13 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
         bool seam, EnforcerBlockerType type, std::vector<ExPolygons>& expolys) const
     {
         for (const ModelVolume* mv : this->model_object()->volumes) {
+            // Don't extract the facets of the volumes, which will be skipped anyway.
+            if (!mv->is_model_part() || (seam ? mv->seam_facets.empty() : mv->supported_facets.empty()))
+                continue;
             const indexed_triangle_set custom_facets = seam
                 ? mv->seam_facets.get_facets(*mv, type)
                 : mv->supported_facets.get_facets(*mv, type);
-            if (!mv->is_model_part() || custom_facets.indices.empty())
+            if (custom_facets.indices.empty())
                 continue;
 
             const Transform3f& tr1 = mv->get_matrix().cast<float>();
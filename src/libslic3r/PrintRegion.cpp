@@ -138,4 +138,35 @@ void PrintRegion::collect_object_printing_extruders(std::set<uint16_t> &object_e
         collect_object_printing_extruders(print()->config(), obj->config(), this->config(), object_extruders);
 }
 
+// Options which have to be equal for Layer::make_perimeters() to merge two regions.
+/// !!! add here the settings you want to be added in the per-object menu.
+/// if you don't do that, objects will share the same region, and the same settings.
+static const t_config_option_keys s_perimeter_config_keys {
+    "perimeter_extruder", "perimeters",
+    "external_perimeter_extrusion_width", "external_perimeter_overlap", "external_perimeter_speed",
+    "external_perimeters_first", "external_perimeters_hole", "external_perimeters_nothole", "external_perimeters_vase",
+    "extra_perimeters_odd_layers", "extra_perimeters_overhangs",
+    "gap_fill", "gap_fill_last", "gap_fill_min_area", "gap_fill_overlap", "gap_fill_speed",
+    "infill_dense", "infill_dense_algo", "no_perimeter_unsupported_algo",
+    "only_one_perimeter_top", "only_one_perimeter_top_other_algo",
+    "overhangs_width_speed", "overhangs_width", "overhangs_reverse", "overhangs_reverse_threshold",
+    "perimeter_extrusion_width", "perimeter_loop", "perimeter_loop_seam", "perimeter_overlap", "perimeter_speed",
+    "small_perimeter_speed", "small_perimeter_min_length", "small_perimeter_max_length",
+    "thin_walls", "thin_walls_min_width", "thin_walls_overlap", "thin_perimeters", "thin_perimeters_all", "thin_walls_speed",
+    "infill_overlap"
+};
+
+void PrintRegion::update_perimeter_config_key()
+{
+    m_perimeter_config_key.clear();
+    for (const t_config_option_key &key : s_perimeter_config_keys) {
+        const ConfigOption *opt = m_config.option(key);
+        assert(opt != nullptr);
+        m_perimeter_config_key += opt->serialize();
+        // separator, so that "1"+"23" differs from "12"+"3"
+        m_perimeter_config_key += '\n';
+    }
+    m_perimeter_config_hash = std::hash<std::string>()(m_perimeter_config_key);
+}
+
 }
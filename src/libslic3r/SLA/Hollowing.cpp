@@ -1,3 +1,4 @@
+#include <cmath>
 #include <functional>
 
 #include <libslic3r/OpenVDBUtils.hpp>
@@ -26,16 +27,22 @@ inline void _scale(S s, TriangleMesh &m) { m.scale(float(s)); }
 template<class S, class = FloatingOnly<S>>
 inline void _scale(S s, Contour3D &m) { for (auto &p : m.points) p *= s; }
 
+struct InteriorGridCache::Grid
+{
+    openvdb::FloatGrid::Ptr grid;
+    double voxel_scale;
+    // Narrow band of the grid, in voxels.
+    float  out_range;
+    float  in_range;
+};
+
 static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
                                        const JobController &ctl,
                                        double               min_thickness,
                                        double               voxel_scale,
-                                       double               closing_dist)
+                                       double               closing_dist,
+                                       InteriorGridCache   *cache)
 {
-    TriangleMesh imesh{mesh};
-    
-    _scale(voxel_scale, imesh);
-    
     double offset = voxel_scale * min_thickness;
     double D = voxel_scale * closing_dist;
     float  out_range = 0.1f * float(offset);
@@ -44,7 +51,24 @@ static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
     if (ctl.stopcondition()) return {};
     else ctl.statuscb(0, L("Hollowing"));
     
-    auto gridptr = mesh_to_grid(imesh, {}, out_range, in_range);
+    // The grid of a previous call is reused if its band holds the iso surface
+    // of the new offset. The grid itself is not modified below.
+    openvdb::FloatGrid::Ptr gridptr;
+    if (cache && cache->grid && cache->grid->voxel_scale == voxel_scale &&
+        cache->grid->out_range >= out_range && cache->grid->in_range >= in_range) {
+        gridptr = cache->grid->grid;
+        BOOST_LOG_TRIVIAL(debug) << "Hollowing: reusing the cached level set";
+    } else {
+        TriangleMesh imesh{mesh};
+        _scale(voxel_scale, imesh);
+        gridptr = mesh_to_grid(imesh, {}, out_range, in_range);
+        if (cache) {
+            if (gridptr)
+                cache->grid = std::make_shared<InteriorGridCache::Grid>(InteriorGridCache::Grid{ gridptr, voxel_scale, out_range, in_range });
+            else
+                cache->clear();
+        }
+    }
     
     assert(gridptr);
     
@@ -79,10 +103,13 @@ static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
 
 std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &   mesh,
                                                 const HollowingConfig &hc,
-                                                const JobController &  ctl)
+                                                const JobController &  ctl,
+                                                InteriorGridCache *    cache)
 {
     static const double MIN_OVERSAMPL = 3.;
     static const double MAX_OVERSAMPL = 8.;
+    // About a gigabyte of level set voxels.
+    static const double MAX_VOXELS    = 2e8;
         
     // I can't figure out how to increase the grid resolution through openvdb
     // API so the model will be scaled up before conversion and the result
@@ -92,9 +119,27 @@ std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &   mesh,
     //
     // max 8x upscale, min is native voxel size
     auto voxel_scale = MIN_OVERSAMPL + (MAX_OVERSAMPL - MIN_OVERSAMPL) * hc.quality;
+    
+    // The level set is a narrow band around the surface, its voxel count
+    // grows with the surface area times the band width times the cube of the
+    // voxel scale. For large parts the voxel scale from the quality is
+    // reduced to keep the grid within the budget.
+    double area = 0.;
+    for (const stl_facet &f : mesh.stl.facet_start)
+        area += 0.5 * double((f.vertex[1] - f.vertex[0]).cross(f.vertex[2] - f.vertex[0]).norm());
+    
+    double band = 0.1 * hc.min_thickness + 1.1 * (hc.min_thickness + hc.closing_distance);
+    double voxels = area * band * std::pow(voxel_scale, 3);
+    if (voxels > MAX_VOXELS) {
+        double scale = std::max(1., std::cbrt(MAX_VOXELS / (area * band)));
+        BOOST_LOG_TRIVIAL(debug) << "Hollowing: voxel scale reduced from " << voxel_scale << " to " << scale
+                                 << " for a surface of " << area << " mm2";
+        voxel_scale = std::min(voxel_scale, scale);
+    }
+    
     auto meshptr = std::make_unique<TriangleMesh>(
         _generate_interior(mesh, ctl, hc.min_thickness, voxel_scale,
-                           hc.closing_distance));
+                           hc.closing_distance, cache));
     
     if (meshptr && !meshptr->empty()) {
         
@@ -60,9 +60,21 @@ using DrainHoles = std::vector<DrainHole>;
 
 constexpr float HoleStickOutLength = 1.f;
 
+// Level set of the mesh kept by generate_interior() between its calls on the
+// same mesh, so that a change of the thickness or of the closing distance only
+// redoes the offset and the meshing of the interior.
+struct InteriorGridCache
+{
+    struct Grid; // holds the OpenVDB grid, defined in Hollowing.cpp
+    std::shared_ptr<Grid> grid;
+
+    void clear() { grid.reset(); }
+};
+
 std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &mesh,
                                                 const HollowingConfig &  = {},
-                                                const JobController &ctl = {});
+                                                const JobController &ctl = {},
+                                                InteriorGridCache *cache = nullptr);
 
 void hollow_mesh(TriangleMesh &mesh, const HollowingConfig &cfg);
 
@@ -32,6 +32,15 @@ public:
                                                   s, dir, hit);
     }
 
+    void intersect_rays(const TriangleMesh& tm,
+                        const Vec3d *s, const Vec3d *dir, size_t n, igl::Hit *hits)
+    {
+        AABBTreeIndirect::intersect_ray_packet_first_hit(tm.its.vertices,
+                                                         tm.its.indices,
+                                                         m_tree,
+                                                         s, dir, n, hits);
+    }
+
     void intersect_ray(const TriangleMesh& tm,
                        const Vec3d& s, const Vec3d& dir, std::vector<igl::Hit>& hits)
     {
@@ -138,6 +147,41 @@ IndexedMesh::query_ray_hit(const Vec3d &s, const Vec3d &dir) const
     return ret;
 }
 
+std::vector<IndexedMesh::hit_result>
+IndexedMesh::query_ray_hit(const std::vector<Vec3d> &sources,
+                           const std::vector<Vec3d> &dirs) const
+{
+    assert(sources.size() == dirs.size());
+    std::vector<hit_result> outs;
+    outs.reserve(sources.size());
+
+#ifdef SLIC3R_HOLE_RAYCASTER
+    if (! m_holes.empty()) {
+        for (size_t i = 0; i < sources.size(); ++ i)
+            outs.emplace_back(query_ray_hit(sources[i], dirs[i]));
+        return outs;
+    }
+#endif
+
+    std::vector<igl::Hit> hits(sources.size());
+    m_aabb->intersect_rays(*m_tm, sources.data(), dirs.data(), sources.size(), hits.data());
+
+    for (size_t i = 0; i < sources.size(); ++ i) {
+        assert(is_approx(dirs[i].norm(), 1.));
+        const igl::Hit &hit = hits[i];
+        outs.emplace_back(IndexedMesh::hit_result(*this));
+        outs.back().m_t = double(hit.t);
+        outs.back().m_dir = dirs[i];
+        outs.back().m_source = sources[i];
+        if(!std::isinf(hit.t) && !std::isnan(hit.t)) {
+            outs.back().m_normal = this->normal_by_face_id(hit.id);
+            outs.back().m_face_id = hit.id;
+        }
+    }
+
+    return outs;
+}
+
 std::vector<IndexedMesh::hit_result>
 IndexedMesh::query_ray_hits(const Vec3d &s, const Vec3d &dir) const
 {
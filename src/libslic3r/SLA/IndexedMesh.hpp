@@ -116,6 +116,12 @@ public:
 
     // Casting a ray on the mesh, returns the distance where the hit occures.
     hit_result query_ray_hit(const Vec3d &s, const Vec3d &dir) const;
+
+    // Casting a bundle of rays on the mesh at once, returns the first hit of
+    // each ray. The rays traverse the AABB tree together, which is faster
+    // than casting them one by one if they are coherent.
+    std::vector<hit_result> query_ray_hit(const std::vector<Vec3d> &sources,
+                                          const std::vector<Vec3d> &dirs) const;
     
     // Casts a ray on the mesh and returns all hits
     std::vector<hit_result> query_ray_hits(const Vec3d &s, const Vec3d &dir) const;
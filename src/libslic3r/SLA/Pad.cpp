@@ -2,6 +2,7 @@
 #include <libslic3r/SLA/SpatIndex.hpp>
 #include <libslic3r/SLA/BoostAdapter.hpp>
 #include <libslic3r/SLA/Contour3D.hpp>
+#include <libslic3r/SLA/Concurrency.hpp>
 
 #include "ConcaveHull.hpp"
 
@@ -383,54 +384,69 @@ bool add_cavity(Contour3D &pad, ExPolygon &top_poly, const PadConfig3D &cfg,
     return true;
 }
 
-Contour3D create_outer_pad_geometry(const ExPolygons & skeleton,
-                                    const PadConfig3D &cfg,
-                                    ThrowOnCancel      thr)
+Contour3D create_outer_pad_part(const ExPolygon &  pad_part,
+                                const PadConfig3D &cfg,
+                                ThrowOnCancel      thr)
 {
     Contour3D ret;
 
-    for (const ExPolygon &pad_part : skeleton) {
-        ExPolygon top_poly{pad_part};
-        ExPolygon bottom_poly =
-            offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
+    ExPolygon top_poly{pad_part};
+    ExPolygon bottom_poly =
+        offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
 
-        if (bottom_poly.empty()) continue;
-        thr();
-        
-        double z_min = -cfg.height, z_max = 0;
-        ret.merge(walls(top_poly.contour, bottom_poly.contour, z_max, z_min));
+    if (bottom_poly.empty()) return ret;
+    thr();
 
-        if (cfg.wing_height > 0. && add_cavity(ret, top_poly, cfg, thr))
-            z_max = -cfg.wing_height;
+    double z_min = -cfg.height, z_max = 0;
+    ret.merge(walls(top_poly.contour, bottom_poly.contour, z_max, z_min));
 
-        for (auto &h : bottom_poly.holes)
-            ret.merge(straight_walls(h, z_max, z_min));
-        
-        ret.merge(triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
-        ret.merge(triangulate_expolygon_3d(top_poly, NORMALS_UP));
-    }
+    if (cfg.wing_height > 0. && add_cavity(ret, top_poly, cfg, thr))
+        z_max = -cfg.wing_height;
+
+    for (auto &h : bottom_poly.holes)
+        ret.merge(straight_walls(h, z_max, z_min));
+
+    ret.merge(triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
+    ret.merge(triangulate_expolygon_3d(top_poly, NORMALS_UP));
 
     return ret;
 }
 
-Contour3D create_inner_pad_geometry(const ExPolygons & skeleton,
-                                    const PadConfig3D &cfg,
-                                    ThrowOnCancel      thr)
+Contour3D create_inner_pad_part(const ExPolygon &  pad_part,
+                                const PadConfig3D &cfg,
+                                ThrowOnCancel      thr)
 {
     Contour3D ret;
 
     double z_max = 0., z_min = -cfg.height;
-    for (const ExPolygon &pad_part : skeleton) {
-        thr();
-        ret.merge(straight_walls(pad_part.contour, z_max, z_min));
+    thr();
+    ret.merge(straight_walls(pad_part.contour, z_max, z_min));
 
-        for (auto &h : pad_part.holes)
-            ret.merge(straight_walls(h, z_max, z_min));
-    
-        ret.merge(triangulate_expolygon_3d(pad_part, z_min, NORMALS_DOWN));
-        ret.merge(triangulate_expolygon_3d(pad_part, z_max, NORMALS_UP));
+    for (auto &h : pad_part.holes)
+        ret.merge(straight_walls(h, z_max, z_min));
+
+    ret.merge(triangulate_expolygon_3d(pad_part, z_min, NORMALS_DOWN));
+    ret.merge(triangulate_expolygon_3d(pad_part, z_max, NORMALS_UP));
+
+    return ret;
+}
+
+// Merges the meshes in their order into a single buffer allocated upfront.
+Contour3D merge_pad_parts(const std::vector<Contour3D> &parts)
+{
+    size_t num_points = 0, num_faces3 = 0, num_faces4 = 0;
+    for (const Contour3D &part : parts) {
+        num_points += part.points.size();
+        num_faces3 += part.faces3.size();
+        num_faces4 += part.faces4.size();
     }
 
+    Contour3D ret;
+    ret.points.reserve(num_points);
+    ret.faces3.reserve(num_faces3);
+    ret.faces4.reserve(num_faces4);
+    for (const Contour3D &part : parts) ret.merge(part);
+
     return ret;
 }
 
@@ -445,9 +461,19 @@ Contour3D create_pad_geometry(const PadSkeleton &skelet,
     svg.Close();
 #endif
 
+    // The islands of the skeleton are independent, their meshes are
+    // generated in parallel and merged in the order of the skeleton.
     PadConfig3D cfg3d(cfg);
-    return create_outer_pad_geometry(skelet.outer, cfg3d, thr)
-        .merge(create_inner_pad_geometry(skelet.inner, cfg3d, thr));
+    const size_t num_outer = skelet.outer.size();
+    std::vector<Contour3D> parts(num_outer + skelet.inner.size());
+    ccr::for_each(size_t(0), parts.size(),
+                  [&skelet, &cfg3d, &thr, &parts, num_outer](size_t i) {
+        parts[i] = i < num_outer ?
+            create_outer_pad_part(skelet.outer[i], cfg3d, thr) :
+            create_inner_pad_part(skelet.inner[i - num_outer], cfg3d, thr);
+    });
+
+    return merge_pad_parts(parts);
 }
 
 Contour3D create_pad_geometry(const ExPolygons &supp_bp,
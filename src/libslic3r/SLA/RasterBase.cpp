@@ -1,10 +1,14 @@
 #ifndef SLARASTER_CPP
 #define SLARASTER_CPP
 
+#include <algorithm>
 #include <functional>
+#include <iterator>
+#include <memory>
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
+#include <libslic3r/SLA/ScanlineRaster.hpp>
 
 // minz image write:
 #include <miniz.h>
@@ -38,6 +42,81 @@ EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "png");
 }
 
+EncodedRaster FastPNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
+                                               size_t      num_components)
+{
+    static const uint8_t color_types[] = { 0, 0, 4, 2, 6 };
+    if (num_components < 1 || num_components > 4) return EncodedRaster({}, "png");
+
+    std::vector<uint8_t> buf;
+
+    auto put_u32 = [](std::vector<uint8_t> &out, uint32_t v) {
+        for (int i = 3; i >= 0; --i) out.emplace_back(uint8_t(v >> (8 * i)));
+    };
+    // Appends a chunk, the data of which was already appended to buf after
+    // the length and the type.
+    auto finish_chunk = [&buf, &put_u32](size_t chunk_start) {
+        size_t len = buf.size() - chunk_start - 8;
+        for (int i = 0; i < 4; ++i)
+            buf[chunk_start + size_t(i)] = uint8_t(len >> (8 * (3 - i)));
+        auto crc = mz_crc32(MZ_CRC32_INIT, buf.data() + chunk_start + 4, len + 4);
+        put_u32(buf, uint32_t(crc));
+    };
+    auto start_chunk = [&buf](const char *type) {
+        size_t chunk_start = buf.size();
+        buf.insert(buf.end(), 4, 0);
+        buf.insert(buf.end(), type, type + 4);
+        return chunk_start;
+    };
+
+    static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+    buf.insert(buf.end(), std::begin(signature), std::end(signature));
+
+    size_t chunk = start_chunk("IHDR");
+    put_u32(buf, uint32_t(w));
+    put_u32(buf, uint32_t(h));
+    buf.insert(buf.end(), { 8, color_types[num_components], 0, 0, 0 });
+    finish_chunk(chunk);
+
+    chunk = start_chunk("IDAT");
+    auto putter = [](const void *data, int len, void *user) -> mz_bool {
+        auto out = static_cast<std::vector<uint8_t>*>(user);
+        auto bytes = static_cast<const uint8_t*>(data);
+        out->insert(out->end(), bytes, bytes + len);
+        return MZ_TRUE;
+    };
+    std::unique_ptr<tdefl_compressor> comp(new tdefl_compressor);
+    if (tdefl_init(comp.get(), putter, &buf,
+                   1 | TDEFL_WRITE_ZLIB_HEADER | TDEFL_GREEDY_PARSING_FLAG | TDEFL_RLE_MATCHES) != TDEFL_STATUS_OKAY)
+        return EncodedRaster({}, "png");
+
+    const size_t bpl = w * num_components;
+    auto pixels = static_cast<const uint8_t *>(ptr);
+    std::vector<uint8_t> row(bpl + 1);
+    // Filter type 2 (Up): the difference to the pixel above.
+    row[0] = 2;
+    for (size_t y = 0; y < h; ++y) {
+        const uint8_t *curr = pixels + y * bpl;
+        if (y == 0)
+            std::copy(curr, curr + bpl, row.begin() + 1);
+        else {
+            const uint8_t *prev = curr - bpl;
+            for (size_t x = 0; x < bpl; ++x)
+                row[x + 1] = uint8_t(curr[x] - prev[x]);
+        }
+        if (tdefl_compress_buffer(comp.get(), row.data(), row.size(), TDEFL_NO_FLUSH) != TDEFL_STATUS_OKAY)
+            return EncodedRaster({}, "png");
+    }
+    if (tdefl_compress_buffer(comp.get(), nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE)
+        return EncodedRaster({}, "png");
+    finish_chunk(chunk);
+
+    chunk = start_chunk("IEND");
+    finish_chunk(chunk);
+
+    return EncodedRaster(std::move(buf), "png");
+}
+
 std::ostream &operator<<(std::ostream &stream, const EncodedRaster &bytes)
 {
     stream.write(reinterpret_cast<const char *>(bytes.data()),
@@ -67,6 +146,71 @@ EncodedRaster PPMRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "ppm");
 }
 
+static const char RLEMagic[] = {'R', 'L', 'E', '1'};
+
+EncodedRaster RLERasterEncoder::operator()(const void *ptr, size_t w, size_t h,
+                                           size_t      num_components)
+{
+    std::vector<uint8_t> buf;
+    
+    auto put_u32 = [&buf](uint32_t v) {
+        for (int i = 0; i < 4; ++i) buf.emplace_back(uint8_t(v >> (8 * i)));
+    };
+    
+    buf.insert(buf.end(), std::begin(RLEMagic), std::end(RLEMagic));
+    put_u32(uint32_t(w));
+    put_u32(uint32_t(h));
+    
+    // Only the first channel is encoded.
+    auto   px = static_cast<const std::uint8_t*>(ptr);
+    size_t n  = w * h;
+    for (size_t i = 0; i < n;) {
+        uint8_t v   = px[i * num_components];
+        size_t  run = 1;
+        while (i + run < n && px[(i + run) * num_components] == v) ++run;
+        i += run;
+        
+        buf.emplace_back(v);
+        for (; run >= 0x80; run >>= 7) buf.emplace_back(uint8_t(run | 0x80));
+        buf.emplace_back(uint8_t(run));
+    }
+    
+    return EncodedRaster(std::move(buf), "rle");
+}
+
+bool decode_rle_raster(const void *ptr, size_t size, std::vector<uint8_t> &pixels, size_t &w, size_t &h)
+{
+    auto data = static_cast<const std::uint8_t*>(ptr);
+    if (size < 12 || ! std::equal(std::begin(RLEMagic), std::end(RLEMagic), data))
+        return false;
+    
+    auto get_u32 = [data](size_t offset) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= uint32_t(data[offset + i]) << (8 * i);
+        return v;
+    };
+    
+    w = get_u32(4);
+    h = get_u32(8);
+    pixels.clear();
+    pixels.reserve(w * h);
+    
+    for (size_t i = 12; i < size;) {
+        uint8_t v   = data[i ++];
+        size_t  run = 0;
+        for (int shift = 0;; shift += 7) {
+            if (i == size || shift > 56) return false;
+            uint8_t b = data[i ++];
+            run |= size_t(b & 0x7f) << shift;
+            if (! (b & 0x80)) break;
+        }
+        if (run > w * h - pixels.size()) return false;
+        pixels.insert(pixels.end(), run, v);
+    }
+    
+    return pixels.size() == w * h;
+}
+
 std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     const RasterBase::Resolution &res,
     const RasterBase::PixelDim &  pxdim,
@@ -83,6 +227,23 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     return rst;
 }
 
+std::unique_ptr<RasterBase> create_raster_grayscale_scanline(
+    const RasterBase::Resolution &res,
+    const RasterBase::PixelDim &  pxdim,
+    double                        gamma,
+    const RasterBase::Trafo &     tr,
+    size_t                        supersampling)
+{
+    std::unique_ptr<RasterBase> rst;
+    
+    if (gamma > 0)
+        rst = std::make_unique<RasterGrayscaleScanline>(res, pxdim, tr, agg::gamma_power(gamma), supersampling);
+    else
+        rst = std::make_unique<RasterGrayscaleScanline>(res, pxdim, tr, agg::gamma_threshold(.5), supersampling);
+    
+    return rst;
+}
+
 } // namespace sla
 } // namespace Slic3r
 
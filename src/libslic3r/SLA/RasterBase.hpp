@@ -22,18 +22,20 @@ template<class T> using wkptr = std::weak_ptr<T>;
 namespace sla {
 
 // Raw byte buffer paired with its size. Suitable for compressed image data.
+// The buffer is immutable and shared by the copies, so that identical layers
+// do not keep their image twice.
 class EncodedRaster {
 protected:
-    std::vector<uint8_t> m_buffer;
+    std::shared_ptr<const std::vector<uint8_t>> m_buffer;
     std::string m_ext;
 public:
     EncodedRaster() = default;
     explicit EncodedRaster(std::vector<uint8_t> &&buf, std::string ext)
-        : m_buffer(std::move(buf)), m_ext(std::move(ext))
+        : m_buffer(std::make_shared<const std::vector<uint8_t>>(std::move(buf))), m_ext(std::move(ext))
     {}
     
-    size_t size() const { return m_buffer.size(); }
-    const void * data() const { return m_buffer.data(); }
+    size_t size() const { return m_buffer ? m_buffer->size() : 0; }
+    const void * data() const { return m_buffer ? m_buffer->data() : nullptr; }
     const char * extension() const { return m_ext.c_str(); }
 };
 
@@ -106,10 +108,30 @@ struct PNGRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
 
+// PNG encoder tuned for the mostly flat layer images: every row uses the "Up"
+// filter, which turns the rows repeating the previous one into zeros, and the
+// deflate stream only looks for runs of the same byte. Several times faster
+// than PNGRasterEncoder for a slightly larger output.
+struct FastPNGRasterEncoder {
+    EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
+};
+
 struct PPMRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
 
+// Run-length encoded 8 bit grayscale image with the "rle" extension:
+// "RLE1" magic, u32 width, u32 height (little endian), followed by the runs
+// of the pixels in row major order, each run as its value byte and its length
+// as an unsigned LEB128 number. The runs continue across the rows.
+struct RLERasterEncoder {
+    EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
+};
+
+// Decodes the output of RLERasterEncoder into w x h pixels, returns false if
+// the buffer is not a valid RLE raster.
+bool decode_rle_raster(const void *ptr, size_t size, std::vector<uint8_t> &pixels, size_t &w, size_t &h);
+
 std::ostream& operator<<(std::ostream &stream, const EncodedRaster &bytes);
 
 // If gamma is zero, thresholding will be performed which disables AA.
@@ -119,6 +141,16 @@ uqptr<RasterBase> create_raster_grayscale_aa(
     double                        gamma = 1.0,
     const RasterBase::Trafo &     tr    = {});
 
+// Same output as create_raster_grayscale_aa() but the polygons are filled by
+// the scanline rasterizer of ScanlineRaster.hpp, sampling each pixel row at
+// supersampling sub-scanlines.
+uqptr<RasterBase> create_raster_grayscale_scanline(
+    const RasterBase::Resolution &res,
+    const RasterBase::PixelDim &  pxdim,
+    double                        gamma         = 1.0,
+    const RasterBase::Trafo &     tr            = {},
+    size_t                        supersampling = 8);
+
 }} // namespace Slic3r::sla
 
 #endif // SLARASTERBASE_HPP
@@ -11,6 +11,8 @@
 #include <libslic3r/Geometry.hpp>
 #include "Model.hpp"
 
+#include <atomic>
+#include <numeric>
 #include <thread>
 
 namespace Slic3r { namespace sla {
@@ -77,12 +79,13 @@ struct Facestats {
 inline const Vec3d DOWN = {0., 0., -1.};
 constexpr double POINTS_PER_UNIT_AREA = 1.;
 
-// The score function for a particular face
-inline double get_score(const Facestats &fc)
+// The score function for a face with the given area and the z coordinate of
+// its normal
+inline double get_score(double area, double normal_z)
 {
     // Simply get the angle (acos of dot product) between the face normal and
     // the DOWN vector.
-    double phi = 1. - std::acos(fc.normal.dot(DOWN)) / PI;
+    double phi = 1. - std::acos(std::min(std::max(-normal_z, -1.), 1.)) / PI;
 
     // Only consider faces that have have slopes below 90 deg:
     phi = phi * (phi > 0.5);
@@ -91,7 +94,12 @@ inline double get_score(const Facestats &fc)
     phi = phi * phi * phi;
 
     // Multiply with the area of the current face
-    return fc.area * POINTS_PER_UNIT_AREA * phi;
+    return area * POINTS_PER_UNIT_AREA * phi;
+}
+
+inline double get_score(const Facestats &fc)
+{
+    return get_score(fc.area, fc.normal.z());
 }
 
 template<class AccessFn>
@@ -161,7 +169,142 @@ XYRotation from_transform3d(const Transform3d &tr)
     return {rot3d.x(), rot3d.y()};
 }
 
+// The faces of the mesh with the normals and areas cached in the model frame,
+// as these do not change with the rotation, only the z coordinates of the
+// rotated normals and vertices are needed by the score functions. The faces
+// are sorted by descending area, so that a partial score of the biggest faces
+// is early known to be worse than the best score found so far.
+class RotfinderMesh {
+    const TriangleMesh &m_mesh;
+    std::vector<size_t> m_faces;
+    std::vector<Vec3d>  m_normals;
+    std::vector<double> m_areas;
+    // Sum of the areas of the faces from the idx-th one to the last.
+    std::vector<double> m_remaining_area;
+
+public:
+    // The search for a single rotation is evaluated by this many chunks of
+    // faces, checking the bound after each one.
+    static constexpr size_t Chunks = 16;
+
+    explicit RotfinderMesh(const TriangleMesh &mesh) : m_mesh{mesh}
+    {
+        size_t facecount = mesh.its.indices.size();
+        std::vector<Vec3d>  normals(facecount);
+        std::vector<double> areas(facecount);
+        ccr_par::for_each(size_t(0), facecount, [&mesh, &normals, &areas](size_t fi) {
+            Facestats fc{get_triangle_vertices(mesh, fi)};
+            normals[fi] = fc.normal;
+            areas[fi]   = fc.area;
+        });
+
+        m_faces.resize(facecount);
+        std::iota(m_faces.begin(), m_faces.end(), size_t(0));
+        std::stable_sort(m_faces.begin(), m_faces.end(), [&areas](size_t a, size_t b) {
+            return areas[a] > areas[b];
+        });
+
+        m_normals.reserve(facecount);
+        m_areas.reserve(facecount);
+        for (size_t fi : m_faces) {
+            m_normals.emplace_back(normals[fi]);
+            m_areas.emplace_back(areas[fi]);
+        }
+
+        m_remaining_area.assign(facecount + 1, 0.);
+        for (size_t i = facecount; i > 0; --i)
+            m_remaining_area[i - 1] = m_remaining_area[i] + m_areas[i - 1];
+    }
+
+    size_t facecount() const { return m_faces.size(); }
+    const TriangleMesh &mesh() const { return m_mesh; }
+
+    // The sum of the scores of the faces for the rotation. The evaluation is
+    // stopped as soon as the score is known to be at least bound, a lower
+    // bound of the sum not less than bound is returned in that case. The
+    // scores of the faces are not lower than their minscore_factor multiple
+    // of their area.
+    template<class ScoreFn>
+    double sum_score(ScoreFn &&scorefn, double minscore_factor, double bound) const
+    {
+        size_t facecount = m_faces.size();
+        size_t chunksize = std::max(facecount / Chunks, size_t(1));
+        double score = 0.;
+        for (size_t from = 0; from < facecount; from += chunksize) {
+            size_t to = std::min(from + chunksize, facecount);
+            score += ccr_par::reduce(from, to, 0., std::plus<double>{}, scorefn,
+                                     std::max((to - from) / std::thread::hardware_concurrency(), size_t(1)));
+
+            double lower_bound = score + minscore_factor * POINTS_PER_UNIT_AREA * m_remaining_area[to];
+            if (to < facecount && lower_bound >= bound)
+                return lower_bound;
+        }
+
+        return score;
+    }
+
+    // Is the idx-th face below the z level after the rotation?
+    bool is_below(const Vec3d &rotated_z, size_t idx, double zlvl) const
+    {
+        const auto &face = m_mesh.its.indices[m_faces[idx]];
+        for (int k = 0; k < 3; ++k)
+            if (rotated_z.dot(m_mesh.its.vertices[face(k)].cast<double>()) > zlvl)
+                return false;
+        return true;
+    }
+
+    double normal_z(const Vec3d &rotated_z, size_t idx) const { return rotated_z.dot(m_normals[idx]); }
+    double area(size_t idx) const { return m_areas[idx]; }
+};
+
+// The direction of the model frame rotated onto the z axis by tr, the z
+// coordinate of a rotated vector is its dot product with it.
+inline Vec3d rotated_z(const Transform3d &tr)
+{
+    return tr.linear().row(Z).transpose();
+}
+
+// Same as get_model_supportedness() for a rotation, not normalized by the
+// number of faces. Stops as soon as the result is known to be at least bound.
+double get_rotation_supportedness(const RotfinderMesh &rmesh,
+                                  const Transform3d &  tr,
+                                  double               bound = std::numeric_limits<double>::max())
+{
+    Vec3d rz = rotated_z(tr);
+    auto accessfn = [&rmesh, &rz](size_t i) {
+        return get_score(rmesh.area(i), rmesh.normal_z(rz, i));
+    };
+
+    return rmesh.sum_score(accessfn, 0., bound);
+}
+
+// Same as get_model_supportedness_onfloor() for a rotation, not normalized by
+// the number of faces. Stops as soon as the result is known to be at least
+// bound.
+double get_rotation_supportedness_onfloor(const RotfinderMesh &rmesh,
+                                          const Transform3d &  tr,
+                                          double               bound = std::numeric_limits<double>::max())
+{
+    size_t Nthreads = std::thread::hardware_concurrency();
+
+    double zmin = find_ground_level(rmesh.mesh(), tr, Nthreads);
+    double zlvl = zmin + 0.1; // Set up a slight tolerance from z level
+
+    Vec3d rz = rotated_z(tr);
+    auto accessfn = [&rmesh, &rz, zlvl](size_t i) {
+        if (rmesh.is_below(rz, i, zlvl))
+            return -rmesh.area(i) * POINTS_PER_UNIT_AREA;
+
+        return get_score(rmesh.area(i), rmesh.normal_z(rz, i));
+    };
+
+    // A face lying on the floor scores its negative area.
+    return rmesh.sum_score(accessfn, -1., bound);
+}
+
 // Find the best score from a set of function inputs. Evaluate for every point.
+// The inputs are evaluated concurrently, the score function gets the best
+// score found so far as a bound to stop the evaluation of worse inputs early.
 template<size_t N, class Fn, class It, class StopCond>
 std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
 {
@@ -173,11 +316,18 @@ std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
     size_t dist = std::distance(from, to);
     std::vector<double> scores(dist, score);
 
-    ccr_par::for_each(size_t(0), dist, [&stopfn, &scores, &fn, &from](size_t i) {
+    std::atomic<double> best{score};
+    auto update_best = [&best](double s) {
+        double b = best.load();
+        while (s < b && !best.compare_exchange_weak(b, s));
+    };
+
+    ccr_par::for_each(size_t(0), dist, [&stopfn, &scores, &fn, &from, &best, &update_best](size_t i) {
         if (stopfn()) return;
 
-        scores[i] = fn(*(from + i));
-    }, dist / Nthreads);
+        scores[i] = fn(*(from + i), best.load());
+        update_best(scores[i]);
+    }, std::max(dist / Nthreads, size_t(1)));
 
     auto it = std::min_element(scores.begin(), scores.end());
 
@@ -253,8 +403,12 @@ Vec2d find_best_rotation(const SLAPrintObject &        po,
     TriangleMesh mesh = po.model_object()->raw_mesh();
     mesh.require_shared_vertices();
 
+    if (mesh.its.indices.empty()) return {0., 0.};
+
+    RotfinderMesh rmesh{mesh};
+
     // To keep track of the number of iterations
-    unsigned status = 0;
+    std::atomic<unsigned> status{0};
 
     // The maximum number of iterations
     auto max_tries = unsigned(accuracy * MAX_TRIES);
@@ -276,10 +430,10 @@ Vec2d find_best_rotation(const SLAPrintObject &        po,
         // If the model can be placed on the bed directly, we only need to
         // check the 3D convex hull face rotations.
 
-        auto objfn = [&mesh, &statusfn](const XYRotation &rot) {
+        auto objfn = [&rmesh, &statusfn](const XYRotation &rot, double bound) {
             statusfn();
             Transform3d tr = to_transform3d(rot);
-            return get_model_supportedness_onfloor(mesh, tr);
+            return get_rotation_supportedness_onfloor(rmesh, tr, bound);
         };
 
         rot = find_min_score<2>(objfn, inputs.begin(), inputs.end(), stopcond);
@@ -296,11 +450,17 @@ Vec2d find_best_rotation(const SLAPrintObject &        po,
         // We can specify the bounds for a dimension in the following way:
         auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
 
+        // The grid is evaluated in sequence, the best score so far is the
+        // bound for the next rotation. A stopped evaluation returns a score
+        // not lower than the best one, which is thus never considered.
+        double best = std::numeric_limits<double>::max();
         auto result = solver.to_min().optimize(
-            [&mesh, &statusfn] (const XYRotation &rot)
+            [&rmesh, &statusfn, &best] (const XYRotation &rot)
             {
                 statusfn();
-                return get_model_supportedness(mesh, to_transform3d(rot));
+                double score = get_rotation_supportedness(rmesh, to_transform3d(rot), best);
+                best = std::min(best, score);
+                return score;
             }, opt::initvals({0., 0.}), bounds);
 
         // Save the result and fck off
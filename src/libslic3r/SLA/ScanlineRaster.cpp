@@ -0,0 +1,215 @@
+#include <libslic3r/SLA/ScanlineRaster.hpp>
+#include <libslic3r/SLA/AGGRaster.hpp>
+
+namespace Slic3r { namespace sla {
+
+// Horizontal coverage is computed in fixed point with this many units per pixel.
+static constexpr int SubpixelShift = 8;
+static constexpr int SubpixelScale = 1 << SubpixelShift;
+
+static Vec2d coords(const Point &p) { return p.cast<double>(); }
+static Vec2d coords(const ClipperLib::IntPoint &p) { return {double(p.X), double(p.Y)}; }
+
+RasterGrayscaleScanline::RasterGrayscaleScanline(const Resolution &res,
+                                                 const PixelDim &  pd,
+                                                 const Trafo &     trafo,
+                                                 size_t            supersampling)
+    : m_resolution(res)
+    , m_pxdim_scaled(SCALING_FACTOR / pd.w_mm, SCALING_FACTOR / pd.h_mm)
+    , m_trafo(trafo)
+    , m_supersampling(std::max(supersampling, size_t(1)))
+    , m_full_cover(int32_t(m_supersampling) * SubpixelScale)
+    , m_buf(res.pixels(), uint8_t(0))
+    , m_cover(res.width_px + 1, 0)
+    , m_delta(res.width_px + 1, 0)
+    , m_touched_mask(res.width_px + 1, false)
+{}
+
+template<class PointVec> void RasterGrayscaleScanline::add_path(const PointVec &v)
+{
+    if (v.size() < 2) return;
+
+    // Same transformation as AGGRaster::to_path().
+    auto to_px = [this](const auto &p) {
+        Vec2d  c = coords(p);
+        double x = c.x() * m_pxdim_scaled.w_mm;
+        double y = c.y() * m_pxdim_scaled.h_mm;
+        if (m_trafo.flipXY) {
+            x = c.y() * m_pxdim_scaled.h_mm;
+            y = c.x() * m_pxdim_scaled.w_mm;
+        }
+        x += m_trafo.center_x * m_pxdim_scaled.w_mm;
+        y += m_trafo.center_y * m_pxdim_scaled.h_mm;
+        if (m_trafo.mirror_x) x = double(m_resolution.width_px) - x;
+        if (m_trafo.mirror_y) y = double(m_resolution.height_px) - y;
+        return Vec2d(x, y);
+    };
+
+    Vec2d prev = to_px(v.back());
+    for (const auto &p : v) {
+        Vec2d pt = to_px(p);
+        if (pt.y() != prev.y()) {
+            const Vec2d &top = pt.y() < prev.y() ? pt : prev;
+            const Vec2d &bot = pt.y() < prev.y() ? prev : pt;
+            m_edges.push_back({top.y(), bot.y(), top.x(),
+                               (bot.x() - top.x()) / (bot.y() - top.y()),
+                               pt.y() > prev.y() ? 1 : -1});
+        }
+        prev = pt;
+    }
+}
+
+void RasterGrayscaleScanline::fill()
+{
+    if (m_edges.empty()) return;
+
+    double y_min = m_edges.front().y_top, y_max = m_edges.front().y_bottom;
+    for (const Edge &e : m_edges) {
+        y_min = std::min(y_min, e.y_top);
+        y_max = std::max(y_max, e.y_bottom);
+    }
+
+    const auto   W       = int(m_resolution.width_px);
+    const int    W_fixed = W * SubpixelScale;
+    const size_t S       = m_supersampling;
+    const int    row_begin = std::max(0, int(std::floor(y_min)));
+    const int    row_end   = std::min(int(m_resolution.height_px), int(std::ceil(y_max)));
+
+    if (row_begin >= row_end) {
+        m_edges.clear();
+        return;
+    }
+
+    // Sparse edge table: the edges bucketed by the row they start at, by a
+    // counting sort as the polygons may have many thousands of edges.
+    const size_t rows = size_t(row_end - row_begin);
+    auto edge_row = [row_begin, rows](const Edge &e) {
+        return size_t(std::min(std::max(int(std::floor(e.y_top)) - row_begin, 0), int(rows)));
+    };
+    m_edge_table.assign(rows + 2, 0);
+    for (const Edge &e : m_edges) ++m_edge_table[edge_row(e) + 1];
+    for (size_t r = 1; r < m_edge_table.size(); ++r) m_edge_table[r] += m_edge_table[r - 1];
+    m_sorted_edges.resize(m_edges.size());
+    m_edge_table_pos.assign(m_edge_table.begin(), m_edge_table.end() - 1);
+    for (const Edge &e : m_edges) m_sorted_edges[m_edge_table_pos[edge_row(e)]++] = e;
+
+    m_active.clear();
+    m_pending.clear();
+
+    for (int row = row_begin; row < row_end; ++row) {
+        size_t r = size_t(row - row_begin);
+        m_pending.insert(m_pending.end(), m_sorted_edges.begin() + m_edge_table[r],
+                         m_sorted_edges.begin() + m_edge_table[r + 1]);
+
+        for (size_t k = 0; k < S; ++k) {
+            const double ys = row + (k + 0.5) / double(S);
+
+            for (size_t i = 0; i < m_active.size();)
+                if (m_active[i].y_bottom <= ys) {
+                    m_active[i] = m_active.back();
+                    m_active.pop_back();
+                } else
+                    ++i;
+            for (size_t i = 0; i < m_pending.size();) {
+                const Edge &e = m_pending[i];
+                if (e.y_top <= ys) {
+                    if (e.y_bottom > ys)
+                        m_active.push_back({(e.x_top + (ys - e.y_top) * e.dxdy) * SubpixelScale,
+                                            e.dxdy * SubpixelScale / double(S), e.y_bottom, e.winding});
+                    m_pending[i] = m_pending.back();
+                    m_pending.pop_back();
+                } else
+                    ++i;
+            }
+
+            if (m_active.empty()) continue;
+
+            // The crossings of the sub-scanline, sorted by insertion as there
+            // are only a few of them.
+            m_crossings.clear();
+            for (ActiveEdge &e : m_active) {
+                std::pair<int, int> c(int(std::min(std::max(e.x, 0.), double(W_fixed)) + 0.5), e.winding);
+                e.x += e.dx;
+                m_crossings.push_back(c);
+                for (size_t i = m_crossings.size() - 1; i > 0 && c.first < m_crossings[i - 1].first; --i)
+                    std::swap(m_crossings[i], m_crossings[i - 1]);
+            }
+
+            int winding = 0, span_begin = 0;
+            for (const std::pair<int, int> &c : m_crossings) {
+                int prev_winding = winding;
+                winding += c.second;
+                if (prev_winding == 0 && winding != 0) {
+                    span_begin = c.first;
+                } else if (prev_winding != 0 && winding == 0 && span_begin < c.first) {
+                    // Partially covered pixels at both ends of the span, the
+                    // difference buffer carries the full coverage in between.
+                    int a = span_begin, b = c.first;
+                    int ia = a >> SubpixelShift, ib = b >> SubpixelShift;
+                    if (ia == ib) {
+                        m_cover[ia] += b - a;
+                    } else {
+                        m_cover[ia] += SubpixelScale - (a & (SubpixelScale - 1));
+                        m_delta[ia] += SubpixelScale;
+                        m_cover[ib] += (b & (SubpixelScale - 1)) - SubpixelScale;
+                        m_delta[ib] -= SubpixelScale;
+                        touch(ib);
+                    }
+                    touch(ia);
+                }
+            }
+        }
+
+        if (m_touched.empty()) continue;
+
+        // Resolve the coverage of the row. Between two touched pixels the
+        // coverage is constant, so the row is written by spans, the same as
+        // agg::renderer_scanline_aa_solid blends the foreground over the row.
+        std::sort(m_touched.begin(), m_touched.end());
+
+        uint8_t *dst = m_buf.data() + size_t(row) * m_resolution.width_px;
+        auto blend = [this, dst](int from, int to, int32_t cover) {
+            if (cover <= 0) return;
+            unsigned a = m_cover_gamma[size_t(std::min(cover, m_full_cover))];
+            if (a == 255)
+                std::fill(dst + from, dst + to, uint8_t(255));
+            else if (a > 0)
+                for (uint8_t *p = dst + from; p != dst + to; ++p)
+                    *p = uint8_t(*p + ((255u - *p) * a + 127u) / 255u);
+        };
+
+        int32_t run = 0;
+        for (size_t j = 0; j < m_touched.size(); ++j) {
+            int i = m_touched[j];
+            int32_t cover = m_cover[i] + run;
+            run += m_delta[i];
+            m_cover[i] = 0;
+            m_delta[i] = 0;
+            m_touched_mask[i] = false;
+            if (i < W) {
+                blend(i, i + 1, cover);
+                int next = j + 1 < m_touched.size() ? std::min(m_touched[j + 1], W) : W;
+                if (next > i + 1) blend(i + 1, next, run);
+            }
+        }
+        m_touched.clear();
+    }
+
+    m_edges.clear();
+}
+
+void RasterGrayscaleScanline::draw(const ExPolygon &poly)
+{
+    add_path(contour(poly).points);
+    for (const Polygon &h : holes(poly)) add_path(h.points);
+    fill();
+}
+
+void RasterGrayscaleScanline::draw(const ClipperLib::Polygon &poly)
+{
+    add_path(contour(poly));
+    for (const ClipperLib::Path &h : holes(poly)) add_path(h);
+    fill();
+}
+
+}} // namespace Slic3r::sla
@@ -0,0 +1,124 @@
+#ifndef SLA_SCANLINERASTER_HPP
+#define SLA_SCANLINERASTER_HPP
+
+#include <libslic3r/SLA/RasterBase.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Slic3r { namespace sla {
+
+/*
+ * Anti-aliased monochrome canvas specialised for the SLA export: a single
+ * 8 bit channel, white polygons on a black background. Instead of the generic
+ * AGG scanline renderer, the polygons are filled from a sorted edge table,
+ * sampling every pixel row at a configurable number of sub-scanlines. The
+ * horizontal coverage of each sub-scanline is exact and the full pixels of a
+ * span are accumulated through a difference buffer, so the cost of a row is
+ * proportional to the number of its edge crossings, not to its width.
+ *
+ * The coverage is mapped to the pixel value by the gamma function, the same
+ * way as with RasterGrayscaleAA. The non-zero fill rule is used.
+ */
+class RasterGrayscaleScanline : public RasterBase {
+public:
+    template<class GammaFn>
+    RasterGrayscaleScanline(const Resolution &res,
+                            const PixelDim &  pd,
+                            const Trafo &     trafo,
+                            GammaFn &&        gammafn,
+                            size_t            supersampling = 8)
+        : RasterGrayscaleScanline(res, pd, trafo, supersampling)
+    {
+        // The gamma function is applied to the coverage quantized to 8 bits
+        // like in agg::rasterizer_scanline_aa.
+        m_cover_gamma.resize(size_t(m_full_cover) + 1);
+        for (size_t i = 0; i < m_cover_gamma.size(); ++i) {
+            double cover = std::round(255. * double(i) / double(m_full_cover)) / 255.;
+            double v     = std::round(255. * gammafn(cover));
+            m_cover_gamma[i] = uint8_t(std::min(std::max(v, 0.), 255.));
+        }
+    }
+
+    Trafo      trafo() const override { return m_trafo; }
+    Resolution resolution() const override { return m_resolution; }
+    PixelDim   pixel_dimensions() const override
+    {
+        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
+                SCALING_FACTOR / m_pxdim_scaled.h_mm};
+    }
+
+    void draw(const ExPolygon &poly) override;
+    void draw(const ClipperLib::Polygon &poly) override;
+
+    EncodedRaster encode(RasterEncoder encoder) const override
+    {
+        return encoder(m_buf.data(), m_resolution.width_px, m_resolution.height_px, 1);
+    }
+
+    uint8_t read_pixel(size_t col, size_t row) const
+    {
+        return m_buf[row * m_resolution.width_px + col];
+    }
+
+    void clear() { std::fill(m_buf.begin(), m_buf.end(), uint8_t(0)); }
+
+    size_t supersampling() const { return m_supersampling; }
+
+private:
+    RasterGrayscaleScanline(const Resolution &res,
+                            const PixelDim &  pd,
+                            const Trafo &     trafo,
+                            size_t            supersampling);
+
+    struct Edge {
+        double y_top, y_bottom; // in pixels, y_top < y_bottom
+        double x_top, dxdy;
+        int    winding;
+    };
+
+    // Edge intersecting the current sub-scanline, x in fixed point.
+    struct ActiveEdge {
+        double x, dx;
+        double y_bottom;
+        int    winding;
+    };
+
+    template<class PointVec> void add_path(const PointVec &v);
+    void fill();
+
+    void touch(int px)
+    {
+        if (!m_touched_mask[size_t(px)]) {
+            m_touched_mask[size_t(px)] = true;
+            m_touched.emplace_back(px);
+        }
+    }
+
+    Resolution           m_resolution;
+    PixelDim             m_pxdim_scaled; // used for scaled coordinate polygons
+    Trafo                m_trafo;
+    size_t               m_supersampling;
+    // Accumulated coverage of a fully covered pixel.
+    int32_t              m_full_cover;
+    // Pixel value for each accumulated coverage.
+    std::vector<uint8_t> m_cover_gamma;
+    std::vector<uint8_t> m_buf;
+
+    // Buffers reused by the consecutive draw() calls.
+    std::vector<Edge>                  m_edges;
+    std::vector<Edge>                  m_sorted_edges;
+    std::vector<size_t>                m_edge_table;
+    std::vector<size_t>                m_edge_table_pos;
+    std::vector<Edge>                  m_pending;
+    std::vector<ActiveEdge>            m_active;
+    std::vector<std::pair<int, int>>   m_crossings;
+    std::vector<int32_t>               m_cover;
+    std::vector<int32_t>               m_delta;
+    std::vector<int>                   m_touched;
+    std::vector<bool>                  m_touched_mask;
+};
+
+}} // namespace Slic3r::sla
+
+#endif // SLA_SCANLINERASTER_HPP
@@ -5,6 +5,7 @@
 
 #include "SupportPointGenerator.hpp"
 #include "Concurrency.hpp"
+#include "SpatIndex.hpp"
 #include "Model.hpp"
 #include "ExPolygon.hpp"
 #include "SVG.hpp"
@@ -171,9 +172,22 @@ static std::vector<SupportPointGenerator::MyLayer> make_layers(
       const double between_layers_offset = scaled(layer_height * std::tan(safe_angle));
             const float slope_angle = 75.f * (float(M_PI)/180.f); // smaller number - less supports
       const double slope_offset = scaled(layer_height * std::tan(slope_angle));
-            //FIXME This has a quadratic time complexity, it will be excessively slow for many tiny islands.
+            // Only the islands below with an overlapping bounding box are
+            // tested, found by an R-tree over the islands of the layer below.
+            // Layers of lattices or textured surfaces may have thousands of
+            // tiny islands.
+            BoxIndex bottom_index;
+            for (size_t i = 0; i < layer_below.islands.size(); ++ i)
+                bottom_index.insert(layer_below.islands[i].bbox, unsigned(i));
+            std::vector<unsigned> candidates;
             for (SupportPointGenerator::Structure &top : layer_above.islands) {
-                for (SupportPointGenerator::Structure &bottom : layer_below.islands) {
+                candidates.clear();
+                for (const BoxIndexEl &el : bottom_index.query(top.bbox, BoxIndex::qtIntersects))
+                    candidates.emplace_back(el.second);
+                // Keep the order of the links independent of the R-tree layout.
+                std::sort(candidates.begin(), candidates.end());
+                for (unsigned i : candidates) {
+                    SupportPointGenerator::Structure &bottom = layer_below.islands[i];
                     float overlap_area = top.overlap_area(bottom);
                     if (overlap_area > 0) {
                         top.islands_below.emplace_back(&bottom, overlap_area);
@@ -235,8 +249,14 @@ void SupportPointGenerator::process(const std::vector<ExPolygons>& slices, const
 
     std::vector<SupportPointGenerator::MyLayer> layers = make_layers(slices, heights, m_throw_on_cancel);
 
+    // The cells are about the size of the distance of the points checked by
+    // uniformly_cover(), so that only a few points are tested per cell even
+    // on the densely supported areas.
+    const float density_horizontal = m_config.tear_pressure() / m_config.support_force();
+    const float grid_cell = std::max(m_config.minimal_distance, 1.f / (5.f * density_horizontal));
+
     PointGrid3D point_grid;
-    point_grid.cell_size = Vec3f(10.f, 10.f, 10.f);
+    point_grid.cell_size = Vec3f(grid_cell, grid_cell, grid_cell);
 
     double increment = 100.0 / layers.size();
     double status    = 0;
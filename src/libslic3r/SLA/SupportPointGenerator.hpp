@@ -160,15 +160,20 @@ public:
             grid.emplace(cell_id(pt.position), pt);
         }
         
+        // Is there a point closer than radius at the same or at a lower level?
+        // The radius may be bigger than the cell size.
         bool collides_with(const Vec2f &pos, float print_z, float radius) {
             Vec3f pos3d(pos.x(), pos.y(), print_z);
             Vec3i32 cell = cell_id(pos3d);
             std::pair<Grid::const_iterator, Grid::const_iterator> it_pair = grid.equal_range(cell);
             if (collides_with(pos3d, radius, it_pair.first, it_pair.second))
                 return true;
-            for (int i = -1; i < 2; ++ i)
-                for (int j = -1; j < 2; ++ j)
-                    for (int k = -1; k < 1; ++ k) {
+            Vec3i32 span(int(ceil(radius / cell_size.x())),
+                         int(ceil(radius / cell_size.y())),
+                         int(ceil(radius / cell_size.z())));
+            for (int i = -span.x(); i <= span.x(); ++ i)
+                for (int j = -span.y(); j <= span.y(); ++ j)
+                    for (int k = -span.z(); k < 1; ++ k) {
                         if (i == 0 && j == 0 && k == 0)
                             continue;
                         it_pair = grid.equal_range(cell + Vec3i32(i, j, k));
@@ -33,37 +33,56 @@ void SupportTree::retrieve_full_mesh(TriangleMesh &outmesh) const {
     outmesh.merge(retrieve_mesh(MeshType::Pad));
 }
 
-std::vector<ExPolygons> SupportTree::slice(
+std::vector<ExPolygons> SupportTree::slice_supports(
     const std::vector<float> &grid, float cr) const
 {
     const TriangleMesh &sup_mesh = retrieve_mesh(MeshType::Support);
-    const TriangleMesh &pad_mesh = retrieve_mesh(MeshType::Pad);
-
-    using Slices = std::vector<ExPolygons>;
-    auto slices = reserve_vector<Slices>(2);
 
+    std::vector<ExPolygons> slices;
     if (!sup_mesh.empty()) {
-        slices.emplace_back();
-
         TriangleMeshSlicer sup_slicer(&sup_mesh);
         sup_slicer.closing_radius = cr;
-        sup_slicer.slice(grid, SlicingMode::Regular, &slices.back(), ctl().cancelfn);
+        sup_slicer.slice(grid, SlicingMode::Regular, &slices, ctl().cancelfn);
     }
 
-    if (!pad_mesh.empty()) {
-        slices.emplace_back();
+    return slices;
+}
+
+std::vector<ExPolygons> SupportTree::slice(
+    const std::vector<float> &grid, float cr) const
+{
+    // The merged support mesh is cached by the first call, it must not be
+    // generated by the two slicing threads at once.
+    const TriangleMesh &sup_mesh = retrieve_mesh(MeshType::Support);
+    const TriangleMesh &pad_mesh = retrieve_mesh(MeshType::Pad);
+
+    using Slices = std::vector<ExPolygons>;
+    Slices sup_slices, pad_slices;
+
+    // The support tree and the pad are independent, slice them side by side.
+    auto slicefn = [&](size_t idx) {
+        if (idx == 0) {
+            if (!sup_mesh.empty())
+                sup_slices = slice_supports(grid, cr);
+        } else if (!pad_mesh.empty()) {
+            auto bb = pad_mesh.bounding_box();
+            auto maxzit = std::upper_bound(grid.begin(), grid.end(), bb.max.z());
+
+            auto cap = grid.end() - maxzit;
+            auto padgrid = reserve_vector<float>(size_t(cap > 0 ? cap : 0));
+            std::copy(grid.begin(), maxzit, std::back_inserter(padgrid));
+
+            TriangleMeshSlicer pad_slicer(&pad_mesh);
+            pad_slicer.closing_radius = cr;
+            pad_slicer.slice(padgrid, SlicingMode::Regular, &pad_slices, ctl().cancelfn);
+        }
+    };
 
-        auto bb = pad_mesh.bounding_box();
-        auto maxzit = std::upper_bound(grid.begin(), grid.end(), bb.max.z());
-        
-        auto cap = grid.end() - maxzit;
-        auto padgrid = reserve_vector<float>(size_t(cap > 0 ? cap : 0));
-        std::copy(grid.begin(), maxzit, std::back_inserter(padgrid));
+    ccr::for_each(size_t(0), size_t(2), slicefn);
 
-        TriangleMeshSlicer pad_slicer(&pad_mesh);
-        pad_slicer.closing_radius = cr;
-        pad_slicer.slice(padgrid, SlicingMode::Regular, &slices.back(), ctl().cancelfn);
-    }
+    auto slices = reserve_vector<Slices>(2);
+    if (!sup_mesh.empty()) slices.emplace_back(std::move(sup_slices));
+    if (!pad_mesh.empty()) slices.emplace_back(std::move(pad_slices));
 
     size_t len = grid.size();
     for (const Slices &slv : slices) { len = std::min(len, slv.size()); }
@@ -93,7 +112,7 @@ SupportTree::UPtr SupportTree::create(const SupportableMesh &sm,
     if (sm.cfg.enabled) {
         // Execute takes care about the ground_level
         SupportTreeBuildsteps::execute(*builder, sm);
-        builder->merge_and_cleanup();   // clean metadata, leave only the meshes.
+        builder->merge_and_cleanup();   // clean metadata, leave the meshes and primitives.
     } else {
         // If a pad gets added later, it will be in the right Z level
         builder->ground_level = sm.emesh.ground_level();
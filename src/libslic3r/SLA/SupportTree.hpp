@@ -1,6 +1,8 @@
 #ifndef SLA_SUPPORTTREE_HPP
 #define SLA_SUPPORTTREE_HPP
 
+#include <array>
+#include <map>
 #include <vector>
 #include <memory>
 #include <Eigen/Geometry>
@@ -117,12 +119,55 @@ struct SupportTreeConfig
 
 enum class MeshType { Support, Pad };
 
+// Pinheads found by the previous support tree builds on the same mesh. The
+// search for the pinhead of a support point only depends on the point, the
+// mesh, the head configuration and the ground level, so after editing a few
+// support points only the heads of the new points are searched for.
+class PinheadCache
+{
+public:
+    struct Entry {
+        bool   valid     = false;
+        Vec3d  dir       = Vec3d::Zero();
+        double width_mm  = 0.;
+        double r_back_mm = 0.;
+    };
+
+    // Drops the entries if the parameters of the search changed.
+    void validate(std::vector<double> params)
+    {
+        if (params != m_params) {
+            m_entries.clear();
+            m_params = std::move(params);
+        }
+    }
+
+    const Entry *find(const SupportPoint &sp) const
+    {
+        auto it = m_entries.find(key(sp));
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    void store(const SupportPoint &sp, const Entry &entry) { m_entries[key(sp)] = entry; }
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    using Key = std::array<float, 4>;
+    static Key key(const SupportPoint &sp) { return {sp.pos.x(), sp.pos.y(), sp.pos.z(), sp.head_front_radius}; }
+
+    std::vector<double>  m_params;
+    std::map<Key, Entry> m_entries;
+};
+
 struct SupportableMesh
 {
     IndexedMesh  emesh;
     SupportPoints pts;
     SupportTreeConfig cfg;
     PadConfig     pad_cfg;
+    // Optional, kept between the builds by SLAPrintObject.
+    std::shared_ptr<PinheadCache> pinhead_cache;
 
     explicit SupportableMesh(const TriangleMesh & trmsh,
                              const SupportPoints &sp,
@@ -161,6 +206,13 @@ public:
     
     virtual void remove_pad() = 0;
     
+    /// Slices of the support tree without the pad. By default the support
+    /// mesh is sliced.
+    virtual std::vector<ExPolygons> slice_supports(const std::vector<float> &,
+                                                   float closing_radius) const;
+
+    /// Slices of the support tree and of the pad, these are sliced
+    /// concurrently.
     std::vector<ExPolygons> slice(const std::vector<float> &,
                                   float closing_radius) const;
     
@@ -3,6 +3,7 @@
 #include <libslic3r/SLA/SupportTreeBuilder.hpp>
 #include <libslic3r/SLA/SupportTreeBuildsteps.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
+#include <libslic3r/SLA/SupportTreeSlicer.hpp>
 #include <libslic3r/SLA/Contour3D.hpp>
 
 namespace Slic3r {
@@ -56,8 +57,12 @@ SupportTreeBuilder::SupportTreeBuilder(SupportTreeBuilder &&o)
     : m_heads(std::move(o.m_heads))
     , m_head_indices{std::move(o.m_head_indices)}
     , m_pillars{std::move(o.m_pillars)}
+    , m_junctions{std::move(o.m_junctions)}
     , m_bridges{std::move(o.m_bridges)}
     , m_crossbridges{std::move(o.m_crossbridges)}
+    , m_diffbridges{std::move(o.m_diffbridges)}
+    , m_pedestals{std::move(o.m_pedestals)}
+    , m_anchors{std::move(o.m_anchors)}
     , m_pad{std::move(o.m_pad)}
     , m_meshcache{std::move(o.m_meshcache)}
     , m_meshcache_valid{o.m_meshcache_valid}
@@ -69,8 +74,12 @@ SupportTreeBuilder::SupportTreeBuilder(const SupportTreeBuilder &o)
     : m_heads(o.m_heads)
     , m_head_indices{o.m_head_indices}
     , m_pillars{o.m_pillars}
+    , m_junctions{o.m_junctions}
     , m_bridges{o.m_bridges}
     , m_crossbridges{o.m_crossbridges}
+    , m_diffbridges{o.m_diffbridges}
+    , m_pedestals{o.m_pedestals}
+    , m_anchors{o.m_anchors}
     , m_pad{o.m_pad}
     , m_meshcache{o.m_meshcache}
     , m_meshcache_valid{o.m_meshcache_valid}
@@ -83,8 +92,12 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(SupportTreeBuilder &&o)
     m_heads = std::move(o.m_heads);
     m_head_indices = std::move(o.m_head_indices);
     m_pillars = std::move(o.m_pillars);
+    m_junctions = std::move(o.m_junctions);
     m_bridges = std::move(o.m_bridges);
     m_crossbridges = std::move(o.m_crossbridges);
+    m_diffbridges = std::move(o.m_diffbridges);
+    m_pedestals = std::move(o.m_pedestals);
+    m_anchors = std::move(o.m_anchors);
     m_pad = std::move(o.m_pad);
     m_meshcache = std::move(o.m_meshcache);
     m_meshcache_valid = o.m_meshcache_valid;
@@ -98,8 +111,12 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(const SupportTreeBuilder &o)
     m_heads = o.m_heads;
     m_head_indices = o.m_head_indices;
     m_pillars = o.m_pillars;
+    m_junctions = o.m_junctions;
     m_bridges = o.m_bridges;
     m_crossbridges = o.m_crossbridges;
+    m_diffbridges = o.m_diffbridges;
+    m_pedestals = o.m_pedestals;
+    m_anchors = o.m_anchors;
     m_pad = o.m_pad;
     m_meshcache = o.m_meshcache;
     m_meshcache_valid = o.m_meshcache_valid;
@@ -200,16 +217,19 @@ const TriangleMesh &SupportTreeBuilder::merge_and_cleanup()
     // in case the mesh is not generated, it should be...
     auto &ret = merged_mesh(); 
     
-    // Doing clear() does not garantee to release the memory.
-    m_heads = {};
+    // Doing clear() does not garantee to release the memory. The primitives
+    // themselves are needed by slice_supports().
     m_head_indices = {};
-    m_pillars = {};
-    m_junctions = {};
-    m_bridges = {};
     
     return ret;
 }
 
+std::vector<ExPolygons> SupportTreeBuilder::slice_supports(
+    const std::vector<float> &grid, float closing_radius) const
+{
+    return slice_support_tree(*this, grid, closing_radius, 45, ctl().cancelfn);
+}
+
 const TriangleMesh &SupportTreeBuilder::retrieve_mesh(MeshType meshtype) const
 {
     switch(meshtype) {
@@ -396,6 +396,10 @@ public:
     inline const std::vector<Head>   &heads() const { return m_heads; }
     inline const std::vector<Bridge> &bridges() const { return m_bridges; }
     inline const std::vector<Bridge> &crossbridges() const { return m_crossbridges; }
+    inline const std::vector<DiffBridge> &diffbridges() const { return m_diffbridges; }
+    inline const std::vector<Junction> &junctions() const { return m_junctions; }
+    inline const std::vector<Pedestal> &pedestals() const { return m_pedestals; }
+    inline const std::vector<Anchor> &anchors() const { return m_anchors; }
     
     template<class T> inline IntegerOnly<T, const Pillar&> pillar(T id) const
     {
@@ -430,7 +434,8 @@ public:
         return m_model_height;
     }
     
-    // Intended to be called after the generation is fully complete
+    // Intended to be called after the generation is fully complete. The
+    // primitives are kept, the supports are sliced from them.
     const TriangleMesh & merge_and_cleanup();
     
     // Implement SupportTree interface:
@@ -442,6 +447,10 @@ public:
     
     virtual const TriangleMesh &retrieve_mesh(
         MeshType meshtype = MeshType::Support) const override;
+
+    // Slices the primitives directly, not the merged mesh.
+    std::vector<ExPolygons> slice_supports(const std::vector<float> &grid,
+                                           float closing_radius) const override;
 };
 
 }} // namespace Slic3r::sla
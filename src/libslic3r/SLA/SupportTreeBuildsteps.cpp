@@ -37,6 +37,7 @@ SupportTreeBuildsteps::SupportTreeBuildsteps(SupportTreeBuilder &   builder,
     : m_cfg(sm.cfg)
     , m_mesh(sm.emesh)
     , m_support_pts(sm.pts)
+    , m_pinhead_cache(sm.pinhead_cache.get())
     , m_support_nmls(sm.pts.size(), 3)
     , m_builder(builder)
     , m_points(sm.pts.size(), 3)
@@ -207,51 +208,55 @@ IndexedMesh::hit_result SupportTreeBuildsteps::pinhead_mesh_intersect(
 
     // We will shoot multiple rays from the head pinpoint in the direction
     // of the pinhead robe (side) surface. The result will be the smallest
-    // hit distance.
-
-    ccr::for_each(size_t(0), hits.size(),
-                  [&m, &rings, sd, &hits](size_t i) {
-
-       // Point on the circle on the pin sphere
-       Vec3d ps = rings.pinring(i);
-       // This is the point on the circle on the back sphere
-       Vec3d p = rings.backring(i);
-
-       auto &hit = hits[i];
-
-       // Point ps is not on mesh but can be inside or
-       // outside as well. This would cause many problems
-       // with ray-casting. To detect the position we will
-       // use the ray-casting result (which has an is_inside
-       // predicate).
-
-       Vec3d n = (p - ps).normalized();
-       auto  q = m.query_ray_hit(ps + sd * n, n);
-
-       if (q.is_inside()) { // the hit is inside the model
-           if (q.distance() > rings.rpin) {
-               // If we are inside the model and the hit
-               // distance is bigger than our pin circle
-               // diameter, it probably indicates that the
-               // support point was already inside the
-               // model, or there is really no space
-               // around the point. We will assign a zero
-               // hit distance to these cases which will
-               // enforce the function return value to be
-               // an invalid ray with zero hit distance.
-               // (see min_element at the end)
-               hit = HitResult(0.0);
-           } else {
-               // re-cast the ray from the outside of the
-               // object. The starting point has an offset
-               // of 2*safety_distance because the
-               // original ray has also had an offset
-               auto q2 = m.query_ray_hit(ps + (q.distance() + 2 * sd) * n, n);
-               hit = q2;
-           }
-       } else
-           hit = q;
-    });
+    // hit distance. The rays are coherent, so they are cast as one packet.
+
+    std::vector<Vec3d> sources(SAMPLES), dirs(SAMPLES);
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        // Point on the circle on the pin sphere
+        Vec3d ps = rings.pinring(i);
+        // This is the point on the circle on the back sphere
+        Vec3d p = rings.backring(i);
+
+        // Point ps is not on mesh but can be inside or outside as well. This
+        // would cause many problems with ray-casting. To detect the position
+        // we will use the ray-casting result (which has an is_inside
+        // predicate).
+        dirs[i]    = (p - ps).normalized();
+        sources[i] = ps + sd * dirs[i];
+    }
+
+    std::vector<HitResult> q = m.query_ray_hit(sources, dirs);
+
+    std::vector<Vec3d> recast_sources, recast_dirs;
+    std::vector<size_t> recast_idx;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        if (q[i].is_inside()) { // the hit is inside the model
+            if (q[i].distance() > rings.rpin) {
+                // If we are inside the model and the hit distance is bigger
+                // than our pin circle diameter, it probably indicates that
+                // the support point was already inside the model, or there
+                // is really no space around the point. We will assign a zero
+                // hit distance to these cases which will enforce the
+                // function return value to be an invalid ray with zero hit
+                // distance. (see min_element at the end)
+                hits[i] = HitResult(0.0);
+            } else {
+                // re-cast the ray from the outside of the object. The
+                // starting point has an offset of 2*safety_distance because
+                // the original ray has also had an offset
+                recast_sources.emplace_back(rings.pinring(i) + (q[i].distance() + 2 * sd) * dirs[i]);
+                recast_dirs.emplace_back(dirs[i]);
+                recast_idx.emplace_back(i);
+            }
+        } else
+            hits[i] = q[i];
+    }
+
+    if (! recast_idx.empty()) {
+        std::vector<HitResult> q2 = m.query_ray_hit(recast_sources, recast_dirs);
+        for (size_t k = 0; k < recast_idx.size(); ++k)
+            hits[recast_idx[k]] = q2[k];
+    }
 
     return min_hit(hits);
 }
@@ -267,24 +272,33 @@ IndexedMesh::hit_result SupportTreeBuildsteps::bridge_mesh_intersect(
     // Hit results
     std::array<Hit, SAMPLES> hits;
 
-    ccr::for_each(size_t(0), hits.size(),
-                 [this, r, src, /*ins_check,*/ &ring, dir, sd, &hits] (size_t i)
-    {
-        Hit &hit = hits[i];
-
+    std::vector<Vec3d> sources(SAMPLES), dirs(SAMPLES, dir);
+    for (size_t i = 0; i < SAMPLES; ++i) {
         // Point on the circle on the pin sphere
         Vec3d p = ring.get(i, src, r + sd);
+        sources[i] = p + r * dir;
+    }
 
-        auto hr = m_mesh.query_ray_hit(p + r * dir, dir);
+    std::vector<Hit> hr = m_mesh.query_ray_hit(sources, dirs);
 
-        if(/*ins_check && */hr.is_inside()) {
-            if(hr.distance() > 2 * r + sd) hit = Hit(0.0);
+    std::vector<Vec3d> recast_sources;
+    std::vector<size_t> recast_idx;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        if (hr[i].is_inside()) {
+            if (hr[i].distance() > 2 * r + sd) hits[i] = Hit(0.0);
             else {
                 // re-cast the ray from the outside of the object
-                hit = m_mesh.query_ray_hit(p + (hr.distance() + EPSILON) * dir, dir);
+                recast_sources.emplace_back(ring.get(i, src, r + sd) + (hr[i].distance() + EPSILON) * dir);
+                recast_idx.emplace_back(i);
             }
-        } else hit = hr;
-    });
+        } else hits[i] = hr[i];
+    }
+
+    if (! recast_idx.empty()) {
+        std::vector<Hit> hr2 = m_mesh.query_ray_hit(recast_sources, std::vector<Vec3d>(recast_sources.size(), dir));
+        for (size_t k = 0; k < recast_idx.size(); ++k)
+            hits[recast_idx[k]] = hr2[k];
+    }
 
     return min_hit(hits);
 }
@@ -470,8 +484,16 @@ bool SupportTreeBuildsteps::create_ground_pillar(const Vec3d &hjp,
                                                  double       radius,
                                                  long         head_id)
 {
+    return add_ground_pillar(route_ground_pillar(hjp, sourcedir, radius), head_id);
+}
+
+SupportTreeBuildsteps::GroundPillarRoute
+SupportTreeBuildsteps::route_ground_pillar(const Vec3d &hjp,
+                                           const Vec3d &sourcedir,
+                                           double       radius)
+{
+    GroundPillarRoute route;
     Vec3d  jp           = hjp, endp = jp, dir = sourcedir;
-    long   pillar_id    = SupportTreeNode::ID_UNSET;
     bool   can_add_base = false, non_head = false;
 
     double gndlvl = 0.; // The Z level where pedestals should be
@@ -500,15 +522,13 @@ bool SupportTreeBuildsteps::create_ground_pillar(const Vec3d &hjp,
             search_widening_path(jp, dir, radius, m_cfg.head_back_radius_mm);
 
         if (diffbr && diffbr->endp.z() > jp_gnd) {
-            auto &br = m_builder.add_diffbridge(*diffbr);
-            if (head_id >= 0) m_builder.head(head_id).bridge_id = br.id;
             endp = diffbr->endp;
             radius = diffbr->end_r;
-            m_builder.add_junction(endp, radius);
             non_head = true;
             dir = diffbr->get_dir();
+            route.diffbridge = std::move(diffbr);
             eval_limits();
-        } else return false;
+        } else return route;
     }
 
     if (m_cfg.object_elevation_mm < EPSILON)
@@ -553,25 +573,52 @@ bool SupportTreeBuildsteps::create_ground_pillar(const Vec3d &hjp,
         }
 
         // Could not find a path to avoid the pad gap
-        if (dlast < gap_dist) return false;
+        if (dlast < gap_dist) return route;
 
         if (t > 0.) { // Need to make additional bridge
-            const Bridge& br = m_builder.add_bridge(endp, nexp, radius);
-            if (head_id >= 0) m_builder.head(head_id).bridge_id = br.id;
-
-            m_builder.add_junction(nexp, radius);
+            route.has_bridge   = true;
+            route.bridge_start = endp;
             endp = nexp;
             non_head = true;
         }
     }
 
-    Vec3d gp = to_floor(endp);
-    double h = endp.z() - gp.z();
+    route.valid        = true;
+    route.endp         = endp;
+    route.radius       = radius;
+    route.gndlvl       = gndlvl;
+    route.can_add_base = can_add_base;
+    route.non_head     = non_head;
+
+    return route;
+}
+
+bool SupportTreeBuildsteps::add_ground_pillar(const GroundPillarRoute &route,
+                                              long                     head_id)
+{
+    // The widening bridge is added even if no pillar could be routed below it.
+    if (route.diffbridge) {
+        auto &br = m_builder.add_diffbridge(*route.diffbridge);
+        if (head_id >= 0) m_builder.head(head_id).bridge_id = br.id;
+        m_builder.add_junction(route.diffbridge->endp, route.diffbridge->end_r);
+    }
+
+    if (!route.valid) return false;
+
+    if (route.has_bridge) {
+        const Bridge& br = m_builder.add_bridge(route.bridge_start, route.endp, route.radius);
+        if (head_id >= 0) m_builder.head(head_id).bridge_id = br.id;
 
-    pillar_id = head_id >= 0 && !non_head ? m_builder.add_pillar(head_id, h) :
-                                            m_builder.add_pillar(gp, h, radius);
+        m_builder.add_junction(route.endp, route.radius);
+    }
 
-    if (can_add_base)
+    Vec3d gp = {route.endp.x(), route.endp.y(), route.gndlvl};
+    double h = route.endp.z() - gp.z();
+
+    long pillar_id = head_id >= 0 && !route.non_head ? m_builder.add_pillar(head_id, h) :
+                                                       m_builder.add_pillar(gp, h, route.radius);
+
+    if (route.can_add_base)
         add_pillar_base(pillar_id);
 
     if(pillar_id >= 0) // Save the pillar endpoint in the spatial index
@@ -641,10 +688,6 @@ void SupportTreeBuildsteps::filter()
         filtered_indices.emplace_back(a.front());
     }
 
-    // calculate the normals to the triangles for filtered points
-    auto nmls = sla::normals(m_points, m_mesh, m_cfg.head_front_radius_mm,
-                             m_thr, filtered_indices);
-
     // Not all of the support points have to be a valid position for
     // support creation. The angle may be inappropriate or there may
     // not be enough space for the pinhead. Filtering is applied for
@@ -663,6 +706,30 @@ void SupportTreeBuildsteps::filter()
             );
     }
 
+    // The pinheads of the points kept from the previous build are reused,
+    // only the remaining points are searched for.
+    if (m_pinhead_cache) {
+        m_pinhead_cache->validate({m_cfg.head_front_radius_mm, m_cfg.head_back_radius_mm,
+                                   m_cfg.head_fallback_radius_mm, m_cfg.head_width_mm,
+                                   m_cfg.head_penetration_mm, m_cfg.normal_cutoff_angle,
+                                   m_cfg.bridge_slope, m_builder.ground_level});
+        PtIndices uncached;
+        uncached.reserve(filtered_indices.size());
+        for (unsigned fidx : filtered_indices)
+            if (const PinheadCache::Entry *entry = m_pinhead_cache->find(m_support_pts[fidx])) {
+                if (entry->valid) {
+                    Head &h = heads[fidx];
+                    h.id = fidx; h.dir = entry->dir; h.width_mm = entry->width_mm; h.r_back_mm = entry->r_back_mm;
+                }
+            } else
+                uncached.emplace_back(fidx);
+        filtered_indices = std::move(uncached);
+    }
+
+    // calculate the normals to the triangles for filtered points
+    auto nmls = sla::normals(m_points, m_mesh, m_cfg.head_front_radius_mm,
+                             m_thr, filtered_indices);
+
     std::function<void(unsigned, size_t, double)> filterfn;
     filterfn = [this, &nmls, &heads, &filterfn](unsigned fidx, size_t i, double back_r) {
         m_thr();
@@ -753,6 +820,12 @@ void SupportTreeBuildsteps::filter()
                       filterfn(filtered_indices[i], i, m_cfg.head_back_radius_mm);
                   });
 
+    if (m_pinhead_cache)
+        for (unsigned fidx : filtered_indices) {
+            const Head &h = heads[fidx];
+            m_pinhead_cache->store(m_support_pts[fidx], {h.is_valid(), h.dir, h.width_mm, h.r_back_mm});
+        }
+
     for (size_t i = 0; i < heads.size(); ++i)
         if (heads[i].is_valid()) {
             m_builder.add_head(i, heads[i]);
@@ -773,19 +846,23 @@ void SupportTreeBuildsteps::classify()
     ground_head_indices.reserve(m_iheads.size());
     m_iheads_onmodel.reserve(m_iheads.size());
 
+    // The collision checks only query the mesh, they run in parallel.
+    std::vector<IndexedMesh::hit_result> hits(m_iheads.size());
+    ccr::for_each(size_t(0), m_iheads.size(), [this, &hits](size_t n) {
+        m_thr();
+
+        const Head &head = m_builder.head(m_iheads[n]);
+        hits[n] = bridge_mesh_intersect(head.junction_point(), DOWN, head.r_back_mm);
+    });
+
     // First we decide which heads reach the ground and can be full
     // pillars and which shall be connected to the model surface (or
     // search a suitable path around the surface that leads to the
     // ground -- TODO)
-    for(unsigned i : m_iheads) {
-        m_thr();
-
+    for(size_t n = 0; n < m_iheads.size(); ++n) {
+        unsigned i = m_iheads[n];
         Head &head = m_builder.head(i);
-        double r = head.r_back_mm;
-        Vec3d headjp = head.junction_point();
-
-        // collision check
-        auto hit = bridge_mesh_intersect(headjp, DOWN, r);
+        const IndexedMesh::hit_result &hit = hits[n];
 
         if(std::isinf(hit.distance())) ground_head_indices.emplace_back(i);
         else if(m_cfg.ground_facing_only)  head.invalidate();
@@ -845,13 +922,28 @@ void SupportTreeBuildsteps::routing_to_ground()
             });
 
         assert(lcid >= 0);
-        unsigned hid = cl[size_t(lcid)]; // Head ID
+        cl_centroids.emplace_back(cl[size_t(lcid)]); // Head ID
+    }
+
+    // The pillars of the cluster centroids are independent of each other:
+    // their routes are searched in parallel and added to the builder in the
+    // order of the clusters, thus the resulting tree does not depend on the
+    // scheduling.
+    std::vector<GroundPillarRoute> routes(cl_centroids.size());
+    ccr::for_each(size_t(0), cl_centroids.size(),
+                  [this, &cl_centroids, &routes](size_t n) {
+        m_thr();
+        const Head &h = m_builder.head(cl_centroids[n]);
+        routes[n] = route_ground_pillar(h.junction_point(), h.dir, h.r_back_mm);
+    });
 
-        cl_centroids.emplace_back(hid);
+    for (size_t n = 0; n < cl_centroids.size(); ++n) {
+        m_thr();
 
+        unsigned hid = cl_centroids[n];
         Head &h = m_builder.head(hid);
 
-        if (!create_ground_pillar(h.junction_point(), h.dir, h.r_back_mm, h.id)) {
+        if (!add_ground_pillar(routes[n], h.id)) {
             BOOST_LOG_TRIVIAL(warning)
                 << "Pillar cannot be created for support point id: " << hid;
             m_iheads_onmodel.emplace_back(h.id);
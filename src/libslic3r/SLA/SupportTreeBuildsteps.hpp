@@ -188,6 +188,7 @@ class SupportTreeBuildsteps {
     const SupportTreeConfig& m_cfg;
     const IndexedMesh& m_mesh;
     const std::vector<SupportPoint>& m_support_pts;
+    PinheadCache *m_pinhead_cache;
 
     using PtIndices = std::vector<unsigned>;
 
@@ -314,6 +315,29 @@ class SupportTreeBuildsteps {
                               double       radius,
                               long         head_id = SupportTreeNode::ID_UNSET);
 
+    // The elements create_ground_pillar() would add to the builder. The route
+    // only queries the mesh, thus the routes of independent pillars can be
+    // searched in parallel and then added to the builder in a fixed order.
+    struct GroundPillarRoute {
+        bool   valid = false;
+        std::optional<DiffBridge> diffbridge;
+        // Corrector bridge from bridge_start to endp avoiding the pad gap.
+        bool   has_bridge = false;
+        Vec3d  bridge_start;
+        Vec3d  endp;
+        double radius = 0.;
+        double gndlvl = 0.;
+        bool   can_add_base = false;
+        bool   non_head = false;
+    };
+
+    GroundPillarRoute route_ground_pillar(const Vec3d &jp,
+                                          const Vec3d &sourcedir,
+                                          double       radius);
+
+    bool add_ground_pillar(const GroundPillarRoute &route,
+                           long head_id = SupportTreeNode::ID_UNSET);
+
     void add_pillar_base(long pid)
     {
         m_builder.add_pillar_base(pid, m_cfg.base_height_mm, m_cfg.base_radius_mm);
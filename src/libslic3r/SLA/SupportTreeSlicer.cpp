@@ -0,0 +1,261 @@
+#include "SupportTreeSlicer.hpp"
+
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Geometry.hpp>
+
+namespace Slic3r { namespace sla {
+
+namespace {
+
+// Points of the circle with the given center and radius, spanned by the unit
+// vectors e1, e2.
+void circle_points(const Vec3d  &center,
+                   double        r,
+                   const Vec3d  &e1,
+                   const Vec3d  &e2,
+                   size_t        steps,
+                   std::vector<Vec3d> &out)
+{
+    double a = 2 * PI / steps;
+    out.clear();
+    for (size_t i = 0; i < steps; ++i) {
+        double phi = i * a;
+        out.emplace_back(center + r * (std::cos(phi) * e1 + std::sin(phi) * e2));
+    }
+}
+
+// Crossing of the segment p, q with the plane at z, if there is any.
+void add_crossing(const Vec3d &p, const Vec3d &q, double z, Points &out)
+{
+    double dp = p.z() - z, dq = q.z() - z;
+    if (dp == 0.) out.emplace_back(scaled(p.x()), scaled(p.y()));
+    if (dq == 0.) out.emplace_back(scaled(q.x()), scaled(q.y()));
+    if ((dp < 0. && dq > 0.) || (dp > 0. && dq < 0.)) {
+        Vec3d c = p + (q - p) * (dp / (dp - dq));
+        out.emplace_back(scaled(c.x()), scaled(c.y()));
+    }
+}
+
+// Cross section points of the sphere, its slice is a circle.
+void sphere_crossing(const Vec3d &center, double r, double z, size_t steps, Points &out)
+{
+    double dz = z - center.z();
+    if (std::abs(dz) > r) return;
+
+    double rho = std::sqrt(r * r - dz * dz);
+    double a   = 2 * PI / steps;
+    for (size_t i = 0; i < steps; ++i) {
+        double phi = i * a;
+        out.emplace_back(scaled(center.x() + rho * std::cos(phi)),
+                         scaled(center.y() + rho * std::sin(phi)));
+    }
+}
+
+// Cross section points of the frustum between two parallel discs, the convex
+// hull of the discs. All the mesh edges of the frustum are cut by the plane:
+// the rims of both discs and the segments connecting them.
+void frustum_crossing(const Vec3d &c1, double r1, const Vec3d &c2, double r2,
+                      double z, size_t steps, Points &out)
+{
+    Vec3d axis = c2 - c1;
+    if (axis.squaredNorm() < EPSILON * EPSILON) return;
+    axis.normalize();
+
+    Vec3d e1 = axis.unitOrthogonal();
+    Vec3d e2 = axis.cross(e1);
+
+    std::vector<Vec3d> ring1, ring2;
+    circle_points(c1, r1, e1, e2, steps, ring1);
+    circle_points(c2, r2, e1, e2, steps, ring2);
+
+    for (size_t i = 0; i < steps; ++i) {
+        size_t next = (i + 1) % steps;
+        add_crossing(ring1[i], ring2[i], z, out);
+        add_crossing(ring1[i], ring1[next], z, out);
+        add_crossing(ring2[i], ring2[next], z, out);
+    }
+}
+
+std::pair<double, double> frustum_zrange(const Vec3d &c1, double r1, const Vec3d &c2, double r2)
+{
+    Vec3d  axis = (c2 - c1).normalized();
+    // Vertical extent of a unit disc perpendicular to the axis.
+    double k    = std::sqrt(std::max(0., 1. - axis.z() * axis.z()));
+    return {std::min(c1.z() - r1 * k, c2.z() - r2 * k),
+            std::max(c1.z() + r1 * k, c2.z() + r2 * k)};
+}
+
+Polygon to_hull(Points &&pts)
+{
+    if (pts.size() < 3) return {};
+    return Geometry::convex_hull(std::move(pts));
+}
+
+// The pin and the back sphere of the head.
+Vec3d back_center(const Head &h) { return h.junction_point(); }
+Vec3d pin_center(const Head &h) { return h.pos + (h.r_pin_mm - h.penetration_mm) * h.dir; }
+
+} // namespace
+
+Polygon get_slice(const Head &h, double z, size_t steps)
+{
+    // The head is the convex hull of its two spheres, made of the spheres and
+    // of the frustum between the circles where the robe touches them.
+    Vec3d  b = back_center(h), p = pin_center(h);
+    double rb = h.r_back_mm, rp = h.r_pin_mm;
+
+    Points pts;
+    sphere_crossing(b, rb, z, steps, pts);
+    sphere_crossing(p, rp, z, steps, pts);
+
+    double d = (p - b).norm();
+    if (d > std::abs(rb - rp)) {
+        Vec3d  u = (p - b) / d;
+        double s = (rb - rp) / d, c = std::sqrt(1. - s * s);
+        frustum_crossing(b + rb * s * u, rb * c, p + rp * s * u, rp * c, z, steps, pts);
+    }
+
+    return to_hull(std::move(pts));
+}
+
+Polygon get_slice(const Pillar &p, double z, size_t steps)
+{
+    if (p.height <= EPSILON) return {};
+
+    Points pts;
+    frustum_crossing(p.endpoint(), p.r, p.startpoint(), p.r, z, steps, pts);
+    return to_hull(std::move(pts));
+}
+
+Polygon get_slice(const Pedestal &p, double z, size_t steps)
+{
+    if (p.height <= 0) return {};
+
+    Points pts;
+    frustum_crossing(p.pos, p.r_bottom, p.pos + Vec3d{0., 0., p.height}, p.r_top, z, steps, pts);
+    return to_hull(std::move(pts));
+}
+
+Polygon get_slice(const Junction &j, double z, size_t steps)
+{
+    Points pts;
+    sphere_crossing(j.pos, j.r, z, steps, pts);
+    return to_hull(std::move(pts));
+}
+
+Polygon get_slice(const Bridge &br, double z, size_t steps)
+{
+    Points pts;
+    frustum_crossing(br.startp, br.r, br.endp, br.r, z, steps, pts);
+    return to_hull(std::move(pts));
+}
+
+Polygon get_slice(const DiffBridge &br, double z, size_t steps)
+{
+    Points pts;
+    frustum_crossing(br.startp, br.r, br.endp, br.end_r, z, steps, pts);
+    return to_hull(std::move(pts));
+}
+
+std::pair<double, double> get_zrange(const Head &h)
+{
+    Vec3d b = back_center(h), p = pin_center(h);
+    return {std::min(b.z() - h.r_back_mm, p.z() - h.r_pin_mm),
+            std::max(b.z() + h.r_back_mm, p.z() + h.r_pin_mm)};
+}
+
+std::pair<double, double> get_zrange(const Pillar &p)
+{
+    return {p.endpoint().z() - EPSILON, p.startpoint().z() + EPSILON};
+}
+
+std::pair<double, double> get_zrange(const Pedestal &p)
+{
+    return {p.pos.z() - EPSILON, p.pos.z() + p.height + EPSILON};
+}
+
+std::pair<double, double> get_zrange(const Junction &j)
+{
+    return {j.pos.z() - j.r, j.pos.z() + j.r};
+}
+
+std::pair<double, double> get_zrange(const Bridge &br)
+{
+    return frustum_zrange(br.startp, br.r, br.endp, br.r);
+}
+
+std::pair<double, double> get_zrange(const DiffBridge &br)
+{
+    return frustum_zrange(br.startp, br.r, br.endp, br.end_r);
+}
+
+std::vector<ExPolygons> slice_support_tree(const SupportTreeBuilder &builder,
+                                           const std::vector<float> &grid,
+                                           float                     closing_radius,
+                                           size_t                    steps,
+                                           ThrowOnCancel             thr)
+{
+    // The primitives cut by each layer of the grid.
+    enum class Kind { Head, Pillar, Pedestal, Junction, Bridge, CrossBridge, DiffBridge, Anchor };
+    using Item = std::pair<Kind, size_t>;
+    std::vector<std::vector<Item>> layers(grid.size());
+
+    auto add_items = [&grid, &layers](const auto &primitives, Kind kind) {
+        for (size_t i = 0; i < primitives.size(); ++i) {
+            auto zrange = get_zrange(primitives[i]);
+            auto from   = std::lower_bound(grid.begin(), grid.end(), zrange.first);
+            auto to     = std::upper_bound(from, grid.end(), zrange.second);
+            for (auto it = from; it != to; ++it)
+                layers[size_t(it - grid.begin())].emplace_back(kind, i);
+        }
+    };
+
+    auto valid_heads = reserve_vector<Head>(builder.heads().size());
+    for (const Head &h : builder.heads())
+        if (h.is_valid()) valid_heads.emplace_back(h);
+
+    add_items(valid_heads, Kind::Head);
+    add_items(builder.pillars(), Kind::Pillar);
+    add_items(builder.pedestals(), Kind::Pedestal);
+    add_items(builder.junctions(), Kind::Junction);
+    add_items(builder.bridges(), Kind::Bridge);
+    add_items(builder.crossbridges(), Kind::CrossBridge);
+    add_items(builder.diffbridges(), Kind::DiffBridge);
+    add_items(builder.anchors(), Kind::Anchor);
+
+    std::vector<ExPolygons> slices(grid.size());
+    double safety_offset = scaled(closing_radius);
+
+    ccr::for_each(size_t(0), grid.size(),
+                  [&](size_t layer_id) {
+        if ((layer_id % 8) == 0) thr();
+
+        double z = grid[layer_id];
+        auto polys = reserve_vector<Polygon>(layers[layer_id].size());
+        for (const Item &item : layers[layer_id]) {
+            Polygon poly;
+            switch (item.first) {
+            case Kind::Head:        poly = get_slice(valid_heads[item.second], z, steps); break;
+            case Kind::Pillar:      poly = get_slice(builder.pillars()[item.second], z, steps); break;
+            case Kind::Pedestal:    poly = get_slice(builder.pedestals()[item.second], z, steps); break;
+            case Kind::Junction:    poly = get_slice(builder.junctions()[item.second], z, steps); break;
+            case Kind::Bridge:      poly = get_slice(builder.bridges()[item.second], z, steps); break;
+            case Kind::CrossBridge: poly = get_slice(builder.crossbridges()[item.second], z, steps); break;
+            case Kind::DiffBridge:  poly = get_slice(builder.diffbridges()[item.second], z, steps); break;
+            case Kind::Anchor:      poly = get_slice(builder.anchors()[item.second], z, steps); break;
+            }
+            if (poly.size() >= 3) polys.emplace_back(std::move(poly));
+        }
+
+        if (polys.empty()) return;
+
+        if (safety_offset > 0)
+            slices[layer_id] = offset2_ex(union_(polys), float(safety_offset), float(-safety_offset));
+        else
+            slices[layer_id] = union_ex(polys);
+    }, 4 /* granularity */);
+
+    return slices;
+}
+
+}} // namespace Slic3r::sla
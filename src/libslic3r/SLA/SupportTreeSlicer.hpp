@@ -0,0 +1,43 @@
+#ifndef SUPPORTTREESLICER_HPP
+#define SUPPORTTREESLICER_HPP
+
+#include "libslic3r/Polygon.hpp"
+#include "libslic3r/ExPolygon.hpp"
+
+#include "libslic3r/SLA/SupportTreeBuilder.hpp"
+
+namespace Slic3r { namespace sla {
+
+// The primitives of the support tree are convex, so are their cross sections
+// with a horizontal plane. These are computed directly from the geometry of
+// the primitives with the same detail as the meshes of SupportTreeMesher.hpp.
+// An empty polygon is returned if the plane at z does not cut the primitive.
+
+Polygon get_slice(const Head &h, double z, size_t steps);
+Polygon get_slice(const Pillar &p, double z, size_t steps);
+Polygon get_slice(const Pedestal &p, double z, size_t steps);
+Polygon get_slice(const Junction &j, double z, size_t steps);
+Polygon get_slice(const Bridge &br, double z, size_t steps);
+Polygon get_slice(const DiffBridge &br, double z, size_t steps);
+
+// The lowest and the highest z coordinate of the primitives.
+std::pair<double, double> get_zrange(const Head &h);
+std::pair<double, double> get_zrange(const Pillar &p);
+std::pair<double, double> get_zrange(const Pedestal &p);
+std::pair<double, double> get_zrange(const Junction &j);
+std::pair<double, double> get_zrange(const Bridge &br);
+std::pair<double, double> get_zrange(const DiffBridge &br);
+
+// Slices of the support tree at the heights of the grid, the union of the
+// cross sections of all its primitives. This avoids slicing the merged mesh
+// of the support tree, which can have millions of triangles. The closing
+// radius is applied the same way as by TriangleMeshSlicer.
+std::vector<ExPolygons> slice_support_tree(const SupportTreeBuilder &builder,
+                                           const std::vector<float> &grid,
+                                           float                     closing_radius,
+                                           size_t                    steps,
+                                           ThrowOnCancel             thr);
+
+}} // namespace Slic3r::sla
+
+#endif // SUPPORTTREESLICER_HPP
@@ -617,6 +617,13 @@ std::string SLAPrint::output_filename(const std::string &filename_base) const
     return this->PrintBase::output_filename(m_print_config.output_filename_format.value, ".sl1", filename_base, &config);
 }
 
+std::string SLAPrint::step_profiles_json() const
+{
+    static const std::array<const char*, slapsCount>  print_step_names  { "merge_slices_and_eval", "rasterize" };
+    static const std::array<const char*, slaposCount> object_step_names { "hollowing", "drill_holes", "object_slice", "support_points", "support_tree", "pad", "slice_supports" };
+    return print_step_profiles_json<SLAPrintStep, SLAPrintObjectStep>(*this, "SLA", print_step_names, object_step_names);
+}
+
 std::pair<PrintBase::PrintValidationError, std::string> SLAPrint::validate() const
 {
     for(SLAPrintObject * po : m_objects) {
@@ -837,7 +844,8 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
         "display_pixels_y",
         "display_mirror_x",
         "display_mirror_y",
-        "display_orientation"
+        "display_orientation",
+        "fast_png_encoding"
     };
 
     static std::unordered_set<std::string> steps_ignore = {
@@ -1017,6 +1025,16 @@ bool SLAPrintObject::invalidate_step(SLAPrintObjectStep step)
     return invalidated;
 }
 
+size_t SLAPrintObject::step_items(SLAPrintObjectStep step) const
+{
+    switch (step) {
+    case slaposObjectSlice:
+    case slaposSliceSupports:   return m_slice_index.size();
+    case slaposSupportPoints:   return this->get_support_points().size();
+    default:                    return 0;
+    }
+}
+
 bool SLAPrintObject::invalidate_all_steps()
 {
     return Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
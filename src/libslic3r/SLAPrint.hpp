@@ -268,6 +268,7 @@ protected:
 
     void                    set_trafo(const Transform3d& trafo, bool left_handed) {
         m_transformed_rmesh.invalidate([this, &trafo, left_handed](){ m_trafo = trafo; m_left_handed = left_handed; });
+        m_interior_grid_cache.clear();
     }
 
     template<class InstVec> inline void set_instances(InstVec&& instances) { m_instances = std::forward<InstVec>(instances); }
@@ -278,6 +279,9 @@ protected:
     // Invalidate steps based on a set of parameters changed.
     bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys);
 
+    // Slices or support points produced by the step.
+    size_t                  step_items(SLAPrintObjectStep step) const override;
+
     // Which steps have to be performed. Implicitly: all
     // to be accessible from SLAPrint
     std::vector<bool>                       m_stepmask;
@@ -313,7 +317,9 @@ private:
         
         inline SupportData(const TriangleMesh &t)
             : sla::SupportableMesh{t, {}, {}}
-        {}
+        {
+            pinhead_cache = std::make_shared<sla::PinheadCache>();
+        }
         
         sla::SupportTree::UPtr &create_support_tree(const sla::JobController &ctl)
         {
@@ -333,6 +339,8 @@ private:
     };
     
     std::unique_ptr<HollowingData> m_hollowing_data;
+    // Level set of the transformed mesh, kept across the changes of the hollowing parameters.
+    sla::InteriorGridCache m_interior_grid_cache;
 };
 
 using PrintObjects = std::vector<SLAPrintObject*>;
@@ -375,6 +383,8 @@ struct SLAPrintStatistics
 class SLAPrinter {
 protected:
     std::vector<sla::EncodedRaster> m_layers;
+    // The layers are rasterized while being exported, see set_streamed_export().
+    bool                            m_streamed_export = false;
     
     virtual uqptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
@@ -384,17 +394,32 @@ public:
     
     virtual void apply(const SLAPrinterConfig &cfg) = 0;
     
+    // If enabled, the layers are not kept in memory after the rasterization step, they are rasterized and encoded
+    // by the export a bounded number of layers at a time. Used for the one shot exports, where the memory needed
+    // would otherwise grow with the number of layers.
+    void set_streamed_export(bool enable) { m_streamed_export = enable; }
+    bool streamed_export() const { return m_streamed_export; }
+    
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
-    template<class Fn> void draw_layers(size_t layer_num, Fn &&drawfn)
+    // If same_as[lyrid] is the index of an earlier layer, the layer is not drawn, it shares the raster of that layer.
+    template<class Fn> void draw_layers(size_t layer_num, Fn &&drawfn, const std::vector<size_t> &same_as = {})
     {
+        if (m_streamed_export) {
+            m_layers.clear();
+            return;
+        }
+        auto is_duplicate = [&same_as](size_t idx) { return idx < same_as.size() && same_as[idx] < idx; };
         m_layers.resize(layer_num);
         sla::ccr::for_each(size_t(0), m_layers.size(),
-                           [this, &drawfn] (size_t idx) {
+                           [this, &drawfn, &is_duplicate] (size_t idx) {
+                               if (is_duplicate(idx)) return;
                                sla::EncodedRaster& enc = m_layers[idx];
                                auto rst = create_raster();
                                drawfn(*rst, idx);
                                enc = rst->encode(get_encoder());
                            });
+        for (size_t idx = 0; idx < m_layers.size(); ++idx)
+            if (is_duplicate(idx)) m_layers[idx] = m_layers[same_as[idx]];
     }
 };
 
@@ -471,6 +496,9 @@ public:
 
         std::vector<ClipperLib::Polygon> m_transformed_slices;
 
+        // Index of the first layer with the same transformed slices, the index of this layer if there is none.
+        size_t m_same_as = size_t(-1);
+
         template<class Container> void transformed_slices(Container&& c)
         {
             m_transformed_slices = std::forward<Container>(c);
@@ -496,6 +524,8 @@ public:
         const std::vector<ClipperLib::Polygon> & transformed_slices() const {
             return m_transformed_slices;
         }
+
+        size_t same_as() const { return m_same_as; }
     };
 
     // The aggregated and leveled print records from various objects.
@@ -504,6 +534,12 @@ public:
     
     void set_printer(SLAPrinter *archiver);
     void set_printer(std::shared_ptr<SLAPrinter> archiver);
+
+    std::string step_profiles_json() const override;
+
+protected:
+    // Layers rasterized by the step.
+    size_t step_items(SLAPrintStep step) const override { return step == slapsRasterize ? m_printer_input.size() : 0; }
     
 private:
     
@@ -16,7 +16,10 @@
 // For geometry algorithms with native Clipper types (no copies and conversions)
 #include <libnest2d/backends/clipper/geometries.hpp>
 
+#include <unordered_map>
+
 #include <boost/log/trivial.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "I18N.hpp"
 
@@ -121,6 +124,7 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     po.m_hollowing_data.reset();
 
     if (! po.m_config.hollowing_enable.getBool()) {
+        po.m_interior_grid_cache.clear();
         BOOST_LOG_TRIVIAL(info) << "Skipping hollowing step!";
         return;
     }
@@ -131,7 +135,9 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     double quality  = po.m_config.hollowing_quality.getFloat();
     double closing_d = po.m_config.hollowing_closing_distance.getFloat();
     sla::HollowingConfig hlwcfg{thickness, quality, closing_d};
-    auto meshptr = generate_interior(po.transformed_mesh(), hlwcfg);
+    // The level set of the mesh is kept by the object, tweaking the thickness
+    // or the closing distance only offsets and meshes it again.
+    auto meshptr = generate_interior(po.transformed_mesh(), hlwcfg, {}, &po.m_interior_grid_cache);
 
     if (meshptr->empty())
         BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
@@ -177,25 +183,22 @@ void SLAPrint::Steps::drill_holes(SLAPrintObject &po)
     sla::DrainHoles drainholes = po.transformed_drainhole_points();
     
     std::uniform_real_distribution<float> dist(0., float(EPSILON));
-    auto holes_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal({});
+    std::vector<TriangleMesh> hole_meshes;
+    hole_meshes.reserve(drainholes.size());
     for (sla::DrainHole holept : drainholes) {
         holept.normal += Vec3f{dist(m_rng), dist(m_rng), dist(m_rng)};
         holept.normal.normalize();
         holept.pos += Vec3f{dist(m_rng), dist(m_rng), dist(m_rng)};
-        TriangleMesh m = sla::to_triangle_mesh(holept.to_mesh());
-        m.require_shared_vertices();
-        auto cgal_m = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
-        MeshBoolean::cgal::plus(*holes_mesh_cgal, *cgal_m);
+        hole_meshes.emplace_back(sla::to_triangle_mesh(holept.to_mesh()));
+        hole_meshes.back().require_shared_vertices();
     }
-    
-    if (MeshBoolean::cgal::does_self_intersect(*holes_mesh_cgal))
+
+    TriangleMesh holes_mesh = MeshBoolean::cgal::plus(hole_meshes);
+    if (MeshBoolean::cgal::does_self_intersect(holes_mesh))
         throw Slic3r::SlicingError(L("Too many overlapping holes."));
-    
-    auto hollowed_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal(hollowed_mesh);
-    
+
     try {
-        MeshBoolean::cgal::minus(*hollowed_mesh_cgal, *holes_mesh_cgal);
-        hollowed_mesh = MeshBoolean::cgal::cgal_to_triangle_mesh(*hollowed_mesh_cgal);
+        MeshBoolean::cgal::minus(hollowed_mesh, holes_mesh);
     } catch (const std::runtime_error &) {
         throw Slic3r::SlicingError(L(
             "Drilling holes into the mesh failed. "
@@ -596,6 +599,65 @@ static ClipperPolygons get_all_polygons(const SliceRecord& record, SliceOrigin o
     return polygons;
 }
 
+// Model and support polygons of all the objects of a print layer, before their union.
+struct LayerInput {
+    double          layer_height = 0.;
+    ClipperPolygons model;
+    ClipperPolygons supports;
+    
+    size_t hash() const
+    {
+        size_t seed = std::hash<double>{}(layer_height);
+        auto hash_path = [&seed](const ClipperLib::Path &path) {
+            boost::hash_combine(seed, path.size());
+            for (const ClipperLib::IntPoint &pt : path) {
+                boost::hash_combine(seed, pt.X);
+                boost::hash_combine(seed, pt.Y);
+            }
+        };
+        auto hash_polygons = [&seed, &hash_path](const ClipperPolygons &polygons) {
+            boost::hash_combine(seed, polygons.size());
+            for (const ClipperPolygon &poly : polygons) {
+                hash_path(poly.Contour);
+                boost::hash_combine(seed, poly.Holes.size());
+                for (const ClipperLib::Path &hole : poly.Holes) hash_path(hole);
+            }
+        };
+        hash_polygons(model);
+        hash_polygons(supports);
+        return seed;
+    }
+    
+    bool operator==(const LayerInput &rhs) const
+    {
+        auto same = [](const ClipperPolygons &a, const ClipperPolygons &b) {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                              [](const ClipperPolygon &p1, const ClipperPolygon &p2) {
+                                  return p1.Contour == p2.Contour && p1.Holes == p2.Holes;
+                              });
+        };
+        return layer_height == rhs.layer_height && same(model, rhs.model) && same(supports, rhs.supports);
+    }
+};
+
+static LayerInput get_layer_input(const SLAPrint::PrintLayer &layer)
+{
+    LayerInput input;
+    if (layer.slices().empty()) return input;
+    
+    input.layer_height = double(layer.slices().front().get().layer_height());
+    
+    for (const SliceRecord &record : layer.slices()) {
+        ClipperPolygons modelslices = get_all_polygons(record, soModel);
+        for (ClipperPolygon &p_tmp : modelslices) input.model.emplace_back(std::move(p_tmp));
+        
+        ClipperPolygons supportslices = get_all_polygons(record, soSupport);
+        for (ClipperPolygon &p_tmp : supportslices) input.supports.emplace_back(std::move(p_tmp));
+    }
+    
+    return input;
+}
+
 void SLAPrint::Steps::initialize_printer_input()
 {
     auto &printer_input = m_print->m_printer_input;
@@ -682,70 +744,36 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
     const double delta_fade_time = (init_exp_time - exp_time) / (fade_layers_cnt + 1);
     double fade_layer_time = init_exp_time;
     
-    sla::ccr::SpinningMutex mutex;
-    using Lock = std::lock_guard<sla::ccr::SpinningMutex>;
+    const size_t layers_cnt = printer_input.size();
     
-    // Going to parallel:
-    auto printlayerfn = [this,
-            // functions and read only vars
-            areafn, area_fill, display_area, exp_time, init_exp_time, fast_tilt, slow_tilt, delta_fade_time,
-            
-            // write vars
-            &mutex, &models_volume, &supports_volume, &estim_time, &slow_layers,
-            &fast_layers, &fade_layer_time, &layers_times](size_t sliced_layer_cnt)
+    // Layers with the same slices as an earlier layer (pads, straight
+    // columns, ...) are not merged again, they are found by hashing the
+    // slices of all the objects of each layer.
+    std::vector<size_t> layer_hashes(layers_cnt);
+    sla::ccr::for_each(size_t(0), layers_cnt, [&printer_input, &layer_hashes](size_t i) {
+        layer_hashes[i] = get_layer_input(printer_input[i]).hash();
+    });
+    
+    std::vector<size_t> same_as(layers_cnt);
     {
-        PrintLayer &layer = m_print->m_printer_input[sliced_layer_cnt];
-
-        // vector of slice record references
-        auto& slicerecord_references = layer.slices();
-        
-        if(slicerecord_references.empty()) return;
-        
-        // Layer height should match for all object slices for a given level.
-        const auto l_height = double(slicerecord_references.front().get().layer_height());
-        
-        // Calculation of the consumed material
-        
-        ClipperPolygons model_polygons;
-        ClipperPolygons supports_polygons;
-        
-        size_t c = std::accumulate(layer.slices().begin(),
-                                   layer.slices().end(),
-                                   size_t(0),
-                                   [](size_t a, const SliceRecord &sr) {
-            return a + sr.get_slice(soModel).size();
-        });
-        
-        model_polygons.reserve(c);
-        
-        c = std::accumulate(layer.slices().begin(),
-                            layer.slices().end(),
-                            size_t(0),
-                            [](size_t a, const SliceRecord &sr) {
-            return a + sr.get_slice(soModel).size();
-        });
-        
-        supports_polygons.reserve(c);
-        
-        for(const SliceRecord& record : layer.slices()) {
-            
-            ClipperPolygons modelslices = get_all_polygons(record, soModel);
-            for(ClipperPolygon& p_tmp : modelslices) model_polygons.emplace_back(std::move(p_tmp));
-        
-            ClipperPolygons supportslices = get_all_polygons(record, soSupport);
-            for(ClipperPolygon& p_tmp : supportslices) supports_polygons.emplace_back(std::move(p_tmp));
-        
-        }
+        std::unordered_map<size_t, size_t> first_layer;
+        for (size_t i = 0; i < layers_cnt; ++i)
+            same_as[i] = first_layer.emplace(layer_hashes[i], i).first->second;
+    }
+    
+    std::vector<double> model_areas(layers_cnt, 0.), support_areas(layers_cnt, 0.);
+    
+    auto mergefn = [areafn, &printer_input, &model_areas, &support_areas](size_t sliced_layer_cnt, LayerInput &&input)
+    {
+        PrintLayer &layer = printer_input[sliced_layer_cnt];
+        ClipperPolygons &model_polygons    = input.model;
+        ClipperPolygons &supports_polygons = input.supports;
         
         model_polygons = polyunion(model_polygons);
         double layer_model_area = 0;
         for (const ClipperPolygon& polygon : model_polygons)
             layer_model_area += areafn(polygon);
         
-        if (layer_model_area < 0 || layer_model_area > 0) {
-            Lock lck(mutex); models_volume += layer_model_area * l_height;
-        }
-        
         if(!supports_polygons.empty()) {
             if(model_polygons.empty()) supports_polygons = polyunion(supports_polygons);
             else supports_polygons = polydiff(supports_polygons, model_polygons);
@@ -756,9 +784,8 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         for (const ClipperPolygon& polygon : supports_polygons)
             layer_support_area += areafn(polygon);
         
-        if (layer_support_area < 0 || layer_support_area > 0) {
-            Lock lck(mutex); supports_volume += layer_support_area * l_height;
-        }
+        model_areas[sliced_layer_cnt]   = layer_model_area;
+        support_areas[sliced_layer_cnt] = layer_support_area;
         
         // Here we can save the expensively calculated polygons for printing
         ClipperPolygons trslices;
@@ -767,39 +794,73 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         for(ClipperPolygon& poly : supports_polygons) trslices.emplace_back(std::move(poly));
         
         layer.transformed_slices(polyunion(trslices));
+        layer.m_same_as = sliced_layer_cnt;
+    };
+    
+    // Going to parallel, first the distinct layers, then the duplicates
+    // copying the polygons of the layer they duplicate.
+    sla::ccr::for_each(size_t(0), layers_cnt, [&printer_input, &same_as, &mergefn](size_t i) {
+        if (same_as[i] == i)
+            mergefn(i, get_layer_input(printer_input[i]));
+    });
+    
+    sla::ccr::for_each(size_t(0), layers_cnt, [&printer_input, &same_as, &mergefn, &model_areas, &support_areas](size_t i) {
+        size_t src = same_as[i];
+        if (src == i)
+            return;
+        LayerInput input = get_layer_input(printer_input[i]);
+        if (input == get_layer_input(printer_input[src])) {
+            PrintLayer &layer = printer_input[i];
+            layer.transformed_slices(printer_input[src].transformed_slices());
+            layer.m_same_as  = src;
+            model_areas[i]   = model_areas[src];
+            support_areas[i] = support_areas[src];
+        } else
+            // Hash collision.
+            mergefn(i, std::move(input));
+    });
+    
+    // The statistics are accumulated in the order of the layers.
+    for (size_t sliced_layer_cnt = 0; sliced_layer_cnt < layers_cnt; ++sliced_layer_cnt) {
+        const PrintLayer &layer = printer_input[sliced_layer_cnt];
+        
+        if (layer.slices().empty()) continue;
+        
+        // Layer height should match for all object slices for a given level.
+        const auto l_height = double(layer.slices().front().get().layer_height());
+        
+        const double layer_model_area   = model_areas[sliced_layer_cnt];
+        const double layer_support_area = support_areas[sliced_layer_cnt];
+        
+        models_volume   += layer_model_area * l_height;
+        supports_volume += layer_support_area * l_height;
         
         // Calculation of the slow and fast layers to the future controlling those values on FW
         
         const bool is_fast_layer = (layer_model_area + layer_support_area) <= display_area*area_fill;
         const double tilt_time = is_fast_layer ? fast_tilt : slow_tilt;
         
-        { Lock lck(mutex);
-            if (is_fast_layer)
-                fast_layers++;
-            else
-                slow_layers++;
-            
-            // Calculation of the printing time
-
-            double layer_times = 0.0;
-            if (sliced_layer_cnt < 3)
-                layer_times += init_exp_time;
-            else if (fade_layer_time > exp_time) {
-                fade_layer_time -= delta_fade_time;
-                layer_times += fade_layer_time;
-            }
-            else
-                layer_times += exp_time;
-            layer_times += tilt_time;
+        if (is_fast_layer)
+            fast_layers++;
+        else
+            slow_layers++;
+        
+        // Calculation of the printing time
 
-            layers_times.push_back(layer_times);
-            estim_time += layer_times;
+        double layer_times = 0.0;
+        if (sliced_layer_cnt < 3)
+            layer_times += init_exp_time;
+        else if (fade_layer_time > exp_time) {
+            fade_layer_time -= delta_fade_time;
+            layer_times += fade_layer_time;
         }
-    };
-    
-    // sequential version for debugging:
-    // for(size_t i = 0; i < m_printer_input.size(); ++i) printlayerfn(i);
-    sla::ccr::for_each(size_t(0), printer_input.size(), printlayerfn);
+        else
+            layer_times += exp_time;
+        layer_times += tilt_time;
+
+        layers_times.push_back(layer_times);
+        estim_time += layer_times;
+    }
     
     auto SCALING2 = SCALING_FACTOR * SCALING_FACTOR;
     print_statistics.support_used_material = supports_volume * SCALING2;
@@ -867,8 +928,13 @@ void SLAPrint::Steps::rasterize()
     // last minute escape
     if(canceled()) return;
     
-    // Print all the layers in parallel
-    m_print->m_printer->draw_layers(m_print->m_printer_input.size(), lvlfn);
+    // Print all the layers in parallel, the layers duplicating an earlier
+    // one share its raster.
+    std::vector<size_t> same_as;
+    same_as.reserve(m_print->m_printer_input.size());
+    for (const PrintLayer &layer : m_print->m_printer_input)
+        same_as.emplace_back(layer.same_as());
+    m_print->m_printer->draw_layers(m_print->m_printer_input.size(), lvlfn, same_as);
 }
 
 std::string SLAPrint::Steps::label(SLAPrintObjectStep step)
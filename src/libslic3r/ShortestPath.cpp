@@ -13,12 +13,64 @@
 #include <cmath>
 #include <cassert>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
+// Segments are chained thousands of times per layer in small collections (Fill, GCode::process_layer),
+// where allocating the end points, the KD tree and the priority queue would dominate the run time.
+// Therefore each thread keeps these buffers between the calls. A buffer is borrowed for the duration of a call,
+// thus a nested call on the same thread just starts with an empty buffer.
+template<typename T>
+class ChainingBuffer
+{
+public:
+	explicit ChainingBuffer(std::vector<T> &pool) : m_pool(pool) { this->data.swap(m_pool); this->data.clear(); }
+	~ChainingBuffer() {
+		// Don't hold the memory of an exceptionally large collection.
+		if (this->data.capacity() <= max_pooled_capacity) {
+			this->data.clear();
+			this->data.swap(m_pool);
+		}
+	}
+	std::vector<T> data;
+
+private:
+	static constexpr size_t max_pooled_capacity = 1 << 16;
+	std::vector<T> &m_pool;
+};
+
+static thread_local std::vector<size_t> s_chaining_kdtree_nodes;
+static thread_local std::vector<size_t> s_chaining_kdtree_indices;
+
+// Up to this number of segments, the closest end points are searched by a linear scan instead of building a KD tree.
+// Chosen by benchmarking chain_extrusion_entities() on random collections: the linear scan is 2-4x faster up to 64 segments
+// and it breaks even at around 400 segments, as the KD tree does not prune the end points already taken.
+static constexpr size_t chain_segments_linear_search_max_segments = 256;
+
+// Find the closest end point by a linear scan. Returns size_t(-1) if no end point passes the filter.
+template<typename EndPointType, typename FilterFn>
+size_t find_closest_end_point_linear(const std::vector<EndPointType> &end_points, const Vec2d &pt, FilterFn filter)
+{
+	size_t min_idx  = size_t(-1);
+	double min_dist = std::numeric_limits<double>::max();
+	for (size_t idx = 0; idx < end_points.size(); ++ idx)
+		if (filter(idx)) {
+			double dist = (end_points[idx].pos - pt).squaredNorm();
+			if (dist < min_dist) {
+				min_dist = dist;
+				min_idx  = idx;
+			}
+		}
+	return min_idx;
+}
+
 // Naive implementation of the Traveling Salesman Problem, it works by always taking the next closest neighbor.
 // This implementation will always produce valid result even if some segments cannot reverse.
-template<typename EndPointType, typename KDTreeType, typename CouldReverseFunc>
-std::vector<std::pair<size_t, bool>> chain_segments_closest_point(std::vector<EndPointType> &end_points, KDTreeType &kdtree, CouldReverseFunc &could_reverse_func, EndPointType &first_point)
+// closest_point_fn(pos, filter) returns index of the end point closest to pos passing the filter (KD tree or linear search).
+template<typename EndPointType, typename ClosestPointFn, typename CouldReverseFunc>
+std::vector<std::pair<size_t, bool>> chain_segments_closest_point(std::vector<EndPointType> &end_points, ClosestPointFn closest_point_fn, CouldReverseFunc &could_reverse_func, EndPointType &first_point)
 {
 	//check pair
 	assert((end_points.size() & 1) == 0);
@@ -44,7 +96,7 @@ std::vector<std::pair<size_t, bool>> chain_segments_closest_point(std::vector<En
 		this_point.chain_id = 1;
 		// Find the closest point to this end_point, which lies on a different extrusion path (filtered by the lambda).
 		// Ignore the starting point as the starting point is considered to be occupied, no end point coud connect to it.
-		size_t next_idx = find_closest_point(kdtree, this_point.pos,
+		size_t next_idx = closest_point_fn(this_point.pos,
 			[this_idx, &end_points, &could_reverse_func](size_t idx) {
             return
                 // ????
@@ -109,7 +161,9 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 			double    distance_out = std::numeric_limits<double>::max();
 			size_t    heap_idx = std::numeric_limits<size_t>::max();
 		};
-	    std::vector<EndPoint> end_points;
+		static thread_local std::vector<EndPoint> end_points_pool;
+		ChainingBuffer<EndPoint> end_points_buffer(end_points_pool);
+	    std::vector<EndPoint> &end_points = end_points_buffer.data;
 	    end_points.reserve(num_segments * 2);
 	    for (size_t i = 0; i < num_segments; ++ i) {
             end_points.emplace_back(end_point_func(i, true ).template cast<double>());
@@ -117,8 +171,18 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 	    }
 
 	    // Construct the closest point KD tree over end points of segments.
+	    // Tiny collections are searched linearly, building a KD tree over them does not pay off.
+	    const bool linear_search = num_segments <= chain_segments_linear_search_max_segments;
 		auto coordinate_fn = [&end_points](size_t idx, size_t dimension) -> double { return end_points[idx].pos[dimension]; };
-		KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn, end_points.size());
+		KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn);
+		ChainingBuffer<size_t> kdtree_nodes(s_chaining_kdtree_nodes);
+		if (! linear_search) {
+			ChainingBuffer<size_t> kdtree_indices(s_chaining_kdtree_indices);
+			kdtree.swap_nodes(kdtree_nodes.data);
+			kdtree.build(end_points.size(), kdtree_indices.data);
+		}
+		auto closest_point_fn = [&end_points, &kdtree, linear_search](const Vec2d &pos, auto filter) -> size_t
+			{ return linear_search ? find_closest_end_point_linear(end_points, pos, filter) : find_closest_point(kdtree, pos, filter); };
 
 		// Helper to detect loops in already connected paths.
 		// Unique chain IDs are assigned to paths. If paths are connected, end points will not have their chain IDs updated, but the chain IDs
@@ -182,7 +246,7 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 		EndPoint *first_point = nullptr;
 		size_t    first_point_idx = std::numeric_limits<size_t>::max();
 		if (start_near != nullptr) {
-            size_t idx = find_closest_point(kdtree, start_near->template cast<double>(),
+            size_t idx = closest_point_fn(start_near->template cast<double>(),
                 // Don't start with a reverse segment, if flipping of the segment is not allowed.
                 [&could_reverse_func](size_t idx) { return idx != size_t(-1) && ( (idx & 1) == 0 || could_reverse_func(idx >> 1) ); });
 			assert(idx < end_points.size());
@@ -400,13 +464,15 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 			}
 			if (failed)
 				// As a last resort, try a dumb algorithm, which is not sensitive to edge reversal constraints.
-				out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+				out = chain_segments_closest_point(end_points, closest_point_fn, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
 		} else {
 			assert(! failed);
 		}
 #else
-            out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+            out = chain_segments_closest_point(end_points, closest_point_fn, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
 #endif
+		// Hand the memory of the KD tree over to the next call.
+		kdtree.swap_nodes(kdtree_nodes.data);
 	}
 	assert(out.size() == num_segments);
 	return out;
@@ -523,7 +589,9 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 			const EndPoint& 	opposite(const std::vector<EndPoint> &endpoints) const { return endpoints[(this - endpoints.data()) ^ 1]; }
 		};
 
-	    std::vector<EndPoint> end_points;
+		static thread_local std::vector<EndPoint> end_points_pool;
+		ChainingBuffer<EndPoint> end_points_buffer(end_points_pool);
+	    std::vector<EndPoint> &end_points = end_points_buffer.data;
 	    end_points.reserve(num_segments * 2);
 	    for (size_t i = 0; i < num_segments; ++ i) {
             end_points.emplace_back(end_point_func(i, true ).template cast<double>());
@@ -532,7 +600,13 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 
 	    // Construct the closest point KD tree over end points of segments.
 		auto coordinate_fn = [&end_points](size_t idx, size_t dimension) -> double { return end_points[idx].pos[dimension]; };
-		KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn, end_points.size());
+		KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn);
+		ChainingBuffer<size_t> kdtree_nodes(s_chaining_kdtree_nodes);
+		{
+			ChainingBuffer<size_t> kdtree_indices(s_chaining_kdtree_indices);
+			kdtree.swap_nodes(kdtree_nodes.data);
+			kdtree.build(end_points.size(), kdtree_indices.data);
+		}
 
 	    // Chained segments with their sum of connection lengths.
 	    // The chain supports flipping all the segments, connecting the segments at the opposite ends.
@@ -714,6 +788,9 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 	    auto queue = make_mutable_priority_queue<EndPoint*, true>(
 			[](EndPoint *ep, size_t idx){ ep->heap_idx = idx; }, 
 	    	[](EndPoint *l, EndPoint *r){ return l->distance_out < r->distance_out; });
+		static thread_local std::vector<EndPoint*> queue_pool;
+		ChainingBuffer<EndPoint*> queue_buffer(queue_pool);
+		queue.swap_storage(queue_buffer.data);
 		queue.reserve(end_points.size() * 2);
 	    for (EndPoint &ep : end_points)
 	    	if (first_point != &ep)
@@ -982,10 +1059,16 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 			}
 			if (failed)
 				// As a last resort, try a dumb algorithm, which is not sensitive to edge reversal constraints.
-				out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+				out = chain_segments_closest_point(end_points,
+					[&kdtree](const Vec2d &pos, auto filter) { return find_closest_point(kdtree, pos, filter); },
+					could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
 		} else {
 			assert(! failed);
 		}
+		// Hand the memory of the KD tree and of the queue over to the next call.
+		kdtree.swap_nodes(kdtree_nodes.data);
+		queue.clear();
+		queue.swap_storage(queue_buffer.data);
 	}
 
 	assert(out.size() == num_segments);
@@ -1627,6 +1710,130 @@ static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<Fl
 	}
 }
 
+// Above this number of edges, reorder_by_two_exchanges_with_segment_flipping_bounded() is used.
+static constexpr size_t two_exchanges_bounded_min_edges = 1000;
+// Maximum number of the second crossover candidates tested against a single first crossover candidate.
+static constexpr size_t two_exchanges_max_neighbors     = 64;
+// Number of the first crossover candidates evaluated in parallel.
+static constexpr size_t two_exchanges_block_size        = 64;
+// Stop once a crossover shortens the chain by less than this fraction of its cost.
+static constexpr double two_exchanges_min_improvement   = 0.0005;
+
+// Bounded time variant of reorder_by_two_exchanges_with_segment_flipping() for large sets of edges, for example sparse infill lines.
+// Exchanging two connections may only shorten the chain if the end points of the other connection are closer to the end points
+// of the first connection than the length of the first connection (segment flipping aside). Therefore the second crossover
+// is only searched among the closest connections in that neighborhood, looked up with a KD tree.
+// Blocks of the first crossover candidates are evaluated in parallel. The first improving candidate in the order
+// of the serial algorithm is applied, thus the result does not depend on the number of threads.
+static inline void reorder_by_two_exchanges_with_segment_flipping_bounded(std::vector<FlipEdge> &edges)
+{
+	assert(edges.size() >= 2);
+
+	struct Crossover {
+		double cost;
+		size_t pos1;
+		size_t pos2;
+		size_t flip;
+	};
+
+	std::vector<ConnectionCost> 			connections(edges.size());
+	std::vector<FlipEdge> 					edges_tmp(edges);
+	std::vector<std::pair<double, size_t>>	connection_lengths(edges.size() - 1, std::pair<double, size_t>(0., 0));
+	// Index of a connection in connection_lengths. The connections sorted before the first crossover candidate were already tried.
+	std::vector<size_t>						connection_order(edges.size(), 0);
+	// Connection i starts at end_points[2 * (i - 1)] and ends at end_points[2 * (i - 1) + 1].
+	std::vector<Vec2d>						end_points(2 * (edges.size() - 1));
+	auto 									coordinate_fn = [&end_points](size_t idx, size_t dimension) { return end_points[idx](dimension); };
+	KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn);
+	std::vector<Crossover>					crossovers;
+	const size_t 							max_iterations = std::min(edges.size(), size_t(100));
+	for (size_t iter = 0; iter < max_iterations; ++ iter) {
+		// Initialize connection costs and connection lengths.
+		for (size_t i = 1; i < edges.size(); ++ i) {
+			const FlipEdge   	 &e1 = edges[i - 1];
+			const FlipEdge   	 &e2 = edges[i];
+			ConnectionCost	     &c  = connections[i];
+			c = connections[i - 1];
+			double l = (e2.p1 - e1.p2).norm();
+			c.cost += l;
+			c.cost_flipped += (e2.p2 - e1.p1).norm();
+			connection_lengths[i - 1] = std::make_pair(l, i);
+			end_points[2 * (i - 1)]     = e1.p2;
+			end_points[2 * (i - 1) + 1] = e2.p1;
+		}
+		std::sort(connection_lengths.begin(), connection_lengths.end(), [](const std::pair<double, size_t> &l, const std::pair<double, size_t> &r) { return l.first > r.first; });
+		for (size_t i = 0; i < connection_lengths.size(); ++ i)
+			connection_order[connection_lengths[i].second] = i;
+		kdtree.build(end_points.size());
+
+		const double cost_current    = connections.back().cost;
+		Crossover    crossover_final { cost_current, 0, 0, 0 };
+		for (size_t block_begin = 0; block_begin < connection_lengths.size() && crossover_final.flip == 0; block_begin += two_exchanges_block_size) {
+			const size_t block_end = std::min(block_begin + two_exchanges_block_size, connection_lengths.size());
+			crossovers.assign(block_end - block_begin, Crossover{ cost_current, 0, 0, 0 });
+			tbb::parallel_for(tbb::blocked_range<size_t>(block_begin, block_end), 
+				[&edges, &connections, &connection_lengths, &connection_order, &end_points, &kdtree, &crossovers, block_begin](const tbb::blocked_range<size_t> &range) {
+				std::vector<size_t> 					nearby;
+				std::vector<std::pair<double, size_t>> 	neighbors;
+				for (size_t order = range.begin(); order < range.end(); ++ order) {
+					const double longest_connection_length = connection_lengths[order].first;
+					const size_t longest_connection_idx    = connection_lengths[order].second;
+					// Collect the connections not yet tried as the first crossover, which have an end point close to the first crossover.
+					neighbors.clear();
+					for (size_t k = 0; k < 2; ++ k) {
+						const Vec2d &center = end_points[2 * (longest_connection_idx - 1) + k];
+						nearby.clear();
+						find_nearby_points(kdtree, center, longest_connection_length, 
+							[&connection_order, order](size_t idx) { return connection_order[idx / 2 + 1] > order; }, nearby);
+						for (size_t idx : nearby)
+							neighbors.emplace_back((end_points[idx] - center).squaredNorm(), idx / 2 + 1);
+					}
+					std::sort(neighbors.begin(), neighbors.end());
+					// Keep the closest end point of each connection.
+					size_t num_neighbors = 0;
+					for (size_t i = 0; i < neighbors.size() && num_neighbors < two_exchanges_max_neighbors; ++ i) {
+						auto it = std::find_if(neighbors.begin(), neighbors.begin() + num_neighbors, [&neighbors, i](const std::pair<double, size_t> &n){ return n.second == neighbors[i].second; });
+						if (it == neighbors.begin() + num_neighbors)
+							neighbors[num_neighbors ++] = neighbors[i];
+					}
+					neighbors.resize(num_neighbors);
+					// Test the candidates in the order of the serial algorithm.
+					std::sort(neighbors.begin(), neighbors.end(), [](const std::pair<double, size_t> &l, const std::pair<double, size_t> &r) { return l.second < r.second; });
+					Crossover &crossover = crossovers[order - block_begin];
+					for (const std::pair<double, size_t> &neighbor : neighbors) {
+						size_t a = neighbor.second;
+						size_t b = longest_connection_idx;
+						if (a > b)
+							std::swap(a, b);
+						std::pair<double, size_t> cost_and_flip = minimum_crossover_cost(edges, 
+							std::make_pair(size_t(0), a), connections[a - 1], std::make_pair(a, b), connections[b - 1] - connections[a], std::make_pair(b, edges.size()), connections.back() - connections[b],
+							connections.back().cost);
+						if (cost_and_flip.second > 0 && cost_and_flip.first < crossover.cost)
+							crossover = Crossover{ cost_and_flip.first, a, b, cost_and_flip.second };
+					}
+				}
+			});
+			for (const Crossover &crossover : crossovers)
+				if (crossover.flip > 0 && crossover.cost < cost_current) {
+					crossover_final = crossover;
+					break;
+				}
+		}
+		if (crossover_final.flip > 0) {
+			// Pair of cross over positions and flip / reverse constellation has been found, which improves the total cost of the connection.
+			// Perform a crossover.
+			do_crossover(edges, edges_tmp, std::make_pair(size_t(0), crossover_final.pos1), std::make_pair(crossover_final.pos1, crossover_final.pos2), std::make_pair(crossover_final.pos2, edges.size()), crossover_final.flip);
+			edges.swap(edges_tmp);
+			if (cost_current - crossover_final.cost < two_exchanges_min_improvement * cost_current)
+				// Further crossovers are not worth the time.
+				break;
+		} else {
+			// No valid pair of cross over positions was found improving the total cost. Giving up.
+			break;
+		}
+	}
+}
+
 #if 0
 // Currently not used, too slow.
 static inline void reorder_by_three_exchanges_with_segment_flipping(std::vector<FlipEdge> &edges)
@@ -1909,7 +2116,10 @@ static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polyl
     std::transform(polylines.begin(), polylines.end(), std::back_inserter(edges), 
     	[&polylines](const Polyline &pl){ return FlipEdge(pl.first_point().cast<double>(), pl.last_point().cast<double>(), &pl - polylines.data()); });
 #if 1
-	reorder_by_two_exchanges_with_segment_flipping(edges);
+	if (edges.size() < two_exchanges_bounded_min_edges)
+		reorder_by_two_exchanges_with_segment_flipping(edges);
+	else
+		reorder_by_two_exchanges_with_segment_flipping_bounded(edges);
 #else
 	// reorder_by_three_exchanges_with_segment_flipping(edges);
 	reorder_by_three_exchanges_with_segment_flipping2(edges);
@@ -2008,6 +2218,145 @@ std::vector<const PrintInstance*> chain_print_object_instances(const Print &prin
 	return out;
 }
 
+std::vector<std::vector<size_t>> chain_sites_by_layers(const Points &sites, const std::vector<std::vector<size_t>> &sites_by_layer, size_t lookahead_layers)
+{
+	std::vector<std::vector<size_t>> out(sites_by_layer.size());
+	if (sites.empty())
+		return out;
+	lookahead_layers = std::max<size_t>(lookahead_layers, 1);
+
+	// A closed tour over all the sites. Each layer visits its sites in the order of the tour, starting at any of them
+	// and following the tour in either direction, thus only the edge between the last and the first site is left out.
+	std::vector<size_t> tour_position(sites.size(), 0);
+	{
+		std::vector<size_t> tour = chain_points(sites);
+		for (size_t i = 0; i < tour.size(); ++ i)
+			tour_position[tour[i]] = i;
+	}
+	auto distance = [&sites](size_t i, size_t j) { return (sites[i] - sites[j]).cast<double>().norm(); };
+
+	// Sites of a single layer ordered along the tour.
+	// A state k of a layer starts with cycle[k % cycle.size()] and it follows the tour if k < cycle.size(), otherwise backwards.
+	struct Layer {
+		std::vector<size_t> cycle;
+		double 				length = 0.;
+		size_t 				num_states() const { return cycle.size() * 2; }
+		size_t 				first(size_t state) const { return cycle[state % cycle.size()]; }
+		size_t 				last(size_t state) const {
+			size_t n = cycle.size();
+			size_t i = state % n;
+			return cycle[state < n ? (i + n - 1) % n : (i + 1) % n];
+		}
+	};
+	auto make_layer = [&tour_position, &distance](const std::vector<size_t> &layer_sites) {
+		Layer layer;
+		layer.cycle = layer_sites;
+		std::sort(layer.cycle.begin(), layer.cycle.end(), [&tour_position](size_t l, size_t r) { return tour_position[l] < tour_position[r]; });
+		for (size_t i = 0; i < layer.cycle.size(); ++ i)
+			layer.length += distance(layer.cycle[i], layer.cycle[(i + 1) % layer.cycle.size()]);
+		return layer;
+	};
+	auto path_length = [&distance](const Layer &layer, size_t state) { return layer.length - distance(layer.first(state), layer.last(state)); };
+
+	// Dynamic programming over windows of lookahead_layers layers: each window is planned to minimize the travel inside its layers
+	// and between them, starting from the site the previous window ended with.
+	size_t last_site = size_t(-1);
+	std::vector<Layer> 				 window;
+	std::vector<std::vector<double>> cost;
+	std::vector<std::vector<size_t>> previous;
+	for (size_t window_begin = 0; window_begin < sites_by_layer.size(); window_begin += lookahead_layers) {
+		size_t window_end = std::min(window_begin + lookahead_layers, sites_by_layer.size());
+		window.clear();
+		cost.clear();
+		previous.clear();
+		// Index of the last non-empty layer of the window.
+		size_t last_layer = size_t(-1);
+		for (size_t layer_idx = window_begin; layer_idx < window_end; ++ layer_idx) {
+			window.emplace_back(make_layer(sites_by_layer[layer_idx]));
+			const Layer &layer = window.back();
+			cost.emplace_back(layer.num_states(), 0.);
+			previous.emplace_back(layer.num_states(), size_t(-1));
+			if (layer.cycle.empty())
+				continue;
+			const Layer *prev_layer = last_layer == size_t(-1) ? nullptr : &window[last_layer];
+			// The best state of the previous layer to continue from to each of the sites of this layer.
+			std::vector<std::pair<double, size_t>> best_previous(layer.cycle.size(), std::make_pair(0., size_t(-1)));
+			for (size_t i = 0; i < layer.cycle.size(); ++ i) {
+				if (prev_layer == nullptr) {
+					if (last_site != size_t(-1))
+						best_previous[i].first = distance(last_site, layer.cycle[i]);
+				} else {
+					best_previous[i].first = std::numeric_limits<double>::max();
+					for (size_t state = 0; state < prev_layer->num_states(); ++ state) {
+						double c = cost[last_layer][state] + distance(prev_layer->last(state), layer.cycle[i]);
+						if (c < best_previous[i].first)
+							best_previous[i] = std::make_pair(c, state);
+					}
+				}
+			}
+			for (size_t state = 0; state < layer.num_states(); ++ state) {
+				const std::pair<double, size_t> &best = best_previous[state % layer.cycle.size()];
+				cost.back()[state]     = best.first + path_length(layer, state);
+				previous.back()[state] = best.second;
+			}
+			last_layer = window.size() - 1;
+		}
+		if (last_layer == size_t(-1))
+			// No site printed by this window.
+			continue;
+		// Trace back the best plan of the window.
+		size_t state = std::min_element(cost[last_layer].begin(), cost[last_layer].end()) - cost[last_layer].begin();
+		last_site = window[last_layer].last(state);
+		for (size_t layer_idx = last_layer + 1; layer_idx > 0; -- layer_idx) {
+			const Layer &layer = window[layer_idx - 1];
+			if (layer.cycle.empty())
+				continue;
+			std::vector<size_t> &order = out[window_begin + layer_idx - 1];
+			size_t n = layer.cycle.size();
+			size_t i = state % n;
+			for (size_t j = 0; j < n; ++ j)
+				order.emplace_back(layer.cycle[state < n ? (i + j) % n : (i + n - j) % n]);
+			state = previous[layer_idx - 1][state];
+		}
+	}
+	return out;
+}
+
+std::vector<std::vector<const PrintInstance*>> chain_print_object_instances(const Print &print, const std::vector<std::vector<const PrintObject*>> &objects_by_layer, size_t lookahead_layers)
+{
+	// Sliced PrintObjects are centered, PrintInstance::shift is the center of the PrintObject in G-code coordinates.
+	Points 							  object_reference_points;
+	std::vector<const PrintInstance*> instances;
+	std::vector<size_t> 			  first_instance_of_object;
+	for (const PrintObject *object : print.objects()) {
+		first_instance_of_object.emplace_back(instances.size());
+		for (const PrintInstance &instance : object->instances()) {
+			object_reference_points.emplace_back(instance.shift);
+			instances.emplace_back(&instance);
+		}
+	}
+	std::vector<std::vector<size_t>> sites_by_layer;
+	sites_by_layer.reserve(objects_by_layer.size());
+	for (const std::vector<const PrintObject*> &objects : objects_by_layer) {
+		sites_by_layer.emplace_back();
+		for (const PrintObject *object : objects) {
+			size_t object_idx = std::find(print.objects().begin(), print.objects().end(), object) - print.objects().begin();
+			assert(object_idx < print.objects().size());
+			for (size_t i = 0; i < object->instances().size(); ++ i)
+				sites_by_layer.back().emplace_back(first_instance_of_object[object_idx] + i);
+		}
+	}
+	std::vector<std::vector<const PrintInstance*>> out;
+	out.reserve(objects_by_layer.size());
+	for (const std::vector<size_t> &order : chain_sites_by_layers(object_reference_points, sites_by_layer, lookahead_layers)) {
+		out.emplace_back();
+		out.back().reserve(order.size());
+		for (size_t site : order)
+			out.back().emplace_back(instances[site]);
+	}
+	return out;
+}
+
 Polylines chain_lines(const std::vector<Line> &lines, const double point_distance_epsilon)
 {
     // Create line end point lookup.
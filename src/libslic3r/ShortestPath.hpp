@@ -33,6 +33,15 @@ class Print;
 struct PrintInstance;
 std::vector<const PrintInstance*> 	 chain_print_object_instances(const Print &print);
 
+// Plan the order of the sites visited on each layer, minimizing the travel inside the layers and from one layer to the next one
+// over windows of lookahead_layers layers. sites_by_layer lists indices of sites printed on each layer.
+// Returns the ordered indices of sites for each layer.
+std::vector<std::vector<size_t>>	 chain_sites_by_layers(const Points &sites, const std::vector<std::vector<size_t>> &sites_by_layer, size_t lookahead_layers);
+// Order the instances of print objects layer by layer with chain_sites_by_layers().
+// objects_by_layer lists the print objects printed on each layer.
+class PrintObject;
+std::vector<std::vector<const PrintInstance*>> chain_print_object_instances(const Print &print, const std::vector<std::vector<const PrintObject*>> &objects_by_layer, size_t lookahead_layers);
+
 // Chain lines into polylines.
 Polylines 							 chain_lines(const std::vector<Line> &lines, const double point_distance_epsilon);
 
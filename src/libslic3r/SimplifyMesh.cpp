@@ -1,6 +1,12 @@
 #include "SimplifyMesh.hpp"
 #include "SimplifyMeshImpl.hpp"
 
+#include <libslic3r/BoundingBox.hpp>
+
+#include <unordered_map>
+
+#include <tbb/parallel_for.h>
+
 namespace SimplifyMesh {
 
 template<> struct vertex_traits<stl_vertex> {
@@ -63,4 +69,123 @@ void simplify_mesh(indexed_triangle_set &m)
     sm.simplify_mesh_lossless();
 }
 
+// Meshes with more faces are split into regions of roughly this size
+// to be simplified in parallel.
+static constexpr size_t SIMPLIFY_REGION_FACES = 100000;
+
+// Simplifies the regions of a spatial grid independently. The faces touching
+// the vertices shared between the regions are kept intact, so that the regions
+// stitch together again.
+static void simplify_regions(indexed_triangle_set &m, size_t face_count, float aggressiveness)
+{
+    BoundingBoxf3 bb;
+    for (const stl_vertex &v : m.vertices) bb.merge(v.cast<double>());
+    
+    int grid = std::max(1, int(std::ceil(std::cbrt(double(m.indices.size()) / SIMPLIFY_REGION_FACES))));
+    Vec3d cell = bb.size() / grid;
+    auto region_of = [&](const stl_triangle_vertex_indices &f) {
+        Vec3d c = (m.vertices[f(0)] + m.vertices[f(1)] + m.vertices[f(2)]).cast<double>() / 3. - bb.min;
+        int   r = 0;
+        for (int i = 2; i >= 0; --i)
+            r = r * grid + std::clamp(cell(i) > 0. ? int(c(i) / cell(i)) : 0, 0, grid - 1);
+        return r;
+    };
+    
+    const int SHARED = -2;
+    std::vector<int> face_region(m.indices.size());
+    std::vector<int> vertex_region(m.vertices.size(), -1);
+    for (size_t fi = 0; fi < m.indices.size(); ++fi) {
+        int r = face_region[fi] = region_of(m.indices[fi]);
+        for (int i = 0; i < 3; ++i) {
+            int &vr = vertex_region[m.indices[fi](i)];
+            vr = (vr == -1 || vr == r) ? r : SHARED;
+        }
+    }
+    
+    std::vector<std::vector<size_t>> region_faces(size_t(grid * grid * grid));
+    for (size_t fi = 0; fi < m.indices.size(); ++fi)
+        region_faces[face_region[fi]].emplace_back(fi);
+    
+    // Simplified regions, the shared vertices come first and keep their position
+    // in the vertex list, the global indices of these are stored aside.
+    std::vector<indexed_triangle_set> regions(region_faces.size());
+    std::vector<std::vector<int>>     region_shared(region_faces.size());
+    double ratio = double(face_count) / double(m.indices.size());
+    
+    tbb::parallel_for(size_t(0), regions.size(), [&](size_t r) {
+        const std::vector<size_t> &faces = region_faces[r];
+        if (faces.empty()) return;
+        
+        // Local vertex indices, shared vertices first.
+        std::vector<int> &shared = region_shared[r];
+        std::unordered_map<int, int> local_id;
+        for (size_t fi : faces)
+            for (int i = 0; i < 3; ++i) {
+                int v = m.indices[fi](i);
+                if (vertex_region[v] == SHARED && local_id.emplace(v, int(shared.size())).second)
+                    shared.emplace_back(v);
+            }
+        
+        indexed_triangle_set &its = regions[r];
+        for (int v : shared) its.vertices.emplace_back(m.vertices[v]);
+        its.indices.reserve(faces.size());
+        std::vector<bool> locked_face(faces.size(), false);
+        for (size_t k = 0; k < faces.size(); ++k) {
+            stl_triangle_vertex_indices f;
+            for (int i = 0; i < 3; ++i) {
+                int v = m.indices[faces[k]](i);
+                auto it = local_id.find(v);
+                if (it == local_id.end()) {
+                    it = local_id.emplace(v, int(its.vertices.size())).first;
+                    its.vertices.emplace_back(m.vertices[v]);
+                }
+                f(i) = it->second;
+                locked_face[k] = locked_face[k] || vertex_region[v] == SHARED;
+            }
+            its.indices.emplace_back(f);
+        }
+        
+        SimplifyMesh::implementation::SimplifiableMesh sm{&its};
+        for (size_t k = 0; k < faces.size(); ++k)
+            if (locked_face[k])
+                for (int i = 0; i < 3; ++i) sm.lock_vertex(size_t(its.indices[k](i)));
+        sm.simplify_mesh(size_t(ratio * double(faces.size())), aggressiveness);
+    });
+    
+    // Stitch the regions back together.
+    indexed_triangle_set out;
+    std::vector<int> shared_id(m.vertices.size(), -1);
+    for (size_t r = 0; r < regions.size(); ++r) {
+        const indexed_triangle_set &its = regions[r];
+        const std::vector<int> &    shared = region_shared[r];
+        std::vector<int> global_id(its.vertices.size());
+        for (size_t v = 0; v < its.vertices.size(); ++v) {
+            int &id = v < shared.size() ? shared_id[shared[v]] : global_id[v];
+            if (v >= shared.size() || id == -1) {
+                id = int(out.vertices.size());
+                out.vertices.emplace_back(its.vertices[v]);
+            }
+            global_id[v] = id;
+        }
+        for (const stl_triangle_vertex_indices &f : its.indices)
+            out.indices.emplace_back(global_id[f(0)], global_id[f(1)], global_id[f(2)]);
+    }
+    m = std::move(out);
+}
+
+void simplify_mesh(indexed_triangle_set &m, size_t face_count, float aggressiveness)
+{
+    if (m.indices.size() <= face_count)
+        return;
+    
+    if (m.indices.size() > 2 * SIMPLIFY_REGION_FACES)
+        simplify_regions(m, face_count, aggressiveness);
+    
+    // Final pass over the whole mesh, it mostly collapses the borders of the regions.
+    if (m.indices.size() > face_count) {
+        SimplifyMesh::implementation::SimplifiableMesh sm{&m};
+        sm.simplify_mesh(face_count, aggressiveness);
+    }
+}
+
 }
@@ -9,8 +9,10 @@ namespace Slic3r {
 
 void simplify_mesh(indexed_triangle_set &);
 
-// TODO: (but this can be done with IGL as well)
-// void simplify_mesh(indexed_triangle_set &, int face_count, float agressiveness = 0.5f);
+// Quadric edge collapse down to face_count faces. Large meshes are split into
+// a spatial grid of regions simplified in parallel, the borders of the regions
+// are collapsed by a final pass over the whole mesh.
+void simplify_mesh(indexed_triangle_set &, size_t face_count, float aggressiveness = 7.f);
 
 template<class...Args> void simplify_mesh(TriangleMesh &m, Args &&...a)
 {
@@ -210,6 +210,8 @@ template<class Mesh> class SimplifiableMesh {
         size_t idx;
         size_t tstart = 0, tcount = 0;
         bool border = false;
+        // Locked vertices are neither moved nor collapsed.
+        bool locked = false;
         SymMat q;
         explicit VertexInfo(size_t id): idx(id) {}
     };
@@ -305,6 +307,11 @@ template<class Mesh> class SimplifiableMesh {
     // Check if a triangle flips when this edge is removed
     bool flipped(const Vertex &p, size_t i0, size_t i1, VertexInfo &v0, VertexInfo &v1, std::vector<bool> &deleted);
     
+    // Collapse the edges with error below the threshold, until stop_fn() returns true
+    template<class StopFn> void collapse_edges(double threshold, int &deleted_triangles, StopFn &&stop_fn);
+    
+    std::vector<bool> m_deleted0, m_deleted1;
+    
 public:
     
     explicit SimplifiableMesh(Mesh *m) : m_mesh{m}
@@ -322,6 +329,13 @@ public:
     
     template<class ProgressFn> void simplify_mesh_lossless(ProgressFn &&fn);
     void simplify_mesh_lossless() { simplify_mesh_lossless([](int){}); }
+    
+    // Collapse the edges of the least error until the face count drops to
+    // target_count. Higher aggressiveness trades quality for speed.
+    template<class ProgressFn> void simplify_mesh(size_t target_count, double aggressiveness, ProgressFn &&fn);
+    void simplify_mesh(size_t target_count, double aggressiveness = 7.) { simplify_mesh(target_count, aggressiveness, [](int){}); }
+    
+    void lock_vertex(size_t vertex_idx) { m_vertexinfo[vertex_idx].locked = true; }
 };
 
 template<class Mesh> void SimplifiableMesh<Mesh>::compact_faces()
@@ -582,7 +596,6 @@ template<class Fn> void SimplifiableMesh<Mesh>::simplify_mesh_lossless(Fn &&fn)
     
     // main iteration loop
     int deleted_triangles=0;
-    std::vector<bool> deleted0, deleted1;
     
     for (int iteration = 0; iteration < 9999; iteration ++) {
         // update mesh constantly
@@ -601,64 +614,100 @@ template<class Fn> void SimplifiableMesh<Mesh>::simplify_mesh_lossless(Fn &&fn)
         
         fn(iteration);
         
-        for (FaceInfo &fi : m_faceinfo) {
-            if (fi.err[3] > threshold || fi.deleted || fi.dirty) continue;
+        collapse_edges(threshold, deleted_triangles, []() { return false; });
+        
+        if (deleted_triangles <= 0) break;
+        deleted_triangles = 0;
+    }
+    
+    compact();
+}
+
+template<class Mesh>
+template<class StopFn>
+void SimplifiableMesh<Mesh>::collapse_edges(double threshold, int &deleted_triangles, StopFn &&stop_fn)
+{
+    for (FaceInfo &fi : m_faceinfo) {
+        if (stop_fn()) break;
+        if (fi.err[3] > threshold || fi.deleted || fi.dirty) continue;
+        
+        for (size_t j = 0; j < 3; ++j) {
+            if (fi.err[j] > threshold) continue;
             
-            for (size_t j = 0; j < 3; ++j) {
-                if (fi.err[j] > threshold) continue;
-                
-                Index3 t = read_triangle(fi);
-                size_t i0 = t[j];
-                VertexInfo &v0 = m_vertexinfo[i0];
-                
-                size_t i1 = t[(j + 1) % 3];
-                VertexInfo &v1 = m_vertexinfo[i1];
+            Index3 t = read_triangle(fi);
+            size_t i0 = t[j];
+            VertexInfo &v0 = m_vertexinfo[i0];
+            
+            size_t i1 = t[(j + 1) % 3];
+            VertexInfo &v1 = m_vertexinfo[i1];
 
-                // Border check
-                if(v0.border != v1.border) continue;
+            // Border check
+            if(v0.border != v1.border || v0.locked || v1.locked) continue;
 
-                // Compute vertex to collapse to
-                Vertex p;
-                calculate_error(i0, i1, p);
+            // Compute vertex to collapse to
+            Vertex p;
+            calculate_error(i0, i1, p);
 
-                deleted0.resize(v0.tcount); // normals temporarily
-                deleted1.resize(v1.tcount); // normals temporarily
+            m_deleted0.resize(v0.tcount); // normals temporarily
+            m_deleted1.resize(v1.tcount); // normals temporarily
 
-                // don't remove if flipped
-                if (flipped(p, i0, i1, v0, v1, deleted0)) continue;
-                if (flipped(p, i1, i0, v1, v0, deleted1)) continue;
+            // don't remove if flipped
+            if (flipped(p, i0, i1, v0, v1, m_deleted0)) continue;
+            if (flipped(p, i1, i0, v1, v0, m_deleted1)) continue;
 
-                // not flipped, so remove edge
-                write_vertex(v0, p);
-                v0.q = v1.q + v0.q;
-                size_t tstart = m_refs.size();
+            // not flipped, so remove edge
+            write_vertex(v0, p);
+            v0.q = v1.q + v0.q;
+            size_t tstart = m_refs.size();
 
-                update_triangles(i0, v0, deleted0, deleted_triangles);
-                update_triangles(i0, v1, deleted1, deleted_triangles);
-                
-                assert(m_refs.size() >= tstart);
-                
-                size_t tcount = m_refs.size() - tstart;
-
-                if(tcount <= v0.tcount)
-                {
-                    // save ram
-                    if (tcount) {
-                        auto from = m_refs.begin() + tstart, to = from + tcount;
-                        std::copy(from, to, m_refs.begin() + v0.tstart);
-                    }
+            update_triangles(i0, v0, m_deleted0, deleted_triangles);
+            update_triangles(i0, v1, m_deleted1, deleted_triangles);
+            
+            assert(m_refs.size() >= tstart);
+            
+            size_t tcount = m_refs.size() - tstart;
+
+            if(tcount <= v0.tcount)
+            {
+                // save ram
+                if (tcount) {
+                    auto from = m_refs.begin() + tstart, to = from + tcount;
+                    std::copy(from, to, m_refs.begin() + v0.tstart);
                 }
-                else
-                    // append
-                    v0.tstart = tstart;
-
-                v0.tcount = tcount;
-                break;
             }
+            else
+                // append
+                v0.tstart = tstart;
+
+            v0.tcount = tcount;
+            break;
         }
+    }
+}
+
+template<class Mesh>
+template<class Fn> void SimplifiableMesh<Mesh>::simplify_mesh(size_t target_count, double aggressiveness, Fn &&fn)
+{
+    for (FaceInfo &fi : m_faceinfo) fi.deleted = false;
+    
+    int deleted_triangles = 0;
+    size_t triangle_count = m_faceinfo.size();
+    auto target_reached = [&]() { return triangle_count - size_t(deleted_triangles) <= target_count; };
+    
+    for (int iteration = 0; iteration < 100 && ! target_reached(); iteration ++) {
+        // update mesh once in a while
+        if (iteration % 5 == 0) update_mesh(iteration);
         
-        if (deleted_triangles <= 0) break;
-        deleted_triangles = 0;
+        // clear dirty flag
+        for (FaceInfo &fi : m_faceinfo) fi.dirty = false;
+        
+        // All triangles with edges below the threshold will be removed,
+        // the threshold grows with the iterations.
+        double threshold = 0.000000001 * std::pow(double(iteration + 3), aggressiveness);
+        
+        fn(iteration);
+        
+        collapse_edges(threshold, deleted_triangles, target_reached);
     }
     
     compact();
@@ -0,0 +1,511 @@
+#include "SlicesCache.hpp"
+
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+
+// Version of the on-disk format, bump it whenever the layout or the slicing algorithm changes.
+static const char SLICES_CACHE_MAGIC[8] = { 'S', 'L', 'C', 'A', 'C', 'H', 'E', '2' };
+
+namespace {
+
+template<typename T> void write_pod(std::ostream &os, const T &value) { os.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+template<typename T> bool read_pod(std::istream &is, T &value) { return bool(is.read(reinterpret_cast<char*>(&value), sizeof(T))); }
+
+template<typename T> void write_pod_vector(std::ostream &os, const std::vector<T> &values)
+{
+    write_pod(os, uint32_t(values.size()));
+    os.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template<typename T> bool read_pod_vector(std::istream &is, std::vector<T> &values)
+{
+    uint32_t n;
+    if (! read_pod(is, n))
+        return false;
+    values.assign(n, T());
+    return bool(is.read(reinterpret_cast<char*>(values.data()), n * sizeof(T)));
+}
+
+void write_expolygon(std::ostream &os, const ExPolygon &expoly)
+{
+    write_pod_vector(os, expoly.contour.points);
+    write_pod(os, uint32_t(expoly.holes.size()));
+    for (const Polygon &hole : expoly.holes)
+        write_pod_vector(os, hole.points);
+}
+
+bool read_expolygon(std::istream &is, ExPolygon &expoly)
+{
+    uint32_t n;
+    if (! read_pod_vector(is, expoly.contour.points) || ! read_pod(is, n))
+        return false;
+    expoly.holes.assign(n, Polygon());
+    for (Polygon &hole : expoly.holes)
+        if (! read_pod_vector(is, hole.points))
+            return false;
+    return true;
+}
+
+void write_expolygons(std::ostream &os, const ExPolygons &expolys)
+{
+    write_pod(os, uint32_t(expolys.size()));
+    for (const ExPolygon &expoly : expolys)
+        write_expolygon(os, expoly);
+}
+
+bool read_expolygons(std::istream &is, ExPolygons &expolys)
+{
+    uint32_t n;
+    if (! read_pod(is, n))
+        return false;
+    expolys.assign(n, ExPolygon());
+    for (ExPolygon &expoly : expolys)
+        if (! read_expolygon(is, expoly))
+            return false;
+    return true;
+}
+
+void write_surfaces(std::ostream &os, const Surfaces &surfaces)
+{
+    write_pod(os, uint32_t(surfaces.size()));
+    for (const Surface &surface : surfaces) {
+        write_pod(os, uint16_t(surface.surface_type));
+        write_pod(os, surface.thickness);
+        write_pod(os, surface.thickness_layers);
+        write_pod(os, surface.bridge_angle);
+        write_pod(os, surface.extra_perimeters);
+        write_pod(os, surface.maxNbSolidLayersOnTop);
+        write_expolygon(os, surface.expolygon);
+    }
+}
+
+bool read_surfaces(std::istream &is, Surfaces &surfaces)
+{
+    uint32_t n;
+    if (! read_pod(is, n))
+        return false;
+    surfaces.reserve(n);
+    for (uint32_t i = 0; i < n; ++ i) {
+        uint16_t type;
+        if (! read_pod(is, type))
+            return false;
+        Surface surface { SurfaceType(type), ExPolygon() };
+        if (! read_pod(is, surface.thickness) || ! read_pod(is, surface.thickness_layers) || ! read_pod(is, surface.bridge_angle) ||
+            ! read_pod(is, surface.extra_perimeters) || ! read_pod(is, surface.maxNbSolidLayersOnTop) || ! read_expolygon(is, surface.expolygon))
+            return false;
+        surfaces.emplace_back(std::move(surface));
+    }
+    return true;
+}
+
+enum ExtrusionTag : uint8_t {
+    etPath,
+    etPath3D,
+    etMultiPath,
+    etMultiPath3D,
+    etLoop,
+    etCollection,
+};
+
+// Writes the extrusion entities with a type tag in front of each of them, so that read_extrusion_entity() knows what to instantiate.
+class ExtrusionWriter : public ExtrusionVisitorConst {
+public:
+    ExtrusionWriter(std::ostream &os) : m_os(os) {}
+
+    void use(const ExtrusionPath &path) override { write_pod(m_os, etPath); this->write_path(path); }
+    void use(const ExtrusionPath3D &path3D) override { write_pod(m_os, etPath3D); this->write_path3D(path3D); }
+    void use(const ExtrusionMultiPath &multipath) override {
+        write_pod(m_os, etMultiPath);
+        write_pod(m_os, uint32_t(multipath.paths.size()));
+        for (const ExtrusionPath &path : multipath.paths)
+            this->write_path(path);
+    }
+    void use(const ExtrusionMultiPath3D &multipath3D) override {
+        write_pod(m_os, etMultiPath3D);
+        write_pod(m_os, uint32_t(multipath3D.paths.size()));
+        for (const ExtrusionPath3D &path : multipath3D.paths)
+            this->write_path3D(path);
+    }
+    void use(const ExtrusionLoop &loop) override {
+        write_pod(m_os, etLoop);
+        write_pod(m_os, uint16_t(loop.loop_role()));
+        write_pod(m_os, uint32_t(loop.paths.size()));
+        for (const ExtrusionPath &path : loop.paths)
+            this->write_path(path);
+    }
+    void use(const ExtrusionEntityCollection &collection) override {
+        write_pod(m_os, etCollection);
+        write_pod(m_os, uint8_t(collection.no_sort));
+        write_pod(m_os, uint32_t(collection.entities.size()));
+        for (const ExtrusionEntity *entity : collection.entities)
+            entity->visit(*this);
+    }
+
+private:
+    void write_path(const ExtrusionPath &path) {
+        write_pod(m_os, uint16_t(path.role()));
+        write_pod(m_os, path.mm3_per_mm);
+        write_pod(m_os, path.width);
+        write_pod(m_os, path.height);
+        write_pod_vector(m_os, path.polyline.points);
+    }
+    void write_path3D(const ExtrusionPath3D &path) {
+        this->write_path(path);
+        write_pod_vector(m_os, path.z_offsets);
+    }
+
+    std::ostream &m_os;
+};
+
+bool read_path(std::istream &is, ExtrusionPath &path)
+{
+    uint16_t role;
+    if (! read_pod(is, role) || ! read_pod(is, path.mm3_per_mm) || ! read_pod(is, path.width) || ! read_pod(is, path.height) ||
+        ! read_pod_vector(is, path.polyline.points))
+        return false;
+    path.set_role(ExtrusionRole(role));
+    return true;
+}
+
+bool read_path3D(std::istream &is, ExtrusionPath3D &path)
+{
+    return read_path(is, path) && read_pod_vector(is, path.z_offsets);
+}
+
+template<typename PathType, typename ReadPath>
+bool read_paths(std::istream &is, std::vector<PathType> &paths, ReadPath read)
+{
+    uint32_t n;
+    if (! read_pod(is, n))
+        return false;
+    paths.assign(n, PathType(erNone));
+    for (PathType &path : paths)
+        if (! read(is, path))
+            return false;
+    return true;
+}
+
+// Returns nullptr on a read error.
+std::unique_ptr<ExtrusionEntity> read_extrusion_entity(std::istream &is);
+
+bool read_collection_content(std::istream &is, ExtrusionEntityCollection &collection)
+{
+    uint8_t  no_sort;
+    uint32_t n;
+    if (! read_pod(is, no_sort) || ! read_pod(is, n))
+        return false;
+    collection.no_sort = no_sort != 0;
+    collection.entities.reserve(n);
+    for (uint32_t i = 0; i < n; ++ i) {
+        std::unique_ptr<ExtrusionEntity> entity = read_extrusion_entity(is);
+        if (! entity)
+            return false;
+        collection.entities.emplace_back(entity.release());
+    }
+    return true;
+}
+
+std::unique_ptr<ExtrusionEntity> read_extrusion_entity(std::istream &is)
+{
+    uint8_t tag;
+    if (! read_pod(is, tag))
+        return nullptr;
+    switch (tag) {
+    case etPath: {
+        auto path = std::make_unique<ExtrusionPath>(erNone);
+        return read_path(is, *path) ? std::move(path) : nullptr;
+    }
+    case etPath3D: {
+        auto path = std::make_unique<ExtrusionPath3D>(erNone);
+        return read_path3D(is, *path) ? std::move(path) : nullptr;
+    }
+    case etMultiPath: {
+        auto multipath = std::make_unique<ExtrusionMultiPath>();
+        return read_paths(is, multipath->paths, read_path) ? std::move(multipath) : nullptr;
+    }
+    case etMultiPath3D: {
+        auto multipath = std::make_unique<ExtrusionMultiPath3D>();
+        return read_paths(is, multipath->paths, read_path3D) ? std::move(multipath) : nullptr;
+    }
+    case etLoop: {
+        uint16_t role;
+        if (! read_pod(is, role))
+            return nullptr;
+        auto loop = std::make_unique<ExtrusionLoop>(ExtrusionLoopRole(role));
+        return read_paths(is, loop->paths, read_path) ? std::move(loop) : nullptr;
+    }
+    case etCollection: {
+        auto collection = std::make_unique<ExtrusionEntityCollection>();
+        return read_collection_content(is, *collection) ? std::move(collection) : nullptr;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+void write_collection(std::ostream &os, const ExtrusionEntityCollection &collection)
+{
+    ExtrusionWriter writer(os);
+    collection.visit(writer);
+}
+
+bool read_collection(std::istream &is, ExtrusionEntityCollection &collection)
+{
+    uint8_t tag;
+    return read_pod(is, tag) && tag == etCollection && read_collection_content(is, collection);
+}
+
+// Estimate of the memory occupied by the extrusion entities.
+class ExtrusionMemorySize : public ExtrusionVisitorConst {
+public:
+    size_t size = 0;
+
+    void use(const ExtrusionPath &path) override { size += sizeof(ExtrusionPath) + path.polyline.points.capacity() * sizeof(Point); }
+    void use(const ExtrusionPath3D &path3D) override {
+        size += sizeof(ExtrusionPath3D) - sizeof(ExtrusionPath) + path3D.z_offsets.capacity() * sizeof(coord_t);
+        this->use(static_cast<const ExtrusionPath&>(path3D));
+    }
+    void use(const ExtrusionMultiPath &multipath) override {
+        size += sizeof(ExtrusionMultiPath);
+        for (const ExtrusionPath &path : multipath.paths)
+            this->use(path);
+    }
+    void use(const ExtrusionMultiPath3D &multipath3D) override {
+        size += sizeof(ExtrusionMultiPath3D);
+        for (const ExtrusionPath3D &path : multipath3D.paths)
+            this->use(path);
+    }
+    void use(const ExtrusionLoop &loop) override {
+        size += sizeof(ExtrusionLoop);
+        for (const ExtrusionPath &path : loop.paths)
+            this->use(path);
+    }
+    void use(const ExtrusionEntityCollection &collection) override {
+        size += sizeof(ExtrusionEntityCollection) + collection.entities.capacity() * sizeof(ExtrusionEntity*);
+        for (const ExtrusionEntity *entity : collection.entities)
+            entity->visit(*this);
+    }
+};
+
+void write_entry(std::ostream &os, const SlicesCache::Entry &entry)
+{
+    os.write(SLICES_CACHE_MAGIC, sizeof(SLICES_CACHE_MAGIC));
+    write_pod(os, uint32_t(sizeof(coord_t)));
+    write_pod(os, uint32_t(entry.layers.size()));
+    for (const SlicesCache::Layer &layer : entry.layers) {
+        write_pod(os, uint64_t(layer.id));
+        write_pod(os, layer.height);
+        write_pod(os, layer.print_z);
+        write_pod(os, layer.slice_z);
+        write_pod(os, uint8_t(layer.slicing_errors));
+        write_expolygons(os, layer.lslices);
+        write_pod(os, uint32_t(layer.region_slices.size()));
+        for (const Surfaces &surfaces : layer.region_slices)
+            write_surfaces(os, surfaces);
+        write_pod(os, uint32_t(layer.region_perimeters.size()));
+        for (const SlicesCache::RegionPerimeters &perimeters : layer.region_perimeters) {
+            write_surfaces(os, perimeters.slices);
+            write_surfaces(os, perimeters.fill_surfaces);
+            write_expolygons(os, perimeters.fill_expolygons);
+            write_expolygons(os, perimeters.fill_no_overlap_expolygons);
+            write_collection(os, perimeters.perimeters);
+            write_collection(os, perimeters.thin_fills);
+        }
+    }
+}
+
+bool read_entry(std::istream &is, SlicesCache::Entry &entry)
+{
+    char     magic[sizeof(SLICES_CACHE_MAGIC)];
+    uint32_t coord_size, num_layers;
+    if (! is.read(magic, sizeof(magic)) || memcmp(magic, SLICES_CACHE_MAGIC, sizeof(magic)) != 0 ||
+        ! read_pod(is, coord_size) || coord_size != sizeof(coord_t) || ! read_pod(is, num_layers))
+        return false;
+    entry.layers.assign(num_layers, SlicesCache::Layer());
+    for (SlicesCache::Layer &layer : entry.layers) {
+        uint64_t id;
+        uint8_t  slicing_errors;
+        uint32_t n;
+        if (! read_pod(is, id) || ! read_pod(is, layer.height) || ! read_pod(is, layer.print_z) || ! read_pod(is, layer.slice_z) ||
+            ! read_pod(is, slicing_errors) || ! read_expolygons(is, layer.lslices) || ! read_pod(is, n))
+            return false;
+        layer.id             = size_t(id);
+        layer.slicing_errors = slicing_errors != 0;
+        layer.region_slices.assign(n, Surfaces());
+        for (Surfaces &surfaces : layer.region_slices)
+            if (! read_surfaces(is, surfaces))
+                return false;
+        if (! read_pod(is, n))
+            return false;
+        layer.region_perimeters.assign(n, SlicesCache::RegionPerimeters());
+        for (SlicesCache::RegionPerimeters &perimeters : layer.region_perimeters)
+            if (! read_surfaces(is, perimeters.slices) || ! read_surfaces(is, perimeters.fill_surfaces) ||
+                ! read_expolygons(is, perimeters.fill_expolygons) || ! read_expolygons(is, perimeters.fill_no_overlap_expolygons) ||
+                ! read_collection(is, perimeters.perimeters) || ! read_collection(is, perimeters.thin_fills))
+                return false;
+    }
+    return true;
+}
+
+} // namespace
+
+size_t SlicesCache::Entry::memory_size() const
+{
+    auto expolygon_size = [](const ExPolygon &expoly) {
+        size_t out = sizeof(ExPolygon) + expoly.contour.points.capacity() * sizeof(Point);
+        for (const Polygon &hole : expoly.holes)
+            out += sizeof(Polygon) + hole.points.capacity() * sizeof(Point);
+        return out;
+    };
+    auto surfaces_size = [&expolygon_size](const Surfaces &surfaces) {
+        size_t out = sizeof(Surfaces);
+        for (const Surface &surface : surfaces)
+            out += sizeof(Surface) - sizeof(ExPolygon) + expolygon_size(surface.expolygon);
+        return out;
+    };
+    size_t out = sizeof(Entry) + layers.capacity() * sizeof(Layer);
+    for (const Layer &layer : layers) {
+        for (const ExPolygon &expoly : layer.lslices)
+            out += expolygon_size(expoly);
+        for (const Surfaces &surfaces : layer.region_slices)
+            out += surfaces_size(surfaces);
+        for (const RegionPerimeters &perimeters : layer.region_perimeters) {
+            out += sizeof(RegionPerimeters) + surfaces_size(perimeters.slices) + surfaces_size(perimeters.fill_surfaces);
+            for (const ExPolygon &expoly : perimeters.fill_expolygons)
+                out += expolygon_size(expoly);
+            for (const ExPolygon &expoly : perimeters.fill_no_overlap_expolygons)
+                out += expolygon_size(expoly);
+            ExtrusionMemorySize extrusions_size;
+            perimeters.perimeters.visit(extrusions_size);
+            perimeters.thin_fills.visit(extrusions_size);
+            out += extrusions_size.size;
+        }
+    }
+    return out;
+}
+
+SlicesCache& SlicesCache::instance()
+{
+    static SlicesCache cache;
+    return cache;
+}
+
+SlicesCache::EntryPtr SlicesCache::find(uint64_t key)
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_items.begin(); it != m_items.end(); ++ it)
+            if (it->key == key) {
+                // Move to the front as the most recently used.
+                m_items.splice(m_items.begin(), m_items, it);
+                return m_items.front().entry;
+            }
+        if (m_directory.empty())
+            return nullptr;
+        path = this->file_path(key);
+    }
+
+    // Read from disk outside of the lock, the other objects may be looking up their slices in the meantime.
+    boost::system::error_code ec;
+    if (! boost::filesystem::exists(path, ec))
+        return nullptr;
+    auto entry = std::make_shared<Entry>();
+    boost::nowide::ifstream is(path, std::ios::in | std::ios::binary);
+    if (! is.good() || ! read_entry(is, *entry)) {
+        BOOST_LOG_TRIVIAL(warning) << "SlicesCache: Failed to read " << path;
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_items.push_front({ key, entry, entry->memory_size() });
+    m_memory_size += m_items.front().memory_size;
+    this->shrink_to_limit();
+    return entry;
+}
+
+void SlicesCache::insert(uint64_t key, EntryPtr entry)
+{
+    assert(entry);
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_items.begin(); it != m_items.end(); ++ it)
+            if (it->key == key) {
+                m_memory_size -= it->memory_size;
+                m_items.erase(it);
+                break;
+            }
+        m_items.push_front({ key, entry, entry->memory_size() });
+        m_memory_size += m_items.front().memory_size;
+        this->shrink_to_limit();
+        if (m_directory.empty())
+            return;
+        path = this->file_path(key);
+    }
+
+    // Write into a temporary file first, so that a crash or a concurrent reader never sees a partially written entry.
+    std::string path_tmp = path + ".tmp";
+    {
+        boost::nowide::ofstream os(path_tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (os.good())
+            write_entry(os, *entry);
+        if (! os.good()) {
+            BOOST_LOG_TRIVIAL(warning) << "SlicesCache: Failed to write " << path_tmp;
+            return;
+        }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(path_tmp, path, ec);
+    if (ec)
+        BOOST_LOG_TRIVIAL(warning) << "SlicesCache: Failed to rename " << path_tmp << " to " << path << ": " << ec.message();
+}
+
+void SlicesCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_items.clear();
+    m_memory_size = 0;
+}
+
+void SlicesCache::set_directory(const std::string &dir)
+{
+    if (! dir.empty()) {
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(dir, ec);
+        if (ec) {
+            BOOST_LOG_TRIVIAL(error) << "SlicesCache: Failed to create directory " << dir << ": " << ec.message();
+            return;
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory = dir;
+}
+
+void SlicesCache::set_memory_limit(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memory_limit = bytes;
+    this->shrink_to_limit();
+}
+
+std::string SlicesCache::file_path(uint64_t key) const
+{
+    return (boost::filesystem::path(m_directory) / (boost::format("%016x.slices") % key).str()).string();
+}
+
+void SlicesCache::shrink_to_limit()
+{
+    // Always keep the most recently used entry, even if it is larger than the limit.
+    while (m_items.size() > 1 && m_memory_size > m_memory_limit) {
+        m_memory_size -= m_items.back().memory_size;
+        m_items.pop_back();
+    }
+}
+
+} // namespace Slic3r
@@ -0,0 +1,93 @@
+#ifndef slic3r_SlicesCache_hpp_
+#define slic3r_SlicesCache_hpp_
+
+#include "libslic3r.h"
+#include "ExPolygon.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include "Surface.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+// Content addressed cache of the results of PrintObject::slice() and of PrintObject::make_perimeters().
+// The key is a hash of everything the step depends on: the meshes and transformations of the volumes,
+// the layer height profile and the configuration values (see PrintObject::slices_cache_key() and PrintObject::perimeters_cache_key()).
+// When the user toggles a slicing related option back and forth, the second slicing is served from the cache.
+// The cache is shared by all the PrintObjects and it is thread safe, as the objects are sliced in parallel.
+// Optionally the entries are written into a directory, so that they survive an application restart
+// or are shared by several machines slicing the same jobs.
+class SlicesCache
+{
+public:
+    // Outputs of the perimeter generator of a LayerRegion, see Layer::copy_perimeters_from().
+    struct RegionPerimeters {
+        // LayerRegion::m_slices, the perimeter generator assigns the extra perimeters to the surfaces.
+        Surfaces                    slices;
+        Surfaces                    fill_surfaces;
+        ExPolygons                  fill_expolygons;
+        ExPolygons                  fill_no_overlap_expolygons;
+        ExtrusionEntityCollection   perimeters;
+        ExtrusionEntityCollection   thin_fills;
+    };
+
+    struct Layer {
+        size_t                  id             { 0 };
+        coordf_t                height         { 0. };
+        coordf_t                print_z        { 0. };
+        coordf_t                slice_z        { 0. };
+        bool                    slicing_errors { false };
+        ExPolygons              lslices;
+        // Surfaces of LayerRegion::m_slices, one vector per print region.
+        std::vector<Surfaces>   region_slices;
+        // One item per print region for the entries of the perimeters step, empty for the entries of the slicing step.
+        std::vector<RegionPerimeters> region_perimeters;
+    };
+
+    struct Entry {
+        std::vector<Layer>      layers;
+        // Estimate of the memory occupied by the entry, used to limit the size of the cache.
+        size_t                  memory_size() const;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    static SlicesCache&         instance();
+
+    // Returns nullptr if there is no entry for the key in memory nor on disk.
+    EntryPtr                    find(uint64_t key);
+    void                        insert(uint64_t key, EntryPtr entry);
+    void                        clear();
+
+    // Empty directory disables the on-disk backing. The directory is created if it does not exist.
+    void                        set_directory(const std::string &dir);
+    // Limit of the memory occupied by the entries held in memory. The least recently used entries are dropped first.
+    void                        set_memory_limit(size_t bytes);
+
+private:
+    SlicesCache() = default;
+
+    std::string                 file_path(uint64_t key) const;
+    // Called with m_mutex locked.
+    void                        shrink_to_limit();
+
+    struct Item {
+        uint64_t        key;
+        EntryPtr        entry;
+        size_t          memory_size;
+    };
+
+    std::mutex                  m_mutex;
+    // Most recently used first.
+    std::list<Item>             m_items;
+    size_t                      m_memory_size  { 0 };
+    size_t                      m_memory_limit { size_t(256) << 20 };
+    std::string                 m_directory;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_SlicesCache_hpp_ */
@@ -6,6 +6,8 @@
 #include "PrintConfig.hpp"
 #include "Model.hpp"
 
+#include <tbb/parallel_for.h>
+
 // #define SLIC3R_DEBUG
 
 // Make assert active if SLIC3R_DEBUG
@@ -762,7 +764,8 @@ std::vector<coordf_t> generate_object_layers(
 int generate_layer_height_texture(
 	const SlicingParameters 	&slicing_params,
 	const std::vector<coordf_t> &layers,
-	void *data, int rows, int cols, bool level_of_detail_2nd_level)
+	void *data, int rows, int cols, bool level_of_detail_2nd_level,
+	size_t                       first_layer)
 {
 // https://github.com/aschn/gnuplot-colorbrewer
     std::vector<Vec3i32> palette_raw;
@@ -790,68 +793,62 @@ int generate_layer_height_texture(
 	if (hscale == 0)
 		// All layers have the same height. Provide some height scale to avoid division by zero.
 		hscale = slicing_params.layer_height;
-    for (size_t idx_layer = 0; idx_layer < layers.size(); idx_layer += 2) {
-        coordf_t lo  = layers[idx_layer];
-		coordf_t hi  = layers[idx_layer + 1];
-        coordf_t mid = 0.5f * (lo + hi);
-		assert(mid <= slicing_params.object_print_z_height());
-		coordf_t h = hi - lo;
-		hi = std::min(hi, slicing_params.object_print_z_height());
-        int cell_first = clamp(0, ncells-1, int(ceil(lo * z_to_cell)));
-        int cell_last  = clamp(0, ncells-1, int(floor(hi * z_to_cell)));
-        for (int cell = cell_first; cell <= cell_last; ++ cell) {
+
+    // Rewrite the cell shared with the last unchanged layer as well.
+    first_layer = (first_layer > 0) ? std::min(first_layer, layers.size() / 2) - 1 : 0;
+    // Span of cells of each layer from first_layer up. A cell shared by two layers belongs to the upper one,
+    // so the span is cut at the first cell of the next non empty layer and the layers are filled in parallel.
+    size_t num_layers = layers.size() / 2 - std::min(first_layer, layers.size() / 2);
+    std::vector<std::pair<int, int>> cells(num_layers), cells1(level_of_detail_2nd_level ? num_layers : 0);
+    for (size_t i = 0; i < num_layers; ++ i) {
+        coordf_t lo = layers[(first_layer + i) * 2];
+        coordf_t hi = std::min(layers[(first_layer + i) * 2 + 1], slicing_params.object_print_z_height());
+        cells[i] = { clamp(0, ncells-1, int(ceil(lo * z_to_cell))), clamp(0, ncells-1, int(floor(hi * z_to_cell))) };
+        if (level_of_detail_2nd_level)
+            cells1[i] = { clamp(0, ncells1-1, int(ceil(lo * z_to_cell1))), clamp(0, ncells1-1, int(floor(hi * z_to_cell1))) };
+    }
+    auto cut_shared_cells = [](std::vector<std::pair<int, int>> &spans) {
+        int next_first = std::numeric_limits<int>::max();
+        for (auto it = spans.rbegin(); it != spans.rend(); ++ it) {
+            bool empty = it->first > it->second;
+            it->second = std::min(it->second, next_first - 1);
+            if (! empty)
+                next_first = it->first;
+        }
+    };
+    cut_shared_cells(cells);
+    cut_shared_cells(cells1);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            size_t   idx_layer = (first_layer + i) * 2;
+            coordf_t lo  = layers[idx_layer];
+            coordf_t hi  = layers[idx_layer + 1];
+            coordf_t mid = 0.5f * (lo + hi);
+            assert(mid <= slicing_params.object_print_z_height());
+            coordf_t h = hi - lo;
             coordf_t idxf = (0.5 * hscale + (h - slicing_params.layer_height)) * coordf_t(palette_raw.size()-1) / hscale;
             int idx1 = clamp(0, int(palette_raw.size() - 1), int(floor(idxf)));
             int idx2 = std::min(int(palette_raw.size() - 1), idx1 + 1);
-			coordf_t t = idxf - coordf_t(idx1);
+            coordf_t t = idxf - coordf_t(idx1);
             const Vec3i32 &color1 = palette_raw[idx1];
             const Vec3i32 &color2 = palette_raw[idx2];
-            coordf_t z = cell_to_z * coordf_t(cell);
-            assert(lo - EPSILON <= z && z <= hi + EPSILON);
-            // Intensity profile to visualize the layers.
-            coordf_t intensity = cos(M_PI * 0.7 * (mid - z) / h);
             // Color mapping from layer height to RGB.
-            Vec3d color(
-                intensity * lerp(coordf_t(color1(0)), coordf_t(color2(0)), t), 
-                intensity * lerp(coordf_t(color1(1)), coordf_t(color2(1)), t),
-                intensity * lerp(coordf_t(color1(2)), coordf_t(color2(2)), t));
-            int row = cell / (cols - 1);
-            int col = cell - row * (cols - 1);
-			assert(row >= 0 && row < rows);
-			assert(col >= 0 && col < cols);
-            unsigned char *ptr = (unsigned char*)data + (row * cols + col) * 4;
-            ptr[0] = (unsigned char)clamp<int>(0, 255, int(floor(color(0) + 0.5)));
-            ptr[1] = (unsigned char)clamp<int>(0, 255, int(floor(color(1) + 0.5)));
-            ptr[2] = (unsigned char)clamp<int>(0, 255, int(floor(color(2) + 0.5)));
-            ptr[3] = 255;
-            if (col == 0 && row > 0) {
-                // Duplicate the first value in a row as a last value of the preceding row.
-                ptr[-4] = ptr[0];
-                ptr[-3] = ptr[1];
-                ptr[-2] = ptr[2];
-                ptr[-1] = ptr[3];
-            }
-        }
-        if (level_of_detail_2nd_level) {
-            cell_first = clamp(0, ncells1-1, int(ceil(lo * z_to_cell1))); 
-            cell_last  = clamp(0, ncells1-1, int(floor(hi * z_to_cell1)));
-            for (int cell = cell_first; cell <= cell_last; ++ cell) {
-                coordf_t idxf = (0.5 * hscale + (h - slicing_params.layer_height)) * coordf_t(palette_raw.size()-1) / hscale;
-                int idx1 = clamp(0, int(palette_raw.size() - 1), int(floor(idxf)));
-                int idx2 = std::min(int(palette_raw.size() - 1), idx1 + 1);
-    			coordf_t t = idxf - coordf_t(idx1);
-                const Vec3i32 &color1 = palette_raw[idx1];
-                const Vec3i32 &color2 = palette_raw[idx2];
-                // Color mapping from layer height to RGB.
-                Vec3d color(
-                    lerp(coordf_t(color1(0)), coordf_t(color2(0)), t), 
-                    lerp(coordf_t(color1(1)), coordf_t(color2(1)), t),
-                    lerp(coordf_t(color1(2)), coordf_t(color2(2)), t));
-                int row = cell / (cols1 - 1);
-                int col = cell - row * (cols1 - 1);
-    			assert(row >= 0 && row < rows/2);
-    			assert(col >= 0 && col < cols/2);
-                unsigned char *ptr = data1 + (row * cols1 + col) * 4;
+            Vec3d color_layer(
+                lerp(coordf_t(color1(0)), coordf_t(color2(0)), t), 
+                lerp(coordf_t(color1(1)), coordf_t(color2(1)), t),
+                lerp(coordf_t(color1(2)), coordf_t(color2(2)), t));
+            for (int cell = cells[i].first; cell <= cells[i].second; ++ cell) {
+                coordf_t z = cell_to_z * coordf_t(cell);
+                assert(lo - EPSILON <= z && z <= hi + EPSILON);
+                // Intensity profile to visualize the layers.
+                coordf_t intensity = cos(M_PI * 0.7 * (mid - z) / h);
+                Vec3d color = intensity * color_layer;
+                int row = cell / (cols - 1);
+                int col = cell - row * (cols - 1);
+                assert(row >= 0 && row < rows);
+                assert(col >= 0 && col < cols);
+                unsigned char *ptr = (unsigned char*)data + (row * cols + col) * 4;
                 ptr[0] = (unsigned char)clamp<int>(0, 255, int(floor(color(0) + 0.5)));
                 ptr[1] = (unsigned char)clamp<int>(0, 255, int(floor(color(1) + 0.5)));
                 ptr[2] = (unsigned char)clamp<int>(0, 255, int(floor(color(2) + 0.5)));
@@ -864,8 +861,28 @@ int generate_layer_height_texture(
                     ptr[-1] = ptr[3];
                 }
             }
+            if (level_of_detail_2nd_level) {
+                for (int cell = cells1[i].first; cell <= cells1[i].second; ++ cell) {
+                    int row = cell / (cols1 - 1);
+                    int col = cell - row * (cols1 - 1);
+                    assert(row >= 0 && row < rows/2);
+                    assert(col >= 0 && col < cols/2);
+                    unsigned char *ptr = data1 + (row * cols1 + col) * 4;
+                    ptr[0] = (unsigned char)clamp<int>(0, 255, int(floor(color_layer(0) + 0.5)));
+                    ptr[1] = (unsigned char)clamp<int>(0, 255, int(floor(color_layer(1) + 0.5)));
+                    ptr[2] = (unsigned char)clamp<int>(0, 255, int(floor(color_layer(2) + 0.5)));
+                    ptr[3] = 255;
+                    if (col == 0 && row > 0) {
+                        // Duplicate the first value in a row as a last value of the preceding row.
+                        ptr[-4] = ptr[0];
+                        ptr[-3] = ptr[1];
+                        ptr[-2] = ptr[2];
+                        ptr[-1] = ptr[3];
+                    }
+                }
+            }
         }
-    }
+    });
 
     // Returns number of cells of the 0th LOD level.
     return ncells;
@@ -182,10 +182,13 @@ extern std::vector<coordf_t> generate_object_layers(
 // Produce a 1D texture packed into a 2D texture describing in the RGBA format
 // the planned object layers.
 // Returns number of cells used by the texture of the 0th LOD level.
+// The layers below first_layer are expected to be unchanged since the previous call on the same data,
+// with the same slicing parameters: their cells are kept, only the edited part of the texture is rewritten.
 extern int generate_layer_height_texture(
     const SlicingParameters     &slicing_params,
     const std::vector<coordf_t> &layers,
-    void *data, int rows, int cols, bool level_of_detail_2nd_level);
+    void *data, int rows, int cols, bool level_of_detail_2nd_level,
+    size_t                       first_layer = 0);
 
 namespace Slicing {
 	// Minimum layer height for the variable layer height algorithm. Nozzle index is 1 based.
@@ -5,6 +5,10 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
 // Based on the work of Florens Waserfall (@platch on github)
 // and his paper
 // Florens Wasserfall, Norman Hendrich, Jianwei Zhang:
@@ -73,9 +77,16 @@ static inline float layer_height_from_slope(const SlicingAdaptive::FaceZ &face,
 //    return float(max_surface_deviation * face.n_sin);
 }
 
+// Key of a face ordering the faces by the layer height they allow, see layer_height_from_slope().
+static inline float face_slope(const SlicingAdaptive::FaceZ &face)
+{
+	return (face.n_cos > 1e-5) ? face.n_sin / face.n_cos : FLT_MAX;
+}
+
 void SlicingAdaptive::clear()
 {
 	m_faces.clear();
+	m_active_faces = {};
 }
 
 void SlicingAdaptive::prepare(const ModelObject &object)
@@ -87,14 +98,17 @@ void SlicingAdaptive::prepare(const ModelObject &object)
     mesh.transform(first_instance.get_matrix(), first_instance.is_left_handed());
 
     // 1) Collect faces from mesh.
-    m_faces.reserve(mesh.stl.stats.number_of_facets);
-    for (const stl_facet &face : mesh.stl.facet_start) {
-    	Vec3f n = face.normal.normalized();
-		m_faces.emplace_back(FaceZ({ face_z_span(face), std::abs(n.z()), std::sqrt(n.x() * n.x() + n.y() * n.y()) }));
-    }
+    m_faces.assign(mesh.stl.facet_start.size(), FaceZ());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_faces.size()), [this, &mesh](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const stl_facet &face = mesh.stl.facet_start[i];
+	    	Vec3f n = face.normal.normalized();
+			m_faces[i] = FaceZ({ face_z_span(face), std::abs(n.z()), std::sqrt(n.x() * n.x() + n.y() * n.y()) });
+        }
+    });
 
 	// 2) Sort faces lexicographically by their Z span.
-	std::sort(m_faces.begin(), m_faces.end(), [](const FaceZ &f1, const FaceZ &f2) { return f1.z_span < f2.z_span; });
+	tbb::parallel_sort(m_faces.begin(), m_faces.end(), [](const FaceZ &f1, const FaceZ &f2) { return f1.z_span < f2.z_span; });
 }
 
 // current_facet is in/out parameter, rememebers the index of the last face of m_faces visited, 
@@ -125,29 +139,21 @@ float SlicingAdaptive::next_layer_height(const float print_z, float quality_fact
 	}
 	
 	// find all facets intersecting the slice-layer
+	// The faces starting below print_z are swept into m_active_faces once, the least sloped face crossing print_z
+	// then limits the height the most. Scanning all the faces below print_z for each layer was quadratic
+	// for meshes with long faces.
+	if (current_facet == 0)
+		m_active_faces = {};
 	size_t ordered_id = current_facet;
-	{
-		bool first_hit = false;
-		for (; ordered_id < m_faces.size(); ++ ordered_id) {
-	        const std::pair<float, float> &zspan = m_faces[ordered_id].z_span;
-	        // facet's minimum is higher than slice_z -> end loop
-			if (zspan.first >= print_z)
-				break;
-			// facet's maximum is higher than slice_z -> store the first event for next cusp_height call to begin at this point
-			if (zspan.second > print_z) {
-				// first event?
-				if (! first_hit) {
-					first_hit = true;
-					current_facet = ordered_id;
-	            }
-				// skip touching facets which could otherwise cause small cusp values
-				if (zspan.second < print_z + EPSILON)
-					continue;
-				// compute cusp-height for this facet and store minimum of all heights
-				height = std::min(height, layer_height_from_slope(m_faces[ordered_id], max_surface_deviation));
-	        }
-		}
-	}
+	for (; ordered_id < m_faces.size() && m_faces[ordered_id].z_span.first < print_z; ++ ordered_id)
+		m_active_faces.push({ face_slope(m_faces[ordered_id]), m_faces[ordered_id].z_span.second, ordered_id });
+	current_facet = ordered_id;
+	// skip the faces below and touching facets which could otherwise cause small cusp values
+	while (! m_active_faces.empty() && m_active_faces.top().z_max < print_z + EPSILON)
+		m_active_faces.pop();
+	if (! m_active_faces.empty())
+		// compute cusp-height for this facet and store minimum of all heights
+		height = std::min(height, layer_height_from_slope(m_faces[m_active_faces.top().idx], max_surface_deviation));
 
 	// lower height limit due to printer capabilities
 	height = std::max(height, float(m_slicing_params.min_layer_height));
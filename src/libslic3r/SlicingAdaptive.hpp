@@ -3,6 +3,8 @@
 #ifndef slic3r_SlicingAdaptive_hpp_
 #define slic3r_SlicingAdaptive_hpp_
 
+#include <queue>
+
 #include "Slicing.hpp"
 #include "admesh/stl.h"
 
@@ -20,6 +22,8 @@ public:
     // Return next layer height starting from the last print_z, using a quality measure
     // (quality in range from 0 to 1, 0 - highest quality at low layer heights, 1 - lowest print quality at high layer heights).
     // The layer height curve shall be centered roughly around the default profile's layer height for quality 0.5.
+    // current_facet is the index of the first face not swept yet, it shall be zero for the first call
+    // and print_z shall not decrease between the calls sharing current_facet.
 	float next_layer_height(const float print_z, float quality, size_t &current_facet);
     float horizontal_facet_distance(float z);
 
@@ -32,9 +36,20 @@ public:
 	};
 
 protected:
+	// Face crossing the last print_z, keyed by the tangent of its slope: the layer height allowed by a face grows with the tangent.
+	struct ActiveFace {
+		float 					slope;
+		float 					z_max;
+		size_t 					idx;
+		bool operator<(const ActiveFace &rhs) const { return slope > rhs.slope; }
+	};
+
 	SlicingParameters 		m_slicing_params;
 
 	std::vector<FaceZ>		m_faces;
+	// Faces starting below the last print_z passed to next_layer_height(), the least sloped on top. Faces ending below
+	// that print_z are only removed when they get to the top, as they would never be active again.
+	std::priority_queue<ActiveFace> m_active_faces;
 };
 
 }; // namespace Slic3r
@@ -3,6 +3,7 @@
 #include "Layer.hpp"
 #include "Print.hpp"
 #include "SupportMaterial.hpp"
+#include "Tracing.hpp"
 #include "Fill/FillBase.hpp"
 #include "EdgeGrid.hpp"
 #include "Geometry.hpp"
@@ -10,12 +11,14 @@
 
 #include <cmath>
 #include <memory>
+#include <unordered_map>
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
 #include <tbb/atomic.h>
 #include <tbb/spin_mutex.h>
 #include <tbb/task_group.h>
+#include <tbb/task_scheduler_init.h>
 
 // #define SLIC3R_DEBUG
 
@@ -180,27 +183,50 @@ PrintObjectSupportMaterial::PrintObjectSupportMaterial(const PrintObject *object
     }
 }
 
-// Using the std::deque as an allocator.
+PrintObjectSupportMaterial::MyLayer& PrintObjectSupportMaterial::MyLayerStorage::allocate(SupporLayerType layer_type)
+{
+    MyLayer &layer = m_layers.allocate();
+    layer.layer_type = layer_type;
+    return layer;
+}
+
+Polygons* PrintObjectSupportMaterial::MyLayerStorage::allocate_polygons(Polygons &&polygons)
+{
+    Polygons &out = m_polygons.allocate();
+    out = std::move(polygons);
+    return &out;
+}
+
+// Called for each layer of the parallel loops, so that a canceled support generation stops without draining the loops.
+static inline void throw_if_canceled(const PrintObject &object)
+{
+    if (object.print()->canceled())
+        throw CanceledException();
+}
+
 inline PrintObjectSupportMaterial::MyLayer& layer_allocate(
-    std::deque<PrintObjectSupportMaterial::MyLayer> &layer_storage, 
+    PrintObjectSupportMaterial::MyLayerStorage      &layer_storage, 
     PrintObjectSupportMaterial::SupporLayerType      layer_type)
 { 
-    layer_storage.push_back(PrintObjectSupportMaterial::MyLayer());
-    layer_storage.back().layer_type = layer_type;
-    return layer_storage.back();
+    return layer_storage.allocate(layer_type);
 }
 
 inline PrintObjectSupportMaterial::MyLayer& layer_allocate(
-    std::deque<PrintObjectSupportMaterial::MyLayer> &layer_storage,
+    PrintObjectSupportMaterial::MyLayerStorage      &layer_storage,
     tbb::spin_mutex                                 &layer_storage_mutex,
     PrintObjectSupportMaterial::SupporLayerType      layer_type)
 { 
-    layer_storage_mutex.lock();
-    layer_storage.push_back(PrintObjectSupportMaterial::MyLayer());
-    PrintObjectSupportMaterial::MyLayer *layer_new = &layer_storage.back();
-    layer_storage_mutex.unlock();
-    layer_new->layer_type = layer_type;
-    return *layer_new;
+    tbb::spin_mutex::scoped_lock lock(layer_storage_mutex);
+    return layer_storage.allocate(layer_type);
+}
+
+inline Polygons* polygons_allocate(
+    PrintObjectSupportMaterial::MyLayerStorage      &layer_storage,
+    tbb::spin_mutex                                 &layer_storage_mutex,
+    Polygons                                       &&polygons)
+{
+    tbb::spin_mutex::scoped_lock lock(layer_storage_mutex);
+    return layer_storage.allocate_polygons(std::move(polygons));
 }
 
 inline void layers_append(PrintObjectSupportMaterial::MyLayersPtr &dst, const PrintObjectSupportMaterial::MyLayersPtr &src)
@@ -218,13 +244,14 @@ struct MyLayersPtrCompare
 
 void PrintObjectSupportMaterial::generate(PrintObject &object)
 {
+    SLIC3R_TRACE_ZONE("PrintObjectSupportMaterial::generate");
     BOOST_LOG_TRIVIAL(info) << "Support generator - Start";
 
     coordf_t max_object_layer_height = 0.;
     for (size_t i = 0; i < object.layer_count(); ++ i)
         max_object_layer_height = std::max(max_object_layer_height, object.layers()[i]->height);
 
-    // Layer instances will be allocated by std::deque and they will be kept until the end of this function call.
+    // Layer instances will be allocated by the MyLayerStorage by chunks and they will be kept until the end of this function call.
     // The layers will be referenced by various LayersPtr (of type std::vector<Layer*>)
     MyLayerStorage layer_storage;
 
@@ -236,7 +263,10 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // should the support material expose to the object in order to guarantee
     // that it will be effective, regardless of how it's built below.
     // If raft is to be generated, the 1st top_contact layer will contain the 1st object layer silhouette without holes.
-    MyLayersPtr top_contacts = this->top_contact_layers(object, layer_storage);
+    // The contact layers are cached on the PrintObject, so that a change of the support painting recalculates just the layers it touches.
+    if (! object.m_support_contacts_cache)
+        object.m_support_contacts_cache = std::make_shared<SupportContactsCache>();
+    MyLayersPtr top_contacts = this->top_contact_layers(object, layer_storage, object.m_support_contacts_cache.get());
     if (top_contacts.empty())
         // Nothing is supported, no supports are generated.
         return;
@@ -257,9 +287,13 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // layer_support_areas contains the per object layer support areas. These per object layer support areas
     // may get merged and trimmed by this->generate_base_layers() if the support layers are not synchronized with object layers.
     std::vector<Polygons> layer_support_areas;
-    MyLayersPtr bottom_contacts = this->bottom_contact_layers_and_layer_support_areas(
-        object, top_contacts, layer_storage,
-        layer_support_areas);
+    MyLayersPtr bottom_contacts = m_object_config->support_material_style.value == smsTree ?
+        this->bottom_contact_layers_and_layer_support_areas_tree(
+            object, top_contacts, layer_storage,
+            layer_support_areas) :
+        this->bottom_contact_layers_and_layer_support_areas(
+            object, top_contacts, layer_storage,
+            layer_support_areas);
 
 #ifdef SLIC3R_DEBUG
     for (size_t layer_id = 0; layer_id < object.layers().size(); ++ layer_id)
@@ -851,14 +885,12 @@ namespace SupportMaterialInternal {
                 }
             }
     }
-    static void collect_bridging_perimeter_areas(const ExtrusionEntitiesPtr &perimeters, const float expansion_scaled, Polygons &out)
+    static void collect_bridging_perimeter_areas(const ExtrusionEntityCollection &perimeters, const float expansion_scaled, Polygons &out)
     {
-        for (const ExtrusionEntity *ee : perimeters) {
-            if (ee->is_collection()) {
-                collect_bridging_perimeter_areas(static_cast<const ExtrusionEntityCollection*>(ee)->entities, expansion_scaled, out);
-            } else if (ee->is_loop())
-                collect_bridging_perimeter_areas(*static_cast<const ExtrusionLoop*>(ee), expansion_scaled, out);
-        }
+        perimeters.for_each_leaf([expansion_scaled, &out](const ExtrusionEntity &ee) {
+            if (ee.is_loop())
+                collect_bridging_perimeter_areas(static_cast<const ExtrusionLoop&>(ee), expansion_scaled, out);
+        });
     }
 
     static void remove_bridges_from_contacts(
@@ -961,7 +993,7 @@ static int run_support_test = Test();
 // For a soluble interface material synchronize the layer heights with the object, otherwise leave the layer height undefined.
 // If supports over bed surface only are requested, don't generate contact layers over an object.
 PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_layers(
-    const PrintObject &object, MyLayerStorage &layer_storage) const
+    const PrintObject &object, MyLayerStorage &layer_storage, SupportContactsCache *cache) const
 {
 #ifdef SLIC3R_DEBUG
     static int iRun = 0;
@@ -1017,12 +1049,57 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
     // For each overhang layer, two supporting layers may be generated: One for the overhangs extruded with a bridging flow, 
     // and the other for the overhangs extruded with a normal flow.
     contact_out.assign(num_layers * 2, nullptr);
+    // Layers to be restored from the cache. The layers touching the dirty Z range are recalculated together with their neighbors,
+    // as a painted facet changes the overhangs of the layer above it as well.
+    std::vector<char> restore(num_layers, false);
+    if (cache != nullptr && cache->layers.size() == num_layers * 2)
+        for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id) {
+            const Layer &below = *object.layers()[layer_id > 0 ? layer_id - 1 : 0];
+            const Layer &above = *object.layers()[std::min(layer_id + 1, object.layer_count() - 1)];
+            restore[layer_id] = below.print_z - below.height > cache->dirty_z_max + EPSILON || above.print_z < cache->dirty_z_min - EPSILON;
+        }
+    // Merge the enforcers and the expanded blockers once per layer, in parallel, instead of once per region.
+    // The projected painted facets are a lot of small overlapping polygons.
+    std::vector<Polygons> enforcers_merged(enforcers.size());
+    std::vector<Polygons> blockers_merged(blockers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, std::min(num_layers, std::max(enforcers.size(), blockers.size()))),
+        [&enforcers, &blockers, &enforcers_merged, &blockers_merged, &restore](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id)
+                if (! restore[layer_id]) {
+                    if (layer_id < enforcers.size() && ! enforcers[layer_id].empty())
+                        enforcers_merged[layer_id] = union_(to_polygons(std::move(enforcers[layer_id])));
+                    // Expand the blocker a bit. Custom blockers produce strips
+                    // spanning just the projection between the two slices.
+                    // Subtracting them as they are may leave unwanted narrow
+                    // residues of diff_polygons that would then be supported.
+                    if (layer_id < blockers.size() && ! blockers[layer_id].empty())
+                        blockers_merged[layer_id] = offset(union_(to_polygons(std::move(blockers[layer_id]))), 1000.*SCALED_EPSILON);
+                }
+        });
     tbb::spin_mutex layer_storage_mutex;
     tbb::parallel_for(tbb::blocked_range<size_t>(this->has_raft() ? 0 : 1, num_layers),
-        [this, &object, &buildplate_covered, &enforcers, &blockers, support_auto, threshold_rad, &layer_storage, &layer_storage_mutex, &contact_out]
+        [this, &object, &buildplate_covered, &enforcers_merged, &blockers_merged, support_auto, threshold_rad, &layer_storage, &layer_storage_mutex, &contact_out, cache, &restore]
         (const tbb::blocked_range<size_t>& range) {
             for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) 
             {
+                throw_if_canceled(object);
+                if (restore[layer_id]) {
+                    for (size_t i = layer_id * 2; i < layer_id * 2 + 2; ++ i)
+                        if (const std::optional<SupportContactsCache::ContactLayer> &cached = cache->layers[i]; cached) {
+                            MyLayer &new_layer = layer_allocate(layer_storage, layer_storage_mutex, sltTopContact);
+                            new_layer.print_z                = cached->print_z;
+                            new_layer.bottom_z               = cached->bottom_z;
+                            new_layer.height                 = cached->height;
+                            new_layer.idx_object_layer_above = cached->idx_object_layer_above;
+                            new_layer.bridging               = cached->bridging;
+                            new_layer.polygons               = cached->polygons;
+                            new_layer.contact_polygons       = polygons_allocate(layer_storage, layer_storage_mutex, Polygons(cached->contact_polygons));
+                            new_layer.overhang_polygons      = polygons_allocate(layer_storage, layer_storage_mutex, Polygons(cached->overhang_polygons));
+                            contact_out[i] = &new_layer;
+                        }
+                    continue;
+                }
+
                 const Layer &layer = *object.layers()[layer_id];
 
                 // Detect overhangs and contact areas needed to support them.
@@ -1099,13 +1176,13 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
     	                                lower_layer_polygons);
     							}
                             }
-                            if (! enforcers.empty()) {
+                            if (! enforcers_merged.empty()) {
                                 // Apply the "support enforcers".
                                 //FIXME add the "enforcers" to the sparse support regions only.
-                                const ExPolygons &enforcer = enforcers[layer_id];
+                                const Polygons &enforcer = enforcers_merged[layer_id];
                                 if (! enforcer.empty()) {
                                     // Enforce supports (as if with 90 degrees of slope) for the regions covered by the enforcer meshes.
-                                    Polygons new_contacts = diff(intersection(layerm_polygons, to_polygons(std::move(enforcer))),
+                                    Polygons new_contacts = diff(intersection(layerm_polygons, enforcer),
                                             offset(lower_layer_polygons, 0.05f * fw, SUPPORT_SURFACES_OFFSET_PARAMETERS));
                                     if (! new_contacts.empty()) {
                                         if (diff_polygons.empty())
@@ -1121,15 +1198,9 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
                             continue;
 
                         // Apply the "support blockers".
-                        if (! blockers.empty() && ! blockers[layer_id].empty()) {
-                            // Expand the blocker a bit. Custom blockers produce strips
-                            // spanning just the projection between the two slices.
-                            // Subtracting them as they are may leave unwanted narrow
-                            // residues of diff_polygons that would then be supported.
-                            diff_polygons = diff(diff_polygons,
-                                offset(union_(to_polygons(std::move(blockers[layer_id]))),
-                                       1000.*SCALED_EPSILON));
-                        }
+                        // The blockers were merged and expanded above.
+                        if (! blockers_merged.empty() && ! blockers_merged[layer_id].empty())
+                            diff_polygons = diff(diff_polygons, blockers_merged[layer_id]);
 
                         #ifdef SLIC3R_DEBUG
                         {
@@ -1284,7 +1355,7 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
                         m_object_config->support_material_spacing.value + m_support_material_flow.spacing(),
                         Geometry::deg2rad(m_object_config->support_material_angle.value));
                     // 1) Contact polygons will be projected down. To keep the interface and base layers from growing, return a contour a tiny bit smaller than the grid cells.
-                    new_layer.contact_polygons = new Polygons(support_grid_pattern.extract_support(-3, true));
+                    new_layer.contact_polygons = polygons_allocate(layer_storage, layer_storage_mutex, support_grid_pattern.extract_support(-3, true));
                     // 2) infill polygons, expand them by half the extrusion width + a tiny bit of extra.
                     if (layer_id == 0 || m_slicing_params.soluble_interface) {
                     // if (no_interface_offset == 0.f) {
@@ -1345,18 +1416,36 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
                     // Store the overhang polygons.
                     // The overhang polygons are used in the path generator for planning of the contact loops.
                     // if (this->has_contact_loops()). Compared to "polygons", "overhang_polygons" are snug.
-                    new_layer.overhang_polygons = new Polygons(std::move(overhang_polygons));
+                    new_layer.overhang_polygons = polygons_allocate(layer_storage, layer_storage_mutex, std::move(overhang_polygons));
                     contact_out[layer_id * 2] = &new_layer;
                     if (bridging_layer != nullptr) {
                         bridging_layer->polygons          = new_layer.polygons;
-                        bridging_layer->contact_polygons  = new Polygons(*new_layer.contact_polygons);
-                        bridging_layer->overhang_polygons = new Polygons(*new_layer.overhang_polygons);
+                        bridging_layer->contact_polygons  = polygons_allocate(layer_storage, layer_storage_mutex, Polygons(*new_layer.contact_polygons));
+                        bridging_layer->overhang_polygons = polygons_allocate(layer_storage, layer_storage_mutex, Polygons(*new_layer.overhang_polygons));
                         contact_out[layer_id * 2 + 1] = bridging_layer;
                     }
                 }
             }
         });
 
+    if (cache != nullptr) {
+        // Store the recalculated layers before they are merged and consumed.
+        if (cache->layers.size() != contact_out.size())
+            cache->layers.assign(contact_out.size(), std::nullopt);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers),
+            [cache, &contact_out, &restore](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id)
+                if (! restore[layer_id])
+                    for (size_t i = layer_id * 2; i < layer_id * 2 + 2; ++ i) {
+                        cache->layers[i].reset();
+                        if (const MyLayer *layer = contact_out[i]; layer != nullptr)
+                            cache->layers[i] = SupportContactsCache::ContactLayer{ layer->print_z, layer->bottom_z, layer->height, layer->idx_object_layer_above, layer->bridging, 
+                                layer->polygons, *layer->contact_polygons, *layer->overhang_polygons };
+                    }
+        });
+        cache->validate();
+    }
+
     // Compress contact_out, remove the nullptr items.
     remove_nulls(contact_out);
     // Sort the layers, as one layer may produce bridging and non-bridging contact layers with different print_z.
@@ -1422,6 +1511,63 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
     return contact_out;
 }
 
+// Fill in a bottom contact layer over the top surfaces of the object layer layer_id, supporting the touching areas.
+// contact_idx is the last top contact layer below the top contacts already projected down to layer_id.
+void PrintObjectSupportMaterial::init_bottom_contact_layer(
+    MyLayer &layer_new, const PrintObject &object, const MyLayersPtr &top_contacts, int contact_idx, int layer_id, const Polygons &touching) const
+{
+    const Layer &layer = *object.get_layer(layer_id);
+    // Grow top surfaces so that interface and support generation are generated
+    // with some spacing from object - it looks we don't need the actual
+    // top shapes so this can be done here
+    //FIXME calculate layer height based on the actual thickness of the layer:
+    // If the layer is extruded with no bridging flow, support just the normal extrusions.
+    layer_new.height = m_slicing_params.soluble_interface ?
+        // Align the interface layer with the object's layer height.
+        object.layers()[layer_id + 1]->height :
+        // Place a bridge flow interface layer over the top surface.
+        //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
+        // According to Jindrich the bottom surfaces work well.
+        //FIXME test the bridging flow instead?
+        m_support_material_interface_flow.nozzle_diameter;
+    layer_new.height_block = ((m_object_config->support_material_contact_distance_type.value == zdPlane) ? object.layers()[layer_id + 1]->height : layer_new.height);
+    layer_new.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
+        (layer.print_z + layer_new.height_block + this->m_slicing_params.gap_object_support);
+    layer_new.bottom_z = layer.print_z;
+    layer_new.idx_object_layer_below = layer_id;
+    layer_new.bridging = ! m_slicing_params.soluble_interface;
+    //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
+    //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
+    layer_new.polygons = offset(touching, double(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
+    if (! m_slicing_params.soluble_interface) {
+        // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
+        // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
+        for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); 
+            top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < layer_new.print_z + this->m_support_layer_height_min + EPSILON; 
+            ++ top_idx) {
+            if (top_contacts[top_idx]->print_z > layer_new.print_z - this->m_support_layer_height_min - EPSILON) {
+                // A top layer has been found, which is close to the new bottom layer.
+                coordf_t diff = layer_new.print_z - top_contacts[top_idx]->print_z;
+                assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
+                if (diff > 0.) {
+                    // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
+                    assert(diff < layer_new.height + EPSILON);
+                    assert(layer_new.height - diff >= m_support_layer_height_min - EPSILON);
+                    layer_new.print_z  = top_contacts[top_idx]->print_z;
+                    layer_new.height  -= diff;
+                } else {
+                    // The top contact layer is above this layer. One may either make this layer thicker or thinner.
+                    // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
+                    // By making the layer thinner, one adds one more discrete layer.
+                    layer_new.print_z  = top_contacts[top_idx]->print_z;
+                    layer_new.height  -= diff;
+                }
+                break;
+            }
+        }
+    }
+}
+
 // Generate bottom contact layers supporting the top contact layers.
 // For a soluble interface material synchronize the layer heights with the object, 
 // otherwise set the layer height to a bridging flow of a support interface nozzle.
@@ -1444,162 +1590,111 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
     if (! top_contacts.empty()) 
     {
         // There is some support to be built, if there are non-empty top surfaces detected.
+        // The projection of the contact areas down to the object is a serial chain from the top layer down, each layer trims
+        // the projection of the layer above it. To keep the cores busy, the layers are processed by blocks from the top down:
+        // 1) The inputs of the chain, which do not depend on the projection, are calculated for all the layers of a block in parallel.
+        // 2) The chain itself walks the layers of the block serially.
+        // 3) The bottom contact layers of the block only depend on the projection at their layer, they are calculated in parallel
+        //    over the block and merged in the order of the serial algorithm.
+        const size_t block_size = std::max<size_t>(8, 4 * size_t(tbb::task_scheduler_init::default_num_threads()));
+
+        // Per layer inputs and outputs of a block, the index is layer_id - the lowest layer_id of the block.
+        struct LayerData {
+            // Range of top_contacts with print_z above or at the level of this layer, not yet collected by the layers above.
+            int         contact_idx_begin { 0 };
+            int         contact_idx_end   { 0 };
+            // Union of those top contacts, ready to be added to the projection.
+            Polygons    contacts;
+            // The object slices, used to trim the projection.
+            Polygons    trimming;
+            // The top surfaces, supporting the projection. Not calculated for the "buildplate only" supports.
+            Polygons    top;
+            // Snapshot of the projection at this layer, to calculate the bottom contacts from.
+            Polygons    projection_raw;
+            // Outputs of the bottom contacts calculation.
+            MyLayer    *bottom_contact { nullptr };
+            Polygons    touching;
+        };
+        std::vector<LayerData> block;
+        tbb::spin_mutex        layer_storage_mutex;
+
         // Sum of unsupported contact areas above the current layer.print_z.
         Polygons  projection;
         // Last top contact layer visited when collecting the projection of contact areas.
         int       contact_idx = int(top_contacts.size()) - 1;
-        for (int layer_id = int(object.total_layer_count()) - 2; layer_id >= 0; -- layer_id) {
-            BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layer " << layer_id;
-            const Layer &layer = *object.get_layer(layer_id);
-            // Collect projections of all contact areas above or at the same level as this top surface.
-            for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx) {
-                Polygons polygons_new;
-                // Contact surfaces are expanded away from the object, trimmed by the object.
-                // Use a slight positive offset to overlap the touching regions.
+        for (int block_end = int(object.total_layer_count()) - 1; block_end > 0; block_end -= int(block_size)) {
+            // Layers <block_begin, block_end) are processed by this block.
+            const int block_begin = std::max(0, block_end - int(block_size));
+            BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layers " << block_begin << " to " << block_end - 1;
+            block.assign(block_end - block_begin, LayerData());
+
+            // Assign the top contacts to the layers of the block, top down.
+            for (int layer_id = block_end - 1; layer_id >= block_begin; -- layer_id) {
+                LayerData &data = block[layer_id - block_begin];
+                const Layer &layer = *object.get_layer(layer_id);
+                data.contact_idx_end = contact_idx + 1;
+                for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx) ;
+                data.contact_idx_begin = contact_idx + 1;
+            }
+
+            // 1) Inputs of the chain.
+            tbb::parallel_for(tbb::blocked_range<int>(block_begin, block_end),
+                [this, &object, &top_contacts, &block, block_begin](const tbb::blocked_range<int> &range) {
+                for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                    throw_if_canceled(object);
+                    LayerData   &data  = block[layer_id - block_begin];
+                    const Layer &layer = *object.get_layer(layer_id);
+                    // Collect projections of all contact areas above or at the same level as this layer, in the order of the serial algorithm.
+                    for (int idx = data.contact_idx_end - 1; idx >= data.contact_idx_begin; -- idx) {
+                        Polygons polygons_new;
+                        // Contact surfaces are expanded away from the object, trimmed by the object.
+                        // Use a slight positive offset to overlap the touching regions.
 #if 0
-                // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->contact_polygons, SCALED_EPSILON));
+                        // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
+                        polygons_append(polygons_new, offset(*top_contacts[idx]->contact_polygons, SCALED_EPSILON));
 #else
-                // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
-                // than the grid cells.
-                polygons_append(polygons_new, std::move(*top_contacts[contact_idx]->contact_polygons));
+                        // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
+                        // than the grid cells.
+                        polygons_append(polygons_new, std::move(*top_contacts[idx]->contact_polygons));
 #endif
-                // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
-                // Use a slight positive offset to overlap the touching regions.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->overhang_polygons, double(SCALED_EPSILON)));
-                polygons_append(projection, union_(polygons_new));
-            }
-            if (projection.empty())
-                continue;
-            Polygons projection_raw = union_(projection);
-
-            tbb::task_group task_group;
-            if (! m_object_config->support_material_buildplate_only)
-                // Find the bottom contact layers above the top surfaces of this layer.
-                task_group.run([this, &object, &top_contacts, contact_idx, &layer, layer_id, &layer_storage, &layer_support_areas, &bottom_contacts, &projection_raw] {
-                    Polygons top = collect_region_slices_by_type(layer, stPosTop | stDensSolid);
-        #ifdef SLIC3R_DEBUG
-                    {
-                        BoundingBox bbox = get_extents(projection_raw);
-                        bbox.merge(get_extents(top));
-                        ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
-                        svg.draw(union_ex(top, false), "blue", 0.5f);
-                        svg.draw(union_ex(projection_raw, true), "red", 0.5f);
-                        svg.draw_outline(union_ex(projection_raw, true), "red", "blue", scale_(0.1f));
-                        svg.draw(layer.lslices, "green", 0.5f);
+                        // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
+                        // Use a slight positive offset to overlap the touching regions.
+                        polygons_append(polygons_new, offset(*top_contacts[idx]->overhang_polygons, double(SCALED_EPSILON)));
+                        polygons_append(data.contacts, union_(polygons_new));
                     }
-        #endif /* SLIC3R_DEBUG */
+                    // Remove the areas that touched from the projection that will continue on next, lower, top surfaces.
+    //                Polygons trimming = union_(to_polygons(layer.slices.expolygons), touching, true);
+                    data.trimming = offset(layer.lslices, double(SCALED_EPSILON));
+                    if (! m_object_config->support_material_buildplate_only)
+                        data.top = collect_region_slices_by_type(layer, stPosTop | stDensSolid);
+                }
+            });
 
-                    // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
-                    // top surfaces above layer.print_z falls onto this top surface. 
-                    // Touching are the contact surfaces supported exclusively by this top surfaces.
-                    // Don't use a safety offset as it has been applied during insertion of polygons.
-                    if (! top.empty()) {
-                        Polygons touching = intersection(top, projection_raw, false);
-                        if (! touching.empty()) {
-                            // Allocate a new bottom contact layer.
-                            MyLayer &layer_new = layer_allocate(layer_storage, sltBottomContact);
-                            bottom_contacts.push_back(&layer_new);
-                            // Grow top surfaces so that interface and support generation are generated
-                            // with some spacing from object - it looks we don't need the actual
-                            // top shapes so this can be done here
-                            //FIXME calculate layer height based on the actual thickness of the layer:
-                            // If the layer is extruded with no bridging flow, support just the normal extrusions.
-                            layer_new.height = m_slicing_params.soluble_interface ?
-                                // Align the interface layer with the object's layer height.
-                                object.layers()[layer_id + 1]->height :
-                                // Place a bridge flow interface layer over the top surface.
-                                //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
-                                // According to Jindrich the bottom surfaces work well.
-                                //FIXME test the bridging flow instead?
-                                m_support_material_interface_flow.nozzle_diameter;
-                            layer_new.height_block = ((m_object_config->support_material_contact_distance_type.value == zdPlane) ? object.layers()[layer_id + 1]->height : layer_new.height);
-                            layer_new.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
-                                (layer.print_z + layer_new.height_block + this->m_slicing_params.gap_object_support);
-                            layer_new.bottom_z = layer.print_z;
-                            layer_new.idx_object_layer_below = layer_id;
-                            layer_new.bridging = ! m_slicing_params.soluble_interface;
-                            //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
-                            //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
-                            layer_new.polygons = offset(touching, double(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
-                            if (! m_slicing_params.soluble_interface) {
-                                // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
-                                // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
-                                for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); 
-                                    top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < layer_new.print_z + this->m_support_layer_height_min + EPSILON; 
-                                    ++ top_idx) {
-                                    if (top_contacts[top_idx]->print_z > layer_new.print_z - this->m_support_layer_height_min - EPSILON) {
-                                        // A top layer has been found, which is close to the new bottom layer.
-                                        coordf_t diff = layer_new.print_z - top_contacts[top_idx]->print_z;
-                                        assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
-                                        if (diff > 0.) {
-                                            // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
-                                            assert(diff < layer_new.height + EPSILON);
-                                            assert(layer_new.height - diff >= m_support_layer_height_min - EPSILON);
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        } else {
-                                            // The top contact layer is above this layer. One may either make this layer thicker or thinner.
-                                            // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
-                                            // By making the layer thinner, one adds one more discrete layer.
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        }
-                                        break;
-                                    }
-                                }
-                            }
-                #ifdef SLIC3R_DEBUG
-                            Slic3r::SVG::export_expolygons(
-                                debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
-                                union_ex(layer_new.polygons, false));
-                #endif /* SLIC3R_DEBUG */
-                            // Trim the already created base layers above the current layer intersecting with the new bottom contacts layer.
-                            //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
-                            touching = offset(touching, double(SCALED_EPSILON));
-                            for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()); ++ layer_id_above) {
-                                const Layer &layer_above = *object.layers()[layer_id_above];
-                                if (layer_above.print_z > layer_new.print_z - EPSILON)
-                                    break; 
-                                if (! layer_support_areas[layer_id_above].empty()) {
-#ifdef SLIC3R_DEBUG
-                                    {
-                                        BoundingBox bbox = get_extents(touching);
-                                        bbox.merge(get_extents(layer_support_areas[layer_id_above]));
-                                        ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z), bbox);
-                                        svg.draw(union_ex(touching, false), "blue", 0.5f);
-                                        svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
-                                        svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
-                                    }
-#endif /* SLIC3R_DEBUG */
-                                    layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], touching);
+            // 2) The serial chain, top down. The inner tasks of a single layer still run in parallel.
+            for (int layer_id = block_end - 1; layer_id >= block_begin; -- layer_id) {
+                LayerData   &data  = block[layer_id - block_begin];
+                polygons_append(projection, std::move(data.contacts));
+                if (projection.empty())
+                    continue;
+                Polygons projection_raw = union_(projection);
+                Polygons &layer_support_area = layer_support_areas[layer_id];
 #ifdef SLIC3R_DEBUG
-                                    Slic3r::SVG::export_expolygons(
-                                        debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z),
-                                        union_ex(layer_support_areas[layer_id_above], false));
+                const Layer &layer = *object.get_layer(layer_id);
 #endif /* SLIC3R_DEBUG */
-                                }
-                            }
-                        }
-                    } // ! top.empty()
-                });
-
-            Polygons &layer_support_area = layer_support_areas[layer_id];
-            task_group.run([this, &projection, &projection_raw, &layer, &layer_support_area, layer_id] {
-                // Remove the areas that touched from the projection that will continue on next, lower, top surfaces.
-    //            Polygons trimming = union_(to_polygons(layer.slices.expolygons), touching, true);
-                Polygons trimming = offset(layer.lslices, double(SCALED_EPSILON));
-                projection = diff(projection_raw, trimming, false);
+                projection = diff(projection_raw, data.trimming, false);
     #ifdef SLIC3R_DEBUG
                 {
                     BoundingBox bbox = get_extents(projection_raw);
-                    bbox.merge(get_extents(trimming));
+                    bbox.merge(get_extents(data.trimming));
                     ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
-                    svg.draw(union_ex(trimming, false), "blue", 0.5f);
+                    svg.draw(union_ex(data.trimming, false), "blue", 0.5f);
                     svg.draw(union_ex(projection, true), "red", 0.5f);
                     svg.draw_outline(union_ex(projection, true), "red", "blue", scale_(0.1f));
                 }
     #endif /* SLIC3R_DEBUG */
+                // Only the layers with top surfaces will produce bottom contacts.
+                if (! data.top.empty())
+                    data.projection_raw = std::move(projection_raw);
                 remove_sticks(projection);
                 remove_degenerate(projection);
         #ifdef SLIC3R_DEBUG
@@ -1611,7 +1706,7 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
                     // Support islands, to be stretched into a grid.
                     projection, 
                     // Trimming polygons, to trim the stretched support islands.
-                    trimming,
+                    data.trimming,
                     // Grid spacing.
                     m_object_config->support_material_spacing.value + m_support_material_flow.spacing(),
                     Geometry::deg2rad(m_object_config->support_material_angle.value));
@@ -1646,8 +1741,85 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
                 });
                 task_group_inner.wait();
                 projection = std::move(projection_new);
+            }
+
+            // 3) Find the bottom contact layers above the top surfaces of the layers of this block.
+            tbb::parallel_for(tbb::blocked_range<int>(block_begin, block_end),
+                [this, &object, &top_contacts, &block, block_begin, &layer_storage, &layer_storage_mutex](const tbb::blocked_range<int> &range) {
+                for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                    throw_if_canceled(object);
+                    LayerData   &data  = block[layer_id - block_begin];
+                    const Layer &layer = *object.get_layer(layer_id);
+                    const Polygons &top            = data.top;
+                    const Polygons &projection_raw = data.projection_raw;
+                    if (top.empty() || projection_raw.empty())
+                        continue;
+        #ifdef SLIC3R_DEBUG
+                    {
+                        BoundingBox bbox = get_extents(projection_raw);
+                        bbox.merge(get_extents(top));
+                        ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
+                        svg.draw(union_ex(top, false), "blue", 0.5f);
+                        svg.draw(union_ex(projection_raw, true), "red", 0.5f);
+                        svg.draw_outline(union_ex(projection_raw, true), "red", "blue", scale_(0.1f));
+                        svg.draw(layer.lslices, "green", 0.5f);
+                    }
+        #endif /* SLIC3R_DEBUG */
+
+                    // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
+                    // top surfaces above layer.print_z falls onto this top surface. 
+                    // Touching are the contact surfaces supported exclusively by this top surfaces.
+                    // Don't use a safety offset as it has been applied during insertion of polygons.
+                    Polygons touching = intersection(top, projection_raw, false);
+                    if (touching.empty())
+                        continue;
+                    // Allocate a new bottom contact layer.
+                    MyLayer &layer_new = layer_allocate(layer_storage, layer_storage_mutex, sltBottomContact);
+                    data.bottom_contact = &layer_new;
+                    // data.contact_idx_begin - 1 is the value of contact_idx of the serial algorithm at this layer.
+                    this->init_bottom_contact_layer(layer_new, object, top_contacts, data.contact_idx_begin - 1, layer_id, touching);
+        #ifdef SLIC3R_DEBUG
+                    Slic3r::SVG::export_expolygons(
+                        debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
+                        union_ex(layer_new.polygons, false));
+        #endif /* SLIC3R_DEBUG */
+                    data.touching = offset(touching, double(SCALED_EPSILON));
+                }
             });
-            task_group.wait();
+
+            // Merge the bottom contacts in the order of the serial algorithm.
+            for (int layer_id = block_end - 1; layer_id >= block_begin; -- layer_id) {
+                LayerData &data = block[layer_id - block_begin];
+                if (data.bottom_contact == nullptr)
+                    continue;
+                const MyLayer &layer_new = *data.bottom_contact;
+                bottom_contacts.push_back(data.bottom_contact);
+                // Trim the already created base layers above the current layer intersecting with the new bottom contacts layer.
+                //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
+                for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()); ++ layer_id_above) {
+                    const Layer &layer_above = *object.layers()[layer_id_above];
+                    if (layer_above.print_z > layer_new.print_z - EPSILON)
+                        break; 
+                    if (! layer_support_areas[layer_id_above].empty()) {
+#ifdef SLIC3R_DEBUG
+                        {
+                            BoundingBox bbox = get_extents(data.touching);
+                            bbox.merge(get_extents(layer_support_areas[layer_id_above]));
+                            ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, object.get_layer(layer_id)->print_z, layer_above.print_z), bbox);
+                            svg.draw(union_ex(data.touching, false), "blue", 0.5f);
+                            svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
+                            svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
+                        }
+#endif /* SLIC3R_DEBUG */
+                        layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], data.touching);
+#ifdef SLIC3R_DEBUG
+                        Slic3r::SVG::export_expolygons(
+                            debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, object.get_layer(layer_id)->print_z, layer_above.print_z),
+                            union_ex(layer_support_areas[layer_id_above], false));
+#endif /* SLIC3R_DEBUG */
+                    }
+                }
+            }
         }
         std::reverse(bottom_contacts.begin(), bottom_contacts.end());
 //        trim_support_layers_by_object(object, bottom_contacts, 0., 0., m_gap_xy);
@@ -1660,6 +1832,319 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
     return bottom_contacts;
 }
 
+// Maximum slope of a tree support branch from the vertical, in degrees.
+static constexpr double TREE_SUPPORT_BRANCH_ANGLE       = 40.;
+// Growth of the branch radius per mm of the branch length down from the tip.
+static constexpr double TREE_SUPPORT_BRANCH_GROWTH      = 0.05;
+// Maximum radius of a tree support trunk, in mm.
+static constexpr double TREE_SUPPORT_MAX_BRANCH_RADIUS  = 5.;
+// Number of segments of the polygonal approximation of a branch cross section.
+static constexpr size_t TREE_SUPPORT_CIRCLE_SEGMENTS    = 16;
+
+namespace TreeSupport {
+
+// Cross section of a branch at a single object layer.
+struct Node {
+    Point   position;
+    coord_t radius;
+};
+
+// Object slices of a single layer with an edge grid for the distance queries.
+struct Collision {
+    ExPolygons      slices;
+    BoundingBox     bbox;
+    EdgeGrid::Grid  grid;
+
+    bool inside(const Point &pt) const {
+        if (! bbox.contains(pt))
+            return false;
+        for (const ExPolygon &expoly : slices)
+            if (expoly.contains(pt))
+                return true;
+        return false;
+    }
+};
+
+// Coarse 2D hash grid of the nodes of a layer, to look up the neighbors of a node.
+class NodeGrid {
+public:
+    NodeGrid(const std::vector<Node> &nodes, coord_t cell_size) : m_cell_size(cell_size) {
+        for (size_t i = 0; i < nodes.size(); ++ i)
+            m_cells[this->cell(nodes[i].position)].emplace_back(i);
+    }
+    // Call fn(node_idx) for all nodes in the cells overlapping the square of radius around pt.
+    template<typename Fn> void visit(const Point &pt, coord_t radius, Fn fn) const {
+        const std::pair<coord_t, coord_t> lo = this->cell_coords(pt - Point(radius, radius));
+        const std::pair<coord_t, coord_t> hi = this->cell_coords(pt + Point(radius, radius));
+        for (coord_t y = lo.second; y <= hi.second; ++ y)
+            for (coord_t x = lo.first; x <= hi.first; ++ x)
+                if (auto it = m_cells.find(key(x, y)); it != m_cells.end())
+                    for (size_t idx : it->second)
+                        fn(idx);
+    }
+private:
+    std::pair<coord_t, coord_t> cell_coords(const Point &pt) const {
+        auto floor_div = [this](coord_t v) { return v >= 0 ? v / m_cell_size : - ((- v + m_cell_size - 1) / m_cell_size); };
+        return { floor_div(pt.x()), floor_div(pt.y()) };
+    }
+    static uint64_t key(coord_t x, coord_t y) { return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(y)); }
+    uint64_t cell(const Point &pt) const { auto c = this->cell_coords(pt); return key(c.first, c.second); }
+
+    coord_t                                          m_cell_size;
+    std::unordered_map<uint64_t, std::vector<size_t>> m_cells;
+};
+
+static Polygon circle(const Point &center, coord_t radius)
+{
+    Polygon out;
+    out.points.reserve(TREE_SUPPORT_CIRCLE_SEGMENTS);
+    for (size_t i = 0; i < TREE_SUPPORT_CIRCLE_SEGMENTS; ++ i) {
+        double angle = 2. * PI * double(i) / double(TREE_SUPPORT_CIRCLE_SEGMENTS);
+        out.points.emplace_back(center.x() + coord_t(radius * cos(angle)), center.y() + coord_t(radius * sin(angle)));
+    }
+    return out;
+}
+
+static Polygons circles(const std::vector<Node> &nodes)
+{
+    Polygons out;
+    out.reserve(nodes.size());
+    for (const Node &node : nodes)
+        out.emplace_back(circle(node.position, node.radius));
+    return union_(out);
+}
+
+// Sample the contact area by a regular grid of branch tips, at least one tip per island.
+static void sample_tips(const ExPolygons &contacts, coord_t spacing, coord_t radius, std::vector<Node> &out)
+{
+    for (const ExPolygon &expoly : contacts) {
+        BoundingBox bbox = get_extents(expoly);
+        // Align the grid to the origin, so that the tips of the neighbor contact layers stack over each other.
+        Point       start((bbox.min.x() / spacing) * spacing, (bbox.min.y() / spacing) * spacing);
+        size_t      num_old = out.size();
+        for (coord_t y = start.y(); y <= bbox.max.y(); y += spacing)
+            for (coord_t x = start.x(); x <= bbox.max.x(); x += spacing)
+                if (Point pt(x, y); expoly.contains(pt))
+                    out.push_back({ pt, radius });
+        if (out.size() == num_old) {
+            // A tiny island, support it at a point inside of it.
+            Point pt = expoly.contour.centroid();
+            out.push_back({ expoly.contains(pt) ? pt : expoly.contour.points.front(), radius });
+        }
+    }
+}
+
+// Move the node out of the object by its radius plus the XY gap if it is closer to the object.
+// Returns false if the node could not be moved out by at most max_move.
+static bool avoid_collision(Node &node, const Collision &collision, coord_t gap_xy, coord_t max_move)
+{
+    if (collision.slices.empty())
+        return true;
+    const coord_t clearance = node.radius + gap_xy;
+    EdgeGrid::Grid::ClosestPointResult cp = collision.grid.closest_point(node.position, clearance + max_move);
+    if (! cp.valid())
+        // Far away from any contour, thus either well clear of the object or deep inside of it.
+        return ! collision.inside(node.position);
+    if (cp.distance >= double(clearance))
+        return true;
+    if (double(clearance) - cp.distance > double(max_move))
+        return false;
+    // Foot point on the closest contour and the outward normal at the node.
+    const Points &pts = *collision.grid.contours()[cp.contour_idx];
+    const Point  &p1  = pts[cp.start_point_idx];
+    const Point  &p2  = pts[(cp.start_point_idx + 1 == pts.size()) ? 0 : cp.start_point_idx + 1];
+    Vec2d foot   = p1.cast<double>() * (1. - cp.t) + p2.cast<double>() * cp.t;
+    Vec2d normal = node.position.cast<double>() - foot;
+    double l = normal.norm();
+    if (l < SCALED_EPSILON) {
+        // On the contour, take the normal of the segment. Contours are CCW, holes CW, the material is on the left.
+        Vec2d v = (p2 - p1).cast<double>();
+        normal = Vec2d(v.y(), - v.x());
+        l = normal.norm();
+        if (l == 0.)
+            return false;
+    } else if (cp.distance < 0.)
+        normal = - normal;
+    foot += normal * (double(clearance + SCALED_EPSILON) / l);
+    node.position = Point(coord_t(foot.x()), coord_t(foot.y()));
+    return true;
+}
+
+} // namespace TreeSupport
+
+// Tree support variant of bottom_contact_layers_and_layer_support_areas().
+// The top contact areas are sampled by branch tips, the branches grow down layer by layer, they are attracted
+// by their neighbors on a coarse hash grid, merge and thicken, while they avoid the object by its XY gap.
+// The branches end on the print bed or on the top surfaces of the object, where they produce bottom contact layers.
+// The branch cross sections are returned as layer_support_areas, thus the rest of the pipeline is shared with the grid supports.
+PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_contact_layers_and_layer_support_areas_tree(
+    const PrintObject &object, const MyLayersPtr &top_contacts, MyLayerStorage &layer_storage,
+    std::vector<Polygons> &layer_support_areas) const
+{
+    using namespace TreeSupport;
+    const int num_layers = int(object.total_layer_count());
+    layer_support_areas.assign(num_layers, Polygons());
+    MyLayersPtr bottom_contacts;
+    if (top_contacts.empty() || num_layers < 2)
+        return bottom_contacts;
+
+    const coord_t tip_radius    = std::max<coord_t>(m_support_material_flow.scaled_width(), coord_t(scale_(0.4)));
+    const coord_t max_radius    = std::max<coord_t>(tip_radius, coord_t(scale_(TREE_SUPPORT_MAX_BRANCH_RADIUS)));
+    const coord_t tip_spacing   = std::max<coord_t>(4 * tip_radius, coord_t(scale_(2. * (m_object_config->support_material_spacing.value + m_support_material_flow.spacing()))));
+    // Branches closer than this are attracted to each other.
+    const coord_t merge_radius  = 3 * tip_spacing;
+    const coord_t gap_xy        = coord_t(scale_(m_gap_xy));
+    const double  tan_angle     = tan(Geometry::deg2rad(TREE_SUPPORT_BRANCH_ANGLE));
+    const bool    buildplate_only = m_object_config->support_material_buildplate_only.value;
+
+    // 1) Collision geometry of all layers, in parallel.
+    std::vector<Collision> collisions(num_layers);
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_layers),
+        [&object, &collisions](const tbb::blocked_range<int> &range) {
+        for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+            throw_if_canceled(object);
+            Collision &collision = collisions[layer_id];
+            collision.slices = object.get_layer(layer_id)->lslices;
+            if (collision.slices.empty())
+                continue;
+            collision.bbox = get_extents(collision.slices);
+            collision.grid.create(collision.slices, coord_t(scale_(1.)));
+        }
+    });
+
+    // 2) Grow the branches top down. This is a serial chain, the branches of a layer depend on the layer above.
+    std::vector<std::vector<Node>> layer_nodes(num_layers);
+    // Nodes landing on the top surfaces of an object layer, to produce the bottom contacts from.
+    std::vector<std::vector<Node>> layer_landed(num_layers);
+    std::vector<Node>              nodes;
+    int                            contact_idx = int(top_contacts.size()) - 1;
+    for (int layer_id = num_layers - 2; layer_id >= 0; -- layer_id) {
+        const Layer    &layer    = *object.get_layer(layer_id);
+        const coord_t   max_move = std::max<coord_t>(coord_t(scale_(layer.height * tan_angle)), 1);
+        const coord_t   growth   = coord_t(scale_(layer.height * TREE_SUPPORT_BRANCH_GROWTH));
+
+        // Attract the branches to their closest neighbors.
+        if (nodes.size() > 1) {
+            NodeGrid          grid(nodes, merge_radius);
+            std::vector<Node> moved(nodes);
+            for (size_t i = 0; i < nodes.size(); ++ i) {
+                size_t  closest      = size_t(-1);
+                int64_t closest_dist = int64_t(merge_radius) * int64_t(merge_radius);
+                grid.visit(nodes[i].position, merge_radius, [&nodes, &closest, &closest_dist, i](size_t j) {
+                    if (j != i)
+                        if (int64_t d = (nodes[j].position - nodes[i].position).cast<int64_t>().squaredNorm(); d < closest_dist) {
+                            closest      = j;
+                            closest_dist = d;
+                        }
+                });
+                if (closest != size_t(-1)) {
+                    Vec2d  v = (nodes[closest].position - nodes[i].position).cast<double>();
+                    double l = v.norm();
+                    double step = std::min(double(max_move), 0.5 * l);
+                    if (l > 0.)
+                        moved[i].position += (v * (step / l)).cast<coord_t>();
+                }
+            }
+            // Merge the branches, which got closer than a single move.
+            NodeGrid          grid_moved(moved, merge_radius);
+            std::vector<bool> merged(moved.size(), false);
+            nodes.clear();
+            for (size_t i = 0; i < moved.size(); ++ i) {
+                if (merged[i])
+                    continue;
+                Node    node  = moved[i];
+                double  area  = double(node.radius) * double(node.radius);
+                grid_moved.visit(node.position, max_move, [&moved, &merged, &node, &area, max_move, i](size_t j) {
+                    if (j > i && ! merged[j] && (moved[j].position - node.position).cast<int64_t>().squaredNorm() <= int64_t(max_move) * int64_t(max_move)) {
+                        merged[j] = true;
+                        // The merged branch keeps the cross section area of both.
+                        double area_j = double(moved[j].radius) * double(moved[j].radius);
+                        node.position = ((node.position.cast<double>() * area + moved[j].position.cast<double>() * area_j) / (area + area_j)).cast<coord_t>();
+                        area += area_j;
+                    }
+                });
+                node.radius = std::min(max_radius, coord_t(sqrt(area)));
+                nodes.emplace_back(node);
+            }
+        }
+
+        // Thicken the branches, keep them out of the object.
+        std::vector<char> collides(nodes.size(), false);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, nodes.size()),
+            [&nodes, &collides, &collisions, layer_id, growth, max_radius, gap_xy, max_move](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                Node &node = nodes[i];
+                node.radius = std::min(max_radius, node.radius + growth);
+                collides[i] = ! avoid_collision(node, collisions[layer_id], gap_xy, max_move);
+            }
+        });
+        {
+            size_t j = 0;
+            for (size_t i = 0; i < nodes.size(); ++ i)
+                if (! collides[i])
+                    nodes[j ++] = nodes[i];
+                else if (! buildplate_only)
+                    // The branch stands on the top surfaces of this object layer.
+                    layer_landed[layer_id].emplace_back(nodes[i]);
+            nodes.resize(j);
+        }
+
+        // Start new branches below the top contacts above or at the level of this layer.
+        for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx) {
+            std::vector<Node> tips;
+            sample_tips(union_ex(top_contacts[contact_idx]->polygons), tip_spacing, tip_radius, tips);
+            for (Node &tip : tips)
+                if (avoid_collision(tip, collisions[layer_id], gap_xy, tip_spacing))
+                    nodes.emplace_back(tip);
+        }
+        layer_nodes[layer_id] = nodes;
+    }
+
+    // 3) Branch cross sections and the bottom contacts in parallel.
+    std::vector<MyLayer*> layer_bottom_contacts(num_layers, nullptr);
+    std::vector<Polygons> layer_touching(num_layers);
+    tbb::spin_mutex       layer_storage_mutex;
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_layers),
+        [this, &object, &top_contacts, &layer_nodes, &layer_landed, &layer_support_areas, &layer_bottom_contacts, &layer_touching,
+         &layer_storage, &layer_storage_mutex](const tbb::blocked_range<int> &range) {
+        for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+            throw_if_canceled(object);
+            if (! layer_nodes[layer_id].empty())
+                layer_support_areas[layer_id] = circles(layer_nodes[layer_id]);
+            if (layer_landed[layer_id].empty())
+                continue;
+            const Layer &layer    = *object.get_layer(layer_id);
+            Polygons     touching = intersection(circles(layer_landed[layer_id]), to_polygons(layer.lslices));
+            if (touching.empty())
+                continue;
+            MyLayer &layer_new = layer_allocate(layer_storage, layer_storage_mutex, sltBottomContact);
+            // Last top contact layer below the top contacts consumed down to this layer.
+            int contact_idx = int(std::lower_bound(top_contacts.begin(), top_contacts.end(), layer.print_z - EPSILON,
+                [](const MyLayer *l, coordf_t z) { return l->print_z <= z; }) - top_contacts.begin()) - 1;
+            this->init_bottom_contact_layer(layer_new, object, top_contacts, contact_idx, layer_id, touching);
+            layer_bottom_contacts[layer_id] = &layer_new;
+            layer_touching[layer_id] = offset(touching, double(SCALED_EPSILON));
+        }
+    });
+
+    // Merge the bottom contacts and trim the support areas above them, top down as bottom_contact_layers_and_layer_support_areas() does.
+    for (int layer_id = num_layers - 2; layer_id >= 0; -- layer_id)
+        if (MyLayer *layer_new = layer_bottom_contacts[layer_id]; layer_new != nullptr) {
+            bottom_contacts.push_back(layer_new);
+            for (int layer_id_above = layer_id + 1; layer_id_above < num_layers; ++ layer_id_above) {
+                if (object.layers()[layer_id_above]->print_z > layer_new->print_z - EPSILON)
+                    break;
+                if (! layer_support_areas[layer_id_above].empty())
+                    layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], layer_touching[layer_id]);
+            }
+        }
+    std::reverse(bottom_contacts.begin(), bottom_contacts.end());
+    trim_support_layers_by_object(object, bottom_contacts, 
+        m_slicing_params.soluble_interface ? 0. : this->m_slicing_params.gap_support_object,
+        m_slicing_params.soluble_interface ? 0. : this->m_slicing_params.gap_object_support, m_gap_xy);
+    return bottom_contacts;
+}
+
 // FN_HIGHER_EQUAL: the provided object pointer has a Z value >= of an internal threshold.
 // Find the first item with Z value >= of an internal threshold of fn_higher_equal.
 // If no vec item with Z value >= of an internal threshold of fn_higher_equal is found, return vec.size()
@@ -1731,6 +2216,7 @@ void PrintObjectSupportMaterial::trim_top_contacts_by_bottom_contacts(
             int idx_bottom_overlapping_first = -2;
             // For all top contact layers, counting downwards due to the way idx_higher_or_equal caches the last index to avoid repeated binary search.
             for (int idx_top = range.end() - 1; idx_top >= range.begin(); -- idx_top) {
+                throw_if_canceled(object);
                 MyLayer &layer_top = *top_contacts[idx_top];
                 // Find the first bottom layer overlapping with layer_top.
                 idx_bottom_overlapping_first = idx_lower_or_equal(bottom_contacts, idx_bottom_overlapping_first, [&layer_top](const MyLayer *layer_bottom){ return layer_bottom->bottom_print_z() - EPSILON <= layer_top.bottom_z; });
@@ -1971,6 +2457,7 @@ void PrintObjectSupportMaterial::generate_base_layers(
             // Counting down due to the way idx_lower_or_equal caches indices to avoid repeated binary search over the complete sequence.
             for (int idx_intermediate = int(range.end()) - 1; idx_intermediate >= int(range.begin()); -- idx_intermediate)
             {
+                throw_if_canceled(object);
                 BOOST_LOG_TRIVIAL(trace) << "Support generator - generate_base_layers - creating layer " << 
                     idx_intermediate << " of " << intermediate_layers.size();
                 MyLayer &layer_intermediate = *intermediate_layers[idx_intermediate];
@@ -2047,7 +2534,7 @@ void PrintObjectSupportMaterial::generate_base_layers(
                 if (polygons_trimming.empty())
                     layer_intermediate.polygons = std::move(polygons_new);
                 else
-                    layer_intermediate.polygons = diff(
+                    layer_intermediate.polygons = ClipperContext::local().diff(
                         polygons_new,
                         polygons_trimming,
                         true); // safety offset to merge the touching source polygons
@@ -2111,7 +2598,9 @@ void PrintObjectSupportMaterial::trim_support_layers_by_object(
         tbb::blocked_range<size_t>(0, nonempty_layers.size()),
         [this, &object, &nonempty_layers, gap_extra_above, gap_extra_below, gap_xy_scaled](const tbb::blocked_range<size_t>& range) {
             size_t idx_object_layer_overlapping = size_t(-1);
+            ClipperContext &clipper = ClipperContext::local();
             for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
+                throw_if_canceled(object);
                 MyLayer &support_layer = *nonempty_layers[idx_layer];
                 // BOOST_LOG_TRIVIAL(trace) << "Support generator - trim_support_layers_by_object - trimmming non-empty layer " << idx_layer << " of " << nonempty_layers.size();
                 assert(! support_layer.polygons.empty() && support_layer.print_z >= m_slicing_params.raft_contact_top_z + EPSILON);
@@ -2127,7 +2616,7 @@ void PrintObjectSupportMaterial::trim_support_layers_by_object(
                     const Layer &object_layer = *object.layers()[i];
                     if (object_layer.print_z - object_layer.height > support_layer.print_z + gap_extra_above - EPSILON)
                         break;
-                    polygons_append(polygons_trimming, offset(object_layer.lslices, gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
+                    polygons_append(polygons_trimming, clipper.offset(object_layer.lslices, gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
                 }
                 if (!m_slicing_params.soluble_interface) {
                     // Collect all bottom surfaces, which will be extruded with a bridging flow.
@@ -2142,10 +2631,10 @@ void PrintObjectSupportMaterial::trim_support_layers_by_object(
                                 break;
                             some_region_overlaps = true;
                             polygons_append(polygons_trimming, 
-                                offset(to_expolygons(region->fill_surfaces.filter_by_type(stPosBottom | stDensSolid | stModBridge)), 
-                                       gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
+                                clipper.offset(to_expolygons(region->fill_surfaces.filter_by_type(stPosBottom | stDensSolid | stModBridge)), 
+                                               gap_xy_scaled, SUPPORT_SURFACES_OFFSET_PARAMETERS));
                             if (region->region()->config().overhangs_width.value > 0)
-                                SupportMaterialInternal::collect_bridging_perimeter_areas(region->perimeters.entities, gap_xy_scaled, polygons_trimming);
+                                SupportMaterialInternal::collect_bridging_perimeter_areas(region->perimeters, gap_xy_scaled, polygons_trimming);
                         }
                         if (! some_region_overlaps)
                             break;
@@ -2155,7 +2644,7 @@ void PrintObjectSupportMaterial::trim_support_layers_by_object(
                 // perimeter's width. $support contains the full shape of support
                 // material, thus including the width of its foremost extrusion.
                 // We leave a gap equal to a full extrusion width.
-                support_layer.polygons = diff(support_layer.polygons, polygons_trimming);
+                support_layer.polygons = clipper.diff(support_layer.polygons, polygons_trimming);
             }
         });
     BOOST_LOG_TRIVIAL(debug) << "PrintObjectSupportMaterial::trim_support_layers_by_object() in parallel - end";
@@ -2236,7 +2725,7 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::generate_raf
             new_layer.bottom_z = print_z;
             new_layer.polygons = interface_polygons;
             //FIXME misusing contact_polygons for support columns.
-            new_layer.contact_polygons = new Polygons(columns);
+            new_layer.contact_polygons = layer_storage.allocate_polygons(Polygons(columns));
         }
     } else if (columns_base != nullptr) {
         // Expand the bases of the support columns in the 1st layer.
@@ -2273,6 +2762,7 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::generate_int
                 // Index of the first bottom contact layer intersecting the current intermediate layer.
                 size_t idx_bottom_contact_first = size_t(-1);
                 for (size_t idx_intermediate_layer = range.begin(); idx_intermediate_layer < range.end(); ++ idx_intermediate_layer) {
+                    throw_if_canceled(*m_object);
                     MyLayer &intermediate_layer = *intermediate_layers[idx_intermediate_layer];
                     // Top / bottom Z coordinate of a slab, over which we are collecting the top / bottom contact surfaces.
                     coordf_t top_z    = intermediate_layers[std::min<int>(intermediate_layers.size()-1, idx_intermediate_layer + m_object_config->support_material_interface_layers - 1)]->print_z;
@@ -2722,11 +3212,9 @@ void modulate_extrusion_by_overlapping_layers(
         return;
 
     //TODO: should preserve the unsortable things
-    ExtrusionEntityCollection flatten_extrusions_in_out = extrusions_in_out.flatten();
-
     // Get the initial extrusion parameters.
     GetFirstPath getFirstPathVisitor;
-    flatten_extrusions_in_out.entities.front()->visit(getFirstPathVisitor);
+    extrusions_in_out.visit(getFirstPathVisitor);
     const ExtrusionPath *extrusion_path_template = getFirstPathVisitor.extrusion_path_template;
     assert(extrusion_path_template != nullptr);
     ExtrusionRole extrusion_role = extrusion_path_template->role();
@@ -2802,13 +3290,14 @@ void modulate_extrusion_by_overlapping_layers(
     // Collect the paths of this_layer.
     {
         Polylines &polylines = path_fragments.back().polylines;
-        for (ExtrusionEntitiesPtr::const_iterator it = flatten_extrusions_in_out.entities.begin(); it != flatten_extrusions_in_out.entities.end(); ++it) {
-            Polylines polylines_from_entity = (*it)->as_polylines();
+        // The leaves are visited in place, they are destroyed together with extrusions_in_out once their polylines are collected.
+        extrusions_in_out.for_each_leaf([&polylines, &path_ends](const ExtrusionEntity &entity) {
+            Polylines polylines_from_entity = entity.as_polylines();
             for (Polyline &polyline : polylines_from_entity) {
                 polylines.emplace_back(std::move(polyline));
             }
             path_ends.emplace_back(std::pair<Point, Point>(polylines.back().points.front(), polylines.back().points.back()));
-        }
+        });
     }
     // Destroy the original extrusion paths, their polylines were moved to path_fragments already.
     // This will be the destination for the new paths.
@@ -3033,6 +3522,7 @@ void PrintObjectSupportMaterial::generate_toolpaths(
             (const tbb::blocked_range<size_t>& range) {
         for (size_t support_layer_id = range.begin(); support_layer_id < range.end(); ++ support_layer_id)
         {
+            throw_if_canceled(object);
             assert(support_layer_id < raft_layers.size());
             SupportLayer &support_layer = *object.support_layers()[support_layer_id];
             assert(support_layer.support_fills.entities.empty());
@@ -3156,6 +3646,7 @@ void PrintObjectSupportMaterial::generate_toolpaths(
         filler_support->set_bounding_box(bbox_object);
         for (size_t support_layer_id = range.begin(); support_layer_id < range.end(); ++ support_layer_id)
         {
+            throw_if_canceled(object);
             SupportLayer &support_layer = *object.support_layers()[support_layer_id];
             LayerCache   &layer_cache   = layer_caches[support_layer_id];
 
@@ -3375,6 +3866,7 @@ void PrintObjectSupportMaterial::generate_toolpaths(
         [this, &object, &layer_caches]
             (const tbb::blocked_range<size_t>& range) {
         for (size_t support_layer_id = range.begin(); support_layer_id < range.end(); ++ support_layer_id) {
+            throw_if_canceled(object);
             SupportLayer &support_layer = *object.support_layers()[support_layer_id];
             LayerCache   &layer_cache   = layer_caches[support_layer_id];
             for (LayerCacheItem &layer_cache_item : layer_cache.overlaps) {
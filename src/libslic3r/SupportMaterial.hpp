@@ -5,12 +5,41 @@
 #include "PrintConfig.hpp"
 #include "Slicing.hpp"
 
+#include <limits>
+#include <memory>
+#include <optional>
+
 namespace Slic3r {
 
 class PrintObject;
 class PrintConfig;
 class PrintObjectConfig;
 
+// Top contact layers produced by the last support generation of a PrintObject, before their merging.
+// When only the support painting changes, the layers outside of the Z range of the modified facets are restored from here
+// instead of detecting the overhangs again, see PrintObject::invalidate_support_painting().
+struct SupportContactsCache
+{
+    struct ContactLayer {
+        coordf_t    print_z                 { 0. };
+        coordf_t    bottom_z                { 0. };
+        coordf_t    height                  { 0. };
+        size_t      idx_object_layer_above  { size_t(-1) };
+        bool        bridging                { false };
+        Polygons    polygons;
+        Polygons    contact_polygons;
+        Polygons    overhang_polygons;
+    };
+    // Two slots per object layer: the contact layer and the optional bridging contact layer.
+    std::vector<std::optional<ContactLayer>>    layers;
+    // Z range of the modified support painting, the layers touching it have to be recalculated.
+    coordf_t                                    dirty_z_min { std::numeric_limits<coordf_t>::max() };
+    coordf_t                                    dirty_z_max { std::numeric_limits<coordf_t>::lowest() };
+
+    void invalidate_z_range(coordf_t z_min, coordf_t z_max) { dirty_z_min = std::min(dirty_z_min, z_min); dirty_z_max = std::max(dirty_z_max, z_max); }
+    void validate() { dirty_z_min = std::numeric_limits<coordf_t>::max(); dirty_z_max = std::numeric_limits<coordf_t>::lowest(); }
+};
+
 // how much we extend support around the actual contact area
 //FIXME this should be dependent on the nozzle diameter!
 #define SUPPORT_MATERIAL_MARGIN 1.5	
@@ -65,14 +94,6 @@ public:
 			overhang_polygons(nullptr)
 			{}
 
-		~MyLayer() 
-		{
-			delete contact_polygons;
-			contact_polygons = nullptr;
-			delete overhang_polygons;
-			overhang_polygons = nullptr;
-		}
-
 		void reset() {
 			layer_type  			= sltUnknown;
 			print_z 				= 0.;
@@ -83,9 +104,12 @@ public:
 			idx_object_layer_below  = size_t(-1);
 			bridging 				= false;
 			polygons.clear();
-			delete contact_polygons;
+			// The polygon containers are owned by the MyLayerStorage, release just their content.
+			if (contact_polygons != nullptr)
+				Polygons().swap(*contact_polygons);
 			contact_polygons 		= nullptr;
-			delete overhang_polygons;
+			if (overhang_polygons != nullptr)
+				Polygons().swap(*overhang_polygons);
 			overhang_polygons 		= nullptr;
 		}
 
@@ -138,15 +162,42 @@ public:
     	// Polygons to be filled by the support pattern.
     	Polygons polygons;
     	// Currently for the contact layers only.
-    	// MyLayer owns the contact_polygons and overhang_polygons, they are freed by the destructor.
+    	// The contact_polygons and overhang_polygons are allocated by and owned by the MyLayerStorage.
     	Polygons *contact_polygons;
     	Polygons *overhang_polygons;
 	};
 
-	// Layers are allocated and owned by a deque. Once a layer is allocated, it is maintained
-	// up to the end of a generate() method. The layer storage may be replaced by an allocator class in the future, 
-	// which would allocate layers by multiple chunks.
-	typedef std::deque<MyLayer> 				MyLayerStorage;
+	// Layers and their contact / overhang polygon containers are allocated by chunks and owned by the MyLayerStorage.
+	// Once a layer is allocated, it is maintained at a stable address up to the end of a generate() method,
+	// where the whole storage is released in one shot. Not thread safe, the parallel callers serialize the allocations by a mutex.
+	class MyLayerStorage {
+	public:
+		MyLayerStorage() = default;
+		MyLayerStorage(const MyLayerStorage&) = delete;
+		MyLayerStorage& operator=(const MyLayerStorage&) = delete;
+
+		MyLayer& 	allocate(SupporLayerType layer_type);
+		Polygons* 	allocate_polygons(Polygons &&polygons);
+
+	private:
+		template<typename T> class Chunks {
+		public:
+			T& allocate() {
+				if (m_chunks.empty() || m_last_chunk_size == CHUNK_SIZE) {
+					m_chunks.emplace_back(new T[CHUNK_SIZE]);
+					m_last_chunk_size = 0;
+				}
+				return m_chunks.back()[m_last_chunk_size ++];
+			}
+		private:
+			static constexpr size_t 			CHUNK_SIZE = 256;
+			std::vector<std::unique_ptr<T[]>> 	m_chunks;
+			size_t 								m_last_chunk_size { 0 };
+		};
+
+		Chunks<MyLayer> 	m_layers;
+		Chunks<Polygons> 	m_polygons;
+	};
 	typedef std::vector<MyLayer*> 				MyLayersPtr;
 
 public:
@@ -170,7 +221,8 @@ private:
 	// Generate top contact layers supporting overhangs.
 	// For a soluble interface material synchronize the layer heights with the object, otherwise leave the layer height undefined.
 	// If supports over bed surface only are requested, don't generate contact layers over an object.
-	MyLayersPtr top_contact_layers(const PrintObject &object, MyLayerStorage &layer_storage) const;
+	// The contact layers out of the dirty Z range of the cache are restored from it, the cache is updated with the new contact layers.
+	MyLayersPtr top_contact_layers(const PrintObject &object, MyLayerStorage &layer_storage, SupportContactsCache *cache = nullptr) const;
 
 	// Generate bottom contact layers supporting the top contact layers.
 	// For a soluble interface material synchronize the layer heights with the object, 
@@ -179,6 +231,16 @@ private:
 		const PrintObject &object, const MyLayersPtr &top_contacts, MyLayerStorage &layer_storage,
 		std::vector<Polygons> &layer_support_areas) const;
 
+	// Tree support variant of bottom_contact_layers_and_layer_support_areas(): the layer_support_areas are produced
+	// by branches growing down from the top contacts, merging and avoiding the object.
+	MyLayersPtr bottom_contact_layers_and_layer_support_areas_tree(
+		const PrintObject &object, const MyLayersPtr &top_contacts, MyLayerStorage &layer_storage,
+		std::vector<Polygons> &layer_support_areas) const;
+
+	// Fill in a bottom contact layer over the top surfaces of the object layer layer_id, supporting the touching areas.
+	void init_bottom_contact_layer(
+		MyLayer &layer_new, const PrintObject &object, const MyLayersPtr &top_contacts, int contact_idx, int layer_id, const Polygons &touching) const;
+
 	// Trim the top_contacts layers with the bottom_contacts layers if they overlap, so there would not be enough vertical space for both of them.
 	void trim_top_contacts_by_bottom_contacts(const PrintObject &object, const MyLayersPtr &bottom_contacts, MyLayersPtr &top_contacts) const;
 
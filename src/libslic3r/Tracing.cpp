@@ -0,0 +1,177 @@
+#include "Tracing.hpp"
+#include "Thread.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <vector>
+
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+namespace tracing {
+
+std::atomic<bool> g_enabled { false };
+
+namespace {
+
+struct Event
+{
+    const char *name;
+    int64_t     begin;
+    int64_t     end;
+};
+
+// Fixed size block of events. Only the owning thread writes into it, the number of the valid events
+// is published with a release store, so that the events may be read while the thread keeps recording.
+struct Chunk
+{
+    static constexpr size_t CAPACITY = 4096;
+    Event                   events[CAPACITY];
+    std::atomic<size_t>     size { 0 };
+    std::atomic<Chunk*>     next { nullptr };
+};
+
+struct ThreadBuffer
+{
+    // Chunks are never released, they are reused after start().
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    Chunk                              *head { nullptr };
+    // Chunk being filled by the owning thread.
+    Chunk                              *tail { nullptr };
+    int                                 tid;
+    std::string                         name;
+};
+
+// Buffers of all the threads which ever recorded a zone. The buffers outlive their threads.
+std::mutex                                  g_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>>  g_buffers;
+std::chrono::steady_clock::time_point       g_origin = std::chrono::steady_clock::now();
+
+ThreadBuffer& thread_buffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+        auto new_buffer = std::make_unique<ThreadBuffer>();
+        new_buffer->chunks.emplace_back(std::make_unique<Chunk>());
+        new_buffer->head = new_buffer->tail = new_buffer->chunks.front().get();
+        std::optional<std::string> name = get_current_thread_name();
+        std::lock_guard<std::mutex> lock(g_mutex);
+        new_buffer->tid  = int(g_buffers.size()) + 1;
+        new_buffer->name = name && ! name->empty() ? *name : "thread " + std::to_string(new_buffer->tid);
+        buffer = new_buffer.get();
+        g_buffers.emplace_back(std::move(new_buffer));
+    }
+    return *buffer;
+}
+
+template<typename Fn> void for_each_event(const ThreadBuffer &buffer, Fn fn)
+{
+    for (const Chunk *chunk = buffer.head; chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire)) {
+        size_t size = chunk->size.load(std::memory_order_acquire);
+        for (size_t i = 0; i < size; ++ i)
+            fn(chunk->events[i]);
+        if (size < Chunk::CAPACITY)
+            break;
+    }
+}
+
+} // namespace
+
+void start()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (std::unique_ptr<ThreadBuffer> &buffer : g_buffers) {
+        for (std::unique_ptr<Chunk> &chunk : buffer->chunks)
+            chunk->size.store(0, std::memory_order_relaxed);
+        buffer->tail = buffer->head;
+    }
+    g_origin = std::chrono::steady_clock::now();
+    // Publishes the cleared buffers to the threads, which test g_enabled before recording.
+    g_enabled.store(true, std::memory_order_release);
+}
+
+void stop()
+{
+    g_enabled.store(false, std::memory_order_release);
+}
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_origin).count();
+}
+
+void record(const char *name, int64_t begin, int64_t end)
+{
+    ThreadBuffer &buffer = thread_buffer();
+    Chunk        *chunk  = buffer.tail;
+    size_t        size   = chunk->size.load(std::memory_order_relaxed);
+    if (size == Chunk::CAPACITY) {
+        // Reuse the chunk allocated before start() or allocate a new one.
+        Chunk *next = chunk->next.load(std::memory_order_relaxed);
+        if (next == nullptr) {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            buffer.chunks.emplace_back(std::make_unique<Chunk>());
+            next = buffer.chunks.back().get();
+            chunk->next.store(next, std::memory_order_release);
+        }
+        buffer.tail = chunk = next;
+        size = 0;
+    }
+    chunk->events[size] = { name, begin, end };
+    chunk->size.store(size + 1, std::memory_order_release);
+}
+
+size_t num_zones()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    size_t cnt = 0;
+    for (const std::unique_ptr<ThreadBuffer> &buffer : g_buffers)
+        for_each_event(*buffer, [&cnt](const Event &) { ++ cnt; });
+    return cnt;
+}
+
+std::string chrome_trace_json()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool        first = true;
+    char        buf[256];
+    auto        append = [&out, &first](const char *event) {
+        if (! first)
+            out += ',';
+        first = false;
+        out += "\n";
+        out += event;
+    };
+    for (const std::unique_ptr<ThreadBuffer> &buffer : g_buffers) {
+        // The thread names are ASCII, see set_current_thread_name().
+        std::string name;
+        for (char c : buffer->name)
+            if (c != '"' && c != '\\' && (unsigned char)c >= 0x20)
+                name += c;
+        snprintf(buf, sizeof(buf), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", buffer->tid, name.c_str());
+        append(buf);
+        for_each_event(*buffer, [&buf, &append, &buffer](const Event &event) {
+            // Timestamps in microseconds.
+            snprintf(buf, sizeof(buf), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                event.name, buffer->tid, double(event.begin) * 0.001, double(event.end - event.begin) * 0.001);
+            append(buf);
+        });
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool write_chrome_trace(const std::string &path)
+{
+    boost::nowide::ofstream file(path);
+    file << chrome_trace_json();
+    file.close();
+    return ! file.fail();
+}
+
+} // namespace tracing
+} // namespace Slic3r
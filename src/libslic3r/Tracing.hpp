@@ -0,0 +1,59 @@
+#ifndef slic3r_Tracing_hpp_
+#define slic3r_Tracing_hpp_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Slic3r {
+namespace tracing {
+
+// Timeline of scoped zones recorded by all threads, including the TBB workers, to inspect the load balance
+// of the slicing pipeline. Each thread appends its zones into its own buffer without locking, the buffers
+// are dumped as a Chrome trace (chrome://tracing, ui.perfetto.dev) with a lane per thread.
+// The recording is switched on and off at runtime, a disabled zone costs an atomic load.
+
+extern std::atomic<bool> g_enabled;
+
+// Discard the zones recorded so far and start recording.
+// To be called while no traced work is running.
+void start();
+// Stop recording. The zones opened before stop() are still recorded when they close.
+void stop();
+inline bool enabled() { return g_enabled.load(std::memory_order_acquire); }
+
+// Number of the zones recorded since start().
+size_t      num_zones();
+// Chrome trace JSON of the zones recorded since start(), may be called while the traced work is running.
+std::string chrome_trace_json();
+// Write chrome_trace_json() into a file, returns false on failure.
+bool        write_chrome_trace(const std::string &path);
+
+// Nanoseconds since start().
+int64_t     now();
+// Append a zone into the buffer of the calling thread. The name has to outlive the trace, usually a string literal.
+void        record(const char *name, int64_t begin, int64_t end);
+
+// Records the lifetime of the scope it is declared in.
+class Zone
+{
+public:
+    explicit Zone(const char *name) : m_name(enabled() ? name : nullptr), m_begin(m_name ? now() : 0) {}
+    ~Zone() { if (m_name) record(m_name, m_begin, now()); }
+    Zone(const Zone &) = delete;
+    Zone& operator=(const Zone &) = delete;
+
+private:
+    const char *m_name;
+    int64_t     m_begin;
+};
+
+} // namespace tracing
+} // namespace Slic3r
+
+#define SLIC3R_TRACE_CONCAT_(a, b) a##b
+#define SLIC3R_TRACE_CONCAT(a, b) SLIC3R_TRACE_CONCAT_(a, b)
+// Trace the enclosing scope as a zone of the given name.
+#define SLIC3R_TRACE_ZONE(name) ::Slic3r::tracing::Zone SLIC3R_TRACE_CONCAT(slic3r_trace_zone_, __LINE__)(name)
+
+#endif // slic3r_Tracing_hpp_
@@ -6,6 +6,7 @@
 #include <libqhullcpp/Qhull.h>
 #include <libqhullcpp/QhullFacetList.h>
 #include <libqhullcpp/QhullVertexSet.h>
+#include <libqhullcpp/QhullVertex.h>
 #include <cmath>
 #include <deque>
 #include <queue>
@@ -14,12 +15,20 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <numeric>
+#include <array>
+#include <atomic>
 #include <math.h>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/task_scheduler_init.h>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -101,6 +110,99 @@ TriangleMesh::TriangleMesh(const indexed_triangle_set &M) : repaired(false)
 
 // #define SLIC3R_TRACE_REPAIR
 
+// Fast path of stl_check_facets_exact() for the trusted input: If the mesh has no degenerate facets and each of its edges
+// is shared by exactly two facets oriented consistently, connects all the neighbors and returns true.
+// The edges are matched by sorting them in parallel instead of inserting them into the hash table one by one.
+// Otherwise returns false without touching the neighbors, and the full repair has to be performed.
+static bool connect_manifold_facets(stl_file &stl)
+{
+    const size_t num_facets = stl.stats.number_of_facets;
+    if (num_facets == 0 || stl.neighbors_start.size() != num_facets)
+        return false;
+
+    struct Edge {
+        // Bits of the coordinates of the lower vertex followed by the higher vertex, negative zeros switched to positive zeros.
+        std::array<uint32_t, 6> key;
+        uint32_t                facet;
+        // Index of the edge in the facet, plus 3 if the edge is loaded backwards.
+        uint32_t                which_edge;
+    };
+    auto vertex_key = [](const stl_vertex &v, uint32_t *key) {
+        for (int i = 0; i < 3; ++ i) {
+            // Adding a positive zero converts a negative zero to a positive one.
+            float f = v(i) + 0.f;
+            memcpy(key + i, &f, sizeof(float));
+        }
+    };
+    std::vector<Edge> edges(num_facets * 3);
+    std::atomic<bool> degenerate(false);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets), [&stl, &edges, &degenerate, vertex_key](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const stl_facet &facet = stl.facet_start[i];
+            if (facet.vertex[0] == facet.vertex[1] || facet.vertex[1] == facet.vertex[2] || facet.vertex[0] == facet.vertex[2]) {
+                degenerate = true;
+                return;
+            }
+            for (uint32_t j = 0; j < 3; ++ j) {
+                Edge &edge = edges[i * 3 + j];
+                std::array<uint32_t, 3> a, b;
+                vertex_key(facet.vertex[j], a.data());
+                vertex_key(facet.vertex[(j + 1) % 3], b.data());
+                edge.facet      = uint32_t(i);
+                edge.which_edge = j;
+                if (b < a) {
+                    std::swap(a, b);
+                    edge.which_edge += 3;
+                }
+                std::copy(a.begin(), a.end(), edge.key.begin());
+                std::copy(b.begin(), b.end(), edge.key.begin() + 3);
+            }
+        }
+    });
+    if (degenerate)
+        return false;
+
+    tbb::parallel_sort(edges.begin(), edges.end(), [](const Edge &l, const Edge &r) { return l.key < r.key || (l.key == r.key && l.which_edge < r.which_edge); });
+
+    // Each edge has to be paired with a single edge of the opposite direction.
+    std::atomic<bool> manifold(true);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets * 3 / 2), [&edges, &manifold](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const Edge &a = edges[i * 2];
+            const Edge &b = edges[i * 2 + 1];
+            if (a.key != b.key || a.which_edge > 2 || b.which_edge < 3 || (i > 0 && edges[i * 2 - 1].key == a.key) || (i * 2 + 2 < edges.size() && edges[i * 2 + 2].key == a.key)) {
+                manifold = false;
+                return;
+            }
+        }
+    });
+    if (edges.size() % 2 == 1 || ! manifold)
+        return false;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets * 3 / 2), [&stl, &edges](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const Edge &a = edges[i * 2];
+            const Edge &b = edges[i * 2 + 1];
+            // The same as record_neighbors() of admesh for a pair of consistently oriented facets.
+            stl.neighbors_start[a.facet].neighbor[a.which_edge]               = int(b.facet);
+            stl.neighbors_start[a.facet].which_vertex_not[a.which_edge]       = char((b.which_edge + 2) % 3);
+            stl.neighbors_start[b.facet].neighbor[b.which_edge - 3]           = int(a.facet);
+            stl.neighbors_start[b.facet].which_vertex_not[b.which_edge - 3]   = char((a.which_edge + 2) % 3);
+        }
+    });
+
+    for (size_t i = 0; i < num_facets; ++ i)
+        for (int j = 0; j < 3; ++ j) {
+            stl_vertex diff = (stl.facet_start[i].vertex[j] - stl.facet_start[i].vertex[(j + 1) % 3]).cwiseAbs();
+            stl.stats.shortest_edge = std::min(diff.maxCoeff(), stl.stats.shortest_edge);
+        }
+    stl.stats.connected_edges         = int(num_facets * 3);
+    stl.stats.connected_facets_1_edge = int(num_facets);
+    stl.stats.connected_facets_2_edge = int(num_facets);
+    stl.stats.connected_facets_3_edge = int(num_facets);
+    return true;
+}
+
 void TriangleMesh::repair(bool update_shared_vertices)
 {
     if (this->repaired) {
@@ -120,7 +222,10 @@ void TriangleMesh::repair(bool update_shared_vertices)
 	BOOST_LOG_TRIVIAL(trace) << "\tstl_check_faces_exact";
 #endif /* SLIC3R_TRACE_REPAIR */
 	assert(stl_validate(&this->stl));
-	stl_check_facets_exact(&stl);
+    // Closed and consistently oriented meshes, for example the ones exported by CAD tools, do not need the cascade of the repairs below.
+    const bool trusted = connect_manifold_facets(stl);
+    if (! trusted)
+	    stl_check_facets_exact(&stl);
     assert(stl_validate(&this->stl));
     stl.stats.facets_w_1_bad_edge = (stl.stats.connected_facets_2_edge - stl.stats.connected_facets_3_edge);
     stl.stats.facets_w_2_bad_edge = (stl.stats.connected_facets_1_edge - stl.stats.connected_facets_2_edge);
@@ -182,7 +287,12 @@ void TriangleMesh::repair(bool update_shared_vertices)
 #ifdef SLIC3R_TRACE_REPAIR
     BOOST_LOG_TRIVIAL(trace) << "\tstl_fix_normal_values";
 #endif /* SLIC3R_TRACE_REPAIR */
-    stl_fix_normal_values(&stl);
+    // Each facet only touches its own normal, recalculate the normals in parallel.
+    stl.stats.normals_fixed += tbb::parallel_reduce(tbb::blocked_range<uint32_t>(0, stl.stats.number_of_facets), 0,
+        [this](const tbb::blocked_range<uint32_t> &range, int normals_fixed) {
+            return normals_fixed + stl_fix_normal_values(&this->stl, range.begin(), range.end());
+        },
+        std::plus<int>());
     assert(stl_validate(&this->stl));
     
     // always calculate the volume and reverse all normals if volume is negative
@@ -193,10 +303,15 @@ void TriangleMesh::repair(bool update_shared_vertices)
     assert(stl_validate(&this->stl));
     
     // neighbors
+    if (trusted)
+        // All the edges were matched exactly and oriented consistently.
+        stl.stats.backwards_edges = 0;
+    else {
 #ifdef SLIC3R_TRACE_REPAIR
-    BOOST_LOG_TRIVIAL(trace) << "\tstl_verify_neighbors";
+        BOOST_LOG_TRIVIAL(trace) << "\tstl_verify_neighbors";
 #endif /* SLIC3R_TRACE_REPAIR */
-    stl_verify_neighbors(&stl);
+        stl_verify_neighbors(&stl);
+    }
     assert(stl_validate(&this->stl));
 
     this->repaired = true;
@@ -564,24 +679,62 @@ BoundingBoxf3 TriangleMesh::transformed_bounding_box(const Transform3d &trafo) c
     return bbox;
 }
 
+// Reduce a large point cloud to the vertices of the convex hulls of its chunks, calculated in parallel.
+// The convex hull of the reduced set equals the convex hull of the original points.
+static std::vector<realT> convex_hull_3d_prehull(const realT *src_vertices, size_t num_points)
+{
+    static constexpr size_t chunk_size = 100000;
+    const size_t num_chunks = (num_points + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<realT>> chunk_hulls(num_chunks);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks), [src_vertices, &chunk_hulls, num_points](const tbb::blocked_range<size_t> &range) {
+        for (size_t chunk_id = range.begin(); chunk_id < range.end(); ++ chunk_id) {
+            const size_t first = chunk_id * chunk_size;
+            const size_t last  = std::min(first + chunk_size, num_points);
+            std::vector<realT> &out = chunk_hulls[chunk_id];
+            try {
+                orgQhull::Qhull qhull;
+                qhull.disableOutputStream();
+                qhull.runQhull("", 3, int(last - first), src_vertices + 3 * first, "Qt");
+                for (const orgQhull::QhullVertex &vertex : qhull.vertexList().toStdVector()) {
+                    const realT *coords = vertex.point().coordinates();
+                    out.insert(out.end(), coords, coords + 3);
+                }
+            } catch (...) {
+                // Degenerate chunk (e.g. coplanar points), keep all its points.
+                out.assign(src_vertices + 3 * first, src_vertices + 3 * last);
+            }
+        }
+    });
+    std::vector<realT> out;
+    size_t size = 0;
+    for (const std::vector<realT> &hull : chunk_hulls)
+        size += hull.size();
+    out.reserve(size);
+    for (const std::vector<realT> &hull : chunk_hulls)
+        append(out, hull);
+    return out;
+}
+
 TriangleMesh TriangleMesh::convex_hull_3d() const
 {
     // The qhull call:
     orgQhull::Qhull qhull;
     qhull.disableOutputStream(); // we want qhull to be quiet
 	std::vector<realT> src_vertices;
+    const realT *points = nullptr;
+    size_t num_points = 0;
 	try
     {
     	if (this->has_shared_vertices()) {
 #if REALfloat
-	    	qhull.runQhull("", 3, (int)this->its.vertices.size(), (const realT*)(this->its.vertices.front().data()), "Qt");
+            points     = (const realT*)(this->its.vertices.front().data());
+            num_points = this->its.vertices.size();
 #else
 	    	src_vertices.reserve(this->its.vertices.size() * 3);
 	    	// We will now fill the vector with input points for computation:
 			for (const stl_vertex &v : this->its.vertices)
 				for (int i = 0; i < 3; ++ i)
 		        	src_vertices.emplace_back(v(i));
-	        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
 #endif
 	    } else {
 	    	src_vertices.reserve(this->stl.facet_start.size() * 9);
@@ -590,8 +743,18 @@ TriangleMesh TriangleMesh::convex_hull_3d() const
 				for (int i = 0; i < 3; ++ i)
 					for (int j = 0; j < 3; ++ j)
 		        		src_vertices.emplace_back(f.vertex[i](j));
-	        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
 	    }
+        if (points == nullptr) {
+            points     = src_vertices.data();
+            num_points = src_vertices.size() / 3;
+        }
+        // Huge meshes are first reduced to the vertices of the convex hulls of their chunks.
+        if (num_points > 200000) {
+            src_vertices = convex_hull_3d_prehull(points, num_points);
+            points       = src_vertices.data();
+            num_points   = src_vertices.size() / 3;
+        }
+        qhull.runQhull("", 3, (int)num_points, points, "Qt");
     }
     catch (...)
     {
@@ -672,7 +835,8 @@ void TriangleMesh::restore_optional()
 		stl_stats stats = this->stl.stats;
 		if (this->stl.neighbors_start.empty()) {
 			stl_reallocate(&this->stl);
-			stl_check_facets_exact(&this->stl);
+			if (! connect_manifold_facets(this->stl))
+				stl_check_facets_exact(&this->stl);
 		}
 		if (this->its.vertices.empty())
 			stl_generate_shared_vertices(&this->stl, this->its);
@@ -772,8 +936,27 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
 
 void TriangleMeshSlicer::set_up_direction(const Vec3f& up)
 {
-    m_quaternion.setFromTwoVectors(up, Vec3f::UnitZ());
-    m_use_quaternion = true;
+    Eigen::Quaternion<float, Eigen::DontAlign> quaternion;
+    quaternion.setFromTwoVectors(up, Vec3f::UnitZ());
+    if (! m_use_quaternion || quaternion.coeffs() != m_quaternion.coeffs()) {
+        m_quaternion     = quaternion;
+        m_use_quaternion = true;
+        // The facets have to be sorted again for the new direction.
+        m_sweep_facets.clear();
+    }
+}
+
+// Minimum number of facets of a mesh, for which TriangleMeshSlicer::slice() sorts the facets by their minimum Z before slicing.
+static constexpr size_t SLICE_SORT_FACETS_MIN = 200000;
+
+namespace {
+    struct ZSortedFacet {
+        // Facet rotated by TriangleMeshSlicer::m_quaternion.
+        stl_facet   facet;
+        float       min_z;
+        float       max_z;
+        int         facet_idx;
+    };
 }
 
 void TriangleMeshSlicer::slice(
@@ -811,34 +994,106 @@ void TriangleMeshSlicer::slice(
     */
     
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_do";
-    std::vector<IntersectionLines> lines(z.size());
-    {
-        boost::mutex lines_mutex;
+    const size_t num_facets = size_t(this->mesh->stl.stats.number_of_facets);
+    // Large meshes are sliced in the order of the minimum Z of their facets: the (rotated) facets are copied
+    // into a contiguous array, which is then read sequentially, and the facets not crossing any slicing plane are dropped.
+    // Each block of consecutive sorted facets then only touches a narrow range of layers.
+    const bool                sorted = num_facets >= SLICE_SORT_FACETS_MIN && ! z.empty();
+    std::vector<ZSortedFacet> sorted_facets;
+    if (sorted) {
+        BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::slice - sorting facets";
+        sorted_facets.assign(num_facets, ZSortedFacet());
         tbb::parallel_for(
-            tbb::blocked_range<int>(0,this->mesh->stl.stats.number_of_facets),
-            [&lines, &lines_mutex, &z, throw_on_cancel, this](const tbb::blocked_range<int>& range) {
-                for (int facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
-                    if ((facet_idx & 0x0ffff) == 0)
+            tbb::blocked_range<size_t>(0, num_facets),
+            [&sorted_facets, this](const tbb::blocked_range<size_t>& range) {
+                for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+                    ZSortedFacet    &out   = sorted_facets[facet_idx];
+                    const stl_facet &facet = this->mesh->stl.facet_start[facet_idx];
+                    out.facet     = m_use_quaternion ? facet.rotated(m_quaternion) : facet;
+                    out.min_z     = fminf(out.facet.vertex[0](2), fminf(out.facet.vertex[1](2), out.facet.vertex[2](2)));
+                    out.max_z     = fmaxf(out.facet.vertex[0](2), fmaxf(out.facet.vertex[1](2), out.facet.vertex[2](2)));
+                    out.facet_idx = int(facet_idx);
+                }
+            });
+        sorted_facets.erase(std::remove_if(sorted_facets.begin(), sorted_facets.end(), 
+            [&z](const ZSortedFacet &f) { return f.max_z < z.front() || f.min_z > z.back(); }), sorted_facets.end());
+        tbb::parallel_sort(sorted_facets.begin(), sorted_facets.end(), 
+            [](const ZSortedFacet &f1, const ZSortedFacet &f2) { return f1.min_z < f2.min_z || (f1.min_z == f2.min_z && f1.facet_idx < f2.facet_idx); });
+        throw_on_cancel();
+    }
+    const size_t num_items = sorted ? sorted_facets.size() : num_facets;
+
+    // The facets are split into blocks, each block collects its intersection lines into its own per layer buckets,
+    // thus no locking is needed. The buckets are concatenated in the order of the blocks when building the loops,
+    // so the order of the lines does not depend on the thread scheduling.
+    struct SliceBlock {
+        // Index of the layer of lines.front().
+        size_t                          first_layer { 0 };
+        std::vector<IntersectionLines>  lines;
+        bool contains(size_t layer_idx) const { return layer_idx >= first_layer && layer_idx < first_layer + lines.size(); }
+    };
+    const size_t num_blocks = std::max<size_t>(1, std::min(num_items, size_t(4 * tbb::task_scheduler_init::default_num_threads())));
+    const size_t block_size = (num_items + num_blocks - 1) / num_blocks;
+    std::vector<SliceBlock> blocks(num_blocks);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_blocks, 1),
+        [&blocks, &sorted_facets, sorted, block_size, num_items, &z, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+            for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+                SliceBlock   &block = blocks[block_idx];
+                const size_t  begin = block_idx * block_size;
+                const size_t  end   = std::min(num_items, begin + block_size);
+                if (begin >= end)
+                    continue;
+                if (sorted) {
+                    float max_z = sorted_facets[begin].max_z;
+                    for (size_t i = begin + 1; i < end; ++ i)
+                        max_z = std::max(max_z, sorted_facets[i].max_z);
+                    block.first_layer = std::lower_bound(z.begin(), z.end(), sorted_facets[begin].min_z) - z.begin();
+                    block.lines.assign(std::upper_bound(z.begin() + block.first_layer, z.end(), max_z) - z.begin() - block.first_layer, IntersectionLines());
+                } else
+                    block.lines.assign(z.size(), IntersectionLines());
+                for (size_t i = begin; i < end; ++ i) {
+                    if ((i & 0x0ffff) == 0)
                         throw_on_cancel();
-                    this->_slice_do(facet_idx, &lines, &lines_mutex, z);
+                    if (sorted) {
+                        const ZSortedFacet &f = sorted_facets[i];
+                        this->_slice_do(f.facet, f.facet_idx, f.min_z, f.max_z, &block.lines, block.first_layer, z);
+                    } else
+                        this->_slice_do(i, &block.lines, z);
                 }
             }
-        );
-    }
+        }
+    );
     throw_on_cancel();
+    std::vector<ZSortedFacet>().swap(sorted_facets);
 
     // v_scaled_shared could be freed here
     
     // build loops
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_make_loops_do";
+    std::vector<IntersectionLines> lines(z.size());
     layers->resize(z.size());
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, z.size()),
-        [&lines, &layers, mode, alternate_mode_first_n_layers, alternate_mode, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+        [&blocks, &lines, &layers, mode, alternate_mode_first_n_layers, alternate_mode, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
             for (size_t line_idx = range.begin(); line_idx < range.end(); ++ line_idx) {
                 if ((line_idx & 0x0ffff) == 0)
                     throw_on_cancel();
 
+                // Gather the lines of this layer from all the blocks.
+                IntersectionLines &layer_lines = lines[line_idx];
+                size_t             num_lines   = 0;
+                for (const SliceBlock &block : blocks)
+                    if (block.contains(line_idx))
+                        num_lines += block.lines[line_idx - block.first_layer].size();
+                layer_lines.reserve(num_lines);
+                for (SliceBlock &block : blocks)
+                    if (block.contains(line_idx)) {
+                        IntersectionLines &block_lines = block.lines[line_idx - block.first_layer];
+                        append(layer_lines, std::move(block_lines));
+                        IntersectionLines().swap(block_lines);
+                    }
+
                 Polygons &polygons = (*layers)[line_idx];
                 this->make_loops(lines[line_idx], &polygons);
 
@@ -906,15 +1161,19 @@ void TriangleMeshSlicer::slice(
 #endif
 }
 
-void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, 
-    const std::vector<float> &z) const
+void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z) const
 {
     const stl_facet &facet = m_use_quaternion ? (this->mesh->stl.facet_start.data() + facet_idx)->rotated(m_quaternion) : *(this->mesh->stl.facet_start.data() + facet_idx);
     
     // find facet extents
     const float min_z = fminf(facet.vertex[0](2), fminf(facet.vertex[1](2), facet.vertex[2](2)));
     const float max_z = fmaxf(facet.vertex[0](2), fmaxf(facet.vertex[1](2), facet.vertex[2](2)));
-    
+    this->_slice_do(facet, int(facet_idx), min_z, max_z, lines, 0, z);
+}
+
+void TriangleMeshSlicer::_slice_do(const stl_facet &facet, int facet_idx, float min_z, float max_z, 
+    std::vector<IntersectionLines>* lines, size_t first_layer, const std::vector<float> &z) const
+{
     #ifdef SLIC3R_TRIANGLEMESH_DEBUG
     printf("\n==> FACET %d (%f,%f,%f - %f,%f,%f - %f,%f,%f):\n", facet_idx,
         facet.vertex[0](0), facet.vertex[0](1), facet.vertex[0](2),
@@ -935,11 +1194,10 @@ void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLin
         std::vector<float>::size_type layer_idx = it - z.begin();
         IntersectionLine il;
         if (this->slice_facet(*it / SCALING_FACTOR, facet, facet_idx, min_z, max_z, &il) == TriangleMeshSlicer::Slicing) {
-            boost::lock_guard<boost::mutex> l(*lines_mutex);
             if (il.edge_type == feHorizontal) {
                 // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
             } else
-                (*lines)[layer_idx].emplace_back(il);
+                (*lines)[layer_idx - first_layer].emplace_back(il);
         }
     }
 }
@@ -976,6 +1234,55 @@ void TriangleMeshSlicer::slice(
 	BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::make_expolygons in parallel - end";
 }
 
+void TriangleMeshSlicer::slice_sweep(float z, SlicingMode mode, ExPolygons* slices) const
+{
+    const size_t num_facets = size_t(this->mesh->stl.stats.number_of_facets);
+    if (m_sweep_facets.size() != num_facets) {
+        BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::slice_sweep - sorting facets";
+        m_sweep_facets.assign(num_facets, SweepFacet());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, num_facets),
+            [this](const tbb::blocked_range<size_t>& range) {
+                for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+                    SweepFacet      &out   = m_sweep_facets[facet_idx];
+                    const stl_facet &facet = this->mesh->stl.facet_start[facet_idx];
+                    const stl_facet  f     = m_use_quaternion ? facet.rotated(m_quaternion) : facet;
+                    out.min_z     = fminf(f.vertex[0](2), fminf(f.vertex[1](2), f.vertex[2](2)));
+                    out.max_z     = fmaxf(f.vertex[0](2), fmaxf(f.vertex[1](2), f.vertex[2](2)));
+                    out.facet_idx = int(facet_idx);
+                }
+            });
+        tbb::parallel_sort(m_sweep_facets.begin(), m_sweep_facets.end(), 
+            [](const SweepFacet &f1, const SweepFacet &f2) { return f1.min_z < f2.min_z || (f1.min_z == f2.min_z && f1.facet_idx < f2.facet_idx); });
+        m_sweep_max_height = 0.f;
+        for (const SweepFacet &f : m_sweep_facets)
+            m_sweep_max_height = std::max(m_sweep_max_height, f.max_z - f.min_z);
+    }
+
+    // Only the facets starting in <z - m_sweep_max_height, z> may cross the plane.
+    const std::vector<float>       zs { z };
+    std::vector<IntersectionLines> lines(1);
+    auto it_begin = std::lower_bound(m_sweep_facets.begin(), m_sweep_facets.end(), z - m_sweep_max_height, 
+        [](const SweepFacet &f, float z) { return f.min_z < z; });
+    auto it_end   = std::upper_bound(it_begin, m_sweep_facets.end(), z, 
+        [](float z, const SweepFacet &f) { return z < f.min_z; });
+    for (auto it = it_begin; it != it_end; ++ it)
+        if (it->max_z >= z) {
+            const stl_facet &facet = this->mesh->stl.facet_start[it->facet_idx];
+            this->_slice_do(m_use_quaternion ? facet.rotated(m_quaternion) : facet, it->facet_idx, it->min_z, it->max_z, &lines, 0, zs);
+        }
+
+    Polygons loops;
+    this->make_loops(lines.front(), &loops);
+    if (mode == SlicingMode::Positive || mode == SlicingMode::PositiveLargestContour)
+        for (Polygon &p : loops)
+            p.make_counter_clockwise();
+    slices->clear();
+    this->make_expolygons(loops, slices);
+    if (mode == SlicingMode::PositiveLargestContour)
+        keep_largest_contour_only(*slices);
+}
+
 // Return true, if the facet has been sliced and line_out has been filled.
 TriangleMeshSlicer::FacetSliceType TriangleMeshSlicer::slice_facet(
     float slice_z, const stl_facet &facet, const int facet_idx,
@@ -1248,6 +1555,32 @@ static void chain_lines_by_triangle_connectivity(std::vector<IntersectionLine> &
     auto by_vertex_lower = [](const IntersectionLine* il1, const IntersectionLine *il2) { return il1->a_id < il2->a_id; };
     std::sort(by_edge_a_id.begin(), by_edge_a_id.end(), by_edge_lower);
     std::sort(by_a_id.begin(), by_a_id.end(), by_vertex_lower);
+    // Lines are never un-skipped while chaining, thus the runs of skipped lines in the sorted maps may be jumped over.
+    // Without it, a vertex or an edge shared by many lines (noisy or degenerate meshes) is scanned over and over
+    // from the start of its range, which is quadratic in the number of lines sharing it.
+    // jump[i] >= i is the first index at or after i, which is not yet known to point to a skipped line.
+    std::vector<size_t> by_edge_a_id_jump(by_edge_a_id.size());
+    std::vector<size_t> by_a_id_jump(by_a_id.size());
+    std::iota(by_edge_a_id_jump.begin(), by_edge_a_id_jump.end(), 0);
+    std::iota(by_a_id_jump.begin(), by_a_id_jump.end(), 0);
+    auto first_not_skipped = [](const std::vector<IntersectionLine*> &by_id, std::vector<size_t> &jump, size_t idx, size_t idx_end) -> IntersectionLine* {
+        size_t i = idx;
+        while (i < idx_end) {
+            if (jump[i] != i)
+                i = jump[i];
+            else if (by_id[i]->skip())
+                jump[i] = ++ i;
+            else
+                break;
+        }
+        // Path compression.
+        for (size_t j = idx; j < i && j < idx_end;) {
+            size_t next = jump[j];
+            jump[j] = i;
+            j = next;
+        }
+        return i < idx_end ? by_id[i] : nullptr;
+    };
     // Chain the segments with a greedy algorithm, collect the loops and unclosed polylines.
     IntersectionLines::iterator it_line_seed = lines.begin();
     for (;;) {
@@ -1281,11 +1614,7 @@ static void chain_lines_by_triangle_connectivity(std::vector<IntersectionLine> &
                 auto it_begin = std::lower_bound(by_edge_a_id.begin(), by_edge_a_id.end(), &key, by_edge_lower);
                 if (it_begin != by_edge_a_id.end()) {
                     auto it_end = std::upper_bound(it_begin, by_edge_a_id.end(), &key, by_edge_lower);
-                    for (auto it_line = it_begin; it_line != it_end; ++ it_line)
-                        if (! (*it_line)->skip()) {
-                            next_line = *it_line;
-                            break;
-                        }
+                    next_line = first_not_skipped(by_edge_a_id, by_edge_a_id_jump, it_begin - by_edge_a_id.begin(), it_end - by_edge_a_id.begin());
                 }
             }
             if (next_line == nullptr && last_line->b_id != -1) {
@@ -1293,11 +1622,7 @@ static void chain_lines_by_triangle_connectivity(std::vector<IntersectionLine> &
                 auto it_begin = std::lower_bound(by_a_id.begin(), by_a_id.end(), &key, by_vertex_lower);
                 if (it_begin != by_a_id.end()) {
                     auto it_end = std::upper_bound(it_begin, by_a_id.end(), &key, by_vertex_lower);
-                    for (auto it_line = it_begin; it_line != it_end; ++ it_line)
-                        if (! (*it_line)->skip()) {
-                            next_line = *it_line;
-                            break;
-                        }
+                    next_line = first_not_skipped(by_a_id, by_a_id_jump, it_begin - by_a_id.begin(), it_end - by_a_id.begin());
                 }
             }
             if (next_line == nullptr) {
@@ -1948,6 +2273,178 @@ void TriangleMeshSlicer::cut(float z, TriangleMesh* upper, TriangleMesh* lower)
     stl_get_size(&lower->stl);
 }
 
+namespace {
+
+// One part of a mesh being cut, the facets are clipped to the half space of the part.
+struct CutPart
+{
+    const indexed_triangle_set       &mesh;
+    indexed_triangle_set             &its;
+    // +1 for the upper part, -1 for the lower part.
+    int                               sign;
+    float                             z;
+    // Vertices of the part created from the mesh vertices and from the cut edges of the mesh.
+    std::vector<int>                  vertex_map;
+    std::unordered_map<uint64_t, int> edge_map;
+    // Edges of the part on the cutting plane, each reversed to bound the cap.
+    std::unordered_set<uint64_t>      cap_edges;
+
+    CutPart(const indexed_triangle_set &mesh, indexed_triangle_set &its, int sign, float z) :
+        mesh(mesh), its(its), sign(sign), z(z), vertex_map(mesh.vertices.size(), -1) {}
+
+    static uint64_t edge_key(int a, int b) { return (uint64_t(uint32_t(a)) << 32) | uint64_t(uint32_t(b)); }
+
+    int vertex(int v)
+    {
+        int &id = vertex_map[v];
+        if (id == -1) {
+            id = int(its.vertices.size());
+            its.vertices.emplace_back(mesh.vertices[v]);
+        }
+        return id;
+    }
+
+    int edge_vertex(int a, int b)
+    {
+        // Calculated from the lower index, the facets sharing the edge share the vertex.
+        if (a > b)
+            std::swap(a, b);
+        auto it = edge_map.find(edge_key(a, b));
+        if (it != edge_map.end())
+            return it->second;
+        const stl_vertex &pa = mesh.vertices[a];
+        const stl_vertex &pb = mesh.vertices[b];
+        stl_vertex v = pa + (pb - pa) * ((z - pa.z()) / (pb.z() - pa.z()));
+        v.z() = z;
+        int id = int(its.vertices.size());
+        its.vertices.emplace_back(v);
+        edge_map.emplace(edge_key(a, b), id);
+        return id;
+    }
+
+    void add_cap_edge(int a, int b)
+    {
+        // An edge touching the plane from the side of the part is seen twice, once in each direction.
+        if (cap_edges.erase(edge_key(b, a)) == 0)
+            cap_edges.insert(edge_key(a, b));
+    }
+
+    void add_facet(const stl_triangle_vertex_indices &f, const std::vector<int> &side)
+    {
+        // Clip the facet, the vertices on the cutting plane belong to both parts.
+        std::array<int, 4>  pts;
+        std::array<bool, 4> on_plane;
+        int n = 0;
+        for (int i = 0; i < 3; ++ i) {
+            int a = f(i), b = f((i + 1) % 3);
+            if (side[a] * sign >= 0) {
+                pts[n] = this->vertex(a);
+                on_plane[n ++] = side[a] == 0;
+            }
+            if (side[a] * side[b] < 0) {
+                pts[n] = this->edge_vertex(a, b);
+                on_plane[n ++] = true;
+            }
+        }
+        if (n < 3 || std::all_of(on_plane.begin(), on_plane.begin() + n, [](bool b) { return b; }))
+            return;
+        // The clipped facet is convex.
+        for (int i = 1; i + 1 < n; ++ i)
+            its.indices.emplace_back(pts[0], pts[i], pts[i + 1]);
+        for (int i = 0; i < n; ++ i)
+            if (on_plane[i] && on_plane[(i + 1) % n])
+                this->add_cap_edge(pts[(i + 1) % n], pts[i]);
+    }
+
+    // Rounded, so that the unscaled output of the tesselator maps back to the same point.
+    static Point to_point(const Vec2d &pt) { return Point(pt.x() / SCALING_FACTOR, pt.y() / SCALING_FACTOR); }
+
+    bool close_cap()
+    {
+        std::unordered_map<int, int> next;
+        for (uint64_t key : cap_edges)
+            if (! next.emplace(int(key >> 32), int(key & 0xFFFFFFFF)).second)
+                // Non-manifold section.
+                return false;
+
+        ExPolygon section;
+        std::unordered_map<Point, int, PointHash> point_ids;
+        while (! next.empty()) {
+            Polygon loop;
+            int     start = next.begin()->first;
+            for (int v = start;;) {
+                auto it = next.find(v);
+                if (it == next.end()) {
+                    if (v != start)
+                        // Open section.
+                        return false;
+                    break;
+                }
+                Point pt = to_point(its.vertices[v].head<2>().cast<double>());
+                if (! point_ids.emplace(pt, v).second)
+                    return false;
+                loop.points.emplace_back(pt);
+                v = it->second;
+                next.erase(it);
+            }
+            if (loop.points.size() < 3)
+                return false;
+            // The winding is resolved by the odd rule of the tesselator, there is no need to sort out the holes.
+            if (section.contour.points.empty())
+                section.contour = std::move(loop);
+            else
+                section.holes.emplace_back(std::move(loop));
+        }
+        if (section.contour.points.empty())
+            return true;
+
+        std::vector<Vec2d> triangles = triangulate_expolygon_2d(section);
+        std::vector<int>   ids(triangles.size());
+        for (size_t i = 0; i < triangles.size(); ++ i) {
+            auto it = point_ids.find(to_point(triangles[i]));
+            if (it == point_ids.end())
+                // The tesselator introduced a vertex of a self intersection.
+                return false;
+            ids[i] = it->second;
+        }
+        for (size_t i = 0; i < ids.size(); i += 3) {
+            const stl_vertex &a = its.vertices[ids[i]];
+            const stl_vertex &b = its.vertices[ids[i + 1]];
+            const stl_vertex &c = its.vertices[ids[i + 2]];
+            // The cap of the lower part faces up, the cap of the upper part faces down.
+            float cross = (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+            if (cross * float(sign) > 0.f)
+                its.indices.emplace_back(ids[i], ids[i + 2], ids[i + 1]);
+            else
+                its.indices.emplace_back(ids[i], ids[i + 1], ids[i + 2]);
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool cut_mesh(const indexed_triangle_set &mesh, float z, indexed_triangle_set *upper, indexed_triangle_set *lower)
+{
+    std::vector<int> side(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); ++ i)
+        side[i] = mesh.vertices[i].z() > z ? 1 : mesh.vertices[i].z() < z ? -1 : 0;
+
+    std::vector<CutPart> parts;
+    if (upper != nullptr)
+        parts.emplace_back(mesh, *upper, 1, z);
+    if (lower != nullptr)
+        parts.emplace_back(mesh, *lower, -1, z);
+    for (CutPart &part : parts) {
+        part.its.clear();
+        for (const stl_triangle_vertex_indices &f : mesh.indices)
+            part.add_facet(f, side);
+        if (! part.close_cap())
+            return false;
+    }
+    return true;
+}
+
 Pointf3s TriangleMesh::vertices()
 {
     Pointf3s tmp{};
@@ -203,6 +203,10 @@ public:
     };
     FacetSliceType slice_facet(float slice_z, const stl_facet &facet, const int facet_idx,
         const float min_z, const float max_z, IntersectionLine *line_out) const;
+    // Slices the mesh with a single plane at height z along the up direction, to be called repeatedly for a moving plane
+    // (interactive clipping planes). The facets are sorted by their minimum height on the first call and the order is kept
+    // until the up direction changes, so that each call only visits the facets in the window of heights around z.
+    void slice_sweep(float z, SlicingMode mode, ExPolygons* slices) const;
     void cut(float z, TriangleMesh* upper, TriangleMesh* lower) const;
     void set_up_direction(const Vec3f& up);
     
@@ -217,13 +221,32 @@ private:
     // Whether or not the above quaterion should be used
     bool                     m_use_quaternion = false;
 
-    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, const std::vector<float> &z) const;
+    struct SweepFacet {
+        float   min_z;
+        float   max_z;
+        int     facet_idx;
+    };
+    // Facets sorted by their minimum Z after rotation by m_quaternion, cached by slice_sweep().
+    mutable std::vector<SweepFacet> m_sweep_facets;
+    // Maximum extent of a facet in Z, bounding the window of m_sweep_facets crossing a plane.
+    mutable float            m_sweep_max_height = 0.f;
+
+    // Appends the intersection lines of a single facet to the per layer buckets of lines.
+    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z) const;
+    // Same as above for an already rotated facet with known Z extents, lines.front() being the bucket of layer first_layer.
+    void _slice_do(const stl_facet &facet, int facet_idx, float min_z, float max_z, std::vector<IntersectionLines>* lines, size_t first_layer, const std::vector<float> &z) const;
     void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops) const;
     void make_expolygons(const Polygons &loops, ExPolygons* slices) const;
     void make_expolygons_simple(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
     void make_expolygons(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
 };
 
+// Cuts the mesh with shared vertices at the plane z, the parts are closed with a cap.
+// Only the facets crossing the plane are split, the vertices created on the cut edges are shared
+// by the facets of a part and its cap, therefore the parts do not need to be stitched by repair().
+// Returns false if the section is not made of simple closed loops, the slicer has to be used then.
+bool cut_mesh(const indexed_triangle_set &mesh, float z, indexed_triangle_set *upper, indexed_triangle_set *lower);
+
 inline void slice_mesh(
     const TriangleMesh &                              mesh,
     const std::vector<float> &                        z,
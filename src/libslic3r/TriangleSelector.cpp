@@ -1,6 +1,9 @@
 #include "TriangleSelector.hpp"
 #include "Model.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 
 namespace Slic3r {
 
@@ -52,14 +55,34 @@ void TriangleSelector::select_patch(const Vec3f& hit, int facet_start,
         m_old_cursor_radius_sqr = m_cursor.radius_sqr;
     }
 
+    if (m_aabb_tree.empty())
+        m_aabb_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(m_mesh->its.vertices, m_mesh->its.indices);
+    if (int(m_patch_flags.size()) != m_orig_size_indices)
+        m_patch_flags.assign(m_orig_size_indices, 0);
+
+    // Collect the original facets which may touch the cursor and test them against
+    // the cursor in parallel. The facets not touching it are never selected.
+    enum : uint8_t { Touching = 1, Visited = 2 };
+    std::vector<size_t> candidates;
+    AABBTreeIndirect::get_candidate_idxs_if(m_aabb_tree,
+        [this](const AABBTreeIndirect::Tree3f::BoundingBox& box) { return m_cursor.may_touch_box(box); },
+        candidates);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, candidates.size(), 256), [this, &candidates](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            int facet = int(candidates[i]);
+            if (m_triangles[facet].valid && (vertices_inside(facet) > 0 || is_pointer_in_triangle(facet) || is_edge_inside_cursor(facet)))
+                m_patch_flags[facet] = Touching;
+        }
+    });
+
     // Now start with the facet the pointer points to and check all adjacent facets.
     std::vector<int> facets_to_check{facet_start};
-    std::vector<bool> visited(m_orig_size_indices, false); // keep track of facets we already processed
     int facet_idx = 0; // index into facets_to_check
     while (facet_idx < int(facets_to_check.size())) {
         int facet = facets_to_check[facet_idx];
-        if (! visited[facet]) {
-            if (select_triangle(facet, new_state)) {
+        if (! (m_patch_flags[facet] & Visited)) {
+            if ((m_patch_flags[facet] & Touching) && select_triangle(facet, new_state)) {
+                set_facet_dirty(facet);
                 // add neighboring facets to list to be proccessed later
                 for (int n=0; n<3; ++n) {
                     int neighbor_idx = m_mesh->stl.neighbors_start[facet].neighbor[n];
@@ -68,9 +91,15 @@ void TriangleSelector::select_patch(const Vec3f& hit, int facet_start,
                 }
             }
         }
-        visited[facet] = true;
+        m_patch_flags[facet] |= Visited; // keep track of facets we already processed
         ++facet_idx;
     }
+
+    // Clear the flags for the next call.
+    for (size_t facet : candidates)
+        m_patch_flags[facet] = 0;
+    for (int facet : facets_to_check)
+        m_patch_flags[facet] = 0;
 }
 
 
@@ -148,6 +177,17 @@ void TriangleSelector::set_facet(int facet_idx, EnforcerBlockerType state)
     undivide_triangle(facet_idx);
     assert(! m_triangles[facet_idx].is_split());
     m_triangles[facet_idx].set_state(state);
+    set_facet_dirty(facet_idx);
+}
+
+void TriangleSelector::set_facet_dirty(int facet_idx)
+{
+    assert(facet_idx < m_orig_size_indices);
+    if (! m_facet_dirty[facet_idx]) {
+        m_facet_dirty[facet_idx] = true;
+        m_dirty_facets.emplace_back(facet_idx);
+    }
+    on_facet_changed(facet_idx);
 }
 
 void TriangleSelector::split_triangle(int facet_idx)
@@ -430,6 +470,10 @@ void TriangleSelector::reset()
     m_orig_size_vertices = m_vertices.size();
     m_orig_size_indices = m_triangles.size();
     m_invalid_triangles = 0;
+    m_serialized.clear();
+    m_dirty_facets.clear();
+    m_facet_dirty.assign(m_orig_size_indices, false);
+    on_reset();
 }
 
 
@@ -543,7 +587,7 @@ indexed_triangle_set TriangleSelector::get_facets(EnforcerBlockerType state) con
 
 
 
-std::map<int, std::vector<bool>> TriangleSelector::serialize() const
+const std::map<int, std::vector<bool>>& TriangleSelector::serialize() const
 {
     // Each original triangle of the mesh is assigned a number encoding its state
     // or how it is split. Each triangle is encoded by 4 bits (xxyy):
@@ -554,12 +598,15 @@ std::map<int, std::vector<bool>> TriangleSelector::serialize() const
     // The function returns a map from original triangle indices to
     // stream of bits encoding state and offsprings.
 
-    std::map<int, std::vector<bool>> out;
-    for (int i=0; i<m_orig_size_indices; ++i) {
+    // The encoding of the triangles not modified since the last call is reused.
+    for (int i : m_dirty_facets) {
+        m_facet_dirty[i] = false;
         const Triangle& tr = m_triangles[i];
 
-        if (! tr.is_split() && tr.get_state() == EnforcerBlockerType::NONE)
+        if (! tr.is_split() && tr.get_state() == EnforcerBlockerType::NONE) {
+            m_serialized.erase(i);
             continue; // no need to save anything, unsplit and unselected is default
+        }
 
         std::vector<bool> data; // complete encoding of this mesh triangle
         int stored_triangles = 0; // how many have been already encoded
@@ -598,10 +645,11 @@ std::map<int, std::vector<bool>> TriangleSelector::serialize() const
         };
 
         serialize_recursive(i);
-        out[i] = data;
+        m_serialized[i] = std::move(data);
     }
+    m_dirty_facets.clear();
 
-    return out;
+    return m_serialized;
 }
 
 void TriangleSelector::deserialize(const std::map<int, std::vector<bool>> data)
@@ -610,6 +658,7 @@ void TriangleSelector::deserialize(const std::map<int, std::vector<bool>> data)
     for (const auto& [triangle_id, code] : data) {
         assert(triangle_id < int(m_triangles.size()));
         assert(! code.empty());
+        set_facet_dirty(triangle_id);
         int processed_triangles = 0;
         struct ProcessingInfo {
             int facet_id = 0;
@@ -736,6 +785,25 @@ bool TriangleSelector::Cursor::is_mesh_point_inside(Vec3f point) const
 
 
 
+bool TriangleSelector::Cursor::may_touch_box(const AABBTreeIndirect::Tree3f::BoundingBox& box) const
+{
+    Vec3f c = box.center();
+    float r = 0.5f * box.diagonal().norm();
+    if (! uniform_scaling) {
+        // The Frobenius norm bounds the stretch of the transformation.
+        c = trafo * c;
+        r *= trafo.linear().norm();
+    }
+    // The cylinder around the cursor axis encloses both types of cursors. The pointer and edge
+    // tests of TriangleSelector::select_triangle() are done against the cylinder as well.
+    Vec3f diff = center - c;
+    diff -= diff.dot(dir) * dir;
+    float d = std::sqrt(radius_sqr) + r;
+    return diff.squaredNorm() <= d * d;
+}
+
+
+
 // p1, p2, p3 are in mesh coords!
 bool TriangleSelector::Cursor::is_pointer_in_triangle(const Vec3f& p1_,
                                                       const Vec3f& p2_,
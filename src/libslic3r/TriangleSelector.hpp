@@ -6,6 +6,7 @@
 
 #include "Point.hpp"
 #include "TriangleMesh.hpp"
+#include "AABBTreeIndirect.hpp"
 
 namespace Slic3r {
 
@@ -27,6 +28,7 @@ public:
     // Create new object on a TriangleMesh. The referenced mesh must
     // stay valid, a ptr to it is saved and used.
     explicit TriangleSelector(const TriangleMesh& mesh);
+    virtual ~TriangleSelector() = default;
 
     // Select all triangles fully inside the circle, subdivide where needed.
     void select_patch(const Vec3f& hit,    // point where to start
@@ -50,8 +52,9 @@ public:
     void garbage_collect();
 
     // Store the division trees in compact form (a long stream of
-    // bits for each triangle of the original mesh).
-    std::map<int, std::vector<bool>> serialize() const;
+    // bits for each triangle of the original mesh). Only the trees
+    // of the triangles modified since the last call are encoded again.
+    const std::map<int, std::vector<bool>>& serialize() const;
 
     // Load serialized data. Assumes that correct mesh is loaded.
     void deserialize(const std::map<int, std::vector<bool>> data);
@@ -127,6 +130,17 @@ protected:
     int m_orig_size_vertices = 0;
     int m_orig_size_indices = 0;
 
+    // Encoded division trees of the original triangles, see serialize().
+    mutable std::map<int, std::vector<bool>> m_serialized;
+    // Original triangles modified since the last serialization.
+    mutable std::vector<int> m_dirty_facets;
+    mutable std::vector<bool> m_facet_dirty;
+
+    // Called whenever the division tree or the state of an original triangle
+    // is modified. Also when all of them are reset before deserialization.
+    virtual void on_facet_changed(int /* facet_idx */) {}
+    virtual void on_reset() {}
+
     // Cache for cursor position, radius and direction.
     struct Cursor {
         Cursor() = default;
@@ -134,6 +148,8 @@ protected:
                CursorType type_, const Transform3d& trafo_);
         bool is_mesh_point_inside(Vec3f pt) const;
         bool is_pointer_in_triangle(const Vec3f& p1, const Vec3f& p2, const Vec3f& p3) const;
+        // Conservative test whether a box in mesh coords may touch the cursor.
+        bool may_touch_box(const AABBTreeIndirect::Tree3f::BoundingBox& box) const;
 
         Vec3f center;
         Vec3f source;
@@ -148,6 +164,13 @@ protected:
     Cursor m_cursor;
     float m_old_cursor_radius_sqr;
 
+    // AABB tree over the original triangles, built on the first select_patch().
+    AABBTreeIndirect::Tree3f m_aabb_tree;
+    // Per original triangle state of the current select_patch(): bit 0 is set
+    // for the triangles touching the cursor, bit 1 for the visited triangles.
+    // Kept allocated and cleared after each call.
+    std::vector<uint8_t> m_patch_flags;
+
     // Private functions:
     bool select_triangle(int facet_idx, EnforcerBlockerType type,
                          bool recursive_call = false);
@@ -159,6 +182,7 @@ protected:
     bool is_pointer_in_triangle(int facet_idx) const;
     bool is_edge_inside_cursor(int facet_idx) const;
     void push_triangle(int a, int b, int c);
+    void set_facet_dirty(int facet_idx);
     void perform_split(int facet_idx, EnforcerBlockerType old_state);
 };
 
@@ -6,6 +6,8 @@
 #endif /* NDEBUG */
 #include <cmath>
 
+#include <tbb/parallel_for.h>
+
 // #define VORONOI_DEBUG_OUT
 
 #ifdef VORONOI_DEBUG_OUT
@@ -196,13 +198,24 @@ namespace detail {
         return out;
     }
 
+    enum class EdgeState : unsigned char {
+        // Initial state, don't know.
+        Unknown,
+        // This edge will certainly not be intersected by the offset curve.
+        Inactive,
+        // This edge will certainly be intersected by the offset curve.
+        Active,
+        // This edge will possibly be intersected by the offset curve.
+        Possible
+    };
 } // namespace detail
 
-Polygons voronoi_offset(
-    const VoronoiDiagram  &vd,
-    const Lines                     &lines,
-    double                           offset_distance,
-    double                           discretization_error)
+using detail::EdgeState;
+
+// Classify the Voronoi edges into those, which will certainly not be intersected by an offset curve
+// and those, which possibly will. The classification only depends on the side of the offset, not on the offset distance,
+// thus it is shared by all the offset curves extracted from the same Voronoi diagram.
+static std::vector<EdgeState> voronoi_offset_classify_edges(const VoronoiDiagram &vd, const Lines &lines, bool outside)
 {
 #ifndef NDEBUG
     // Verify that twin halfedges are stored next to the other in vd.
@@ -225,17 +238,6 @@ Polygons voronoi_offset(
     }
 #endif // NDEBUG
 
-    enum class EdgeState : unsigned char {
-        // Initial state, don't know.
-        Unknown,
-        // This edge will certainly not be intersected by the offset curve.
-        Inactive,
-        // This edge will certainly be intersected by the offset curve.
-        Active,
-        // This edge will possibly be intersected by the offset curve.
-        Possible
-    };
-
     enum class CellState : unsigned char {
         // Initial state, don't know.
         Unknown,
@@ -249,7 +251,6 @@ Polygons voronoi_offset(
 
     // Mark edges with outward vertex pointing outside the polygons, thus there is a chance
     // that such an edge will have an intersection with our desired offset curve.
-    bool                    outside = offset_distance > 0.;
     std::vector<EdgeState>  edge_state(vd.num_edges(), EdgeState::Unknown);
     std::vector<CellState>  cell_state(vd.num_cells(), CellState::Unknown);
     const VD::edge_type    *front_edge = &vd.edges().front();
@@ -260,12 +261,6 @@ Polygons voronoi_offset(
         assert(new_edge_type == EdgeState::Possible || new_edge_type == EdgeState::Inactive);
         edge_type = new_edge_type;
     };
-    auto                    set_edge_state_final = [&edge_state, front_edge](const size_t edge_id, EdgeState new_edge_type) {
-        EdgeState &edge_type = edge_state[edge_id];
-        assert(edge_type == EdgeState::Possible || edge_type == new_edge_type);
-        assert(new_edge_type == EdgeState::Active || new_edge_type == EdgeState::Inactive);
-        edge_type = new_edge_type;
-    };
     auto                    set_cell_state = [&cell_state, front_cell](const VD::cell_type *cell, CellState new_cell_type) -> bool {
         CellState &cell_type = cell_state[cell - front_cell];
         assert(cell_type == CellState::Active || cell_type == CellState::Inactive || cell_type == CellState::Boundary || cell_type == CellState::Unknown);
@@ -429,8 +424,26 @@ Polygons voronoi_offset(
         }
     }
 
-    if (! outside)
-        offset_distance = - offset_distance;
+    return edge_state;
+}
+
+// Extract a single offset curve at a positive offset_distance from edge_state classified by voronoi_offset_classify_edges().
+static Polygons voronoi_offset_classified(
+    const VoronoiDiagram            &vd,
+    const Lines                     &lines,
+    std::vector<EdgeState>           edge_state,
+    double                           offset_distance,
+    double                           discretization_error)
+{
+    assert(offset_distance > 0.);
+    const VD::edge_type    *front_edge = &vd.edges().front();
+    auto                    set_edge_state_final = [&edge_state](const size_t edge_id, EdgeState new_edge_type) {
+        EdgeState &edge_type = edge_state[edge_id];
+        assert(edge_type == EdgeState::Possible || edge_type == new_edge_type);
+        assert(new_edge_type == EdgeState::Active || new_edge_type == EdgeState::Inactive);
+        edge_type = new_edge_type;
+    };
+
 
 #ifdef VORONOI_DEBUG_OUT
     BoundingBox bbox;
@@ -854,4 +867,42 @@ Polygons voronoi_offset(
 	return out;
 }
 
+Polygons voronoi_offset(
+    const VoronoiDiagram  &vd,
+    const Lines                     &lines,
+    double                           offset_distance,
+    double                           discretization_error)
+{
+    bool outside = offset_distance > 0.;
+    return voronoi_offset_classified(vd, lines, voronoi_offset_classify_edges(vd, lines, outside), std::abs(offset_distance), discretization_error);
+}
+
+std::vector<Polygons> voronoi_offset(
+    const VoronoiDiagram            &vd,
+    const Lines                     &lines,
+    const std::vector<double>       &offset_distances,
+    double                           discretization_error)
+{
+    std::vector<Polygons> out(offset_distances.size());
+    // Classify the edges once for the outer and once for the inner offset curves.
+    std::vector<EdgeState> edge_state_outside;
+    std::vector<EdgeState> edge_state_inside;
+    for (double d : offset_distances) {
+        if (d > 0. && edge_state_outside.empty())
+            edge_state_outside = voronoi_offset_classify_edges(vd, lines, true);
+        else if (d < 0. && edge_state_inside.empty())
+            edge_state_inside = voronoi_offset_classify_edges(vd, lines, false);
+    }
+    // The offset curves only read the classification and the diagram, extract them in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, offset_distances.size()),
+        [&vd, &lines, &offset_distances, discretization_error, &edge_state_outside, &edge_state_inside, &out](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            double d = offset_distances[i];
+            if (d != 0.)
+                out[i] = voronoi_offset_classified(vd, lines, d > 0. ? edge_state_outside : edge_state_inside, std::abs(d), discretization_error);
+        }
+    });
+    return out;
+}
+
 } // namespace Slic3r
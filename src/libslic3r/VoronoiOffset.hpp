@@ -36,6 +36,15 @@ Polygons voronoi_offset(
 	double 							 offset_distance, 
 	double 							 discretization_error);
 
+// Extract multiple offset curves from a single Voronoi diagram, one for each of offset_distances.
+// The classification of the Voronoi edges is shared by all offset curves of the same sign,
+// the offset curves are then extracted in parallel.
+std::vector<Polygons> voronoi_offset(
+	const VoronoiDiagram 			&vd,
+	const Lines 					&lines,
+	const std::vector<double> 		&offset_distances,
+	double 							 discretization_error);
+
 } // namespace Slic3r
 
 #endif // slic3r_VoronoiOffset_hpp_
@@ -27,6 +27,8 @@
         #include <sys/stat.h>
         #include <fcntl.h>
         #include <sys/sendfile.h>
+        #include <sys/ioctl.h>
+        #include <linux/fs.h>
     #endif
 #endif
 
@@ -550,6 +552,14 @@ bool copy_file_linux(const boost::filesystem::path &from, const boost::filesyste
 		goto fail;
 	}
 
+#ifdef FICLONE
+	// The exported G-code is mostly copied from the temp directory to the same filesystem. If the filesystem supports it
+	// (Btrfs, XFS), share the data blocks copy-on-write instead of writing the whole file a second time.
+	// The ioctl fails with EXDEV when crossing filesystems and with EOPNOTSUPP / EINVAL when not supported.
+	if (::ioctl(outfile.fd, FICLONE, infile.fd) == 0) {
+		BOOST_LOG_TRIVIAL(debug) << "copy_file_linux() cloned \"" << from.string() << "\" to \"" << to.string() << "\"";
+	} else
+#endif // FICLONE
 	//! copy_file implementation that uses sendfile loop. Requires sendfile to support file descriptors.
 	//FIXME Vojtech: This is a copy loop valid for Linux 2.6.33 and newer.
 	// copy_file_data_copy_file_range() supports cross-filesystem copying since 5.3, but Vojtech did not want to polute this
@@ -953,15 +963,8 @@ std::string log_memory_info(bool ignore_loglevel)
     #endif
         // Now get peak memory usage.
         out += "; Peak memory usage: ";
-        rusage memory_info;
-        if (getrusage(RUSAGE_SELF, &memory_info) == 0)
-        {
-            size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
-            #ifdef __linux__
-                peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
-            #endif
+        if (size_t peak_mem_usage = peak_memory_usage(); peak_mem_usage > 0)
             out += format_memsize_MB(peak_mem_usage);
-        }
         else
             out += "N/A";
 #endif
@@ -969,6 +972,32 @@ std::string log_memory_info(bool ignore_loglevel)
     return out;
 }
 
+size_t peak_memory_usage()
+{
+#ifdef WIN32
+    size_t peak = 0;
+    HANDLE hProcess = ::OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, ::GetCurrentProcessId());
+    if (hProcess != nullptr) {
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (GetProcessMemoryInfo(hProcess, &pmc, sizeof(pmc)))
+            peak = (size_t)pmc.PeakWorkingSetSize;
+        CloseHandle(hProcess);
+    }
+    return peak;
+#elif defined(__linux__) or defined(__APPLE__)
+    rusage memory_info;
+    if (getrusage(RUSAGE_SELF, &memory_info) != 0)
+        return 0;
+    size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
+    #ifdef __linux__
+        peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
+    #endif
+    return peak_mem_usage;
+#else
+    return 0;
+#endif
+}
+
 // Returns the size of physical memory (RAM) in bytes.
 // http://nadeausoftware.com/articles/2012/09/c_c_tip_how_get_physical_memory_size_system
 size_t total_physical_memory()
@@ -29,6 +29,10 @@
 #include <string.h>
 #include <assert.h>
 
+#include <unordered_map>
+
+#include <tbb/parallel_for.h>
+
 #include <boost/log/trivial.hpp>
 
 #include <boost/filesystem/operations.hpp>
@@ -125,6 +129,57 @@ static void smooth_normals_vertex(TriangleMesh& mesh, std::vector<stl_normal>& n
 }
 #endif // ENABLE_SMOOTH_NORMALS
 
+namespace {
+struct CompactVertexHash
+{
+    size_t operator()(const GLIndexedVertexArray::CompactVertex &v) const {
+        uint64_t pos = (uint64_t(uint16_t(v.position[0])) << 32) | (uint64_t(uint16_t(v.position[1])) << 16) | uint64_t(uint16_t(v.position[2]));
+        uint32_t nrm = (uint32_t(uint8_t(v.normal[0])) << 16) | (uint32_t(uint8_t(v.normal[1])) << 8) | uint32_t(uint8_t(v.normal[2]));
+        return std::hash<uint64_t>()(pos ^ (uint64_t(nrm) << 40) ^ (uint64_t(nrm) >> 24));
+    }
+};
+
+// Quantizes the vertices of a mesh relative to its bounding box and merges the equal ones.
+class CompactVertexBuilder
+{
+public:
+    CompactVertexBuilder(GLIndexedVertexArray &array, const BoundingBoxf3 &bbox, size_t num_corners) : m_array(array)
+    {
+        // The same scale along all the axes, so that the normals are not skewed by gl_NormalMatrix.
+        const double max_size = bbox.size().maxCoeff();
+        m_center = bbox.center().cast<float>();
+        m_scale  = max_size > 0. ? float(0.5 * max_size / 32767.) : 1.f;
+        m_map.reserve(num_corners);
+        m_array.compact_vertices.reserve(num_corners);
+    }
+
+    Transform3d dequantization() const
+        { return Geometry::assemble_transform(m_center.cast<double>(), Vec3d::Zero(), Vec3d(m_scale, m_scale, m_scale)); }
+
+    int push(const Vec3f &position, const Vec3f &normal)
+    {
+        GLIndexedVertexArray::CompactVertex v;
+        Vec3f n = normal.normalized();
+        for (int i = 0; i < 3; ++ i) {
+            v.position[i] = int16_t(std::clamp<long>(std::lround((position(i) - m_center(i)) / m_scale), -32767, 32767));
+            v.normal[i]   = std::isfinite(n(i)) ? int8_t(std::clamp<long>(std::lround(n(i) * 127.f), -127, 127)) : 0;
+        }
+        v.position[3] = 0;
+        v.normal[3]   = 0;
+        auto it = m_map.emplace(v, int(m_array.compact_vertices.size()));
+        if (it.second)
+            m_array.compact_vertices.emplace_back(v);
+        return it.first->second;
+    }
+
+private:
+    GLIndexedVertexArray                                                &m_array;
+    Vec3f                                                                m_center;
+    float                                                                m_scale;
+    std::unordered_map<GLIndexedVertexArray::CompactVertex, int, CompactVertexHash> m_map;
+};
+} // namespace
+
 #if ENABLE_SMOOTH_NORMALS
 void GLIndexedVertexArray::load_mesh_full_shading(const TriangleMesh& mesh, bool smooth_normals)
 #else
@@ -134,7 +189,10 @@ void GLIndexedVertexArray::load_mesh_full_shading(const TriangleMesh& mesh)
     assert(triangle_indices.empty() && vertices_and_normals_interleaved_size == 0);
     assert(quad_indices.empty() && triangle_indices_size == 0);
     assert(vertices_and_normals_interleaved.size() % 6 == 0 && quad_indices_size == vertices_and_normals_interleaved.size());
+    assert(compact_vertices.empty());
 
+    m_compact = true;
+    m_bounding_box = mesh.bounding_box();
 #if ENABLE_SMOOTH_NORMALS
     if (smooth_normals) {
         TriangleMesh new_mesh(mesh);
@@ -142,36 +200,53 @@ void GLIndexedVertexArray::load_mesh_full_shading(const TriangleMesh& mesh)
         smooth_normals_corner(new_mesh, normals);
 //        smooth_normals_vertex(new_mesh, normals);
 
-        this->vertices_and_normals_interleaved.reserve(this->vertices_and_normals_interleaved.size() + 3 * 2 * new_mesh.its.vertices.size());
-        for (size_t i = 0; i < new_mesh.its.vertices.size(); ++i) {
-            const stl_vertex& v = new_mesh.its.vertices[i];
-            const stl_normal& n = normals[i];
-            this->push_geometry(v(0), v(1), v(2), n(0), n(1), n(2));
-        }
+        CompactVertexBuilder builder(*this, m_bounding_box, new_mesh.its.vertices.size());
+        std::vector<int> map_vertices(new_mesh.its.vertices.size());
+        for (size_t i = 0; i < new_mesh.its.vertices.size(); ++i)
+            map_vertices[i] = builder.push(new_mesh.its.vertices[i], normals[i]);
 
+        this->triangle_indices.reserve(3 * new_mesh.its.indices.size());
         for (size_t i = 0; i < new_mesh.its.indices.size(); ++i) {
             const stl_triangle_vertex_indices& idx = new_mesh.its.indices[i];
-            this->push_triangle(idx(0), idx(1), idx(2));
+            this->push_triangle(map_vertices[idx(0)], map_vertices[idx(1)], map_vertices[idx(2)]);
         }
+        m_dequantization = builder.dequantization();
     }
     else {
 #endif // ENABLE_SMOOTH_NORMALS
-    this->vertices_and_normals_interleaved.reserve(this->vertices_and_normals_interleaved.size() + 3 * 3 * 2 * mesh.facets_count());
-
-    unsigned int vertices_count = 0;
+    // Flat shading: the vertices are shared by the triangles of the same normal only.
+    CompactVertexBuilder builder(*this, m_bounding_box, 3 * mesh.facets_count());
+    this->triangle_indices.reserve(3 * mesh.facets_count());
     for (int i = 0; i < (int)mesh.stl.stats.number_of_facets; ++i) {
-            const stl_facet& facet = mesh.stl.facet_start[i];
+        const stl_facet& facet = mesh.stl.facet_start[i];
+        int idx[3];
         for (int j = 0; j < 3; ++j)
-            this->push_geometry(facet.vertex[j](0), facet.vertex[j](1), facet.vertex[j](2), facet.normal(0), facet.normal(1), facet.normal(2));
-
-        this->push_triangle(vertices_count, vertices_count + 1, vertices_count + 2);
-        vertices_count += 3;
+            idx[j] = builder.push(facet.vertex[j], facet.normal);
+        this->push_triangle(idx[0], idx[1], idx[2]);
     }
+    m_dequantization = builder.dequantization();
 #if ENABLE_SMOOTH_NORMALS
     }
 #endif // ENABLE_SMOOTH_NORMALS
+    this->vertices_and_normals_interleaved_size = this->compact_vertices.size();
 }
 
+struct GLIndexedVertexArray::VBOs
+{
+    unsigned int vertices_and_normals_interleaved_id{ 0 };
+    unsigned int triangle_indices_id{ 0 };
+    unsigned int quad_indices_id{ 0 };
+
+    ~VBOs() {
+        if (vertices_and_normals_interleaved_id)
+            glsafe(::glDeleteBuffers(1, &vertices_and_normals_interleaved_id));
+        if (triangle_indices_id)
+            glsafe(::glDeleteBuffers(1, &triangle_indices_id));
+        if (quad_indices_id)
+            glsafe(::glDeleteBuffers(1, &quad_indices_id));
+    }
+};
+
 void GLIndexedVertexArray::finalize_geometry(bool opengl_initialized)
 {
     assert(this->vertices_and_normals_interleaved_VBO_id == 0);
@@ -184,7 +259,16 @@ void GLIndexedVertexArray::finalize_geometry(bool opengl_initialized)
 		return;
 	}
 
-    if (! this->vertices_and_normals_interleaved.empty()) {
+    m_VBOs = std::make_shared<VBOs>();
+    m_shared_VBOs = false;
+    if (! this->compact_vertices.empty()) {
+        glsafe(::glGenBuffers(1, &this->vertices_and_normals_interleaved_VBO_id));
+        glsafe(::glBindBuffer(GL_ARRAY_BUFFER, this->vertices_and_normals_interleaved_VBO_id));
+        glsafe(::glBufferData(GL_ARRAY_BUFFER, this->compact_vertices.size() * sizeof(CompactVertex), this->compact_vertices.data(), GL_STATIC_DRAW));
+        glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+        // Release the CPU side copy.
+        this->compact_vertices = std::vector<CompactVertex>();
+    } else if (! this->vertices_and_normals_interleaved.empty()) {
         glsafe(::glGenBuffers(1, &this->vertices_and_normals_interleaved_VBO_id));
         glsafe(::glBindBuffer(GL_ARRAY_BUFFER, this->vertices_and_normals_interleaved_VBO_id));
         glsafe(::glBufferData(GL_ARRAY_BUFFER, this->vertices_and_normals_interleaved.size() * 4, this->vertices_and_normals_interleaved.data(), GL_STATIC_DRAW));
@@ -205,33 +289,58 @@ void GLIndexedVertexArray::finalize_geometry(bool opengl_initialized)
         glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
         this->quad_indices.clear();
     }
+    m_VBOs->vertices_and_normals_interleaved_id = this->vertices_and_normals_interleaved_VBO_id;
+    m_VBOs->triangle_indices_id                 = this->triangle_indices_VBO_id;
+    m_VBOs->quad_indices_id                     = this->quad_indices_VBO_id;
 }
 
 void GLIndexedVertexArray::release_geometry()
 {
-    if (this->vertices_and_normals_interleaved_VBO_id) {
-        glsafe(::glDeleteBuffers(1, &this->vertices_and_normals_interleaved_VBO_id));
-        this->vertices_and_normals_interleaved_VBO_id = 0;
-    }
-    if (this->triangle_indices_VBO_id) {
-        glsafe(::glDeleteBuffers(1, &this->triangle_indices_VBO_id));
-        this->triangle_indices_VBO_id = 0;
-    }
-    if (this->quad_indices_VBO_id) {
-        glsafe(::glDeleteBuffers(1, &this->quad_indices_VBO_id));
-        this->quad_indices_VBO_id = 0;
-    }
+    // The buffers are deleted together with the last reference to them.
+    m_VBOs.reset();
+    m_shared_VBOs = false;
+    this->vertices_and_normals_interleaved_VBO_id = 0;
+    this->triangle_indices_VBO_id                 = 0;
+    this->quad_indices_VBO_id                     = 0;
     this->clear();
 }
 
+void GLIndexedVertexArray::share_geometry(const GLIndexedVertexArray &rhs)
+{
+    assert(rhs.has_VBOs());
+    this->release_geometry();
+    m_VBOs                                        = rhs.m_VBOs;
+    m_shared_VBOs                                 = true;
+    m_bounding_box                                = rhs.m_bounding_box;
+    m_compact                                     = rhs.m_compact;
+    m_dequantization                              = rhs.m_dequantization;
+    this->vertices_and_normals_interleaved_VBO_id = rhs.vertices_and_normals_interleaved_VBO_id;
+    this->triangle_indices_VBO_id                 = rhs.triangle_indices_VBO_id;
+    this->quad_indices_VBO_id                     = rhs.quad_indices_VBO_id;
+    this->vertices_and_normals_interleaved_size   = rhs.vertices_and_normals_interleaved_size;
+    this->triangle_indices_size                   = rhs.triangle_indices_size;
+    this->quad_indices_size                       = rhs.quad_indices_size;
+}
+
+void GLIndexedVertexArray::setup_vertex_pointers() const
+{
+    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, this->vertices_and_normals_interleaved_VBO_id));
+    if (m_compact) {
+        // The positions are dequantized by the dequantization_matrix(), the byte normals are normalized by OpenGL.
+        glsafe(::glVertexPointer(3, GL_SHORT, sizeof(CompactVertex), (const void*)offsetof(CompactVertex, position)));
+        glsafe(::glNormalPointer(GL_BYTE, sizeof(CompactVertex), (const void*)offsetof(CompactVertex, normal)));
+    } else {
+        glsafe(::glVertexPointer(3, GL_FLOAT, 6 * sizeof(float), (const void*)(3 * sizeof(float))));
+        glsafe(::glNormalPointer(GL_FLOAT, 6 * sizeof(float), nullptr));
+    }
+}
+
 void GLIndexedVertexArray::render() const
 {
     assert(this->vertices_and_normals_interleaved_VBO_id != 0);
     assert(this->triangle_indices_VBO_id != 0 || this->quad_indices_VBO_id != 0);
 
-    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, this->vertices_and_normals_interleaved_VBO_id));
-    glsafe(::glVertexPointer(3, GL_FLOAT, 6 * sizeof(float), (const void*)(3 * sizeof(float))));
-    glsafe(::glNormalPointer(GL_FLOAT, 6 * sizeof(float), nullptr));
+    this->setup_vertex_pointers();
 
     glsafe(::glEnableClientState(GL_VERTEX_ARRAY));
     glsafe(::glEnableClientState(GL_NORMAL_ARRAY));
@@ -262,9 +371,7 @@ void GLIndexedVertexArray::render(
 //    assert(this->triangle_indices_VBO_id != 0 || this->quad_indices_VBO_id != 0);
 
     // Render using the Vertex Buffer Objects.
-    glsafe(::glBindBuffer(GL_ARRAY_BUFFER, this->vertices_and_normals_interleaved_VBO_id));
-    glsafe(::glVertexPointer(3, GL_FLOAT, 6 * sizeof(float), (const void*)(3 * sizeof(float))));
-    glsafe(::glNormalPointer(GL_FLOAT, 6 * sizeof(float), nullptr));
+    this->setup_vertex_pointers();
 
     glsafe(::glEnableClientState(GL_VERTEX_ARRAY));
     glsafe(::glEnableClientState(GL_NORMAL_ARRAY));
@@ -497,6 +604,8 @@ void GLVolume::render() const
     glsafe(::glCullFace(GL_BACK));
     glsafe(::glPushMatrix());
     glsafe(::glMultMatrixd(world_matrix().data()));
+    if (this->indexed_vertex_array.is_compact())
+        glsafe(::glMultMatrixd(this->indexed_vertex_array.dequantization_matrix().data()));
 
     this->indexed_vertex_array.render(this->tverts_range, this->qverts_range);
 
@@ -508,6 +617,15 @@ void GLVolume::render() const
 bool GLVolume::is_sla_support() const { return this->composite_id.volume_id == -int(slaposSupportTree); }
 bool GLVolume::is_sla_pad() const { return this->composite_id.volume_id == -int(slaposPad); }
 
+static void load_mesh(GLIndexedVertexArray &vertex_array, const TriangleMesh &mesh)
+{
+#if ENABLE_SMOOTH_NORMALS
+    vertex_array.load_mesh(mesh, true);
+#else
+    vertex_array.load_mesh(mesh);
+#endif // ENABLE_SMOOTH_NORMALS
+}
+
 std::vector<int> GLVolumeCollection::load_object(
     const ModelObject       *model_object,
     int                      obj_idx,
@@ -528,7 +646,8 @@ int GLVolumeCollection::load_object_volume(
     int                  volume_idx,
     int                  instance_idx,
     const std::string   &color_by,
-    bool 				 opengl_initialized)
+    bool 				 opengl_initialized,
+    bool                 load_geometry)
 {
     const ModelVolume   *model_volume = model_object->volumes[volume_idx];
     const int            extruder_id  = model_volume->extruder_id();
@@ -550,12 +669,23 @@ int GLVolumeCollection::load_object_volume(
     this->volumes.emplace_back(new GLVolume(color));
     GLVolume& v = *this->volumes.back();
     v.set_color_from_model_volume(model_volume);
-#if ENABLE_SMOOTH_NORMALS
-    v.indexed_vertex_array.load_mesh(mesh, true);
-#else
-    v.indexed_vertex_array.load_mesh(mesh);
-#endif // ENABLE_SMOOTH_NORMALS
-    v.indexed_vertex_array.finalize_geometry(opengl_initialized);
+    v.source_mesh = model_volume->get_mesh_shared_ptr();
+    if (load_geometry) {
+        // The other instances of this ModelVolume have already uploaded the same mesh.
+        const GLVolume *shared = nullptr;
+        if (opengl_initialized)
+            for (const GLVolume *other : this->volumes)
+                if (other != &v && other->source_mesh == v.source_mesh && other->indexed_vertex_array.has_VBOs()) {
+                    shared = other;
+                    break;
+                }
+        if (shared != nullptr)
+            v.indexed_vertex_array.share_geometry(shared->indexed_vertex_array);
+        else {
+            load_mesh(v.indexed_vertex_array, mesh);
+            v.indexed_vertex_array.finalize_geometry(opengl_initialized);
+        }
+    }
     v.composite_id = GLVolume::CompositeID(obj_idx, volume_idx, instance_idx);
     if (model_volume->is_model_part())
     {
@@ -572,6 +702,44 @@ int GLVolumeCollection::load_object_volume(
     return int(this->volumes.size() - 1);
 }
 
+void GLVolumeCollection::load_object_volumes_geometry(const std::vector<size_t> &volume_idxs, bool opengl_initialized)
+{
+    // Volume holding the geometry of a mesh, either uploaded already or to be loaded by this call.
+    std::unordered_map<const TriangleMesh*, const GLVolume*> loaded;
+    if (opengl_initialized)
+        for (const GLVolume *v : this->volumes)
+            if (v->source_mesh && v->indexed_vertex_array.has_VBOs())
+                loaded.emplace(v->source_mesh.get(), v);
+
+    std::vector<GLVolume*> to_load;
+    for (size_t idx : volume_idxs) {
+        GLVolume *v = this->volumes[idx];
+        assert(v->source_mesh && v->indexed_vertex_array.empty());
+        if (loaded.emplace(v->source_mesh.get(), v).second)
+            to_load.emplace_back(v);
+    }
+
+    // Filling the vertex arrays does not touch OpenGL, thus it may run in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, to_load.size()),
+        [&to_load](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                load_mesh(to_load[i]->indexed_vertex_array, *to_load[i]->source_mesh);
+        });
+    for (GLVolume *v : to_load)
+        v->indexed_vertex_array.finalize_geometry(opengl_initialized);
+
+    for (size_t idx : volume_idxs) {
+        GLVolume       *v   = this->volumes[idx];
+        const GLVolume *src = loaded[v->source_mesh.get()];
+        if (src == v)
+            continue;
+        if (src->indexed_vertex_array.has_VBOs())
+            v->indexed_vertex_array.share_geometry(src->indexed_vertex_array);
+        else
+            v->indexed_vertex_array = src->indexed_vertex_array;
+    }
+}
+
 // Load SLA auxiliary GLVolumes (for support trees or pad).
 // This function produces volumes for multiple instances in a single shot,
 // as some object specific mesh conversions may be expensive.
@@ -699,6 +867,24 @@ GLVolume* GLVolumeCollection::new_nontoolpath_volume(const float *rgba, size_t r
 	return out;
 }
 
+void GLVolumeCollection::finalize_geometry(bool opengl_initialized)
+{
+    // The first volume loaded from a mesh uploads it, the others reference its VBOs.
+    std::unordered_map<const TriangleMesh*, const GLVolume*> uploaded;
+    for (GLVolume *v : volumes) {
+        if (opengl_initialized && v->source_mesh) {
+            auto it = uploaded.find(v->source_mesh.get());
+            if (it != uploaded.end()) {
+                v->indexed_vertex_array.share_geometry(it->second->indexed_vertex_array);
+                continue;
+            }
+        }
+        v->finalize_geometry(opengl_initialized);
+        if (v->source_mesh && v->indexed_vertex_array.has_VBOs())
+            uploaded.emplace(v->source_mesh.get(), v);
+    }
+}
+
 GLVolumeWithIdAndZList volumes_to_render(const GLVolumePtrs& volumes, GLVolumeCollection::ERenderType type, const Transform3d& view_matrix, std::function<bool(const GLVolume&)> filter_func)
 {
     GLVolumeWithIdAndZList list;
@@ -772,7 +958,7 @@ void GLVolumeCollection::render(GLVolumeCollection::ERenderType type, bool disab
         volume.first->set_render_color();
         shader->set_uniform("uniform_color", volume.first->render_color, 4);
         shader->set_uniform("print_box.actived", volume.first->shader_outside_printer_detection_enabled);
-        shader->set_uniform("print_box.volume_world_matrix", volume.first->world_matrix());
+        shader->set_uniform("print_box.volume_world_matrix", volume.first->world_matrix() * volume.first->indexed_vertex_array.dequantization_matrix());
         shader->set_uniform("slope.actived", m_slope.active && !volume.first->is_modifier && !volume.first->is_wipe_tower);
         shader->set_uniform("slope.volume_world_normal_matrix", static_cast<Matrix3f>(volume.first->world_matrix().matrix().block(0, 0, 3, 3).inverse().transpose().cast<float>()));
 
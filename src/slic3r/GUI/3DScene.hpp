@@ -8,7 +8,10 @@
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/Geometry.hpp"
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
 
 #if ENABLE_OPENGL_ERROR_LOGGING || ! defined(NDEBUG)
     #define HAS_GLSAFE
@@ -41,8 +44,18 @@ enum ModelInstanceEPrintVolumeState : unsigned char;
 
 // A container for interleaved arrays of 3D vertices and normals,
 // possibly indexed by triangles and / or quads.
+// Meshes loaded by load_mesh() are stored in a compact form: the vertices are shared between the triangles,
+// their positions are quantized to 16 bits relative to the mesh bounding box and their normals to 8 bits.
 class GLIndexedVertexArray {
 public:
+    // Vertex of the compact format, 12 bytes instead of the 24 bytes of vertices_and_normals_interleaved.
+    struct CompactVertex
+    {
+        int16_t position[4];
+        int8_t  normal[4];
+        bool operator==(const CompactVertex &rhs) const { return memcmp(this, &rhs, sizeof(CompactVertex)) == 0; }
+    };
+
     GLIndexedVertexArray() : 
         vertices_and_normals_interleaved_VBO_id(0),
         triangle_indices_VBO_id(0),
@@ -50,19 +63,25 @@ public:
         {}
     GLIndexedVertexArray(const GLIndexedVertexArray &rhs) :
         vertices_and_normals_interleaved(rhs.vertices_and_normals_interleaved),
+        compact_vertices(rhs.compact_vertices),
         triangle_indices(rhs.triangle_indices),
         quad_indices(rhs.quad_indices),
         vertices_and_normals_interleaved_VBO_id(0),
         triangle_indices_VBO_id(0),
-        quad_indices_VBO_id(0)
+        quad_indices_VBO_id(0),
+        m_compact(rhs.m_compact),
+        m_dequantization(rhs.m_dequantization)
         { assert(! rhs.has_VBOs()); }
     GLIndexedVertexArray(GLIndexedVertexArray &&rhs) :
         vertices_and_normals_interleaved(std::move(rhs.vertices_and_normals_interleaved)),
+        compact_vertices(std::move(rhs.compact_vertices)),
         triangle_indices(std::move(rhs.triangle_indices)),
         quad_indices(std::move(rhs.quad_indices)),
         vertices_and_normals_interleaved_VBO_id(0),
         triangle_indices_VBO_id(0),
-        quad_indices_VBO_id(0)
+        quad_indices_VBO_id(0),
+        m_compact(rhs.m_compact),
+        m_dequantization(rhs.m_dequantization)
         { assert(! rhs.has_VBOs()); }
 
     ~GLIndexedVertexArray() { release_geometry(); }
@@ -76,9 +95,12 @@ public:
         assert(rhs.triangle_indices_VBO_id == 0);
         assert(rhs.quad_indices_VBO_id == 0);
         this->vertices_and_normals_interleaved 		 = rhs.vertices_and_normals_interleaved;
+        this->compact_vertices                 		 = rhs.compact_vertices;
         this->triangle_indices                 		 = rhs.triangle_indices;
         this->quad_indices                     		 = rhs.quad_indices;
         this->m_bounding_box                   		 = rhs.m_bounding_box;
+        this->m_compact                        		 = rhs.m_compact;
+        this->m_dequantization                 		 = rhs.m_dequantization;
         this->vertices_and_normals_interleaved_size  = rhs.vertices_and_normals_interleaved_size;
         this->triangle_indices_size                  = rhs.triangle_indices_size;
         this->quad_indices_size                      = rhs.quad_indices_size;
@@ -94,9 +116,12 @@ public:
         assert(rhs.triangle_indices_VBO_id == 0);
         assert(rhs.quad_indices_VBO_id == 0);
         this->vertices_and_normals_interleaved 		 = std::move(rhs.vertices_and_normals_interleaved);
+        this->compact_vertices                 		 = std::move(rhs.compact_vertices);
         this->triangle_indices                 		 = std::move(rhs.triangle_indices);
         this->quad_indices                     		 = std::move(rhs.quad_indices);
         this->m_bounding_box                   		 = std::move(rhs.m_bounding_box);
+        this->m_compact                        		 = rhs.m_compact;
+        this->m_dequantization                 		 = rhs.m_dequantization;
         this->vertices_and_normals_interleaved_size  = rhs.vertices_and_normals_interleaved_size;
         this->triangle_indices_size                  = rhs.triangle_indices_size;
         this->quad_indices_size                      = rhs.quad_indices_size;
@@ -105,11 +130,14 @@ public:
 
     // Vertices and their normals, interleaved to be used by void glInterleavedArrays(GL_N3F_V3F, 0, x)
     std::vector<float> vertices_and_normals_interleaved;
+    // Shared vertices of a mesh loaded by load_mesh(), used instead of vertices_and_normals_interleaved.
+    std::vector<CompactVertex> compact_vertices;
     std::vector<int>   triangle_indices;
     std::vector<int>   quad_indices;
 
     // When the geometry data is loaded into the graphics card as Vertex Buffer Objects,
     // the above mentioned std::vectors are cleared and the following variables keep their original length.
+    // In the compact format, vertices_and_normals_interleaved_size is the number of compact vertices.
     size_t vertices_and_normals_interleaved_size{ 0 };
     size_t triangle_indices_size{ 0 };
     size_t quad_indices_size{ 0 };
@@ -129,6 +157,11 @@ public:
 #endif // ENABLE_SMOOTH_NORMALS
 
     inline bool has_VBOs() const { return vertices_and_normals_interleaved_VBO_id != 0; }
+    // Is the geometry stored in the compact format?
+    bool is_compact() const { return m_compact; }
+    // Transformation of the quantized vertex positions to the mesh coordinates, identity if not compact.
+    // To be multiplied to the right of the volume world matrix when rendering.
+    const Transform3d& dequantization_matrix() const { return m_dequantization; }
 
     inline void reserve(size_t sz) {
         this->vertices_and_normals_interleaved.reserve(sz * 6);
@@ -194,7 +227,11 @@ public:
     // and shrink the allocated data, possibly relasing it if it has been loaded into the VBOs.
     void finalize_geometry(bool opengl_initialized);
     // Release the geometry data, release OpenGL VBOs.
+    // The VBOs shared with other arrays are only deleted by the last one of them.
     void release_geometry();
+    // Reference the VBOs of rhs instead of uploading a copy of the same geometry.
+    // rhs has to be finalized already.
+    void share_geometry(const GLIndexedVertexArray &rhs);
 
     void render() const;
     void render(const std::pair<size_t, size_t>& tverts_range, const std::pair<size_t, size_t>& qverts_range) const;
@@ -204,9 +241,12 @@ public:
 
     void clear() {
         this->vertices_and_normals_interleaved.clear();
+        this->compact_vertices.clear();
         this->triangle_indices.clear();
         this->quad_indices.clear();
         this->m_bounding_box.reset();
+        this->m_compact = false;
+        this->m_dequantization = Transform3d::Identity();
         vertices_and_normals_interleaved_size = 0;
         triangle_indices_size = 0;
         quad_indices_size = 0;
@@ -215,6 +255,7 @@ public:
     // Shrink the internal storage to tighly fit the data stored.
     void shrink_to_fit() {
         this->vertices_and_normals_interleaved.shrink_to_fit();
+        this->compact_vertices.shrink_to_fit();
         this->triangle_indices.shrink_to_fit();
         this->quad_indices.shrink_to_fit();
     }
@@ -222,13 +263,16 @@ public:
     const BoundingBoxf3& bounding_box() const { return m_bounding_box; }
 
     // Return an estimate of the memory consumed by this class.
-    size_t cpu_memory_used() const { return sizeof(*this) + vertices_and_normals_interleaved.capacity() * sizeof(float) + triangle_indices.capacity() * sizeof(int) + quad_indices.capacity() * sizeof(int); }
+    size_t cpu_memory_used() const { return sizeof(*this) + vertices_and_normals_interleaved.capacity() * sizeof(float) + compact_vertices.capacity() * sizeof(CompactVertex) + triangle_indices.capacity() * sizeof(int) + quad_indices.capacity() * sizeof(int); }
     // Return an estimate of the memory held by GPU vertex buffers.
     size_t gpu_memory_used() const
     {
+    	// Shared VBOs are accounted for by the array, which uploaded them.
+    	if (m_shared_VBOs)
+    		return 0;
     	size_t memsize = 0;
     	if (this->vertices_and_normals_interleaved_VBO_id != 0)
-    		memsize += this->vertices_and_normals_interleaved_size * 4;
+    		memsize += this->vertices_and_normals_interleaved_size * (m_compact ? sizeof(CompactVertex) : 4);
     	if (this->triangle_indices_VBO_id != 0)
     		memsize += this->triangle_indices_size * 4;
     	if (this->quad_indices_VBO_id != 0)
@@ -238,7 +282,16 @@ public:
     size_t total_memory_used() const { return this->cpu_memory_used() + this->gpu_memory_used(); }
 
 private:
-    BoundingBoxf3 m_bounding_box;
+    // Owner of the OpenGL buffers, deletes them when the last array referencing them releases its geometry.
+    struct VBOs;
+    std::shared_ptr<VBOs> m_VBOs;
+    // Were the VBOs received from another array through share_geometry()?
+    bool                  m_shared_VBOs{ false };
+    BoundingBoxf3         m_bounding_box;
+    bool                  m_compact{ false };
+    Transform3d           m_dequantization{ Transform3d::Identity() };
+
+    void                  setup_vertex_pointers() const;
 };
 
 class GLVolume {
@@ -309,6 +362,9 @@ public:
     // and the associated ModelInstanceID.
     // Valid geometry_id should always be positive.
     std::pair<size_t, size_t> geometry_id;
+    // Mesh of the ModelVolume, from which indexed_vertex_array was loaded, if any.
+    // The instances of a ModelVolume share the VBOs of the same mesh.
+    std::shared_ptr<const TriangleMesh> source_mesh;
     // An ID containing the extruder ID (used to select color).
     int                 	extruder_id;
 
@@ -450,7 +506,7 @@ public:
     void                render() const;
 
     void                finalize_geometry(bool opengl_initialized) { this->indexed_vertex_array.finalize_geometry(opengl_initialized); }
-    void                release_geometry() { this->indexed_vertex_array.release_geometry(); }
+    void                release_geometry() { this->indexed_vertex_array.release_geometry(); this->source_mesh.reset(); }
 
     void                set_bounding_boxes_as_dirty() { m_transformed_bounding_box_dirty = true; m_transformed_convex_hull_bounding_box_dirty = true; }
 
@@ -520,7 +576,14 @@ public:
         int                volume_idx,
         int                instance_idx,
         const std::string &color_by,
-        bool 			   opengl_initialized);
+        bool 			   opengl_initialized,
+        // If false, the geometry is loaded later by load_object_volumes_geometry().
+        bool               load_geometry = true);
+
+    // Load the geometry of the volumes created by load_object_volume() without geometry.
+    // The vertex arrays of the distinct meshes are filled in parallel,
+    // only the upload to the OpenGL driver is done by the calling thread.
+    void load_object_volumes_geometry(const std::vector<size_t> &volume_idxs, bool opengl_initialized);
 
     // Load SLA auxiliary GLVolumes (for support trees or pad).
     void load_object_auxiliary(
@@ -545,7 +608,8 @@ public:
     // Finalize the initialization of the geometry & indices,
     // upload the geometry and indices to OpenGL VBO objects
     // and shrink the allocated data, possibly relasing it if it has been loaded into the VBOs.
-    void finalize_geometry(bool opengl_initialized) { for (auto* v : volumes) v->finalize_geometry(opengl_initialized); }
+    // The volumes loaded from the same mesh share its VBOs.
+    void finalize_geometry(bool opengl_initialized);
     // Release the geometry data assigned to the volumes.
     // If OpenGL VBOs were allocated, an OpenGL context has to be active to release them.
     void release_geometry() { for (auto *v : volumes) v->release_geometry(); }
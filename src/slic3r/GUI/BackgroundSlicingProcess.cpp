@@ -31,6 +31,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <tbb/task_arena.h>
 #include "I18N.hpp"
 #include "RemovableDriveManager.hpp"
 
@@ -262,16 +263,29 @@ void BackgroundSlicingProcess::thread_proc()
 			break;
 		// Process the background slicing task.
 		m_state = STATE_RUNNING;
+		const int slicing_threads = m_slicing_threads;
 		lck.unlock();
 		std::exception_ptr exception;
 		try {
 			assert(m_print != nullptr);
-			switch(m_print->technology()) {
-				case ptFFF: this->process_fff(); break;
-                case ptSLA: this->process_sla(); break;
-                case ptSLS: this->process_fff(); break;
-				default: m_print->process(); break;
+			{
+				// The G-code / archive of this run will be finalized again. Reset the finalize step without canceling,
+				// so that an export scheduled while this run is still generating the output joins it
+				// instead of canceling and restarting the G-code generation.
+				tbb::mutex::scoped_lock lock(m_print->state_mutex());
+				m_step_state.invalidate(bspsGCodeFinalize, [](){});
 			}
+			// The parallel loops of the slicing run in their own arena, sharing the TBB worker threads with the UI thread
+			// up to the configured concurrency.
+			tbb::task_arena arena(slicing_threads > 0 ? slicing_threads : int(tbb::task_arena::automatic));
+			arena.execute([this]() {
+				switch(m_print->technology()) {
+					case ptFFF: this->process_fff(); break;
+	                case ptSLA: this->process_sla(); break;
+	                case ptSLS: this->process_fff(); break;
+					default: m_print->process(); break;
+				}
+			});
 		} catch (CanceledException & /* ex */) {
 			// Canceled, this is all right.
 			assert(m_print->canceled());
@@ -348,6 +362,7 @@ bool BackgroundSlicingProcess::start()
 	if (! this->idle())
 		throw Slic3r::RuntimeError("Cannot start a background task, the worker thread is not idle.");
 	m_state = STATE_STARTED;
+	m_slicing_threads = std::max(0, atoi(GUI::wxGetApp().app_config->get("slicing_threads").c_str()));
 	m_print->set_cancel_callback([this](){ this->stop_internal(); });
 	lck.unlock();
 	m_condition.notify_one();
@@ -599,7 +614,8 @@ void BackgroundSlicingProcess::prepare_upload()
 		if (copy_file(m_temp_output_path, source_path.string(), error_message) != SUCCESS) {
 			throw Slic3r::RuntimeError(_utf8(L("Copying of the temporary G-code to the output G-code failed")));
 		}
-		run_post_process_scripts(source_path.string(), m_fff_print->full_print_config());
+		// The print hosts and their firmwares can't read the compressed G-code, always upload the text.
+		run_post_process_scripts(source_path.string(), m_fff_print->full_print_config(), false);
 		m_upload_job.upload_data.upload_path = m_fff_print->print_statistics().finalize_output_path(m_upload_job.upload_data.upload_path.string());
     } else if (m_print == m_sla_print) {
 		m_upload_job.upload_data.upload_path = m_sla_print->print_statistics().finalize_output_path(m_upload_job.upload_data.upload_path.string());
@@ -211,6 +211,10 @@ private:
 	std::mutex 		 			m_mutex;
 	std::condition_variable		m_condition;
 	State 						m_state = STATE_INITIAL;
+	// Maximum number of threads of the task arena the slicing and the G-code export run in, 0 for all the hardware threads.
+	// Limiting it leaves worker threads to the parallel work of the UI thread, for example the G-code preview load.
+	// Read from the application preferences by start(), guarded by m_mutex.
+	int 						m_slicing_threads = 0;
 
     // For executing tasks from the background thread on UI thread synchronously (waiting for result) using wxWidgets CallAfter().
     // When the background proces is canceled, the UITask has to be invalidated as well, so that it will not be
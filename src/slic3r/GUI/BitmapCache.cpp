@@ -6,6 +6,8 @@
 #include "GUI_Utils.hpp"
 
 #include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/nowide/fstream.hpp>
 
 #ifdef __WXGTK2__
     // Broken alpha workaround
@@ -262,6 +264,63 @@ wxBitmap* BitmapCache::load_png(const std::string &bitmap_name, unsigned width,
     return this->insert(bitmap_key, wxImage_to_wxBitmap_with_alpha(std::move(image)));
 }
 
+// Rasterized SVG icons are cached on disk, keyed by the SVG file, its size and modification time and by the rasterization
+// parameters, as parsing and rasterizing the SVGs with nanosvg is a noticeable part of the startup and of a DPI change.
+static std::string svg_raster_cache_path(const std::string &svg_path, unsigned target_width, unsigned target_height, uint32_t color, double scale)
+{
+    const std::string dir = data_dir();
+    boost::system::error_code ec;
+    const boost::filesystem::path path(svg_path);
+    const auto size  = boost::filesystem::file_size(path, ec);
+    if (dir.empty() || ec)
+        return std::string();
+    const auto mtime = boost::filesystem::last_write_time(path, ec);
+    if (ec)
+        return std::string();
+    size_t seed = 0;
+    boost::hash_combine(seed, svg_path);
+    boost::hash_combine(seed, size);
+    boost::hash_combine(seed, mtime);
+    boost::hash_combine(seed, target_width);
+    boost::hash_combine(seed, target_height);
+    boost::hash_combine(seed, color);
+    boost::hash_combine(seed, scale);
+    char name[32];
+    sprintf(name, "%016llx.rgba", (unsigned long long)seed);
+    return dir + "/cache/icons/" + name;
+}
+
+static bool load_svg_raster(const std::string &path, unsigned &width, unsigned &height, std::vector<unsigned char> &data)
+{
+    boost::nowide::ifstream s(path, boost::nowide::ifstream::binary);
+    if (! s.good())
+        return false;
+    s.read(reinterpret_cast<char*>(&width), sizeof(width));
+    s.read(reinterpret_cast<char*>(&height), sizeof(height));
+    if (! s.good() || width == 0 || height == 0 || size_t(width) * size_t(height) > (1 << 24))
+        return false;
+    data.assign(size_t(width) * size_t(height) * 4, 0);
+    s.read(reinterpret_cast<char*>(data.data()), data.size());
+    return s.gcount() == std::streamsize(data.size());
+}
+
+static void save_svg_raster(const std::string &path, unsigned width, unsigned height, const std::vector<unsigned char> &data)
+{
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(boost::filesystem::path(path).parent_path(), ec);
+    // Write into a temporary file first, so that a concurrently running instance never reads a partial file.
+    const std::string path_tmp = path + ".tmp";
+    {
+        boost::nowide::ofstream s(path_tmp, boost::nowide::ofstream::binary);
+        s.write(reinterpret_cast<const char*>(&width), sizeof(width));
+        s.write(reinterpret_cast<const char*>(&height), sizeof(height));
+        s.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (! s.good())
+            return;
+    }
+    boost::filesystem::rename(path_tmp, path, ec);
+}
+
 wxBitmap* BitmapCache::load_svg(const std::string &bitmap_name, unsigned target_width, unsigned target_height, 
     uint32_t color /* = 2172eb*/, const bool dark_mode/* = false*/)
 {
@@ -307,7 +366,16 @@ wxBitmap* BitmapCache::load_svg(const std::string &bitmap_name, unsigned target_
             return it->second;
     }
 
-    NSVGimage *image = ::nsvgParseFromFile(Slic3r::var(folder + bitmap_name + ".svg").c_str(), "px", 96.0f);
+    const std::string svg_path   = Slic3r::var(folder + bitmap_name + ".svg");
+    const std::string cache_path = svg_raster_cache_path(svg_path, target_width, target_height, color, m_scale);
+    {
+        unsigned                   width, height;
+        std::vector<unsigned char> data;
+        if (! cache_path.empty() && load_svg_raster(cache_path, width, height, data))
+            return this->insert_raw_rgba(bitmap_key, width, height, data.data(), 9079434 == color);
+    }
+
+    NSVGimage *image = ::nsvgParseFromFile(svg_path.c_str(), "px", 96.0f);
     if (image == nullptr)
         return nullptr;
 
@@ -348,6 +416,9 @@ wxBitmap* BitmapCache::load_svg(const std::string &bitmap_name, unsigned target_
     ::nsvgDeleteRasterizer(rast);
     ::nsvgDelete(image);
 
+    if (! cache_path.empty())
+        save_svg_raster(cache_path, unsigned(width), unsigned(height), data);
+
     return this->insert_raw_rgba(bitmap_key, width, height, data.data(), 9079434 == color);
 }
 
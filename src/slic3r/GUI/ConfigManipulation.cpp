@@ -458,7 +458,7 @@ void ConfigManipulation::toggle_print_fff_options(DynamicPrintConfig* config)
     bool have_support_material_auto = have_support_material && config->opt_bool("support_material_auto");
     bool have_support_interface = config->opt_int("support_material_interface_layers") > 0;
     bool have_support_soluble = have_support_material && ((ConfigOptionEnumGeneric*)config->option("support_material_contact_distance_type"))->value == zdNone;
-    for (auto el : { "support_material_pattern", "support_material_with_sheath",
+    for (auto el : { "support_material_style", "support_material_pattern", "support_material_with_sheath",
                     "support_material_spacing", "support_material_angle", "support_material_interface_layers",
                     "dont_support_bridges", "support_material_extrusion_width",
                     "support_material_contact_distance_type",
@@ -487,6 +487,7 @@ void ConfigManipulation::toggle_print_fff_options(DynamicPrintConfig* config)
     for (auto el : { /*"extruder_clearance_radius", "extruder_clearance_height",*/ "complete_objects_one_skirt",
 		"complete_objects_sort", "complete_objects_one_brim"})
         toggle_field(el, have_sequential_printing);
+    toggle_field("travel_planning_lookahead", ! have_sequential_printing);
 
     bool have_ooze_prevention = config->opt_bool("ooze_prevention");
     toggle_field("standby_temperature_delta", have_ooze_prevention);
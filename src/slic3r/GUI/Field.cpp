@@ -1221,6 +1221,8 @@ void Choice::set_value(const boost::any& value, bool change_event)
             val = idx_from_enum_value<SupportZDistanceType>(val);
         else if (m_opt_id.compare("support_material_pattern") == 0)
             val = idx_from_enum_value<SupportMaterialPattern>(val);
+        else if (m_opt_id.compare("support_material_style") == 0)
+            val = idx_from_enum_value<SupportMaterialStyle>(val);
         else if (m_opt_id.compare("support_pillar_connection_mode") == 0)
             val = idx_from_enum_value<SLAPillarConnectionMode>(val);
         else if (m_opt_id.compare("wipe_advanced_algo") == 0)
@@ -1343,6 +1345,8 @@ boost::any& Choice::get_value()
             convert_to_enum_value<SupportZDistanceType>(ret_enum);
         else if (m_opt_id.compare("support_material_pattern") == 0)
             convert_to_enum_value<SupportMaterialPattern>(ret_enum);
+        else if (m_opt_id.compare("support_material_style") == 0)
+            convert_to_enum_value<SupportMaterialStyle>(ret_enum);
         else if (m_opt_id.compare("support_pillar_connection_mode") == 0)
             convert_to_enum_value<SLAPillarConnectionMode>(ret_enum);
         else if (m_opt_id.compare("wipe_advanced_algo") == 0)
@@ -21,11 +21,14 @@
 
 #include <GL/glew.h>
 #include <boost/locale/generator.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
 #include <wx/progdlg.h>
 #include <wx/numformatter.h>
 
@@ -72,15 +75,7 @@ static std::vector<std::array<float, 3>> decode_colors(const std::vector<std::st
 
 static float round_to_nearest(float value, unsigned int decimals)
 {
-    float res = 0.0f;
-    if (decimals == 0)
-        res = std::round(value);
-    else {
-        char buf[64];
-        sprintf(buf, "%.*g", decimals, value);
-        res = std::stof(buf);
-    }
-    return res;
+    return GCodeProcessor::round_to_nearest(value, decimals);
 }
 
 #if ENABLE_SPLITTED_VERTEX_BUFFER
@@ -115,6 +110,12 @@ void GCodeViewer::IBuffer::reset()
         glsafe(::glDeleteBuffers(1, &ibo));
         ibo = 0;
     }
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+    if (lod_ibo > 0) {
+        glsafe(::glDeleteBuffers(1, &lod_ibo));
+        lod_ibo = 0;
+    }
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 #else
     // release gpu memory
     if (id > 0) {
@@ -198,6 +199,24 @@ void GCodeViewer::TBuffer::reset()
     render_paths.clear();
 }
 
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+void GCodeViewer::ToolpathsCache::reset()
+{
+    // release gpu memory, the ids of the reused buffers have been zeroed
+    for (Buffer& buffer : buffers) {
+        if (!buffer.vbos.empty())
+            glsafe(::glDeleteBuffers(static_cast<GLsizei>(buffer.vbos.size()), static_cast<const GLuint*>(buffer.vbos.data())));
+        for (IBuffer& ibuf : buffer.indices) {
+            ibuf.reset();
+        }
+    }
+
+    // release cpu memory
+    chunks.clear();
+    buffers.clear();
+}
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
+
 void GCodeViewer::TBuffer::add_path(const GCodeProcessor::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id)
 {
     Path::Endpoint endpoint = { b_id, i_id, s_id, move.position };
@@ -572,39 +591,21 @@ void GCodeViewer::refresh(const GCodeProcessor::Result& gcode_result, const std:
         // update tool colors
         m_filament_colors = decode_colors(str_tool_colors);
 
-    // update ranges for coloring / legend
-    m_extrusions.reset_ranges();
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        // skip first vertex
-        if (i == 0)
-            continue;
-
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
-
-        switch (curr.type)
-        {
-        case EMoveType::Extrude:
-        {
-            m_extrusions.ranges.height.update_from(round_to_nearest(curr.height, 2));
-            m_extrusions.ranges.width.update_from(round_to_nearest(curr.width, 2));
-            m_extrusions.ranges.fan_speed.update_from(curr.fan_speed);
-            if(curr.layer_duration > 0.f)
-                m_extrusions.ranges.layer_duration.update_from(curr.layer_duration);
-            m_extrusions.ranges.elapsed_time.update_from(curr.time);
-            m_extrusions.ranges.volumetric_rate.update_from(round_to_nearest(curr.volumetric_rate(), 2));
-            m_extrusions.ranges.extruder_temp.update_from(curr.temperature);
-            [[fallthrough]];
-        }
-        case EMoveType::Travel:
-        {
-            if (m_buffers[buffer_id(curr.type)].visible)
-                m_extrusions.ranges.feedrate.update_from(curr.feedrate);
-
-            break;
-        }
-        default: { break; }
-        }
-    }
+    // update ranges for coloring / legend, from the ones computed by the GCodeProcessor
+    const GCodeProcessor::MovesRanges& ranges = gcode_result.ranges;
+    m_extrusions.ranges.height.set(ranges.height);
+    m_extrusions.ranges.width.set(ranges.width);
+    m_extrusions.ranges.fan_speed.set(ranges.fan_speed);
+    m_extrusions.ranges.volumetric_rate.set(ranges.volumetric_rate);
+    m_extrusions.ranges.extruder_temp.set(ranges.extruder_temp);
+    m_extrusions.ranges.layer_duration.set(ranges.layer_duration);
+    m_extrusions.ranges.elapsed_time.set(ranges.elapsed_time);
+    GCodeProcessor::ValuesRange feedrate;
+    if (m_buffers[buffer_id(EMoveType::Extrude)].visible)
+        feedrate.merge(ranges.extrude_feedrate);
+    if (m_buffers[buffer_id(EMoveType::Travel)].visible)
+        feedrate.merge(ranges.travel_feedrate);
+    m_extrusions.ranges.feedrate.set(feedrate);
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     m_statistics.refresh_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
@@ -636,6 +637,29 @@ void GCodeViewer::update_shells_color_by_extruder(const DynamicPrintConfig* conf
 void GCodeViewer::reset()
 {
     m_moves_count = 0;
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+    if (!m_toolpaths_chunks.empty()) {
+        // detach the toolpaths from the TBuffers, keeping their data on gpu,
+        // so that the next call to load_toolpaths() can reuse the chunks which did not change
+        // restore the original color of the paths
+        toggle_options_layers_color();
+        m_toolpaths_cache.reset();
+        m_toolpaths_cache.chunks.swap(m_toolpaths_chunks);
+        m_toolpaths_cache.buffers = std::vector<ToolpathsCache::Buffer>(m_buffers.size());
+        for (size_t i = 0; i < m_buffers.size(); ++i) {
+            TBuffer& t_buffer = m_buffers[i];
+            ToolpathsCache::Buffer& c_buffer = m_toolpaths_cache.buffers[i];
+            c_buffer.vbos.swap(t_buffer.vertices.vbos);
+            c_buffer.sizes.swap(t_buffer.vertices.sizes);
+            c_buffer.compressed = t_buffer.vertices.compressed;
+            c_buffer.quantization_origin = t_buffer.vertices.quantization_origin;
+            c_buffer.quantization_step = t_buffer.vertices.quantization_step;
+            c_buffer.indices.swap(t_buffer.indices);
+            c_buffer.paths.swap(t_buffer.paths);
+        }
+    }
+    m_options_zs.clear();
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
     for (TBuffer& buffer : m_buffers) {
         buffer.reset();
     }
@@ -924,17 +948,29 @@ void GCodeViewer::export_toolpaths_to_obj(const char* filename) const
 
     // get vertices/normals data from vertex buffers on gpu
     for (size_t i = 0; i < t_buffer.vertices.vbos.size(); ++i) {
-        const size_t floats_count = t_buffer.vertices.sizes[i] / sizeof(float);
-        VertexBuffer vertices(floats_count);
+        size_t vertices_count = 0;
         glsafe(::glBindBuffer(GL_ARRAY_BUFFER, t_buffer.vertices.vbos[i]));
-        glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(t_buffer.vertices.sizes[i]), static_cast<void*>(vertices.data())));
-        glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
-        const size_t vertices_count = floats_count / floats_per_vertex;
-        for (size_t j = 0; j < vertices_count; ++j) {
-            const size_t base = j * floats_per_vertex;
-            out_vertices.push_back({ vertices[base + 0], vertices[base + 1], vertices[base + 2] });
-            out_normals.push_back({ vertices[base + 3], vertices[base + 4], vertices[base + 5] });
+        if (t_buffer.vertices.compressed) {
+            vertices_count = t_buffer.vertices.sizes[i] / sizeof(VBuffer::CompressedVertex);
+            std::vector<VBuffer::CompressedVertex> vertices(vertices_count);
+            glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(t_buffer.vertices.sizes[i]), static_cast<void*>(vertices.data())));
+            for (const VBuffer::CompressedVertex& v : vertices) {
+                out_vertices.push_back(t_buffer.vertices.dequantize(v.position));
+                out_normals.push_back(Vec3f(float(v.normal[0]), float(v.normal[1]), float(v.normal[2])).normalized());
+            }
+        }
+        else {
+            const size_t floats_count = t_buffer.vertices.sizes[i] / sizeof(float);
+            VertexBuffer vertices(floats_count);
+            glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(t_buffer.vertices.sizes[i]), static_cast<void*>(vertices.data())));
+            vertices_count = floats_count / floats_per_vertex;
+            for (size_t j = 0; j < vertices_count; ++j) {
+                const size_t base = j * floats_per_vertex;
+                out_vertices.push_back({ vertices[base + 0], vertices[base + 1], vertices[base + 2] });
+                out_normals.push_back({ vertices[base + 3], vertices[base + 4], vertices[base + 5] });
+            }
         }
+        glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
 
         if (i < t_buffer.vertices.vbos.size() - 1)
             vertices_offsets.push_back({ t_buffer.vertices.vbos[i + 1], vertices_offsets.back().offset + vertices_count });
@@ -1245,22 +1281,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 {
     // max index buffer size, in bytes
     static const size_t IBUFFER_THRESHOLD_BYTES = 64 * 1024 * 1024;
-
-    auto log_memory_usage = [this](const std::string& label, const std::vector<MultiVertexBuffer>& vertices, const std::vector<MultiIndexBuffer>& indices) {
-        int64_t vertices_size = 0;
-        for (const MultiVertexBuffer& buffers : vertices) {
-            for (const VertexBuffer& buffer : buffers) {
-                vertices_size += SLIC3R_STDVEC_MEMSIZE(buffer, float);
-            }
-        }
-        int64_t indices_size = 0;
-        for (const MultiIndexBuffer& buffers : indices) {
-            for (const IndexBuffer& buffer : buffers) {
-                indices_size += SLIC3R_STDVEC_MEMSIZE(buffer, IBufferType);
-            }
-        }
-        log_memory_used(label, vertices_size + indices_size);
-    };
+    // min count of moves contained into a toolpaths chunk
+    static const size_t TOOLPATHS_CHUNK_MIN_MOVES = 100000;
 
     // format data into the buffers to be rendered as points
     auto add_vertices_as_point = [](const GCodeProcessor::MoveVertex& curr, VertexBuffer& vertices) {
@@ -1295,7 +1317,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     };
     auto add_indices_as_line = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, TBuffer& buffer,
         unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id) {
-            if (prev.type != curr.type || !buffer.paths.back().matches(curr)) {
+            if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr)) {
                 // add starting index
                 indices.push_back(static_cast<unsigned int>(indices.size()));
                 buffer.add_path(curr, ibuffer_id, indices.size() - 1, move_id - 1);
@@ -1326,7 +1348,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             vertices.push_back(normal[2]);
         };
 
-        if (prev.type != curr.type || !buffer.paths.back().matches(curr)) {
+        if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr)) {
             buffer.add_path(curr, vbuffer_id, vertices.size(), move_id - 1);
             buffer.paths.back().sub_paths.back().first.position = prev.position;
         }
@@ -1371,16 +1393,23 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
         last_path.sub_paths.back().last = { vbuffer_id, vertices.size(), move_id, curr.position };
     };
+    // data of the previous segment, used to generate the corners of the solid toolpaths
+    struct PrevSegment
+    {
+        Vec3f dir{ Vec3f::Zero() };
+        Vec3f up{ Vec3f::Zero() };
+        float sq_length{ 0.0f };
+    };
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
     auto add_indices_as_solid = [&](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, const GCodeProcessor::MoveVertex* next,
-        TBuffer& buffer, size_t& vbuffer_size, unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id) {
+        TBuffer& buffer, size_t& vbuffer_size, unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id, PrevSegment& prev_segment) {
 #else
     auto add_indices_as_solid = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, TBuffer& buffer,
-        size_t& vbuffer_size, unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id) {
+        size_t& vbuffer_size, unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id, PrevSegment& prev_segment) {
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
-            static Vec3f prev_dir;
-            static Vec3f prev_up;
-            static float sq_prev_length;
+            const Vec3f& prev_dir = prev_segment.dir;
+            const Vec3f& prev_up = prev_segment.up;
+            const float sq_prev_length = prev_segment.sq_length;
             auto store_triangle = [](IndexBuffer& indices, IBufferType i1, IBufferType i2, IBufferType i3) {
                 indices.push_back(i1);
                 indices.push_back(i2);
@@ -1449,7 +1478,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             };
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 
-            if (prev.type != curr.type || !buffer.paths.back().matches(curr)) {
+            if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr)) {
                 buffer.add_path(curr, ibuffer_id, indices.size(), move_id - 1);
                 buffer.paths.back().sub_paths.back().first.position = prev.position;
             }
@@ -1546,20 +1575,18 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             }
 
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
-            if (next != nullptr && (curr.type != next->type || !last_path.matches(*next)))
+            if (next == nullptr || curr.type != next->type || !last_path.matches(*next))
                 // ending cap triangles
                 append_ending_cap_triangles(indices, non_first_seg_v_offsets);
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 
             last_path.sub_paths.back().last = { ibuffer_id, indices.size() - 1, move_id, curr.position };
-            prev_dir = dir;
-            prev_up = up;
-            sq_prev_length = sq_length;
+            prev_segment = { dir, up, sq_length };
     };
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessor::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memory_size();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -1567,8 +1594,6 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     if (m_moves_count == 0)
         return;
 
-    unsigned int progress_count = 0;
-    static const unsigned int progress_threshold = 1000;
     wxProgressDialog* progress_dialog = wxGetApp().is_gcode_viewer() ?
         new wxProgressDialog(_L("Generating toolpaths"), "...",
             100, wxGetApp().plater(), wxPD_AUTO_HIDE | wxPD_APP_MODAL) : nullptr;
@@ -1576,7 +1601,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     wxBusyCursor busy;
 
     // extract approximate paths bounding box from result
-    for (const GCodeProcessor::MoveVertex& move : gcode_result.moves) {
+    for (const GCodeProcessor::MoveVertex move : gcode_result.moves) {
         if (wxGetApp().is_gcode_viewer())
             // for the gcode viewer we need to take in account all moves to correctly size the printbed
             m_paths_bounding_box.merge(move.position.cast<double>());
@@ -1590,62 +1615,120 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     m_max_bounding_box = m_paths_bounding_box;
     m_max_bounding_box.merge(m_paths_bounding_box.max + m_sequential_view.marker.get_bounding_box().size()[2] * Vec3d::UnitZ());
 
-    std::vector<MultiVertexBuffer> vertices(m_buffers.size());
-    std::vector<MultiIndexBuffer> indices(m_buffers.size());
-    std::vector<float> options_zs;
+    // set the grid on which the vertices of the extrusion toolpaths are quantized,
+    // large enough to contain the toolpaths' boxes
+    {
+        BoundingBoxf3 box;
+        float max_size = 0.0f;
+        for (const GCodeProcessor::MoveVertex& move : gcode_result.moves) {
+            if (move.type == EMoveType::Extrude || move.type == EMoveType::Wipe) {
+                box.merge(move.position.cast<double>());
+                max_size = std::max(max_size, std::max(move.width, move.height));
+            }
+        }
+        if (box.defined) {
+            box.offset(double(max_size) + 1.0);
+            // snap the grid to a coarse cube, so that it does not change when the toolpaths change slightly
+            // and the cached chunks of the previous toolpaths can be reused
+            static const double GridSnap = 64.0;
+            const Vec3d min = ((box.min / GridSnap).array().floor() * GridSnap).matrix();
+            double extent = GridSnap;
+            while (min.x() + extent < box.max.x() || min.y() + extent < box.max.y() || min.z() + extent < box.max.z()) {
+                extent *= 2.0;
+            }
+            for (TBuffer& buffer : m_buffers) {
+                buffer.vertices.compressed = buffer.vertices.format == VBuffer::EFormat::PositionNormal3;
+                buffer.vertices.quantization_origin = (min + 0.5 * extent * Vec3d::Ones()).cast<float>();
+                buffer.vertices.quantization_step = static_cast<float>(0.5 * extent / 32767.0);
+            }
+        }
+        else {
+            for (TBuffer& buffer : m_buffers) {
+                buffer.vertices.compressed = false;
+            }
+        }
+    }
 
-    // toolpaths data -> extract vertices from result
+    // layers zs / roles / extruder ids / options zs -> extract from result
+    size_t last_travel_s_id = 0;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
-
-        // skip first vertex
-        if (i == 0)
-            continue;
-
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-
-        // update progress dialog
-        ++progress_count;
-        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
-            progress_dialog->Update(int(100.0f * float(i) / (2.0f * float(m_moves_count))),
-                _L("Generating vertex buffer") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
-            progress_dialog->Fit();
-            progress_count = 0;
+        const GCodeProcessor::MoveVertex move = gcode_result.moves[i];
+        if (move.type == EMoveType::Extrude) {
+            // layers zs
+            const double* const last_z = m_layers.empty() ? nullptr : &m_layers.get_zs().back();
+            double z = static_cast<double>(move.position[2]);
+            if (last_z == nullptr || z < *last_z - EPSILON || *last_z + EPSILON < z)
+                m_layers.append(z, { last_travel_s_id, i });
+            else
+                m_layers.get_endpoints().back().last = i;
+            // extruder ids
+            m_extruder_ids.emplace_back(move.extruder_id);
+            // roles
+            if (i > 0)
+                m_roles.emplace_back(move.extrusion_role);
         }
+        else if (move.type == EMoveType::Travel) {
+            if (i - last_travel_s_id > 1 && !m_layers.empty())
+                m_layers.get_endpoints().back().last = i;
 
-        unsigned char id = buffer_id(curr.type);
-        TBuffer& t_buffer = m_buffers[id];
-        MultiVertexBuffer& v_multibuffer = vertices[id];
+            last_travel_s_id = i;
+        }
+        else if (move.type == EMoveType::Pause_Print || move.type == EMoveType::Custom_GCode) {
+            // collect options zs for later use
+            const float* const last_z = m_options_zs.empty() ? nullptr : &m_options_zs.back();
+            if (last_z == nullptr || move.position[2] < *last_z - EPSILON || *last_z + EPSILON < move.position[2])
+                m_options_zs.emplace_back(move.position[2]);
+        }
+    }
 
-        // ensure there is at least one vertex buffer
-        if (v_multibuffer.empty())
-            v_multibuffer.push_back(VertexBuffer());
+    // roles -> remove duplicates
+    std::sort(m_roles.begin(), m_roles.end());
+    m_roles.erase(std::unique(m_roles.begin(), m_roles.end()), m_roles.end());
+    m_roles.shrink_to_fit();
 
-        // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
-        // add another vertex buffer
-        if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - t_buffer.max_vertices_per_segment_size_bytes()) {
-            v_multibuffer.push_back(VertexBuffer());
-            if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
-                Path& last_path = t_buffer.paths.back();
-                if (prev.type == curr.type && last_path.matches(curr))
-                    last_path.add_sub_path(prev, static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, i - 1);
-            }
-        }
+    // extruder ids -> remove duplicates
+    std::sort(m_extruder_ids.begin(), m_extruder_ids.end());
+    m_extruder_ids.erase(std::unique(m_extruder_ids.begin(), m_extruder_ids.end()), m_extruder_ids.end());
+    m_extruder_ids.shrink_to_fit();
 
-        VertexBuffer& v_buffer = v_multibuffer.back();
+    // set layers z range
+    if (!m_layers.empty())
+        m_layers_z_range = { 0, static_cast<unsigned int>(m_layers.size() - 1) };
 
-        switch (t_buffer.render_primitive_type)
-        {
-        case TBuffer::ERenderPrimitiveType::Point:    { add_vertices_as_point(curr, v_buffer); break; }
-        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
-        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, i); break; }
+    // split the moves into chunks of whole layers, the 1st move is a dummy move and it is skipped
+    std::vector<ToolpathsChunk> chunks;
+    if (m_moves_count > 1) {
+        size_t first_move = 1;
+        for (const Layers::Endpoints& endpoints : m_layers.get_endpoints()) {
+            if (endpoints.first > first_move && endpoints.first - first_move >= TOOLPATHS_CHUNK_MIN_MOVES) {
+                chunks.push_back({ first_move, endpoints.first - 1 });
+                first_move = endpoints.first;
+            }
         }
+        chunks.push_back({ first_move, m_moves_count - 1 });
+    }
 
-        // collect options zs for later use
-        if (curr.type == EMoveType::Pause_Print || curr.type == EMoveType::Custom_GCode) {
-            const float* const last_z = options_zs.empty() ? nullptr : &options_zs.back();
-            if (last_z == nullptr || curr.position[2] < *last_z - EPSILON || *last_z + EPSILON < curr.position[2])
-                options_zs.emplace_back(curr.position[2]);
+    // the hash covers also the move preceding the chunk, used to generate the 1st segment
+    for (ToolpathsChunk& chunk : chunks) {
+        GCodeProcessor::MoveVertices::const_iterator it(&gcode_result.moves, chunk.first_move - 1);
+        for (size_t i = chunk.first_move - 1; i <= chunk.last_move; ++i, ++it) {
+            const GCodeProcessor::MoveVertex move = *it;
+            boost::hash_combine(chunk.hash, static_cast<unsigned char>(move.type));
+            boost::hash_combine(chunk.hash, static_cast<unsigned char>(move.extrusion_role));
+            boost::hash_combine(chunk.hash, move.extruder_id);
+            boost::hash_combine(chunk.hash, move.cp_color_id);
+            boost::hash_combine(chunk.hash, move.position[0]);
+            boost::hash_combine(chunk.hash, move.position[1]);
+            boost::hash_combine(chunk.hash, move.position[2]);
+            boost::hash_combine(chunk.hash, move.delta_extruder);
+            boost::hash_combine(chunk.hash, move.feedrate);
+            boost::hash_combine(chunk.hash, move.width);
+            boost::hash_combine(chunk.hash, move.height);
+            boost::hash_combine(chunk.hash, move.mm3_per_mm);
+            boost::hash_combine(chunk.hash, move.fan_speed);
+            boost::hash_combine(chunk.hash, move.layer_duration);
+            boost::hash_combine(chunk.hash, move.time);
+            boost::hash_combine(chunk.hash, move.temperature);
         }
     }
 
@@ -1734,9 +1817,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             float half_width = 0.5f * path.width;
             for (size_t j = 1; j < path_vertices_count - 1; ++j) {
                 size_t curr_s_id = path.sub_paths.front().first.s_id + j;
-                const Vec3f& prev = gcode_result.moves[curr_s_id - 1].position;
-                const Vec3f& curr = gcode_result.moves[curr_s_id].position;
-                const Vec3f& next = gcode_result.moves[curr_s_id + 1].position;
+                const Vec3f& prev = gcode_result.moves.position(curr_s_id - 1);
+                const Vec3f& curr = gcode_result.moves.position(curr_s_id);
+                const Vec3f& next = gcode_result.moves.position(curr_s_id + 1);
 
                 // select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
@@ -1790,205 +1873,473 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
         }
     };
 
+    // variable used to keep track of the current vertex buffers index and size
+    using CurrVertexBuffer = std::pair<unsigned int, size_t>;
+    // variable used to keep track of the vertex buffers ids
+    using VboIndexList = std::vector<unsigned int>;
+
+    // vertices and indices data of a chunk, generated in parallel with the other chunks and then sent to gpu
+    struct ChunkData
+    {
+        // paths of the chunk, b_id of the sub paths are relative to the chunk buffers
+        std::vector<TBuffer> buffers;
+        std::vector<MultiVertexBuffer> vertices;
+        std::vector<MultiIndexBuffer> indices;
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+        // simplified indices for distant views, same layout as indices
+        std::vector<MultiIndexBuffer> lod_indices;
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+        // ids of the vertex buffers used by the index buffers, relative to the chunk
+        std::vector<VboIndexList> vbo_indices;
 #if ENABLE_GCODE_VIEWER_STATISTICS
-    auto load_vertices_time = std::chrono::high_resolution_clock::now();
-    m_statistics.load_vertices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+        int64_t load_vertices_time{ 0 };
+        int64_t smooth_vertices_time{ 0 };
+        int64_t load_indices_time{ 0 };
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
+    };
 
-    // smooth toolpaths corners for TBuffers using triangles
-    for (size_t i = 0; i < m_buffers.size(); ++i) {
-        const TBuffer& t_buffer = m_buffers[i];
-        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
-            smooth_triangle_toolpaths_corners(t_buffer, vertices[i]);
+    // generates the vertices and indices data of the given chunk,
+    // it does not access gpu nor the TBuffers' data, so it can run in parallel for several chunks
+    auto generate_chunk = [&](const ToolpathsChunk& chunk, ChunkData& data) {
+        data.buffers = std::vector<TBuffer>(m_buffers.size());
+        for (size_t i = 0; i < m_buffers.size(); ++i) {
+            data.buffers[i].render_primitive_type = m_buffers[i].render_primitive_type;
+            data.buffers[i].vertices.format = m_buffers[i].vertices.format;
         }
-    }
+        std::vector<TBuffer>& buffers = data.buffers;
+        std::vector<MultiVertexBuffer>& vertices = data.vertices;
+        std::vector<MultiIndexBuffer>& indices = data.indices;
+        vertices = std::vector<MultiVertexBuffer>(m_buffers.size());
+        indices = std::vector<MultiIndexBuffer>(m_buffers.size());
 
-    for (MultiVertexBuffer& v_multibuffer : vertices) {
-        for (VertexBuffer& v_buffer : v_multibuffer) {
-            v_buffer.shrink_to_fit();
-        }
-    }
+#if ENABLE_GCODE_VIEWER_STATISTICS
+        auto chunk_start_time = std::chrono::high_resolution_clock::now();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-    // move the wipe toolpaths half height up to render them on proper position
-    MultiVertexBuffer& wipe_vertices = vertices[buffer_id(EMoveType::Wipe)];
-    for (VertexBuffer& v_buffer : wipe_vertices) {
-        for (size_t i = 2; i < v_buffer.size(); i += 3) {
-            v_buffer[i] += 0.5f * GCodeProcessor::Wipe_Height;
-        }
-    }
+        // toolpaths data -> extract vertices from result
+        for (size_t i = chunk.first_move; i <= chunk.last_move; ++i) {
+            const GCodeProcessor::MoveVertex curr = gcode_result.moves[i];
+            const GCodeProcessor::MoveVertex prev = gcode_result.moves[i - 1];
+
+            unsigned char id = buffer_id(curr.type);
+            TBuffer& t_buffer = buffers[id];
+            MultiVertexBuffer& v_multibuffer = vertices[id];
+
+            // ensure there is at least one vertex buffer
+            if (v_multibuffer.empty())
+                v_multibuffer.push_back(VertexBuffer());
+
+            // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
+            // add another vertex buffer
+            if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - t_buffer.max_vertices_per_segment_size_bytes()) {
+                v_multibuffer.push_back(VertexBuffer());
+                if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+                    Path& last_path = t_buffer.paths.back();
+                    if (prev.type == curr.type && last_path.matches(curr))
+                        last_path.add_sub_path(prev, static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, i - 1);
+                }
+            }
 
-    // send vertices data to gpu
-    for (size_t i = 0; i < m_buffers.size(); ++i) {
-        TBuffer& t_buffer = m_buffers[i];
+            VertexBuffer& v_buffer = v_multibuffer.back();
 
-        const MultiVertexBuffer& v_multibuffer = vertices[i];
-        for (const VertexBuffer& v_buffer : v_multibuffer) {
-            size_t size_elements = v_buffer.size();
-            size_t size_bytes = size_elements * sizeof(float);
-            size_t vertices_count = size_elements / t_buffer.vertices.vertex_size_floats();
-            t_buffer.vertices.count += vertices_count;
+            switch (t_buffer.render_primitive_type)
+            {
+            case TBuffer::ERenderPrimitiveType::Point:    { add_vertices_as_point(curr, v_buffer); break; }
+            case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
+            case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, i); break; }
+            }
+        }
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
-            m_statistics.total_vertices_gpu_size += static_cast<int64_t>(size_bytes);
-            m_statistics.max_vbuffer_gpu_size = std::max(m_statistics.max_vbuffer_gpu_size, static_cast<int64_t>(size_bytes));
-            ++m_statistics.vbuffers_count;
+        auto load_vertices_time = std::chrono::high_resolution_clock::now();
+        data.load_vertices_time = std::chrono::duration_cast<std::chrono::milliseconds>(load_vertices_time - chunk_start_time).count();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-            GLuint id = 0;
-            glsafe(::glGenBuffers(1, &id));
-            t_buffer.vertices.vbos.push_back(static_cast<unsigned int>(id));
-            t_buffer.vertices.sizes.push_back(size_bytes);
-            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, id));
-            glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, v_buffer.data(), GL_STATIC_DRAW));
-            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+        // smooth toolpaths corners for TBuffers using triangles
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            const TBuffer& t_buffer = buffers[i];
+            if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+                smooth_triangle_toolpaths_corners(t_buffer, vertices[i]);
+            }
+        }
+
+        for (MultiVertexBuffer& v_multibuffer : vertices) {
+            for (VertexBuffer& v_buffer : v_multibuffer) {
+                v_buffer.shrink_to_fit();
+            }
+        }
+
+        // move the wipe toolpaths half height up to render them on proper position
+        MultiVertexBuffer& wipe_vertices = vertices[buffer_id(EMoveType::Wipe)];
+        for (VertexBuffer& v_buffer : wipe_vertices) {
+            for (size_t i = 2; i < v_buffer.size(); i += 3) {
+                v_buffer[i] += 0.5f * GCodeProcessor::Wipe_Height;
+            }
         }
-    }
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
-    auto smooth_vertices_time = std::chrono::high_resolution_clock::now();
-    m_statistics.smooth_vertices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - load_vertices_time).count();
+        auto smooth_vertices_time = std::chrono::high_resolution_clock::now();
+        data.smooth_vertices_time = std::chrono::duration_cast<std::chrono::milliseconds>(smooth_vertices_time - load_vertices_time).count();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
-    log_memory_usage("Loaded G-code generated vertex buffers ", vertices, indices);
 
-    // dismiss vertices data, no more needed
-    std::vector<MultiVertexBuffer>().swap(vertices);
-
-    // toolpaths data -> extract indices from result
-    // paths may have been filled while extracting vertices,
-    // so reset them, they will be filled again while extracting indices
-    for (TBuffer& buffer : m_buffers) {
-        buffer.paths.clear();
-    }
+        // toolpaths data -> extract indices from result
+        // paths may have been filled while extracting vertices,
+        // so reset them, they will be filled again while extracting indices
+        for (TBuffer& buffer : buffers) {
+            buffer.paths.clear();
+        }
 
-    // variable used to keep track of the current vertex buffers index and size
-    using CurrVertexBuffer = std::pair<unsigned int, size_t>;
-    std::vector<CurrVertexBuffer> curr_vertex_buffers(m_buffers.size(), { 0, 0 });
+        std::vector<CurrVertexBuffer> curr_vertex_buffers(m_buffers.size(), { 0, 0 });
+        std::vector<VboIndexList>& vbo_indices = data.vbo_indices;
+        vbo_indices = std::vector<VboIndexList>(m_buffers.size());
+        PrevSegment prev_segment;
 
-    // variable used to keep track of the vertex buffers ids
-    using VboIndexList = std::vector<unsigned int>;
-    std::vector<VboIndexList> vbo_indices(m_buffers.size());
+        for (size_t i = chunk.first_move; i <= chunk.last_move; ++i) {
+            const GCodeProcessor::MoveVertex curr = gcode_result.moves[i];
+            const GCodeProcessor::MoveVertex prev = gcode_result.moves[i - 1];
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+            // paths are closed at the chunk end
+            GCodeProcessor::MoveVertex next_move;
+            const GCodeProcessor::MoveVertex* next = nullptr;
+            if (i < chunk.last_move) {
+                next_move = gcode_result.moves[i + 1];
+                next = &next_move;
+            }
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+            unsigned char id = buffer_id(curr.type);
+            TBuffer& t_buffer = buffers[id];
+            MultiIndexBuffer& i_multibuffer = indices[id];
+            CurrVertexBuffer& curr_vertex_buffer = curr_vertex_buffers[id];
+            VboIndexList& vbo_index_list = vbo_indices[id];
 
-        // skip first vertex
-        if (i == 0)
-            continue;
+            // ensure there is at least one index buffer
+            if (i_multibuffer.empty()) {
+                i_multibuffer.push_back(IndexBuffer());
+                vbo_index_list.push_back(curr_vertex_buffer.first);
+            }
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
+            // if adding the indices for the current segment exceeds the threshold size of the current index buffer
+            // create another index buffer
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
-        const GCodeProcessor::MoveVertex* next = nullptr;
-        if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
+            if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - t_buffer.max_indices_per_segment_size_bytes()) {
+#else
+            if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - t_buffer.indices_per_segment_size_bytes()) {
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+                i_multibuffer.push_back(IndexBuffer());
+                vbo_index_list.push_back(curr_vertex_buffer.first);
+                if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Point) {
+                    Path& last_path = t_buffer.paths.back();
+                    last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, i - 1);
+                }
+            }
 
-        ++progress_count;
-        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
-            progress_dialog->Update(int(100.0f * float(m_moves_count + i) / (2.0f * float(m_moves_count))),
-                _L("Generating index buffers") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
-            progress_dialog->Fit();
-            progress_count = 0;
-        }
+            // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
+            // create another index buffer
+            if (curr_vertex_buffer.second * t_buffer.vertices.vertex_size_bytes() > t_buffer.vertices.max_size_bytes() - t_buffer.max_vertices_per_segment_size_bytes()) {
+                i_multibuffer.push_back(IndexBuffer());
 
-        unsigned char id = buffer_id(curr.type);
-        TBuffer& t_buffer = m_buffers[id];
-        MultiIndexBuffer& i_multibuffer = indices[id];
-        CurrVertexBuffer& curr_vertex_buffer = curr_vertex_buffers[id];
-        VboIndexList& vbo_index_list = vbo_indices[id];
+                ++curr_vertex_buffer.first;
+                curr_vertex_buffer.second = 0;
+                vbo_index_list.push_back(curr_vertex_buffer.first);
 
-        // ensure there is at least one index buffer
-        if (i_multibuffer.empty()) {
-            i_multibuffer.push_back(IndexBuffer());
-            vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
-        }
+                if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Point) {
+                    Path& last_path = t_buffer.paths.back();
+                    last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, i - 1);
+                }
+            }
 
-        // if adding the indices for the current segment exceeds the threshold size of the current index buffer
-        // create another index buffer
+            IndexBuffer& i_buffer = i_multibuffer.back();
+
+            switch (t_buffer.render_primitive_type)
+            {
+            case TBuffer::ERenderPrimitiveType::Point: {
+                add_indices_as_point(curr, t_buffer, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i);
+                curr_vertex_buffer.second += t_buffer.max_vertices_per_segment();
+                break;
+            }
+            case TBuffer::ERenderPrimitiveType::Line: {
+                add_indices_as_line(prev, curr, t_buffer, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i);
+                curr_vertex_buffer.second += t_buffer.max_vertices_per_segment();
+                break;
+            }
+            case TBuffer::ERenderPrimitiveType::Triangle: {
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
-        if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - t_buffer.max_indices_per_segment_size_bytes()) {
+                add_indices_as_solid(prev, curr, next, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i, prev_segment);
 #else
-        if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - t_buffer.indices_per_segment_size_bytes()) {
+                add_indices_as_solid(prev, curr, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i, prev_segment);
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
-            i_multibuffer.push_back(IndexBuffer());
-            vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
-            if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Point) {
-                Path& last_path = t_buffer.paths.back();
-                last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, i - 1);
+                break;
+            }
             }
         }
 
-        // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
-        // create another index buffer
-        if (curr_vertex_buffer.second * t_buffer.vertices.vertex_size_bytes() > t_buffer.vertices.max_size_bytes() - t_buffer.max_vertices_per_segment_size_bytes()) {
-            i_multibuffer.push_back(IndexBuffer());
-
-            ++curr_vertex_buffer.first;
-            curr_vertex_buffer.second = 0;
-            vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+        for (MultiIndexBuffer& i_multibuffer : indices) {
+            for (IndexBuffer& i_buffer : i_multibuffer) {
+                i_buffer.shrink_to_fit();
+            }
+        }
 
-            if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Point) {
-                Path& last_path = t_buffer.paths.back();
-                last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, i - 1);
+        // toolpaths data -> bounding boxes of the sub paths, to cull them while rendering
+        for (TBuffer& t_buffer : buffers) {
+            for (Path& path : t_buffer.paths) {
+                // the segments are extruded around the moves positions, wipes are moved up
+                double margin = 0.5 * double(std::max(path.width, path.height)) + 0.5 * double(GCodeProcessor::Wipe_Height);
+                for (Path::Sub_Path& sub_path : path.sub_paths) {
+                    // the first segment starts at the previous move
+                    for (size_t s_id = std::max<size_t>(sub_path.first.s_id, 1) - 1; s_id <= sub_path.last.s_id; ++s_id) {
+                        sub_path.bounding_box.merge(gcode_result.moves[s_id].position.cast<double>());
+                    }
+                    sub_path.bounding_box.offset(margin);
+                }
             }
         }
 
-        IndexBuffer& i_buffer = i_multibuffer.back();
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+        // toolpaths data -> simplified indices for distant views
+        // they keep the layout of the full indices, so that the render paths are valid for both of them,
+        // the corner caps and the lower faces of the stems are collapsed into degenerate triangles
+        auto collapse_triangles = [](IndexBuffer& indices, size_t first, size_t count) {
+            for (size_t i = first; i < first + count; ++i) {
+                indices[i] = indices[first];
+            }
+        };
+        std::vector<MultiIndexBuffer>& lod_indices = data.lod_indices;
+        lod_indices = std::vector<MultiIndexBuffer>(m_buffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            const TBuffer& t_buffer = buffers[i];
+            if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Triangle)
+                continue;
 
-        switch (t_buffer.render_primitive_type)
-        {
-        case TBuffer::ERenderPrimitiveType::Point: {
-            add_indices_as_point(curr, t_buffer, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i);
-            curr_vertex_buffer.second += t_buffer.max_vertices_per_segment();
-            break;
+            const unsigned int indices_per_segment = t_buffer.indices_per_segment();
+            MultiIndexBuffer& lod_multibuffer = lod_indices[i];
+            lod_multibuffer = indices[i];
+            for (const Path& path : t_buffer.paths) {
+                for (size_t j = 0; j < path.sub_paths.size(); ++j) {
+                    const Path::Sub_Path& sub_path = path.sub_paths[j];
+                    IndexBuffer& lod_buffer = lod_multibuffer[sub_path.first.b_id];
+                    size_t offset = sub_path.first.i_id;
+                    if (j == 0)
+                        offset += 6; // skip 2 triangles for starting cap
+                    // each segment is made of 2 triangles for the corner cap followed by 8 triangles for the stem,
+                    // the 2nd and 3rd pair of the stem triangles are the faces below the extrusion axis
+                    for (size_t s_id = sub_path.first.s_id; s_id < sub_path.last.s_id; ++s_id) {
+                        collapse_triangles(lod_buffer, offset, 6);
+                        collapse_triangles(lod_buffer, offset + 12, 12);
+                        offset += indices_per_segment;
+                    }
+                }
+            }
         }
-        case TBuffer::ERenderPrimitiveType::Line: {
-            add_indices_as_line(prev, curr, t_buffer, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i);
-            curr_vertex_buffer.second += t_buffer.max_vertices_per_segment();
-            break;
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+        data.load_indices_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - smooth_vertices_time).count();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+    };
+
+    // sends the data of the given chunk to gpu, appending them to the TBuffers
+    auto upload_chunk = [this](ToolpathsChunk& chunk, ChunkData& data) {
+        chunk.ranges = std::vector<ToolpathsChunk::Range>(m_buffers.size());
+        for (size_t i = 0; i < m_buffers.size(); ++i) {
+            TBuffer& t_buffer = m_buffers[i];
+            ToolpathsChunk::Range& range = chunk.ranges[i];
+
+            // toolpaths data -> send vertices data to gpu
+            range.vbos_first = t_buffer.vertices.vbos.size();
+            range.vbos_count = data.vertices[i].size();
+            std::vector<VBuffer::CompressedVertex> compressed_buffer;
+            for (const VertexBuffer& v_buffer : data.vertices[i]) {
+                size_t size_elements = v_buffer.size();
+                size_t vertices_count = size_elements / t_buffer.vertices.vertex_size_floats();
+                size_t size_bytes = vertices_count * t_buffer.vertices.gpu_vertex_size_bytes();
+                range.vertices_count += vertices_count;
+
+                const void* gpu_data = v_buffer.data();
+                if (t_buffer.vertices.compressed) {
+                    // quantize positions on the grid and normals to bytes
+                    const float inv_step = 1.0f / t_buffer.vertices.quantization_step;
+                    compressed_buffer.resize(vertices_count);
+                    for (size_t j = 0; j < vertices_count; ++j) {
+                        const float* src = v_buffer.data() + j * 6;
+                        VBuffer::CompressedVertex& dst = compressed_buffer[j];
+                        for (size_t k = 0; k < 3; ++k) {
+                            dst.position[k] = static_cast<int16_t>(std::clamp(std::lround((src[k] - t_buffer.vertices.quantization_origin[k]) * inv_step), -32767L, 32767L));
+                            dst.normal[k] = static_cast<int8_t>(std::clamp(std::lround(src[3 + k] * 127.0f), -127L, 127L));
+                        }
+                        dst.position[3] = 0;
+                        dst.normal[3] = 0;
+                    }
+                    gpu_data = compressed_buffer.data();
+                }
+
+                GLuint id = 0;
+                glsafe(::glGenBuffers(1, &id));
+                t_buffer.vertices.vbos.push_back(static_cast<unsigned int>(id));
+                t_buffer.vertices.sizes.push_back(size_bytes);
+                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, id));
+                glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, gpu_data, GL_STATIC_DRAW));
+                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+            }
+            t_buffer.vertices.count += range.vertices_count;
+
+            // dismiss vertices data, no more needed
+            MultiVertexBuffer().swap(data.vertices[i]);
+
+            // toolpaths data -> send indices data to gpu
+            range.ibuffers_first = t_buffer.indices.size();
+            range.ibuffers_count = data.indices[i].size();
+            for (size_t j = 0; j < data.indices[i].size(); ++j) {
+                const IndexBuffer& i_buffer = data.indices[i][j];
+                size_t size_elements = i_buffer.size();
+                size_t size_bytes = size_elements * sizeof(IBufferType);
+
+                // stores index buffer informations into TBuffer
+                t_buffer.indices.push_back(IBuffer());
+                IBuffer& ibuf = t_buffer.indices.back();
+                ibuf.count = size_elements;
+                ibuf.vbo = t_buffer.vertices.vbos[range.vbos_first + data.vbo_indices[i][j]];
+
+                glsafe(::glGenBuffers(1, &ibuf.ibo));
+                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.ibo));
+                glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_bytes, i_buffer.data(), GL_STATIC_DRAW));
+                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+                if (!data.lod_indices[i].empty()) {
+                    glsafe(::glGenBuffers(1, &ibuf.lod_ibo));
+                    glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.lod_ibo));
+                    glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_bytes, data.lod_indices[i][j].data(), GL_STATIC_DRAW));
+                    glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+                }
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+            }
+
+            // dismiss indices data, no more needed
+            MultiIndexBuffer().swap(data.indices[i]);
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+            MultiIndexBuffer().swap(data.lod_indices[i]);
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+
+            // stores the paths into TBuffer, making their sub paths relative to TBuffer::indices
+            range.paths_first = t_buffer.paths.size();
+            range.paths_count = data.buffers[i].paths.size();
+            for (Path& path : data.buffers[i].paths) {
+                for (Path::Sub_Path& sub_path : path.sub_paths) {
+                    sub_path.first.b_id += static_cast<unsigned int>(range.ibuffers_first);
+                    sub_path.last.b_id += static_cast<unsigned int>(range.ibuffers_first);
+                }
+                t_buffer.paths.emplace_back(std::move(path));
+            }
         }
-        case TBuffer::ERenderPrimitiveType::Triangle: {
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+        m_statistics.load_vertices += data.load_vertices_time;
+        m_statistics.smooth_vertices += data.smooth_vertices_time;
+        m_statistics.load_indices += data.load_indices_time;
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+    };
+
+    // appends the data of the given chunk of the previously loaded toolpaths to the TBuffers
+    auto reuse_chunk = [this](ToolpathsChunk& chunk, const ToolpathsChunk& cached_chunk) {
+        chunk.ranges = std::vector<ToolpathsChunk::Range>(m_buffers.size());
+        for (size_t i = 0; i < m_buffers.size(); ++i) {
+            TBuffer& t_buffer = m_buffers[i];
+            ToolpathsCache::Buffer& c_buffer = m_toolpaths_cache.buffers[i];
+            const ToolpathsChunk::Range& cached_range = cached_chunk.ranges[i];
+            ToolpathsChunk::Range& range = chunk.ranges[i];
+            range = { t_buffer.vertices.vbos.size(), cached_range.vbos_count, t_buffer.indices.size(), cached_range.ibuffers_count,
+                t_buffer.paths.size(), cached_range.paths_count, cached_range.vertices_count };
+
+            // the gpu data are moved from the cache, zero ids are not released by ToolpathsCache::reset()
+            for (size_t j = 0; j < cached_range.vbos_count; ++j) {
+                unsigned int& vbo = c_buffer.vbos[cached_range.vbos_first + j];
+                t_buffer.vertices.vbos.push_back(vbo);
+                t_buffer.vertices.sizes.push_back(c_buffer.sizes[cached_range.vbos_first + j]);
+                vbo = 0;
+            }
+            t_buffer.vertices.count += cached_range.vertices_count;
+            for (size_t j = 0; j < cached_range.ibuffers_count; ++j) {
+                IBuffer& ibuf = c_buffer.indices[cached_range.ibuffers_first + j];
+                t_buffer.indices.push_back(ibuf);
+                ibuf.ibo = 0;
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
-            add_indices_as_solid(prev, curr, next, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i);
-#else
-            add_indices_as_solid(prev, curr, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, i);
+                ibuf.lod_ibo = 0;
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+            }
+            for (size_t j = 0; j < cached_range.paths_count; ++j) {
+                Path& path = c_buffer.paths[cached_range.paths_first + j];
+                for (Path::Sub_Path& sub_path : path.sub_paths) {
+                    sub_path.first.b_id = static_cast<unsigned int>(sub_path.first.b_id - cached_range.ibuffers_first + range.ibuffers_first);
+                    sub_path.last.b_id = static_cast<unsigned int>(sub_path.last.b_id - cached_range.ibuffers_first + range.ibuffers_first);
+                }
+                t_buffer.paths.emplace_back(std::move(path));
+            }
+        }
+    };
+
+    // search for the cached chunks which can be reused, a cached chunk can be reused only once
+    std::vector<int> cached_ids(chunks.size(), -1);
+    std::vector<bool> cached_used(m_toolpaths_cache.chunks.size(), false);
+    // the cached vertices are usable only if they were quantized on the same grid
+    for (size_t i = 0; i < m_toolpaths_cache.buffers.size() && i < m_buffers.size(); ++i) {
+        const ToolpathsCache::Buffer& c_buffer = m_toolpaths_cache.buffers[i];
+        const VBuffer& vertices = m_buffers[i].vertices;
+        if (c_buffer.compressed != vertices.compressed || (vertices.compressed &&
+            (c_buffer.quantization_origin != vertices.quantization_origin || c_buffer.quantization_step != vertices.quantization_step))) {
+            std::fill(cached_used.begin(), cached_used.end(), true);
             break;
         }
+    }
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        for (size_t j = 0; j < m_toolpaths_cache.chunks.size(); ++j) {
+            if (!cached_used[j] && m_toolpaths_cache.chunks[j].matches(chunks[i])) {
+                cached_ids[i] = static_cast<int>(j);
+                cached_used[j] = true;
+                break;
+            }
         }
     }
 
-    for (MultiIndexBuffer& i_multibuffer : indices) {
-        for (IndexBuffer& i_buffer : i_multibuffer) {
-            i_buffer.shrink_to_fit();
+    // the chunks to be regenerated are processed in batches: the data of the chunks of a batch are generated
+    // in parallel, then sent to gpu and appended to the TBuffers by this thread, keeping the order of the chunks
+    const size_t batch_size = 2 * static_cast<size_t>(std::max(1, tbb::task_scheduler_init::default_num_threads()));
+    for (size_t i = 0; i < chunks.size();) {
+        if (cached_ids[i] != -1) {
+            reuse_chunk(chunks[i], m_toolpaths_cache.chunks[cached_ids[i]]);
+            ++i;
+            continue;
         }
-    }
 
-    // toolpaths data -> send indices data to gpu
-    for (size_t i = 0; i < m_buffers.size(); ++i) {
-        TBuffer& t_buffer = m_buffers[i];
-        const MultiIndexBuffer& i_multibuffer = indices[i];
-        for (const IndexBuffer& i_buffer : i_multibuffer) {
-            size_t size_elements = i_buffer.size();
-            size_t size_bytes = size_elements * sizeof(IBufferType);
-
-            // stores index buffer informations into TBuffer
-            t_buffer.indices.push_back(IBuffer());
-            IBuffer& ibuf = t_buffer.indices.back();
-            ibuf.count = size_elements;
-            ibuf.vbo = vbo_indices[i][t_buffer.indices.size() - 1];
+        size_t batch_end = i + 1;
+        while (batch_end < chunks.size() && batch_end - i < batch_size && cached_ids[batch_end] == -1) {
+            ++batch_end;
+        }
 
-#if ENABLE_GCODE_VIEWER_STATISTICS
-            m_statistics.total_indices_gpu_size += static_cast<int64_t>(size_bytes);
-            m_statistics.max_ibuffer_gpu_size = std::max(m_statistics.max_ibuffer_gpu_size, static_cast<int64_t>(size_bytes));
-            ++m_statistics.ibuffers_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
+        // update progress dialog
+        if (progress_dialog != nullptr) {
+            progress_dialog->Update(int(100.0f * float(chunks[i].first_move) / float(m_moves_count)),
+                _L("Generating toolpaths") + ": " + wxNumberFormatter::ToString(100.0 * double(chunks[i].first_move) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
+            progress_dialog->Fit();
+        }
 
-            glsafe(::glGenBuffers(1, &ibuf.ibo));
-            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.ibo));
-            glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_bytes, i_buffer.data(), GL_STATIC_DRAW));
-            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+        std::vector<ChunkData> batch(batch_end - i);
+        tbb::parallel_for(tbb::blocked_range<size_t>(i, batch_end, 1),
+            [&chunks, &batch, &generate_chunk, i](const tbb::blocked_range<size_t>& range) {
+                for (size_t j = range.begin(); j < range.end(); ++j) {
+                    generate_chunk(chunks[j], batch[j - i]);
+                }
+            });
+
+        for (size_t j = i; j < batch_end; ++j) {
+            upload_chunk(chunks[j], batch[j - i]);
         }
+        i = batch_end;
     }
+    m_toolpaths_chunks = std::move(chunks);
+
+    // release the gpu memory of the cached chunks which have not been reused
+    m_toolpaths_cache.reset();
 
     if (progress_dialog != nullptr) {
         progress_dialog->Update(100, "");
@@ -1997,90 +2348,42 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     for (const TBuffer& buffer : m_buffers) {
+        for (size_t size_bytes : buffer.vertices.sizes) {
+            m_statistics.total_vertices_gpu_size += static_cast<int64_t>(size_bytes);
+            m_statistics.max_vbuffer_gpu_size = std::max(m_statistics.max_vbuffer_gpu_size, static_cast<int64_t>(size_bytes));
+            ++m_statistics.vbuffers_count;
+        }
+        for (const IBuffer& ibuf : buffer.indices) {
+            int64_t size_bytes = static_cast<int64_t>(ibuf.count * sizeof(IBufferType));
+            m_statistics.total_indices_gpu_size += size_bytes;
+            m_statistics.max_ibuffer_gpu_size = std::max(m_statistics.max_ibuffer_gpu_size, size_bytes);
+            ++m_statistics.ibuffers_count;
+        }
         m_statistics.paths_size += SLIC3R_STDVEC_MEMSIZE(buffer.paths, Path);
     }
 
     auto update_segments_count = [&](EMoveType type, int64_t& count) {
-        unsigned int id = buffer_id(type);
-        const MultiIndexBuffer& buffers = indices[id];
-#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+        const TBuffer& t_buffer = m_buffers[buffer_id(type)];
         int64_t indices_count = 0;
-        for (const IndexBuffer& buffer : buffers) {
-            indices_count += buffer.size();
+        for (const IBuffer& ibuf : t_buffer.indices) {
+            indices_count += static_cast<int64_t>(ibuf.count);
         }
-        const TBuffer& t_buffer = m_buffers[id];
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
         if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle)
             indices_count -= static_cast<int64_t>(12 * t_buffer.paths.size()); // remove the starting + ending caps = 4 triangles
-
-        count += indices_count / t_buffer.indices_per_segment();
-#else
-        for (const IndexBuffer& buffer : buffers) {
-            count += buffer.size() / m_buffers[id].indices_per_segment();
-        }
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+        count += indices_count / t_buffer.indices_per_segment();
     };
 
     update_segments_count(EMoveType::Travel, m_statistics.travel_segments_count);
     update_segments_count(EMoveType::Wipe, m_statistics.wipe_segments_count);
     update_segments_count(EMoveType::Extrude, m_statistics.extrude_segments_count);
-
-    m_statistics.load_indices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - smooth_vertices_time).count();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-    log_memory_usage("Loaded G-code generated indices buffers ", vertices, indices);
-
-    // dismiss indices data, no more needed
-    std::vector<MultiIndexBuffer>().swap(indices);
-
-    // layers zs / roles / extruder ids -> extract from result
-    size_t last_travel_s_id = 0;
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
-        if (move.type == EMoveType::Extrude) {
-            // layers zs
-            const double* const last_z = m_layers.empty() ? nullptr : &m_layers.get_zs().back();
-            double z = static_cast<double>(move.position[2]);
-            if (last_z == nullptr || z < *last_z - EPSILON || *last_z + EPSILON < z)
-                m_layers.append(z, { last_travel_s_id, i });
-            else
-                m_layers.get_endpoints().back().last = i;
-            // extruder ids
-            m_extruder_ids.emplace_back(move.extruder_id);
-            // roles
-            if (i > 0)
-                m_roles.emplace_back(move.extrusion_role);
-        }
-        else if (move.type == EMoveType::Travel) {
-            if (i - last_travel_s_id > 1 && !m_layers.empty())
-                m_layers.get_endpoints().back().last = i;
-
-            last_travel_s_id = i;
-        }
-    }
-
-    // roles -> remove duplicates
-    std::sort(m_roles.begin(), m_roles.end());
-    m_roles.erase(std::unique(m_roles.begin(), m_roles.end()), m_roles.end());
-    m_roles.shrink_to_fit();
-
-    // extruder ids -> remove duplicates
-    std::sort(m_extruder_ids.begin(), m_extruder_ids.end());
-    m_extruder_ids.erase(std::unique(m_extruder_ids.begin(), m_extruder_ids.end()), m_extruder_ids.end());
-    m_extruder_ids.shrink_to_fit();
-
-    // set layers z range
-    if (!m_layers.empty())
-        m_layers_z_range = { 0, static_cast<unsigned int>(m_layers.size() - 1) };
+    log_memory_used("Loaded G-code generated toolpaths ");
 
     // change color of paths whose layer contains option points
-    if (!options_zs.empty()) {
-        TBuffer& extrude_buffer = m_buffers[buffer_id(EMoveType::Extrude)];
-        for (Path& path : extrude_buffer.paths) {
-            float z = path.sub_paths.front().first.position[2];
-            if (std::find_if(options_zs.begin(), options_zs.end(), [z](float f) { return f - EPSILON <= z && z <= f + EPSILON; }) != options_zs.end())
-                path.cp_color_id = 255 - path.cp_color_id;
-        }
-    }
+    toggle_options_layers_color();
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     m_statistics.load_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
@@ -2094,7 +2397,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 {
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessor::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memory_size();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -2112,7 +2415,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     m_extruders_count = gcode_result.extruders_count;
 
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
+        const GCodeProcessor::MoveVertex move = gcode_result.moves[i];
         if (wxGetApp().is_gcode_viewer())
             // for the gcode viewer we need all moves to correctly size the printbed
             m_paths_bounding_box.merge(move.position.cast<double>());
@@ -2495,8 +2798,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             progress_count = 0;
         }
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessor::MoveVertex prev = gcode_result.moves[i - 1];
+        const GCodeProcessor::MoveVertex curr = gcode_result.moves[i];
 
         unsigned char id = buffer_id(curr.type);
         TBuffer& buffer = m_buffers[id];
@@ -2583,8 +2886,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             progress_count = 0;
         }
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessor::MoveVertex prev = gcode_result.moves[i - 1];
+        const GCodeProcessor::MoveVertex curr = gcode_result.moves[i];
 
         unsigned char id = buffer_id(curr.type);
         TBuffer& buffer = m_buffers[id];
@@ -2693,7 +2996,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     // layers zs / roles / extruder ids / cp color ids -> extract from result
     size_t last_travel_s_id = 0;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
+        const GCodeProcessor::MoveVertex move = gcode_result.moves[i];
         if (move.type == EMoveType::Extrude) {
             // layers zs
             const double* const last_z = m_layers.empty() ? nullptr : &m_layers.get_zs().back();
@@ -2751,6 +3054,21 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 }
 #endif // ENABLE_SPLITTED_VERTEX_BUFFER
 
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+void GCodeViewer::toggle_options_layers_color()
+{
+    if (m_options_zs.empty())
+        return;
+
+    TBuffer& extrude_buffer = m_buffers[buffer_id(EMoveType::Extrude)];
+    for (Path& path : extrude_buffer.paths) {
+        float z = path.sub_paths.front().first.position[2];
+        if (std::find_if(m_options_zs.begin(), m_options_zs.end(), [z](float f) { return f - EPSILON <= z && z <= f + EPSILON; }) != m_options_zs.end())
+            path.cp_color_id = 255 - path.cp_color_id;
+    }
+}
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
+
 void GCodeViewer::load_shells(const Print& print, bool initialized)
 {
     if (print.objects().empty())
@@ -2995,7 +3313,13 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
 
                     // gets the position from the vertices buffer on gpu
                     glsafe(::glBindBuffer(GL_ARRAY_BUFFER, i_buffer.vbo));
-                    glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(index * buffer.vertices.vertex_size_bytes()), static_cast<GLsizeiptr>(3 * sizeof(float)), static_cast<void*>(sequential_view->current_position.data())));
+                    if (buffer.vertices.compressed) {
+                        VBuffer::CompressedVertex vertex;
+                        glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(index * sizeof(VBuffer::CompressedVertex)), static_cast<GLsizeiptr>(sizeof(VBuffer::CompressedVertex)), static_cast<void*>(&vertex)));
+                        sequential_view->current_position = buffer.vertices.dequantize(vertex.position);
+                    }
+                    else
+                        glsafe(::glGetBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(index * buffer.vertices.vertex_size_bytes()), static_cast<GLsizeiptr>(3 * sizeof(float)), static_cast<void*>(sequential_view->current_position.data())));
                     glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
 
                     found = true;
@@ -3133,6 +3457,7 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 
         render_path->offsets.push_back(static_cast<size_t>((sub_path.first.i_id + delta_1st) * sizeof(IBufferType)));
+        render_path->bounding_boxes.push_back(sub_path.bounding_box);
 
 #if 0
         // check sizes and offsets against index buffer size on gpu
@@ -3557,7 +3882,43 @@ void GCodeViewer::render_toolpaths() const
         shader.set_uniform("uniform_color", color4);
     };
 
-    auto render_as_points = [this, zoom, point_size, near_plane_height, set_uniform_color]
+    // planes of the view frustum in world coordinates, extracted from the projection * view matrix
+    const Eigen::Matrix4d clip_matrix = camera.get_projection_matrix().matrix() * camera.get_view_matrix().matrix();
+    std::array<Eigen::Vector4d, 6> frustum_planes;
+    for (int i = 0; i < 3; ++i) {
+        frustum_planes[2 * i] = clip_matrix.row(3).transpose() + clip_matrix.row(i).transpose();
+        frustum_planes[2 * i + 1] = clip_matrix.row(3).transpose() - clip_matrix.row(i).transpose();
+    }
+
+    auto is_in_frustum = [&frustum_planes](const BoundingBoxf3& box) {
+        for (const Eigen::Vector4d& plane : frustum_planes) {
+            // the box is outside if its corner farthest along the plane normal is behind the plane
+            const Vec3d corner = { plane[0] >= 0.0 ? box.max.x() : box.min.x(),
+                                   plane[1] >= 0.0 ? box.max.y() : box.min.y(),
+                                   plane[2] >= 0.0 ? box.max.z() : box.min.z() };
+            if (plane.head<3>().dot(corner) + plane[3] < 0.0)
+                return false;
+        }
+        return true;
+    };
+
+    // renders the sub paths of the given render path which intersect the view frustum
+    std::vector<GLsizei> visible_sizes;
+    std::vector<size_t> visible_offsets;
+    auto multi_draw_visible = [&is_in_frustum, &visible_sizes, &visible_offsets](GLenum mode, const RenderPath& path) {
+        visible_sizes.clear();
+        visible_offsets.clear();
+        for (size_t i = 0; i < path.sizes.size(); ++i) {
+            if (is_in_frustum(path.bounding_boxes[i])) {
+                visible_sizes.push_back(static_cast<GLsizei>(path.sizes[i]));
+                visible_offsets.push_back(path.offsets[i]);
+            }
+        }
+        if (!visible_sizes.empty())
+            glsafe(::glMultiDrawElements(mode, visible_sizes.data(), GL_UNSIGNED_SHORT, (const void* const*)visible_offsets.data(), (GLsizei)visible_sizes.size()));
+    };
+
+    auto render_as_points = [this, zoom, point_size, near_plane_height, set_uniform_color, &multi_draw_visible]
         (const TBuffer& buffer, unsigned int ibuffer_id, GLShaderProgram& shader) {
 #if ENABLE_FIXED_SCREEN_SIZE_POINT_MARKERS
         shader.set_uniform("use_fixed_screen_size", 1);
@@ -3576,7 +3937,7 @@ void GCodeViewer::render_toolpaths() const
         for (const RenderPath& path : buffer.render_paths) {
             if (path.ibuffer_id == ibuffer_id) {
                 set_uniform_color(path.color, shader);
-                glsafe(::glMultiDrawElements(GL_POINTS, (const GLsizei*)path.sizes.data(), GL_UNSIGNED_SHORT, (const void* const*)path.offsets.data(), (GLsizei)path.sizes.size()));
+                multi_draw_visible(GL_POINTS, path);
 #if ENABLE_GCODE_VIEWER_STATISTICS
                 ++const_cast<Statistics*>(&m_statistics)->gl_multi_points_calls_count;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -3587,12 +3948,12 @@ void GCodeViewer::render_toolpaths() const
         glsafe(::glDisable(GL_VERTEX_PROGRAM_POINT_SIZE));
     };
 
-    auto render_as_lines = [this, light_intensity, set_uniform_color](const TBuffer& buffer, unsigned int ibuffer_id, GLShaderProgram& shader) {
+    auto render_as_lines = [this, light_intensity, set_uniform_color, &multi_draw_visible](const TBuffer& buffer, unsigned int ibuffer_id, GLShaderProgram& shader) {
         shader.set_uniform("light_intensity", light_intensity);
         for (const RenderPath& path : buffer.render_paths) {
             if (path.ibuffer_id == ibuffer_id) {
                 set_uniform_color(path.color, shader);
-                glsafe(::glMultiDrawElements(GL_LINES, (const GLsizei*)path.sizes.data(), GL_UNSIGNED_SHORT, (const void* const*)path.offsets.data(), (GLsizei)path.sizes.size()));
+                multi_draw_visible(GL_LINES, path);
 #if ENABLE_GCODE_VIEWER_STATISTICS
                 ++const_cast<Statistics*>(&m_statistics)->gl_multi_lines_calls_count;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -3600,11 +3961,11 @@ void GCodeViewer::render_toolpaths() const
         }
     };
 
-    auto render_as_triangles = [this, set_uniform_color](const TBuffer& buffer, unsigned int ibuffer_id, GLShaderProgram& shader) {
+    auto render_as_triangles = [this, set_uniform_color, &multi_draw_visible](const TBuffer& buffer, unsigned int ibuffer_id, GLShaderProgram& shader) {
         for (const RenderPath& path : buffer.render_paths) {
             if (path.ibuffer_id == ibuffer_id) {
                 set_uniform_color(path.color, shader);
-                glsafe(::glMultiDrawElements(GL_TRIANGLES, (const GLsizei*)path.sizes.data(), GL_UNSIGNED_SHORT, (const void* const*)path.offsets.data(), (GLsizei)path.sizes.size()));
+                multi_draw_visible(GL_TRIANGLES, path);
 #if ENABLE_GCODE_VIEWER_STATISTICS
                 ++const_cast<Statistics*>(&m_statistics)->gl_multi_triangles_calls_count;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -3618,6 +3979,15 @@ void GCodeViewer::render_toolpaths() const
 
     glsafe(::glLineWidth(static_cast<GLfloat>(line_width(zoom))));
 
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+    // the simplified toolpaths are used while the extrusions are thinner than a couple of pixels,
+    // unless the user is inspecting a range of layers or of moves
+    static const double LOD_MAX_ZOOM = 4.0;
+    const bool use_lod = zoom < LOD_MAX_ZOOM && !m_layers.empty() &&
+        m_layers_z_range[0] == 0 && m_layers_z_range[1] == static_cast<unsigned int>(m_layers.size() - 1) &&
+        m_sequential_view.current.first == m_sequential_view.endpoints.first && m_sequential_view.current.last == m_sequential_view.endpoints.last;
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+
     unsigned char begin_id = buffer_id(EMoveType::Retract);
     unsigned char end_id = buffer_id(EMoveType::Count);
 
@@ -3630,19 +4000,28 @@ void GCodeViewer::render_toolpaths() const
         if (shader != nullptr) {
             shader->start_using();
 
+            if (buffer.vertices.compressed) {
+                glsafe(::glPushMatrix());
+                glsafe(::glMultMatrixd(buffer.vertices.dequantization_matrix().data()));
+            }
+
             for (size_t j = 0; j < buffer.indices.size(); ++j) {
                 const IBuffer& i_buffer = buffer.indices[j];
 
                 glsafe(::glBindBuffer(GL_ARRAY_BUFFER, i_buffer.vbo));
-                glsafe(::glVertexPointer(buffer.vertices.position_size_floats(), GL_FLOAT, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.position_offset_size()));
+                glsafe(::glVertexPointer(buffer.vertices.position_size_floats(), buffer.vertices.compressed ? GL_SHORT : GL_FLOAT, buffer.vertices.gpu_vertex_size_bytes(), (const void*)buffer.vertices.gpu_position_offset_size()));
                 glsafe(::glEnableClientState(GL_VERTEX_ARRAY));
                 bool has_normals = buffer.vertices.normal_size_floats() > 0;
                 if (has_normals) {
-                    glsafe(::glNormalPointer(GL_FLOAT, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.normal_offset_size()));
+                    glsafe(::glNormalPointer(buffer.vertices.compressed ? GL_BYTE : GL_FLOAT, buffer.vertices.gpu_vertex_size_bytes(), (const void*)buffer.vertices.gpu_normal_offset_size()));
                     glsafe(::glEnableClientState(GL_NORMAL_ARRAY));
                 }
 
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, (use_lod && i_buffer.lod_ibo > 0) ? i_buffer.lod_ibo : i_buffer.ibo));
+#else
                 glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, i_buffer.ibo));
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 
                 switch (buffer.render_primitive_type)
                 {
@@ -3669,6 +4048,9 @@ void GCodeViewer::render_toolpaths() const
                 glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
             }
 
+            if (buffer.vertices.compressed)
+                glsafe(::glPopMatrix());
+
             shader->stop_using();
         }
     }
@@ -3679,12 +4061,18 @@ void GCodeViewer::render_toolpaths() const
         if (shader != nullptr) {
             shader->start_using();
 
+            const VBuffer& vertices = cap.buffer->vertices;
+            if (vertices.compressed) {
+                glsafe(::glPushMatrix());
+                glsafe(::glMultMatrixd(vertices.dequantization_matrix().data()));
+            }
+
             glsafe(::glBindBuffer(GL_ARRAY_BUFFER, cap.vbo));
-            glsafe(::glVertexPointer(cap.buffer->vertices.position_size_floats(), GL_FLOAT, cap.buffer->vertices.vertex_size_bytes(), (const void*)cap.buffer->vertices.position_offset_size()));
+            glsafe(::glVertexPointer(vertices.position_size_floats(), vertices.compressed ? GL_SHORT : GL_FLOAT, vertices.gpu_vertex_size_bytes(), (const void*)vertices.gpu_position_offset_size()));
             glsafe(::glEnableClientState(GL_VERTEX_ARRAY));
-            bool has_normals = cap.buffer->vertices.normal_size_floats() > 0;
+            bool has_normals = vertices.normal_size_floats() > 0;
             if (has_normals) {
-                glsafe(::glNormalPointer(GL_FLOAT, cap.buffer->vertices.vertex_size_bytes(), (const void*)cap.buffer->vertices.normal_offset_size()));
+                glsafe(::glNormalPointer(vertices.compressed ? GL_BYTE : GL_FLOAT, vertices.gpu_vertex_size_bytes(), (const void*)vertices.gpu_normal_offset_size()));
                 glsafe(::glEnableClientState(GL_NORMAL_ARRAY));
             }
 
@@ -3704,6 +4092,9 @@ void GCodeViewer::render_toolpaths() const
             glsafe(::glDisableClientState(GL_VERTEX_ARRAY));
             glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
 
+            if (vertices.compressed)
+                glsafe(::glPopMatrix());
+
             shader->stop_using();
         }
     };
@@ -5,6 +5,7 @@
 #include "libslic3r/GCode/GCodeProcessor.hpp"
 #include "GLModel.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <float.h>
 #include <set>
@@ -63,6 +64,30 @@ class GCodeViewer
 
         EFormat format{ EFormat::Position };
 #if ENABLE_SPLITTED_VERTEX_BUFFER
+        // vertex format on gpu of the compressed buffers:
+        // 3 shorts + padding -> position quantized on the grid of the toolpaths box|3 bytes + padding -> normal
+        struct CompressedVertex
+        {
+            int16_t position[4];
+            int8_t normal[4];
+        };
+        // whether the vertices of the PositionNormal3 format are sent to gpu as CompressedVertex
+        bool compressed{ false };
+        // quantization grid of the compressed positions: position = origin + step * quantized position
+        Vec3f quantization_origin{ Vec3f::Zero() };
+        float quantization_step{ 1.0f };
+
+        Transform3d dequantization_matrix() const {
+            return compressed ? Geometry::assemble_transform(quantization_origin.cast<double>(), Vec3d::Zero(), double(quantization_step) * Vec3d::Ones()) : Transform3d::Identity();
+        }
+        Vec3f dequantize(const int16_t* position) const {
+            return quantization_origin + quantization_step * Vec3f(float(position[0]), float(position[1]), float(position[2]));
+        }
+        // size of a vertex in the vbos, which differs from vertex_size_bytes() for compressed buffers
+        size_t gpu_vertex_size_bytes() const { return compressed ? sizeof(CompressedVertex) : vertex_size_bytes(); }
+        size_t gpu_position_offset_size() const { return compressed ? offsetof(CompressedVertex, position) : position_offset_size(); }
+        size_t gpu_normal_offset_size() const { return compressed ? offsetof(CompressedVertex, normal) : normal_offset_size(); }
+
         // vbos id
         std::vector<unsigned int> vbos;
         // sizes of the buffers, in bytes, used in export to obj
@@ -129,6 +154,10 @@ class GCodeViewer
         unsigned int vbo{ 0 };
         // ibo id
         unsigned int ibo{ 0 };
+#if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+        // id of the simplified ibo used by distant views, zero if none
+        unsigned int lod_ibo{ 0 };
+#endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 #else
         // ibo id
         unsigned int id{ 0 };
@@ -161,6 +190,8 @@ class GCodeViewer
         {
             Endpoint first;
             Endpoint last;
+            // bounding box of the rendered toolpaths, used to skip the sub paths outside of the view frustum
+            BoundingBoxf3 bounding_box;
 
             bool contains(size_t s_id) const {
                 return first.s_id <= s_id && s_id <= last.s_id;
@@ -234,6 +265,10 @@ class GCodeViewer
         unsigned int                path_id;
         std::vector<unsigned int>   sizes;
         std::vector<size_t>         offsets; // use size_t because we need an unsigned integer whose size matches pointer's size (used in the call glMultiDrawElements())
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+        // bounding boxes of the sub paths rendered by sizes and offsets
+        std::vector<BoundingBoxf3>  bounding_boxes;
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
         bool contains(size_t offset) const {
             for (size_t i = 0; i < offsets.size(); ++i) {
@@ -393,6 +428,7 @@ class GCodeViewer
                 max = std::max(max, value);
             }
             void reset() { min = FLT_MAX; max = -FLT_MAX; count = 0; }
+            void set(const GCodeProcessor::ValuesRange& range) { min = range.min; max = range.max; count = range.count; }
 
             float step_size(bool log = false) const;
             Color get_color_at(float value, bool log = false) const;
@@ -511,6 +547,67 @@ class GCodeViewer
     };
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+    // Chunk of toolpaths containing whole layers.
+    // The data of each chunk are generated and sent to gpu independently from the other chunks and are
+    // stored contiguously into the TBuffers, so that only the chunks whose moves changed need to be
+    // regenerated when a new gcode result is loaded
+    struct ToolpathsChunk
+    {
+        // ranges of the chunk data into a TBuffer
+        struct Range
+        {
+            // range into TBuffer::vertices.vbos and TBuffer::vertices.sizes
+            size_t vbos_first{ 0 };
+            size_t vbos_count{ 0 };
+            // range into TBuffer::indices
+            size_t ibuffers_first{ 0 };
+            size_t ibuffers_count{ 0 };
+            // range into TBuffer::paths
+            size_t paths_first{ 0 };
+            size_t paths_count{ 0 };
+            size_t vertices_count{ 0 };
+        };
+
+        // moves [first_move, last_move] contained into the chunk
+        size_t first_move{ 0 };
+        size_t last_move{ 0 };
+        // hash of the moves, used to detect whether the chunk can be reused
+        size_t hash{ 0 };
+        // one range for each TBuffer
+        std::vector<Range> ranges;
+
+        bool matches(const ToolpathsChunk& other) const {
+            return first_move == other.first_move && last_move == other.last_move && hash == other.hash;
+        }
+    };
+
+    // Toolpaths detached from the TBuffers by reset(), kept on gpu
+    // until the next call to load_toolpaths() to reuse the chunks which did not change
+    struct ToolpathsCache
+    {
+        struct Buffer
+        {
+            std::vector<unsigned int> vbos;
+            std::vector<size_t> sizes;
+            std::vector<IBuffer> indices;
+            std::vector<Path> paths;
+            // quantization grid of the cached vertices
+            bool compressed{ false };
+            Vec3f quantization_origin{ Vec3f::Zero() };
+            float quantization_step{ 1.0f };
+        };
+
+        std::vector<ToolpathsChunk> chunks;
+        // one buffer for each TBuffer
+        std::vector<Buffer> buffers;
+
+        bool empty() const { return chunks.empty(); }
+        // release gpu memory
+        void reset();
+    };
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
     struct Statistics
     {
@@ -679,10 +776,21 @@ private:
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
     std::array<SequentialRangeCap, 2> m_sequential_range_caps;
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+    // chunks of the toolpaths contained into m_buffers
+    std::vector<ToolpathsChunk> m_toolpaths_chunks;
+    // zs of the options (pause prints, custom gcodes) whose layers paths have been recolored
+    std::vector<float> m_options_zs;
+    ToolpathsCache m_toolpaths_cache;
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
 
 public:
     GCodeViewer();
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+    ~GCodeViewer() { reset(); m_toolpaths_cache.reset(); }
+#else
     ~GCodeViewer() { reset(); }
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
 
     // extract rendering data from the given parameters
     void load(const GCodeProcessor::Result& gcode_result, const Print& print, bool initialized);
@@ -731,6 +839,10 @@ public:
 
 private:
     void load_toolpaths(const GCodeProcessor::Result& gcode_result);
+#if ENABLE_SPLITTED_VERTEX_BUFFER
+    // changes the color of the paths whose layer contains option points (applying it twice restores the original color)
+    void toggle_options_layers_color();
+#endif // ENABLE_SPLITTED_VERTEX_BUFFER
     void load_shells(const Print& print, bool initialized);
     void refresh_render_paths(bool keep_sequential_current_first, bool keep_sequential_current_last) const;
     void render_toolpaths() const;
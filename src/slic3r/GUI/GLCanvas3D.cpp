@@ -184,6 +184,7 @@ void GLCanvas3D::LayersEditing::set_config(const DynamicPrintConfig* config)
     delete m_slicing_parameters;
     m_slicing_parameters = nullptr;
     m_layers_texture.valid = false;
+    m_layers_texture.layers.clear();
 }
 
 void GLCanvas3D::LayersEditing::select_object(const Model &model, int object_id)
@@ -200,6 +201,7 @@ void GLCanvas3D::LayersEditing::select_object(const Model &model, int object_id)
         delete m_slicing_parameters;
         m_slicing_parameters   = nullptr;
         m_layers_texture.valid = false;
+        m_layers_texture.layers.clear();
         this->last_object_id   = object_id;
         m_model_object         = model_object_new;
         m_object_max_z         = new_max_z;
@@ -470,22 +472,26 @@ void GLCanvas3D::LayersEditing::render_volumes(const GLCanvas3D& canvas, const G
     shader->set_uniform("z_cursor_band_width", float(this->band_width));
 
         // Initialize the layer height texture mapping.
-        GLsizei w = (GLsizei)m_layers_texture.width;
-        GLsizei h = (GLsizei)m_layers_texture.height;
-        GLsizei half_w = w / 2;
-        GLsizei half_h = h / 2;
         glsafe(::glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
         glsafe(::glBindTexture(GL_TEXTURE_2D, m_z_texture_id));
-        glsafe(::glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
-        glsafe(::glTexImage2D(GL_TEXTURE_2D, 1, GL_RGBA, half_w, half_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
-        glsafe(::glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, m_layers_texture.data.data()));
-        glsafe(::glTexSubImage2D(GL_TEXTURE_2D, 1, 0, 0, half_w, half_h, GL_RGBA, GL_UNSIGNED_BYTE, m_layers_texture.data.data() + m_layers_texture.width * m_layers_texture.height * 4));
+        if (! m_layers_texture.uploaded) {
+            // Only send the texture to the GPU after it was regenerated, not at every frame.
+            GLsizei w = (GLsizei)m_layers_texture.width;
+            GLsizei h = (GLsizei)m_layers_texture.height;
+            GLsizei half_w = w / 2;
+            GLsizei half_h = h / 2;
+            glsafe(::glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+            glsafe(::glTexImage2D(GL_TEXTURE_2D, 1, GL_RGBA, half_w, half_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+            glsafe(::glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, m_layers_texture.data.data()));
+            glsafe(::glTexSubImage2D(GL_TEXTURE_2D, 1, 0, 0, half_w, half_h, GL_RGBA, GL_UNSIGNED_BYTE, m_layers_texture.data.data() + m_layers_texture.width * m_layers_texture.height * 4));
+            const_cast<LayersEditing*>(this)->m_layers_texture.uploaded = true;
+        }
         for (const GLVolume* glvolume : volumes.volumes) {
             // Render the object using the layer editing shader and texture.
             if (! glvolume->is_active || glvolume->composite_id.object_id != this->last_object_id || glvolume->is_modifier)
                 continue;
 
-        shader->set_uniform("volume_world_matrix", glvolume->world_matrix());
+        shader->set_uniform("volume_world_matrix", glvolume->world_matrix() * glvolume->indexed_vertex_array.dequantization_matrix());
         shader->set_uniform("object_max_z", GLfloat(0));
             glvolume->render();
         }
@@ -553,13 +559,26 @@ void GLCanvas3D::LayersEditing::generate_layer_height_texture()
         m_layers_texture.height = 1024;
         m_layers_texture.levels = 2;
         m_layers_texture.data.assign(m_layers_texture.width * m_layers_texture.height * 5, 0);
+        m_layers_texture.layers.clear();
+    }
+
+    // A brush stroke only changes the layers from the edited band up, keep the texture of the layers below.
+    std::vector<coordf_t> layers = Slic3r::generate_object_layers(*m_slicing_parameters, m_layer_height_profile);
+    size_t first_layer = 0;
+    if (m_layers_texture.cells > 0 && ! m_layers_texture.layers.empty()) {
+        size_t num_common = std::min(layers.size(), m_layers_texture.layers.size());
+        while (first_layer < num_common && layers[first_layer] == m_layers_texture.layers[first_layer])
+            ++ first_layer;
+        first_layer /= 2;
+    }
+    if (first_layer * 2 < layers.size() || layers.size() != m_layers_texture.layers.size()) {
+        bool level_of_detail_2nd_level = true;
+        m_layers_texture.cells = Slic3r::generate_layer_height_texture(
+            *m_slicing_parameters, layers,
+            m_layers_texture.data.data(), m_layers_texture.height, m_layers_texture.width, level_of_detail_2nd_level, first_layer);
+        m_layers_texture.layers   = std::move(layers);
+        m_layers_texture.uploaded = false;
     }
-
-    bool level_of_detail_2nd_level = true;
-    m_layers_texture.cells = Slic3r::generate_layer_height_texture(
-        *m_slicing_parameters, 
-        Slic3r::generate_object_layers(*m_slicing_parameters, m_layer_height_profile), 
-		m_layers_texture.data.data(), m_layers_texture.height, m_layers_texture.width, level_of_detail_2nd_level);
 	m_layers_texture.valid = true;
 }
 
@@ -2097,6 +2116,8 @@ void GLCanvas3D::reload_scene(bool refresh_immediately, bool force_full_scene_re
     if (m_volumes.volumes != glvolumes_new)
 		update_object_list = true;
     m_volumes.volumes = std::move(glvolumes_new);
+    // The new volumes get their geometry loaded in a single shot at the end, in parallel.
+    std::vector<size_t> volume_idxs_new;
     for (unsigned int obj_idx = 0; obj_idx < (unsigned int)m_model->objects.size(); ++ obj_idx) {
         const ModelObject &model_object = *m_model->objects[obj_idx];
         for (int volume_idx = 0; volume_idx < (int)model_object.volumes.size(); ++ volume_idx) {
@@ -2115,8 +2136,9 @@ void GLCanvas3D::reload_scene(bool refresh_immediately, bool force_full_scene_re
                     // Note the index of the loaded volume, so that we can reload the main model GLVolume with the hollowed mesh
                     // later in this function.
                     it->volume_idx = m_volumes.volumes.size();
-                    m_volumes.load_object_volume(&model_object, obj_idx, volume_idx, instance_idx, m_color_by, m_initialized);
+                    m_volumes.load_object_volume(&model_object, obj_idx, volume_idx, instance_idx, m_color_by, m_initialized, false);
                     m_volumes.volumes.back()->geometry_id = key.geometry_id;
+                    volume_idxs_new.emplace_back(m_volumes.volumes.size() - 1);
 					update_object_list = true;
                 } else {
 					// Recycling an old GLVolume.
@@ -2131,6 +2153,7 @@ void GLCanvas3D::reload_scene(bool refresh_immediately, bool force_full_scene_re
             }
         }
     }
+    m_volumes.load_object_volumes_geometry(volume_idxs_new, m_initialized);
     if (printer_technology == ptSLA) {
         size_t idx = 0;
         const SLAPrint *sla_print = this->sla_print();
@@ -2172,7 +2195,8 @@ void GLCanvas3D::reload_scene(bool refresh_immediately, bool force_full_scene_re
                         GLVolume &volume = *m_volumes.volumes[it->volume_idx];
                         if (! volume.offsets.empty() && state.step[istep].timestamp != volume.offsets.front()) {
                         	// The backend either produced a new hollowed mesh, or it invalidated the one that the front end has seen.
-                            volume.indexed_vertex_array.release_geometry();
+                            // The hollowed mesh is not shared with the other instances.
+                            volume.release_geometry();
                         	if (state.step[istep].state == PrintStateBase::DONE) {
                                 TriangleMesh mesh = print_object->get_mesh(slaposDrillHoles);
 	                            assert(! mesh.empty());
@@ -5973,6 +5997,8 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
     ctxt.extruders_cnt = wxGetApp().extruders_edited_cnt();
 
     ctxt.shifted_copies = &print_object.instances();
+    if (ctxt.shifted_copies->empty())
+        return;
 
     // order layers by print_z
     {
@@ -6061,8 +6087,9 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
                     vol->offsets.emplace_back(vol->indexed_vertex_array.quad_indices.size());
                     vol->offsets.emplace_back(vol->indexed_vertex_array.triangle_indices.size());
                 }
-            for (const PrintInstance &instance : *ctxt.shifted_copies) {
-                const Point &copy = instance.shift;
+            {
+                // The toolpaths are generated for the first instance only, the other instances reference them.
+                const Point &copy = ctxt.shifted_copies->front().shift;
                 for (const LayerRegion *layerm : layer->regions()) {
                     if (is_selected_separate_extruder)
                     {
@@ -6129,6 +6156,26 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
     for (size_t i = volumes_cnt_initial; i < m_volumes.volumes.size(); ++i)
         m_volumes.volumes[i]->indexed_vertex_array.finalize_geometry(m_initialized);
 
+    // The toolpaths of the other instances are the toolpaths of the first one, shifted by the difference of the instance shifts.
+    // Their volumes share the VBOs of the first instance, or copy its geometry if it has not been sent to the GPU yet.
+    const size_t volumes_cnt_first_instance = m_volumes.volumes.size();
+    for (size_t idx_copy = 1; idx_copy < ctxt.shifted_copies->size(); ++ idx_copy) {
+        const Point shift = (*ctxt.shifted_copies)[idx_copy].shift - ctxt.shifted_copies->front().shift;
+        for (size_t i = volumes_cnt_initial; i < volumes_cnt_first_instance; ++i) {
+            const GLVolume &src    = *m_volumes.volumes[i];
+            GLVolume       *volume = new GLVolume(src.color);
+            volume->is_extrusion_path = true;
+            volume->print_zs          = src.print_zs;
+            volume->offsets           = src.offsets;
+            if (src.indexed_vertex_array.has_VBOs())
+                volume->indexed_vertex_array.share_geometry(src.indexed_vertex_array);
+            else
+                volume->indexed_vertex_array = src.indexed_vertex_array;
+            volume->set_instance_offset(unscale(shift.x(), shift.y(), 0));
+            m_volumes.volumes.emplace_back(volume);
+        }
+    }
+
     BOOST_LOG_TRIVIAL(debug) << "Loading print object toolpaths in parallel - end" << m_volumes.log_memory_info() << log_memory_info();
 }
 
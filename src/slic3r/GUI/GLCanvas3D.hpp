@@ -178,7 +178,7 @@ class GLCanvas3D
         class LayersTexture
         {
         public:
-            LayersTexture() : width(0), height(0), levels(0), cells(0), valid(false) {}
+            LayersTexture() : width(0), height(0), levels(0), cells(0), valid(false), uploaded(false) {}
 
             // Texture data
             std::vector<char>   data;
@@ -192,6 +192,11 @@ class GLCanvas3D
             size_t              cells;
             // Does it need to be refreshed?
             bool                valid;
+            // Object layers the data was generated from, to only regenerate the texture above the edited layers.
+            // Cleared when the slicing parameters change.
+            std::vector<coordf_t> layers;
+            // Was the data sent to the GPU since it was last generated?
+            bool                uploaded;
         };
         LayersTexture   m_layers_texture;
 
@@ -8,7 +8,11 @@
 #include <boost/nowide/fstream.hpp>
 #include <GL/glew.h>
 #include <cassert>
+#include <iterator>
+#include <vector>
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 
 namespace Slic3r {
@@ -75,6 +79,62 @@ bool GLShaderProgram::init_from_files(const std::string& name, const ShaderFilen
     return valid ? init_from_texts(name, sources) : false;
 }
 
+// Linked program binaries are cached under the data directory, keyed by the driver and by the shader sources,
+// as compiling and linking the shaders takes seconds on some drivers (software rendering, remote desktops).
+static bool program_binary_supported()
+{
+    return GLEW_ARB_get_program_binary;
+}
+
+static std::string program_binary_path(const std::string& name, const GLShaderProgram::ShaderSources& sources)
+{
+    size_t seed = 0;
+    for (GLenum e : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION }) {
+        const char* str = reinterpret_cast<const char*>(::glGetString(e));
+        boost::hash_combine(seed, std::string(str != nullptr ? str : ""));
+    }
+    for (const std::string& source : sources)
+        boost::hash_combine(seed, source);
+    return data_dir() + "/cache/shaders/" + name + "_" + format("%016x", uint64_t(seed)) + ".bin";
+}
+
+// Returns false if the binary is not cached or if the driver rejects it, the program has to be compiled then.
+static bool load_program_binary(GLuint program, const std::string& path)
+{
+    boost::nowide::ifstream s(path, boost::nowide::ifstream::binary);
+    if (! s.good())
+        return false;
+    GLenum binary_format = 0;
+    s.read(reinterpret_cast<char*>(&binary_format), sizeof(binary_format));
+    if (! s.good())
+        return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
+    if (data.empty())
+        return false;
+    glsafe(::glProgramBinary(program, binary_format, data.data(), GLsizei(data.size())));
+    GLint params;
+    glsafe(::glGetProgramiv(program, GL_LINK_STATUS, &params));
+    return params == GL_TRUE;
+}
+
+static void save_program_binary(GLuint program, const std::string& path)
+{
+    GLint length = 0;
+    glsafe(::glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+    std::vector<char> data(length);
+    GLenum binary_format = 0;
+    glsafe(::glGetProgramBinary(program, length, &length, &binary_format, data.data()));
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(boost::filesystem::path(path).parent_path(), ec);
+    boost::nowide::ofstream s(path, boost::nowide::ofstream::binary);
+    s.write(reinterpret_cast<const char*>(&binary_format), sizeof(binary_format));
+    s.write(data.data(), length);
+    if (! s.good())
+        BOOST_LOG_TRIVIAL(warning) << "Unable to cache the shader program binary: '" << path << "'";
+}
+
 bool GLShaderProgram::init_from_texts(const std::string& name, const ShaderSources& sources)
 {
     auto shader_type_as_string = [](EShaderType type) {
@@ -117,6 +177,19 @@ bool GLShaderProgram::init_from_texts(const std::string& name, const ShaderSourc
 
     m_name = name;
 
+    const bool        use_binary  = program_binary_supported();
+    const std::string binary_path = use_binary ? program_binary_path(name, sources) : std::string();
+    if (use_binary) {
+        m_id = ::glCreateProgram();
+        glcheck();
+        if (m_id > 0) {
+            if (load_program_binary(m_id, binary_path))
+                return true;
+            glsafe(::glDeleteProgram(m_id));
+            m_id = 0;
+        }
+    }
+
     std::array<GLuint, static_cast<size_t>(EShaderType::Count)> shader_ids = { 0 };
 
     for (size_t i = 0; i < static_cast<size_t>(EShaderType::Count); ++i) {
@@ -169,6 +242,8 @@ bool GLShaderProgram::init_from_texts(const std::string& name, const ShaderSourc
             glsafe(::glAttachShader(m_id, shader_ids[i]));
     }
 
+    if (use_binary)
+        glsafe(::glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
     glsafe(::glLinkProgram(m_id));
     GLint params;
     glsafe(::glGetProgramiv(m_id, GL_LINK_STATUS, &params));
@@ -192,6 +267,9 @@ bool GLShaderProgram::init_from_texts(const std::string& name, const ShaderSourc
     // release shaders, they are no more needed
     release_shaders(shader_ids);
 
+    if (use_binary)
+        save_program_binary(m_id, binary_path);
+
     return true;
 }
 
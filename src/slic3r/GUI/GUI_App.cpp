@@ -43,6 +43,7 @@
 #include "libslic3r/Model.hpp"
 #include "libslic3r/I18N.hpp"
 #include "libslic3r/PresetBundle.hpp"
+#include "libslic3r/SlicesCache.hpp"
 
 #include "GUI.hpp"
 #include "GUI_Utils.hpp"
@@ -728,6 +729,12 @@ bool GUI_App::init_opengl()
 #endif
 }
 
+// The slices are kept on disk between the sessions only if enabled in the preferences.
+static void update_slices_cache_directory(const AppConfig &app_config)
+{
+    SlicesCache::instance().set_directory(app_config.get("slices_cache_on_disk") == "1" ? data_dir() + "/cache/slices" : std::string());
+}
+
 void GUI_App::init_app_config()
 {
     #ifdef SLIC3R_ALPHA
@@ -784,6 +791,7 @@ void GUI_App::init_app_config()
             }
         }
     }
+    update_slices_cache_directory(*app_config);
 }
 
 void GUI_App::init_single_instance_checker(const std::string &name, const std::string &path)
@@ -1384,6 +1392,7 @@ void fatal_error(wxWindow* parent)
 // Update the UI based on the current preferences.
 void GUI_App::update_ui_from_settings(bool apply_free_camera_correction)
 {
+    update_slices_cache_directory(*app_config);
     if(mainframe)
         mainframe->update_ui_from_settings(apply_free_camera_correction);
 }
@@ -5,6 +5,7 @@
 
 #include "libslic3r/Model.hpp"
 
+#include <algorithm>
 #include <numeric>
 
 #include <GL/glew.h>
@@ -28,6 +29,8 @@ bool GLGizmoFlatten::on_init()
 
 void GLGizmoFlatten::on_set_state()
 {
+    if (m_state == Off)
+        stop_worker();
 }
 
 CommonGizmosDataID GLGizmoFlatten::on_get_requirements() const
@@ -70,6 +73,10 @@ void GLGizmoFlatten::on_render() const
         glsafe(::glMultMatrixd(m.data()));
         if (this->is_plane_update_necessary())
 			const_cast<GLGizmoFlatten*>(this)->update_planes();
+        const_cast<GLGizmoFlatten*>(this)->process_worker_planes();
+        glsafe(::glColor4f(0.9f, 0.9f, 0.9f, 0.5f));
+        for (const GLIndexedVertexArray& preview : m_preview)
+            preview.render();
         for (int i = 0; i < (int)m_planes.size(); ++i) {
             if (i == m_hover_id)
                 glsafe(::glColor4f(0.9f, 0.9f, 0.9f, 0.75f));
@@ -114,25 +121,79 @@ void GLGizmoFlatten::set_flattening_data(const ModelObject* model_object)
 {
     m_starting_center = Vec3d::Zero();
     if (model_object != m_old_model_object) {
+        stop_worker();
         m_planes.clear();
         m_planes_valid = false;
     }
 }
 
+void GLGizmoFlatten::stop_worker()
+{
+    if (m_thread.joinable()) {
+        m_cancel = true;
+        m_thread.join();
+        m_cancel = false;
+    }
+    m_worker_planes.clear();
+    m_worker_done = false;
+    m_received_planes.clear();
+    m_preview.clear();
+}
+
 void GLGizmoFlatten::update_planes()
 {
+    stop_worker();
+    m_planes.clear();
+    m_planes_valid = false;
+
     const ModelObject* mo = m_c->selection_info()->model_object();
-    TriangleMesh ch;
+
+    // Save what the planes are calculated from, so that they are not recalculated while the worker runs:
+    m_volumes_matrices.clear();
+    m_volumes_types.clear();
     for (const ModelVolume* vol : mo->volumes) {
-        if (vol->type() != ModelVolumeType::MODEL_PART)
-            continue;
-        TriangleMesh vol_ch = vol->get_convex_hull();
-        vol_ch.transform(vol->get_matrix());
+        m_volumes_matrices.push_back(vol->get_matrix());
+        m_volumes_types.push_back(vol->type());
+    }
+    m_first_instance_scale = mo->instances.front()->get_scaling_factor();
+    m_first_instance_mirror = mo->instances.front()->get_mirror();
+    m_old_model_object = mo;
+
+    // Were the planes already calculated for this object and transformation?
+    auto it_cache = m_planes_cache.find(mo->id());
+    if (it_cache != m_planes_cache.end()) {
+        const PlanesCache& cache = it_cache->second;
+        bool same = cache.volumes_types == m_volumes_types && cache.first_instance_scale.isApprox(m_first_instance_scale) &&
+            cache.first_instance_mirror.isApprox(m_first_instance_mirror) && cache.volumes_matrices.size() == m_volumes_matrices.size();
+        for (size_t i = 0; same && i < m_volumes_matrices.size(); ++i)
+            same = cache.volumes_matrices[i].isApprox(m_volumes_matrices[i]);
+        if (same) {
+            this->finalize_planes(std::vector<PlaneData>(cache.planes));
+            return;
+        }
+    }
+
+    // Collect the inputs of the worker thread. The convex hulls of the volumes are cached by the volumes
+    // and shared with the worker thread, the ModelObject itself is not accessed by the worker.
+    std::vector<std::pair<std::shared_ptr<const TriangleMesh>, Transform3d>> hulls;
+    for (const ModelVolume* vol : mo->volumes)
+        if (vol->type() == ModelVolumeType::MODEL_PART)
+            hulls.emplace_back(vol->get_convex_hull_shared_ptr(), vol->get_matrix());
+    const Transform3d inst_matrix = mo->instances.front()->get_matrix(true);
+
+    m_thread = std::thread(&GLGizmoFlatten::detect_planes, this, std::move(hulls), inst_matrix);
+}
+
+void GLGizmoFlatten::detect_planes(std::vector<std::pair<std::shared_ptr<const TriangleMesh>, Transform3d>> hulls, Transform3d inst_matrix)
+{
+    TriangleMesh ch;
+    for (const std::pair<std::shared_ptr<const TriangleMesh>, Transform3d>& hull : hulls) {
+        TriangleMesh vol_ch = *hull.first;
+        vol_ch.transform(hull.second);
         ch.merge(vol_ch);
     }
     ch = ch.convex_hull_3d();
-    m_planes.clear();
-    const Transform3d& inst_matrix = mo->instances.front()->get_matrix(true);
+    std::vector<PlaneData> planes;
 
     // Following constants are used for discarding too small polygons.
     const float minimal_area = 5.f; // in square mm (world coordinates)
@@ -145,7 +206,7 @@ void GLGizmoFlatten::update_planes()
     std::vector<bool> facet_visited(num_of_facets, false);
     int               facet_queue_cnt = 0;
     const stl_normal* normal_ptr = nullptr;
-    while (1) {
+    while (! m_cancel) {
         // Find next unvisited triangle:
         int facet_idx = 0;
         for (; facet_idx < num_of_facets; ++ facet_idx)
@@ -153,7 +214,7 @@ void GLGizmoFlatten::update_planes()
                 facet_queue[facet_queue_cnt ++] = facet_idx;
                 facet_visited[facet_idx] = true;
                 normal_ptr = &ch.stl.facet_start[facet_idx].normal;
-                m_planes.emplace_back();
+                planes.emplace_back();
                 break;
             }
         if (facet_idx == num_of_facets)
@@ -165,7 +226,7 @@ void GLGizmoFlatten::update_planes()
             if (std::abs(this_normal(0) - (*normal_ptr)(0)) < 0.001 && std::abs(this_normal(1) - (*normal_ptr)(1)) < 0.001 && std::abs(this_normal(2) - (*normal_ptr)(2)) < 0.001) {
                 stl_vertex* first_vertex = ch.stl.facet_start[facet_idx].vertex;
                 for (int j=0; j<3; ++j)
-                    m_planes.back().vertices.emplace_back(first_vertex[j].cast<double>());
+                    planes.back().vertices.emplace_back(first_vertex[j].cast<double>());
 
                 facet_visited[facet_idx] = true;
                 for (int j = 0; j < 3; ++ j) {
@@ -175,9 +236,9 @@ void GLGizmoFlatten::update_planes()
                 }
             }
         }
-        m_planes.back().normal = normal_ptr->cast<double>();
+        planes.back().normal = normal_ptr->cast<double>();
 
-        Pointf3s& verts = m_planes.back().vertices;
+        Pointf3s& verts = planes.back().vertices;
         // Now we'll transform all the points into world coordinates, so that the areas, angles and distances
         // make real sense.
         verts = transform(verts, inst_matrix);
@@ -187,7 +248,7 @@ void GLGizmoFlatten::update_planes()
             ((verts[0] - verts[1]).norm() < minimal_side
             || (verts[0] - verts[2]).norm() < minimal_side
             || (verts[1] - verts[2]).norm() < minimal_side))
-            m_planes.pop_back();
+            planes.pop_back();
     }
 
     // Let's prepare transformation of the normal vector from mesh to instance coordinates.
@@ -196,9 +257,9 @@ void GLGizmoFlatten::update_planes()
     t.set_scaling_factor(Vec3d(1./scaling(0), 1./scaling(1), 1./scaling(2)));
 
     // Now we'll go through all the polygons, transform the points into xy plane to process them:
-    for (unsigned int polygon_id=0; polygon_id < m_planes.size(); ++polygon_id) {
-        Pointf3s& polygon = m_planes[polygon_id].vertices;
-        const Vec3d& normal = m_planes[polygon_id].normal;
+    for (unsigned int polygon_id=0; polygon_id < planes.size() && ! m_cancel; ++polygon_id) {
+        Pointf3s& polygon = planes[polygon_id].vertices;
+        const Vec3d& normal = planes[polygon_id].normal;
 
         // transform the normal according to the instance matrix:
         Vec3d normal_transformed = t.get_matrix() * normal;
@@ -220,7 +281,7 @@ void GLGizmoFlatten::update_planes()
         polygon = transform(polygon, tr.inverse());
 
         // Calculate area of the polygons and discard ones that are too small
-        float& area = m_planes[polygon_id].area;
+        float& area = planes[polygon_id].area;
         area = 0.f;
         for (unsigned int i = 0; i < polygon.size(); i++) // Shoelace formula
             area += polygon[i](0)*polygon[i + 1 < polygon.size() ? i + 1 : 0](1) - polygon[i + 1 < polygon.size() ? i + 1 : 0](0)*polygon[i](1);
@@ -246,7 +307,7 @@ void GLGizmoFlatten::update_planes()
         }
 
         if (discard) {
-            m_planes.erase(m_planes.begin() + (polygon_id--));
+            planes.erase(planes.begin() + (polygon_id--));
             continue;
         }
 
@@ -302,22 +363,68 @@ void GLGizmoFlatten::update_planes()
 
         // Transform back to 3D (and also back to mesh coordinates)
         polygon = transform(polygon, inst_matrix.inverse() * m.inverse());
+
+        // Pass the finished plane to the UI thread to be previewed.
+        std::lock_guard<std::mutex> lock(m_worker_mutex);
+        m_worker_planes.push_back(planes[polygon_id]);
     }
 
-    // We'll sort the planes by area and only keep the 254 largest ones (because of the picking pass limitations):
-    std::sort(m_planes.rbegin(), m_planes.rend(), [](const PlaneData& a, const PlaneData& b) { return a.area < b.area; });
-    m_planes.resize(std::min((int)m_planes.size(), 254));
+    std::lock_guard<std::mutex> lock(m_worker_mutex);
+    m_worker_done = true;
+}
+
 
-    // Planes are finished - let's save what we calculated it from:
-    m_volumes_matrices.clear();
-    m_volumes_types.clear();
-    for (const ModelVolume* vol : mo->volumes) {
-        m_volumes_matrices.push_back(vol->get_matrix());
-        m_volumes_types.push_back(vol->type());
+void GLGizmoFlatten::process_worker_planes()
+{
+    if (! m_thread.joinable())
+        return;
+
+    bool done;
+    {
+        std::lock_guard<std::mutex> lock(m_worker_mutex);
+        for (PlaneData& plane : m_worker_planes) {
+            // Preview of the plane. The polygon is convex with the vertices in order, so triangulation is trivial.
+            m_preview.emplace_back();
+            GLIndexedVertexArray& preview = m_preview.back();
+            preview.reserve(plane.vertices.size());
+            for (const Vec3d& vert : plane.vertices)
+                preview.push_geometry(vert, plane.normal);
+            for (size_t i = 1; i + 1 < plane.vertices.size(); ++i)
+                preview.push_triangle(0, i, i + 1); // triangle fan
+            preview.finalize_geometry(true);
+            m_received_planes.emplace_back(std::move(plane));
+        }
+        m_worker_planes.clear();
+        done = m_worker_done;
     }
-    m_first_instance_scale = mo->instances.front()->get_scaling_factor();
-    m_first_instance_mirror = mo->instances.front()->get_mirror();
-    m_old_model_object = mo;
+
+    if (done) {
+        m_thread.join();
+        std::vector<PlaneData> planes = std::move(m_received_planes);
+        this->stop_worker();
+
+        // We'll sort the planes by area and only keep the 254 largest ones (because of the picking pass limitations):
+        std::sort(planes.rbegin(), planes.rend(), [](const PlaneData& a, const PlaneData& b) { return a.area < b.area; });
+        planes.resize(std::min((int)planes.size(), 254));
+
+        PlanesCache& cache = m_planes_cache[m_old_model_object->id()];
+        cache.volumes_matrices = m_volumes_matrices;
+        cache.volumes_types = m_volumes_types;
+        cache.first_instance_scale = m_first_instance_scale;
+        cache.first_instance_mirror = m_first_instance_mirror;
+        cache.planes = planes;
+
+        this->finalize_planes(std::move(planes));
+    } else {
+        // Keep rendering until the worker finishes.
+        m_parent.set_as_dirty();
+        m_parent.request_extra_frame();
+    }
+}
+
+void GLGizmoFlatten::finalize_planes(std::vector<PlaneData> &&planes)
+{
+    m_planes = std::move(planes);
 
     // And finally create respective VBOs. The polygon is convex with
     // the vertices in order, so triangulation is trivial.
@@ -328,8 +435,6 @@ void GLGizmoFlatten::update_planes()
         for (size_t i=1; i<plane.vertices.size()-1; ++i)
             plane.vbo.push_triangle(0, i, i+1); // triangle fan
         plane.vbo.finalize_geometry(true);
-        // FIXME: vertices should really be local, they need not
-        // persist now when we use VBOs
         plane.vertices.clear();
         plane.vertices.shrink_to_fit();
     }
@@ -337,14 +442,14 @@ void GLGizmoFlatten::update_planes()
     m_planes_valid = true;
 }
 
-
 bool GLGizmoFlatten::is_plane_update_necessary() const
 {
     const ModelObject* mo = m_c->selection_info()->model_object();
     if (m_state != On || ! mo || mo->instances.empty())
         return false;
 
-    if (! m_planes_valid || mo != m_old_model_object
+    // The planes being detected by the worker thread are up to date unless the object changes.
+    if ((! m_planes_valid && ! m_thread.joinable()) || mo != m_old_model_object
      || mo->volumes.size() != m_volumes_matrices.size())
         return true;
 
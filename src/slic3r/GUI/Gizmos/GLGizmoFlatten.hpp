@@ -3,6 +3,13 @@
 
 #include "GLGizmoBase.hpp"
 #include "slic3r/GUI/3DScene.hpp"
+#include "libslic3r/ObjectID.hpp"
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 
 
 namespace Slic3r {
@@ -21,7 +28,7 @@ private:
     mutable Vec3d m_normal;
 
     struct PlaneData {
-        std::vector<Vec3d> vertices; // should be in fact local in update_planes()
+        std::vector<Vec3d> vertices;
         GLIndexedVertexArray vbo;
         Vec3d normal;
         float area;
@@ -39,11 +46,39 @@ private:
     const ModelObject* m_old_model_object = nullptr;
     std::vector<const Transform3d*> instances_matrices;
 
+    // Planes computed for the objects and the transformations seen so far, so that reopening the gizmo is immediate.
+    struct PlanesCache {
+        std::vector<Transform3d> volumes_matrices;
+        std::vector<ModelVolumeType> volumes_types;
+        Vec3d first_instance_scale;
+        Vec3d first_instance_mirror;
+        std::vector<PlaneData> planes;
+    };
+    std::map<ObjectID, PlanesCache> m_planes_cache;
+
+    // The planes are detected by a worker thread. The planes it finished are passed to the UI thread
+    // through m_worker_planes and rendered as a preview until the detection is complete.
+    std::thread m_thread;
+    std::atomic<bool> m_cancel{ false };
+    std::mutex m_worker_mutex;
+    std::vector<PlaneData> m_worker_planes;
+    bool m_worker_done = false;
+    // Planes received from the worker thread so far and their preview.
+    std::vector<PlaneData> m_received_planes;
+    std::deque<GLIndexedVertexArray> m_preview;
+
     void update_planes();
+    // Body of the worker thread, detecting the planes on the convex hull of the volumes.
+    void detect_planes(std::vector<std::pair<std::shared_ptr<const TriangleMesh>, Transform3d>> hulls, Transform3d inst_matrix);
     bool is_plane_update_necessary() const;
+    // Pick up the planes finished by the worker thread, finalize them once the worker is done.
+    void process_worker_planes();
+    void stop_worker();
+    void finalize_planes(std::vector<PlaneData> &&planes);
 
 public:
     GLGizmoFlatten(GLCanvas3D& parent, const std::string& icon_filename, unsigned int sprite_id);
+    ~GLGizmoFlatten() override { stop_worker(); }
 
     void set_flattening_data(const ModelObject* model_object);
     Vec3d get_flattening_normal() const;
@@ -518,49 +518,91 @@ void GLGizmoPainterBase::on_load(cereal::BinaryInputArchive&)
 
 
 
-void TriangleSelectorGUI::render(ImGuiWrapper* imgui)
+void TriangleSelectorGUI::on_facet_changed(int facet_idx)
 {
-    int enf_cnt = 0;
-    int blc_cnt = 0;
+    size_t block_idx = size_t(facet_idx / RenderBlockSize);
+    if (block_idx < m_render_blocks.size())
+        m_render_blocks[block_idx].dirty = true;
+}
 
-    m_iva_enforcers.release_geometry();
-    m_iva_blockers.release_geometry();
+void TriangleSelectorGUI::on_reset()
+{
+    for (RenderBlock& block : m_render_blocks)
+        block.dirty = true;
+}
 
-    for (const Triangle& tr : m_triangles) {
-        if (! tr.valid || tr.is_split() || tr.get_state() == EnforcerBlockerType::NONE)
-            continue;
+void TriangleSelectorGUI::update_render_block(int block_idx)
+{
+    RenderBlock& block = m_render_blocks[block_idx];
+    block.iva_enforcers.release_geometry();
+    block.iva_blockers.release_geometry();
 
-        GLIndexedVertexArray& va = tr.get_state() == EnforcerBlockerType::ENFORCER
-                                   ? m_iva_enforcers
-                                   : m_iva_blockers;
-        int& cnt = tr.get_state() == EnforcerBlockerType::ENFORCER
-                ? enf_cnt
-                : blc_cnt;
+    int enf_cnt = 0;
+    int blc_cnt = 0;
+    std::vector<int> stack;
+    int facet_end = std::min(m_orig_size_indices, (block_idx + 1) * RenderBlockSize);
+    for (int facet_idx = block_idx * RenderBlockSize; facet_idx < facet_end; ++ facet_idx) {
+        // Walk the division tree of the original facet down to its leaves.
+        stack.assign(1, facet_idx);
+        while (! stack.empty()) {
+            const Triangle& tr = m_triangles[stack.back()];
+            stack.pop_back();
+            if (! tr.valid)
+                continue;
+            if (tr.is_split()) {
+                for (int i = 0; i <= tr.number_of_split_sides(); ++ i)
+                    stack.emplace_back(tr.children[i]);
+                continue;
+            }
+            if (tr.get_state() == EnforcerBlockerType::NONE)
+                continue;
 
-        for (int i=0; i<3; ++i)
-            va.push_geometry(double(m_vertices[tr.verts_idxs[i]].v[0]),
-                             double(m_vertices[tr.verts_idxs[i]].v[1]),
-                             double(m_vertices[tr.verts_idxs[i]].v[2]),
-                             0., 0., 1.);
-        va.push_triangle(cnt,
-                         cnt+1,
-                         cnt+2);
-        cnt += 3;
+            GLIndexedVertexArray& va = tr.get_state() == EnforcerBlockerType::ENFORCER
+                                       ? block.iva_enforcers
+                                       : block.iva_blockers;
+            int& cnt = tr.get_state() == EnforcerBlockerType::ENFORCER
+                    ? enf_cnt
+                    : blc_cnt;
+
+            for (int i=0; i<3; ++i)
+                va.push_geometry(double(m_vertices[tr.verts_idxs[i]].v[0]),
+                                 double(m_vertices[tr.verts_idxs[i]].v[1]),
+                                 double(m_vertices[tr.verts_idxs[i]].v[2]),
+                                 0., 0., 1.);
+            va.push_triangle(cnt,
+                             cnt+1,
+                             cnt+2);
+            cnt += 3;
+        }
     }
 
-    m_iva_enforcers.finalize_geometry(true);
-    m_iva_blockers.finalize_geometry(true);
+    block.iva_enforcers.finalize_geometry(true);
+    block.iva_blockers.finalize_geometry(true);
+    block.dirty = false;
+}
 
-    if (m_iva_enforcers.has_VBOs()) {
-        ::glColor4f(0.f, 0.f, 1.f, 0.4f);
-        m_iva_enforcers.render();
+void TriangleSelectorGUI::render(ImGuiWrapper* imgui)
+{
+    size_t num_blocks = size_t((m_orig_size_indices + RenderBlockSize - 1) / RenderBlockSize);
+    if (m_render_blocks.size() != num_blocks) {
+        // The vertex arrays with VBOs cannot be moved, release them first.
+        m_render_blocks.clear();
+        m_render_blocks = std::vector<RenderBlock>(num_blocks);
     }
 
+    for (int block_idx = 0; block_idx < int(m_render_blocks.size()); ++ block_idx)
+        if (m_render_blocks[block_idx].dirty)
+            update_render_block(block_idx);
 
-    if (m_iva_blockers.has_VBOs()) {
-        ::glColor4f(1.f, 0.f, 0.f, 0.4f);
-        m_iva_blockers.render();
-    }
+    ::glColor4f(0.f, 0.f, 1.f, 0.4f);
+    for (RenderBlock& block : m_render_blocks)
+        if (block.iva_enforcers.has_VBOs())
+            block.iva_enforcers.render();
+
+    ::glColor4f(1.f, 0.f, 0.f, 0.4f);
+    for (RenderBlock& block : m_render_blocks)
+        if (block.iva_blockers.has_VBOs())
+            block.iva_blockers.render();
 
 
 #ifdef PRUSASLICER_TRIANGLE_SELECTOR_DEBUG
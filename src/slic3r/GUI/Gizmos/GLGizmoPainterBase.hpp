@@ -44,9 +44,23 @@ public:
     bool m_show_invalid{false};
 #endif
 
+protected:
+    void on_facet_changed(int facet_idx) override;
+    void on_reset() override;
+
 private:
-    GLIndexedVertexArray m_iva_enforcers;
-    GLIndexedVertexArray m_iva_blockers;
+    // Vertex arrays of the painted triangles of a block of consecutive
+    // original facets. Only the blocks touched by the brush are updated.
+    struct RenderBlock {
+        GLIndexedVertexArray iva_enforcers;
+        GLIndexedVertexArray iva_blockers;
+        bool dirty{true};
+    };
+    static constexpr int RenderBlockSize = 4096;
+
+    void update_render_block(int block_idx);
+
+    std::vector<RenderBlock> m_render_blocks;
     std::array<GLIndexedVertexArray, 3> m_varrays;
 };
 
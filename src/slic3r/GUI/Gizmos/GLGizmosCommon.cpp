@@ -244,11 +244,14 @@ void Raycaster::on_update()
 
     std::vector<const TriangleMesh*> meshes;
     const std::vector<ModelVolume*>& mvs = mo->volumes;
+    bool hollowed = false;
     if (mvs.size() == 1) {
         assert(mvs.front()->is_model_part());
         const HollowedMesh* hollowed_mesh_tracker = get_pool()->hollowed_mesh();
-        if (hollowed_mesh_tracker && hollowed_mesh_tracker->get_hollowed_mesh())
+        if (hollowed_mesh_tracker && hollowed_mesh_tracker->get_hollowed_mesh()) {
             meshes.push_back(hollowed_mesh_tracker->get_hollowed_mesh());
+            hollowed = true;
+        }
     }
     if (meshes.empty()) {
         for (const ModelVolume* mv : mvs) {
@@ -259,8 +262,13 @@ void Raycaster::on_update()
 
     if (meshes != m_old_meshes) {
         m_raycasters.clear();
-        for (const TriangleMesh* mesh : meshes)
-            m_raycasters.emplace_back(new MeshRaycaster(*mesh));
+        if (hollowed)
+            // The hollowed mesh is owned by the HollowedMesh tracker, it is not shared with other gizmos.
+            m_raycasters.emplace_back(std::make_shared<const MeshRaycaster>(*meshes.front()));
+        else
+            for (const ModelVolume* mv : mvs)
+                if (mv->is_model_part())
+                    m_raycasters.emplace_back(MeshRaycasterCache::get(mv->get_mesh_shared_ptr()));
         m_old_meshes = meshes;
     }
 }
@@ -274,8 +282,8 @@ void Raycaster::on_release()
 std::vector<const MeshRaycaster*> Raycaster::raycasters() const
 {
     std::vector<const MeshRaycaster*> mrcs;
-    for (const auto& raycaster_unique_ptr : m_raycasters)
-        mrcs.push_back(raycaster_unique_ptr.get());
+    for (const auto& raycaster_ptr : m_raycasters)
+        mrcs.push_back(raycaster_ptr.get());
     return mrcs;
 }
 
@@ -12,6 +12,8 @@
 namespace Slic3r {
 namespace GUI {
 
+static const size_t RASTER_ARRANGE_MIN_ITEMS = 100;
+
 void FillBedJob::prepare()
 {
     m_selected.clear();
@@ -113,6 +115,11 @@ void FillBedJob::process()
     params.allow_rotations  = settings.enable_rotation;
     params.min_obj_distance = scaled(settings.distance);
 
+    // Computing the no fit polygons is far too slow with hundreds of items,
+    // a small extra gap between them is acceptable when filling the bed.
+    if (m_selected.size() > RASTER_ARRANGE_MIN_ITEMS)
+        params.engine = arrangement::ArrangeParams::Engine::Raster;
+
     bool do_stop = false;
     params.stopcondition = [this, &do_stop]() {
         return was_canceled() || do_stop;
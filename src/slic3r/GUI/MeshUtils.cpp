@@ -7,6 +7,8 @@
 
 #include <GL/glew.h>
 
+#include <algorithm>
+
 
 namespace Slic3r {
 namespace GUI {
@@ -69,11 +71,12 @@ void MeshClipper::recalculate_triangles()
     // Calculate distance from mesh origin to the clipping plane (in mesh coordinates).
     float height_mesh = m_plane.distance(m_trafo.get_offset()) * (up_noscale.norm()/up.norm());
 
-    // Now do the cutting
-    std::vector<ExPolygons> list_of_expolys;
+    // Now do the cutting. The slicer keeps the facets sorted along the up direction between the calls,
+    // thus moving the plane without rotating it only visits the facets around the cut.
+    ExPolygons expolys;
     m_tms->set_up_direction(up.cast<float>());
-    m_tms->slice(std::vector<float>{height_mesh}, SlicingMode::Regular, &list_of_expolys, [](){});
-    m_triangles2d = triangulate_expolygons_2f(list_of_expolys[0], m_trafo.get_matrix().matrix().determinant() < 0.);
+    m_tms->slice_sweep(height_mesh, SlicingMode::Regular, &expolys);
+    m_triangles2d = triangulate_expolygons_2f(expolys, m_trafo.get_matrix().matrix().determinant() < 0.);
 
     // Rotate the cut into world coords:
     Eigen::Quaterniond q;
@@ -99,6 +102,23 @@ void MeshClipper::recalculate_triangles()
 }
 
 
+std::vector<MeshRaycasterCache::Entry> MeshRaycasterCache::s_entries;
+
+std::shared_ptr<const MeshRaycaster> MeshRaycasterCache::get(const std::shared_ptr<const TriangleMesh>& mesh)
+{
+    // Drop the raycasters of the released meshes first, their AABB trees may be large.
+    s_entries.erase(std::remove_if(s_entries.begin(), s_entries.end(),
+        [](const Entry& entry) { return entry.mesh.expired(); }), s_entries.end());
+
+    for (const Entry& entry : s_entries)
+        if (entry.mesh.lock() == mesh)
+            return entry.raycaster;
+
+    s_entries.push_back({ mesh, std::make_shared<const MeshRaycaster>(*mesh) });
+    return s_entries.back().raycaster;
+}
+
+
 Vec3f MeshRaycaster::get_triangle_normal(size_t facet_idx) const
 {
     return m_normals[facet_idx];
@@ -9,6 +9,7 @@
 #include "slic3r/GUI/3DScene.hpp"
 
 #include <cfloat>
+#include <memory>
 
 namespace Slic3r {
 
@@ -151,6 +152,22 @@ private:
     std::vector<stl_normal> m_normals;
 };
 
+
+// Raycasters of the ModelVolume meshes shared by the gizmos, so that the AABB tree of a mesh is built once
+// and not each time a gizmo is opened. ModelVolume replaces its mesh instead of modifying it, therefore
+// a cached raycaster is valid as long as its mesh is alive and it is dropped once the mesh is released.
+class MeshRaycasterCache {
+public:
+    static std::shared_ptr<const MeshRaycaster> get(const std::shared_ptr<const TriangleMesh>& mesh);
+
+private:
+    struct Entry {
+        std::weak_ptr<const TriangleMesh>    mesh;
+        std::shared_ptr<const MeshRaycaster> raycaster;
+    };
+    static std::vector<Entry> s_entries;
+};
+
     
 } // namespace GUI
 } // namespace Slic3r
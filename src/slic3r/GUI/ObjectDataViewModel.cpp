@@ -270,6 +270,8 @@ wxDataViewItem ObjectDataViewModel::Add(const wxString &name,
         root->m_bmp = *m_warning_bmp;
 
     m_objects.push_back(root);
+    if (m_objects_idx_valid)
+        m_objects_idx.emplace(root, int(m_objects.size()) - 1);
 	// notify control
 	wxDataViewItem child((void*)root);
 	wxDataViewItem parent((void*)NULL);
@@ -412,6 +414,8 @@ wxDataViewItem ObjectDataViewModel::AddInstanceChild(const wxDataViewItem& paren
 
     // Add instance nodes
     ObjectDataViewModelNode *instance_node = nullptr;    
+    wxDataViewItemArray instance_items;
+    instance_items.Alloc(print_indicator.size());
     size_t counter = 0;
     while (counter < print_indicator.size()) {
         instance_node = new ObjectDataViewModelNode(inst_root_node, itInstance);
@@ -419,11 +423,12 @@ wxDataViewItem ObjectDataViewModel::AddInstanceChild(const wxDataViewItem& paren
         instance_node->set_printable_icon(print_indicator[counter] ? piPrintable : piUnprintable);
 
         inst_root_node->Append(instance_node);
-        // notify control
-        const wxDataViewItem instance_item((void*)instance_node);
-        ItemAdded(inst_root_item, instance_item);
+        instance_items.Add(wxDataViewItem((void*)instance_node));
         ++counter;
     }
+    // notify control once for all the new instances
+    if (!instance_items.IsEmpty())
+        ItemsAdded(inst_root_item, instance_items);
 
     // update object_node printable property
     UpdateObjectPrintable(parent_item);
@@ -465,13 +470,17 @@ void ObjectDataViewModel::UpdateInstancesPrintable(wxDataViewItem parent_item)
     ObjectDataViewModelNode* inst_root_node = static_cast<ObjectDataViewModelNode*>(inst_root_item.GetID());
     const size_t child_cnt = inst_root_node->GetChildren().Count();
 
+    wxDataViewItemArray inst_items;
+    inst_items.Alloc(child_cnt);
     for (size_t i=0; i < child_cnt; i++)
     {
         ObjectDataViewModelNode* inst_node = inst_root_node->GetNthChild(i);
         // and set printable state for object_node to piUndef
         inst_node->set_printable_icon(obj_pi);
-        ItemChanged(wxDataViewItem((void*)inst_node));
+        inst_items.Add(wxDataViewItem((void*)inst_node));
     }
+    if (!inst_items.IsEmpty())
+        ItemsChanged(inst_items);
 }
 
 bool ObjectDataViewModel::IsPrintable(const wxDataViewItem& item) const
@@ -652,8 +661,7 @@ wxDataViewItem ObjectDataViewModel::Delete(const wxDataViewItem &item)
                 ItemDeleted(parent, wxDataViewItem(last_child_node));
 
                 wxCommandEvent event(wxCUSTOMEVT_LAST_VOLUME_IS_DELETED);
-                auto it = find(m_objects.begin(), m_objects.end(), node_parent);
-                event.SetInt(it == m_objects.end() ? -1 : it - m_objects.begin());
+                event.SetInt(get_object_idx(node_parent));
                 wxPostEvent(m_ctrl, event);
 
                 ret_item = parent;
@@ -664,9 +672,9 @@ wxDataViewItem ObjectDataViewModel::Delete(const wxDataViewItem &item)
 	}
 	else
 	{
-		auto it = find(m_objects.begin(), m_objects.end(), node);
-        size_t id = it - m_objects.begin();
-		if (it != m_objects.end())
+        const int obj_idx = get_object_idx(node);
+        size_t id = obj_idx < 0 ? m_objects.size() : size_t(obj_idx);
+		if (obj_idx >= 0)
 		{
             // Delete all sub-items
             int i = m_objects[id]->GetChildCount() - 1;
@@ -674,7 +682,8 @@ wxDataViewItem ObjectDataViewModel::Delete(const wxDataViewItem &item)
                 Delete(wxDataViewItem(m_objects[id]->GetNthChild(i)));
                 i = m_objects[id]->GetChildCount() - 1;
             }
-			m_objects.erase(it);
+			m_objects.erase(m_objects.begin() + id);
+            m_objects_idx_valid = false;
         }
 		if (id > 0) { 
 			if(id == m_objects.size()) id--;
@@ -717,13 +726,17 @@ wxDataViewItem ObjectDataViewModel::DeleteLastInstance(const wxDataViewItem &par
     PrintIndicator last_inst_printable = piUndef;
 
     int stop = delete_inst_root_item ? 0 : inst_cnt - num;
+    items.Alloc(inst_cnt - stop);
     for (int i = inst_cnt - 1; i >= stop;--i) {
         ObjectDataViewModelNode *last_instance_node = inst_root_node->GetNthChild(i);
         if (i==0) last_inst_printable = last_instance_node->IsPrintable();
-        inst_root_node->GetChildren().Remove(last_instance_node);
+        inst_root_node->GetChildren().RemoveAt(i);
         delete last_instance_node;
-        ItemDeleted(inst_root_item, wxDataViewItem(last_instance_node));
+        items.Add(wxDataViewItem(last_instance_node));
     }
+    // notify control once for all the deleted instances
+    if (!items.IsEmpty())
+        ItemsDeleted(inst_root_item, items);
 
     if (delete_inst_root_item) {
         ret_item = parent_item;
@@ -745,12 +758,22 @@ wxDataViewItem ObjectDataViewModel::DeleteLastInstance(const wxDataViewItem &par
 
 void ObjectDataViewModel::DeleteAll()
 {
-	while (!m_objects.empty())
-	{
-		auto object = m_objects.back();
-// 		object->RemoveAllChildren();
-		Delete(wxDataViewItem(object));	
-	}
+    if (m_objects.empty())
+        return;
+
+    // The nodes delete their children. The control is notified once for all the objects,
+    // instead of once for each object, volume, instance and settings item.
+    wxDataViewItemArray items;
+    items.Alloc(m_objects.size());
+    for (ObjectDataViewModelNode* object : m_objects) {
+        items.Add(wxDataViewItem(object));
+        delete object;
+    }
+    m_objects.clear();
+    m_objects_idx.clear();
+    m_objects_idx_valid = false;
+
+    ItemsDeleted(wxDataViewItem(nullptr), items);
 }
 
 void ObjectDataViewModel::DeleteChildren(wxDataViewItem& parent)
@@ -881,6 +904,9 @@ wxDataViewItem ObjectDataViewModel::GetItemById(const int obj_idx, const int sub
         return wxDataViewItem(0);
 
     auto parent = static_cast<ObjectDataViewModelNode*>(item.GetID());
+    // The indices of instances and layers follow their order, check the expected position first.
+    if (sub_obj_idx >= 0 && size_t(sub_obj_idx) < parent->GetChildCount() && parent->GetNthChild(sub_obj_idx)->m_idx == sub_obj_idx)
+        return wxDataViewItem(parent->GetNthChild(sub_obj_idx));
     for (size_t i = 0; i < parent->GetChildCount(); i++)
         if (parent->GetNthChild(i)->m_idx == sub_obj_idx)
             return wxDataViewItem(parent->GetNthChild(i));
@@ -932,11 +958,20 @@ int ObjectDataViewModel::GetIdByItem(const wxDataViewItem& item) const
         return -1;
 
 	ObjectDataViewModelNode *node = static_cast<ObjectDataViewModelNode*>(item.GetID());
-	auto it = find(m_objects.begin(), m_objects.end(), node);
-	if (it == m_objects.end())
-		return -1;
+	return get_object_idx(node);
+}
 
-	return it - m_objects.begin();
+int ObjectDataViewModel::get_object_idx(const ObjectDataViewModelNode* node) const
+{
+    if (!m_objects_idx_valid) {
+        m_objects_idx.clear();
+        m_objects_idx.reserve(m_objects.size());
+        for (size_t i = 0; i < m_objects.size(); ++i)
+            m_objects_idx.emplace(m_objects[i], int(i));
+        m_objects_idx_valid = true;
+    }
+    auto it = m_objects_idx.find(node);
+    return it == m_objects_idx.end() ? -1 : it->second;
 }
 
 int ObjectDataViewModel::GetIdByItemAndType(const wxDataViewItem& item, const ItemType type) const
@@ -1048,9 +1083,9 @@ void ObjectDataViewModel::GetItemInfo(const wxDataViewItem& item, ItemType& type
     while (parent_node->m_type != itObject)
         parent_node = parent_node->GetParent();
 
-    auto it = find(m_objects.begin(), m_objects.end(), parent_node);
-    if (it != m_objects.end())
-        obj_idx = it - m_objects.begin();
+    const int parent_obj_idx = get_object_idx(parent_node);
+    if (parent_obj_idx >= 0)
+        obj_idx = parent_obj_idx;
     else
         type = itUndef;
 }
@@ -1258,6 +1293,7 @@ wxDataViewItem ObjectDataViewModel::ReorganizeObjects(  const int current_id, co
     ItemDeleted(wxDataViewItem(nullptr), wxDataViewItem(deleted_node));
 
     m_objects.emplace(m_objects.begin() + new_id, deleted_node);
+    m_objects_idx_valid = false;
     ItemAdded(wxDataViewItem(nullptr), wxDataViewItem(deleted_node));
 
     // If some item has a children, just to add a deleted item is not enough on Linux 
@@ -3,6 +3,7 @@
 
 #include <wx/dataview.h>
 #include <vector>
+#include <unordered_map>
 #include "libslic3r/Config.hpp"
 
 #include "ExtraRenderers.hpp"
@@ -242,11 +243,18 @@ wxDECLARE_EVENT(wxCUSTOMEVT_LAST_VOLUME_IS_DELETED, wxCommandEvent);
 class ObjectDataViewModel :public wxDataViewModel
 {
     std::vector<ObjectDataViewModelNode*>       m_objects;
+    // Positions of the object nodes in m_objects, rebuilt lazily after m_objects was reordered or shrunk,
+    // so that looking up the index of an object doesn't scan the whole list of objects.
+    mutable std::unordered_map<const ObjectDataViewModelNode*, int> m_objects_idx;
+    mutable bool                                m_objects_idx_valid { false };
     std::vector<wxBitmap*>                      m_volume_bmps;
     wxBitmap*                                   m_warning_bmp { nullptr };
 
     wxDataViewCtrl*                             m_ctrl { nullptr };
 
+    // Index of an object node in m_objects, -1 if it is not an object node.
+    int  get_object_idx(const ObjectDataViewModelNode* node) const;
+
 public:
     ObjectDataViewModel();
     ~ObjectDataViewModel();
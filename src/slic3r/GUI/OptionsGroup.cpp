@@ -971,6 +971,8 @@ boost::any ConfigOptionsGroup::get_config_value(const DynamicPrintConfig& config
             ret = static_cast<int>(config.option<ConfigOptionEnum<SupportZDistanceType>>(opt_key)->value);
         } else if (opt_key == "support_material_pattern") {
             ret = static_cast<int>(config.option<ConfigOptionEnum<SupportMaterialPattern>>(opt_key)->value);
+        } else if (opt_key == "support_material_style") {
+            ret = static_cast<int>(config.option<ConfigOptionEnum<SupportMaterialStyle>>(opt_key)->value);
         } else if (opt_key == "support_pillar_connection_mode") {
             ret  = static_cast<int>(config.option<ConfigOptionEnum<SLAPillarConnectionMode>>(opt_key)->value);
         } else if (opt_key == "wipe_advanced_algo") {
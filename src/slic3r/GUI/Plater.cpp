@@ -4094,11 +4094,31 @@ void Plater::priv::generate_thumbnail(ThumbnailData& data, unsigned int w, unsig
 
 ThumbnailsList Plater::priv::generate_thumbnails(const ThumbnailsParams& params)
 {
+    // The scene is rendered once for the largest of the requested sizes with the same aspect ratio,
+    // the smaller thumbnails are downscaled on the CPU, which also antialiases them.
+    std::vector<Point> sizes;
+    for (const Vec2d& size : params.sizes)
+        sizes.emplace_back(Point(size)); // round to ints
+    auto same_aspect = [](const Point& s1, const Point& s2) {
+        return std::abs(double(s1.x()) * double(s2.y()) - double(s2.x()) * double(s1.y())) <= 0.01 * double(s1.x()) * double(s2.y());
+    };
+
+    std::vector<ThumbnailData> rendered(sizes.size());
     ThumbnailsList thumbnails;
-    for (const Vec2d& size : params.sizes) {
-        thumbnails.push_back(ThumbnailData());
-        Point isize(size); // round to ints
-        generate_thumbnail(thumbnails.back(), isize.x(), isize.y(), params.printable_only, params.parts_only, params.show_bed, params.transparent_background);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const Point& isize = sizes[i];
+        if (isize.x() <= 0 || isize.y() <= 0)
+            continue;
+        size_t largest = i;
+        for (size_t j = 0; j < sizes.size(); ++j)
+            if (sizes[j].x() > sizes[largest].x() && same_aspect(sizes[j], isize))
+                largest = j;
+        if (!rendered[largest].is_valid())
+            generate_thumbnail(rendered[largest], sizes[largest].x(), sizes[largest].y(), params.printable_only, params.parts_only, params.show_bed, params.transparent_background);
+        if (largest == i)
+            thumbnails.push_back(rendered[i]);
+        else
+            thumbnails.push_back(downscaled(rendered[largest], isize.x(), isize.y()));
         if (!thumbnails.back().is_valid())
             thumbnails.pop_back();
     }
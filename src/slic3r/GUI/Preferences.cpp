@@ -46,6 +46,8 @@ std::shared_ptr<ConfigOptionsGroup> PreferencesDialog::create_general_options_gr
             m_values[opt_key] = boost::any_cast<bool>(value) ? "none" : "discard";
         else if (std::unordered_set<std::string>{ "splash_screen_editor", "splash_screen_gcodeviewer", "auto_switch_preview" }.count(opt_key) > 0)
             m_values[opt_key] = boost::any_cast<std::string>(value);
+        else if (opt_key == "slicing_threads")
+            m_values[opt_key] = std::to_string(boost::any_cast<int>(value));
         else
             m_values[opt_key] = boost::any_cast<bool>(value) ? "1" : "0";
     };
@@ -178,6 +180,23 @@ void PreferencesDialog::build()
         option = Option(def, "export_sources_full_pathnames");
         m_optgroups_general.back()->append_single_option_line(option);
 
+        def.label = L("Keep the slices cache on disk");
+        def.type = coBool;
+        def.tooltip = L("If enabled, the results of slicing are stored in the cache folder of the configuration directory, "
+            "so that an object sliced with the same settings is not sliced again, even after a restart of the application.");
+        def.set_default_value(new ConfigOptionBool(app_config->get("slices_cache_on_disk") == "1"));
+        option = Option(def, "slices_cache_on_disk");
+        m_optgroups_general.back()->append_single_option_line(option);
+
+        def.label = L("Number of slicing threads");
+        def.type = coInt;
+        def.tooltip = L("Maximum number of threads used by the background slicing and the G-code export. "
+            "Set it lower than the number of cores to keep the user interface responsive while slicing. Set to 0 to use all the cores.");
+        def.set_default_value(new ConfigOptionInt{ atoi(app_config->get("slicing_threads").c_str()) });
+        option = Option(def, "slicing_threads");
+        option.opt.width = 6;
+        m_optgroups_general.back()->append_single_option_line(option);
+
 #if ENABLE_CUSTOMIZABLE_FILES_ASSOCIATION_ON_WIN
 #ifdef _WIN32
 		// Please keep in sync with ConfigWizard
@@ -1,6 +1,8 @@
 #include "Search.hpp"
 
+#include <algorithm>
 #include <cstddef>
+#include <cwctype>
 #include <string>
 #include <boost/algorithm/string.hpp>
 #include <boost/optional.hpp>
@@ -170,8 +172,7 @@ static bool fuzzy_match(const std::wstring &search_pattern, const std::wstring &
 		return false;
 }
 
-static bool strong_match(const std::wstring& search_pattern, const std::wstring& label, int& out_score, std::vector<uint16_t>& out_matches) {
-    std::wregex pattern(search_pattern, std::regex_constants::icase);
+static bool strong_match(const std::wregex& pattern, const std::wstring& label, int& out_score, std::vector<uint16_t>& out_matches) {
     std::wsmatch sm;
     out_matches.clear();
     out_score = 0;
@@ -190,6 +191,128 @@ static bool strong_match(const std::wstring& search_pattern, const std::wstring&
     return out_score > 0;
 }
 
+// Label of an option as shown in the search list: "category : group : label", skipping the repeated parts.
+static std::wstring get_label(const Option& opt, bool category, bool english, char marker = 0)
+{
+    static const std::wstring sep = L" : ";
+    std::wstring out;
+    if (marker != 0)
+        out += marker;
+    const std::wstring* prev = nullptr;
+    for (const std::wstring* const s : {
+        category ? (english ? &opt.category : &opt.category_local) : nullptr,
+            english ? &opt.group : &opt.group_local, english ? &opt.label : &opt.label_local })
+        if (s != nullptr && (prev == nullptr || *prev != *s)) {
+            if (out.size() > 2)
+                out += sep;
+            out += *s;
+            prev = s;
+        }
+    return out;
+}
+
+// Bit of a character in OptionIndexEntry::chars_mask. Letters and digits have their own bits,
+// the other characters share the remaining ones.
+static uint64_t char_bit(wchar_t c)
+{
+    c = wchar_t(std::towlower(c));
+    if (c >= L'a' && c <= L'z')
+        return uint64_t(1) << (c - L'a');
+    if (c >= L'0' && c <= L'9')
+        return uint64_t(1) << (26 + c - L'0');
+    return uint64_t(1) << (36 + uint64_t(c) % 28);
+}
+
+// Key of the trigram starting at str[pos], str is expected in lower case.
+static uint64_t trigram_key(const std::wstring& str, size_t pos)
+{
+    return (uint64_t(uint32_t(str[pos]) & 0x1FFFFF) << 42) | (uint64_t(uint32_t(str[pos + 1]) & 0x1FFFFF) << 21) | uint64_t(uint32_t(str[pos + 2]) & 0x1FFFFF);
+}
+
+static std::wstring to_lower(const std::wstring& str)
+{
+    std::wstring out(str);
+    for (wchar_t& c : out)
+        c = wchar_t(std::towlower(c));
+    return out;
+}
+
+void OptionsSearcher::update_index()
+{
+    index.clear();
+    trigrams.clear();
+    index.reserve(options.size());
+    index_category = view_params.category;
+
+    for (size_t i = 0; i < options.size(); ++ i) {
+        const Option& opt = options[i];
+        OptionIndexEntry entry;
+        entry.label         = get_label(opt, index_category, false);
+        entry.label_english = get_label(opt, index_category, true);
+        for (const std::wstring* str : { &entry.label, &entry.label_english, &opt.opt_key }) {
+            for (wchar_t c : *str) {
+                entry.chars_mask |= char_bit(c);
+                // fuzzy_match() matches the ASCII folding of a character too.
+                wchar_t tmp[4];
+                for (wchar_t *f = tmp, *end = fold_to_ascii(c, tmp); f != end; ++ f)
+                    entry.chars_mask |= char_bit(*f);
+            }
+            const std::wstring lower = to_lower(*str);
+            for (size_t j = 0; j + 2 < lower.size(); ++ j) {
+                std::vector<size_t>& list = trigrams[trigram_key(lower, j)];
+                if (list.empty() || list.back() != i)
+                    list.emplace_back(i);
+            }
+        }
+        index.emplace_back(std::move(entry));
+    }
+}
+
+std::vector<size_t> OptionsSearcher::search_candidates(const std::wstring& pattern) const
+{
+    std::vector<size_t> candidates;
+    const bool ascii = std::all_of(pattern.begin(), pattern.end(), [](wchar_t c) { return c < 0x80; });
+
+    if (view_params.exact && (! ascii || pattern.find_first_of(L"\\^$.|?*+()[]{}") != std::wstring::npos)) {
+        // Don't filter a regular expression with special characters, nor a pattern with non ASCII characters,
+        // whose case insensitive regex matching depends on the locale.
+        candidates.reserve(options.size());
+        for (size_t i = 0; i < options.size(); ++ i)
+            candidates.emplace_back(i);
+        return candidates;
+    }
+
+    if (view_params.exact && pattern.size() >= 3) {
+        // A regular expression without special characters matches a substring, which contains all the trigrams of the pattern.
+        const std::wstring lower = to_lower(pattern);
+        std::vector<const std::vector<size_t>*> lists;
+        for (size_t j = 0; j + 2 < lower.size(); ++ j) {
+            auto it = trigrams.find(trigram_key(lower, j));
+            if (it == trigrams.end())
+                return candidates;
+            lists.emplace_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(), [](const std::vector<size_t>* l1, const std::vector<size_t>* l2) { return l1->size() < l2->size(); });
+        candidates = *lists.front();
+        std::vector<size_t> intersection;
+        for (size_t j = 1; j < lists.size() && ! candidates.empty(); ++ j) {
+            intersection.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), lists[j]->begin(), lists[j]->end(), std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+        return candidates;
+    }
+
+    // Both the fuzzy matching and the exact matching need all the characters of the pattern to be present.
+    uint64_t mask = 0;
+    for (wchar_t c : pattern)
+        mask |= char_bit(c);
+    for (size_t i = 0; i < index.size(); ++ i)
+        if ((index[i].chars_mask & mask) == mask)
+            candidates.emplace_back(i);
+    return candidates;
+}
+
 bool OptionsSearcher::search(const std::string& search, bool force/* = false*/)
 {
     if (search_line == search && !force)
@@ -197,45 +320,13 @@ bool OptionsSearcher::search(const std::string& search, bool force/* = false*/)
 
     found.clear();
 
+    // The index is built lazily, after the options or the view parameters changed.
+    if (index.size() != options.size() || index_category != view_params.category)
+        update_index();
+
     bool full_list = search.empty();
     std::wstring sep = L" : ";
 
-    auto get_label = [this, &sep](const Option& opt, bool marked = true)
-    {
-        std::wstring out;
-        if (marked)
-            out += marker_by_type(opt.type, printer_technology);
-        const std::wstring* prev = nullptr;
-        for (const std::wstring* const s : {
-            view_params.category ? &opt.category_local : nullptr,
-                & opt.group_local, & opt.label_local })
-            if (s != nullptr && (prev == nullptr || *prev != *s)) {
-                if (out.size() > 2)
-                    out += sep;
-                out += *s;
-                prev = s;
-            }
-            return out;
-    };
-
-    auto get_label_english = [this, &sep](const Option& opt, bool marked = true)
-    {
-        std::wstring out;
-        if (marked)
-            out += marker_by_type(opt.type, printer_technology);
-        const std::wstring* prev = nullptr;
-        for (const std::wstring* const s : {
-            view_params.category ? &opt.category : nullptr,
-                & opt.group, & opt.label })
-            if (s != nullptr && (prev == nullptr || *prev != *s)) {
-                if (out.size() > 2)
-                    out += sep;
-                out += *s;
-                prev = s;
-            }
-            return out;
-    };
-
     auto get_tooltip = [this, &sep](const Option& opt)
     {
         return  marker_by_type(opt.type, printer_technology) +
@@ -243,59 +334,63 @@ bool OptionsSearcher::search(const std::string& search, bool force/* = false*/)
                 opt.group_local + sep + opt.label_local;
     };
 
-    std::vector<uint16_t> matches, matches2;
-    for (size_t i=0; i < options.size(); i++)
-    {
-        const Option &opt = options[i];
-        if (full_list) {
-            std::string label = into_u8(get_label(opt));
+    if (full_list) {
+        for (size_t i = 0; i < options.size(); i++) {
+            const Option &opt = options[i];
+            std::string label = into_u8(get_label(opt, view_params.category, false, marker_by_type(opt.type, printer_technology)));
             found.emplace_back(FoundOption{ label, label, boost::nowide::narrow(get_tooltip(opt)), i, 0 });
-            continue;
         }
-
+    } else {
         std::wstring wsearch       = boost::nowide::widen(search);
         boost::trim_left(wsearch);
-        std::wstring label         = get_label(opt, false);
-        std::wstring label_english = get_label_english(opt, false);
-        int score = std::numeric_limits<int>::min();
-        int score2;
-        matches.clear();
-        if(view_params.exact)
-            strong_match(wsearch, label, score, matches);
-        else
-            fuzzy_match(wsearch, label, score, matches);
-
-        if ( (view_params.exact ? strong_match(wsearch, opt.opt_key, score2, matches2):fuzzy_match(wsearch, opt.opt_key, score2, matches2)) && (view_params.exact || score2 > score) ) {
-        	for (fts::pos_type &pos : matches2)
-        		pos += label.size() + 1;
-        	label += L"(" + opt.opt_key + L")";
-        	append(matches, matches2);
-        	score = std::max(score, score2);
-        }
-        if (view_params.english && (view_params.exact ? strong_match(wsearch, label_english, score2, matches2) : fuzzy_match(wsearch, label_english, score2, matches2)) && score2 > score) {
-        	label   = std::move(label_english);
-        	matches = std::move(matches2);
-        	score   = score2;
-        }
-        if (score > 90/*std::numeric_limits<int>::min()*/) {
-		    label = mark_string(label, matches, opt.type, printer_technology);
-            label += L"  [" + std::to_wstring(score) + L"]";// add score value
-	        std::string label_u8 = into_u8(label);
-	        std::string label_plain = label_u8;
+        std::wregex  pattern;
+        if (view_params.exact)
+            pattern = std::wregex(wsearch, std::regex_constants::icase);
+        auto match = [this, &wsearch, &pattern](const std::wstring& label, int& out_score, std::vector<uint16_t>& out_matches) {
+            return view_params.exact ? strong_match(pattern, label, out_score, out_matches) : fuzzy_match(wsearch, label, out_score, out_matches);
+        };
+
+        std::vector<uint16_t> matches, matches2;
+        for (size_t i : search_candidates(wsearch))
+        {
+            const Option           &opt   = options[i];
+            const OptionIndexEntry &entry = index[i];
+            std::wstring label = entry.label;
+            int score = std::numeric_limits<int>::min();
+            int score2;
+            matches.clear();
+            match(label, score, matches);
+
+            if (match(opt.opt_key, score2, matches2) && (view_params.exact || score2 > score)) {
+            	for (fts::pos_type &pos : matches2)
+            		pos += label.size() + 1;
+            	label += L"(" + opt.opt_key + L")";
+            	append(matches, matches2);
+            	score = std::max(score, score2);
+            }
+            if (view_params.english && match(entry.label_english, score2, matches2) && score2 > score) {
+            	label   = entry.label_english;
+            	matches = std::move(matches2);
+            	score   = score2;
+            }
+            if (score > 90/*std::numeric_limits<int>::min()*/) {
+		        label = mark_string(label, matches, opt.type, printer_technology);
+                label += L"  [" + std::to_wstring(score) + L"]";// add score value
+	            std::string label_u8 = into_u8(label);
+	            std::string label_plain = label_u8;
 
 #ifdef SUPPORTS_MARKUP
-            boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)), "<b>");
-            boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)),   "</b>");
+                boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)), "<b>");
+                boost::replace_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)),   "</b>");
 #else
-            boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)));
-            boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)));
+                boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerStart)));
+                boost::erase_all(label_plain, std::string(1, char(ImGui::ColorMarkerEnd)));
 #endif
-	        found.emplace_back(FoundOption{ label_plain, label_u8, boost::nowide::narrow(get_tooltip(opt)), i, score });
+	            found.emplace_back(FoundOption{ label_plain, label_u8, boost::nowide::narrow(get_tooltip(opt)), i, score });
+            }
         }
-    }
-
-    if (!full_list)
         sort_found();
+    }
  
     if (search_line != search)
         search_line = search;
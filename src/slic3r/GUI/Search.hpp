@@ -1,8 +1,10 @@
 #ifndef slic3r_SearchComboBox_hpp_
 #define slic3r_SearchComboBox_hpp_
 
+#include <cstdint>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include <wx/panel.h>
 #include <wx/sizer.h>
@@ -52,6 +54,16 @@ struct Option {
     std::wstring    category_local;
 };
 
+// Search data of an Option precomputed by OptionsSearcher::update_index(), so that a keystroke in the search line
+// does not rebuild the labels of all options and the fuzzy matching runs over the possible candidates only.
+struct OptionIndexEntry {
+    // Labels as matched by OptionsSearcher::search(), without the icon marker.
+    std::wstring    label;
+    std::wstring    label_english;
+    // Bit mask of the lower case characters (and of their ASCII foldings) of label, label_english and opt_key.
+    uint64_t        chars_mask {0};
+};
+
 struct FoundOption {
 	// UTF8 encoding, to be consumed by ImGUI by reference.
     std::string     label;
@@ -82,11 +94,22 @@ class OptionsSearcher
     std::vector<Option>                     options {};
     std::vector<FoundOption>                found {};
 
+    // Search index, one entry per option in the order of options.
+    std::vector<OptionIndexEntry>           index {};
+    // Lower case character trigrams of the labels and opt_keys, with the sorted indices of the options containing them.
+    std::unordered_map<uint64_t, std::vector<size_t>> trigrams {};
+    // Value of view_params.category the index was built for.
+    bool                                    index_category {false};
+
     void append_options(DynamicPrintConfig* config, Preset::Type type, ConfigOptionMode mode);
+    void update_index();
+    // Indices of the options, which may match the search pattern.
+    std::vector<size_t> search_candidates(const std::wstring& pattern) const;
 
     void sort_options() {
         std::sort(options.begin(), options.end(), [](const Option& o1, const Option& o2) {
             return o1.label < o2.label; });
+        index.clear();
     }
     void sort_found() {
         std::sort(found.begin(), found.end(), [](const FoundOption& f1, const FoundOption& f2) {
@@ -128,6 +151,7 @@ public:
     void sort_options_by_opt_key() {
         std::sort(options.begin(), options.end(), [](const Option& o1, const Option& o2) {
             return o1.opt_key < o2.opt_key; });
+        index.clear();
     }
 
     static void register_label_override(t_config_option_key key, std::string label, std::string full_label, std::string tooltip) {
@@ -560,21 +560,39 @@ void Tab::update_labels_colour()
     }
 }
 
+// Only the fields of the active page exist, the other pages are built when they get selected.
+// The state of all options is kept in m_options_list, so only the active page is decorated here,
+// instead of searching every option of the preset in the active page.
 void Tab::decorate()
 {
-    for (const auto opt : m_options_list)
+    std::vector<std::pair<const std::pair<const std::string, int>*, Field*>> options_to_decorate;
+    for (const char *opt_key : { "bed_shape", "filament_ramming_parameters", "compatible_prints", "compatible_printers" }) {
+        auto it = m_options_list.find(opt_key);
+        if (it != m_options_list.end())
+            options_to_decorate.emplace_back(&(*it), nullptr);
+    }
+    if (m_active_page)
+        for (const ConfigOptionsGroupShp &group : m_active_page->m_optgroups)
+            for (const auto &kvp : group->opt_map()) {
+                if (m_colored_Label_colors.find(kvp.first) != m_colored_Label_colors.end())
+                    continue;
+                Field *field = group->get_field(kvp.first);
+                auto   it    = m_options_list.find(kvp.first);
+                if (field != nullptr && it != m_options_list.end())
+                    options_to_decorate.emplace_back(&(*it), field);
+            }
+
+    for (const auto &opt_and_field : options_to_decorate)
     {
-        Field*          field = nullptr;
+        const auto     &opt = *opt_and_field.first;
+        Field*          field = opt_and_field.second;
         wxColour*   colored_label_clr = nullptr;
 
-        if (opt.first == "bed_shape" || opt.first == "filament_ramming_parameters" ||
-            opt.first == "compatible_prints" || opt.first == "compatible_printers")
-            colored_label_clr = (m_colored_Label_colors.find(opt.first) == m_colored_Label_colors.end()) ? nullptr : &m_colored_Label_colors.at(opt.first);
-
-        if (!colored_label_clr) {
-            field = get_field(opt.first);
-            if (!field)
+        if (field == nullptr) {
+            auto it_clr = m_colored_Label_colors.find(opt.first);
+            if (it_clr == m_colored_Label_colors.end())
                 continue;
+            colored_label_clr = &it_clr->second;
         }
 
         bool is_nonsys_value = false;
@@ -1467,6 +1485,27 @@ t_change set_or_add(t_change previous, t_change toadd) {
     };
 }
 
+// Content of a ui_layout file, trimmed and without comments. The files are read once per session:
+// the extruder and milling pages are created from the same file for each tool, and again when the
+// printer preset changes the tools count.
+static const std::vector<std::string>& ui_layout_lines(const boost::filesystem::path &ui_layout_file)
+{
+    static std::map<std::string, std::vector<std::string>> cache;
+    auto it = cache.find(ui_layout_file.string());
+    if (it != cache.end())
+        return it->second;
+    std::vector<std::string> &lines = cache[ui_layout_file.string()];
+    boost::filesystem::ifstream filestream(ui_layout_file);
+    std::string full_line;
+    while (std::getline(filestream, full_line)) {
+        //remove spaces
+        boost::algorithm::trim(full_line);
+        if (full_line.size() < 4 || full_line[0] == '#') continue;
+        lines.push_back(full_line);
+    }
+    return lines;
+}
+
 bool Tab::create_pages(std::string setting_type_name, int idx_page)
 {
     //search for the file
@@ -1497,13 +1536,7 @@ bool Tab::create_pages(std::string setting_type_name, int idx_page)
     bool logs = false;
 
     //read file
-    //std::ifstream filestream(ui_layout_file.c_str());
-    boost::filesystem::ifstream filestream(ui_layout_file);
-    std::string full_line;
-    while (std::getline(filestream, full_line)) {
-        //remove spaces
-        boost::algorithm::trim(full_line);
-        if (full_line.size() < 4 || full_line[0] == '#') continue;
+    for (const std::string &full_line : ui_layout_lines(ui_layout_file)) {
         //get main command
         if (boost::starts_with(full_line, "logs"))
         {
@@ -983,6 +983,8 @@ static wxString get_string_value(std::string opt_key, const DynamicPrintConfig&
             return get_string_from_enum<SupportZDistanceType>(opt_key, config);
         if (opt_key == "support_material_pattern")
             return get_string_from_enum<SupportMaterialPattern>(opt_key, config);
+        if (opt_key == "support_material_style")
+            return get_string_from_enum<SupportMaterialStyle>(opt_key, config);
         if (opt_key == "support_pillar_connection_mode")
             return get_string_from_enum<SLAPillarConnectionMode>(opt_key, config);
         if (opt_key == "wipe_advanced_algo")
@@ -10,6 +10,7 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/log/trivial.hpp>
 
 #include <curl/curl.h>
@@ -105,6 +106,7 @@ struct Http::priv
 	enum {
 		DEFAULT_TIMEOUT_CONNECT = 10,
 		DEFAULT_SIZE_LIMIT = 5 * 1024 * 1024,
+		UPLOAD_BUFFER_SIZE = 512 * 1024,
 	};
 
 	::CURL *curl;
@@ -126,12 +128,14 @@ struct Http::priv
 	Http::CompleteFn completefn;
 	Http::ErrorFn errorfn;
 	Http::ProgressFn progressfn;
+	Http::HeaderFn headerfn;
 
 	priv(const std::string &url);
 	~priv();
 
 	static bool ca_file_supported(::CURL *curl);
 	static size_t writecb(void *data, size_t size, size_t nmemb, void *userp);
+	static size_t headercb(char *data, size_t size, size_t nitems, void *userp);
 	static int xfercb(void *userp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 	static int xfercb_legacy(void *userp, double dltotal, double dlnow, double ultotal, double ulnow);
 	static size_t form_file_read_cb(char *buffer, size_t size, size_t nitems, void *userp);
@@ -215,6 +219,25 @@ size_t Http::priv::writecb(void *data, size_t size, size_t nmemb, void *userp)
 	return realsize;
 }
 
+size_t Http::priv::headercb(char *data, size_t size, size_t nitems, void *userp)
+{
+	auto self = static_cast<priv*>(userp);
+	const size_t realsize = size * nitems;
+
+	// The status line and the empty line terminating the headers have no colon and are skipped.
+	const std::string line(data, realsize);
+	const size_t colon = line.find(':');
+	if (colon != std::string::npos && self->headerfn) {
+		std::string name  = line.substr(0, colon);
+		std::string value = line.substr(colon + 1);
+		boost::algorithm::trim(name);
+		boost::algorithm::trim(value);
+		self->headerfn(std::move(name), std::move(value));
+	}
+
+	return realsize;
+}
+
 int Http::priv::xfercb(void *userp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
 {
 	auto self = static_cast<priv*>(userp);
@@ -326,6 +349,11 @@ void Http::priv::http_perform()
 	::curl_easy_setopt(curl, CURLOPT_WRITEDATA, static_cast<void*>(this));
 	::curl_easy_setopt(curl, CURLOPT_READFUNCTION, form_file_read_cb);
 
+	if (headerfn) {
+		::curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headercb);
+		::curl_easy_setopt(curl, CURLOPT_HEADERDATA, static_cast<void*>(this));
+	}
+
 	::curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
 #if LIBCURL_VERSION_MAJOR >= 7 && LIBCURL_VERSION_MINOR >= 32
 	::curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, xfercb);
@@ -348,6 +376,14 @@ void Http::priv::http_perform()
 		::curl_easy_setopt(curl, CURLOPT_HTTPPOST, form);
 	}
 
+#if LIBCURL_VERSION_NUM >= 0x073E00
+	if (! form_files.empty() || putFile) {
+		// The uploaded G-code is read through form_file_read_cb() in blocks of the upload buffer size.
+		// Sending it in larger blocks than the default 64 kB reduces the per block overhead on slow links.
+		::curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, long(UPLOAD_BUFFER_SIZE));
+	}
+#endif
+
 	if (!postfields.empty()) {
 		::curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postfields.c_str());
 		::curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, postfields.size());
@@ -527,6 +563,12 @@ Http& Http::on_progress(ProgressFn fn)
 	return *this;
 }
 
+Http& Http::on_header(HeaderFn fn)
+{
+	if (p) { p->headerfn = std::move(fn); }
+	return *this;
+}
+
 Http::Ptr Http::perform()
 {
 	auto self = std::make_shared<Http>(std::move(*this));
@@ -41,6 +41,10 @@ public:
 	// Writing true to the `cancel` reference cancels the request in progress.
 	typedef std::function<void(Progress, bool& /* cancel */)> ProgressFn;
 
+	// Called once for each response header line, with the header name and its value trimmed of whitespace.
+	// When redirects are followed, the headers of the intermediate responses are reported as well.
+	typedef std::function<void(std::string /* name */, std::string /* value */)> HeaderFn;
+
 	Http(Http &&other);
 
 	// Note: strings are expected to be UTF-8-encoded
@@ -105,6 +109,8 @@ public:
 	// See the `Progress` structure for description of the data passed.
 	// Writing a true-ish value into the cancel reference parameter cancels the request.
 	Http& on_progress(ProgressFn fn);
+	// Callback called for each header of the response, see HeaderFn.
+	Http& on_header(HeaderFn fn);
 
 	// Starts performing the request in a background thread
 	Ptr perform();
@@ -1,6 +1,7 @@
 #include "PresetUpdater.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <thread>
 #include <unordered_map>
 #include <ostream>
@@ -13,6 +14,9 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include <wx/app.h>
 #include <wx/msgdlg.h>
 
@@ -52,6 +56,9 @@ enum {
 
 static const char *INDEX_FILENAME = "index.idx";
 static const char *TMP_EXTENSION = ".download";
+static const char *VALIDATORS_EXTENSION = ".validators";
+// Number of vendors synchronized concurrently by sync_config().
+static const size_t MAX_PARALLEL_DOWNLOADS = 4;
 
 
 void copy_file_fix(const fs::path &source, const fs::path &target)
@@ -71,6 +78,60 @@ void copy_file_fix(const fs::path &source, const fs::path &target)
 	fs::permissions(target, perms);
 }
 
+// HTTP cache validators (ETag, Last-Modified) of a file downloaded into the cache, saved next to the file.
+// They are sent back with the next request of the same url, so that the server answers "304 Not Modified"
+// instead of sending an unchanged index or bundle again.
+struct CacheValidators
+{
+	std::string url;
+	std::string etag;
+	std::string last_modified;
+
+	bool empty() const { return etag.empty() && last_modified.empty(); }
+
+	static fs::path path_for(const fs::path &cached_path)
+	{
+		fs::path path = cached_path;
+		path += VALIDATORS_EXTENSION;
+		return path;
+	}
+
+	// Returns false if there are no usable validators for the cached file.
+	bool load(const fs::path &cached_path)
+	{
+		const fs::path path = path_for(cached_path);
+		if (! fs::exists(cached_path) || ! fs::exists(path))
+			return false;
+		fs::ifstream file(path);
+		std::getline(file, url);
+		std::getline(file, etag);
+		std::getline(file, last_modified);
+		return ! url.empty() && ! this->empty();
+	}
+
+	void save(const fs::path &cached_path) const
+	{
+		if (this->empty())
+			return;
+		fs::ofstream file(path_for(cached_path), std::ios::out | std::ios::trunc);
+		file << url << '\n' << etag << '\n' << last_modified << '\n';
+	}
+
+	// To be called whenever the cached file is replaced by other means than a download of the url.
+	static void invalidate(const fs::path &cached_path)
+	{
+		boost::system::error_code ec;
+		fs::remove(path_for(cached_path), ec);
+	}
+};
+
+enum class GetFileResult
+{
+	Failed,
+	Downloaded,
+	NotModified,
+};
+
 struct Update
 {
 	fs::path source;
@@ -165,9 +226,11 @@ struct PresetUpdater::priv
 
 	void set_download_prefs(AppConfig *app_config);
 	bool get_file(const std::string &url, const fs::path &target_path) const;
+	GetFileResult get_file_if_modified(const std::string &url, const fs::path &target_path, const fs::path &cached_path, CacheValidators &new_validators) const;
 	void prune_tmps() const;
 	void sync_version() const;
 	void sync_config(const VendorMap vendors);
+	void sync_index(Index &index, const VendorMap &vendors) const;
 
 	void check_install_indices() const;
 	Updates get_config_updates(const Semver& old_slic3r_version) const;
@@ -199,7 +262,18 @@ void PresetUpdater::priv::set_download_prefs(AppConfig *app_config)
 // Downloads a file (http get operation). Cancels if the Updater is being destroyed.
 bool PresetUpdater::priv::get_file(const std::string &url, const fs::path &target_path) const
 {
-	bool res = false;
+	CacheValidators new_validators;
+	return get_file_if_modified(url, target_path, fs::path(), new_validators) == GetFileResult::Downloaded;
+}
+
+// Downloads a file like get_file(), but if the file at cached_path was downloaded from the same url before,
+// the server is asked to send it only if it has changed since (conditional request). NotModified is returned
+// for a "304 Not Modified" response, target_path is not touched then.
+// The validators of a fresh download are returned in new_validators, to be saved by the caller
+// once the downloaded file is accepted into the cache.
+GetFileResult PresetUpdater::priv::get_file_if_modified(const std::string &url, const fs::path &target_path, const fs::path &cached_path, CacheValidators &new_validators) const
+{
+	GetFileResult res = GetFileResult::Failed;
 	fs::path tmp_path = target_path;
 	tmp_path += format(".%1%%2%", get_current_pid(), TMP_EXTENSION);
 
@@ -208,9 +282,26 @@ bool PresetUpdater::priv::get_file(const std::string &url, const fs::path &targe
 		target_path.string(),
 		tmp_path.string());
 
-	Http::get(url)
-		.on_progress([this](Http::Progress, bool &cancel) {
-			if (cancel) { cancel = true; }
+	new_validators = CacheValidators();
+	new_validators.url = url;
+
+	auto http = Http::get(url);
+	CacheValidators old_validators;
+	if (! cached_path.empty() && old_validators.load(cached_path) && old_validators.url == url) {
+		if (! old_validators.etag.empty())
+			http.header("If-None-Match", old_validators.etag);
+		if (! old_validators.last_modified.empty())
+			http.header("If-Modified-Since", old_validators.last_modified);
+	}
+
+	http.on_progress([this](Http::Progress, bool &cancel) {
+			cancel = this->cancel;
+		})
+		.on_header([&](std::string name, std::string value) {
+			if (boost::iequals(name, "ETag"))
+				new_validators.etag = std::move(value);
+			else if (boost::iequals(name, "Last-Modified"))
+				new_validators.last_modified = std::move(value);
 		})
 		.on_error([&](std::string body, std::string error, unsigned http_status) {
 			(void)body;
@@ -219,12 +310,17 @@ bool PresetUpdater::priv::get_file(const std::string &url, const fs::path &targe
 				http_status,
 				error);
 		})
-		.on_complete([&](std::string body, unsigned /* http_status */) {
+		.on_complete([&](std::string body, unsigned http_status) {
+			if (http_status == 304) {
+				BOOST_LOG_TRIVIAL(info) << format("Not modified: `%1%`", url);
+				res = GetFileResult::NotModified;
+				return;
+			}
 			fs::fstream file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
 			file.write(body.c_str(), body.size());
 			file.close();
 			fs::rename(tmp_path, target_path);
-			res = true;
+			res = GetFileResult::Downloaded;
 		})
 		.perform_sync();
 
@@ -298,7 +394,8 @@ void PresetUpdater::priv::sync_version() const
 }
 
 // Download vendor indices. Also download new bundles if an index indicates there's a new one available.
-// Both are saved in cache.
+// Both are saved in cache. The vendors are independent of each other, they are synchronized by a few
+// worker threads, so that a slow vendor server does not hold up the others.
 void PresetUpdater::priv::sync_config(const VendorMap vendors)
 {
 	BOOST_LOG_TRIVIAL(info) << "Syncing configuration cache";
@@ -307,102 +404,133 @@ void PresetUpdater::priv::sync_config(const VendorMap vendors)
 
 	// Donwload vendor preset bundles
 	// Over all indices from the cache directory:
-	for (auto &index : index_db) {
-		if (cancel) { return; }
+	std::atomic<size_t> next_index(0);
+	auto worker = [this, &vendors, &next_index]() {
+		for (size_t i = next_index ++; i < index_db.size() && ! cancel; i = next_index ++)
+			sync_index(index_db[i], vendors);
+	};
+	std::vector<std::thread> workers;
+	const size_t num_workers = std::min(index_db.size(), MAX_PARALLEL_DOWNLOADS);
+	for (size_t i = 1; i < num_workers; ++ i)
+		workers.emplace_back(worker);
+	worker();
+	for (std::thread &t : workers)
+		t.join();
+}
 
-		const auto vendor_it = vendors.find(index.vendor());
-		if (vendor_it == vendors.end()) {
-			BOOST_LOG_TRIVIAL(warning) << "No such vendor: " << index.vendor();
-			continue;
-		}
+// Download a fresh index of a single vendor and the recommended bundle, if newer than the installed one.
+// Called from the worker threads of sync_config(), touches only the files of this vendor.
+void PresetUpdater::priv::sync_index(Index &index, const VendorMap &vendors) const
+{
+	const auto vendor_it = vendors.find(index.vendor());
+	if (vendor_it == vendors.end()) {
+		BOOST_LOG_TRIVIAL(warning) << "No such vendor: " << index.vendor();
+		return;
+	}
 
-		const VendorProfile &vendor = vendor_it->second;
-		if (vendor.config_update_url.empty()) {
-			BOOST_LOG_TRIVIAL(info) << "Vendor has no config_update_url: " << vendor.name;
-			continue;
-		}
+	const VendorProfile &vendor = vendor_it->second;
+	if (vendor.config_update_url.empty()) {
+		BOOST_LOG_TRIVIAL(info) << "Vendor has no config_update_url: " << vendor.name;
+		return;
+	}
 
-		// Download a fresh index
-		BOOST_LOG_TRIVIAL(info) << "Downloading index for vendor: " << vendor.name;
-		const auto idx_url = vendor.config_update_url + "/" + INDEX_FILENAME;
-		const std::string idx_path = (cache_path / (vendor.id + ".idx")).string();
-		const std::string idx_path_temp = idx_path + "-update";
-		//check if idx_url is leading to a safe site 
-		//if (! boost::starts_with(idx_url, "http://files.my_company.com/wp-content/uploads/repository/")
-		//	&& ! boost::starts_with(idx_url, "https://files.my_company.com/wp-content/uploads/repository/"))
-		//{
-		//	BOOST_LOG_TRIVIAL(warning) << "unsafe url path for vendor \"" << vendor.name << "\" rejected: " << idx_url;
-		//	continue;
-		//}
-		if (!get_file(idx_url, idx_path_temp)) { continue; }
-		if (cancel) { return; }
-
-		// Load the fresh index up
-		{
-			Index new_index;
-			try {
-				new_index.load(idx_path_temp);
-			} catch (const std::exception & /* err */) {
-				BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path_temp, vendor.name);
-				continue;
-			}
-			if (new_index.version() < index.version()) {
-				BOOST_LOG_TRIVIAL(warning) << format("The downloaded index %1% for vendor %2% is older than the active one. Ignoring the downloaded index.", idx_path_temp, vendor.name);
-				continue;
-			}
-			Slic3r::rename_file(idx_path_temp, idx_path);
-			//if we rename path we need to change it in Index object too or create the object again
-			//index = std::move(new_index);
-			try {
-				index.load(idx_path);
-			}
-			catch (const std::exception& /* err */) {
-				BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path, vendor.name);
-				continue;
-			}
-			if (cancel)
-				return;
+	// Download a fresh index
+	BOOST_LOG_TRIVIAL(info) << "Downloading index for vendor: " << vendor.name;
+	const auto idx_url = vendor.config_update_url + "/" + INDEX_FILENAME;
+	const std::string idx_path = (cache_path / (vendor.id + ".idx")).string();
+	const std::string idx_path_temp = idx_path + "-update";
+	//check if idx_url is leading to a safe site 
+	//if (! boost::starts_with(idx_url, "http://files.my_company.com/wp-content/uploads/repository/")
+	//	&& ! boost::starts_with(idx_url, "https://files.my_company.com/wp-content/uploads/repository/"))
+	//{
+	//	BOOST_LOG_TRIVIAL(warning) << "unsafe url path for vendor \"" << vendor.name << "\" rejected: " << idx_url;
+	//	return;
+	//}
+	CacheValidators idx_validators;
+	const GetFileResult idx_result = get_file_if_modified(idx_url, idx_path_temp, idx_path, idx_validators);
+	if (idx_result == GetFileResult::Failed) { return; }
+	if (cancel) { return; }
+
+	// Load the fresh index up. If the server reported the index unchanged, the one in cache is up to date.
+	if (idx_result == GetFileResult::Downloaded) {
+		Index new_index;
+		try {
+			new_index.load(idx_path_temp);
+		} catch (const std::exception & /* err */) {
+			BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path_temp, vendor.name);
+			return;
 		}
-
-		// See if a there's a new version to download
-		const auto recommended_it = index.recommended();
-		if (recommended_it == index.end()) {
-			BOOST_LOG_TRIVIAL(error) << format("No recommended version for vendor: %1%, invalid index?", vendor.name);
-			continue;
+		if (new_index.version() < index.version()) {
+			BOOST_LOG_TRIVIAL(warning) << format("The downloaded index %1% for vendor %2% is older than the active one. Ignoring the downloaded index.", idx_path_temp, vendor.name);
+			return;
+		}
+		CacheValidators::invalidate(idx_path);
+		Slic3r::rename_file(idx_path_temp, idx_path);
+		idx_validators.save(idx_path);
+		//if we rename path we need to change it in Index object too or create the object again
+		//index = std::move(new_index);
+		try {
+			index.load(idx_path);
 		}
+		catch (const std::exception& /* err */) {
+			BOOST_LOG_TRIVIAL(error) << format("Could not load downloaded index %1% for vendor %2%: invalid index?", idx_path, vendor.name);
+			return;
+		}
+		if (cancel)
+			return;
+	}
 
-		const auto recommended = recommended_it->config_version;
+	// See if a there's a new version to download
+	const auto recommended_it = index.recommended();
+	if (recommended_it == index.end()) {
+		BOOST_LOG_TRIVIAL(error) << format("No recommended version for vendor: %1%, invalid index?", vendor.name);
+		return;
+	}
 
-		BOOST_LOG_TRIVIAL(debug) << format("Got index for vendor: %1%: current version: %2%, recommended version: %3%",
-			vendor.name,
-			vendor.config_version.to_string(),
-			recommended.to_string());
+	const auto recommended = recommended_it->config_version;
 
-		if (vendor.config_version >= recommended) { continue; }
+	BOOST_LOG_TRIVIAL(debug) << format("Got index for vendor: %1%: current version: %2%, recommended version: %3%",
+		vendor.name,
+		vendor.config_version.to_string(),
+		recommended.to_string());
 
-		// Download a fresh bundle
-		BOOST_LOG_TRIVIAL(info) << "Downloading new bundle for vendor: " << vendor.name;
-		const auto bundle_url = format("%1%/%2%.ini", vendor.config_update_url, recommended.to_string());
-		const auto bundle_path = cache_path / (vendor.id + ".ini");
-		if (! get_file(bundle_url, bundle_path)) { continue; }
-		if (cancel) { return; }
-	}
+	if (vendor.config_version >= recommended) { return; }
+
+	// Download a fresh bundle, unless the one already in cache was downloaded from the same url and is still valid.
+	BOOST_LOG_TRIVIAL(info) << "Downloading new bundle for vendor: " << vendor.name;
+	const auto bundle_url = format("%1%/%2%.ini", vendor.config_update_url, recommended.to_string());
+	const auto bundle_path = cache_path / (vendor.id + ".ini");
+	CacheValidators bundle_validators;
+	if (get_file_if_modified(bundle_url, bundle_path, bundle_path, bundle_validators) == GetFileResult::Downloaded)
+		bundle_validators.save(bundle_path);
 }
 
 // Install indicies from resources. Only installs those that are either missing or older than in resources.
+// The indices and the installed bundles are parsed in parallel, each vendor touches only its own files.
 void PresetUpdater::priv::check_install_indices() const
 {
 	BOOST_LOG_TRIVIAL(info) << "Checking if indices need to be installed from resources...";
 	if (!fs::exists(rsrc_path))
 		return;
-	for (auto& dir_entry : boost::filesystem::directory_iterator(rsrc_path)) {
-		if (is_idx_file(dir_entry)) {
-			const auto& path = dir_entry.path();
+	std::vector<fs::path> rsrc_indices;
+	for (auto& dir_entry : boost::filesystem::directory_iterator(rsrc_path))
+		if (is_idx_file(dir_entry))
+			rsrc_indices.emplace_back(dir_entry.path());
+
+	auto install = [](const fs::path &path, const fs::path &path_in_cache) {
+		copy_file_fix(path, path_in_cache);
+		// The cached index is not the downloaded one anymore.
+		CacheValidators::invalidate(path_in_cache);
+	};
+
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, rsrc_indices.size()), [this, &rsrc_indices, &install](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i) {
+			const auto& path = rsrc_indices[i];
 			const auto path_in_cache = cache_path / path.filename();
 
 			if (!fs::exists(path_in_cache)) {
 				BOOST_LOG_TRIVIAL(info) << "Install index from resources: " << path.filename();
-				copy_file_fix(path, path_in_cache);
+				install(path, path_in_cache);
 			} else {
 				Index idx_rsrc, idx_cache;
 				idx_rsrc.load(path);
@@ -418,21 +546,21 @@ void PresetUpdater::priv::check_install_indices() const
 						if (idx_cache.version() < idx_rsrc.version()) {
 							if (fs::exists(bundle_path)) {
 								BOOST_LOG_TRIVIAL(info) << "Update index from resources (new version): " << path.filename();
-								copy_file_fix(path, path_in_cache);
+								install(path, path_in_cache);
 							}
 						} else if (ver_from_cache == idx_cache.end()) {
 							BOOST_LOG_TRIVIAL(info) << "Update index from resources (only way to have a consistent idx): " << path.filename();
-							copy_file_fix(path, path_in_cache);
+							install(path, path_in_cache);
 						}
 					}
 				} else if (idx_cache.version() < idx_rsrc.version() || idx_cache.configs().back().max_slic3r_version < idx_rsrc.configs().back().max_slic3r_version) {
 					//not installed, force update the .idx from resource
 					BOOST_LOG_TRIVIAL(info) << "Update index from resources (uninstalled & more up-to-date): " << path.filename();
-					copy_file_fix(path, path_in_cache);
+					install(path, path_in_cache);
 				}
 			}
 		}
-	}
+	});
 }
 
 // Generates a list of bundle updates that are to be performed.
@@ -1,5 +1,11 @@
 #include "PrintHost.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <vector>
 #include <thread>
 #include <exception>
@@ -12,7 +18,6 @@
 #include <wx/arrstr.h>
 
 #include "libslic3r/PrintConfig.hpp"
-#include "libslic3r/Channel.hpp"
 #include "OctoPrint.hpp"
 #include "Duet.hpp"
 #include "FlashAir.hpp"
@@ -87,33 +92,52 @@ wxString PrintHost::format_error(const std::string &body, const std::string &err
 
 struct PrintHostJobQueue::priv
 {
-    // XXX: comment on how bg thread works
+    // The jobs are performed by a small pool of background threads, started on demand.
+    // A worker picks up the oldest queued job whose host does not run MAX_UPLOADS_PER_HOST uploads yet,
+    // so uploads to different printers run concurrently, while a single printer is not flooded
+    // with parallel requests. All the fields below except the constants are guarded by mutex.
+    enum {
+        MAX_UPLOAD_THREADS   = 8,
+        MAX_UPLOADS_PER_HOST = 1,
+    };
+
+    struct QueuedJob {
+        size_t       id;
+        PrintHostJob job;
+    };
+
+    struct RunningJob {
+        bool cancel        = false;
+        int  prev_progress = -1;
+    };
 
     PrintHostJobQueue *q;
 
-    Channel<PrintHostJob> channel_jobs;
-    Channel<size_t> channel_cancels;
-    size_t job_id = 0;
-    int prev_progress = -1;
-    fs::path source_to_remove;
+    std::mutex                    mutex;
+    std::condition_variable       condition;
+    std::deque<QueuedJob>         jobs;
+    std::map<size_t, RunningJob>  running;
+    std::map<std::string, size_t> uploads_per_host;
+    size_t                        next_job_id = 0;
+    size_t                        num_idle    = 0;
 
-    std::thread bg_thread;
-    bool bg_exit = false;
+    std::vector<std::thread> bg_threads;
+    std::atomic<bool>        bg_exit { false };
 
     PrintHostQueueDialog *queue_dialog;
 
     priv(PrintHostJobQueue *q) : q(q) {}
 
-    void emit_progress(int progress);
-    void emit_error(wxString error);
+    void emit_progress(size_t id, int progress);
+    void emit_error(size_t id, wxString error);
     void emit_cancel(size_t id);
+    // To be called with mutex locked.
     void start_bg_thread();
     void stop_bg_thread();
     void bg_thread_main();
-    void progress_fn(Http::Progress progress, bool &cancel);
+    void progress_fn(size_t id, Http::Progress progress, bool &cancel);
     void remove_source(const fs::path &path);
-    void remove_source();
-    void perform_job(PrintHostJob the_job);
+    void perform_job(size_t id, PrintHostJob the_job);
 };
 
 PrintHostJobQueue::PrintHostJobQueue(PrintHostQueueDialog *queue_dialog)
@@ -127,15 +151,15 @@ PrintHostJobQueue::~PrintHostJobQueue()
     if (p) { p->stop_bg_thread(); }
 }
 
-void PrintHostJobQueue::priv::emit_progress(int progress)
+void PrintHostJobQueue::priv::emit_progress(size_t id, int progress)
 {
-    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_PROGRESS, queue_dialog->GetId(), job_id, progress);
+    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_PROGRESS, queue_dialog->GetId(), id, progress);
     wxQueueEvent(queue_dialog, evt);
 }
 
-void PrintHostJobQueue::priv::emit_error(wxString error)
+void PrintHostJobQueue::priv::emit_error(size_t id, wxString error)
 {
-    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_ERROR, queue_dialog->GetId(), job_id, std::move(error));
+    auto evt = new PrintHostQueueDialog::Event(GUI::EVT_PRINTHOST_ERROR, queue_dialog->GetId(), id, std::move(error));
     wxQueueEvent(queue_dialog, evt);
 }
 
@@ -147,68 +171,101 @@ void PrintHostJobQueue::priv::emit_cancel(size_t id)
 
 void PrintHostJobQueue::priv::start_bg_thread()
 {
-    if (bg_thread.joinable()) { return; }
+    // Only start another thread if the idle ones do not cover the queued jobs.
+    if (jobs.size() <= num_idle || bg_threads.size() >= MAX_UPLOAD_THREADS) { return; }
 
     std::shared_ptr<priv> p2 = q->p;
-    bg_thread = std::thread([p2]() {
+    bg_threads.emplace_back([p2]() {
         p2->bg_thread_main();
     });
 }
 
 void PrintHostJobQueue::priv::stop_bg_thread()
 {
-    if (bg_thread.joinable()) {
+    std::vector<fs::path> sources;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
         bg_exit = true;
-        channel_jobs.push(PrintHostJob()); // Push an empty job to wake up bg_thread in case it's sleeping
-        bg_thread.detach();                // Let the background thread go, it should exit on its own
+        for (QueuedJob &queued : jobs)
+            sources.emplace_back(queued.job.upload_data.source_path);
+        jobs.clear();
     }
+    // Wake up the sleeping threads.
+    condition.notify_all();
+    for (std::thread &thread : bg_threads)
+        thread.detach();                // Let the background threads go, they should exit on their own
+    bg_threads.clear();
+    // Cleanup leftover files, if any
+    for (const fs::path &path : sources)
+        remove_source(path);
 }
 
 void PrintHostJobQueue::priv::bg_thread_main()
 {
     // bg thread entry point
-
-    try {
-        // Pick up jobs from the job channel:
-        while (! bg_exit) {
-            auto job = channel_jobs.pop();   // Sleeps in a cond var if there are no jobs
-            if (job.empty()) {
-                // This happens when the thread is being stopped
-                break;
-            }
-
-            source_to_remove = job.upload_data.source_path;
-
-            BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue/bg_thread: Received job: [%1%]: `%2%` -> `%3%`, cancelled: %4%")
-                % job_id
-                % job.upload_data.upload_path
-                % job.printhost->get_host()
-                % job.cancelled;
-
-            if (! job.cancelled) {
-                perform_job(std::move(job));
+    std::unique_lock<std::mutex> lock(mutex);
+    while (! bg_exit) {
+        // Pick up the oldest job, which does not exceed the number of concurrent uploads to its host.
+        auto it_job = jobs.end();
+        ++ num_idle;
+        // Sleeps in a cond var if there are no jobs
+        condition.wait(lock, [this, &it_job]() {
+            if (bg_exit)
+                return true;
+            it_job = std::find_if(jobs.begin(), jobs.end(), [this](const QueuedJob &queued) {
+                if (queued.job.cancelled)
+                    return true;
+                auto it = uploads_per_host.find(queued.job.printhost->get_host());
+                return it == uploads_per_host.end() || it->second < MAX_UPLOADS_PER_HOST;
+            });
+            return it_job != jobs.end();
+        });
+        -- num_idle;
+        if (bg_exit)
+            // This happens when the thread is being stopped
+            break;
+
+        size_t       id  = it_job->id;
+        PrintHostJob job = std::move(it_job->job);
+        jobs.erase(it_job);
+
+        BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue/bg_thread: Received job: [%1%]: `%2%` -> `%3%`, cancelled: %4%")
+            % id
+            % job.upload_data.upload_path
+            % job.printhost->get_host()
+            % job.cancelled;
+
+        fs::path source_path = job.upload_data.source_path;
+        if (! job.cancelled) {
+            std::string host = job.printhost->get_host();
+            ++ uploads_per_host[host];
+            running.emplace(id, RunningJob());
+            lock.unlock();
+            try {
+                perform_job(id, std::move(job));
+            } catch (const std::exception &e) {
+                emit_error(id, e.what());
             }
-
-            remove_source();
-            job_id++;
+            remove_source(source_path);
+            lock.lock();
+            running.erase(id);
+            if (-- uploads_per_host[host] == 0)
+                uploads_per_host.erase(host);
+            // A job waiting for this host may be picked up now.
+            condition.notify_all();
+        } else {
+            lock.unlock();
+            remove_source(source_path);
+            lock.lock();
         }
-    } catch (const std::exception &e) {
-        emit_error(e.what());
-    }
-
-    // Cleanup leftover files, if any
-    remove_source();
-    auto jobs = channel_jobs.lock_rw();
-    for (const PrintHostJob &job : *jobs) {
-        remove_source(job.upload_data.source_path);
     }
 }
 
-void PrintHostJobQueue::priv::progress_fn(Http::Progress progress, bool &cancel)
+void PrintHostJobQueue::priv::progress_fn(size_t id, Http::Progress progress, bool &cancel)
 {
     if (cancel) {
         // When cancel is true from the start, Http indicates request has been cancelled
-        emit_cancel(job_id);
+        emit_cancel(id);
         return;
     }
 
@@ -217,34 +274,19 @@ void PrintHostJobQueue::priv::progress_fn(Http::Progress progress, bool &cancel)
         return;
     }
 
-    if (channel_cancels.size_hint() > 0) {
-        // Lock both queues
-        auto cancels = channel_cancels.lock_rw();
-        auto jobs = channel_jobs.lock_rw();
-
-        for (size_t cancel_id : *cancels) {
-            if (cancel_id == job_id) {
-                cancel = true;
-            } else if (cancel_id > job_id) {
-                const size_t idx = cancel_id - job_id - 1;
-                if (idx < jobs->size()) {
-                    jobs->at(idx).cancelled = true;
-                    BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue: Job id %1% cancelled") % cancel_id;
-                    emit_cancel(cancel_id);
-                }
-            }
-        }
-
-        cancels->clear();
-    }
-
-    if (! cancel) {
-        int gui_progress = progress.ultotal > 0 ? 100*progress.ulnow / progress.ultotal : 0;
-        if (gui_progress != prev_progress) {
-            emit_progress(gui_progress);
-            prev_progress = gui_progress;
+    int gui_progress = progress.ultotal > 0 ? 100*progress.ulnow / progress.ultotal : 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        RunningJob &job = running[id];
+        if (job.cancel) {
+            cancel = true;
+            return;
         }
+        if (gui_progress == job.prev_progress)
+            return;
+        job.prev_progress = gui_progress;
     }
+    emit_progress(id, gui_progress);
 }
 
 void PrintHostJobQueue::priv::remove_source(const fs::path &path)
@@ -258,38 +300,53 @@ void PrintHostJobQueue::priv::remove_source(const fs::path &path)
     }
 }
 
-void PrintHostJobQueue::priv::remove_source()
-{
-    remove_source(source_to_remove);
-    source_to_remove.clear();
-}
-
-void PrintHostJobQueue::priv::perform_job(PrintHostJob the_job)
+void PrintHostJobQueue::priv::perform_job(size_t id, PrintHostJob the_job)
 {
-    emit_progress(0);   // Indicate the upload is starting
+    emit_progress(id, 0);   // Indicate the upload is starting
 
     bool success = the_job.printhost->upload(std::move(the_job.upload_data),
-        [this](Http::Progress progress, bool &cancel) { this->progress_fn(std::move(progress), cancel); },
-        [this](wxString error) {
-            emit_error(std::move(error));
+        [this, id](Http::Progress progress, bool &cancel) { this->progress_fn(id, std::move(progress), cancel); },
+        [this, id](wxString error) {
+            emit_error(id, std::move(error));
         }
     );
 
     if (success) {
-        emit_progress(100);
+        emit_progress(id, 100);
     }
 }
 
 void PrintHostJobQueue::enqueue(PrintHostJob job)
 {
-    p->start_bg_thread();
     p->queue_dialog->append_job(job);
-    p->channel_jobs.push(std::move(job));
+    {
+        std::lock_guard<std::mutex> lock(p->mutex);
+        p->jobs.push_back({ p->next_job_id ++, std::move(job) });
+        p->start_bg_thread();
+    }
+    p->condition.notify_one();
 }
 
 void PrintHostJobQueue::cancel(size_t id)
 {
-    p->channel_cancels.push(id);
+    bool cancelled_queued = false;
+    {
+        std::lock_guard<std::mutex> lock(p->mutex);
+        if (auto it = p->running.find(id); it != p->running.end()) {
+            // The upload will be cancelled from its progress callback.
+            it->second.cancel = true;
+        } else if (auto it_job = std::find_if(p->jobs.begin(), p->jobs.end(), [id](const priv::QueuedJob &queued) { return queued.id == id; });
+                   it_job != p->jobs.end() && ! it_job->job.cancelled) {
+            it_job->job.cancelled = true;
+            cancelled_queued = true;
+        }
+    }
+    if (cancelled_queued) {
+        BOOST_LOG_TRIVIAL(debug) << boost::format("PrintHostJobQueue: Job id %1% cancelled") % id;
+        p->emit_cancel(id);
+        // Let a worker thread drop the job and remove its source file.
+        p->condition.notify_one();
+    }
 }
 
 }
@@ -1,12 +1,15 @@
 #include "UndoRedo.hpp"
 
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <typeinfo> 
 #include <cassert>
 #include <cstddef>
+#include <cstring>
+#include <unordered_map>
 
 #include <cereal/types/polymorphic.hpp>
 #include <cereal/types/map.hpp> 
@@ -20,6 +23,7 @@
 #include <libslic3r/PrintConfig.hpp>
 #include <libslic3r/ObjectID.hpp>
 #include <libslic3r/Utils.hpp>
+#include <libslic3r/miniz_extension.hpp>
 
 #include <boost/foreach.hpp>
 
@@ -112,6 +116,9 @@ public:
 	virtual size_t release_optional() = 0;
 	// Restore optional data possibly released by release_optional.
 	virtual void   restore_optional() = 0;
+	// Serialize and compress the object if it is referenced by the Undo / Redo stack only.
+	// Return the amount of memory released.
+	virtual size_t compress(StackImpl & /* stack */) { return 0; }
 
 	// Estimated size in memory, to be used to drop least recently used snapshots.
 	virtual size_t memsize() const = 0;
@@ -276,6 +283,8 @@ public:
 			const_cast<T*>(m_shared_object.get())->restore_optional();
 	}
 
+	size_t 						compress(StackImpl &stack) override;
+
 	bool 						is_serialized() const { return m_shared_object.get() == nullptr; }
 	const std::string&			serialized_data() const { return m_serialized; }
 	std::shared_ptr<const T>& 	shared_ptr(StackImpl &stack);
@@ -298,13 +307,118 @@ public:
 
 private:
 	// Either the source object is held by a shared pointer and the m_serialized field is empty,
-	// or the shared pointer is null and the object is being serialized into m_serialized.
+	// or the shared pointer is null and the object is being serialized into m_serialized,
+	// compressed and prefixed with the uncompressed size.
 	std::shared_ptr<const T>	m_shared_object;
 	// If this object is optional, then it may be deleted from the Undo / Redo stack and recalculated from other data (for example mesh convex hull).
 	bool 						m_optional;
 	std::string 				m_serialized;
 };
 
+// Store of the chunks of the large serialized mutable objects. The serialized data is split
+// into chunks at the boundaries defined by its content, so that the unchanged parts of the data
+// produce the same chunks even if some bytes were inserted or removed before them. Each distinct
+// chunk is stored just once and shared by all the snapshots containing it, for example by all
+// the snapshots of a paint-on support annotation of which only a small region was painted over.
+class ChunkStore
+{
+public:
+	struct Chunk
+	{
+		size_t 		refcnt;
+		uint64_t 	hash;
+		std::string data;
+	};
+
+	ChunkStore() = default;
+	ChunkStore(const ChunkStore &rhs) = delete;
+	ChunkStore& operator=(const ChunkStore &rhs) = delete;
+	~ChunkStore() {
+		// All the chunks shall have been released together with the snapshots.
+		assert(m_chunks.empty());
+		for (auto &kvp : m_chunks)
+			delete kvp.second;
+	}
+
+	// Serialized data smaller than this are not split into chunks.
+	static constexpr size_t chunked_data_min_size = 65536;
+
+	// Split the data into chunks, share the chunks already stored.
+	std::vector<Chunk*> split(const std::string &data) {
+		std::vector<Chunk*> out;
+		const unsigned char *begin = (const unsigned char*)data.data();
+		const unsigned char *end   = begin + data.size();
+		for (const unsigned char *chunk_begin = begin; chunk_begin < end;) {
+			const unsigned char *chunk_end = std::min(end, chunk_begin + chunk_size_max);
+			const unsigned char *it        = std::min(chunk_end, chunk_begin + chunk_size_min);
+			// Gear hash of the last 64 bytes, the boundary is placed where its top bits are zero.
+			for (uint64_t h = 0; it < chunk_end; ++ it) {
+				h = (h << 1) + gear_table()[*it];
+				if ((h & chunk_boundary_mask) == 0) {
+					++ it;
+					break;
+				}
+			}
+			out.emplace_back(this->acquire((const char*)chunk_begin, size_t(it - chunk_begin)));
+			chunk_begin = it;
+		}
+		return out;
+	}
+
+	void release(Chunk *chunk) {
+		assert(chunk->refcnt > 0);
+		if (-- chunk->refcnt == 0) {
+			auto range = m_chunks.equal_range(chunk->hash);
+			for (auto it = range.first; it != range.second; ++ it)
+				if (it->second == chunk) {
+					m_chunks.erase(it);
+					break;
+				}
+			delete chunk;
+		}
+	}
+
+private:
+	static constexpr size_t 	chunk_size_min 		= 2048;
+	static constexpr size_t 	chunk_size_max 		= 65536;
+	// 8kB average chunk size above the minimum.
+	static constexpr uint64_t 	chunk_boundary_mask = uint64_t(0x1FFF) << 51;
+
+	static const uint64_t* gear_table() {
+		static const std::array<uint64_t, 256> table = []() {
+			// splitmix64
+			std::array<uint64_t, 256> out;
+			uint64_t state = 0x9E3779B97F4A7C15ull;
+			for (uint64_t &v : out) {
+				uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+				v = z ^ (z >> 31);
+			}
+			return out;
+		}();
+		return table.data();
+	}
+
+	Chunk* acquire(const char *data, size_t size) {
+		// FNV-1a
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (size_t i = 0; i < size; ++ i)
+			hash = (hash ^ (unsigned char)data[i]) * 0x100000001B3ull;
+		auto range = m_chunks.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++ it)
+			if (it->second->data.size() == size && memcmp(it->second->data.data(), data, size) == 0) {
+				++ it->second->refcnt;
+				return it->second;
+			}
+		Chunk *chunk = new Chunk{ 1, hash, std::string(data, size) };
+		m_chunks.emplace(hash, chunk);
+		return chunk;
+	}
+
+	std::unordered_multimap<uint64_t, Chunk*> m_chunks;
+};
+
 struct MutableHistoryInterval
 {
 private:
@@ -314,25 +428,68 @@ private:
 		// with the associated cost of CPU cache invalidation on refcount change.
 		size_t		refcnt;
 		size_t		size;
-		char 		data[1];
+		// Either the serialized data is stored here, or it is split into chunks shared through the chunk store.
+		std::string 				bytes;
+		std::vector<ChunkStore::Chunk*> chunks;
+		ChunkStore 				   *store;
+
+		Data(const std::string &input_data, ChunkStore &store) : refcnt(1), size(input_data.size()), store(&store) {
+			if (input_data.size() < ChunkStore::chunked_data_min_size)
+				this->bytes = input_data;
+			else
+				this->chunks = store.split(input_data);
+		}
+		~Data() {
+			for (ChunkStore::Chunk *chunk : this->chunks)
+				this->store->release(chunk);
+		}
 
 		// The serialized data matches the data stored here.
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
+		bool 		matches(const std::string& rhs) const {
+			if (this->size != rhs.size())
+				return false;
+			if (this->chunks.empty())
+				return this->bytes == rhs;
+			size_t offset = 0;
+			for (const ChunkStore::Chunk *chunk : this->chunks) {
+				if (memcmp(chunk->data.data(), rhs.data() + offset, chunk->data.size()) != 0)
+					return false;
+				offset += chunk->data.size();
+			}
+			return true;
+		}
 
 		// The timestamp matches the timestamp serialized in the data stored here.
-		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->data, &timestamp, 8) == 0; }
+		bool 		matches_timestamp(uint64_t timestamp) const {
+			assert(timestamp > 0);  assert(this->size > 8);
+			// The first chunk is never shorter than 8 bytes.
+			return memcmp(this->chunks.empty() ? this->bytes.data() : this->chunks.front()->data.data(), &timestamp, 8) == 0;
+		}
+
+		std::string str() const {
+			if (this->chunks.empty())
+				return this->bytes;
+			std::string out;
+			out.reserve(this->size);
+			for (const ChunkStore::Chunk *chunk : this->chunks)
+				out += chunk->data;
+			return out;
+		}
+
+		// Count the size of the shared chunks divided by the number of references, rounded up.
+		size_t 		memsize() const {
+			size_t memsize = this->bytes.size() + this->chunks.size() * sizeof(ChunkStore::Chunk*);
+			for (const ChunkStore::Chunk *chunk : this->chunks)
+				memsize += (chunk->data.size() + chunk->refcnt - 1) / chunk->refcnt;
+			return memsize;
+		}
 	};
 
 	Interval    m_interval;
 	Data	   *m_data;
 
 public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
-	}
+	MutableHistoryInterval(const Interval &interval, const std::string &input_data, ChunkStore &store) : m_interval(interval), m_data(new Data(input_data, store)) {}
 
 	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
 		++ m_data->refcnt;
@@ -346,7 +503,7 @@ public:
 
 	~MutableHistoryInterval() {
 		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
+			delete m_data;
 	}
 
 	const Interval& interval() const { return m_interval; }
@@ -359,7 +516,9 @@ public:
 	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
 	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
 
-	const char* data() const { return m_data->data; }
+	// Identity of the data shared by multiple intervals.
+	const void* data_id() const { return m_data; }
+	std::string data() const { return m_data->str(); }
 	size_t  	size() const { return m_data->size; }
 	size_t		refcnt() const { return m_data->refcnt; }
 	bool		matches(const std::string& data) { return m_data->matches(data); }
@@ -367,9 +526,9 @@ public:
 	size_t 		memsize() const {
 		return m_data->refcnt == 1 ?
 			// Count just the size of the snapshot data.
-			m_data->size :
+			m_data->memsize() :
 			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
+			(m_data->memsize() + m_data->refcnt - 1) / m_data->refcnt;
 	}
 
 private:
@@ -424,7 +583,7 @@ public:
 		return false;
 	}
 
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
+	void save(size_t active_snapshot_time, size_t current_time, const std::string &data, ChunkStore &store) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
 		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
 			if (! m_history.empty() && m_history.back().matches(data))
@@ -432,7 +591,7 @@ public:
 				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
 			else
 				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
+				m_history.emplace_back(Interval(current_time, current_time + 1), data, store);
 		} else {
 			assert(! m_history.empty());
 			assert(m_history.back().end() == active_snapshot_time);
@@ -441,7 +600,7 @@ public:
 				m_history.back().extend_end(current_time + 1);
 			else
 				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data, store);
 		}
 	}
 
@@ -453,7 +612,7 @@ public:
 			-- it;
 		}
 		assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
+		return it->data();
 	}
 
 	// Currently all mutable snapshots are mandatory.
@@ -465,7 +624,7 @@ public:
 	std::string format() override {
 		std::string out = typeid(T).name();
 		for (const MutableHistoryInterval &interval : m_history)
-			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
+			out += std::string(", ptr:") + ptr_to_string(interval.data_id()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
 		return out;
 	}
 #endif /* SLIC3R_UNDOREDO_DEBUG */
@@ -495,16 +654,16 @@ bool MutableObjectHistory<T>::valid()
 {
 	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
 	if (! m_history.empty()) {
-		std::map<const char*, size_t> refcntrs;
-		assert(m_history.front().data() != nullptr);
-		++ refcntrs[m_history.front().data()];
+		std::map<const void*, size_t> refcntrs;
+		assert(m_history.front().data_id() != nullptr);
+		++ refcntrs[m_history.front().data_id()];
 		for (size_t i = 1; i < m_history.size(); ++ i) {
 			assert(m_history[i - 1].interval().strictly_before(m_history[i].interval()));
-			++ refcntrs[m_history[i].data()];
+			++ refcntrs[m_history[i].data_id()];
 		}
 		for (const auto &hi : m_history) {
-			assert(hi.data() != nullptr);
-			assert(refcntrs[hi.data()] == hi.refcnt());
+			assert(hi.data_id() != nullptr);
+			assert(refcntrs[hi.data_id()] == hi.refcnt());
 		}
 	}
 	return true;
@@ -625,6 +784,9 @@ private:
 	// Maximum memory allowed to be occupied by the Undo / Redo stack. If the limit is exceeded,
 	// least recently used snapshots will be released.
 	size_t 													m_memory_limit;
+	// Chunks of the large serialized mutable objects, shared by their snapshots. Declared before m_objects,
+	// so that it is destroyed after the object histories releasing their chunks.
+	ChunkStore 												m_chunk_store;
 	// Each individual object (Model, ModelObject, ModelInstance, ModelVolume, Selection, TriangleMesh)
 	// is stored with its own history, referenced by the ObjectID. Immutable objects do not provide
 	// their own IDs, therefore there are temporary IDs generated for them and stored to m_shared_ptr_to_object_id.
@@ -753,11 +915,43 @@ namespace cereal
 namespace Slic3r {
 namespace UndoRedo {
 
+template<typename T> size_t ImmutableObjectHistory<T>::compress(StackImpl &stack)
+{
+	if (this->is_serialized() || m_shared_object.use_count() != 1)
+		return 0;
+	std::ostringstream oss;
+	{
+		Slic3r::UndoRedo::OutputArchive archive(stack, oss);
+		archive(*m_shared_object.get());
+	}
+	std::string   data = oss.str();
+	uint64_t      size = data.size();
+	mz_ulong      compressed_size = mz_compressBound(mz_ulong(data.size()));
+	m_serialized.assign(sizeof(size) + compressed_size, 0);
+	memcpy(m_serialized.data(), &size, sizeof(size));
+	if (mz_compress2((unsigned char*)m_serialized.data() + sizeof(size), &compressed_size, (const unsigned char*)data.data(), mz_ulong(data.size()), MZ_BEST_SPEED) != MZ_OK) {
+		m_serialized.clear();
+		return 0;
+	}
+	m_serialized.resize(sizeof(size) + compressed_size);
+	m_serialized.shrink_to_fit();
+	size_t mem_released = m_shared_object->memsize();
+	m_shared_object.reset();
+	return mem_released > m_serialized.size() ? mem_released - m_serialized.size() : 0;
+}
+
 template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::shared_ptr(StackImpl &stack)
 {
 	if (m_shared_object.get() == nullptr && ! this->m_serialized.empty()) {
-		// Deserialize the object.
-		std::istringstream iss(m_serialized);
+		// Decompress and deserialize the object.
+		uint64_t size;
+		memcpy(&size, m_serialized.data(), sizeof(size));
+		std::string data(size_t(size), 0);
+		mz_ulong    uncompressed_size = mz_ulong(size);
+		int         res = mz_uncompress((unsigned char*)data.data(), &uncompressed_size, (const unsigned char*)m_serialized.data() + sizeof(size), mz_ulong(m_serialized.size() - sizeof(size)));
+		assert(res == MZ_OK && uncompressed_size == size);
+		(void)res;
+		std::istringstream iss(data);
 		{
 			Slic3r::UndoRedo::InputArchive archive(stack, iss);
 			typedef typename std::remove_const<T>::type Type;
@@ -765,6 +959,9 @@ template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::share
 			archive(*mesh.get());
 			m_shared_object = std::move(mesh);
 		}
+		// The object is in memory again, it will be compressed again once it is referenced by the Undo / Redo stack only.
+		m_serialized.clear();
+		m_serialized.shrink_to_fit();
 	}
 	return m_shared_object;
 }
@@ -791,7 +988,7 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 			Slic3r::UndoRedo::OutputArchive archive(*this, oss);
 			archive(object);
 		}
-		object_history->save(m_active_snapshot_time, m_current_time, oss.str());
+		object_history->save(m_active_snapshot_time, m_current_time, oss.str(), m_chunk_store);
 	}
 	return object.id();
 }
@@ -828,7 +1025,12 @@ template<typename T> std::shared_ptr<const T> StackImpl::load_immutable_object(c
 	auto *object_history = static_cast<ImmutableObjectHistory<T>*>(it_object_history->second.get());
 	assert(object_history->has_snapshot(m_active_snapshot_time));
 	object_history->restore_optional();
-	return object_history->shared_ptr(*this);
+	bool was_serialized = object_history->is_serialized();
+	std::shared_ptr<const T> &ptr = object_history->shared_ptr(*this);
+	if (was_serialized && ptr)
+		// The decompressed object has a new address, map it to its history again.
+		m_shared_ptr_to_object_id[(const void*)ptr.get()] = id;
+	return ptr;
 }
 
 template<typename T> void StackImpl::load_mutable_object(const Slic3r::ObjectID id, T &target)
@@ -1019,6 +1221,16 @@ void StackImpl::release_least_recently_used()
 		else
 			current_memsize = 0;
 	}
+	// Then compress the immutable objects not referenced by the scene, for example the meshes of deleted objects
+	// or the meshes of the volumes before a mesh modifying operation.
+	for (auto it = m_objects.begin(); current_memsize > m_memory_limit && it != m_objects.end(); ++ it) {
+		const void *ptr = it->second->immutable_object_ptr();
+		size_t mem_released = it->second->compress(*this);
+		if (ptr != nullptr && it->second->immutable_object_ptr() == nullptr)
+			// The object was released, its address may be reused by another object.
+			m_shared_ptr_to_object_id.erase(ptr);
+		current_memsize -= std::min(current_memsize, mem_released);
+	}
 	while (current_memsize > m_memory_limit && m_snapshots.size() >= 3) {
 		// From which side to remove a snapshot?
 		assert(m_snapshots.front().timestamp < m_active_snapshot_time);
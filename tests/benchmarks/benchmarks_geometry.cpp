@@ -0,0 +1,191 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/BoundingBox.hpp"
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/EdgeGrid.hpp"
+#include "libslic3r/ExtrusionEntity.hpp"
+#include "libslic3r/MedialAxis.hpp"
+#include "libslic3r/ShortestPath.hpp"
+
+using namespace Slic3r;
+
+// Throughput of the geometry kernels over parameterised inputs: the number of points of the contours,
+// the number of holes and the degeneracy (duplicate and collinear points, as left by the slicer).
+// The inputs are deterministic, so that the runs of different builds are comparable.
+
+namespace {
+
+// Circle with a wavy boundary, so that the input is not convex.
+Polygon wavy_circle(const Vec2d &center, double radius, size_t num_points, bool degenerate)
+{
+    Polygon out;
+    out.points.reserve(degenerate ? 3 * num_points : num_points);
+    auto point = [&center, radius, num_points](size_t i) {
+        double a = 2. * PI * double(i) / double(num_points);
+        double r = radius * (1. + 0.05 * std::sin(17. * a));
+        return Point::new_scale(Vec2d(center + r * Vec2d(std::cos(a), std::sin(a))));
+    };
+    for (size_t i = 0; i < num_points; ++ i) {
+        Point p = point(i);
+        out.points.emplace_back(p);
+        if (degenerate) {
+            // Duplicate point and a point in the middle of the following edge.
+            out.points.emplace_back(p);
+            out.points.emplace_back((p + point(i + 1)) / 2);
+        }
+    }
+    return out;
+}
+
+// Disc of 50mm radius perforated by a grid of holes of 32 points each.
+ExPolygon holed_disc(size_t num_points, size_t num_holes, bool degenerate)
+{
+    ExPolygon out;
+    out.contour = wavy_circle(Vec2d::Zero(), 50., num_points, degenerate);
+    size_t grid = size_t(std::ceil(std::sqrt(double(num_holes))));
+    double step = grid > 0 ? 60. / double(grid) : 0.;
+    for (size_t i = 0; i < num_holes; ++ i) {
+        Vec2d center(-30. + step * (double(i % grid) + 0.5), -30. + step * (double(i / grid) + 0.5));
+        Polygon hole = wavy_circle(center, 0.3 * step, 32, degenerate);
+        hole.make_clockwise();
+        out.holes.emplace_back(std::move(hole));
+    }
+    return out;
+}
+
+// Ring of about 1mm wall thickness for the medial axis.
+ExPolygon thin_ring(size_t num_points, bool degenerate)
+{
+    ExPolygon out;
+    out.contour = wavy_circle(Vec2d::Zero(), 20., num_points, degenerate);
+    Polygon hole = wavy_circle(Vec2d::Zero(), 19., num_points, degenerate);
+    hole.make_clockwise();
+    out.holes.emplace_back(std::move(hole));
+    return out;
+}
+
+// Random short segments over a 200mm square.
+Polylines random_polylines(size_t count)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> pos(0., 200.), dir(-5., 5.);
+    Polylines out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++ i) {
+        Vec2d a(pos(rng), pos(rng));
+        Vec2d b = a + Vec2d(dir(rng), dir(rng));
+        out.emplace_back(Point::new_scale(a), Point::new_scale(b));
+    }
+    return out;
+}
+
+std::string input_name(size_t num_points, size_t num_holes, bool degenerate)
+{
+    return std::to_string(num_points) + " points, " + std::to_string(num_holes) + " holes" + (degenerate ? ", degenerate" : "");
+}
+
+} // namespace
+
+TEST_CASE("offset", "[ClipperUtils]")
+{
+    size_t    num_points = GENERATE(100, 1000, 10000);
+    size_t    num_holes  = GENERATE(0, 10, 100);
+    bool      degenerate = GENERATE(false, true);
+    ExPolygon input      = holed_disc(num_points, num_holes, degenerate);
+
+    BENCHMARK("offset " + input_name(num_points, num_holes, degenerate)) {
+        return offset(input, float(scale_(0.2)));
+    };
+}
+
+TEST_CASE("offset2_ex", "[ClipperUtils]")
+{
+    size_t     num_points = GENERATE(100, 1000, 10000);
+    size_t     num_holes  = GENERATE(0, 10, 100);
+    bool       degenerate = GENERATE(false, true);
+    ExPolygons input { holed_disc(num_points, num_holes, degenerate) };
+
+    BENCHMARK("offset2_ex " + input_name(num_points, num_holes, degenerate)) {
+        return offset2_ex(input, - float(scale_(0.5)), float(scale_(0.5)));
+    };
+}
+
+TEST_CASE("diff_ex", "[ClipperUtils]")
+{
+    size_t    num_points = GENERATE(100, 1000, 10000);
+    size_t    num_holes  = GENERATE(0, 10, 100);
+    bool      degenerate = GENERATE(false, true);
+    Polygons  subject    = to_polygons(holed_disc(num_points, num_holes, degenerate));
+    Polygons  clip       = subject;
+    for (Polygon &p : clip)
+        p.translate(Point::new_scale(1., 0.5));
+
+    BENCHMARK("diff_ex " + input_name(num_points, num_holes, degenerate)) {
+        return diff_ex(subject, clip);
+    };
+}
+
+TEST_CASE("EdgeGrid::Grid::create", "[EdgeGrid]")
+{
+    size_t      num_points = GENERATE(100, 1000, 10000);
+    size_t      num_holes  = GENERATE(0, 10, 100);
+    bool        degenerate = GENERATE(false, true);
+    ExPolygon   input      = holed_disc(num_points, num_holes, degenerate);
+    BoundingBox bbox       = get_extents(input.contour);
+    bbox.offset(SCALED_EPSILON);
+
+    BENCHMARK("EdgeGrid::Grid::create " + input_name(num_points, num_holes, degenerate)) {
+        EdgeGrid::Grid grid;
+        grid.set_bbox(bbox);
+        grid.create(input, coord_t(scale_(1.)));
+        return grid.rows();
+    };
+}
+
+TEST_CASE("MedialAxis::build", "[MedialAxis]")
+{
+    size_t    num_points = GENERATE(100, 1000, 10000);
+    bool      degenerate = GENERATE(false, true);
+    ExPolygon input      = thin_ring(num_points, degenerate);
+
+    BENCHMARK("MedialAxis::build " + input_name(num_points, 1, degenerate)) {
+        ThickPolylines out;
+        MedialAxis(input, coord_t(scale_(1.5)), coord_t(scale_(0.2)), coord_t(scale_(0.2))).build(out);
+        return out;
+    };
+}
+
+TEST_CASE("chain_polylines", "[ShortestPath]")
+{
+    size_t    count = GENERATE(100, 1000, 10000);
+    Polylines input = random_polylines(count);
+
+    BENCHMARK("chain_polylines " + std::to_string(count) + " polylines") {
+        return chain_polylines(input);
+    };
+}
+
+TEST_CASE("chain_extrusion_entities", "[ShortestPath]")
+{
+    size_t                        count = GENERATE(4, 16, 64, 100, 1000, 10000);
+    std::vector<ExtrusionPath>    paths;
+    for (Polyline &pl : random_polylines(count)) {
+        paths.emplace_back(erPerimeter, 0.05, 0.45f, 0.2f);
+        paths.back().polyline = std::move(pl);
+    }
+    std::vector<ExtrusionEntity*> input;
+    for (ExtrusionPath &path : paths)
+        input.emplace_back(&path);
+
+    BENCHMARK("chain_extrusion_entities " + std::to_string(count) + " paths") {
+        std::vector<ExtrusionEntity*> entities = input;
+        return chain_extrusion_entities(entities);
+    };
+}
@@ -81,5 +81,44 @@ SCENARIO("ExtrusionEntityCollection: Polygon flattening", "[ExtrusionEntity]") {
                     }
             }
         }
+        WHEN("The references to the EEC leaves are collected with preservation (preserve_order=true)") {
+            ExtrusionEntitiesPtr references;
+            sample.flatten_references(references, true);
+            THEN("The same entities as the flattened copy are referenced, the no-sort EEC as a whole") {
+                output = sample.flatten(true);
+                REQUIRE(references.size() == output.entities.size());
+                CHECK(references[sub_sort.entities.size()] == sample.entities[1]);
+                for (size_t i = 0; i < references.size(); ++ i) {
+                    CHECK(references[i]->is_collection() == output.entities[i]->is_collection());
+                    CHECK(references[i]->first_point() == output.entities[i]->first_point());
+                }
+            }
+        }
+        WHEN("The references to the EEC leaves are collected with default options (preserve_order=false)") {
+            ExtrusionEntitiesPtr references;
+            sample.flatten_references(references);
+            THEN("The leaves owned by the EEC are referenced") {
+                CHECK(references.size() == sample.flatten().entities.size());
+                CHECK(references.front() == static_cast<const ExtrusionEntityCollection*>(sample.entities.front())->entities.front());
+            }
+        }
+        WHEN("The EEC leaves are visited in place") {
+            ExtrusionEntitiesPtr references;
+            sample.flatten_references(references);
+            std::vector<const ExtrusionEntity*> visited;
+            sample.for_each_leaf([&visited](const ExtrusionEntity &leaf) { visited.emplace_back(&leaf); });
+            THEN("The same leaves as the references are visited, in the same order") {
+                REQUIRE(visited.size() == references.size());
+                for (size_t i = 0; i < visited.size(); ++ i)
+                    CHECK(visited[i] == references[i]);
+            }
+            AND_THEN("A role filter skips the leaves of other roles") {
+                size_t num_perimeters = 0, num_infills = 0;
+                sample.for_each_leaf(erPerimeter, [&num_perimeters](const ExtrusionEntity &) { ++ num_perimeters; });
+                sample.for_each_leaf(erInternalInfill, [&num_infills](const ExtrusionEntity &) { ++ num_infills; });
+                CHECK(num_perimeters == visited.size());
+                CHECK(num_infills == 0);
+            }
+        }
     }
 }
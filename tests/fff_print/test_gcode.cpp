@@ -2,7 +2,12 @@
 
 #include <memory>
 
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/ArcFitting.hpp"
+#include "libslic3r/GCode/CompressedGCode.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +25,128 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+SCENARIO("Arc fitting", "[GCode]") {
+    GIVEN("A half circle of radius 10mm sampled every 5 degrees followed by a straight segment") {
+        Points points;
+        for (int deg = 0; deg <= 180; deg += 5)
+            points.emplace_back(Point::new_scale(10. * cos(deg * PI / 180.), 10. * sin(deg * PI / 180.)));
+        points.emplace_back(Point::new_scale(-10., -10.));
+        WHEN("The points are fitted with a tolerance of 0.02mm") {
+            std::vector<ArcFitting::Move> moves = ArcFitting::fit(points, scale_(0.02), scale_(0.5), scale_(1000.));
+            THEN("The half circle is a single counter-clockwise arc around the origin, the segment a line") {
+                REQUIRE(moves.size() == 2);
+                CHECK(moves.front().is_arc);
+                CHECK(moves.front().ccw);
+                CHECK(moves.front().end == points.size() - 2);
+                CHECK(moves.front().center.norm() < scale_(0.01));
+                CHECK(! moves.back().is_arc);
+                CHECK(moves.back().end == points.size() - 1);
+            }
+        }
+        WHEN("The maximum radius is below the radius of the circle") {
+            std::vector<ArcFitting::Move> moves = ArcFitting::fit(points, scale_(0.02), scale_(0.5), scale_(5.));
+            THEN("Only lines are emitted") {
+                CHECK(moves.size() == points.size() - 1);
+                CHECK(std::none_of(moves.begin(), moves.end(), [](const ArcFitting::Move &m) { return m.is_arc; }));
+            }
+        }
+    }
+    GIVEN("The arc length of a quarter circle of radius 2") {
+        THEN("It is PI when counter-clockwise and 3 PI when clockwise") {
+            CHECK(ArcFitting::arc_length(Vec2d(2., 0.), Vec2d(0., 2.), Vec2d(0., 0.), true) == Approx(PI));
+            CHECK(ArcFitting::arc_length(Vec2d(2., 0.), Vec2d(0., 2.), Vec2d(0., 0.), false) == Approx(3. * PI));
+        }
+    }
+}
+
+SCENARIO("Compressed G-code", "[GCode]") {
+    GIVEN("A G-code file with a thumbnail, 3000 layers and the statistics at its end") {
+        const std::string gcode_path      = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test-%%%%-%%%%.gcode")).string();
+        const std::string compressed_path = gcode_path + ".sgcz";
+        const std::string restored_path   = gcode_path + ".restored";
+        std::string gcode = "; generated by test\n;\n; thumbnail begin 2x2 8\n; aGVsbG8=\n; thumbnail end\n;\nG28\n";
+        for (int layer = 0; layer < 3000; ++ layer) {
+            gcode += ";LAYER_CHANGE\n;Z:" + std::to_string(layer) + "\n";
+            for (int i = 0; i < 100; ++ i)
+                gcode += "G1 X" + std::to_string(i) + " Y" + std::to_string(layer) + " E0.0" + std::to_string(i) + "\n";
+        }
+        gcode += "; filament used [mm] = 123.4\n; layer_height = 0.2\n";
+        FILE *file = boost::nowide::fopen(gcode_path.c_str(), "wb");
+        REQUIRE(file != nullptr);
+        fwrite(gcode.data(), 1, gcode.size(), file);
+        fclose(file);
+
+        WHEN("It is compressed") {
+            compress_gcode_file(gcode_path, compressed_path);
+            THEN("The container is recognized, the G-code text is not") {
+                CHECK(is_compressed_gcode_file(compressed_path));
+                CHECK(! is_compressed_gcode_file(gcode_path));
+                CHECK(boost::filesystem::file_size(compressed_path) < gcode.size());
+            }
+            THEN("The index holds the layers, the thumbnail and the statistics") {
+                CompressedGCodeReader reader(compressed_path);
+                CHECK(reader.text_size() == gcode.size());
+                REQUIRE(reader.layers_count() == 3000);
+                const size_t layer_start = gcode.find(";LAYER_CHANGE\n;Z:1500\n");
+                const size_t layer_end   = gcode.find(";LAYER_CHANGE\n;Z:1501\n");
+                CHECK(reader.layer(1500) == gcode.substr(layer_start, layer_end - layer_start));
+                REQUIRE(reader.thumbnails().size() == 1);
+                CHECK(reader.thumbnails().front().width == 2);
+                CHECK(reader.thumbnails().front().png == "hello");
+                REQUIRE(reader.metadata().size() == 2);
+                CHECK(reader.metadata().front().first == "filament used [mm]");
+                CHECK(reader.metadata().front().second == "123.4");
+            }
+            AND_WHEN("It is decompressed") {
+                decompress_gcode_file(compressed_path, restored_path);
+                THEN("The G-code text is restored") {
+                    std::string restored(size_t(boost::filesystem::file_size(restored_path)), 0);
+                    FILE *file = boost::nowide::fopen(restored_path.c_str(), "rb");
+                    REQUIRE(file != nullptr);
+                    CHECK(fread(&restored[0], 1, restored.size(), file) == restored.size());
+                    fclose(file);
+                    CHECK(restored == gcode);
+                }
+                boost::nowide::remove(restored_path.c_str());
+            }
+            boost::nowide::remove(compressed_path.c_str());
+        }
+        boost::nowide::remove(gcode_path.c_str());
+    }
+}
+
+SCENARIO("Estimated printing time placeholder", "[GCode]") {
+    GIVEN("A G-code streamed into a file with the placeholder of the estimated printing time split between two buffers") {
+        const std::string gcode_path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test-%%%%-%%%%.gcode")).string();
+        std::string gcode = "G28\nG1 Z0.2 F600\n";
+        for (int i = 0; i < 100; ++ i)
+            gcode += "G1 X" + std::to_string(i) + " Y" + std::to_string(i % 2) + " E0.1 F1800\n";
+        gcode += "; filament used [mm] = 10\n" + GCodeProcessor::Estimated_Printing_Time_Placeholder_Line + "; layer_height = 0.2\n";
+        const size_t split = gcode.find(GCodeProcessor::Estimated_Printing_Time_Placeholder_Tag) + 10;
+        GCodeProcessor processor;
+        processor.start_streaming();
+        processor.process_buffer(gcode.substr(0, split));
+        processor.process_buffer(gcode.substr(split));
+        FILE *file = boost::nowide::fopen(gcode_path.c_str(), "wb");
+        REQUIRE(file != nullptr);
+        fwrite(gcode.data(), 1, gcode.size(), file);
+        fclose(file);
+        WHEN("The processing is finished") {
+            processor.finish_streaming(gcode_path, true);
+            THEN("The placeholder is replaced in place by the estimated printing time") {
+                std::string result(size_t(boost::filesystem::file_size(gcode_path)), 0);
+                FILE *file = boost::nowide::fopen(gcode_path.c_str(), "rb");
+                REQUIRE(file != nullptr);
+                CHECK(fread(&result[0], 1, result.size(), file) == result.size());
+                fclose(file);
+                CHECK(result.size() == gcode.size());
+                CHECK(result.find(GCodeProcessor::Estimated_Printing_Time_Placeholder_Tag) == std::string::npos);
+                const size_t pos = result.find("; estimated printing time (normal mode) = ");
+                CHECK(pos == gcode.find(GCodeProcessor::Estimated_Printing_Time_Placeholder_Tag));
+                CHECK(result.compare(result.size() - 21, 21, "; layer_height = 0.2\n") == 0);
+            }
+        }
+        boost::nowide::remove(gcode_path.c_str());
+    }
+}
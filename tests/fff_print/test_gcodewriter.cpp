@@ -157,3 +157,32 @@ SCENARIO("set_fan saves state.", "[GCode][GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("Moves emit the coordinates with the configured precision, without trailing zeros.", "[GCodeWriter]") {
+    GIVEN("GCodeWriter instance with comments off, a single extruder and the acceleration already written") {
+        GCodeWriter writer;
+        writer.config.gcode_comments.value = false;
+        writer.config.gcode_precision_xyz.value = 3;
+        writer.config.gcode_precision_e.values = { 5 };
+        writer.config.travel_speed.value = 130;
+        writer.set_extruders({ 0 });
+        writer.set_tool(0);
+        writer.set_acceleration(1000);
+        writer.write_acceleration();
+        WHEN("travel_to_xy is called with coordinates with more decimals than the precision") {
+            THEN("Output string is 'G1 X1.5 Y-2.125 F7800'") {
+                REQUIRE_THAT(writer.travel_to_xy(Vec2d(1.5, -2.1254)), Catch::Equals("G1 X1.5 Y-2.125 F7800\n"));
+            }
+        }
+        WHEN("extrude_to_xy is called with integer coordinates") {
+            THEN("Output string is 'G1 X10 Y20 E0.12346'") {
+                REQUIRE_THAT(writer.extrude_to_xy(Vec2d(10., 20.), 0.123456), Catch::Equals("G1 X10 Y20 E0.12346\n"));
+            }
+        }
+        WHEN("extrude_arc_to_xy is called for a counter-clockwise arc") {
+            THEN("Output string is 'G3 X10 Y0 I5 J0 E0.5'") {
+                REQUIRE_THAT(writer.extrude_arc_to_xy(Vec2d(10., 0.), Vec2d(5., 0.), 0.5, true), Catch::Equals("G3 X10 Y0 I5 J0 E0.5\n"));
+            }
+        }
+    }
+}
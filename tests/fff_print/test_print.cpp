@@ -102,6 +102,37 @@ SCENARIO("Print: Changing number of solid surfaces does not cause all surfaces t
     }
 }
 
+SCENARIO("Print: apply() compares only the modified options", "[Print]") {
+    GIVEN("20mm cube applied to a print") {
+        Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        DynamicPrintConfig applied = print.full_print_config();
+        WHEN("the same config is applied again") {
+            THEN("nothing changes") {
+                REQUIRE(print.apply(model, applied) == PrintBase::APPLY_STATUS_UNCHANGED);
+            }
+        }
+        WHEN("a print, an object and a region option are modified") {
+            applied.set_deserialize_strict({ { "retract_length", "3" }, { "support_material", 1 }, { "top_solid_layers", 7 } });
+            print.apply(model, applied);
+            THEN("the modified options are applied to the print, object and region defaults") {
+                REQUIRE(print.config().retract_length.get_at(0) == Approx(3.));
+                REQUIRE(print.default_object_config().support_material.value);
+                REQUIRE(print.default_region_config().top_solid_layers.value == 7);
+            }
+        }
+        WHEN("a filament retract override is modified") {
+            applied.set_deserialize_strict("filament_retract_length", "2");
+            print.apply(model, applied);
+            THEN("the override is applied to the print config") {
+                REQUIRE(print.config().retract_length.get_at(0) == Approx(2.));
+            }
+        }
+    }
+}
+
 SCENARIO("Print: Brim generation", "[Print]") {
     GIVEN("20mm cube and default config, 1mm first layer width") {
         WHEN("Brim is set to 3mm")  {
@@ -138,3 +169,76 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Step profiles", "[Print]") {
+    GIVEN("20mm cube and default config") {
+        WHEN("the print is processed")  {
+            Slic3r::Print print;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, {
+                { "layer_height",       0.2 },
+                { "first_layer_height", 0.2 }
+            });
+            const PrintObject &object = *print.objects().front();
+            THEN("the slicing step is profiled with its layer count") {
+                const PrintStepProfile &profile = object.step_profile(posSlice);
+                REQUIRE(profile.finished);
+                REQUIRE(profile.items == object.layer_count());
+                REQUIRE(profile.wall_time >= 0.);
+                REQUIRE(profile.cpu_time >= 0.);
+            }
+            THEN("the JSON document lists the steps of the print and of the object") {
+                std::string json = print.step_profiles_json();
+                REQUIRE(json.find("\"technology\": \"FFF\"") != std::string::npos);
+                REQUIRE(json.find("\"step\": \"skirt\"") != std::string::npos);
+                REQUIRE(json.find("\"step\": \"support_material\"") != std::string::npos);
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Release of the intermediate layer data", "[Print]") {
+    GIVEN("20mm cube and default config") {
+        Slic3r::Print print_kept, print_released;
+        Slic3r::Model model_kept, model_released;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print_kept, model_kept, { { "fill_density", 0.2 } });
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print_released, model_released, { { "fill_density", 0.2 } });
+        WHEN("one print releases its intermediate data after the object steps")  {
+            print_kept.process();
+            print_released.set_release_intermediates(true);
+            print_released.process();
+            THEN("the raw slices are dropped but the exported G-code is identical") {
+                REQUIRE(print_released.objects().front()->layers().front()->regions().front()->fill_expolygons.empty());
+                REQUIRE(Slic3r::Test::gcode(print_released) == Slic3r::Test::gcode(print_kept));
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Statistics are derived from the extruded volumes", "[Print]") {
+    GIVEN("The statistics of two extruders, one of them also extruding for the wipe tower") {
+        Slic3r::PrintStatistics stats;
+        stats.extruded_volumes[0]   = 10000.;
+        stats.extruded_volumes[1]   = 5000.;
+        stats.wipe_tower_volumes[1] = 1000.;
+        Slic3r::PrintConfig config;
+        config.filament_density.values = { 1.25, 1.0 };
+        config.filament_cost.values    = { 20., 40. };
+        WHEN("The weight and the cost are computed") {
+            stats.update_weight_and_cost(config);
+            THEN("They match the densities and the costs of the filaments") {
+                REQUIRE(stats.total_weight == Approx(12.5 + 5.));
+                REQUIRE(stats.total_cost == Approx(12.5 * 0.02 + 5. * 0.04));
+                REQUIRE(stats.total_wipe_tower_cost == Approx(1. * 0.04));
+            }
+        }
+        WHEN("Only the cost of a filament changes") {
+            stats.update_weight_and_cost(config);
+            config.filament_cost.values = { 30., 40. };
+            stats.update_weight_and_cost(config);
+            THEN("The cost is updated without exporting again") {
+                REQUIRE(stats.total_weight == Approx(12.5 + 5.));
+                REQUIRE(stats.total_cost == Approx(12.5 * 0.03 + 5. * 0.04));
+            }
+        }
+    }
+}
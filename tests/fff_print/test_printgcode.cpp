@@ -2,10 +2,13 @@
 
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
 
 #include "test_data.hpp"
 
 #include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
 #include <boost/regex.hpp>
 
 using namespace Slic3r;
@@ -266,5 +269,66 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
 				REQUIRE(z == Approx(20.));
 			}
         }
+
+        WHEN("the G-code is exported through the pipelined layer export") {
+            // The header contains the export time stamp.
+            auto strip_header = [](std::string gcode) { return gcode.substr(gcode.find('\n')); };
+            for (bool complete_objects : { false, true }) {
+                std::string serial = strip_header(::Test::slice({ TestMesh::cube_20x20x20, TestMesh::cube_20x20x20 }, {
+                    { "complete_objects",               complete_objects },
+                    { "gcode_comments",                 true },
+                    { "fan_always_on",                  true },
+                    { "slowdown_below_layer_time",      30 },
+                    { "gcode_export_pipelined",         false }
+                    }));
+                std::string pipelined = strip_header(::Test::slice({ TestMesh::cube_20x20x20, TestMesh::cube_20x20x20 }, {
+                    { "complete_objects",               complete_objects },
+                    { "gcode_comments",                 true },
+                    { "fan_always_on",                  true },
+                    { "slowdown_below_layer_time",      30 },
+                    { "gcode_export_pipelined",         true }
+                    }));
+                THEN("the output is identical to the serial export") {
+                    REQUIRE(! serial.empty());
+                    REQUIRE(serial == pipelined);
+                }
+            }
+        }
+
+        WHEN("the G-code is processed while being exported") {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, { { "gcode_comments", true } });
+            print.set_status_silent();
+            print.process();
+            boost::filesystem::path temp = boost::filesystem::unique_path();
+            GCodeProcessor::Result streamed;
+            print.export_gcode(temp.string(), &streamed, nullptr);
+            GCodeProcessor processor;
+            processor.apply_config(print.config());
+            processor.process_file(temp.string(), false);
+            boost::nowide::remove(temp.string().c_str());
+            const GCodeProcessor::Result &parsed = processor.get_result();
+            THEN("the result is the same as processing the exported file") {
+                REQUIRE(streamed.moves.size() > 1);
+                REQUIRE(streamed.moves.size() == parsed.moves.size());
+                REQUIRE(streamed.moves.back().position == parsed.moves.back().position);
+                REQUIRE(streamed.time_statistics.modes[0].time == Approx(parsed.time_statistics.modes[0].time));
+            }
+            THEN("the attributes of the moves are stored run length encoded") {
+                const GCodeProcessor::MoveVertices &moves = parsed.moves;
+                REQUIRE(moves.runs_count() < moves.size());
+                size_t idx = 0;
+                for (const GCodeProcessor::MoveVertex move : moves) {
+                    const GCodeProcessor::MoveVertex random_access = moves[idx ++];
+                    REQUIRE(move.position == random_access.position);
+                    REQUIRE(move.width == random_access.width);
+                    REQUIRE(move.height == random_access.height);
+                    REQUIRE(move.extruder_id == random_access.extruder_id);
+                    REQUIRE(move.fan_speed == random_access.fan_speed);
+                }
+                REQUIRE(idx == moves.size());
+            }
+        }
     }
 }
@@ -3,6 +3,9 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/SlicesCache.hpp"
+
+#include <boost/filesystem.hpp>
 
 #include "test_data.hpp"
 
@@ -299,3 +302,114 @@ SCENARIO("PrintObject: minimum horizontal shells", "[PrintObject]") {
 
     }
 }
+
+SCENARIO("PrintObject: slices cache", "[PrintObject]") {
+    GIVEN("20mm cube sliced with and without XY size compensation") {
+        SlicesCache::instance().clear();
+        auto slices_area = [](const Print &print) {
+            double area = 0.;
+            for (const Layer *layer : print.objects().front()->layers())
+                for (const ExPolygon &expoly : layer->lslices)
+                    area += expoly.area();
+            return area;
+        };
+        Slic3r::Print print_initial, print_compensated, print_toggled_back;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print_initial, { { "xy_size_compensation", 0 } });
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print_compensated, { { "xy_size_compensation", -0.5 } });
+        WHEN("the compensation is toggled back") {
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print_toggled_back, { { "xy_size_compensation", 0 } });
+            THEN("the slices restored from the cache match the initial slices") {
+                REQUIRE(slices_area(print_compensated) < slices_area(print_initial));
+                REQUIRE(print_toggled_back.objects().front()->layers().size() == print_initial.objects().front()->layers().size());
+                REQUIRE(slices_area(print_toggled_back) == Approx(slices_area(print_initial)));
+            }
+        }
+    }
+    GIVEN("A cache entry backed by a directory") {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        SlicesCache::instance().set_directory(dir.string());
+        auto entry = std::make_shared<SlicesCache::Entry>();
+        entry->layers.emplace_back();
+        entry->layers.back().id      = 3;
+        entry->layers.back().print_z = 0.4;
+        entry->layers.back().lslices = { ExPolygon(Polygon::new_scale({ {0, 0}, {10, 0}, {10, 10}, {0, 10} })) };
+        entry->layers.back().region_slices.assign(1, Surfaces{ Surface(stPosInternal | stDensSparse, entry->layers.back().lslices.front()) });
+        SlicesCache::instance().insert(1234, entry);
+        WHEN("the entries held in memory are dropped") {
+            SlicesCache::instance().clear();
+            SlicesCache::EntryPtr loaded = SlicesCache::instance().find(1234);
+            THEN("the entry is loaded from disk") {
+                REQUIRE(loaded);
+                REQUIRE(loaded->layers.size() == 1);
+                REQUIRE(loaded->layers.front().id == 3);
+                REQUIRE(loaded->layers.front().print_z == Approx(0.4));
+                REQUIRE(loaded->layers.front().lslices == entry->layers.front().lslices);
+                REQUIRE(loaded->layers.front().region_slices.front().front().surface_type == (stPosInternal | stDensSparse));
+            }
+        }
+        SlicesCache::instance().set_directory(std::string());
+        SlicesCache::instance().clear();
+        boost::filesystem::remove_all(dir);
+    }
+    GIVEN("A perimeters cache entry backed by a directory") {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        SlicesCache::instance().set_directory(dir.string());
+        auto entry = std::make_shared<SlicesCache::Entry>();
+        entry->layers.emplace_back();
+        entry->layers.back().region_perimeters.emplace_back();
+        SlicesCache::RegionPerimeters &perimeters = entry->layers.back().region_perimeters.back();
+        ExtrusionPath path(erExternalPerimeter, 0.05, 0.45f, 0.2f);
+        path.polyline = Polyline::new_scale({ {0, 0}, {10, 0}, {10, 10}, {0, 10}, {0, 0} });
+        ExtrusionEntityCollection loops;
+        loops.append(ExtrusionLoop(path, elrDefault));
+        perimeters.perimeters.append(std::move(loops));
+        path.set_role(erGapFill);
+        perimeters.thin_fills.append(path);
+        Surface fill(stPosInternal | stDensSparse, ExPolygon(Polygon::new_scale({ {1, 1}, {9, 1}, {9, 9}, {1, 9} })));
+        fill.extra_perimeters = 2;
+        perimeters.fill_surfaces.emplace_back(fill);
+        SlicesCache::instance().insert(5678, entry);
+        WHEN("the entries held in memory are dropped") {
+            SlicesCache::instance().clear();
+            SlicesCache::EntryPtr loaded = SlicesCache::instance().find(5678);
+            THEN("the extrusions are loaded from disk") {
+                REQUIRE(loaded);
+                REQUIRE(loaded->layers.front().region_perimeters.size() == 1);
+                const SlicesCache::RegionPerimeters &loaded_perimeters = loaded->layers.front().region_perimeters.front();
+                REQUIRE(loaded_perimeters.perimeters.items_count() == 1);
+                const auto *loaded_loops = dynamic_cast<const ExtrusionEntityCollection*>(loaded_perimeters.perimeters.entities.front());
+                REQUIRE(loaded_loops != nullptr);
+                const auto *loop = dynamic_cast<const ExtrusionLoop*>(loaded_loops->entities.front());
+                REQUIRE(loop != nullptr);
+                REQUIRE(loop->role() == erExternalPerimeter);
+                REQUIRE(loop->paths.front().polyline.points == path.polyline.points);
+                REQUIRE(loop->paths.front().width == Approx(0.45));
+                REQUIRE(loaded_perimeters.thin_fills.entities.front()->role() == erGapFill);
+                REQUIRE(loaded_perimeters.fill_surfaces.front().extra_perimeters == 2);
+            }
+        }
+        SlicesCache::instance().set_directory(std::string());
+        SlicesCache::instance().clear();
+        boost::filesystem::remove_all(dir);
+    }
+}
+
+SCENARIO("PrintObject: perimeters reused for layers with the same slices", "[PrintObject]") {
+    GIVEN("20mm cube") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, { { "perimeters", 3 }, { "layer_height", 0.4 }, { "first_layer_height", 0.4 } });
+        const std::vector<Slic3r::Layer*> &layers = print.objects().front()->layers();
+        THEN("the inner layers have the same perimeters as the layer below") {
+            REQUIRE(layers.size() > 4);
+            REQUIRE(layers[3]->has_same_perimeter_inputs(*layers[2]));
+            REQUIRE(! layers[1]->has_same_perimeter_inputs(*layers[0]));
+            for (size_t i = 2; i + 1 < layers.size(); ++ i) {
+                const LayerRegion &layerm       = *layers[i]->regions().front();
+                const LayerRegion &layerm_below = *layers[i - 1]->regions().front();
+                REQUIRE(layerm.perimeters.entities.size() == layerm_below.perimeters.entities.size());
+                REQUIRE(layerm.perimeters.total_volume() == Approx(layerm_below.perimeters.total_volume()));
+                REQUIRE(layerm.fill_surfaces.surfaces.size() == layerm_below.fill_surfaces.surfaces.size());
+            }
+        }
+    }
+}
@@ -119,6 +119,39 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+SCENARIO("SupportMaterial: tree supports", "[SupportMaterial]")
+{
+    TriangleMesh mesh = Slic3r::Test::mesh(Slic3r::Test::TestMesh::overhang);
+    auto support_area = [](const Slic3r::Print &print) {
+        double area = 0.;
+        for (const Slic3r::SupportLayer *layer : print.objects().front()->support_layers())
+            for (const ExPolygon &expoly : layer->support_islands.expolygons)
+                area += expoly.area();
+        return area;
+    };
+    GIVEN("An overhanging object") {
+        Slic3r::Print print_grid;
+        Slic3r::Test::init_and_process_print({ mesh }, print_grid, {
+            { "support_material",       1 },
+            { "support_material_style", "grid" },
+        });
+        Slic3r::Print print_tree;
+        Slic3r::Test::init_and_process_print({ mesh }, print_tree, {
+            { "support_material",       1 },
+            { "support_material_style", "tree" },
+        });
+        WHEN("Supports are generated by the tree style") {
+            THEN("Support layers are generated") {
+                REQUIRE(! print_tree.objects().front()->support_layers().empty());
+                REQUIRE(support_area(print_tree) > 0.);
+            }
+            THEN("The tree supports cover less area than the grid supports") {
+                REQUIRE(support_area(print_tree) < support_area(print_grid));
+            }
+        }
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
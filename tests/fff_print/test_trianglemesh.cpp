@@ -226,6 +226,24 @@ SCENARIO( "TriangleMesh: slice behavior.") {
             }
         }
     }
+    GIVEN( "A finely tessellated sphere, large enough for the facets to be sorted by Z before slicing") {
+        TriangleMesh sphere = make_sphere(10., 2. * PI / 720.);
+        sphere.repair();
+        REQUIRE(sphere.facets_count() > 200000);
+        WHEN("The sphere is sliced through and around its equator") {
+            std::vector<double> z { -15., -8., -3., 0. + EPSILON, 5., 9.5, 15. };
+            std::vector<ExPolygons> result = sphere.slice(z);
+            THEN( "Each slice inside the sphere is a single disc of the expected area") {
+                REQUIRE(result.size() == z.size());
+                REQUIRE(result.front().empty());
+                REQUIRE(result.back().empty());
+                for (size_t i = 1; i + 1 < z.size(); ++ i) {
+                    REQUIRE(result[i].size() == 1);
+                    REQUIRE(result[i].front().area() * SCALING_FACTOR * SCALING_FACTOR == Approx(PI * (100. - z[i] * z[i])).epsilon(0.01));
+                }
+            }
+        }
+    }
 }
 
 SCENARIO( "make_xxx functions produce meshes.") {
@@ -380,6 +398,130 @@ SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
         }
     }
 }
+SCENARIO( "TriangleMeshSlicer: Sweep slicing.") {
+    GIVEN( "A sphere and a tilted up direction") {
+        TriangleMesh sphere = make_sphere(10., 2. * PI / 72.);
+        sphere.repair();
+        TriangleMeshSlicer slicer(&sphere);
+        slicer.set_up_direction(Vec3f(1.f, 1.f, 2.f).normalized());
+        WHEN( "The plane is swept through the sphere") {
+            THEN( "Each cut matches the regular slice at the same height") {
+                for (float z : { -12.f, -9.f, -4.5f, 0.f, 3.f, 7.5f, 12.f }) {
+                    ExPolygons swept;
+                    slicer.slice_sweep(z, SlicingMode::Regular, &swept);
+                    std::vector<ExPolygons> sliced;
+                    slicer.slice({ z }, SlicingMode::Regular, &sliced, [](){});
+                    REQUIRE(swept.size() == sliced.front().size());
+                    double swept_area  = 0.;
+                    double sliced_area = 0.;
+                    for (const ExPolygon &expoly : swept)
+                        swept_area += expoly.area();
+                    for (const ExPolygon &expoly : sliced.front())
+                        sliced_area += expoly.area();
+                    REQUIRE(swept_area == Approx(sliced_area));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO( "cut_mesh: Cut without repair.") {
+    GIVEN( "A 20mm cube with one corner on the origin") {
+        TriangleMesh cube = make_cube(20., 20., 20.);
+        cube.require_shared_vertices();
+        WHEN( "Object is cut at the bottom") {
+            indexed_triangle_set upper, lower;
+            REQUIRE(cut_mesh(cube.its, 0.f, &upper, &lower));
+            THEN("Upper mesh has all facets except those belonging to the slicing plane, the cap replaces them.") {
+                REQUIRE(upper.indices.size() == 12);
+            }
+            THEN("Lower mesh has no facets.") {
+                REQUIRE(lower.indices.empty());
+            }
+        }
+        WHEN( "Object is cut at the center") {
+            indexed_triangle_set upper_its, lower_its;
+            REQUIRE(cut_mesh(cube.its, 10.f, &upper_its, &lower_its));
+            TriangleMesh upper(upper_its), lower(lower_its);
+            upper.repair();
+            lower.repair();
+            THEN("Both parts have 2 external horizontal facets, 3 facets on each side, and 6 facets on the triangulated side (2 + 12 + 6).") {
+                REQUIRE(upper.facets_count() == 2+12+6);
+                REQUIRE(lower.facets_count() == 2+12+6);
+            }
+            THEN("Both parts are closed and need no repair.") {
+                REQUIRE(upper.is_manifold());
+                REQUIRE(lower.is_manifold());
+                REQUIRE(! upper.needed_repair());
+                REQUIRE(! lower.needed_repair());
+                REQUIRE(upper.volume() == Approx(20. * 20. * 10.));
+                REQUIRE(lower.volume() == Approx(20. * 20. * 10.));
+            }
+        }
+    }
+    GIVEN( "A square tube, its section has a hole") {
+        // Outer square 20mm, inner square 10mm, 20mm high.
+        std::vector<Vec3d> vertices;
+        for (double z : { 0., 20. })
+            for (double r : { 10., 5. })
+                for (const Vec2d &d : { Vec2d(-1., -1.), Vec2d(1., -1.), Vec2d(1., 1.), Vec2d(-1., 1.) })
+                    vertices.emplace_back(r * d.x(), r * d.y(), z);
+        auto outer = [](int i, int level) { return level * 8 + i % 4; };
+        auto inner = [](int i, int level) { return level * 8 + 4 + i % 4; };
+        std::vector<Vec3i32> facets;
+        for (int i = 0; i < 4; ++ i) {
+            facets.emplace_back(outer(i, 0), outer(i + 1, 0), outer(i + 1, 1));
+            facets.emplace_back(outer(i, 0), outer(i + 1, 1), outer(i, 1));
+            facets.emplace_back(inner(i + 1, 0), inner(i, 0), inner(i, 1));
+            facets.emplace_back(inner(i + 1, 0), inner(i, 1), inner(i + 1, 1));
+            facets.emplace_back(outer(i, 1), outer(i + 1, 1), inner(i + 1, 1));
+            facets.emplace_back(outer(i, 1), inner(i + 1, 1), inner(i, 1));
+            facets.emplace_back(outer(i + 1, 0), outer(i, 0), inner(i, 0));
+            facets.emplace_back(outer(i + 1, 0), inner(i, 0), inner(i + 1, 0));
+        }
+        TriangleMesh tube(vertices, facets);
+        tube.repair();
+        tube.require_shared_vertices();
+        REQUIRE(! tube.needed_repair());
+        WHEN( "Object is cut across the tube") {
+            indexed_triangle_set upper_its, lower_its;
+            REQUIRE(cut_mesh(tube.its, 7.f, &upper_its, &lower_its));
+            TriangleMesh upper(upper_its), lower(lower_its);
+            upper.repair();
+            lower.repair();
+            THEN("The parts are closed and the volume is preserved.") {
+                REQUIRE(! upper.needed_repair());
+                REQUIRE(! lower.needed_repair());
+                REQUIRE(lower.volume() == Approx(300. * 7.));
+                REQUIRE(upper.volume() == Approx(300. * 13.));
+            }
+        }
+    }
+}
+
+SCENARIO( "TriangleMesh: repair of a closed mesh with a reversed facet") {
+    GIVEN( "A 20mm cube with a single facet oriented backwards" ) {
+        std::vector<Vec3d> vertices { {20,20,0}, {20,0,0}, {0,0,0}, {0,20,0}, {20,20,20}, {0,20,20}, {0,0,20}, {20,0,20} };
+        std::vector<Vec3i32> facets { {0,1,2}, {0,2,3}, {4,5,6}, {4,6,7}, {0,4,7}, {0,7,1}, {1,7,6}, {1,6,2}, {2,6,5}, {2,5,3}, {4,0,3}, {4,3,5} };
+        TriangleMesh good(vertices, facets);
+        std::swap(facets[6](1), facets[6](2));
+        TriangleMesh cube(vertices, facets);
+        WHEN( "Both meshes are repaired") {
+            good.repair();
+            cube.repair();
+            THEN( "The consistent cube did not need any repair") {
+                REQUIRE(good.is_manifold());
+                REQUIRE(! good.needed_repair());
+            }
+            THEN( "The reversed facet is fixed") {
+                REQUIRE(cube.is_manifold());
+                REQUIRE(cube.stl.stats.facets_reversed == 1);
+                REQUIRE(abs(cube.volume() - 20.0*20.0*20.0) < 1e-2);
+            }
+        }
+    }
+}
+
 #ifdef TEST_PERFORMANCE
 TEST_CASE("Regression test for issue #4486 - files take forever to slice") {
     TriangleMesh mesh;
@@ -59,3 +59,42 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Ray packet gives the same first hits as single rays", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = make_sphere(1., 0.1);
+    tmesh.translate(0.2f, -0.1f, 0.3f);
+    tmesh.repair();
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    REQUIRE(! tree.empty());
+
+    // More rays than the width of a packet, some of them missing the sphere.
+    std::vector<Vec3d> origins, dirs;
+    for (size_t i = 0; i < 40; ++ i) {
+        double a = 2. * PI * double(i) / 40.;
+        origins.emplace_back(1.5 * std::cos(a), 1.5 * std::sin(a), 0.1 * double(i % 7));
+        dirs.emplace_back(Vec3d(-std::cos(a), -std::sin(a), i % 3 == 0 ? 1. : 0.).normalized());
+    }
+
+    std::vector<igl::Hit> hits(origins.size());
+    AABBTreeIndirect::intersect_ray_packet_first_hit(
+		tmesh.its.vertices, tmesh.its.indices,
+		tree,
+        origins.data(), dirs.data(), origins.size(),
+		hits.data());
+
+    for (size_t i = 0; i < origins.size(); ++ i) {
+        igl::Hit hit;
+        bool intersected = AABBTreeIndirect::intersect_ray_first_hit(
+			tmesh.its.vertices, tmesh.its.indices,
+			tree,
+            origins[i], dirs[i],
+			hit);
+        if (intersected) {
+            REQUIRE(hits[i].id == hit.id);
+            REQUIRE(hits[i].t == Approx(hit.t));
+        } else
+            REQUIRE(hits[i].id == -1);
+    }
+}
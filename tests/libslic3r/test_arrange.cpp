@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Arrange.hpp"
+#include "libslic3r/BoundingBox.hpp"
+#include "libslic3r/ClipperUtils.hpp"
+
+using namespace Slic3r;
+
+static arrangement::ArrangePolygons square_items(size_t n, double size_mm)
+{
+    coord_t   s = scaled(size_mm);
+    ExPolygon sq;
+    sq.contour.points = {Point(0, 0), Point(s, coord_t(0)), Point(s, s), Point(coord_t(0), s)};
+
+    arrangement::ArrangePolygons items(n);
+    for (auto &ap : items) ap.poly = sq;
+
+    return items;
+}
+
+TEST_CASE("Raster arrange fills the bed without overlaps", "[Arrange]")
+{
+    BoundingBox bed({0, 0}, {scaled(250.), scaled(210.)});
+    const double dist = 2.;
+
+    arrangement::ArrangeParams params{scaled(dist)};
+    params.engine = arrangement::ArrangeParams::Engine::Raster;
+
+    arrangement::ArrangePolygons items = square_items(1000, 5.);
+    arrangement::arrange(items, bed, params);
+
+    Polygons on_bed;
+    for (const auto &ap : items) {
+        REQUIRE(ap.is_arranged());
+        if (ap.bed_idx != 0) continue;
+
+        Polygon p = ap.transformed_poly().contour;
+        REQUIRE(bed.contains(p.bounding_box()));
+        on_bed.emplace_back(std::move(p));
+    }
+
+    // Squares of 7mm pitch with some extra gap from the rasterization.
+    REQUIRE(on_bed.size() >= size_t(250. / 8.) * size_t(210. / 8.));
+
+    // The items inflated by a bit less than half of the distance have to
+    // stay disjoint.
+    REQUIRE(union_(offset(on_bed, float(scaled(dist / 2. - 0.1)))).size() == on_bed.size());
+}
+
+TEST_CASE("Raster arrange keeps clear of the fixed items", "[Arrange]")
+{
+    BoundingBox bed({0, 0}, {scaled(100.), scaled(100.)});
+
+    arrangement::ArrangePolygons fixed = square_items(1, 50.);
+    fixed.front().bed_idx = 0;
+
+    arrangement::ArrangeParams params{scaled(1.)};
+    params.engine = arrangement::ArrangeParams::Engine::Raster;
+
+    arrangement::ArrangePolygons items = square_items(20, 10.);
+    arrangement::arrange(items, fixed, bed, params);
+
+    Polygon fixedp = fixed.front().transformed_poly().contour;
+    for (const auto &ap : items)
+        if (ap.bed_idx == 0) {
+            Polygon p = ap.transformed_poly().contour;
+            REQUIRE(bed.contains(p.bounding_box()));
+            REQUIRE(intersection(Polygons{p}, Polygons{fixedp}).empty());
+        }
+}
@@ -322,3 +322,69 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+SCENARIO("ClipperContext produces the same results as the free functions", "[ClipperUtils]") {
+    Slic3r::Polygon   square{ Point::new_scale(0, 0), Point::new_scale(20, 0), Point::new_scale(20, 20), Point::new_scale(0, 20) };
+    Slic3r::Polygon   hole  { Point::new_scale(5, 5), Point::new_scale(5, 15), Point::new_scale(15, 15), Point::new_scale(15, 5) };
+    Slic3r::Polygon   other { Point::new_scale(10, 10), Point::new_scale(30, 12), Point::new_scale(28, 30), Point::new_scale(12, 26) };
+    ExPolygons        expolys { ExPolygon(square, hole), ExPolygon(other) };
+    Polygons          polys   = to_polygons(expolys);
+    Polylines         lines   { Polyline(Point::new_scale(-5, 10), Point::new_scale(35, 10)), Polyline(Point::new_scale(2, -5), Point::new_scale(2, 35)) };
+    ClipperContext   &clipper = ClipperContext::local();
+    // Run the operations twice to exercise the reuse of the buffers.
+    for (int i = 0; i < 2; ++ i) {
+        THEN("offsets match") {
+            REQUIRE(clipper.offset(polys, scale_(1.)) == offset(polys, scale_(1.)));
+            REQUIRE(clipper.offset(polys, scale_(-1.), jtRound, scale_(0.01)) == offset(polys, scale_(-1.), jtRound, scale_(0.01)));
+            REQUIRE(clipper.offset_ex(polys, scale_(-1.)) == offset_ex(polys, scale_(-1.)));
+            REQUIRE(clipper.offset(expolys, scale_(1.)) == offset(expolys, scale_(1.)));
+            REQUIRE(clipper.offset_ex(expolys, scale_(-1.)) == offset_ex(expolys, scale_(-1.)));
+            REQUIRE(clipper.offset_ex(expolys, scale_(2.), jtRound, 0.01) == offset_ex(expolys, scale_(2.), jtRound, 0.01));
+            REQUIRE(clipper.offset2(polys, scale_(-3.), scale_(2.)) == offset2(polys, scale_(-3.), scale_(2.)));
+            REQUIRE(clipper.offset2_ex(polys, scale_(-3.), scale_(2.)) == offset2_ex(polys, scale_(-3.), scale_(2.)));
+        }
+        THEN("boolean operations match") {
+            Polygons square_polys { square };
+            REQUIRE(clipper.diff(polys, square_polys) == diff(polys, square_polys));
+            REQUIRE(clipper.diff_ex(polys, square_polys, true) == diff_ex(polys, square_polys, true));
+            REQUIRE(clipper.diff_ex(expolys, ExPolygons { ExPolygon(other) }) == diff_ex(expolys, ExPolygons { ExPolygon(other) }));
+            REQUIRE(clipper.intersection(polys, square_polys) == intersection(polys, square_polys));
+            REQUIRE(clipper.intersection_ex(polys, square_polys, true) == intersection_ex(polys, square_polys, true));
+            REQUIRE(clipper.intersection_ex(expolys, ExPolygons { ExPolygon(other) }) == intersection_ex(expolys, ExPolygons { ExPolygon(other) }));
+            REQUIRE(clipper.union_(polys) == union_(polys));
+            REQUIRE(clipper.union_ex(polys, true) == union_ex(polys, true));
+            REQUIRE(clipper.union_ex(expolys) == union_ex(expolys));
+            REQUIRE(clipper.diff_pl(lines, polys) == diff_pl(lines, polys));
+            REQUIRE(clipper.intersection_pl(lines, polys) == intersection_pl(lines, polys));
+        }
+    }
+}
+
+SCENARIO("Slic3r polygons passed to the Clipper as path views", "[ClipperUtils]") {
+    Polygons subject { Polygon({ { 0, 0 }, { 100, 0 }, { 100, 100 }, { 0, 100 } }) };
+    Polygons clip    { Polygon({ { 50, 50 }, { 150, 50 }, { 150, 150 }, { 50, 150 } }) };
+    GIVEN("views of the points") {
+        ClipperLib::PathViews views;
+        Slic3rMultiPoints_to_ClipperPathViews(subject, views);
+        THEN("the views alias the Slic3r points") {
+            REQUIRE(views.size() == 1);
+            REQUIRE(views.front().size() == 4);
+            REQUIRE(views.front()[2].X == 100);
+            REQUIRE(views.front()[2].Y == 100);
+        }
+        THEN("boolean operation over the views matches the one over the copied paths") {
+            ClipperLib::PathViews clip_views;
+            Slic3rMultiPoints_to_ClipperPathViews(clip, clip_views);
+            ClipperLib::Clipper clipper_views, clipper_paths;
+            clipper_views.AddPaths(views, ClipperLib::ptSubject, true);
+            clipper_views.AddPaths(clip_views, ClipperLib::ptClip, true);
+            clipper_paths.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, true);
+            clipper_paths.AddPaths(Slic3rMultiPoints_to_ClipperPaths(clip), ClipperLib::ptClip, true);
+            ClipperLib::Paths out_views, out_paths;
+            clipper_views.Execute(ClipperLib::ctDifference, out_views, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            clipper_paths.Execute(ClipperLib::ctDifference, out_paths, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            REQUIRE(out_views == out_paths);
+            REQUIRE(std::abs(ClipperLib::Area(out_views.front())) == Approx(7500.));
+        }
+    }
+}
@@ -194,6 +194,31 @@ SCENARIO("Config accessor functions perform as expected.", "[Config]") {
     }
 }
 
+SCENARIO("DynamicConfig merging keeps the options sorted", "[Config]") {
+    GIVEN("Two configs with partially overlapping options") {
+        DynamicPrintConfig a, b;
+        a.set_deserialize_strict({ { "perimeters", 2 }, { "layer_height", 0.3 }, { "top_solid_layers", 5 } });
+        b.set_deserialize_strict({ { "bottom_solid_layers", 4 }, { "perimeters", 4 }, { "wipe", true } });
+        WHEN("the second config is added to the first one") {
+            DynamicPrintConfig copied = a;
+            copied += b;
+            DynamicPrintConfig moved = a;
+            moved  += DynamicPrintConfig(b);
+            THEN("the options of the second config are added or override the existing ones") {
+                REQUIRE(copied.keys() == t_config_option_keys({ "bottom_solid_layers", "layer_height", "perimeters", "top_solid_layers", "wipe" }));
+                REQUIRE(copied.opt_int("perimeters") == 4);
+                REQUIRE(copied.opt_float("layer_height") == Approx(0.3));
+                REQUIRE(copied == moved);
+            }
+            THEN("an erased option is not found anymore") {
+                REQUIRE(copied.erase("layer_height"));
+                REQUIRE(copied.option("layer_height") == nullptr);
+                REQUIRE(! copied.erase("layer_height"));
+            }
+        }
+    }
+}
+
 SCENARIO("Config ini load/save interface", "[Config]") {
     WHEN("new_from_ini is called") {
 		Slic3r::DynamicPrintConfig config;
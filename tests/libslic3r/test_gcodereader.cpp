@@ -0,0 +1,111 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
+
+using namespace Slic3r;
+
+static std::vector<std::string> parse_lines(GCodeReader &reader, const std::string &path, std::vector<float> &xs)
+{
+    std::vector<std::string> lines;
+    reader.parse_file(path, [&lines, &xs](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+        lines.emplace_back(line.raw());
+        xs.emplace_back(line.new_X(reader));
+    });
+    return lines;
+}
+
+TEST_CASE("GCodeReader parses a file the same way as a buffer", "[GCodeReader]") {
+    const std::string gcode = "G1 X10.5 Y3 ; comment\nG1 X\n5\r\n\nG92 E0\r\nM106 S255 ; a long comment, longer than the small string optimization";
+    boost::filesystem::path temp = boost::filesystem::unique_path();
+    {
+        boost::nowide::ofstream f(temp.string(), std::ios::binary);
+        f << gcode;
+    }
+
+    GCodeReader file_reader;
+    std::vector<float> file_xs;
+    std::vector<std::string> file_lines = parse_lines(file_reader, temp.string(), file_xs);
+    boost::nowide::remove(temp.string().c_str());
+
+    GCodeReader buffer_reader;
+    std::vector<std::string> buffer_lines;
+    std::vector<float> buffer_xs;
+    buffer_reader.parse_buffer(gcode, [&buffer_lines, &buffer_xs](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+        buffer_lines.emplace_back(line.raw());
+        buffer_xs.emplace_back(line.new_X(reader));
+    });
+
+    REQUIRE(file_lines.size() == 6);
+    REQUIRE(file_lines == buffer_lines);
+    REQUIRE(file_xs == buffer_xs);
+    REQUIRE(file_lines.back() == "M106 S255 ; a long comment, longer than the small string optimization");
+    REQUIRE(file_reader.x() == Approx(0.));
+
+    SECTION("an empty file is parsed without any line") {
+        boost::filesystem::path empty = boost::filesystem::unique_path();
+        { boost::nowide::ofstream f(empty.string()); }
+        GCodeReader reader;
+        std::vector<float> xs;
+        REQUIRE(parse_lines(reader, empty.string(), xs).empty());
+        boost::nowide::remove(empty.string().c_str());
+    }
+}
+
+TEST_CASE("The layers of a G-code file are indexed without parsing it", "[GCodeReader]") {
+    const std::string layer1 = ";LAYER_CHANGE\n;Z:0.2\n;HEIGHT:0.2\nG1 Z0.2 F600\nG1 X1 Y1 E0.5\nG2 X2 Y2 I1 J0 E1\n";
+    const std::string layer2 = ";LAYER_CHANGE\r\n;Z:0.4\r\nG1 X3 Y3 E1.5\r\n";
+    const std::string gcode  = "; header\nG28\n" + layer1 + layer2 + "M107";
+    boost::filesystem::path temp = boost::filesystem::unique_path();
+    {
+        boost::nowide::ofstream f(temp.string(), std::ios::binary);
+        f << gcode;
+    }
+
+    std::vector<GCodeProcessor::LayerIndexEntry> layers = GCodeProcessor::scan_layers(temp.string());
+    REQUIRE(layers.size() == 2);
+    CHECK(layers[0].offset == gcode.find(layer1));
+    CHECK(layers[0].z == Approx(0.2));
+    CHECK(layers[0].lines == 6);
+    CHECK(layers[0].moves == 3);
+    CHECK(layers[1].offset == gcode.find(layer2));
+    CHECK(layers[1].z == Approx(0.4));
+    CHECK(layers[1].lines == 4);
+    CHECK(layers[1].moves == 1);
+
+    SECTION("the file is parsed up to the second layer") {
+        GCodeReader reader;
+        std::vector<std::string> lines;
+        reader.parse_file(temp.string(), [&lines](GCodeReader &, const GCodeReader::GCodeLine &line) { lines.emplace_back(line.raw()); }, layers[1].offset);
+        REQUIRE(lines.size() == 8);
+        CHECK(lines.back() == "G2 X2 Y2 I1 J0 E1");
+        CHECK(reader.x() == Approx(2.));
+    }
+    boost::nowide::remove(temp.string().c_str());
+}
+
+TEST_CASE("GCodeReader parses the axis values independently of the locale", "[GCodeReader]") {
+    GCodeReader reader;
+    std::vector<GCodeReader::GCodeLine> lines;
+    reader.parse_buffer("G1 X-.5 Y+12.25 Z0.2 E1e-2 F7800.\nG1 X Y0.1.2 E-0.00001\nG1 X1.2345678901234567\n",
+        [&lines](GCodeReader &, const GCodeReader::GCodeLine &line) { lines.emplace_back(line); });
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0].x() == -0.5f);
+    CHECK(lines[0].y() == 12.25f);
+    CHECK(lines[0].z() == 0.2f);
+    CHECK(lines[0].e() == 0.01f);
+    CHECK(lines[0].f() == 7800.f);
+    // An axis without a value is parsed as zero, a malformed value is skipped.
+    CHECK(lines[1].has_x());
+    CHECK(lines[1].x() == 0.f);
+    CHECK(! lines[1].has_y());
+    CHECK(lines[1].e() == -0.00001f);
+    CHECK(lines[2].x() == float(1.2345678901234567));
+    float value = 0.f;
+    CHECK(lines[0].has_value('Y', value));
+    CHECK(value == 12.25f);
+}
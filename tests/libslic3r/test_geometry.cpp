@@ -1,5 +1,9 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <random>
+
 #include "libslic3r/Point.hpp"
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/Polygon.hpp"
@@ -65,6 +69,101 @@ TEST_CASE("shortest path, 30x30 cube") {
     REQUIRE(out.size() == vecIn.size());
 }
 
+TEST_CASE("shortest path, collections below and above the linear search limit") {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> pos(0., 50.);
+    std::vector<ExtrusionPaths> sets;
+    for (size_t n : { 2, 3, 5, 16, 100, 256, 257, 600 }) {
+        sets.emplace_back();
+        for (size_t i = 0; i < n; ++ i) {
+            sets.back().emplace_back(ExtrusionRole::erNone);
+            sets.back().back().polyline = Polyline(Point::new_scale(pos(rng), pos(rng)), Point::new_scale(pos(rng), pos(rng)));
+        }
+    }
+    Point start_near = Point::new_scale(25., 25.);
+    auto chain = [&start_near](ExtrusionPaths &paths) {
+        std::vector<ExtrusionEntity*> entities;
+        for (ExtrusionPath &path : paths)
+            entities.emplace_back(&path);
+        return chain_extrusion_entities(entities, &start_near);
+    };
+    std::vector<std::vector<std::pair<size_t, bool>>> chains;
+    for (ExtrusionPaths &paths : sets) {
+        chains.emplace_back(chain(paths));
+        std::vector<std::pair<size_t, bool>> &out = chains.back();
+        REQUIRE(out.size() == paths.size());
+        std::vector<size_t> ids;
+        for (const std::pair<size_t, bool> &segment : out)
+            ids.emplace_back(segment.first);
+        std::sort(ids.begin(), ids.end());
+        REQUIRE(std::unique(ids.begin(), ids.end()) == ids.end());
+        // The chain starts at the end point closest to start_near.
+        double dist_first = std::numeric_limits<double>::max();
+        for (const ExtrusionPath &path : paths)
+            dist_first = std::min(dist_first, std::min((path.first_point() - start_near).cast<double>().norm(), (path.last_point() - start_near).cast<double>().norm()));
+        const ExtrusionPath &first = paths[out.front().first];
+        REQUIRE(((out.front().second ? first.last_point() : first.first_point()) - start_near).cast<double>().norm() == Approx(dist_first));
+    }
+    // Buffers reused from the previous calls do not change the result.
+    for (size_t i = sets.size(); i > 0; -- i)
+        REQUIRE(chain(sets[i - 1]) == chains[i - 1]);
+}
+
+TEST_CASE("shortest path, large set of infill lines") {
+    // Above 1000 lines, the ordering is improved by the bounded time variant of the two exchange optimization.
+    const size_t num_lines = 2000;
+    Polylines lines;
+    for (size_t i = 0; i < num_lines; ++ i)
+        lines.emplace_back(Point::new_scale(0., 0.5 * double(i)), Point::new_scale(i % 7 == 0 ? 50. : 100., 0.5 * double(i)));
+    std::shuffle(lines.begin(), lines.end(), std::mt19937(1234));
+    auto travel = [](const Polylines &polylines) {
+        double sum = 0.;
+        for (size_t i = 1; i < polylines.size(); ++ i)
+            sum += (polylines[i].first_point() - polylines[i - 1].last_point()).cast<double>().norm();
+        return sum;
+    };
+    Polylines out = chain_polylines(lines);
+    REQUIRE(out.size() == num_lines);
+    // Each line is present exactly once, possibly reversed.
+    std::vector<coord_t> ys;
+    for (const Polyline &pl : out)
+        ys.emplace_back(pl.first_point().y());
+    std::sort(ys.begin(), ys.end());
+    REQUIRE(std::unique(ys.begin(), ys.end()) == ys.end());
+    REQUIRE(travel(out) < 0.1 * travel(lines));
+}
+
+TEST_CASE("shortest path, sites planned over several layers") {
+    // A row of sites, all of them printed on some layers, the lower half of them on the others.
+    Points sites;
+    for (size_t i = 0; i < 10; ++ i)
+        sites.emplace_back(Point::new_scale(10. * double(i), 0.));
+    std::vector<size_t> all(10), lower(5);
+    for (size_t i = 0; i < 10; ++ i)
+        all[i] = i;
+    for (size_t i = 0; i < 5; ++ i)
+        lower[i] = i;
+    std::vector<std::vector<size_t>> sites_by_layer { all, all, all, {}, all, lower, lower, lower };
+    for (size_t lookahead : { 1, 3, 20 }) {
+        std::vector<std::vector<size_t>> out = chain_sites_by_layers(sites, sites_by_layer, lookahead);
+        REQUIRE(out.size() == sites_by_layer.size());
+        const std::vector<size_t> *last_layer = nullptr;
+        for (size_t layer_idx = 0; layer_idx < out.size(); ++ layer_idx) {
+            std::vector<size_t> sorted = out[layer_idx];
+            std::sort(sorted.begin(), sorted.end());
+            REQUIRE(sorted == sites_by_layer[layer_idx]);
+            if (out[layer_idx].empty())
+                continue;
+            // Each layer is printed along the row, such a layer starts where the previous one ended.
+            for (size_t i = 1; i < out[layer_idx].size(); ++ i)
+                REQUIRE(std::abs(int(out[layer_idx][i]) - int(out[layer_idx][i - 1])) == 1);
+            if (last_layer != nullptr && last_layer->size() == out[layer_idx].size())
+                REQUIRE(out[layer_idx].front() == last_layer->back());
+            last_layer = &out[layer_idx];
+        }
+    }
+}
+
 TEST_CASE("Polygon::contains works properly", "[Geometry]"){
    // this test was failing on Windows (GH #1950)
     Slic3r::Polygon polygon(std::vector<Point>({
@@ -509,3 +608,19 @@ SCENARIO("Ported from xs/t/14_geometry.t", "[Geometry]"){
 }
 
 
+
+TEST_CASE("Products of coordinates are evaluated without overflow", "[Geometry]"){
+    // Coordinates of a 1m wide bed do not fit 32bit when multiplied, even with the 32bit coord_t.
+    Point a(scale_(-500.), scale_(-500.));
+    Point b(scale_(500.), scale_(500.));
+    Point c(scale_(500.), scale_(-500.));
+    SECTION("cross product") {
+        REQUIRE(cross2(Vec2i32((b - a).cast<int32_t>()), Vec2i32((c - a).cast<int32_t>())) == - int64_t(scale_(1000.)) * int64_t(scale_(1000.)));
+    }
+    SECTION("dot product") {
+        REQUIRE(Line(a, b).dot(Line(a, c)) == int64_t(scale_(1000.)) * int64_t(scale_(1000.)));
+    }
+    SECTION("orientation") {
+        REQUIRE(int128::cross(b - a, c - a) < 0);
+    }
+}
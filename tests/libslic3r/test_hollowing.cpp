@@ -44,3 +44,23 @@ TEST_CASE("Negative 3D offset should produce smaller object.", "[Hollowing]")
     in_mesh.WriteOBJFile("merged_out.obj");
 }
 
+
+TEST_CASE("Cached level set gives the same interior when the thickness decreases.", "[Hollowing]")
+{
+    Slic3r::TriangleMesh in_mesh = load_model("20mm_cube.obj");
+    Slic3r::sla::InteriorGridCache cache;
+
+    Slic3r::sla::HollowingConfig cfg;
+    cfg.min_thickness = 3.;
+    Slic3r::sla::generate_interior(in_mesh, cfg, {}, &cache);
+    REQUIRE(cache.grid);
+
+    cfg.min_thickness = 2.;
+    std::unique_ptr<Slic3r::TriangleMesh> cached = Slic3r::sla::generate_interior(in_mesh, cfg, {}, &cache);
+    std::unique_ptr<Slic3r::TriangleMesh> fresh  = Slic3r::sla::generate_interior(in_mesh, cfg);
+
+    REQUIRE(cached);
+    REQUIRE(fresh);
+    REQUIRE(! cached->empty());
+    REQUIRE(cached->volume() == Approx(fresh->volume()).epsilon(0.01));
+}
@@ -1,6 +1,10 @@
 #include <catch2/catch.hpp>
 #include <test_utils.hpp>
 
+#include <libslic3r/SimplifyMesh.hpp>
+
+#include <map>
+
 //#include <libslic3r/MeshSimplify.hpp>
 
 //TEST_CASE("Mesh simplification", "[mesh_simplify]") {
@@ -9,3 +13,43 @@
 //    Simplify::write_obj("zaba_simplified.obj");
 //}
 
+using namespace Slic3r;
+
+// Every edge of a closed manifold mesh is shared by exactly two faces.
+static bool is_closed(const indexed_triangle_set &its)
+{
+    std::map<std::pair<int, int>, int> edges;
+    for (const stl_triangle_vertex_indices &f : its.indices)
+        for (int i = 0; i < 3; ++i) {
+            int a = f(i), b = f((i + 1) % 3);
+            ++edges[{std::min(a, b), std::max(a, b)}];
+        }
+    for (const auto &e : edges)
+        if (e.second != 2) return false;
+    return true;
+}
+
+static void test_simplify_sphere(double fa, size_t face_count)
+{
+    TriangleMesh sphere = make_sphere(10., fa);
+    REQUIRE(sphere.its.indices.size() > face_count);
+
+    indexed_triangle_set its = sphere.its;
+    simplify_mesh(its, face_count);
+
+    REQUIRE(its.indices.size() <= face_count);
+    REQUIRE(its.indices.size() > face_count * 9 / 10);
+    REQUIRE(is_closed(its));
+
+    TriangleMesh simplified(its);
+    REQUIRE(simplified.volume() == Approx(sphere.volume()).epsilon(0.05));
+}
+
+TEST_CASE("Simplify a mesh to a face count", "[mesh_simplify]") {
+    test_simplify_sphere(PI / 100., 4000);
+}
+
+TEST_CASE("Simplify a large mesh in parallel regions", "[mesh_simplify]") {
+    // Large enough to be split into a grid of regions.
+    test_simplify_sphere(PI / 400., 20000);
+}
@@ -71,6 +71,14 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     // The PlaceholderParser has no way to know which extrusion type the caller has in mind, therefore it throws.
     SECTION("first_layer_speed") { REQUIRE_THROWS(parser.process("{first_layer_speed}")); }
 
+    // Test the compiled templates against the templates parsed at once.
+    auto compiled = [&parser](const std::string& templ) { return parser.process(PlaceholderParser::compile(templ), 1); };
+    SECTION("compiled: text and legacy variables") { REQUIRE(compiled("M104 S[temperature] ; [ temperature_ [foo] ] [temperature_2]\n") == parser.process("M104 S[temperature] ; [ temperature_ [foo] ] [temperature_2]\n", 1)); }
+    SECTION("compiled: nested conditions") { REQUIRE(compiled("A{if bar == 2}B{if foo > 0}C{else}D{endif}{elsif foo == 0}E{endif} {2*bar} {\"}\"}") == "ABD 4 }"); }
+    SECTION("compiled: regular expression") { REQUIRE(compiled("{if printer_notes=~/.*MK{1}.*/}MK2{endif}") == "MK2"); }
+    SECTION("compiled: unterminated condition") { REQUIRE_THROWS(compiled("{if bar == 2}B")); }
+    SECTION("compiled: unknown variable") { REQUIRE_THROWS(compiled("G1 [no_such_variable]")); }
+
     // Test the boolean expression parser.
     auto boolean_expression = [&parser](const std::string& templ) { return parser.evaluate_boolean_expression(templ, parser.config()); };
 
@@ -53,3 +53,48 @@ TEST_CASE("PNG read", "[PNG]") {
         REQUIRE(sum == rstsum);
     }
 }
+
+TEST_CASE("RLE raster round trip", "[RLE]") {
+    auto rst = create_raster({100, 100});
+    ExPolygon square;
+    square.contour.points = {{scaled(-20.), scaled(-20.)}, {scaled(20.), scaled(-20.)},
+                             {scaled(20.), scaled(20.)}, {scaled(-20.), scaled(20.)}};
+    rst.draw(square);
+
+    auto enc_rst = rst.encode(sla::RLERasterEncoder{});
+    REQUIRE(std::string(enc_rst.extension()) == "rle");
+    // One run per row crossing the square and a few more for the background.
+    REQUIRE(enc_rst.size() < 12 + 3 * 2 * 41 + 6);
+
+    std::vector<uint8_t> pixels;
+    size_t w = 0, h = 0;
+    REQUIRE(sla::decode_rle_raster(enc_rst.data(), enc_rst.size(), pixels, w, h));
+    REQUIRE(w == rst.resolution().width_px);
+    REQUIRE(h == rst.resolution().height_px);
+
+    for (size_t r = 0; r < h; ++r)
+        for (size_t c = 0; c < w; ++c)
+            REQUIRE(pixels[r * w + c] == rst.read_pixel(c, r));
+
+    REQUIRE(! sla::decode_rle_raster(enc_rst.data(), enc_rst.size() - 1, pixels, w, h));
+}
+
+TEST_CASE("Fast PNG encoder round trip", "[PNG]") {
+    auto rst = create_raster({100, 100});
+    ExPolygon square;
+    square.contour.points = {{scaled(-20.), scaled(-20.)}, {scaled(20.), scaled(-20.)},
+                             {scaled(20.), scaled(20.)}, {scaled(-20.), scaled(20.)}};
+    rst.draw(square);
+
+    auto enc_rst = rst.encode(sla::FastPNGRasterEncoder{});
+    REQUIRE(Slic3r::png::is_png({enc_rst.data(), enc_rst.size()}));
+
+    png::ImageGreyscale img;
+    REQUIRE(png::decode_png({enc_rst.data(), enc_rst.size()}, img));
+    REQUIRE(img.rows == rst.resolution().height_px);
+    REQUIRE(img.cols == rst.resolution().width_px);
+
+    for (size_t r = 0; r < img.rows; ++r)
+        for (size_t c = 0; c < img.cols; ++c)
+            REQUIRE(img.get(r, c) == rst.read_pixel(c, r));
+}
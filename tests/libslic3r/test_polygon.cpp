@@ -1,7 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include "libslic3r/BoundingBox.hpp"
+#include "libslic3r/ExPolygon.hpp"
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Polygon.hpp"
+#include "libslic3r/Polyline.hpp"
 
 using namespace Slic3r;
 
@@ -42,3 +45,58 @@ SCENARIO("Remove collinear points from Polygon", "[Polygon]") {
         }
     }
 }
+
+SCENARIO("ExPolygonContainsIndex answers as ExPolygon::contains", "[Polygon]") {
+    GIVEN("A star shaped ExPolygon with a hole") {
+        ExPolygon expoly;
+        for (size_t i = 0; i < 200; ++ i) {
+            double angle  = 2. * M_PI * double(i) / 200.;
+            double radius = (i % 2) ? 50. : 30.;
+            expoly.contour.points.emplace_back(Point::new_scale(radius * cos(angle), radius * sin(angle)));
+        }
+        expoly.holes.emplace_back(Points{ Point::new_scale(-5, -5), Point::new_scale(-5, 5), Point::new_scale(5, 5), Point::new_scale(5, -5) });
+        ExPolygonContainsIndex index(expoly);
+        THEN("All the points of a grid over its bounding box are classified the same") {
+            size_t mismatches = 0;
+            for (int y = -55; y <= 55; ++ y)
+                for (int x = -55; x <= 55; ++ x) {
+                    Point pt = Point::new_scale(x, y + 0.5 * (x % 2));
+                    if (index.contains(pt) != expoly.contains(pt))
+                        ++ mismatches;
+                }
+            for (const Point &pt : expoly.contour.points)
+                if (index.contains(pt) != expoly.contains(pt))
+                    ++ mismatches;
+            REQUIRE(mismatches == 0);
+            REQUIRE(index.contains(Point::new_scale(20, 0)));
+            REQUIRE(! index.contains(Point::new_scale(0, 0)));
+            REQUIRE(! index.contains(Point::new_scale(60, 0)));
+        }
+    }
+}
+
+SCENARIO("Length and bounding box kernels match the per line computation", "[Polygon]") {
+    GIVEN("A square and the open path through its points") {
+        Polygon  square({ { 0, 0 }, { 100, 0 }, { 100, 100 }, { 0, 100 } });
+        Polyline path(square.points);
+        THEN("The polygon length includes the closing segment") {
+            double len = 0.;
+            for (const Line &line : square.lines())
+                len += line.length();
+            REQUIRE(square.length() == len);
+            REQUIRE(square.length() == Approx(400.));
+        }
+        THEN("The polyline length does not") {
+            REQUIRE(path.length() == Approx(300.));
+        }
+        THEN("A polygon of two points has no length") {
+            REQUIRE(Polygon({ { 0, 0 }, { 100, 0 } }).length() == 0.);
+        }
+        THEN("The bounding box spans the points") {
+            BoundingBox bbox(Points{ { 30, -20 }, { -10, 50 }, { 70, 10 } });
+            REQUIRE(bbox.defined);
+            REQUIRE(bbox.min == Point(-10, -20));
+            REQUIRE(bbox.max == Point(70, 50));
+        }
+    }
+}
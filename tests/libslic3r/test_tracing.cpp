@@ -0,0 +1,40 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Tracing.hpp"
+
+#include <tbb/parallel_for.h>
+
+using namespace Slic3r;
+
+TEST_CASE("Tracing records zones of all threads", "[Tracing]")
+{
+    tracing::start();
+    // Spans several buffer chunks of the main thread.
+    for (size_t i = 0; i < 10000; ++ i) {
+        SLIC3R_TRACE_ZONE("test_zone");
+    }
+    tbb::parallel_for(size_t(0), size_t(10000), [](size_t) {
+        SLIC3R_TRACE_ZONE("test_zone");
+    });
+    tracing::stop();
+    {
+        // Not recorded, the tracing is stopped.
+        SLIC3R_TRACE_ZONE("test_zone_stopped");
+    }
+
+    REQUIRE(tracing::num_zones() == 20000);
+
+    std::string json = tracing::chrome_trace_json();
+    REQUIRE(json.find("\"name\":\"test_zone\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(json.find("\"ph\":\"M\"") != std::string::npos);
+    REQUIRE(json.find("test_zone_stopped") == std::string::npos);
+
+    SECTION("start() discards the zones recorded before") {
+        tracing::start();
+        {
+            SLIC3R_TRACE_ZONE("test_zone_restarted");
+        }
+        tracing::stop();
+        REQUIRE(tracing::num_zones() == 1);
+    }
+}
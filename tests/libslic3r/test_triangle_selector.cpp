@@ -0,0 +1,69 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+
+using namespace Slic3r;
+
+// Encoding of all the division trees from scratch.
+static std::map<int, std::vector<bool>> serialize_from_scratch(const TriangleMesh &mesh, const std::map<int, std::vector<bool>> &data)
+{
+    TriangleSelector selector(mesh);
+    selector.deserialize(data);
+    return selector.serialize();
+}
+
+TEST_CASE("Incremental serialization of the triangle selector", "[TriangleSelector]")
+{
+    TriangleMesh mesh = make_cube(10., 10., 10.);
+    TriangleSelector selector(mesh);
+    REQUIRE(selector.serialize().empty());
+
+    const stl_triangle_vertex_indices &face = mesh.its.indices.front();
+    Vec3f hit = (mesh.its.vertices[face(0)] + mesh.its.vertices[face(1)] + mesh.its.vertices[face(2)]) / 3.f;
+    selector.select_patch(hit, 0, hit + Vec3f(0.f, 0.f, 100.f), 2.f, TriangleSelector::SPHERE,
+                          EnforcerBlockerType::ENFORCER, Transform3d::Identity());
+    std::map<int, std::vector<bool>> painted = selector.serialize();
+    REQUIRE(! painted.empty());
+    REQUIRE(painted == serialize_from_scratch(mesh, painted));
+
+    selector.set_facet(5, EnforcerBlockerType::BLOCKER);
+    auto data = selector.serialize();
+    REQUIRE(data.size() == painted.size() + (painted.count(5) ? 0 : 1));
+    REQUIRE(data == serialize_from_scratch(mesh, data));
+
+    // Painting the facet back to the default state removes its record.
+    selector.set_facet(5, EnforcerBlockerType::NONE);
+    painted.erase(5);
+    REQUIRE(selector.serialize() == painted);
+
+    selector.reset();
+    REQUIRE(selector.serialize().empty());
+}
+
+TEST_CASE("Painting with the sphere and circle cursors", "[TriangleSelector]")
+{
+    TriangleMesh mesh = make_cube(10., 10., 10.);
+    const stl_triangle_vertex_indices &face = mesh.its.indices.front();
+    Vec3f hit = (mesh.its.vertices[face(0)] + mesh.its.vertices[face(1)] + mesh.its.vertices[face(2)]) / 3.f;
+    Vec3f normal = mesh.stl.facet_start.front().normal;
+
+    for (auto type : { TriangleSelector::SPHERE, TriangleSelector::CIRCLE }) {
+        TriangleSelector selector(mesh);
+        selector.select_patch(hit, 0, hit + 100.f * normal, 1.f, type, EnforcerBlockerType::ENFORCER, Transform3d::Identity());
+        indexed_triangle_set painted = selector.get_facets(EnforcerBlockerType::ENFORCER);
+        REQUIRE(! painted.indices.empty());
+
+        // All the painted triangles touch the cursor.
+        for (const stl_triangle_vertex_indices &f : painted.indices) {
+            Vec3f c = (painted.vertices[f(0)] + painted.vertices[f(1)] + painted.vertices[f(2)]) / 3.f;
+            REQUIRE((c - hit).norm() < 2.f);
+        }
+
+        // A brush far away from the mesh paints nothing.
+        TriangleSelector selector2(mesh);
+        Vec3f far = hit + Vec3f(100.f, 100.f, 0.f);
+        selector2.select_patch(far, 0, far + 100.f * normal, 1.f, type, EnforcerBlockerType::ENFORCER, Transform3d::Identity());
+        REQUIRE(selector2.get_facets(EnforcerBlockerType::ENFORCER).indices.empty());
+    }
+}
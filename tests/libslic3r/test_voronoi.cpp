@@ -1253,6 +1253,14 @@ TEST_CASE("Voronoi offset", "[VoronoiOffset]")
           vd, Points(), lines, offsetted_polygons_in);
 #endif
   }
+
+  SECTION("multiple offsets extracted from a single Voronoi diagram") {
+      std::vector<double> distances { scale_(0.2), - scale_(0.2), scale_(0.505), - scale_(0.505), scale_(0.55), - scale_(0.55) };
+      std::vector<Polygons> offsetted = voronoi_offset(vd, lines, distances, scale_(0.005));
+      REQUIRE(offsetted.size() == distances.size());
+      for (size_t i = 0; i < distances.size(); ++ i)
+          REQUIRE(offsetted[i] == voronoi_offset(vd, lines, distances[i], scale_(0.005)));
+  }
 }
 
 TEST_CASE("Voronoi offset 2", "[VoronoiOffset]")
@@ -7,6 +7,7 @@
 
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/SLA/Concurrency.hpp>
+#include <libslic3r/SLA/ScanlineRaster.hpp>
 
 namespace {
 
@@ -159,6 +160,83 @@ TEST_CASE("FloorSupportsDoNotPierceModel", "[SLASupportGeneration]") {
         test_support_model_collision(fname, supportcfg);
 }
 
+TEST_CASE("Pinhead cache reproduces the support tree", "[SLASupportGeneration]") {
+    TriangleMesh mesh = make_cube(20., 20., 20.);
+    mesh.translate(0., 0., 10.);
+    
+    sla::SupportPoints pts;
+    for (float x = 2.f; x < 20.f; x += 4.f)
+        for (float y = 2.f; y < 20.f; y += 4.f)
+            pts.emplace_back(Vec3f{x, y, 10.f}, 0.4f, false);
+    
+    sla::SupportTreeConfig cfg;
+    cfg.object_elevation_mm = 5.;
+    
+    sla::SupportableMesh sm{mesh, pts, cfg};
+    sm.pinhead_cache = std::make_shared<sla::PinheadCache>();
+    
+    sla::SupportTreeBuilder first;
+    sla::SupportTreeBuildsteps::execute(first, sm);
+    REQUIRE(sm.pinhead_cache->size() == pts.size());
+    
+    sla::SupportTreeBuilder second;
+    sla::SupportTreeBuildsteps::execute(second, sm);
+    
+    REQUIRE(second.heads().size() == first.heads().size());
+    for (size_t i = 0; i < first.heads().size(); ++i) {
+        REQUIRE(second.heads()[i].dir.isApprox(first.heads()[i].dir));
+        REQUIRE(second.heads()[i].width_mm == Approx(first.heads()[i].width_mm));
+    }
+    REQUIRE(second.pillars().size() == first.pillars().size());
+    
+    // Only the added point is searched for.
+    sm.pts.emplace_back(Vec3f{19.f, 19.f, 10.f}, 0.4f, false);
+    sla::SupportTreeBuilder third;
+    sla::SupportTreeBuildsteps::execute(third, sm);
+    REQUIRE(sm.pinhead_cache->size() == pts.size() + 1);
+    
+    // A changed configuration drops the cache.
+    sm.cfg.head_width_mm *= 2.;
+    sla::SupportTreeBuilder fourth;
+    sla::SupportTreeBuildsteps::execute(fourth, sm);
+    REQUIRE(sm.pinhead_cache->size() == sm.pts.size());
+}
+
+TEST_CASE("Support tree slices match the slices of its mesh", "[SLASupportGeneration]") {
+    TriangleMesh mesh = make_cube(20., 20., 20.);
+    mesh.translate(0., 0., 10.);
+    
+    sla::SupportPoints pts;
+    for (float x = 2.f; x < 20.f; x += 4.f)
+        for (float y = 2.f; y < 20.f; y += 4.f)
+            pts.emplace_back(Vec3f{x, y, 10.f}, 0.4f, false);
+    
+    sla::SupportTreeConfig cfg;
+    cfg.object_elevation_mm = 5.;
+    
+    sla::SupportableMesh sm{mesh, pts, cfg};
+    sla::SupportTreeBuilder builder;
+    sla::SupportTreeBuildsteps::execute(builder, sm);
+    builder.merge_and_cleanup();
+    
+    auto bb = builder.retrieve_mesh().bounding_box();
+    std::vector<float> slicegrid = grid(float(bb.min.z()), float(bb.max.z()), 0.1f);
+    
+    std::vector<ExPolygons> slices      = builder.slice_supports(slicegrid, CLOSING_RADIUS);
+    std::vector<ExPolygons> mesh_slices = builder.sla::SupportTree::slice_supports(slicegrid, CLOSING_RADIUS);
+    REQUIRE(slices.size() == mesh_slices.size());
+    
+    // The spheres of the mesh are approximated by rings, the sliced primitives
+    // by circles, so only the sums of the areas are compared.
+    double total = 0., mesh_total = 0.;
+    for (size_t i = 0; i < slices.size(); ++i) {
+        for (const ExPolygon &p : slices[i]) total += p.area();
+        for (const ExPolygon &p : mesh_slices[i]) mesh_total += p.area();
+    }
+    REQUIRE(total > 0.);
+    REQUIRE(total == Approx(mesh_total).epsilon(0.03));
+}
+
 TEST_CASE("InitializedRasterShouldBeNONEmpty", "[SLARasterOutput]") {
     // Default Prusa SL1 display parameters
     sla::RasterBase::Resolution res{2560, 1440};
@@ -224,6 +302,44 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
     REQUIRE(raster_pxsum(raster0) == 0);
 }
 
+TEST_CASE("ScanlineRasterShouldMatchAGG", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::RasterBase::Resolution res{2560, 1440};
+    sla::RasterBase::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    
+    sla::RasterBase::Trafo trafo{sla::RasterBase::roPortrait, sla::RasterBase::MirrorX};
+    trafo.center_x = scaled(disp_w / 2.);
+    trafo.center_y = scaled(disp_h / 2.);
+    
+    ExPolygon poly = square_with_hole(20.);
+    poly.rotate(0.3);
+    
+    sla::RasterGrayscaleAAGammaPower agg_raster(res, pixdim, trafo, 1.);
+    sla::RasterGrayscaleScanline raster(res, pixdim, trafo, agg::gamma_power(1.), 16);
+    agg_raster.draw(poly);
+    raster.draw(poly);
+    
+    int max_diff = 0;
+    for (size_t x = 0; x < res.width_px; ++x)
+        for (size_t y = 0; y < res.height_px; ++y)
+            max_diff = std::max(max_diff, std::abs(int(raster.read_pixel(x, y)) -
+                                                   int(agg_raster.read_pixel(x, y))));
+    
+    // 16 sub-scanlines quantize the coverage of a pixel to 1/16.
+    REQUIRE(max_diff <= 255 / 16);
+    
+    sla::RasterGrayscaleScanline raster1(res, pixdim, trafo, agg::gamma_threshold(.5), 1);
+    raster1.draw(poly);
+    
+    double ra = 0.;
+    for (size_t x = 0; x < res.width_px; ++x)
+        for (size_t y = 0; y < res.height_px; ++y)
+            ra += pixel_area(raster1.read_pixel(x, y), pixdim);
+    
+    double a = poly.area() / (scaled<double>(1.) * scaled(1.));
+    REQUIRE(std::abs(a - ra) <= predict_error(poly, pixdim));
+}
+
 TEST_CASE("Triangle mesh conversions should be correct", "[SLAConversions]")
 {
     sla::Contour3D cntr;